@@ -28,6 +28,7 @@
 #include "otbRAMDrivenAdaptativeStreamingManager.h"
 
 #include "otbConfusionMatrixMeasurements.h"
+#include "otbStreamingConfusionMatrixImageFilter.h"
 #include "otbContingencyTableCalculator.h"
 #include "otbContingencyTable.h"
 
@@ -70,10 +71,8 @@ public:
   typedef unsigned long                                    ConfusionMatrixEltType;
   typedef itk::VariableSizeMatrix<ConfusionMatrixEltType>  ConfusionMatrixType;
 
-  typedef std::map<
-                   ClassLabelType,
-                   std::map<ClassLabelType, ConfusionMatrixEltType>
-                  > OutputConfusionMatrixType;
+  typedef otb::StreamingConfusionMatrixImageFilter<Int32ImageType> ConfusionMatrixFilterType;
+  typedef ConfusionMatrixFilterType::LabelListType                  LabelListType;
 
 
   // filter type
@@ -410,57 +409,41 @@ private:
 
   void DoExecuteConfusionMatrix(const StreamingInitializationData& sid)
   {
-
-    // Extraction of the Class Labels from the Reference image/rasterized vector data + filling of m_Matrix
-    MapOfClassesType  mapOfClassesRef, mapOfClassesProd;
-    MapOfClassesType::iterator  itMapOfClassesRef, itMapOfClassesProd;
-    ClassLabelType labelRef = 0, labelProd = 0;
-    int itLabelRef = 0, itLabelProd = 0;
-
-    for (unsigned int index = 0; index < sid.numberOfStreamDivisions; index++)
+    // Accumulation of the reference/produced label pairs by all threads
+    ConfusionMatrixFilterType::Pointer confusionMatrixFilter = ConfusionMatrixFilterType::New();
+    confusionMatrixFilter->SetInput(m_Input);
+    confusionMatrixFilter->SetReferenceImage(m_Reference);
+    if (sid.refhasnodata)
       {
-      RegionType streamRegion = m_StreamingManager->GetSplit(index);
-
-      m_Input->SetRequestedRegion(streamRegion);
-      m_Input->PropagateRequestedRegion();
-      m_Input->UpdateOutputData();
-
-      m_Reference->SetRequestedRegion(streamRegion);
-      m_Reference->PropagateRequestedRegion();
-      m_Reference->UpdateOutputData();
-
-      ImageIteratorType itInput(m_Input, streamRegion);
-      itInput.GoToBegin();
-
-      ImageIteratorType itRef(m_Reference, streamRegion);
-      itRef.GoToBegin();
-
-      while (!itRef.IsAtEnd())
-        {
-        labelRef = static_cast<ClassLabelType> (itRef.Get());
-        labelProd = static_cast<ClassLabelType> (itInput.Get());
-
-        // Extraction of the reference/produced class labels
-        if ((!sid.refhasnodata || labelRef != sid.refnodata) && (!sid.prodhasnodata || labelProd != sid.prodnodata))
-          {
-          // If the current labels have not been added to their respective mapOfClasses yet
-          if (mapOfClassesRef.insert(MapOfClassesType::value_type(labelRef, itLabelRef)).second)
-            {
-            ++itLabelRef;
-            }
-          if (mapOfClassesProd.insert(MapOfClassesType::value_type(labelProd, itLabelProd)).second)
-            {
-            ++itLabelProd;
-            }
-
-          // Filling of m_Matrix
-          m_Matrix[labelRef][labelProd]++;
-          } // END if ((labelRef != nodata) && (labelProd != nodata))
-        ++itRef;
-        ++itInput;
-        }
-      } // END of for (unsigned int index = 0; index < numberOfStreamDivisions; index++)
-
+      confusionMatrixFilter->SetReferenceNoDataValue(sid.refnodata);
+      }
+    if (sid.prodhasnodata)
+      {
+      confusionMatrixFilter->SetProducedNoDataValue(sid.prodnodata);
+      }
+    confusionMatrixFilter->GetStreamer()->SetAutomaticAdaptativeStreaming(GetParameterInt("ram"), 2.0);
+    AddProcess(confusionMatrixFilter->GetStreamer(), "Computing confusion matrix...");
+    confusionMatrixFilter->Update();
+
+    const LabelListType & labels = confusionMatrixFilter->GetLabels();
+    const LabelListType & refLabels = confusionMatrixFilter->GetReferenceLabels();
+    const LabelListType & prodLabels = confusionMatrixFilter->GetProducedLabels();
+    const ConfusionMatrixType & matrix = confusionMatrixFilter->GetConfusionMatrix();
+
+    // Rows/columns of the reference/produced labels in the full matrix
+    std::vector<unsigned int> refPositions, prodPositions;
+    MapOfClassesType  mapOfClassesRef;
+    for (unsigned int i = 0; i < refLabels.size(); ++i)
+      {
+      refPositions.push_back(std::lower_bound(labels.begin(), labels.end(), refLabels[i]) - labels.begin());
+      mapOfClassesRef[refLabels[i]] = i;
+      otbAppLogINFO("mapOfClassesRef[" << refLabels[i] << "] = " << i);
+      }
+    for (unsigned int j = 0; j < prodLabels.size(); ++j)
+      {
+      prodPositions.push_back(std::lower_bound(labels.begin(), labels.end(), prodLabels[j]) - labels.begin());
+      otbAppLogINFO("mapOfClassesProd[" << prodLabels[j] << "] = " << j);
+      }
 
     /////////////////////////////////////////////
     // Filling the 2 headers for the output file
@@ -469,64 +452,18 @@ private:
     const char separatorChar = ',';
     std::ostringstream ossHeaderRefLabels, ossHeaderProdLabels;
 
-    // Filling ossHeaderRefLabels for the output file
     ossHeaderRefLabels << commentRefStr;
-
-    MapOfClassesType::iterator itMapOfClassesRefEnd = mapOfClassesRef.end();
-    itMapOfClassesRef = mapOfClassesRef.begin();
-    int indexLabelRef = 0;
-    while (itMapOfClassesRef != itMapOfClassesRefEnd)
+    for (unsigned int i = 0; i < refLabels.size(); ++i)
       {
-      // labels labelRef of mapOfClassesRef are already sorted
-      labelRef = itMapOfClassesRef->first;
-
-      // SORTING the itMapOfClassesRef->second items of mapOfClassesRef
-      mapOfClassesRef[labelRef] = indexLabelRef;
-      otbAppLogINFO("mapOfClassesRef[" << labelRef << "] = " << mapOfClassesRef[labelRef]);
-
-      ossHeaderRefLabels << labelRef;
-      ++itMapOfClassesRef;
-      if (itMapOfClassesRef != itMapOfClassesRefEnd)
-        {
-        ossHeaderRefLabels << separatorChar;
-        }
-      else
-        {
-        ossHeaderRefLabels << std::endl;
-        }
-
-      ++indexLabelRef;
+      ossHeaderRefLabels << refLabels[i] << (i + 1 < refLabels.size() ? separatorChar : '\n');
       }
 
-    // Filling ossHeaderProdLabels for the output file
     ossHeaderProdLabels << commentProdStr;
-    MapOfClassesType::iterator itMapOfClassesProdEnd = mapOfClassesProd.end();
-    itMapOfClassesProd = mapOfClassesProd.begin();
-    int indexLabelProd = 0;
-    while (itMapOfClassesProd != itMapOfClassesProdEnd)
+    for (unsigned int j = 0; j < prodLabels.size(); ++j)
       {
-      // labels labelProd of mapOfClassesProd are already sorted
-      labelProd = itMapOfClassesProd->first;
-
-      // SORTING the itMapOfClassesProd->second items of mapOfClassesProd
-      mapOfClassesProd[labelProd] = indexLabelProd;
-      otbAppLogINFO("mapOfClassesProd[" << labelProd << "] = " << mapOfClassesProd[labelProd]);
-
-      ossHeaderProdLabels << labelProd;
-      ++itMapOfClassesProd;
-      if (itMapOfClassesProd != itMapOfClassesProdEnd)
-        {
-        ossHeaderProdLabels << separatorChar;
-        }
-      else
-        {
-        ossHeaderProdLabels << std::endl;
-        }
-
-      ++indexLabelProd;
+      ossHeaderProdLabels << prodLabels[j] << (j + 1 < prodLabels.size() ? separatorChar : '\n');
       }
 
-
     std::ofstream outFile;
     outFile.open(this->GetParameterString("out").c_str());
     outFile << std::fixed;
@@ -538,42 +475,23 @@ private:
     outFile << ossHeaderProdLabels.str();
     /////////////////////////////////////
 
-
-    // Initialization of the Confusion Matrix for the application LOG and for measurements
-    int nbClassesRef = static_cast<int>(mapOfClassesRef.size());
-    int nbClassesProd = static_cast<int>(mapOfClassesProd.size());
-
-    // Formatting m_MatrixLOG from m_Matrix in order to make m_MatrixLOG a square matrix
-    // from the reference labels in mapOfClassesRef
-    indexLabelRef = 0;
-    int indexLabelProdInRef = 0;
-
-    // Initialization of m_MatrixLOG
+    // m_MatrixLOG is the square matrix of the reference labels, for the
+    // application LOG and for measurements
+    const unsigned int nbClassesRef = refLabels.size();
     m_MatrixLOG.SetSize(nbClassesRef, nbClassesRef);
-    m_MatrixLOG.Fill(0);
-    for (itMapOfClassesRef = mapOfClassesRef.begin(); itMapOfClassesRef != itMapOfClassesRefEnd; ++itMapOfClassesRef)
+    for (unsigned int i = 0; i < nbClassesRef; ++i)
       {
-      // labels labelRef of mapOfClassesRef are already sorted
-      labelRef = itMapOfClassesRef->first;
-
-      indexLabelProd = 0;
-      for (itMapOfClassesProd = mapOfClassesProd.begin(); itMapOfClassesProd != itMapOfClassesProdEnd; ++itMapOfClassesProd)
+      for (unsigned int j = 0; j < nbClassesRef; ++j)
         {
-        // labels labelProd of mapOfClassesProd are already sorted
-        labelProd = itMapOfClassesProd->first;
-
-        // If labelProd is present in mapOfClassesRef
-        if (mapOfClassesRef.count(labelProd) != 0)
-          {
-          // Index of labelProd in mapOfClassesRef; itMapOfClassesRef->second elements are now SORTED
-          indexLabelProdInRef = mapOfClassesRef[labelProd];
-          m_MatrixLOG(indexLabelRef, indexLabelProdInRef) = m_Matrix[labelRef][labelProd];
-          }
+        m_MatrixLOG(i, j) = matrix(refPositions[i], refPositions[j]);
+        }
 
-        ///////////////////////////////////////////////////////////
-        // Writing the ordered confusion matrix in the output file
-        outFile << m_Matrix[labelRef][labelProd];
-        if (indexLabelProd < (nbClassesProd - 1))
+      ///////////////////////////////////////////////////////////
+      // Writing the ordered confusion matrix in the output file
+      for (unsigned int j = 0; j < prodPositions.size(); ++j)
+        {
+        outFile << matrix(refPositions[i], prodPositions[j]);
+        if (j + 1 < prodPositions.size())
           {
           outFile << separatorChar;
           }
@@ -581,16 +499,10 @@ private:
           {
           outFile << std::endl;
           }
-        ///////////////////////////////////////////////////////////
-        ++indexLabelProd;
         }
-
-      m_Matrix[labelRef].clear();
-      ++indexLabelRef;
+      ///////////////////////////////////////////////////////////
       }
 
-    // m_Matrix is cleared in order to remove old results in case of successive runs of the GUI application
-    m_Matrix.clear();
     outFile.close();
 
     otbAppLogINFO("Reference class labels ordered according to the rows of the output confusion matrix: " << ossHeaderRefLabels.str());
@@ -600,17 +512,13 @@ private:
     LogConfusionMatrix(&mapOfClassesRef, &m_MatrixLOG);
 
 
-    // Measurements of the Confusion Matrix parameters
-    ConfusionMatrixMeasurementsType::Pointer confMatMeasurements = ConfusionMatrixMeasurementsType::New();
-
-    confMatMeasurements->SetMapOfClasses(mapOfClassesRef);
-    confMatMeasurements->SetConfusionMatrix(m_MatrixLOG);
-    confMatMeasurements->Compute();
+    // Measurements of the Confusion Matrix parameters, computed by the
+    // filter on the same square matrix
+    ConfusionMatrixMeasurementsType* confMatMeasurements = confusionMatrixFilter->GetMeasurements();
 
-    for (itMapOfClassesRef = mapOfClassesRef.begin(); itMapOfClassesRef != itMapOfClassesRefEnd; ++itMapOfClassesRef)
+    for (unsigned int indexLabelRef = 0; indexLabelRef < nbClassesRef; ++indexLabelRef)
       {
-      labelRef = itMapOfClassesRef->first;
-      indexLabelRef = itMapOfClassesRef->second;
+      const ClassLabelType labelRef = refLabels[indexLabelRef];
 
       otbAppLogINFO("Precision of class [" << labelRef << "] vs all: " << confMatMeasurements->GetPrecisions()[indexLabelRef]);
       otbAppLogINFO("Recall of class [" << labelRef << "] vs all: " << confMatMeasurements->GetRecalls()[indexLabelRef]);
@@ -627,7 +535,6 @@ private:
   }// END Execute()
 
   ConfusionMatrixType m_MatrixLOG;
-  OutputConfusionMatrixType m_Matrix;
   Int32ImageType* m_Input;
   Int32ImageType::Pointer m_Reference;
   RAMDrivenAdaptativeStreamingManagerType::Pointer m_StreamingManager;
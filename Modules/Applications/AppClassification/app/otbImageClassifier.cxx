@@ -63,6 +63,7 @@ public:
   typedef ClassificationFilterType::LabelType                                                  LabelType;
   typedef otb::MachineLearningModelFactory<ValueType, LabelType>                               MachineLearningModelFactoryType;
   typedef ClassificationFilterType::ConfidenceImageType                                        ConfidenceImageType;
+  typedef ClassificationFilterType::ProbaImageType                                             ProbaImageType;
 
 protected:
 
@@ -120,6 +121,14 @@ private:
     SetDefaultOutputPixelType( "confmap", ImagePixelType_double);
     MandatoryOff("confmap");
 
+    AddParameter(ParameterType_OutputImage, "probamap",  "Probability map");
+    SetParameterDescription( "probamap", "Probability of each class, with one band per class, in increasing order of the class labels. "
+      "The probabilities are computed with the labels, in the same streaming pass. The supported models are :\n"
+      "  - LibSVM : probability estimates (needs a model with probability estimates)\n"
+      "  - OpenCV RandomForest : proportion of the trees voting for each class\n");
+    SetDefaultOutputPixelType( "probamap", ImagePixelType_float);
+    MandatoryOff("probamap");
+
     AddRAMParameter();
 
    // Doc example parameter settings
@@ -214,6 +223,28 @@ private:
         this->DisableParameter("confmap");
         }
       }
+
+    // output class probabilities
+    if (IsParameterEnabled("probamap") && HasValue("probamap"))
+      {
+      if (m_Model->HasProbaIndex() && !m_Model->GetRegressionMode())
+        {
+        m_ClassificationFilter->SetUseProbaMap(true);
+        const std::vector<LabelType> & labels = m_Model->GetProbaLabels();
+        std::ostringstream oss;
+        for (unsigned int i = 0; i < labels.size(); ++i)
+          {
+          oss << (i > 0 ? ", " : "") << labels[i];
+          }
+        otbAppLogINFO("Classes of the bands of the probability map: " << oss.str());
+        SetParameterOutputImage<ProbaImageType>("probamap",m_ClassificationFilter->GetOutputProba());
+        }
+      else
+        {
+        otbAppLogWARNING("Probability map requested but the classifier doesn't support it!");
+        this->DisableParameter("probamap");
+        }
+      }
   }
 
   ClassificationFilterType::Pointer m_ClassificationFilter;
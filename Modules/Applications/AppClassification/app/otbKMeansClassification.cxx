@@ -31,12 +31,17 @@
 #include "otbStreamingShrinkImageFilter.h"
 #include "otbChangeLabelImageFilter.h"
 #include "otbRAMDrivenStrippedStreamingManager.h"
+#include "otbStreamingMiniBatchKMeansImageFilter.h"
+#include "otbKMeansLabelFunctor.h"
+#include "otbUnaryFunctorImageFilter.h"
 
 #include "otbChangeLabelImageFilter.h"
 #include "itkLabelToRGBImageFilter.h"
 #include "otbReliefColormapFunctor.h"
 #include "itkScalarToRGBColormapImageFilter.h"
 
+#include <algorithm>
+
 
 namespace otb
 {
@@ -45,66 +50,6 @@ namespace otb
 namespace Wrapper
 {
 
-namespace Functor
-{
-template <class TSample, class TLabel> class KMeansFunctor
-{
-public:
-  /** operator */
-  TLabel operator ()(const TSample& sample) const
-  {
-    typename CentroidMapType::const_iterator it = m_CentroidsMap.begin();
-
-    if (it == m_CentroidsMap.end())
-      {
-      return 0;
-      }
-
-    TLabel resp = it->first;
-    double minDist = m_Distance->Evaluate(sample, it->second);
-    ++it;
-
-    while (it != m_CentroidsMap.end())
-      {
-      double dist = m_Distance->Evaluate(sample, it->second);
-
-      if (dist < minDist)
-        {
-        resp = it->first;
-        minDist = dist;
-        }
-      ++it;
-      }
-    return resp;
-  }
-
-  /** Add a new centroid */
-  void AddCentroid(const TLabel& label, const TSample& centroid)
-  {
-    m_CentroidsMap[label] = centroid;
-  }
-
-  /** Constructor */
-  KMeansFunctor() : m_CentroidsMap(), m_Distance()
-  {
-    m_Distance = DistanceType::New();
-  }
-
-  bool operator !=(const KMeansFunctor& other) const
-  {
-    return m_CentroidsMap != other.m_CentroidsMap;
-  }
-
-private:
-  typedef std::map<TLabel, TSample>                   CentroidMapType;
-  typedef itk::Statistics::EuclideanDistanceMetric<TSample> DistanceType;
-
-  CentroidMapType m_CentroidsMap;
-  typename DistanceType::Pointer m_Distance;
-};
-}
-
-
 typedef FloatImageType::PixelType PixelType;
 typedef UInt16ImageType   LabeledImageType;
 
@@ -133,8 +78,10 @@ typedef otb::StreamingShrinkImageFilter<FloatVectorImageType,
 
 typedef otb::StreamingShrinkImageFilter<UInt8ImageType,
     UInt8ImageType>              MaskSamplingFilterType;
-typedef Functor::KMeansFunctor<SampleType, LabelType> KMeansFunctorType;
-typedef itk::UnaryFunctorImageFilter<FloatVectorImageType,
+typedef otb::StreamingMiniBatchKMeansImageFilter<FloatVectorImageType,
+    UInt8ImageType>                         MiniBatchKMeansFilterType;
+typedef otb::Functor::KMeansLabelFunctor<SampleType, LabelType> KMeansFunctorType;
+typedef otb::UnaryFunctorImageFilter<FloatVectorImageType,
     LabeledImageType, KMeansFunctorType>     KMeansFilterType;
 
 
@@ -173,7 +120,9 @@ private:
     SetDescription("Unsupervised KMeans image classification");
 
     SetDocName("Unsupervised KMeans image classification");
-    SetDocLongDescription("Performs unsupervised KMeans image classification.");
+    SetDocLongDescription("Performs unsupervised KMeans image classification. The centroids are either "
+                          "estimated on a sample of the image, or on the whole image with a streamed mini-batch "
+                          "k-means (train parameter).");
     SetDocLimitations("None");
     SetDocAuthors("OTB-Team");
     SetDocSeeAlso(" ");
@@ -207,6 +156,19 @@ private:
     SetParameterDescription("ct", "Convergence threshold for class centroid  (L2 distance, by default 0.0001).");
     SetDefaultParameterFloat("ct", 0.0001);
     MandatoryOff("ct");
+    AddParameter(ParameterType_Choice, "train", "Training method");
+    SetParameterDescription("train", "Pixels used to estimate the centroids.");
+    AddChoice("train.sample", "Sample of the image");
+    SetParameterDescription("train.sample", "The centroids are estimated on a regular sample of the image, "
+                            "with at most ts pixels (and never more than one million), randomly initialized.");
+    AddChoice("train.full", "Whole image");
+    SetParameterDescription("train.full", "The centroids are initialized with the k-means++ seeding on the sample "
+                            "of ts pixels, then estimated on all the pixels of the image with a streamed mini-batch "
+                            "k-means: each iteration is a pass on the image, and each strip of at most 262144 pixels "
+                            "moves the centroids towards the mean of its pixels. The strips do not depend on "
+                            "the available RAM.");
+    SetParameterString("train", "sample", false);
+
     AddParameter(ParameterType_OutputFilename, "outmeans", "Centroid filename");
     SetParameterDescription("outmeans", "Output text file containing centroid positions");
     MandatoryOff("outmeans");
@@ -417,18 +379,33 @@ private:
       }
 
     // Next, initialize centroids by random sampling in the generated
-    // list of samples
+    // list of samples, or with the k-means++ seeding for the training
+    // on the whole image
 
-    for (unsigned int classIndex = 0; classIndex < nbClasses; ++classIndex)
+    const bool fullTraining = (GetParameterString("train") == "full");
+    MiniBatchKMeansFilterType::Pointer kmeans;
+    if (fullTraining)
       {
-      SampleType newCentroid = sampleList->GetMeasurementVector(randGen->GetIntegerVariate(sampleList->Size()-1));
+      kmeans = MiniBatchKMeansFilterType::New();
+      kmeans->InitializeCentroids(sampleList, nbClasses);
 
-      for (unsigned int compIndex = 0; compIndex < sampleSize; ++compIndex)
+      const MiniBatchKMeansFilterType::CentroidsType & seeds = kmeans->GetCentroids();
+      std::copy(seeds.begin(), seeds.end(), initialMeans.begin());
+      otbAppLogINFO(<< totalSamples << " samples were used for the k-means++ seeding." << std::endl);
+      }
+    else
+      {
+      for (unsigned int classIndex = 0; classIndex < nbClasses; ++classIndex)
         {
-        initialMeans[compIndex + classIndex * sampleSize] = newCentroid[compIndex];
+        SampleType newCentroid = sampleList->GetMeasurementVector(randGen->GetIntegerVariate(sampleList->Size()-1));
+
+        for (unsigned int compIndex = 0; compIndex < sampleSize; ++compIndex)
+          {
+          initialMeans[compIndex + classIndex * sampleSize] = newCentroid[compIndex];
+          }
         }
+      otbAppLogINFO(<< totalSamples << " samples will be used as estimator input." << std::endl);
       }
-    otbAppLogINFO(<< totalSamples << " samples will be used as estimator input." << std::endl);
 
     /*******************************************/
     /*           Learning                      */
@@ -452,27 +429,54 @@ private:
     GetLogger()->Info(message.str());
     message.str("");
     otbAppLogINFO("Starting optimization." << std::endl);
-    EstimatorType::Pointer estimator = EstimatorType::New();
+    const int maxIt = GetParameterInt("maxit");
+    EstimatorType::ParametersType estimatedMeans(nbComp * nbClasses);
 
-    TreeGeneratorType::Pointer treeGenerator = TreeGeneratorType::New();
-    treeGenerator->SetSample(sampleList);
+    if (fullTraining)
+      {
+      kmeans->SetInput(m_InImage);
+      if (maskFlag)
+        {
+        kmeans->SetMaskImage(maskImage);
+        }
+      kmeans->SetMaximumNumberOfIterations(maxIt);
+      kmeans->SetCentroidsShiftThreshold(GetParameterFloat("ct"));
+      AddProcess(kmeans->GetStreamer(), "Mini-batch k-means on the whole image");
+      kmeans->Update();
 
-    treeGenerator->SetBucketSize(10000);
-    treeGenerator->Update();
+      const MiniBatchKMeansFilterType::CentroidsType & centroids = kmeans->GetCentroids();
+      std::copy(centroids.begin(), centroids.end(), estimatedMeans.begin());
 
-    estimator->SetParameters(initialMeans);
-    estimator->SetKdTree(treeGenerator->GetOutput());
-    int maxIt = GetParameterInt("maxit");
-    estimator->SetMaximumIteration(maxIt);
-    estimator->SetCentroidPositionChangesThreshold(GetParameterFloat("ct"));
-    estimator->StartOptimization();
+      otbAppLogINFO("Optimization completed after " << kmeans->GetNumberOfIterations()
+                    << " passes on the image (inertia: " << kmeans->GetInertia() << ")." );
+      if (static_cast<int>(kmeans->GetNumberOfIterations()) == maxIt)
+        {
+        otbAppLogWARNING("The estimator reached the maximum iteration number." << std::endl);
+        }
+      }
+    else
+      {
+      EstimatorType::Pointer estimator = EstimatorType::New();
 
-    EstimatorType::ParametersType estimatedMeans = estimator->GetParameters();
+      TreeGeneratorType::Pointer treeGenerator = TreeGeneratorType::New();
+      treeGenerator->SetSample(sampleList);
 
-    otbAppLogINFO("Optimization completed." );
-    if (estimator->GetCurrentIteration() == maxIt)
-      {
-      otbAppLogWARNING("The estimator reached the maximum iteration number." << std::endl);
+      treeGenerator->SetBucketSize(10000);
+      treeGenerator->Update();
+
+      estimator->SetParameters(initialMeans);
+      estimator->SetKdTree(treeGenerator->GetOutput());
+      estimator->SetMaximumIteration(maxIt);
+      estimator->SetCentroidPositionChangesThreshold(GetParameterFloat("ct"));
+      estimator->StartOptimization();
+
+      estimatedMeans = estimator->GetParameters();
+
+      otbAppLogINFO("Optimization completed." );
+      if (estimator->GetCurrentIteration() == maxIt)
+        {
+        otbAppLogWARNING("The estimator reached the maximum iteration number." << std::endl);
+        }
       }
     message.str("");
     message << "Estimated centroids are: " << std::endl;
@@ -500,16 +504,8 @@ private:
     // Finally, update the KMeans filter
     KMeansFunctorType functor;
 
-    for (unsigned int classIndex = 0; classIndex < nbClasses; ++classIndex)
-      {
-      SampleType centroid(sampleSize);
-
-      for (unsigned int compIndex = 0; compIndex < sampleSize; ++compIndex)
-        {
-        centroid[compIndex] = estimatedMeans[compIndex + classIndex * sampleSize];
-        }
-      functor.AddCentroid(classIndex, centroid);
-      }
+    KMeansFunctorType::CentroidsType centroids(estimatedMeans.begin(), estimatedMeans.end());
+    functor.SetCentroids(centroids, sampleSize);
 
     m_KMeansFilter = KMeansFilterType::New();
     m_KMeansFilter->SetFunctor(functor);
@@ -146,6 +146,11 @@ private:
     SetParameterDescription("iv", "Maximum initial neuron weight");
     MandatoryOff("iv");
 
+    AddParameter(ParameterType_Empty,  "bm",   "BatchMode");
+    SetParameterDescription("bm", "Update the map once per iteration with all the samples, "
+      "processed in parallel, instead of after each sample");
+    MandatoryOff("bm");
+
     AddRAMParameter();
     // TODO : replace StreamingLines by RAM param ?
 
@@ -362,6 +367,7 @@ private:
       estimator->SetBetaInit(GetParameterFloat("bi"));
       estimator->SetBetaEnd(GetParameterFloat("bf"));
       estimator->SetMaxWeight(GetParameterFloat("iv"));
+      estimator->SetBatchMode(IsParameterEnabled("bm"));
 
     AddProcess(estimator,"Learning");
     estimator->Update();
@@ -98,6 +98,7 @@ public:
   
   typedef typename ModelType::InputSampleType     SampleType;
   typedef typename ModelType::InputListSampleType ListSampleType;
+  typedef typename ModelType::InputContiguousListSampleType ContiguousListSampleType;
   
   typedef typename ModelType::TargetSampleType      TargetSampleType;
   typedef typename ModelType::TargetListSampleType  TargetListSampleType;
@@ -129,11 +130,26 @@ protected:
              typename TargetListSampleType::Pointer trainingLabeledListSample,
              std::string modelPath);
 
+  /** Same as above, the model being trained on a contiguous sample list */
+  void Train(typename ContiguousListSampleType::Pointer trainingListSample,
+             typename TargetListSampleType::Pointer trainingLabeledListSample,
+             std::string modelPath);
+
   /** Generic method to load a model file and use it to classify a sample list*/
   typename TargetListSampleType::Pointer Classify(
     typename ListSampleType::Pointer validationListSample,
     std::string modelPath);
 
+  /** Same as above for a contiguous sample list. The samples are predicted
+   * by chunks of ClassifyChunkSize samples, so that at most one chunk is
+   * copied to a ListSample at a time. */
+  typename TargetListSampleType::Pointer Classify(
+    typename ContiguousListSampleType::Pointer validationListSample,
+    std::string modelPath);
+
+  /** Number of samples predicted at once by Classify() on a contiguous list */
+  itkStaticConstMacro(ClassifyChunkSize, unsigned int, 100000);
+
   /** Init method that creates all the parameters for machine learning models */
   void DoInit() ITK_OVERRIDE;
 
@@ -142,6 +158,26 @@ protected:
   bool m_RegressionFlag;
 
 private:
+  /** Load the model of the given file */
+  ModelPointerType LoadModel(const std::string & modelPath);
+
+  /** Call the train method of the chosen model, whatever the list type */
+  template <class TListSample>
+  void TrainModel(TListSample * trainingListSample,
+                  typename TargetListSampleType::Pointer trainingLabeledListSample,
+                  std::string modelPath);
+
+  /** Give the training samples to the model */
+  static void SetModelTrainingSamples(ModelType * model, ListSampleType * trainingListSample)
+  {
+    model->SetInputListSample(trainingListSample);
+  }
+
+  static void SetModelTrainingSamples(ModelType * model, ContiguousListSampleType * trainingListSample)
+  {
+    model->SetInputContiguousListSample(trainingListSample);
+  }
+
   /** Specific Init and Train methods for each machine learning model */
 
   /** Init Parameters for Supervised Classifier */
@@ -156,7 +192,8 @@ private:
 #ifdef OTB_USE_LIBSVM 
   void InitLibSVMParams();
 
-  void TrainLibSVM(typename ListSampleType::Pointer trainingListSample,
+  template <class TListSample>
+  void TrainLibSVM(TListSample * trainingListSample,
                    typename TargetListSampleType::Pointer trainingLabeledListSample,
                    std::string modelPath);
 #endif  
@@ -171,39 +208,49 @@ private:
   void InitRandomForestsParams();
   void InitKNNParams();
 
-  void TrainBoost(typename ListSampleType::Pointer trainingListSample,
+  template <class TListSample>
+  void TrainBoost(TListSample * trainingListSample,
                   typename TargetListSampleType::Pointer trainingLabeledListSample,
                   std::string modelPath);
-  void TrainSVM(typename ListSampleType::Pointer trainingListSample,
+  template <class TListSample>
+  void TrainSVM(TListSample * trainingListSample,
                 typename TargetListSampleType::Pointer trainingLabeledListSample,
                 std::string modelPath);
-  void TrainDecisionTree(typename ListSampleType::Pointer trainingListSample,
+  template <class TListSample>
+  void TrainDecisionTree(TListSample * trainingListSample,
                          typename TargetListSampleType::Pointer trainingLabeledListSample,
                          std::string modelPath);
-  void TrainGradientBoostedTree(typename ListSampleType::Pointer trainingListSample,
+  template <class TListSample>
+  void TrainGradientBoostedTree(TListSample * trainingListSample,
                                 typename TargetListSampleType::Pointer trainingLabeledListSample,
                                 std::string modelPath);
-  void TrainNeuralNetwork(typename ListSampleType::Pointer trainingListSample,
+  template <class TListSample>
+  void TrainNeuralNetwork(TListSample * trainingListSample,
                           typename TargetListSampleType::Pointer trainingLabeledListSample,
                           std::string modelPath);
-  void TrainNormalBayes(typename ListSampleType::Pointer trainingListSample,
+  template <class TListSample>
+  void TrainNormalBayes(TListSample * trainingListSample,
                         typename TargetListSampleType::Pointer trainingLabeledListSample,
                         std::string modelPath);
-  void TrainRandomForests(typename ListSampleType::Pointer trainingListSample,
+  template <class TListSample>
+  void TrainRandomForests(TListSample * trainingListSample,
                           typename TargetListSampleType::Pointer trainingLabeledListSample,
                           std::string modelPath);
-  void TrainKNN(typename ListSampleType::Pointer trainingListSample,
+  template <class TListSample>
+  void TrainKNN(TListSample * trainingListSample,
                 typename TargetListSampleType::Pointer trainingLabeledListSample,
                 std::string modelPath);
 #endif
 
 #ifdef OTB_USE_SHARK
   void InitSharkRandomForestsParams();
-  void TrainSharkRandomForests(typename ListSampleType::Pointer trainingListSample,
+  template <class TListSample>
+  void TrainSharkRandomForests(TListSample * trainingListSample,
                                typename TargetListSampleType::Pointer trainingLabeledListSample,
                                std::string modelPath);
   void InitSharkKMeansParams();
-  void TrainSharkKMeans(typename ListSampleType::Pointer trainingListSample,
+  template <class TListSample>
+  void TrainSharkKMeans(TListSample * trainingListSample,
                         typename TargetListSampleType::Pointer trainingLabeledListSample,
                         std::string modelPath);
 #endif
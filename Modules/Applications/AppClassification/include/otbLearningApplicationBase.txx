@@ -25,6 +25,8 @@
 // only need this filter as a dummy process object
 #include "otbRGBAPixelConverter.h"
 
+#include <algorithm>
+
 namespace otb
 {
 namespace Wrapper
@@ -127,6 +129,27 @@ LearningApplicationBase<TInputValue,TOutputValue>
 #endif
 }
 
+template <class TInputValue, class TOutputValue>
+typename LearningApplicationBase<TInputValue,TOutputValue>
+::ModelPointerType
+LearningApplicationBase<TInputValue,TOutputValue>
+::LoadModel(const std::string & modelPath)
+{
+  // load a machine learning model from file
+  ModelPointerType model = ModelFactoryType::CreateMachineLearningModel(modelPath,
+                                                                        ModelFactoryType::ReadMode);
+
+  if (model.IsNull())
+    {
+    otbAppLogFATAL(<< "Error when loading model " << modelPath);
+    }
+
+  model->Load(modelPath);
+  model->SetRegressionMode(this->m_RegressionFlag);
+
+  return model;
+}
+
 template <class TInputValue, class TOutputValue>
 typename LearningApplicationBase<TInputValue,TOutputValue>
 ::TargetListSampleType::Pointer
@@ -142,18 +165,56 @@ LearningApplicationBase<TInputValue,TOutputValue>
   dummyFilter->InvokeEvent(itk::StartEvent());
 
   // load a machine learning model from file and predict the input sample list
-  ModelPointerType model = ModelFactoryType::CreateMachineLearningModel(modelPath,
-                                                                        ModelFactoryType::ReadMode);
+  ModelPointerType model = this->LoadModel(modelPath);
 
-  if (model.IsNull())
+  typename TargetListSampleType::Pointer predictedList = model->PredictBatch(validationListSample, NULL);
+
+  // update reporter
+  dummyFilter->UpdateProgress(1.0f);
+  dummyFilter->InvokeEvent(itk::EndEvent());
+
+  return predictedList;
+}
+
+template <class TInputValue, class TOutputValue>
+typename LearningApplicationBase<TInputValue,TOutputValue>
+::TargetListSampleType::Pointer
+LearningApplicationBase<TInputValue,TOutputValue>
+::Classify(typename ContiguousListSampleType::Pointer validationListSample,
+           std::string modelPath)
+{
+  // Setup fake reporter
+  RGBAPixelConverter<int,int>::Pointer dummyFilter =
+    RGBAPixelConverter<int,int>::New();
+  dummyFilter->SetProgress(0.0f);
+  this->AddProcess(dummyFilter,"Classify...");
+  dummyFilter->InvokeEvent(itk::StartEvent());
+
+  ModelPointerType model = this->LoadModel(modelPath);
+
+  typename TargetListSampleType::Pointer predictedList = TargetListSampleType::New();
+  typename ListSampleType::Pointer chunk = ListSampleType::New();
+  chunk->SetMeasurementVectorSize(validationListSample->GetMeasurementVectorSize());
+
+  // predict the samples chunk by chunk, the labels are appended in order
+  const unsigned long nbSamples = validationListSample->Size();
+  for (unsigned long start = 0; start < nbSamples; start += ClassifyChunkSize)
     {
-    otbAppLogFATAL(<< "Error when loading model " << modelPath);
-    }
+    const unsigned long end = std::min(start + ClassifyChunkSize, nbSamples);
+    chunk->Clear();
+    for (unsigned long id = start; id < end; ++id)
+      {
+      chunk->PushBack(validationListSample->GetMeasurementVector(id));
+      }
 
-  model->Load(modelPath);
-  model->SetRegressionMode(this->m_RegressionFlag);
+    typename TargetListSampleType::Pointer predictedChunk = model->PredictBatch(chunk, NULL);
+    for (unsigned long id = 0; id < predictedChunk->Size(); ++id)
+      {
+      predictedList->PushBack(predictedChunk->GetMeasurementVector(id));
+      }
 
-  typename TargetListSampleType::Pointer predictedList = model->PredictBatch(validationListSample, NULL);
+    dummyFilter->UpdateProgress(static_cast<float>(end) / nbSamples);
+    }
 
   // update reporter
   dummyFilter->UpdateProgress(1.0f);
@@ -168,6 +229,27 @@ LearningApplicationBase<TInputValue,TOutputValue>
 ::Train(typename ListSampleType::Pointer trainingListSample,
         typename TargetListSampleType::Pointer trainingLabeledListSample,
         std::string modelPath)
+{
+  this->TrainModel(trainingListSample.GetPointer(), trainingLabeledListSample, modelPath);
+}
+
+template <class TInputValue, class TOutputValue>
+void
+LearningApplicationBase<TInputValue,TOutputValue>
+::Train(typename ContiguousListSampleType::Pointer trainingListSample,
+        typename TargetListSampleType::Pointer trainingLabeledListSample,
+        std::string modelPath)
+{
+  this->TrainModel(trainingListSample.GetPointer(), trainingLabeledListSample, modelPath);
+}
+
+template <class TInputValue, class TOutputValue>
+template <class TListSample>
+void
+LearningApplicationBase<TInputValue,TOutputValue>
+::TrainModel(TListSample * trainingListSample,
+             typename TargetListSampleType::Pointer trainingLabeledListSample,
+             std::string modelPath)
 {
   // Setup fake reporter
   RGBAPixelConverter<int,int>::Pointer dummyFilter =
@@ -64,16 +64,17 @@ namespace Wrapper
   }
 
   template <class TInputValue, class TOutputValue>
+  template <class TListSample>
   void
   LearningApplicationBase<TInputValue,TOutputValue>
-  ::TrainBoost(typename ListSampleType::Pointer trainingListSample,
+  ::TrainBoost(TListSample * trainingListSample,
                typename TargetListSampleType::Pointer trainingLabeledListSample,
                std::string modelPath)
   {
     typedef otb::BoostMachineLearningModel<InputValueType, OutputValueType> BoostType;
     typename BoostType::Pointer boostClassifier = BoostType::New();
     boostClassifier->SetRegressionMode(this->m_RegressionFlag);
-    boostClassifier->SetInputListSample(trainingListSample);
+    this->SetModelTrainingSamples(boostClassifier, trainingListSample);
     boostClassifier->SetTargetListSample(trainingLabeledListSample);
     boostClassifier->SetBoostType(GetParameterInt("classifier.boost.t"));
     boostClassifier->SetWeakCount(GetParameterInt("classifier.boost.w"));
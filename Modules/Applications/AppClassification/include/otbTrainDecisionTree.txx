@@ -100,16 +100,17 @@ LearningApplicationBase<TInputValue,TOutputValue>
 }
 
 template <class TInputValue, class TOutputValue>
+template <class TListSample>
 void
 LearningApplicationBase<TInputValue,TOutputValue>
-::TrainDecisionTree(typename ListSampleType::Pointer trainingListSample,
+::TrainDecisionTree(TListSample * trainingListSample,
                     typename TargetListSampleType::Pointer trainingLabeledListSample,
                     std::string modelPath)
 {
   typedef otb::DecisionTreeMachineLearningModel<InputValueType, OutputValueType> DecisionTreeType;
   typename DecisionTreeType::Pointer classifier = DecisionTreeType::New();
   classifier->SetRegressionMode(this->m_RegressionFlag);
-  classifier->SetInputListSample(trainingListSample);
+  this->SetModelTrainingSamples(classifier, trainingListSample);
   classifier->SetTargetListSample(trainingLabeledListSample);
   classifier->SetMaxDepth(GetParameterInt("classifier.dt.max"));
   classifier->SetMinSampleCount(GetParameterInt("classifier.dt.min"));
@@ -86,9 +86,10 @@ LearningApplicationBase<TInputValue,TOutputValue>
 }
 
 template <class TInputValue, class TOutputValue>
+template <class TListSample>
 void
 LearningApplicationBase<TInputValue,TOutputValue>
-::TrainGradientBoostedTree(typename ListSampleType::Pointer trainingListSample,
+::TrainGradientBoostedTree(TListSample * trainingListSample,
                            typename TargetListSampleType::Pointer trainingLabeledListSample,
                            std::string modelPath)
 {
@@ -100,7 +101,7 @@ LearningApplicationBase<TInputValue,TOutputValue>
   typedef otb::GradientBoostedTreeMachineLearningModel<InputValueType, OutputValueType> GradientBoostedTreeType;
   typename GradientBoostedTreeType::Pointer classifier = GradientBoostedTreeType::New();
   classifier->SetRegressionMode(this->m_RegressionFlag);
-  classifier->SetInputListSample(trainingListSample);
+  this->SetModelTrainingSamples(classifier, trainingListSample);
   classifier->SetTargetListSample(trainingLabeledListSample);
   classifier->SetWeakCount(GetParameterInt("classifier.gbt.w"));
   classifier->SetShrinkage(GetParameterFloat("classifier.gbt.s"));
@@ -57,16 +57,17 @@ namespace Wrapper
   }
 
   template <class TInputValue, class TOutputValue>
+  template <class TListSample>
   void
   LearningApplicationBase<TInputValue,TOutputValue>
-  ::TrainKNN(typename ListSampleType::Pointer trainingListSample,
+  ::TrainKNN(TListSample * trainingListSample,
              typename TargetListSampleType::Pointer trainingLabeledListSample,
              std::string modelPath)
   {
     typedef otb::KNearestNeighborsMachineLearningModel<InputValueType, OutputValueType> KNNType;
     typename KNNType::Pointer knnClassifier = KNNType::New();
     knnClassifier->SetRegressionMode(this->m_RegressionFlag);
-    knnClassifier->SetInputListSample(trainingListSample);
+    this->SetModelTrainingSamples(knnClassifier, trainingListSample);
     knnClassifier->SetTargetListSample(trainingLabeledListSample);
     knnClassifier->SetK(GetParameterInt("classifier.knn.k"));
     if (this->m_RegressionFlag)
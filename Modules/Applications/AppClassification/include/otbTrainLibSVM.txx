@@ -79,16 +79,17 @@ namespace Wrapper
   }
 
   template <class TInputValue, class TOutputValue>
+  template <class TListSample>
   void
   LearningApplicationBase<TInputValue,TOutputValue>
-  ::TrainLibSVM(typename ListSampleType::Pointer trainingListSample,
+  ::TrainLibSVM(TListSample * trainingListSample,
                 typename TargetListSampleType::Pointer trainingLabeledListSample,
                 std::string modelPath)
   {
     typedef otb::LibSVMMachineLearningModel<InputValueType, OutputValueType> LibSVMType;
     typename LibSVMType::Pointer libSVMClassifier = LibSVMType::New();
     libSVMClassifier->SetRegressionMode(this->m_RegressionFlag);
-    libSVMClassifier->SetInputListSample(trainingListSample);
+    this->SetModelTrainingSamples(libSVMClassifier, trainingListSample);
     libSVMClassifier->SetTargetListSample(trainingLabeledListSample);
     //SVM Option
     //TODO : Add other options ?
@@ -129,16 +129,17 @@ LearningApplicationBase<TInputValue,TOutputValue>
 }
 
 template <class TInputValue, class TOutputValue>
+template <class TListSample>
 void
 LearningApplicationBase<TInputValue,TOutputValue>
-::TrainNeuralNetwork(typename ListSampleType::Pointer trainingListSample,
+::TrainNeuralNetwork(TListSample * trainingListSample,
                      typename TargetListSampleType::Pointer trainingLabeledListSample,
                      std::string modelPath)
 {
   typedef otb::NeuralNetworkMachineLearningModel<InputValueType, OutputValueType> NeuralNetworkType;
   typename NeuralNetworkType::Pointer classifier = NeuralNetworkType::New();
   classifier->SetRegressionMode(this->m_RegressionFlag);
-  classifier->SetInputListSample(trainingListSample);
+  this->SetModelTrainingSamples(classifier, trainingListSample);
   classifier->SetTargetListSample(trainingLabeledListSample);
 
   switch (GetParameterInt("classifier.ann.t"))
@@ -40,16 +40,17 @@ namespace Wrapper
   }
 
   template <class TInputValue, class TOutputValue>
+  template <class TListSample>
   void
   LearningApplicationBase<TInputValue,TOutputValue>
-  ::TrainNormalBayes(typename ListSampleType::Pointer trainingListSample,
+  ::TrainNormalBayes(TListSample * trainingListSample,
                      typename TargetListSampleType::Pointer trainingLabeledListSample,
                      std::string modelPath)
   {
     typedef otb::NormalBayesMachineLearningModel<InputValueType, OutputValueType> NormalBayesType;
     typename NormalBayesType::Pointer classifier = NormalBayesType::New();
     classifier->SetRegressionMode(this->m_RegressionFlag);
-    classifier->SetInputListSample(trainingListSample);
+    this->SetModelTrainingSamples(classifier, trainingListSample);
     classifier->SetTargetListSample(trainingLabeledListSample);
     classifier->Train();
     classifier->Save(modelPath);
@@ -105,16 +105,17 @@ LearningApplicationBase<TInputValue,TOutputValue>
 }
 
 template <class TInputValue, class TOutputValue>
+template <class TListSample>
 void
 LearningApplicationBase<TInputValue,TOutputValue>
-::TrainRandomForests(typename ListSampleType::Pointer trainingListSample,
+::TrainRandomForests(TListSample * trainingListSample,
                      typename TargetListSampleType::Pointer trainingLabeledListSample,
                      std::string modelPath)
 {
   typedef otb::RandomForestsMachineLearningModel<InputValueType, OutputValueType> RandomForestType;
   typename RandomForestType::Pointer classifier = RandomForestType::New();
   classifier->SetRegressionMode(this->m_RegressionFlag);
-  classifier->SetInputListSample(trainingListSample);
+  this->SetModelTrainingSamples(classifier, trainingListSample);
   classifier->SetTargetListSample(trainingLabeledListSample);
   classifier->SetMaxDepth(GetParameterInt("classifier.rf.max"));
   classifier->SetMinSampleCount(GetParameterInt("classifier.rf.min"));
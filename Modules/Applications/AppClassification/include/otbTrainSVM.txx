@@ -109,16 +109,17 @@ namespace Wrapper
   }
 
   template <class TInputValue, class TOutputValue>
+  template <class TListSample>
   void
   LearningApplicationBase<TInputValue,TOutputValue>
-  ::TrainSVM(typename ListSampleType::Pointer trainingListSample,
+  ::TrainSVM(TListSample * trainingListSample,
              typename TargetListSampleType::Pointer trainingLabeledListSample,
              std::string modelPath)
   {
     typedef otb::SVMMachineLearningModel<InputValueType, OutputValueType> SVMType;
     typename SVMType::Pointer SVMClassifier = SVMType::New();
     SVMClassifier->SetRegressionMode(this->m_RegressionFlag);
-    SVMClassifier->SetInputListSample(trainingListSample);
+    this->SetModelTrainingSamples(SVMClassifier, trainingListSample);
     SVMClassifier->SetTargetListSample(trainingLabeledListSample);
     switch (GetParameterInt("classifier.svm.k"))
       {
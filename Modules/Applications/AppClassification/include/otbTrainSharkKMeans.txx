@@ -52,8 +52,9 @@ void LearningApplicationBase<TInputValue, TOutputValue>::InitSharkKMeansParams()
 }
 
 template<class TInputValue, class TOutputValue>
+template <class TListSample>
 void LearningApplicationBase<TInputValue, TOutputValue>::TrainSharkKMeans(
-        typename ListSampleType::Pointer trainingListSample,
+        TListSample * trainingListSample,
         typename TargetListSampleType::Pointer trainingLabeledListSample, std::string modelPath)
 {
   unsigned int nbMaxIter = static_cast<unsigned int>(abs( GetParameterInt( "classifier.sharkkm.maxiter" ) ));
@@ -62,7 +63,7 @@ void LearningApplicationBase<TInputValue, TOutputValue>::TrainSharkKMeans(
   typedef otb::SharkKMeansMachineLearningModel<InputValueType, OutputValueType> SharkKMeansType;
   typename SharkKMeansType::Pointer classifier = SharkKMeansType::New();
   classifier->SetRegressionMode( this->m_RegressionFlag );
-  classifier->SetInputListSample( trainingListSample );
+  this->SetModelTrainingSamples( classifier, trainingListSample );
   classifier->SetTargetListSample( trainingLabeledListSample );
   classifier->SetK( k );
   classifier->SetMaximumNumberOfIterations( nbMaxIter );
@@ -78,16 +78,17 @@ LearningApplicationBase<TInputValue,TOutputValue>
 }
 
 template <class TInputValue, class TOutputValue>
+template <class TListSample>
 void
 LearningApplicationBase<TInputValue,TOutputValue>
-::TrainSharkRandomForests(typename ListSampleType::Pointer trainingListSample,
+::TrainSharkRandomForests(TListSample * trainingListSample,
                           typename TargetListSampleType::Pointer trainingLabeledListSample,
                           std::string modelPath)
 {
   typedef otb::SharkRandomForestsMachineLearningModel<InputValueType, OutputValueType> SharkRandomForestType;
   typename SharkRandomForestType::Pointer classifier = SharkRandomForestType::New();
   classifier->SetRegressionMode(this->m_RegressionFlag);
-  classifier->SetInputListSample(trainingListSample);
+  this->SetModelTrainingSamples(classifier, trainingListSample);
   classifier->SetTargetListSample(trainingLabeledListSample);
   classifier->SetNodeSize(GetParameterInt("classifier.sharkrf.nodesize"));
   classifier->SetOobRatio(GetParameterFloat("classifier.sharkrf.oobr"));
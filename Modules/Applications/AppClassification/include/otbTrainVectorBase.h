@@ -32,7 +32,7 @@
 #include "otbStatisticsXMLFileReader.h"
 
 #include "itkListSample.h"
-#include "otbShiftScaleSampleListFilter.h"
+#include "otbContiguousListSample.h"
 
 #include <algorithm>
 #include <locale>
@@ -62,6 +62,7 @@ public:
 
   typedef Superclass::SampleType SampleType;
   typedef Superclass::ListSampleType ListSampleType;
+  typedef Superclass::ContiguousListSampleType ContiguousListSampleType;
   typedef Superclass::TargetListSampleType TargetListSampleType;
 
   typedef double ValueType;
@@ -69,8 +70,6 @@ public:
 
   typedef otb::StatisticsXMLFileReader<SampleType> StatisticsReader;
 
-  typedef otb::Statistics::ShiftScaleSampleListFilter<ListSampleType, ListSampleType> ShiftScaleFilterType;
-
 protected:
 
   /** Class used to store statistics Measurment (mean/stddev) */
@@ -81,15 +80,16 @@ protected:
     MeasurementType stddevMeasurementVector;
   };
 
-  /** Class used to store a list of sample and the corresponding label */
+  /** Class used to store a list of sample and the corresponding label.
+   * The samples are stored in a single buffer, see ContiguousListSample. */
   class SamplesWithLabel
   {
   public:
-    ListSampleType::Pointer listSample;
+    ContiguousListSampleType::Pointer listSample;
     TargetListSampleType::Pointer labeledListSample;
     SamplesWithLabel()
     {
-      listSample = ListSampleType::New();
+      listSample = ContiguousListSampleType::New();
       labeledListSample = TargetListSampleType::New();
     }
   };
@@ -222,10 +222,33 @@ TrainVectorBase::ExtractSamplesWithLabel(std::string parameterName, std::string
   SamplesWithLabel samplesWithLabel;
   if( HasValue( parameterName ) && IsParameterEnabled( parameterName ) )
     {
-    ListSampleType::Pointer input = ListSampleType::New();
+    if( measurement.meanMeasurementVector.Size() != m_FeaturesInfo.m_NbFeatures
+        || measurement.stddevMeasurementVector.Size() != m_FeaturesInfo.m_NbFeatures )
+      {
+      otbAppLogFATAL( "The statistics have " << measurement.meanMeasurementVector.Size()
+                                             << " components while " << m_FeaturesInfo.m_NbFeatures
+                                             << " features are selected." );
+      }
+
+    // Shift and scale the samples as they are read, with the same float
+    // arithmetic as ShiftScaleSampleListFilter
+    SampleType shifts( measurement.meanMeasurementVector );
+    SampleType invertedScales( measurement.stddevMeasurementVector );
+    for( unsigned int idx = 0; idx < invertedScales.Size(); ++idx )
+      {
+      if( invertedScales[idx] - 1e-10 < 0. )
+        invertedScales[idx] = 0.;
+      else
+        invertedScales[idx] = 1 / invertedScales[idx];
+      }
+
+    ContiguousListSampleType::Pointer input = ContiguousListSampleType::New();
     TargetListSampleType::Pointer target = TargetListSampleType::New();
     input->SetMeasurementVectorSize( m_FeaturesInfo.m_NbFeatures );
 
+    SampleType mv;
+    mv.SetSize( m_FeaturesInfo.m_NbFeatures );
+
     std::vector<std::string> fileList = this->GetParameterStringList( parameterName );
     for( unsigned int k = 0; k < fileList.size(); k++ )
       {
@@ -241,6 +264,13 @@ TrainVectorBase::ExtractSamplesWithLabel(std::string parameterName, std::string
         continue;
         }
 
+      // Allocate the buffer at once when the driver knows the feature count
+      const int nbFeaturesInLayer = layer.GetFeatureCount( false );
+      if( nbFeaturesInLayer > 0 )
+        {
+        input->Reserve( input->Size() + static_cast<unsigned int>( nbFeaturesInLayer ) );
+        }
+
       // Check all needed fields are present :
       //   - check class field if we use supervised classification or if class field name is not empty
       int cFieldIndex = feature.ogr().GetFieldIndex( m_FeaturesInfo.m_SelectedCFieldName.c_str() );
@@ -266,10 +296,11 @@ TrainVectorBase::ExtractSamplesWithLabel(std::string parameterName, std::string
       while( goesOn )
         {
         // Retrieve all the features for each field in the ogr layer.
-        MeasurementType mv;
-        mv.SetSize( m_FeaturesInfo.m_NbFeatures );
         for( unsigned int idx = 0; idx < m_FeaturesInfo.m_NbFeatures; ++idx )
-          mv[idx] = feature.ogr().GetFieldAsDouble( featureFieldIndex[idx] );
+          {
+          const float value = static_cast<float>( feature.ogr().GetFieldAsDouble( featureFieldIndex[idx] ) );
+          mv[idx] = static_cast<float>( ( value - shifts[idx] ) * invertedScales[idx] );
+          }
 
         input->PushBack( mv );
 
@@ -283,17 +314,8 @@ TrainVectorBase::ExtractSamplesWithLabel(std::string parameterName, std::string
         }
       }
 
-
-
-    ShiftScaleFilterType::Pointer shiftScaleFilter = ShiftScaleFilterType::New();
-    shiftScaleFilter->SetInput( input );
-    shiftScaleFilter->SetShifts( measurement.meanMeasurementVector );
-    shiftScaleFilter->SetScales( measurement.stddevMeasurementVector );
-    shiftScaleFilter->Update();
-
-    samplesWithLabel.listSample = shiftScaleFilter->GetOutput();
+    samplesWithLabel.listSample = input;
     samplesWithLabel.labeledListSample = target;
-    samplesWithLabel.listSample->DisconnectPipeline();
     }
 
   return samplesWithLabel;
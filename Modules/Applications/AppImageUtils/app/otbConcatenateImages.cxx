@@ -45,14 +45,6 @@ public:
 
   itkTypeMacro(ConcatenateImages, otb::Application);
 
-  /** Filters typedef */
-  typedef otb::ImageList<FloatImageType>  ImageListType;
-  typedef ImageListToVectorImageFilter<ImageListType,
-                                       FloatVectorImageType >                   ListConcatenerFilterType;
-  typedef MultiToMonoChannelExtractROI<FloatVectorImageType::InternalPixelType,
-                                       FloatImageType::PixelType>               ExtractROIFilterType;
-  typedef ObjectList<ExtractROIFilterType>                                      ExtractROIFilterListType;
-
 private:
   void DoInit() ITK_OVERRIDE
   {
@@ -70,10 +62,6 @@ private:
     AddDocTag("Concatenation");
     AddDocTag("Multi-channel");
 
-    m_Concatener = ListConcatenerFilterType::New();
-    m_ExtractorList = ExtractROIFilterListType::New();
-    m_ImageList = ImageListType::New();
-
     AddParameter(ParameterType_InputImageList,  "il",   "Input images list");
     SetParameterDescription("il", "The list of images to concatenate");
 
@@ -94,29 +82,78 @@ private:
     // Nothing to do here for the parameters : all are independent
 
     // Reinitialize the object
-    m_Concatener = ListConcatenerFilterType::New();
-    m_ImageList = ImageListType::New();
-    m_ExtractorList = ExtractROIFilterListType::New();
+    m_Concatener = ITK_NULLPTR;
+    m_ImageList = ITK_NULLPTR;
+    m_ExtractorList = ITK_NULLPTR;
   }
 
   void DoExecute() ITK_OVERRIDE
   {
-    // Get the input image list
-    FloatVectorImageListType::Pointer inList = this->GetParameterImageList("il");
-
-    if( inList->Size() == 0 )
+    if( this->GetParameterImageList("il")->Size() == 0 )
       {
       itkExceptionMacro("No input Image set...");
       }
 
-    inList->GetNthElement(0)->UpdateOutputInformation();
-    FloatVectorImageType::SizeType size = inList->GetNthElement(0)->GetLargestPossibleRegion().GetSize();
+    // Inputs sharing the same 8 or 16 bits pixel type are concatenated
+    // without conversion to float
+    switch (GetParameterImageListNativePixelType("il"))
+      {
+      case ImagePixelType_uint8:
+        DoExecuteTyped<UInt8VectorImageType>();
+        break;
+      case ImagePixelType_int16:
+        DoExecuteTyped<Int16VectorImageType>();
+        break;
+      case ImagePixelType_uint16:
+        DoExecuteTyped<UInt16VectorImageType>();
+        break;
+      default:
+        DoExecuteTyped<FloatVectorImageType>();
+        break;
+      }
+  }
+
+  /** Get an input image of the list, of the type chosen in DoExecute() */
+  template <class TVectorImageType>
+  TVectorImageType * GetInputImage(unsigned int i)
+  {
+    // The float path uses the images of the list, already read as float
+    TVectorImageType * image =
+      dynamic_cast<TVectorImageType*>(GetParameterImageList("il")->GetNthElement(i).GetPointer());
+    if (image == ITK_NULLPTR)
+      {
+      image = dynamic_cast<TVectorImageType*>(GetParameterNthNativeVectorImage("il", i));
+      }
+    return image;
+  }
+
+  template <class TVectorImageType>
+  void DoExecuteTyped()
+  {
+    typedef typename TVectorImageType::InternalPixelType          InternalPixelType;
+    typedef otb::Image<InternalPixelType>                         ImageType;
+    typedef otb::ImageList<ImageType>                             ImageListType;
+    typedef ImageListToVectorImageFilter<ImageListType,
+                                         TVectorImageType>        ListConcatenerFilterType;
+    typedef MultiToMonoChannelExtractROI<InternalPixelType,
+                                         InternalPixelType>       ExtractROIFilterType;
+    typedef ObjectList<ExtractROIFilterType>                      ExtractROIFilterListType;
+
+    const unsigned int nbImages = this->GetParameterImageList("il")->Size();
+
+    typename ListConcatenerFilterType::Pointer concatener = ListConcatenerFilterType::New();
+    typename ExtractROIFilterListType::Pointer extractorList = ExtractROIFilterListType::New();
+    typename ImageListType::Pointer            imageList = ImageListType::New();
+
+    TVectorImageType * firstIm = this->GetInputImage<TVectorImageType>(0);
+    firstIm->UpdateOutputInformation();
+    typename TVectorImageType::SizeType size = firstIm->GetLargestPossibleRegion().GetSize();
 
     // Split each input vector image into image
     // and generate an mono channel image list
-    for( unsigned int i=0; i<inList->Size(); i++ )
+    for( unsigned int i=0; i<nbImages; i++ )
       {
-      FloatVectorImageType::Pointer vectIm = inList->GetNthElement(i);
+      typename TVectorImageType::Pointer vectIm = this->GetInputImage<TVectorImageType>(i);
       vectIm->UpdateOutputInformation();
       if( size != vectIm->GetLargestPossibleRegion().GetSize() )
         {
@@ -125,25 +162,28 @@ private:
 
       for( unsigned int j=0; j<vectIm->GetNumberOfComponentsPerPixel(); j++)
         {
-        ExtractROIFilterType::Pointer extractor = ExtractROIFilterType::New();
+        typename ExtractROIFilterType::Pointer extractor = ExtractROIFilterType::New();
         extractor->SetInput( vectIm );
         extractor->SetChannel( j+1 );
         extractor->UpdateOutputInformation();
-        m_ExtractorList->PushBack( extractor );
-        m_ImageList->PushBack( extractor->GetOutput() );
+        extractorList->PushBack( extractor );
+        imageList->PushBack( extractor->GetOutput() );
         }
       }
 
 
-    m_Concatener->SetInput( m_ImageList );
+    concatener->SetInput( imageList );
 
-    SetParameterOutputImage("out", m_Concatener->GetOutput());
+    m_Concatener = concatener;
+    m_ExtractorList = extractorList;
+    m_ImageList = imageList;
+    SetParameterOutputImage("out", concatener->GetOutput());
   }
 
 
-  ListConcatenerFilterType::Pointer  m_Concatener;
-  ExtractROIFilterListType::Pointer  m_ExtractorList;
-  ImageListType::Pointer        m_ImageList;
+  itk::ProcessObject::Pointer  m_Concatener;
+  itk::DataObject::Pointer     m_ExtractorList;
+  itk::DataObject::Pointer     m_ImageList;
 };
 
 }
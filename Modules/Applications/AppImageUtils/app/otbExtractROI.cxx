@@ -53,9 +53,7 @@ public:
 
   itkTypeMacro(ExtractROI, otb::Application);
 
-  /** Filters typedef */
-  typedef otb::MultiChannelExtractROI<FloatVectorImageType::InternalPixelType,
-                                      FloatVectorImageType::InternalPixelType> ExtractROIFilterType;
+  typedef InputImageParameter::ImageBaseType  ImageBaseType;
 
 private:
   void DoInit() ITK_OVERRIDE
@@ -126,8 +124,10 @@ private:
     // Update the sizes only if the user has not defined a size
     if ( HasValue("in") )
       {
-      ExtractROIFilterType::InputImageType* inImage = GetParameterImage("in");
-      ExtractROIFilterType::InputImageType::RegionType  largestRegion = inImage->GetLargestPossibleRegion();
+      // The extraction works on the native pixel type of the input, so that
+      // no conversion to float happens between the reader and the writer
+      ImageBaseType* inImage = GetParameterNativeVectorImage("in");
+      ImageBaseType::RegionType  largestRegion = inImage->GetLargestPossibleRegion();
 
       if (!HasUserValue("sizex")  && !HasUserValue("sizey") )
         {
@@ -212,7 +212,7 @@ private:
 
     if ( HasValue("in") )
       {
-        if (region.Crop(GetParameterImage("in")->GetLargestPossibleRegion()))
+        if (region.Crop(GetParameterNativeVectorImage("in")->GetLargestPossibleRegion()))
           {
             SetParameterInt("sizex",region.GetSize(0), HasUserValue("sizex"));
             SetParameterInt("sizey",region.GetSize(1), HasUserValue("sizey"));
@@ -226,7 +226,29 @@ private:
 
   void DoExecute() ITK_OVERRIDE
   {
-    ExtractROIFilterType::InputImageType* inImage = GetParameterImage("in");
+    switch (GetParameterImageNativePixelType("in"))
+      {
+      case ImagePixelType_uint8:
+        DoExecuteTyped<UInt8VectorImageType>(GetParameterUInt8VectorImage("in"));
+        break;
+      case ImagePixelType_int16:
+        DoExecuteTyped<Int16VectorImageType>(GetParameterInt16VectorImage("in"));
+        break;
+      case ImagePixelType_uint16:
+        DoExecuteTyped<UInt16VectorImageType>(GetParameterUInt16VectorImage("in"));
+        break;
+      default:
+        DoExecuteTyped<FloatVectorImageType>(GetParameterFloatVectorImage("in"));
+        break;
+      }
+  }
+
+  template <class TImageType>
+  void DoExecuteTyped(TImageType* inImage)
+  {
+    typedef otb::MultiChannelExtractROI<typename TImageType::InternalPixelType,
+                                        typename TImageType::InternalPixelType> TypedExtractROIFilterType;
+
     inImage->UpdateOutputInformation();
 
 
@@ -293,22 +315,23 @@ private:
       }
 
 
-    m_ExtractROIFilter = ExtractROIFilterType::New();
-    m_ExtractROIFilter->SetInput(inImage);
-    m_ExtractROIFilter->SetStartX(GetParameterInt("startx"));
-    m_ExtractROIFilter->SetStartY(GetParameterInt("starty"));
-    m_ExtractROIFilter->SetSizeX(GetParameterInt("sizex"));
-    m_ExtractROIFilter->SetSizeY(GetParameterInt("sizey"));
+    typename TypedExtractROIFilterType::Pointer extractROIFilter = TypedExtractROIFilterType::New();
+    extractROIFilter->SetInput(inImage);
+    extractROIFilter->SetStartX(GetParameterInt("startx"));
+    extractROIFilter->SetStartY(GetParameterInt("starty"));
+    extractROIFilter->SetSizeX(GetParameterInt("sizex"));
+    extractROIFilter->SetSizeY(GetParameterInt("sizey"));
 
     for (unsigned int idx = 0; idx < GetSelectedItems("cl").size(); ++idx)
       {
-      m_ExtractROIFilter->SetChannel(GetSelectedItems("cl")[idx] + 1 );
+      extractROIFilter->SetChannel(GetSelectedItems("cl")[idx] + 1 );
       }
 
-    SetParameterOutputImage("out", m_ExtractROIFilter->GetOutput());
+    m_ExtractROIFilter = extractROIFilter;
+    SetParameterOutputImage("out", extractROIFilter->GetOutput());
   }
 
-  ExtractROIFilterType::Pointer   m_ExtractROIFilter;
+  itk::ProcessObject::Pointer   m_ExtractROIFilter;
 
 };
 
@@ -44,10 +44,6 @@ public:
 
   itkTypeMacro(SplitImage, Application);
 
-  /** Filters typedef */
-  typedef otb::MultiToMonoChannelExtractROI<FloatVectorImageType::InternalPixelType,
-                                            FloatVectorImageType::InternalPixelType> FilterType;
-
 private:
   void DoInit() ITK_OVERRIDE
   {
@@ -85,8 +81,34 @@ private:
 
   void DoExecute() ITK_OVERRIDE
   {
-    // Get the input image
-    FloatVectorImageType::Pointer inImage = GetParameterImage("in");
+    // The bands are extracted in the native pixel type of the input, so
+    // that no conversion to float happens between the reader and the writers
+    switch (GetParameterImageNativePixelType("in"))
+      {
+      case ImagePixelType_uint8:
+        DoExecuteTyped<UInt8VectorImageType>(GetParameterUInt8VectorImage("in"));
+        break;
+      case ImagePixelType_int16:
+        DoExecuteTyped<Int16VectorImageType>(GetParameterInt16VectorImage("in"));
+        break;
+      case ImagePixelType_uint16:
+        DoExecuteTyped<UInt16VectorImageType>(GetParameterUInt16VectorImage("in"));
+        break;
+      default:
+        DoExecuteTyped<FloatVectorImageType>(GetParameterFloatVectorImage("in"));
+        break;
+      }
+
+    // Disable the output Image parameter to avoid writing
+    // the last image (Application::ExecuteAndWriteOutput method)
+    DisableParameter("out");
+  }
+
+  template <class TImageType>
+  void DoExecuteTyped(TImageType* inImage)
+  {
+    typedef otb::MultiToMonoChannelExtractROI<typename TImageType::InternalPixelType,
+                                              typename TImageType::InternalPixelType> FilterType;
 
     // Get the path/fileWithoutextension/extension of the output images filename
     std::string path, fname, ext;
@@ -98,13 +120,14 @@ private:
     ext   = itksys::SystemTools::GetFilenameExtension(ofname);
 
     // Set the extract filter input image
-    m_Filter = FilterType::New();
-    m_Filter->SetInput(inImage);
+    typename FilterType::Pointer filter = FilterType::New();
+    filter->SetInput(inImage);
+    m_Filter = filter;
 
     for (unsigned int i = 0; i < inImage->GetNumberOfComponentsPerPixel(); ++i)
       {
       // Set the channel to extract
-      m_Filter->SetChannel(i+1);
+      filter->SetChannel(i+1);
 
       // build the current output filename
       std::ostringstream oss;
@@ -124,20 +147,16 @@ private:
       // Set the filename of the current output image
       paramOut->SetFileName(oss.str());
       otbAppLogINFO(<< "File: "<<paramOut->GetFileName() << " will be written.");
-      paramOut->SetValue(m_Filter->GetOutput());
+      paramOut->SetValue(filter->GetOutput());
       paramOut->SetPixelType(this->GetParameterOutputImagePixelType("out"));
       // Add the current level to be written
       paramOut->InitializeWriters();
       AddProcess(paramOut->GetWriter(), osswriter.str());
       paramOut->Write();
       }
-
-    // Disable the output Image parameter to avoid writing
-    // the last image (Application::ExecuteAndWriteOutput method)
-    DisableParameter("out");
   }
 
-  FilterType::Pointer        m_Filter;
+  itk::ProcessObject::Pointer m_Filter;
 };
 }
 }
@@ -887,6 +887,10 @@ private:
           m_SurfaceAdjacencyEffectCorrectionSchemeFilter->SetZenithalViewingAngle(
             m_paramAcqui->GetViewingZenithalAngle());
           m_SurfaceAdjacencyEffectCorrectionSchemeFilter->SetWindowRadius(GetParameterInt("atmo.radius"));
+#if defined ITK_USE_FFTWD
+          // Large windows are cheaper to process in the Fourier domain
+          m_SurfaceAdjacencyEffectCorrectionSchemeFilter->SetUseFFT(GetParameterInt("atmo.radius") > 8);
+#endif
           m_SurfaceAdjacencyEffectCorrectionSchemeFilter->
             SetPixelSpacingInKilometers(GetParameterFloat("atmo.pixsize"));
 
@@ -28,6 +28,7 @@
 #include "itkChangeLabelImageFilter.h"
 
 #include "otbTileImageFilter.h"
+#include "otbRegionAdjacencyGraph.h"
 
 #include <time.h>
 #include <vcl_algorithm.h>
@@ -43,6 +44,36 @@ namespace otb
 {
 namespace Wrapper
 {
+
+/** Cost of the merge of two adjacent regions. The pairs with a region
+ *  smaller than the minimum size are merged by increasing size of their
+ *  smallest region, then by increasing spectral distance. The other
+ *  pairs, and the pairs with the label 0, cost the minimum size and are
+ *  never merged. */
+class SmallRegionsMergingCost
+{
+public:
+  typedef RegionAdjacencyGraph<UInt32ImageType::InternalPixelType> GraphType;
+  typedef GraphType::LabelType                                     LabelType;
+
+  explicit SmallRegionsMergingCost(unsigned int minSize) : m_MinSize(minSize) {}
+
+  double operator()(const GraphType & graph, LabelType region1, LabelType region2) const
+  {
+    const unsigned long size = vcl_min(graph.GetSize(region1), graph.GetSize(region2));
+    if (region1 == 0 || region2 == 0 || size >= m_MinSize)
+      {
+      return m_MinSize;
+      }
+    // the distance term is in [0, 0.5[, so that the sizes are compared first
+    const double distance = graph.GetSquaredMeanDistance(region1, region2);
+    return size + 0.5 * distance / (1. + distance);
+  }
+
+private:
+  unsigned int m_MinSize;
+};
+
 class LSMSSmallRegionsMerging : public Application
 {
 public:
@@ -56,6 +87,8 @@ public:
   typedef UInt32ImageType                   LabelImageType;
   typedef LabelImageType::InternalPixelType LabelImagePixelType;
 
+  typedef SmallRegionsMergingCost::GraphType GraphType;
+
   typedef otb::MultiChannelExtractROI <ImagePixelType,ImagePixelType > MultiChannelExtractROIFilterType;
   typedef otb::ExtractROI<LabelImagePixelType,LabelImagePixelType> ExtractROIFilterType;
 
@@ -79,7 +112,7 @@ private:
     SetDescription("Third (optional) step of the exact Large-Scale Mean-Shift segmentation workflow.");
 
     SetDocName("Exact Large-Scale Mean-Shift segmentation, step 3 (optional)");
-    SetDocLongDescription("This application performs the third step of the exact Large-Scale Mean-Shift segmentation workflow (LSMS). Given a segmentation result (label image) and the original image, it will merge regions whose size in pixels is lower than minsize parameter with the adjacent regions with the adjacent region with closest radiometry and acceptable size. Small regions will be processed by size: first all regions of area, which is equal to 1 pixel will be merged with adjacent region, then all regions of area equal to 2 pixels, until regions of area minsize. For large images one can use the nbtilesx and nbtilesy parameters for tile-wise processing, with the guarantees of identical results.");
+    SetDocLongDescription("This application performs the third step of the exact Large-Scale Mean-Shift segmentation workflow (LSMS). Given a segmentation result (label image) and the original image, it will merge regions whose size in pixels is lower than minsize parameter with the adjacent region with closest radiometry. Small regions are processed by increasing size: the smallest region is merged first with its closest adjacent region, the merged region takes the size and the mean radiometry of both, and so on until all regions have a size of at least minsize pixels. For large images one can use the tilesizex and tilesizey parameters to read the images tile by tile, with the guarantees of identical results.");
     SetDocLimitations("This application is part of the Large-Scale Mean-Shift segmentation workflow (LSMS) and may not be suited for any other purpose.");
     SetDocAuthors("David Youssefi");
     SetDocSeeAlso("LSMSSegmentation, LSMSVectorization, MeanShiftSmoothing");
@@ -153,24 +186,17 @@ private:
     stats->Update();
     unsigned int regionCount=stats->GetMaximum();
 
-    std::vector<unsigned int>nbPixels;
-    nbPixels.clear();
-    nbPixels.resize(regionCount+1);
-    for(LabelImagePixelType curLabel = 1; curLabel <= regionCount; ++curLabel)
-      nbPixels[curLabel] = 0;
-
-    ImageType::PixelType defaultValue(numberOfComponentsPerPixel);
-    defaultValue.Fill(0);
-
-    std::vector<ImageType::PixelType>sum(regionCount+1,defaultValue);
-
     unsigned int nbTilesX = sizeImageX/sizeTilesX + (sizeImageX%sizeTilesX > 0 ? 1 : 0);
     unsigned int nbTilesY = sizeImageY/sizeTilesY + (sizeImageY%sizeTilesY > 0 ? 1 : 0);
 
     otbAppLogINFO(<<"Number of tiles: "<<nbTilesX<<" x "<<nbTilesY);
 
-    //Sums calculation per label
-    otbAppLogINFO(<<"Sums calculation ...");
+    // Region adjacency graph of the whole segmentation, with the size and
+    // the sums of the pixel values of each region
+    GraphType graph;
+    graph.Initialize(regionCount+1, numberOfComponentsPerPixel);
+
+    otbAppLogINFO(<<"Building the region adjacency graph ...");
 
     for(unsigned int row = 0; row < nbTilesY; row++)
       for(unsigned int column = 0; column < nbTilesX; column++)
@@ -189,230 +215,54 @@ private:
         imageROI->SetSizeY(sizeY);
         imageROI->Update();
 
-        //Tiles extraction of the segmented image
+        //Tiles extraction of the segmented image, with the next row and
+        //column so that the adjacencies across the tile borders are found
         ExtractROIFilterType::Pointer labelImageROI = ExtractROIFilterType::New();
         labelImageROI->SetInput(labelIn);
         labelImageROI->SetStartX(startX);
         labelImageROI->SetStartY(startY);
-        labelImageROI->SetSizeX(sizeX);
-        labelImageROI->SetSizeY(sizeY);
+        labelImageROI->SetSizeX(vcl_min(sizeX+1,sizeImageX-startX));
+        labelImageROI->SetSizeY(vcl_min(sizeY+1,sizeImageY-startY));
         labelImageROI->Update();
 
-        //Sums calculation for the mean calculation per label
-        LabelImageIterator itLabel( labelImageROI->GetOutput(), labelImageROI->GetOutput()->GetLargestPossibleRegion());
+        LabelImageType::RegionType tileRegion = labelImageROI->GetOutput()->GetLargestPossibleRegion();
+        LabelImageType::SizeType tileSize;
+        tileSize[0] = sizeX;
+        tileSize[1] = sizeY;
+        tileRegion.SetSize(tileSize);
+
+        graph.AddAdjacencies(labelImageROI->GetOutput(), tileRegion);
+
+        //Statistics of the regions
+        LabelImageIterator itLabel( labelImageROI->GetOutput(), tileRegion);
         ImageIterator itImage( imageROI->GetOutput(), imageROI->GetOutput()->GetLargestPossibleRegion());
 
         for (itLabel.GoToBegin(), itImage.GoToBegin(); !itLabel.IsAtEnd(); ++itLabel, ++itImage)
           {
-          nbPixels[itLabel.Value()]++;
-          for(unsigned int comp = 0; comp<numberOfComponentsPerPixel; ++comp)
-            {
-            sum[itLabel.Value()][comp]+=itImage.Get()[comp];
-            }
+          graph.AddPixel(itLabel.Get(), itImage.Get());
           }
         }
 
-    //LUT creation for the final relabelling
-    std::vector<LabelImagePixelType> LUT;
-    LUT.clear();
-    LUT.resize(regionCount+1);
-    for(LabelImagePixelType curLabel = 1; curLabel <= regionCount; ++curLabel)
-      {
-      LUT[curLabel] = curLabel;
-      }
+    graph.BuildAdjacency();
 
-    //Minimal size region suppression
-    otbAppLogINFO(<<"Building LUT for small regions merging ...");
+    //Minimal size region suppression: the small regions are merged by
+    //increasing size with their adjacent region of closest radiometry
+    otbAppLogINFO(<<"Merging the small regions ...");
 
-    for (unsigned int size=1; size<minSize; size++)
-      {
-      // LUTtmp creation in order to modify the LUT only at the end of the pass
-      std::vector<LabelImagePixelType> LUTtmp;
-      LUTtmp.clear();
-      LUTtmp.resize(regionCount+1);
-      for(LabelImagePixelType curLabel = 1; curLabel <= regionCount; ++curLabel)
-        {
-        LUTtmp[curLabel] = LUT[curLabel];
-        }
+    SmallRegionsMergingCost cost(minSize);
+    const unsigned long nbMerges = graph.MergeByPriority(cost, minSize);
 
-      for(unsigned int row = 0; row < nbTilesY; row++)
-        {
-        for(unsigned int column = 0; column < nbTilesX; column++)
-          {
-          std::set<int> minLabel, edgeLabel, labelMerged;
-          std::map<int,std::set<int> > adjMap;
-
-          unsigned long startX = column*sizeTilesX, startY = row*sizeTilesY;
-          unsigned long sizeX = vcl_min(sizeTilesX+size+1,sizeImageX-startX),
-            sizeY = vcl_min(sizeTilesY+size+1,sizeImageY-startY);
-
-          ExtractROIFilterType::Pointer labelImageROI = ExtractROIFilterType::New();
-          labelImageROI->SetInput(labelIn);
-          labelImageROI->SetStartX(startX);
-          labelImageROI->SetStartY(startY);
-          labelImageROI->SetSizeX(sizeX);
-          labelImageROI->SetSizeY(sizeY);
-          labelImageROI->Update();
-
-          LabelImageType::IndexType pixelIndex;
-
-          //"Adjacency map" creation for the region with nbPixels=="size"
-          for(pixelIndex[0]=0; pixelIndex[0]<static_cast<long>(sizeX); ++pixelIndex[0])
-            for(pixelIndex[1]=0; pixelIndex[1]<static_cast<long>(sizeY); ++pixelIndex[1])
-              {
-              LabelImagePixelType curLabel = labelImageROI->GetOutput()->GetPixel(pixelIndex);
-
-              if(labelMerged.count(LUT[curLabel]))
-                {
-                edgeLabel.insert(LUT[curLabel]);
-                }
-              if((pixelIndex[0]==0)&&(startX!=0))
-                {
-                edgeLabel.insert(LUT[curLabel]);
-                }
-              if((pixelIndex[1]==0)&&(startY!=0))
-                {
-                edgeLabel.insert(LUT[curLabel]);
-                }
-
-              if(pixelIndex[0]==static_cast<long>(sizeX)-1)
-                {
-                if(startX!=(nbTilesX-1)*sizeTilesX) edgeLabel.insert(LUT[curLabel]);
-                }
-              else
-                {
-                ++pixelIndex[0];
-                LabelImagePixelType adjLabelX = labelImageROI->GetOutput()->GetPixel(pixelIndex);
-                --pixelIndex[0];
-
-                if(LUT[adjLabelX]!=LUT[curLabel])
-                  {
-                  if((nbPixels[LUT[curLabel]]>0)&&(nbPixels[LUT[curLabel]]==size))
-                    {
-                    adjMap[LUT[curLabel]].insert(LUT[adjLabelX]);
-                    minLabel.insert(LUT[curLabel]);
-                    }
-                  if((nbPixels[LUT[adjLabelX]]>0)&&(nbPixels[LUT[adjLabelX]]==size))
-                    {
-                    adjMap[LUT[adjLabelX]].insert(LUT[curLabel]);
-                    minLabel.insert(LUT[adjLabelX]);
-                    }
-                  }
-                }
-              if(pixelIndex[1]==static_cast<long>(sizeY)-1)
-                {
-                if(startY!=(nbTilesY-1)*sizeTilesY) edgeLabel.insert(LUT[curLabel]);
-                }
-              else
-                {
-                ++pixelIndex[1];
-                LabelImagePixelType adjLabelY = labelImageROI->GetOutput()->GetPixel(pixelIndex);
-                --pixelIndex[1];
-                if(LUT[adjLabelY]!=LUT[curLabel])
-                  {
-                  if((nbPixels[LUT[curLabel]]>0)&&(nbPixels[LUT[curLabel]]==size))
-                    {
-                    adjMap[LUT[curLabel]].insert(LUT[adjLabelY]);
-                    minLabel.insert(LUT[curLabel]);
-                    }
-                  if((nbPixels[LUT[adjLabelY]]>0)&&(nbPixels[LUT[adjLabelY]]==size))
-                    {
-                    adjMap[LUT[adjLabelY]].insert(LUT[curLabel]);
-                    minLabel.insert(LUT[adjLabelY]); }
-                  }
-                }
-              }
-
-          //Searching the "nearest" region
-          for(std::set<int>::iterator itMinLabel=minLabel.begin(); itMinLabel!=minLabel.end(); ++itMinLabel)
-            {
-            LabelImagePixelType curLabel = *itMinLabel, adjLabel(0);
-            double err = itk::NumericTraits<double>::max();
-            if(edgeLabel.count(curLabel)==0)
-              {
-              if(nbPixels[curLabel]==size)
-                {
-                edgeLabel.insert(curLabel);
-                for(std::set<int>::iterator itAdjLabel=(adjMap[curLabel]).begin();
-                    itAdjLabel!=(adjMap[curLabel]).end(); ++itAdjLabel)
-                  {
-                  double tmpError = 0;
-                  LabelImagePixelType tmpLabel = *itAdjLabel;
-                  if(tmpLabel!=curLabel)
-                    {
-                    for(unsigned int comp = 0; comp<numberOfComponentsPerPixel; ++comp)
-                      {
-                      double curComp = static_cast<double>(sum[curLabel][comp])/nbPixels[curLabel];
-                      int tmpComp = static_cast<double>(sum[tmpLabel][comp])/nbPixels[tmpLabel];
-                      tmpError += (curComp-tmpComp)*(curComp-tmpComp);
-                      }
-                    if(tmpError<err)
-                      {
-                      err = tmpError;
-                      adjLabel = tmpLabel;
-                      }
-                    }
-                  }
-
-                //Fusion of the two regions
-                if(adjLabel!=curLabel)
-                  {
-                  unsigned int curLabelLUT = curLabel, adjLabelLUT = adjLabel;
-                  while(LUTtmp[curLabelLUT] != curLabelLUT)
-                    {
-                    curLabelLUT = LUTtmp[curLabelLUT];
-                    }
-                  while(LUTtmp[adjLabelLUT] != adjLabelLUT)
-                    {
-                    adjLabelLUT = LUTtmp[adjLabelLUT];
-                    }
-                  if(curLabelLUT < adjLabelLUT)
-                    {
-                    LUTtmp[adjLabelLUT] = curLabelLUT;
-                    }
-                  else
-                    {
-                    LUTtmp[LUTtmp[curLabelLUT]] = adjLabelLUT; LUTtmp[curLabelLUT] = adjLabelLUT;
-                    }
-                  }
-                }
-              }
-            }
-
-          for(LabelImagePixelType label = 1; label < regionCount+1; ++label)
-            {
-            LabelImagePixelType can = label;
-            while(LUTtmp[can] != can)
-              {
-              can = LUTtmp[can];
-              }
-            LUTtmp[label] = can;
-            }
-          }
-        }
+    otbAppLogINFO(<<"Number of merged regions: "<<nbMerges);
 
-      for(LabelImagePixelType label = 1; label < regionCount+1; ++label)
-        {
-        LUT[label]=LUTtmp[label];
-        if((nbPixels[label]!=0)&&(LUT[label]!=label))
-          {
-          nbPixels[LUT[label]]+=nbPixels[label];
-          nbPixels[label]=0;
-          for(unsigned int comp = 0; comp<numberOfComponentsPerPixel; ++comp)
-            {
-            sum[LUT[label]][comp]+=sum[label][comp];
-            }
-          }
-        }
-      }
     //Relabelling
     m_ChangeLabelFilter = ChangeLabelImageFilterType::New();
     m_ChangeLabelFilter->SetInput(labelIn);
     for(LabelImagePixelType label = 1; label<regionCount+1; ++label)
       {
-      if(label!=LUT[label])
+      const LabelImagePixelType region = graph.GetRegion(label);
+      if(label!=region)
         {
-        m_ChangeLabelFilter->SetChange(label,LUT[label]);
+        m_ChangeLabelFilter->SetChange(label,region);
         }
       }
 
@@ -84,6 +84,72 @@ public:
    */
   static RAMValueType GetMaxRAMHint();
 
+  /**
+   * SIXSCacheFile is the path to a file where the atmospheric
+   * radiative terms computed by 6S are persisted between runs.
+   *
+   * If environment variable OTB_6S_CACHE_FILE is defined,
+   * returns it contents as a string
+   * Else, returns an empty string (cache is kept in memory only)
+   */
+  static std::string GetSIXSCacheFile();
+
+  /**
+   * ProfileTraceFile is the path to a JSON file where applications
+   * write the execution time of each filter of their pipelines, in
+   * the Chrome trace format (see PipelineProfiler).
+   *
+   * If environment variable OTB_PROFILE_TRACE_FILE is defined,
+   * returns it contents as a string
+   * Else, returns an empty string (profiling is disabled)
+   */
+  static std::string GetProfileTraceFile();
+
+  /**
+   * ThreadPoolSize is the number of persistent worker threads of the
+   * ThreadPool used by the filters which support it. When the pool is
+   * disabled, these filters use the ITK MultiThreader as usual.
+   *
+   * If environment variable OTB_THREAD_POOL_SIZE is defined and could be
+   * converted to int, return its content.
+   * Else, returns 0 (the pool is disabled)
+   */
+  static unsigned int GetThreadPoolSize();
+
+  /**
+   * ThreadPoolChunksPerThread is the number of region chunks per worker
+   * thread when a filter runs on the ThreadPool. More chunks give a
+   * better load balancing on uneven filters, at the cost of a larger
+   * overhead per chunk.
+   *
+   * If environment variable OTB_THREAD_POOL_CHUNKS is defined and could be
+   * converted to int, return its content.
+   * Else, returns default value, which is 16
+   */
+  static unsigned int GetThreadPoolChunksPerThread();
+
+  /**
+   * GDALReadThreads is the number of threads used by GDALImageIO to
+   * decode the blocks of a compressed image (JPEG2000, or compressed
+   * GeoTIFF) within a single read. 1 disables the parallel reads.
+   *
+   * If environment variable OTB_GDAL_READ_THREADS is defined and could be
+   * converted to int, return its content.
+   * Else, returns 0 (the default number of threads of ITK is used)
+   */
+  static unsigned int GetGDALReadThreads();
+
+  /**
+   * GDALWriteThreads is the number of threads used by GDAL to compress
+   * the blocks of a GeoTIFF written by GDALImageIO, unless the creation
+   * options already set NUM_THREADS. 1 disables the parallel encoding.
+   *
+   * If environment variable OTB_GDAL_WRITE_THREADS is defined and could be
+   * converted to int, return its content.
+   * Else, returns 0 (the default number of threads of ITK is used)
+   */
+  static unsigned int GetGDALWriteThreads();
+
 private:
   ConfigurationManager(); //purposely not implemented
   ~ConfigurationManager(); //purposely not implemented
@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbImageRegionCostBalancedSplitter_h
+#define otbImageRegionCostBalancedSplitter_h
+
+#include "itkRegion.h"
+#include "itkImageRegionSplitter.h"
+#include "itkObjectFactory.h"
+#include "itkSimpleFastMutexLock.h"
+
+#include <vector>
+
+namespace otb
+{
+
+/** \class ImageRegionCostBalancedSplitter
+ * \brief Divide a region into strips of equal processing cost.
+ *
+ * The usual splitters give the same number of pixels to each piece,
+ * whatever the cost of processing them: with a mask, no-data borders or
+ * a filter converging at a variable speed, some threads get almost no
+ * work while the others get the whole of it.
+ *
+ * This splitter divides a region along its last dimension (the lines of
+ * an image), so that the estimated costs of the pieces are as close as
+ * possible. The cost of each line is given by a cost profile, which can
+ * be set:
+ * - directly with SetCostProfile(), possibly at a lower resolution than
+ *   the region (each sample covers a block of consecutive lines),
+ * - from a mask with SetMaskImage(): a pixel in the mask costs 1, a
+ *   pixel outside the mask costs MaskedPixelCost,
+ * - from a cost image with SetCostImage(): the cost of a pixel is its
+ *   value.
+ *
+ * The profile is refined with AddRegionTiming(), which records the time
+ * actually spent on a piece: the lines of the piece then get the
+ * measured cost, and the other lines keep their estimated cost, scaled
+ * with the average time per cost unit of the timed pieces.
+ *
+ * Without a profile, or if the profile gives a null cost to the region,
+ * the region is split into strips of the same height. Lines outside the
+ * reference region of the profile get the average line cost.
+ *
+ * The splitter can be returned by GetImageRegionSplitter() in a filter
+ * (to balance its threads) or used by a streaming manager.
+ *
+ * \sa ImageRegionAdaptativeSplitter
+ *
+ * \ingroup OTBCommon
+ */
+template <unsigned int VImageDimension>
+class ITK_EXPORT ImageRegionCostBalancedSplitter : public itk::ImageRegionSplitter<VImageDimension>
+{
+public:
+  /** Standard class typedefs. */
+  typedef ImageRegionCostBalancedSplitter           Self;
+  typedef itk::ImageRegionSplitter<VImageDimension> Superclass;
+  typedef itk::SmartPointer<Self>                   Pointer;
+  typedef itk::SmartPointer<const Self>             ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ImageRegionCostBalancedSplitter, itk::Object);
+
+  /** Dimension of the image available at compile time. */
+  itkStaticConstMacro(ImageDimension, unsigned int, VImageDimension);
+
+  /** Index typedef support. An index is used to access pixel values. */
+  typedef itk::Index<VImageDimension>        IndexType;
+  typedef typename IndexType::IndexValueType IndexValueType;
+
+  /** Size typedef support. A size is used to define region bounds. */
+  typedef itk::Size<VImageDimension>       SizeType;
+  typedef typename SizeType::SizeValueType SizeValueType;
+
+  /** Region typedef support.   */
+  typedef itk::ImageRegion<VImageDimension> RegionType;
+
+  /** Cost of each sample of a profile */
+  typedef std::vector<double> CostProfileType;
+
+  /** How many pieces can the specified region be split? At most one per
+   * line. */
+  unsigned int GetNumberOfSplits(const RegionType& region,
+                                 unsigned int requestedNumber) ITK_OVERRIDE;
+
+  /** Get the ith strip of the region split in numberOfPieces strips of
+   * equal cost. */
+  RegionType GetSplit(unsigned int i, unsigned int numberOfPieces,
+                      const RegionType& region) ITK_OVERRIDE;
+
+  /** Reset the profile to a uniform cost (the width of each line) on the
+   * lines of the given region. Timings are cleared. */
+  void SetReferenceRegion(const RegionType & region);
+
+  /** Set the cost profile of the reference region. The profile has
+   * between 1 and one sample per line of the region: sample k covers the
+   * lines [k*n/K, (k+1)*n/K[, and its cost is shared between them.
+   * Timings are cleared. */
+  void SetCostProfile(const RegionType & region, const CostProfileType & profile);
+
+  /** Clear the profile and the timings */
+  void ClearCostProfile();
+
+  /** Set the profile from a mask, over the requested region of the mask:
+   * pixels with a value greater than 0 cost 1, the other ones cost
+   * MaskedPixelCost. */
+  template <class TMaskImage>
+  void SetMaskImage(const TMaskImage * mask);
+
+  /** Set the profile from a scalar cost image, over its requested region:
+   * the cost of a pixel is its value (negative values are ignored). */
+  template <class TCostImage>
+  void SetCostImage(const TCostImage * costImage);
+
+  /** Record the time (or any measure of the cost) spent on a region.
+   * If there is no profile yet, the region becomes the reference. */
+  void AddRegionTiming(const RegionType & region, double seconds);
+
+  /** Get the cost of a line, as used for the splits */
+  double GetLineCost(IndexValueType line) const;
+
+  /** Get the estimated cost of a region */
+  double GetRegionCost(const RegionType & region) const;
+
+  /** Set/Get the cost of a pixel outside the mask (default is 0.05) */
+  itkSetMacro(MaskedPixelCost, double);
+  itkGetConstMacro(MaskedPixelCost, double);
+
+  itkGetConstReferenceMacro(ReferenceRegion, RegionType);
+
+protected:
+  ImageRegionCostBalancedSplitter();
+  ~ImageRegionCostBalancedSplitter() ITK_OVERRIDE {}
+  void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
+
+private:
+  ImageRegionCostBalancedSplitter(const ImageRegionCostBalancedSplitter &); //purposely not implemented
+  void operator =(const ImageRegionCostBalancedSplitter&); //purposely not implemented
+
+  /** Compute the boundaries of the strips, if not in the cache */
+  void UpdateBoundaries(const RegionType & region, unsigned int numberOfPieces);
+
+  /** Average cost of the lines of the reference region */
+  double GetAverageLineCost() const;
+
+  /** Cost of a line, given the average line cost used outside the
+   * reference region */
+  double ComputeLineCost(IndexValueType line, double averageCost) const;
+
+  /** Number of pixels in a line (along the last dimension) of a region */
+  static SizeValueType GetLineWidth(const RegionType & region);
+
+  /** Estimated cost of each line of the reference region */
+  CostProfileType m_LineCosts;
+
+  /** Sum and number of the timings of each line */
+  CostProfileType           m_LineTimings;
+  std::vector<unsigned int> m_LineTimingCounts;
+
+  /** Sum of the timings and of the estimated cost of the timed lines */
+  double m_TimedCost;
+  double m_TimedEstimatedCost;
+
+  RegionType m_ReferenceRegion;
+
+  double m_MaskedPixelCost;
+
+  /** Cache of the boundaries of the last split region. GetSplit() can be
+   * called concurrently from the threads of a filter. */
+  RegionType                  m_CachedRegion;
+  unsigned int                m_CachedNumberOfPieces;
+  std::vector<SizeValueType>  m_Boundaries;
+  itk::SimpleFastMutexLock    m_CacheLock;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+# include "otbImageRegionCostBalancedSplitter.txx"
+#endif
+
+#endif
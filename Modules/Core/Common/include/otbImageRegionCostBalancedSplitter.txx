@@ -0,0 +1,396 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbImageRegionCostBalancedSplitter_txx
+#define otbImageRegionCostBalancedSplitter_txx
+
+#include "otbImageRegionCostBalancedSplitter.h"
+#include "otbMacro.h"
+#include "itkImageRegionConstIterator.h"
+
+#include <algorithm>
+
+namespace otb
+{
+
+template <unsigned int VImageDimension>
+ImageRegionCostBalancedSplitter<VImageDimension>
+::ImageRegionCostBalancedSplitter()
+  : m_TimedCost(0.),
+    m_TimedEstimatedCost(0.),
+    m_MaskedPixelCost(0.05),
+    m_CachedNumberOfPieces(0)
+{
+}
+
+template <unsigned int VImageDimension>
+typename ImageRegionCostBalancedSplitter<VImageDimension>::SizeValueType
+ImageRegionCostBalancedSplitter<VImageDimension>
+::GetLineWidth(const RegionType & region)
+{
+  SizeValueType width = 1;
+  for (unsigned int j = 0; j < VImageDimension - 1; ++j)
+    {
+    width *= region.GetSize(j);
+    }
+  return width;
+}
+
+template <unsigned int VImageDimension>
+void
+ImageRegionCostBalancedSplitter<VImageDimension>
+::SetReferenceRegion(const RegionType & region)
+{
+  this->SetCostProfile(region,
+                       CostProfileType(region.GetSize(VImageDimension - 1),
+                                       static_cast<double>(GetLineWidth(region))));
+}
+
+template <unsigned int VImageDimension>
+void
+ImageRegionCostBalancedSplitter<VImageDimension>
+::SetCostProfile(const RegionType & region, const CostProfileType & profile)
+{
+  const SizeValueType nbLines = region.GetSize(VImageDimension - 1);
+
+  if (profile.empty() || profile.size() > nbLines)
+    {
+    itkExceptionMacro(<< "The cost profile has " << profile.size() << " samples, it should have between 1 and "
+                      << nbLines << " samples (one per line at most)");
+    }
+
+  m_CacheLock.Lock();
+
+  m_ReferenceRegion = region;
+  m_LineCosts.assign(nbLines, 0.);
+  m_LineTimings.assign(nbLines, 0.);
+  m_LineTimingCounts.assign(nbLines, 0);
+  m_TimedCost = 0.;
+  m_TimedEstimatedCost = 0.;
+
+  // Share the cost of each sample between the lines it covers
+  const SizeValueType nbSamples = profile.size();
+  for (SizeValueType k = 0; k < nbSamples; ++k)
+    {
+    const SizeValueType begin = k * nbLines / nbSamples;
+    const SizeValueType end = (k + 1) * nbLines / nbSamples;
+    const double lineCost = std::max(profile[k], 0.) / static_cast<double>(end - begin);
+    for (SizeValueType l = begin; l < end; ++l)
+      {
+      m_LineCosts[l] = lineCost;
+      }
+    }
+
+  m_CachedNumberOfPieces = 0;
+  m_CacheLock.Unlock();
+
+  this->Modified();
+}
+
+template <unsigned int VImageDimension>
+void
+ImageRegionCostBalancedSplitter<VImageDimension>
+::ClearCostProfile()
+{
+  m_CacheLock.Lock();
+  m_ReferenceRegion = RegionType();
+  m_LineCosts.clear();
+  m_LineTimings.clear();
+  m_LineTimingCounts.clear();
+  m_TimedCost = 0.;
+  m_TimedEstimatedCost = 0.;
+  m_CachedNumberOfPieces = 0;
+  m_CacheLock.Unlock();
+
+  this->Modified();
+}
+
+template <unsigned int VImageDimension>
+template <class TMaskImage>
+void
+ImageRegionCostBalancedSplitter<VImageDimension>
+::SetMaskImage(const TMaskImage * mask)
+{
+  const RegionType    region = mask->GetRequestedRegion();
+  const SizeValueType width = GetLineWidth(region);
+
+  CostProfileType profile(region.GetSize(VImageDimension - 1), 0.);
+
+  // Pixels are visited line by line
+  itk::ImageRegionConstIterator<TMaskImage> it(mask, region);
+  SizeValueType pixel = 0;
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it, ++pixel)
+    {
+    profile[pixel / width] += (it.Get() > 0) ? 1. : m_MaskedPixelCost;
+    }
+
+  this->SetCostProfile(region, profile);
+}
+
+template <unsigned int VImageDimension>
+template <class TCostImage>
+void
+ImageRegionCostBalancedSplitter<VImageDimension>
+::SetCostImage(const TCostImage * costImage)
+{
+  const RegionType    region = costImage->GetRequestedRegion();
+  const SizeValueType width = GetLineWidth(region);
+
+  CostProfileType profile(region.GetSize(VImageDimension - 1), 0.);
+
+  itk::ImageRegionConstIterator<TCostImage> it(costImage, region);
+  SizeValueType pixel = 0;
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it, ++pixel)
+    {
+    profile[pixel / width] += std::max(static_cast<double>(it.Get()), 0.);
+    }
+
+  this->SetCostProfile(region, profile);
+}
+
+template <unsigned int VImageDimension>
+void
+ImageRegionCostBalancedSplitter<VImageDimension>
+::AddRegionTiming(const RegionType & region, double seconds)
+{
+  const unsigned int dim = VImageDimension - 1;
+
+  if (m_LineCosts.empty())
+    {
+    this->SetReferenceRegion(region);
+    }
+
+  const SizeValueType nbLines = region.GetSize(dim);
+  if (nbLines == 0 || GetLineWidth(region) == 0)
+    {
+    return;
+    }
+
+  // Cost of a whole line of the reference region
+  const double lineTiming = seconds / static_cast<double>(nbLines)
+    * static_cast<double>(GetLineWidth(m_ReferenceRegion)) / static_cast<double>(GetLineWidth(region));
+
+  m_CacheLock.Lock();
+
+  const IndexValueType refStart = m_ReferenceRegion.GetIndex(dim);
+  const IndexValueType refEnd = refStart + static_cast<IndexValueType>(m_ReferenceRegion.GetSize(dim));
+  const IndexValueType start = std::max(region.GetIndex(dim), refStart);
+  const IndexValueType end = std::min(region.GetIndex(dim) + static_cast<IndexValueType>(nbLines), refEnd);
+
+  for (IndexValueType line = start; line < end; ++line)
+    {
+    const SizeValueType k = static_cast<SizeValueType>(line - refStart);
+    if (m_LineTimingCounts[k] > 0)
+      {
+      m_TimedCost -= m_LineTimings[k] / m_LineTimingCounts[k];
+      }
+    else
+      {
+      m_TimedEstimatedCost += m_LineCosts[k];
+      }
+    m_LineTimings[k] += lineTiming;
+    ++m_LineTimingCounts[k];
+    m_TimedCost += m_LineTimings[k] / m_LineTimingCounts[k];
+    }
+
+  m_CachedNumberOfPieces = 0;
+  m_CacheLock.Unlock();
+
+  this->Modified();
+}
+
+template <unsigned int VImageDimension>
+double
+ImageRegionCostBalancedSplitter<VImageDimension>
+::ComputeLineCost(IndexValueType line, double averageCost) const
+{
+  const IndexValueType refStart = m_ReferenceRegion.GetIndex(VImageDimension - 1);
+  if (m_LineCosts.empty() || line < refStart
+      || line >= refStart + static_cast<IndexValueType>(m_LineCosts.size()))
+    {
+    return averageCost;
+    }
+
+  const SizeValueType k = static_cast<SizeValueType>(line - refStart);
+  if (m_LineTimingCounts[k] > 0)
+    {
+    return m_LineTimings[k] / m_LineTimingCounts[k];
+    }
+  if (m_TimedEstimatedCost > 0.)
+    {
+    // Estimated cost, converted to the unit of the timings
+    return m_LineCosts[k] * m_TimedCost / m_TimedEstimatedCost;
+    }
+  return m_LineCosts[k];
+}
+
+template <unsigned int VImageDimension>
+double
+ImageRegionCostBalancedSplitter<VImageDimension>
+::GetAverageLineCost() const
+{
+  if (m_LineCosts.empty())
+    {
+    return 1.;
+    }
+
+  const IndexValueType refStart = m_ReferenceRegion.GetIndex(VImageDimension - 1);
+  double sum = 0.;
+  for (SizeValueType k = 0; k < m_LineCosts.size(); ++k)
+    {
+    sum += this->ComputeLineCost(refStart + static_cast<IndexValueType>(k), 0.);
+    }
+  return sum / static_cast<double>(m_LineCosts.size());
+}
+
+template <unsigned int VImageDimension>
+double
+ImageRegionCostBalancedSplitter<VImageDimension>
+::GetLineCost(IndexValueType line) const
+{
+  return this->ComputeLineCost(line, this->GetAverageLineCost());
+}
+
+template <unsigned int VImageDimension>
+double
+ImageRegionCostBalancedSplitter<VImageDimension>
+::GetRegionCost(const RegionType & region) const
+{
+  const unsigned int dim = VImageDimension - 1;
+  const double averageCost = this->GetAverageLineCost();
+
+  double cost = 0.;
+  for (SizeValueType l = 0; l < region.GetSize(dim); ++l)
+    {
+    cost += this->ComputeLineCost(region.GetIndex(dim) + static_cast<IndexValueType>(l), averageCost);
+    }
+
+  if (!m_LineCosts.empty() && GetLineWidth(m_ReferenceRegion) > 0)
+    {
+    cost *= static_cast<double>(GetLineWidth(region)) / static_cast<double>(GetLineWidth(m_ReferenceRegion));
+    }
+  return cost;
+}
+
+template <unsigned int VImageDimension>
+unsigned int
+ImageRegionCostBalancedSplitter<VImageDimension>
+::GetNumberOfSplits(const RegionType& region, unsigned int requestedNumber)
+{
+  const SizeValueType nbLines = region.GetSize(VImageDimension - 1);
+  return static_cast<unsigned int>(std::max(std::min(static_cast<SizeValueType>(requestedNumber), nbLines),
+                                            static_cast<SizeValueType>(1)));
+}
+
+template <unsigned int VImageDimension>
+void
+ImageRegionCostBalancedSplitter<VImageDimension>
+::UpdateBoundaries(const RegionType & region, unsigned int numberOfPieces)
+{
+  // Called with the cache lock held
+  if (m_CachedNumberOfPieces == numberOfPieces && m_CachedRegion == region)
+    {
+    return;
+    }
+
+  const unsigned int  dim = VImageDimension - 1;
+  const SizeValueType nbLines = region.GetSize(dim);
+  const double        averageCost = this->GetAverageLineCost();
+
+  std::vector<double> cumulative(nbLines + 1, 0.);
+  for (SizeValueType l = 0; l < nbLines; ++l)
+    {
+    cumulative[l + 1] = cumulative[l]
+      + std::max(this->ComputeLineCost(region.GetIndex(dim) + static_cast<IndexValueType>(l), averageCost), 0.);
+    }
+  const double total = cumulative[nbLines];
+
+  m_Boundaries.assign(numberOfPieces + 1, 0);
+  m_Boundaries[numberOfPieces] = nbLines;
+  for (unsigned int k = 1; k < numberOfPieces; ++k)
+    {
+    SizeValueType boundary = static_cast<SizeValueType>(k) * nbLines / numberOfPieces;
+    if (total > 0.)
+      {
+      // First line where the cumulative cost reaches the target, or the
+      // previous one if it is closer
+      const double target = total * k / numberOfPieces;
+      boundary = static_cast<SizeValueType>(
+        std::lower_bound(cumulative.begin(), cumulative.end(), target) - cumulative.begin());
+      if (boundary > 0 && target - cumulative[boundary - 1] < cumulative[boundary] - target)
+        {
+        --boundary;
+        }
+      }
+    // Each strip has at least one line
+    boundary = std::max(boundary, m_Boundaries[k - 1] + 1);
+    boundary = std::min(boundary, nbLines - (numberOfPieces - k));
+    m_Boundaries[k] = boundary;
+    }
+
+  otbMsgDevMacro(<< "Cost balanced split of " << nbLines << " lines in " << numberOfPieces
+                 << " strips, total cost " << total);
+
+  m_CachedRegion = region;
+  m_CachedNumberOfPieces = numberOfPieces;
+}
+
+template <unsigned int VImageDimension>
+itk::ImageRegion<VImageDimension>
+ImageRegionCostBalancedSplitter<VImageDimension>
+::GetSplit(unsigned int i, unsigned int numberOfPieces, const RegionType& region)
+{
+  const unsigned int numPieces = this->GetNumberOfSplits(region, numberOfPieces);
+
+  // Sanity check
+  if (i >= numPieces)
+    {
+    itkExceptionMacro("Asked for split number " << i << " but region contains only " << numPieces << " splits");
+    }
+
+  m_CacheLock.Lock();
+  this->UpdateBoundaries(region, numPieces);
+  const SizeValueType begin = m_Boundaries[i];
+  const SizeValueType end = m_Boundaries[i + 1];
+  m_CacheLock.Unlock();
+
+  const unsigned int dim = VImageDimension - 1;
+  RegionType splitRegion = region;
+  splitRegion.SetIndex(dim, region.GetIndex(dim) + static_cast<IndexValueType>(begin));
+  splitRegion.SetSize(dim, end - begin);
+
+  return splitRegion;
+}
+
+template <unsigned int VImageDimension>
+void
+ImageRegionCostBalancedSplitter<VImageDimension>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "ReferenceRegion    : " << m_ReferenceRegion << std::endl;
+  os << indent << "NumberOfLineCosts  : " << m_LineCosts.size() << std::endl;
+  os << indent << "MaskedPixelCost    : " << m_MaskedPixelCost << std::endl;
+  os << indent << "TimedCost          : " << m_TimedCost << std::endl;
+}
+
+} // end namespace otb
+
+#endif
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbMappedFile_h
+#define otbMappedFile_h
+
+#include <string>
+#include <cstddef>
+
+#include "itkMacro.h"
+
+#include "OTBCommonExport.h"
+
+namespace otb
+{
+
+/** \class MappedFile
+ * \brief Read-only memory mapping of a whole file.
+ *
+ * Raw image formats store the samples uncompressed, at a position which
+ * only depends on their line, column and band. Mapping the file gives a
+ * direct access to any region without the seek and read calls of a
+ * stream (and without their intermediate copy): the pages are loaded by
+ * the system when they are first accessed, and shared with the other
+ * readers of the same file.
+ *
+ * Open() returns false if the file can not be mapped (for instance on a
+ * system without mmap, or with a file too large for the address space),
+ * in which case the caller is expected to fall back to stream reads.
+ *
+ * \ingroup OTBCommon
+ */
+class OTBCommon_EXPORT MappedFile
+{
+public:
+  MappedFile();
+  ~MappedFile();
+
+  /** Map the given file. Returns false if it can not be mapped. */
+  bool Open(const std::string & filename);
+
+  /** Unmap the file */
+  void Close();
+
+  bool IsOpen() const
+  {
+    return m_Data != ITK_NULLPTR;
+  }
+
+  /** Get the address of the first byte of the file */
+  const char * GetData() const
+  {
+    return m_Data;
+  }
+
+  /** Get the size of the file, in bytes */
+  std::size_t GetSize() const
+  {
+    return m_Size;
+  }
+
+  const std::string & GetFileName() const
+  {
+    return m_FileName;
+  }
+
+private:
+  MappedFile(const MappedFile &); //purposely not implemented
+  void operator =(const MappedFile&); //purposely not implemented
+
+  std::string  m_FileName;
+  const char * m_Data;
+  std::size_t  m_Size;
+
+#if defined(_WIN32)
+  void *       m_FileHandle;
+  void *       m_MappingHandle;
+#endif
+};
+
+/** Copy nbPixels pixels of nbBands bands to a pixel interleaved buffer.
+ *
+ * bands[b] is the address of the first sample of band b, and the samples
+ * of a band are separated by pixelSpace bytes (componentSize for a band
+ * sequential file). The output receives the nbBands samples of the first
+ * pixel, then those of the second one, and so on.
+ *
+ * The pixels are transposed by blocks which fit in the L1 cache, so that
+ * each band is read sequentially and each output line is written while
+ * it is still cached.
+ */
+OTBCommon_EXPORT void InterleaveBands(const char * const * bands,
+                                      unsigned int nbBands,
+                                      std::size_t pixelSpace,
+                                      std::size_t nbPixels,
+                                      std::size_t componentSize,
+                                      char * output);
+
+} // namespace otb
+
+#endif
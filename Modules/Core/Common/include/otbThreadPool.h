@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbThreadPool_h
+#define otbThreadPool_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itkMutexLock.h"
+#include "itkConditionVariable.h"
+
+#include "OTBCommonExport.h"
+
+#include <deque>
+#include <vector>
+#include <string>
+
+namespace otb
+{
+
+/** \class ThreadPool
+ *  \brief Persistent pool of worker threads with work stealing
+ *
+ * The ITK MultiThreader spawns and joins its threads at each call of
+ * GenerateData(), and statically gives one piece of the region to each
+ * thread: with many small stream divisions, the thread creation is paid
+ * many times, and with uneven filters, the threads with an easy piece
+ * stay idle while the others finish.
+ *
+ * This pool keeps its workers alive between the runs. A run is a list of
+ * independent tasks, identified by their index. The tasks are first
+ * dealt in contiguous blocks to the worker queues; each worker processes
+ * its own queue from the front, and when it is empty, it steals the tasks
+ * at the back of the other queues, so that all the workers stay busy
+ * until the end of the run.
+ *
+ * Only one run can be executed at a time: callers have to Acquire() the
+ * pool before Run(), and fall back to their own threading if the pool is
+ * already in use (for instance by a filter called from a task).
+ *
+ * The global instance is sized by ConfigurationManager::GetThreadPoolSize()
+ * and is not created when the size is 0. Filters use it through the
+ * ThreadPoolDispatcher.
+ *
+ * \sa ThreadPoolDispatcher
+ *
+ * \ingroup OTBCommon
+ */
+class OTBCommon_EXPORT ThreadPool : public itk::Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef ThreadPool                    Self;
+  typedef itk::Object                   Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Function processing a task. The worker id is in [0, nbWorkers[ */
+  typedef void (*TaskFunctionType)(void * data, unsigned int taskId, unsigned int workerId);
+
+  /** Function called by the thread calling Run() when tasks are done */
+  typedef void (*ProgressFunctionType)(void * data, unsigned int nbDone, unsigned int nbTasks);
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(ThreadPool, itk::Object);
+
+  /** Get the global pool, created on the first call with the settings of
+   * the ConfigurationManager. Returns a null pointer if the pool is
+   * disabled. */
+  static ThreadPool * GetInstance();
+
+  /** Set the number of worker threads. The previous workers are stopped.
+   * This must not be called during a Run(). */
+  void SetNumberOfWorkers(unsigned int nbWorkers);
+  itkGetConstMacro(NumberOfWorkers, unsigned int);
+
+  /** Set/Get the number of tasks per worker that users of the pool should
+   * create for a good load balancing */
+  itkSetMacro(ChunksPerWorker, unsigned int);
+  itkGetConstMacro(ChunksPerWorker, unsigned int);
+
+  /** Try to reserve the pool. Returns false if it is already in use. */
+  bool Acquire();
+
+  /** Release the pool reserved with Acquire() */
+  void Release();
+
+  /** Process the tasks [0, nbTasks[ with at most maxWorkers workers (0
+   * means all of them), and wait for their completion. The calling thread
+   * does not process tasks: it calls the progress function each time a
+   * task is done. If a task throws, the remaining tasks are skipped and
+   * an exception is thrown once the workers are idle. */
+  void Run(TaskFunctionType task, void * data,
+           unsigned int nbTasks, unsigned int maxWorkers = 0,
+           ProgressFunctionType progress = ITK_NULLPTR, void * progressData = ITK_NULLPTR);
+
+  /** Get the number of tasks stolen from another queue during the last
+   * Run() */
+  itkGetConstMacro(NumberOfStolenTasks, unsigned int);
+
+protected:
+  ThreadPool();
+  ~ThreadPool() ITK_OVERRIDE;
+  void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
+
+private:
+  ThreadPool(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  typedef std::deque<unsigned int> TaskQueueType;
+
+  /** Argument of the worker threads */
+  struct WorkerInfo
+  {
+    ThreadPool *       Pool;
+    unsigned int       WorkerId;
+    unsigned long      Generation;
+    itk::ThreadIdType  ThreadId;
+  };
+
+  static ITK_THREAD_RETURN_TYPE WorkerCallback(void * arg);
+
+  /** Main loop of a worker: wait for a run, process tasks, repeat */
+  void WorkerLoop(unsigned int workerId, unsigned long generation);
+
+  /** Process the tasks of the current run until all the queues are empty */
+  void ProcessTasks(unsigned int workerId);
+
+  /** Pop a task from the front of the worker queue, or steal one from the
+   * back of another queue. Returns false when all the queues are empty. */
+  bool PopTask(unsigned int workerId, unsigned int & taskId, bool & stolen);
+
+  /** Stop and join all the workers */
+  void StopWorkers();
+
+  itk::MultiThreader::Pointer m_Threader;
+
+  unsigned int m_NumberOfWorkers;
+  unsigned int m_ChunksPerWorker;
+
+  std::vector<WorkerInfo>            m_Workers;
+  std::vector<TaskQueueType>         m_Queues;
+  std::vector<itk::SimpleFastMutexLock *> m_QueueLocks;
+
+  /** Reservation of the pool */
+  itk::SimpleFastMutexLock m_AcquireLock;
+  bool                     m_Acquired;
+
+  /** State of the current run, protected by m_Mutex */
+  itk::SimpleMutexLock              m_Mutex;
+  itk::ConditionVariable::Pointer   m_WakeUp;
+  itk::ConditionVariable::Pointer   m_TaskDone;
+  unsigned long                     m_Generation;
+  bool                              m_Terminate;
+  unsigned int                      m_ActiveWorkers;
+  unsigned int                      m_BusyWorkers;
+  unsigned int                      m_NumberOfTasks;
+  unsigned int                      m_NumberOfDoneTasks;
+  unsigned int                      m_NumberOfStolenTasks;
+  bool                              m_Failed;
+  std::string                       m_ErrorMessage;
+
+  TaskFunctionType m_Task;
+  void *           m_TaskData;
+};
+
+} // end namespace otb
+
+#endif
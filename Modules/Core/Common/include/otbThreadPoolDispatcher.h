@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbThreadPoolDispatcher_h
+#define otbThreadPoolDispatcher_h
+
+#include "otbThreadPool.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace otb
+{
+
+/** \class ThreadPoolDispatcher
+ *  \brief Run the threaded part of an image filter on the ThreadPool
+ *
+ * GenerateData() does the same as itk::ImageSource::GenerateData(), but
+ * instead of one piece of the output region per thread of the
+ * MultiThreader, the region is split in
+ * ChunksPerWorker * NumberOfWorkers chunks which are processed by the
+ * workers of the global ThreadPool. ThreadedGenerateData() is called on
+ * each chunk, with the id of the worker plus one as thread id: it is
+ * always lower than the number of threads of the filter, so that the
+ * per-thread data of BeforeThreadedGenerateData() stay valid, and the id
+ * 0, which reports the progress in itk::ProgressReporter, is not used
+ * (the progress is reported by the dispatcher instead).
+ *
+ * A filter opts in by declaring the dispatcher as friend and overriding
+ * GenerateData():
+ * \code
+ * void GenerateData() ITK_OVERRIDE
+ * {
+ *   if (!ThreadPoolDispatcher<Self>::GenerateData(this))
+ *     {
+ *     Superclass::GenerateData();
+ *     }
+ * }
+ * \endcode
+ * The ThreadedGenerateData() of the filter must support being called
+ * several times with the same thread id.
+ *
+ * \sa ThreadPool
+ *
+ * \ingroup OTBCommon
+ */
+template <class TFilter>
+class ThreadPoolDispatcher
+{
+public:
+  typedef ThreadPoolDispatcher                       Self;
+  typedef TFilter                                    FilterType;
+  typedef typename FilterType::OutputImageRegionType RegionType;
+
+  /** Process the filter on the ThreadPool. Returns false, without doing
+   * anything, if the pool is disabled or already in use, or if the filter
+   * has only one thread: the filter then has to use its usual
+   * GenerateData(). */
+  static bool GenerateData(FilterType * filter);
+
+private:
+  ThreadPoolDispatcher(); //purposely not implemented
+
+  struct DispatchData
+  {
+    FilterType *            Filter;
+    std::vector<RegionType> Chunks;
+  };
+
+  static void ProcessChunk(void * data, unsigned int taskId, unsigned int workerId);
+
+  static void ReportProgress(void * data, unsigned int nbDone, unsigned int nbTasks);
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbThreadPoolDispatcher.txx"
+#endif
+
+#endif
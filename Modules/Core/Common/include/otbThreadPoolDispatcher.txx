@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbThreadPoolDispatcher_txx
+#define otbThreadPoolDispatcher_txx
+
+#include "otbThreadPoolDispatcher.h"
+
+namespace otb
+{
+
+template <class TFilter>
+bool
+ThreadPoolDispatcher<TFilter>
+::GenerateData(FilterType * filter)
+{
+  ThreadPool * pool = ThreadPool::GetInstance();
+
+  if (pool == ITK_NULLPTR || filter->GetNumberOfThreads() < 2)
+    {
+    return false;
+    }
+
+  // Filters called from a task of the pool use their own threads
+  if (!pool->Acquire())
+    {
+    return false;
+    }
+
+  try
+    {
+    const unsigned int nbWorkers = std::min(pool->GetNumberOfWorkers(),
+                                            static_cast<unsigned int>(filter->GetNumberOfThreads() - 1));
+
+    filter->AllocateOutputs();
+    filter->BeforeThreadedGenerateData();
+
+    DispatchData dispatchData;
+    dispatchData.Filter = filter;
+
+    RegionType chunk;
+    const unsigned int nbChunks = filter->SplitRequestedRegion(0, nbWorkers * pool->GetChunksPerWorker(), chunk);
+    dispatchData.Chunks.reserve(nbChunks);
+    dispatchData.Chunks.push_back(chunk);
+    for (unsigned int i = 1; i < nbChunks; ++i)
+      {
+      filter->SplitRequestedRegion(i, nbChunks, chunk);
+      dispatchData.Chunks.push_back(chunk);
+      }
+
+    pool->Run(&Self::ProcessChunk, &dispatchData, nbChunks, nbWorkers,
+              &Self::ReportProgress, &dispatchData);
+
+    filter->AfterThreadedGenerateData();
+    }
+  catch (...)
+    {
+    pool->Release();
+    throw;
+    }
+
+  pool->Release();
+  return true;
+}
+
+template <class TFilter>
+void
+ThreadPoolDispatcher<TFilter>
+::ProcessChunk(void * data, unsigned int taskId, unsigned int workerId)
+{
+  DispatchData * dispatchData = static_cast<DispatchData *>(data);
+
+  if (!dispatchData->Filter->GetAbortGenerateData())
+    {
+    dispatchData->Filter->ThreadedGenerateData(dispatchData->Chunks[taskId], workerId + 1);
+    }
+}
+
+template <class TFilter>
+void
+ThreadPoolDispatcher<TFilter>
+::ReportProgress(void * data, unsigned int nbDone, unsigned int nbTasks)
+{
+  DispatchData * dispatchData = static_cast<DispatchData *>(data);
+
+  dispatchData->Filter->UpdateProgress(static_cast<float>(nbDone) / static_cast<float>(nbTasks));
+}
+
+} // end namespace otb
+
+#endif
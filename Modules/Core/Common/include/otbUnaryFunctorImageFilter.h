@@ -22,6 +22,7 @@
 #define otbUnaryFunctorImageFilter_h
 
 #include "itkUnaryFunctorImageFilter.h"
+#include "otbThreadPoolDispatcher.h"
 
 namespace otb
 {
@@ -76,7 +77,19 @@ protected:
       this->GetFunctor().GetOutputSize());
   }
 
+  /** Process the output region by chunks on the ThreadPool when it is
+   * enabled, with the MultiThreader otherwise */
+  void GenerateData() ITK_OVERRIDE
+  {
+    if (!ThreadPoolDispatcher<Self>::GenerateData(this))
+      {
+      Superclass::GenerateData();
+      }
+  }
+
 private:
+  friend class ThreadPoolDispatcher<Self>;
+
   UnaryFunctorImageFilter(const Self &); //purposely not implemented
   void operator =(const Self&); //purposely not implemented
 
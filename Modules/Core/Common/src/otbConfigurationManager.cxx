@@ -41,6 +41,20 @@ std::string ConfigurationManager::GetGeoidFile()
   return svalue;
 }
 
+std::string ConfigurationManager::GetSIXSCacheFile()
+{
+  std::string svalue;
+  itksys::SystemTools::GetEnv("OTB_6S_CACHE_FILE",svalue);
+  return svalue;
+}
+
+std::string ConfigurationManager::GetProfileTraceFile()
+{
+  std::string svalue;
+  itksys::SystemTools::GetEnv("OTB_PROFILE_TRACE_FILE",svalue);
+  return svalue;
+}
+
 ConfigurationManager::RAMValueType ConfigurationManager::GetMaxRAMHint()
 {
   std::string svalue;
@@ -61,4 +75,65 @@ ConfigurationManager::RAMValueType ConfigurationManager::GetMaxRAMHint()
   return value;
 
 }
+
+unsigned int ConfigurationManager::GetThreadPoolSize()
+{
+  std::string svalue;
+
+  unsigned int value = 0;
+
+  if(itksys::SystemTools::GetEnv("OTB_THREAD_POOL_SIZE",svalue))
+    {
+    value = static_cast<unsigned int>(strtoul(svalue.c_str(),ITK_NULLPTR,10));
+    }
+
+  return value;
+}
+
+unsigned int ConfigurationManager::GetThreadPoolChunksPerThread()
+{
+  std::string svalue;
+
+  unsigned int value = 16;
+
+  if(itksys::SystemTools::GetEnv("OTB_THREAD_POOL_CHUNKS",svalue))
+    {
+    unsigned long int tmp = strtoul(svalue.c_str(),ITK_NULLPTR,10);
+
+    if(tmp)
+      {
+      value = static_cast<unsigned int>(tmp);
+      }
+    }
+
+  return value;
+}
+
+unsigned int ConfigurationManager::GetGDALReadThreads()
+{
+  std::string svalue;
+
+  unsigned int value = 0;
+
+  if(itksys::SystemTools::GetEnv("OTB_GDAL_READ_THREADS",svalue))
+    {
+    value = static_cast<unsigned int>(strtoul(svalue.c_str(),ITK_NULLPTR,10));
+    }
+
+  return value;
+}
+
+unsigned int ConfigurationManager::GetGDALWriteThreads()
+{
+  std::string svalue;
+
+  unsigned int value = 0;
+
+  if(itksys::SystemTools::GetEnv("OTB_GDAL_WRITE_THREADS",svalue))
+    {
+    value = static_cast<unsigned int>(strtoul(svalue.c_str(),ITK_NULLPTR,10));
+    }
+
+  return value;
+}
 }
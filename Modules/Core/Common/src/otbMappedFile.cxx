@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbMappedFile.h"
+#include "otbMacro.h"
+
+#include <cstring>
+#include <algorithm>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace otb
+{
+
+MappedFile::MappedFile()
+  : m_Data(ITK_NULLPTR),
+    m_Size(0)
+#if defined(_WIN32)
+  , m_FileHandle(ITK_NULLPTR),
+    m_MappingHandle(ITK_NULLPTR)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+  this->Close();
+}
+
+bool MappedFile::Open(const std::string & filename)
+{
+  this->Close();
+
+#if defined(_WIN32)
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE)
+    {
+    return false;
+    }
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0
+      || static_cast<LONGLONG>(static_cast<std::size_t>(size.QuadPart)) != size.QuadPart)
+    {
+    CloseHandle(file);
+    return false;
+    }
+
+  HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (mapping == NULL)
+    {
+    CloseHandle(file);
+    return false;
+    }
+
+  void * data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (data == NULL)
+    {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+    }
+
+  m_FileHandle = file;
+  m_MappingHandle = mapping;
+  m_Size = static_cast<std::size_t>(size.QuadPart);
+#else
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    {
+    return false;
+    }
+
+  struct stat status;
+  if (fstat(fd, &status) != 0 || status.st_size <= 0
+      || static_cast<off_t>(static_cast<std::size_t>(status.st_size)) != status.st_size)
+    {
+    close(fd);
+    return false;
+    }
+
+  const std::size_t size = static_cast<std::size_t>(status.st_size);
+  void * data = mmap(ITK_NULLPTR, size, PROT_READ, MAP_SHARED, fd, 0);
+
+  // The mapping stays valid once the descriptor is closed
+  close(fd);
+
+  if (data == MAP_FAILED)
+    {
+    return false;
+    }
+
+  m_Size = size;
+#endif
+
+  m_Data = static_cast<const char *>(data);
+  m_FileName = filename;
+
+  otbMsgDevMacro(<< "Mapped " << m_Size << " bytes of " << m_FileName);
+
+  return true;
+}
+
+void MappedFile::Close()
+{
+  if (m_Data != ITK_NULLPTR)
+    {
+#if defined(_WIN32)
+    UnmapViewOfFile(m_Data);
+    CloseHandle(static_cast<HANDLE>(m_MappingHandle));
+    CloseHandle(static_cast<HANDLE>(m_FileHandle));
+    m_MappingHandle = ITK_NULLPTR;
+    m_FileHandle = ITK_NULLPTR;
+#else
+    munmap(const_cast<char *>(m_Data), m_Size);
+#endif
+    }
+  m_Data = ITK_NULLPTR;
+  m_Size = 0;
+  m_FileName.clear();
+}
+
+namespace
+{
+
+/** Transposition with a sample type of the component size, so that the
+ * compiler copies whole samples */
+template <class TSample>
+void InterleaveBandsBlock(const char * const * bands,
+                          unsigned int nbBands,
+                          std::size_t pixelSpace,
+                          std::size_t firstPixel,
+                          std::size_t nbPixels,
+                          char * output)
+{
+  TSample * out = reinterpret_cast<TSample *>(output) + firstPixel * nbBands;
+
+  for (unsigned int b = 0; b < nbBands; ++b)
+    {
+    const char * in = bands[b] + firstPixel * pixelSpace;
+    TSample *    outBand = out + b;
+    for (std::size_t i = 0; i < nbPixels; ++i, in += pixelSpace, outBand += nbBands)
+      {
+      std::memcpy(outBand, in, sizeof(TSample));
+      }
+    }
+}
+
+void InterleaveBandsBlockGeneric(const char * const * bands,
+                                 unsigned int nbBands,
+                                 std::size_t pixelSpace,
+                                 std::size_t componentSize,
+                                 std::size_t firstPixel,
+                                 std::size_t nbPixels,
+                                 char * output)
+{
+  const std::size_t outPixelSize = componentSize * nbBands;
+  char * out = output + firstPixel * outPixelSize;
+
+  for (unsigned int b = 0; b < nbBands; ++b)
+    {
+    const char * in = bands[b] + firstPixel * pixelSpace;
+    char *       outBand = out + b * componentSize;
+    for (std::size_t i = 0; i < nbPixels; ++i, in += pixelSpace, outBand += outPixelSize)
+      {
+      std::memcpy(outBand, in, componentSize);
+      }
+    }
+}
+
+}
+
+void InterleaveBands(const char * const * bands,
+                     unsigned int nbBands,
+                     std::size_t pixelSpace,
+                     std::size_t nbPixels,
+                     std::size_t componentSize,
+                     char * output)
+{
+  // A single contiguous band is a plain copy
+  if (nbBands == 1 && pixelSpace == componentSize)
+    {
+    std::memcpy(output, bands[0], nbPixels * componentSize);
+    return;
+    }
+
+  // Output block of about 16 kB, which stays in the L1 cache while all
+  // the bands are copied into it
+  const std::size_t blockSize = std::max(static_cast<std::size_t>(16384) / (componentSize * nbBands),
+                                         static_cast<std::size_t>(64));
+
+  for (std::size_t first = 0; first < nbPixels; first += blockSize)
+    {
+    const std::size_t count = std::min(blockSize, nbPixels - first);
+    switch (componentSize)
+      {
+      case 1:
+        InterleaveBandsBlock<unsigned char>(bands, nbBands, pixelSpace, first, count, output);
+        break;
+      case 2:
+        InterleaveBandsBlock<unsigned short>(bands, nbBands, pixelSpace, first, count, output);
+        break;
+      case 4:
+        InterleaveBandsBlock<unsigned int>(bands, nbBands, pixelSpace, first, count, output);
+        break;
+      case 8:
+        InterleaveBandsBlock<double>(bands, nbBands, pixelSpace, first, count, output);
+        break;
+      default:
+        InterleaveBandsBlockGeneric(bands, nbBands, pixelSpace, componentSize, first, count, output);
+        break;
+      }
+    }
+}
+
+} // namespace otb
@@ -0,0 +1,398 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbThreadPool.h"
+#include "otbConfigurationManager.h"
+#include "otbMacro.h"
+
+#include <exception>
+
+namespace otb
+{
+
+ThreadPool *
+ThreadPool
+::GetInstance()
+{
+  static itk::SimpleFastMutexLock instanceLock;
+  static Pointer                  instance;
+  static bool                     initialized = false;
+
+  instanceLock.Lock();
+  if (!initialized)
+    {
+    initialized = true;
+    const unsigned int size = ConfigurationManager::GetThreadPoolSize();
+    if (size > 0)
+      {
+      instance = Self::New();
+      instance->SetNumberOfWorkers(size);
+      instance->SetChunksPerWorker(ConfigurationManager::GetThreadPoolChunksPerThread());
+      otbMsgDevMacro(<< "Thread pool started with " << instance->GetNumberOfWorkers() << " workers");
+      }
+    }
+  instanceLock.Unlock();
+
+  return instance.GetPointer();
+}
+
+ThreadPool
+::ThreadPool()
+  : m_Threader(itk::MultiThreader::New()),
+    m_NumberOfWorkers(0),
+    m_ChunksPerWorker(16),
+    m_Acquired(false),
+    m_WakeUp(itk::ConditionVariable::New()),
+    m_TaskDone(itk::ConditionVariable::New()),
+    m_Generation(0),
+    m_Terminate(false),
+    m_ActiveWorkers(0),
+    m_BusyWorkers(0),
+    m_NumberOfTasks(0),
+    m_NumberOfDoneTasks(0),
+    m_NumberOfStolenTasks(0),
+    m_Failed(false),
+    m_Task(ITK_NULLPTR),
+    m_TaskData(ITK_NULLPTR)
+{
+}
+
+ThreadPool
+::~ThreadPool()
+{
+  this->StopWorkers();
+}
+
+void
+ThreadPool
+::SetNumberOfWorkers(unsigned int nbWorkers)
+{
+  this->StopWorkers();
+
+  // Spawned threads are limited by the MultiThreader
+  if (nbWorkers > ITK_MAX_THREADS)
+    {
+    itkWarningMacro(<< "Number of workers is limited to " << ITK_MAX_THREADS);
+    nbWorkers = ITK_MAX_THREADS;
+    }
+
+  m_NumberOfWorkers = nbWorkers;
+  m_Queues.assign(nbWorkers, TaskQueueType());
+  m_QueueLocks.resize(nbWorkers);
+  m_Workers.resize(nbWorkers);
+
+  m_Mutex.Lock();
+  m_Terminate = false;
+  const unsigned long generation = m_Generation;
+  m_Mutex.Unlock();
+
+  // The worker info must not move once the threads are spawned
+  for (unsigned int w = 0; w < nbWorkers; ++w)
+    {
+    m_QueueLocks[w] = new itk::SimpleFastMutexLock;
+    m_Workers[w].Pool = this;
+    m_Workers[w].WorkerId = w;
+    m_Workers[w].Generation = generation;
+    }
+  for (unsigned int w = 0; w < nbWorkers; ++w)
+    {
+    m_Workers[w].ThreadId = m_Threader->SpawnThread(&ThreadPool::WorkerCallback, &m_Workers[w]);
+    }
+
+  this->Modified();
+}
+
+void
+ThreadPool
+::StopWorkers()
+{
+  if (!m_Workers.empty())
+    {
+    m_Mutex.Lock();
+    m_Terminate = true;
+    m_WakeUp->Broadcast();
+    m_Mutex.Unlock();
+
+    for (unsigned int w = 0; w < m_Workers.size(); ++w)
+      {
+      m_Threader->TerminateThread(m_Workers[w].ThreadId);
+      }
+    }
+
+  for (unsigned int w = 0; w < m_QueueLocks.size(); ++w)
+    {
+    delete m_QueueLocks[w];
+    }
+  m_QueueLocks.clear();
+  m_Queues.clear();
+  m_Workers.clear();
+  m_NumberOfWorkers = 0;
+}
+
+bool
+ThreadPool
+::Acquire()
+{
+  m_AcquireLock.Lock();
+  const bool acquired = !m_Acquired;
+  m_Acquired = true;
+  m_AcquireLock.Unlock();
+  return acquired;
+}
+
+void
+ThreadPool
+::Release()
+{
+  m_AcquireLock.Lock();
+  m_Acquired = false;
+  m_AcquireLock.Unlock();
+}
+
+void
+ThreadPool
+::Run(TaskFunctionType task, void * data,
+      unsigned int nbTasks, unsigned int maxWorkers,
+      ProgressFunctionType progress, void * progressData)
+{
+  if (nbTasks == 0)
+    {
+    return;
+    }
+  if (m_NumberOfWorkers == 0)
+    {
+    itkExceptionMacro(<< "The thread pool has no worker");
+    }
+
+  const unsigned int nbWorkers =
+    (maxWorkers == 0 || maxWorkers > m_NumberOfWorkers) ? m_NumberOfWorkers : maxWorkers;
+
+  m_Mutex.Lock();
+
+  // A worker woken late by the previous run may still be looking at the
+  // (empty) queues
+  while (m_BusyWorkers > 0)
+    {
+    m_TaskDone->Wait(&m_Mutex);
+    }
+
+  m_Task = task;
+  m_TaskData = data;
+  m_NumberOfTasks = nbTasks;
+  m_NumberOfDoneTasks = 0;
+  m_NumberOfStolenTasks = 0;
+  m_Failed = false;
+  m_ErrorMessage.clear();
+  m_ActiveWorkers = nbWorkers;
+
+  // Contiguous blocks of tasks, so that neighbouring chunks of a region
+  // are processed by the same worker as long as there is no stealing
+  for (unsigned int w = 0; w < m_NumberOfWorkers; ++w)
+    {
+    m_QueueLocks[w]->Lock();
+    m_Queues[w].clear();
+    if (w < nbWorkers)
+      {
+      const unsigned int begin = static_cast<unsigned int>(
+        static_cast<itk::SizeValueType>(w) * nbTasks / nbWorkers);
+      const unsigned int end = static_cast<unsigned int>(
+        static_cast<itk::SizeValueType>(w + 1) * nbTasks / nbWorkers);
+      for (unsigned int t = begin; t < end; ++t)
+        {
+        m_Queues[w].push_back(t);
+        }
+      }
+    m_QueueLocks[w]->Unlock();
+    }
+
+  ++m_Generation;
+  m_WakeUp->Broadcast();
+
+  unsigned int reported = 0;
+  while (m_NumberOfDoneTasks < nbTasks || m_BusyWorkers > 0)
+    {
+    m_TaskDone->Wait(&m_Mutex);
+    if (progress != ITK_NULLPTR && m_NumberOfDoneTasks != reported)
+      {
+      reported = m_NumberOfDoneTasks;
+      m_Mutex.Unlock();
+      (*progress)(progressData, reported, nbTasks);
+      m_Mutex.Lock();
+      }
+    }
+
+  const bool        failed = m_Failed;
+  const std::string message = m_ErrorMessage;
+  m_Mutex.Unlock();
+
+  if (failed)
+    {
+    itkExceptionMacro(<< "A task of the thread pool failed: " << message);
+    }
+}
+
+ITK_THREAD_RETURN_TYPE
+ThreadPool
+::WorkerCallback(void * arg)
+{
+  itk::MultiThreader::ThreadInfoStruct * threadInfo =
+    static_cast<itk::MultiThreader::ThreadInfoStruct *>(arg);
+  WorkerInfo * info = static_cast<WorkerInfo *>(threadInfo->UserData);
+
+  info->Pool->WorkerLoop(info->WorkerId, info->Generation);
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+void
+ThreadPool
+::WorkerLoop(unsigned int workerId, unsigned long generation)
+{
+  m_Mutex.Lock();
+  for (;;)
+    {
+    while (!m_Terminate && m_Generation == generation)
+      {
+      m_WakeUp->Wait(&m_Mutex);
+      }
+    if (m_Terminate)
+      {
+      break;
+      }
+    generation = m_Generation;
+
+    if (workerId >= m_ActiveWorkers)
+      {
+      continue;
+      }
+
+    ++m_BusyWorkers;
+    m_Mutex.Unlock();
+
+    this->ProcessTasks(workerId);
+
+    m_Mutex.Lock();
+    --m_BusyWorkers;
+    m_TaskDone->Broadcast();
+    }
+  m_Mutex.Unlock();
+}
+
+void
+ThreadPool
+::ProcessTasks(unsigned int workerId)
+{
+  unsigned int taskId = 0;
+  bool         stolen = false;
+  bool         skip = false;
+
+  while (this->PopTask(workerId, taskId, stolen))
+    {
+    bool        failed = false;
+    std::string message;
+
+    // Once a task has failed, the remaining ones are only counted
+    if (!skip)
+      {
+      try
+        {
+        (*m_Task)(m_TaskData, taskId, workerId);
+        }
+      catch (itk::ExceptionObject & err)
+        {
+        failed = true;
+        message = err.GetDescription();
+        }
+      catch (std::exception & err)
+        {
+        failed = true;
+        message = err.what();
+        }
+      catch (...)
+        {
+        failed = true;
+        message = "unknown exception";
+        }
+      }
+
+    m_Mutex.Lock();
+    if (failed && !m_Failed)
+      {
+      m_Failed = true;
+      m_ErrorMessage = message;
+      }
+    if (stolen)
+      {
+      ++m_NumberOfStolenTasks;
+      }
+    ++m_NumberOfDoneTasks;
+    skip = m_Failed;
+    m_TaskDone->Broadcast();
+    m_Mutex.Unlock();
+    }
+}
+
+bool
+ThreadPool
+::PopTask(unsigned int workerId, unsigned int & taskId, bool & stolen)
+{
+  // Own queue first, from the front
+  m_QueueLocks[workerId]->Lock();
+  if (!m_Queues[workerId].empty())
+    {
+    taskId = m_Queues[workerId].front();
+    m_Queues[workerId].pop_front();
+    m_QueueLocks[workerId]->Unlock();
+    stolen = false;
+    return true;
+    }
+  m_QueueLocks[workerId]->Unlock();
+
+  // Then steal from the back of the other queues, starting with the next
+  // worker so that the thieves do not all target the same queue
+  for (unsigned int i = 1; i < m_ActiveWorkers; ++i)
+    {
+    const unsigned int victim = (workerId + i) % m_ActiveWorkers;
+    m_QueueLocks[victim]->Lock();
+    if (!m_Queues[victim].empty())
+      {
+      taskId = m_Queues[victim].back();
+      m_Queues[victim].pop_back();
+      m_QueueLocks[victim]->Unlock();
+      stolen = true;
+      return true;
+      }
+    m_QueueLocks[victim]->Unlock();
+    }
+
+  return false;
+}
+
+void
+ThreadPool
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Number of workers: " << m_NumberOfWorkers << std::endl;
+  os << indent << "Chunks per worker: " << m_ChunksPerWorker << std::endl;
+  os << indent << "Number of stolen tasks (last run): " << m_NumberOfStolenTasks << std::endl;
+}
+
+} // end namespace otb
@@ -42,4 +42,8 @@ void RegisterTests()
   REGISTER_TEST(otbStandardFilterWatcherNew);
   REGISTER_TEST(otbStandardOneLineFilterWatcherTest);
   REGISTER_TEST(otbStandardWriterWatcher);
+  REGISTER_TEST(otbThreadPoolTest);
+  REGISTER_TEST(otbThreadPoolDispatcherTest);
+  REGISTER_TEST(otbImageRegionCostBalancedSplitter);
+  REGISTER_TEST(otbMappedFileTest);
 }
@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+
+#include "otbImageRegionCostBalancedSplitter.h"
+#include "otbImage.h"
+#include "itkImageRegionIterator.h"
+#include "vnl/vnl_math.h"
+
+typedef otb::ImageRegionCostBalancedSplitter<2> SplitterType;
+typedef SplitterType::RegionType                RegionType;
+
+namespace
+{
+
+/** Check that the splits cover the region without overlap, and that their
+ * costs differ from the average by less than the cost of one line */
+bool CheckSplits(SplitterType * splitter, const RegionType & region, unsigned int nbPieces)
+{
+  const unsigned int nbSplits = splitter->GetNumberOfSplits(region, nbPieces);
+  if (nbSplits != nbPieces)
+    {
+    std::cerr << "Got " << nbSplits << " splits instead of " << nbPieces << std::endl;
+    return false;
+    }
+
+  const double average = splitter->GetRegionCost(region) / nbSplits;
+  double maxLineCost = 0.;
+  for (unsigned int l = 0; l < region.GetSize(1); ++l)
+    {
+    maxLineCost = std::max(maxLineCost, splitter->GetLineCost(region.GetIndex(1) + l));
+    }
+
+  long nextLine = region.GetIndex(1);
+  for (unsigned int i = 0; i < nbSplits; ++i)
+    {
+    RegionType split = splitter->GetSplit(i, nbSplits, region);
+    const double cost = splitter->GetRegionCost(split);
+    std::cout << "Split " << i << ": " << split.GetIndex() << " " << split.GetSize()
+              << " cost " << cost << std::endl;
+
+    if (split.GetIndex(0) != region.GetIndex(0) || split.GetSize(0) != region.GetSize(0)
+        || split.GetIndex(1) != nextLine || split.GetSize(1) == 0)
+      {
+      std::cerr << "Split " << i << " does not follow the previous one" << std::endl;
+      return false;
+      }
+    nextLine += split.GetSize(1);
+
+    if (vnl_math_abs(cost - average) > maxLineCost)
+      {
+      std::cerr << "Split " << i << " has a cost of " << cost << " instead of about " << average << std::endl;
+      return false;
+      }
+    }
+
+  if (nextLine != region.GetIndex(1) + static_cast<long>(region.GetSize(1)))
+    {
+    std::cerr << "The splits do not cover the region" << std::endl;
+    return false;
+    }
+  return true;
+}
+
+}
+
+int otbImageRegionCostBalancedSplitter(int itkNotUsed(argc), char * itkNotUsed(argv) [])
+{
+  typedef otb::Image<unsigned char, 2> MaskType;
+
+  RegionType::IndexType index;
+  index[0] = 10;
+  index[1] = 20;
+  RegionType::SizeType size;
+  size[0] = 100;
+  size[1] = 200;
+  RegionType region(index, size);
+
+  SplitterType::Pointer splitter = SplitterType::New();
+
+  // Without profile: strips of the same height
+  std::cout << "Uniform cost" << std::endl;
+  if (!CheckSplits(splitter, region, 4))
+    {
+    return EXIT_FAILURE;
+    }
+  if (splitter->GetSplit(1, 4, region).GetSize(1) != 50)
+    {
+    std::cerr << "Without profile, strips should have the same height" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Mask covering the first quarter of the lines only
+  MaskType::Pointer mask = MaskType::New();
+  mask->SetRegions(region);
+  mask->Allocate();
+  mask->FillBuffer(0);
+  RegionType::SizeType maskedSize = size;
+  maskedSize[1] = 50;
+  RegionType maskedRegion(index, maskedSize);
+  itk::ImageRegionIterator<MaskType> maskIt(mask, maskedRegion);
+  for (maskIt.GoToBegin(); !maskIt.IsAtEnd(); ++maskIt)
+    {
+    maskIt.Set(1);
+    }
+
+  std::cout << "Mask" << std::endl;
+  splitter->SetMaskImage(mask.GetPointer());
+  if (!CheckSplits(splitter, region, 4))
+    {
+    return EXIT_FAILURE;
+    }
+  // The three first strips are in the mask
+  if (splitter->GetSplit(2, 4, region).GetIndex(1) + splitter->GetSplit(2, 4, region).GetSize(1) > 20 + 50)
+    {
+    std::cerr << "The three first strips should be within the mask" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Timings: the first half of the lines is three times slower
+  std::cout << "Timings" << std::endl;
+  splitter->SetReferenceRegion(region);
+  RegionType::SizeType halfSize = size;
+  halfSize[1] = 100;
+  RegionType::IndexType halfIndex = index;
+  splitter->AddRegionTiming(RegionType(halfIndex, halfSize), 3.);
+  halfIndex[1] += 100;
+  splitter->AddRegionTiming(RegionType(halfIndex, halfSize), 1.);
+  if (!CheckSplits(splitter, region, 2))
+    {
+    return EXIT_FAILURE;
+    }
+  const RegionType firstHalf = splitter->GetSplit(0, 2, region);
+  if (firstHalf.GetSize(1) < 66 || firstHalf.GetSize(1) > 67)
+    {
+    std::cerr << "The first strip should have about 67 lines, not " << firstHalf.GetSize(1) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Partial timings: the untimed lines keep their estimated cost, in the
+  // unit of the timings
+  splitter->SetReferenceRegion(region);
+  RegionType::SizeType quarterSize = size;
+  quarterSize[1] = 50;
+  splitter->AddRegionTiming(RegionType(index, quarterSize), 2.);
+  if (vnl_math_abs(splitter->GetRegionCost(region) - 8.) > 1e-9)
+    {
+    std::cerr << "Cost of the region should be 8, not " << splitter->GetRegionCost(region) << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // More pieces than lines
+  RegionType::SizeType thinSize = size;
+  thinSize[1] = 3;
+  if (splitter->GetNumberOfSplits(RegionType(index, thinSize), 8) != 3)
+    {
+    std::cerr << "A region can not be split in more strips than lines" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+#include <cstring>
+
+#include "otbMappedFile.h"
+
+int otbMappedFileTest(int argc, char* argv[])
+{
+  if (argc != 2)
+    {
+    std::cerr << "Usage: " << argv[0] << " tempFile" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Band sequential file of 3 bands of 1000 shorts
+  const unsigned int nbBands = 3;
+  const unsigned int nbPixels = 1000;
+  std::vector<short> samples(nbBands * nbPixels);
+  for (unsigned int i = 0; i < samples.size(); ++i)
+    {
+    samples[i] = static_cast<short>(i);
+    }
+
+  std::ofstream file(argv[1], std::ios::out | std::ios::binary);
+  file.write(reinterpret_cast<const char*>(&samples[0]), samples.size() * sizeof(short));
+  file.close();
+
+  otb::MappedFile mapped;
+  if (!mapped.Open(argv[1]))
+    {
+    // Not an error: the readers fall back to stream reads
+    std::cout << "Can not map " << argv[1] << ", skipping the test" << std::endl;
+    return EXIT_SUCCESS;
+    }
+
+  if (mapped.GetSize() != samples.size() * sizeof(short)
+      || std::memcmp(mapped.GetData(), &samples[0], mapped.GetSize()) != 0)
+    {
+    std::cerr << "The mapped data differs from the file content" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Band sequential to pixel interleaved
+  const char* bands[nbBands];
+  for (unsigned int b = 0; b < nbBands; ++b)
+    {
+    bands[b] = mapped.GetData() + b * nbPixels * sizeof(short);
+    }
+
+  std::vector<short> interleaved(nbBands * nbPixels);
+  otb::InterleaveBands(bands, nbBands, sizeof(short), nbPixels, sizeof(short),
+                       reinterpret_cast<char*>(&interleaved[0]));
+
+  for (unsigned int p = 0; p < nbPixels; ++p)
+    {
+    for (unsigned int b = 0; b < nbBands; ++b)
+      {
+      if (interleaved[p * nbBands + b] != samples[b * nbPixels + p])
+        {
+        std::cerr << "Wrong sample for pixel " << p << " band " << b << ": "
+                  << interleaved[p * nbBands + b] << " instead of "
+                  << samples[b * nbPixels + p] << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  // Single band with a pixel space: extraction of the second band of the
+  // interleaved buffer
+  const char* secondBand = reinterpret_cast<const char*>(&interleaved[1]);
+  std::vector<short> extracted(nbPixels);
+  otb::InterleaveBands(&secondBand, 1, nbBands * sizeof(short), nbPixels, sizeof(short),
+                       reinterpret_cast<char*>(&extracted[0]));
+  if (std::memcmp(&extracted[0], &samples[nbPixels], nbPixels * sizeof(short)) != 0)
+    {
+    std::cerr << "Wrong extraction of a single band" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  mapped.Close();
+  if (mapped.IsOpen())
+    {
+    std::cerr << "The file is still mapped after Close()" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+
+#include "otbThreadPool.h"
+#include "otbUnaryFunctorImageFilter.h"
+#include "otbImage.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+
+namespace
+{
+
+struct TaskData
+{
+  std::vector<unsigned int> Counts;
+  std::vector<unsigned int> Workers;
+  bool                      Throw;
+};
+
+void UnevenTask(void * data, unsigned int taskId, unsigned int workerId)
+{
+  TaskData * taskData = static_cast<TaskData *>(data);
+
+  if (taskData->Throw && taskId == 7)
+    {
+    itkGenericExceptionMacro(<< "Task 7 failed");
+    }
+
+  // The first tasks, all given to the first worker, are much longer
+  volatile double sum = 0.;
+  const unsigned int cost = (taskId < 16) ? 2000000 : 1000;
+  for (unsigned int i = 0; i < cost; ++i)
+    {
+    sum += 1e-6 * i;
+    }
+
+  // Each task is processed once, so each element is written by one thread
+  taskData->Counts[taskId]++;
+  taskData->Workers[taskId] = workerId;
+}
+
+template <class TInput, class TOutput>
+class TwiceFunctor
+{
+public:
+  TOutput operator()(const TInput & value) const
+  {
+    return static_cast<TOutput>(2 * value);
+  }
+  unsigned int GetOutputSize() const
+  {
+    return 1;
+  }
+  bool operator!=(const TwiceFunctor &) const
+  {
+    return false;
+  }
+  bool operator==(const TwiceFunctor & other) const
+  {
+    return !(*this != other);
+  }
+};
+
+}
+
+int otbThreadPoolTest(int itkNotUsed(argc), char * itkNotUsed(argv) [])
+{
+  const unsigned int nbWorkers = 4;
+  const unsigned int nbTasks = 64;
+
+  otb::ThreadPool::Pointer pool = otb::ThreadPool::New();
+  pool->SetNumberOfWorkers(nbWorkers);
+
+  if (!pool->Acquire() || pool->Acquire())
+    {
+    std::cerr << "The pool should be acquired once only" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  TaskData data;
+  data.Throw = false;
+
+  // Several runs, to check that the workers are reused
+  for (unsigned int run = 0; run < 3; ++run)
+    {
+    data.Counts.assign(nbTasks, 0);
+    data.Workers.assign(nbTasks, nbWorkers);
+
+    pool->Run(&UnevenTask, &data, nbTasks);
+
+    for (unsigned int t = 0; t < nbTasks; ++t)
+      {
+      if (data.Counts[t] != 1)
+        {
+        std::cerr << "Run " << run << ": task " << t << " processed " << data.Counts[t] << " times" << std::endl;
+        return EXIT_FAILURE;
+        }
+      if (data.Workers[t] >= nbWorkers)
+        {
+        std::cerr << "Run " << run << ": task " << t << " has an invalid worker id " << data.Workers[t] << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    std::cout << "Run " << run << ": " << pool->GetNumberOfStolenTasks() << " stolen tasks" << std::endl;
+    }
+
+  // Restrict the number of workers
+  data.Counts.assign(nbTasks, 0);
+  data.Workers.assign(nbTasks, nbWorkers);
+  pool->Run(&UnevenTask, &data, nbTasks, 2);
+  for (unsigned int t = 0; t < nbTasks; ++t)
+    {
+    if (data.Counts[t] != 1 || data.Workers[t] >= 2)
+      {
+      std::cerr << "Task " << t << " not processed by the first two workers only" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // A failing task has to be reported to the caller
+  data.Counts.assign(nbTasks, 0);
+  data.Throw = true;
+  bool thrown = false;
+  try
+    {
+    pool->Run(&UnevenTask, &data, nbTasks);
+    }
+  catch (itk::ExceptionObject & err)
+    {
+    std::cout << "Expected exception: " << err.GetDescription() << std::endl;
+    thrown = true;
+    }
+  if (!thrown)
+    {
+    std::cerr << "The exception of the task was not thrown by Run()" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  pool->Release();
+
+  return EXIT_SUCCESS;
+}
+
+int otbThreadPoolDispatcherTest(int itkNotUsed(argc), char * itkNotUsed(argv) [])
+{
+  typedef otb::Image<float, 2>                                              ImageType;
+  typedef TwiceFunctor<float, float>                                        FunctorType;
+  typedef otb::UnaryFunctorImageFilter<ImageType, ImageType, FunctorType>  FilterType;
+
+  // The global pool is configured from the environment
+  if (otb::ThreadPool::GetInstance() == ITK_NULLPTR)
+    {
+    std::cerr << "The thread pool is not enabled (OTB_THREAD_POOL_SIZE)" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ImageType::SizeType size;
+  size[0] = 211;
+  size[1] = 157;
+  ImageType::RegionType region;
+  region.SetSize(size);
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(region);
+  image->Allocate();
+
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    it.Set(static_cast<float>(it.GetIndex()[0] + 1000 * it.GetIndex()[1]));
+    }
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(image);
+  filter->SetNumberOfThreads(4);
+  filter->Update();
+
+  itk::ImageRegionConstIteratorWithIndex<ImageType> outIt(filter->GetOutput(), region);
+  for (outIt.GoToBegin(); !outIt.IsAtEnd(); ++outIt)
+    {
+    const float expected = 2.f * static_cast<float>(outIt.GetIndex()[0] + 1000 * outIt.GetIndex()[1]);
+    if (outIt.Get() != expected)
+      {
+      std::cerr << "Wrong value at " << outIt.GetIndex() << ": " << outIt.Get()
+                << " instead of " << expected << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // The pool is released after the filter
+  if (!otb::ThreadPool::GetInstance()->Acquire())
+    {
+    std::cerr << "The pool was not released by the filter" << std::endl;
+    return EXIT_FAILURE;
+    }
+  otb::ThreadPool::GetInstance()->Release();
+
+  return EXIT_SUCCESS;
+}
@@ -31,6 +31,10 @@ namespace otb {
 /** \class LabelImageToLabelMapWithAdjacencyFilter
  * \brief convert a labeled image to a label map with adjacency information.
  *
+ * Each thread records the adjacencies it finds as a flat vector of
+ * pairs of labels. The vectors are sorted and merged once, at the end,
+ * to build the adjacency map of the output.
+ *
  *
  * \ingroup OTBLabelMap
  */
@@ -63,6 +67,8 @@ public:
   typedef typename OutputImageType::AdjacencyMapType            AdjacencyMapType;
   typedef typename OutputImageType::AdjacentLabelsContainerType AdjacentLabelsContainerType;
   typedef typename OutputImageType::LabelType                   LabelType;
+  typedef typename OutputImageType::LabelPairType               LabelPairType;
+  typedef typename OutputImageType::LabelPairVectorType         LabelPairVectorType;
 
   /** Const iterator over LabelObject lines */
   typedef typename LabelObjectType::ConstLineIterator           ConstLineIteratorType;
@@ -149,7 +155,8 @@ private:
   OutputImagePixelType m_BackgroundValue;
 
   typename std::vector< OutputImagePointer > m_TemporaryImages;
-  typename std::vector<AdjacencyMapType>     m_TemporaryAdjacencyMaps;
+  /** Adjacencies found by each thread, as sorted pairs of labels */
+  typename std::vector<LabelPairVectorType>  m_TemporaryAdjacencies;
 
 }; // end of class
 
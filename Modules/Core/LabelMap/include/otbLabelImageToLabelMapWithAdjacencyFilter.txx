@@ -28,6 +28,8 @@
 #include "itkImageLinearConstIteratorWithIndex.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
 
+#include <algorithm>
+
 namespace otb {
 
 template <class TInputImage, class TOutputImage>
@@ -82,8 +84,9 @@ LabelImageToLabelMapWithAdjacencyFilter<TInputImage, TOutputImage>
 {
   // init the temp images - one per thread
   m_TemporaryImages.resize( this->GetNumberOfThreads() );
-  // Clear previous adjacency map
-  m_TemporaryAdjacencyMaps.resize( this->GetNumberOfThreads() );
+  // Clear previous adjacencies
+  m_TemporaryAdjacencies.clear();
+  m_TemporaryAdjacencies.resize( this->GetNumberOfThreads() );
 
   for( unsigned int i=0; i<this->GetNumberOfThreads(); ++i )
     {
@@ -110,28 +113,22 @@ void
 LabelImageToLabelMapWithAdjacencyFilter<TInputImage, TOutputImage>
 ::AddAdjacency(LabelType label1, LabelType label2, itk::ThreadIdType threadId)
 {
-  // Insert label1 in v neighbors
-  if(m_TemporaryAdjacencyMaps[threadId].find(label2)!= m_TemporaryAdjacencyMaps[threadId].end())
-    {
-    m_TemporaryAdjacencyMaps[threadId][label2].insert(label1);
-    }
-  else
-    {
-    AdjacentLabelsContainerType newContainer;
-    newContainer.insert(label1);
-    m_TemporaryAdjacencyMaps[threadId][label2]=newContainer;
-    }
-  // Insert label2 in label1s neighbors
-  if(m_TemporaryAdjacencyMaps[threadId].find(label1)!=m_TemporaryAdjacencyMaps[threadId].end())
+  LabelPairVectorType & adjacencies = m_TemporaryAdjacencies[threadId];
+  const LabelPairType adjacency = label1 < label2 ? LabelPairType(label1, label2) : LabelPairType(label2, label1);
+
+  // consecutive lines often give the same adjacency again
+  if(!adjacencies.empty() && adjacencies.back() == adjacency)
     {
-    m_TemporaryAdjacencyMaps[threadId][label1].insert(label2);
+    return;
     }
-  else
+
+  // remove the duplicates instead of growing a large vector
+  if(adjacencies.size() >= (1 << 16) && adjacencies.size() == adjacencies.capacity())
     {
-    AdjacentLabelsContainerType newContainer;
-    newContainer.insert(label2);
-    m_TemporaryAdjacencyMaps[threadId][label1]=newContainer;
+    std::sort(adjacencies.begin(), adjacencies.end());
+    adjacencies.erase(std::unique(adjacencies.begin(), adjacencies.end()), adjacencies.end());
     }
+  adjacencies.push_back(adjacency);
 }
 
 template<class TInputImage, class TOutputImage>
@@ -360,45 +357,25 @@ LabelImageToLabelMapWithAdjacencyFilter<TInputImage, TOutputImage>
       }
     }
 
-  // Merge adjacency tables
-  AdjacencyMapType adjMap = m_TemporaryAdjacencyMaps[0];
-
-  // For each remaining thread
-  for(itk::ThreadIdType threadId = 1; threadId < this->GetNumberOfThreads(); ++threadId)
-    {
-    // For each label in the thread adjacency map
-    for(typename AdjacencyMapType::const_iterator mit = m_TemporaryAdjacencyMaps[threadId].begin();
-  mit!= m_TemporaryAdjacencyMaps[threadId].end();
-  ++mit)
-      {
-      // If the label exists in the main map
-      if(adjMap.find(mit->first) != adjMap.end())
-  {
-  // We need to merge
-  AdjacentLabelsContainerType adjLabels1 = adjMap[mit->first];
-  AdjacentLabelsContainerType adjLabels2 = mit->second;
-  std::vector<LabelType> mergedLabels(adjLabels1.size()+adjLabels2.size(), 0);
-
-  // Merge
-  typename std::vector<LabelType>::const_iterator vend = set_union(adjLabels1.begin(), adjLabels1.end(), adjLabels2.begin(), adjLabels2.end(), mergedLabels.begin());
-
-  AdjacentLabelsContainerType mergedLabelsSet;
-
-  for(typename std::vector<LabelType>::const_iterator vit = mergedLabels.begin();
-      vit!=vend; ++vit)
+  // Merge the adjacencies of the threads
+  LabelPairVectorType adjacencies;
+  for(itk::ThreadIdType threadId = 0; threadId < this->GetNumberOfThreads(); ++threadId)
     {
-    mergedLabelsSet.insert(*vit);
+    adjacencies.insert(adjacencies.end(), m_TemporaryAdjacencies[threadId].begin(), m_TemporaryAdjacencies[threadId].end());
+    LabelPairVectorType().swap(m_TemporaryAdjacencies[threadId]);
     }
+  std::sort(adjacencies.begin(), adjacencies.end());
+  adjacencies.erase(std::unique(adjacencies.begin(), adjacencies.end()), adjacencies.end());
 
-  // Set the final result
-  adjMap[mit->first]=mergedLabelsSet;
-  }
-      else
-  {
-  // Set the labels
-  adjMap[mit->first]=mit->second;
-  }
-      }
+  // Build the adjacency map: since the pairs are sorted, the labels
+  // are always appended at the end of the sets
+  AdjacencyMapType adjMap;
+  for(typename LabelPairVectorType::const_iterator it = adjacencies.begin(); it != adjacencies.end(); ++it)
+    {
+    AdjacentLabelsContainerType & adjLabels1 = adjMap[it->first];
+    adjLabels1.insert(adjLabels1.end(), it->second);
+    AdjacentLabelsContainerType & adjLabels2 = adjMap[it->second];
+    adjLabels2.insert(adjLabels2.end(), it->first);
     }
 
   // Set the adjacency map to the output
@@ -406,7 +383,7 @@ LabelImageToLabelMapWithAdjacencyFilter<TInputImage, TOutputImage>
 
   // release the data in the temp images
   m_TemporaryImages.clear();
-  m_TemporaryAdjacencyMaps.clear();
+  m_TemporaryAdjacencies.clear();
 }
 
 
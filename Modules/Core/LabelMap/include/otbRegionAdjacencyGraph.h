@@ -0,0 +1,253 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef otbRegionAdjacencyGraph_h
+#define otbRegionAdjacencyGraph_h
+
+#include "itkMacro.h"
+
+#include <vector>
+#include <utility>
+
+namespace otb
+{
+
+/** \class RegionAdjacencyGraph
+ *  \brief Compact region adjacency graph with per-region statistics and merging
+ *
+ *  The regions are labelled from 0 to N-1. The adjacencies are
+ *  recorded as pairs of labels, then stored in compressed rows (CSR):
+ *  one offset array and one array of sorted neighbor labels. Each
+ *  region also holds its number of pixels and the sums of its pixel
+ *  values, in flat arrays.
+ *
+ *  Regions are merged with a union-find structure: the region with
+ *  the smallest label is kept and receives the statistics of the
+ *  other one. The adjacency of a merged region is stored apart from
+ *  the CSR arrays, and the neighbors that have been merged since are
+ *  resolved when it is read.
+ *
+ *  MergeByPriority() merges the adjacent regions by increasing cost,
+ *  using a priority queue. Entries made stale by a merge are not
+ *  removed from the queue: they are detected and dropped when they
+ *  are popped (lazy invalidation).
+ *
+ * \ingroup OTBLabelMap
+ */
+template <class TLabel = unsigned int>
+class RegionAdjacencyGraph
+{
+public:
+  /** Standard typedefs */
+  typedef RegionAdjacencyGraph Self;
+
+  typedef TLabel                               LabelType;
+  typedef double                               RealType;
+  typedef std::vector<LabelType>               LabelVectorType;
+  typedef std::pair<LabelType, LabelType>      LabelPairType;
+  typedef std::vector<LabelPairType>           LabelPairVectorType;
+  typedef std::vector<unsigned long>           OffsetVectorType;
+
+  RegionAdjacencyGraph();
+
+  /** Reset the graph with nbRegions regions, labelled from 0 to
+   *  nbRegions - 1, and the number of components of their pixels */
+  void Initialize(LabelType nbRegions, unsigned int nbComponents);
+
+  /** Record an adjacency between two labels. Duplicates are allowed
+   *  and removed by BuildAdjacency(). */
+  void AddAdjacency(LabelType label1, LabelType label2);
+
+  /** Record the adjacencies between the faces of the pixels of a
+   *  label image (4-connectivity in 2D). Each pixel of the region is
+   *  compared to its next neighbor along each dimension, when this
+   *  neighbor is in the buffered region of the image. */
+  template <class TLabelImage>
+  void AddAdjacencies(const TLabelImage * image, const typename TLabelImage::RegionType & region);
+
+  /** Build the compressed adjacency rows from the recorded adjacencies */
+  void BuildAdjacency();
+
+  /** Add a pixel to the statistics of a region */
+  template <class TPixel>
+  void AddPixel(LabelType label, const TPixel & pixel)
+  {
+    this->AddPixels(label, pixel, 1);
+  }
+
+  /** Add count pixels of the same value to the statistics of a region */
+  template <class TPixel>
+  void AddPixels(LabelType label, const TPixel & pixel, unsigned long count)
+  {
+    m_Sizes[label] += count;
+    RealType * sum = m_NumberOfComponents > 0 ? &m_Sums[static_cast<size_t>(label) * m_NumberOfComponents] : ITK_NULLPTR;
+    for (unsigned int c = 0; c < m_NumberOfComponents; ++c)
+      {
+      sum[c] += count * static_cast<RealType>(pixel[c]);
+      }
+  }
+
+  /** Get the number of regions before any merge */
+  LabelType GetNumberOfRegions() const
+  {
+    return m_NumberOfRegions;
+  }
+
+  /** Get the number of regions left after the merges */
+  LabelType GetNumberOfRemainingRegions() const
+  {
+    return m_NumberOfRemainingRegions;
+  }
+
+  /** Get the number of components of the statistics */
+  unsigned int GetNumberOfComponents() const
+  {
+    return m_NumberOfComponents;
+  }
+
+  /** Get the number of adjacencies, before any merge */
+  unsigned long GetNumberOfAdjacencies() const
+  {
+    return m_Neighbors.size() / 2;
+  }
+
+  /** Get the neighbors of a label, before any merge (CSR row) */
+  const LabelType * GetNeighborsBegin(LabelType label) const
+  {
+    return m_Neighbors.empty() ? ITK_NULLPTR : &m_Neighbors[0] + m_Offsets[label];
+  }
+  const LabelType * GetNeighborsEnd(LabelType label) const
+  {
+    return m_Neighbors.empty() ? ITK_NULLPTR : &m_Neighbors[0] + m_Offsets[label + 1];
+  }
+
+  /** Is the label the representative of its region ? */
+  bool IsRegion(LabelType label) const
+  {
+    return m_Parents[label] == label;
+  }
+
+  /** Get the region containing a label, i.e. the smallest label of
+   *  the regions merged with it */
+  LabelType GetRegion(LabelType label);
+
+  /** Number of pixels of a region */
+  unsigned long GetSize(LabelType region) const
+  {
+    return m_Sizes[region];
+  }
+
+  /** Sums of the pixel values of a region */
+  const RealType * GetSum(LabelType region) const
+  {
+    return m_NumberOfComponents > 0 ? &m_Sums[static_cast<size_t>(region) * m_NumberOfComponents] : ITK_NULLPTR;
+  }
+
+  /** Mean of a component of the pixel values of a region */
+  RealType GetMean(LabelType region, unsigned int component) const
+  {
+    return m_Sums[static_cast<size_t>(region) * m_NumberOfComponents + component] / m_Sizes[region];
+  }
+
+  /** Squared euclidean distance between the means of two regions */
+  RealType GetSquaredMeanDistance(LabelType region1, LabelType region2) const;
+
+  /** Get the regions adjacent to a region, sorted by label */
+  void GetAdjacentRegions(LabelType region, LabelVectorType & neighbors);
+
+  /** Merge the regions containing two labels, and return the label
+   *  of the merged region (the smallest one) */
+  LabelType Merge(LabelType label1, LabelType label2);
+
+  /** Merge the adjacent regions by increasing cost, while the cost
+   *  is lower than maxCost, and return the number of merges.
+   *
+   *  The cost functor is called as cost(graph, region1, region2) and
+   *  must only depend on the two regions (their statistics). */
+  template <class TCostFunctor>
+  unsigned long MergeByPriority(TCostFunctor & cost, RealType maxCost);
+
+private:
+  /** Entry of the merging priority queue */
+  struct MergeCandidate
+  {
+    RealType      cost;
+    LabelType     region1;
+    LabelType     region2;
+    unsigned long version1;
+    unsigned long version2;
+
+    /** Order of the queue: the lowest cost first, then the smallest labels */
+    bool operator >(const MergeCandidate & other) const
+    {
+      if (cost != other.cost)
+        {
+        return cost > other.cost;
+        }
+      if (region1 != other.region1)
+        {
+        return region1 > other.region1;
+        }
+      return region2 > other.region2;
+    }
+  };
+
+  /** Sort the recorded adjacencies and remove the duplicates */
+  void CompactAdjacencies();
+
+  /** Replace the labels of a neighbor list by their regions, and
+   *  remove the duplicates and the region itself */
+  void ResolveNeighbors(LabelType region, LabelVectorType & neighbors);
+
+  LabelType                    m_NumberOfRegions;
+  LabelType                    m_NumberOfRemainingRegions;
+  unsigned int                 m_NumberOfComponents;
+
+  /** Recorded adjacencies, waiting for BuildAdjacency() */
+  LabelPairVectorType          m_Adjacencies;
+  unsigned long                m_CompactionSize;
+
+  /** Compressed adjacency rows */
+  OffsetVectorType             m_Offsets;
+  LabelVectorType              m_Neighbors;
+
+  /** Union-find parents */
+  LabelVectorType              m_Parents;
+
+  /** Number of merges received by each region, used to detect the
+   *  stale entries of the merging queue */
+  std::vector<unsigned long>   m_Versions;
+
+  /** Adjacency of the merged regions */
+  std::vector<LabelVectorType> m_MergedNeighbors;
+
+  /** Statistics */
+  std::vector<unsigned long>   m_Sizes;
+  std::vector<RealType>        m_Sums;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbRegionAdjacencyGraph.txx"
+#endif
+
+#endif
@@ -0,0 +1,373 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef otbRegionAdjacencyGraph_txx
+#define otbRegionAdjacencyGraph_txx
+
+#include "otbRegionAdjacencyGraph.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+namespace otb
+{
+
+template <class TLabel>
+RegionAdjacencyGraph<TLabel>
+::RegionAdjacencyGraph()
+  : m_NumberOfRegions(0),
+    m_NumberOfRemainingRegions(0),
+    m_NumberOfComponents(0),
+    m_CompactionSize(1 << 20)
+{
+}
+
+template <class TLabel>
+void
+RegionAdjacencyGraph<TLabel>
+::Initialize(LabelType nbRegions, unsigned int nbComponents)
+{
+  m_NumberOfRegions = nbRegions;
+  m_NumberOfRemainingRegions = nbRegions;
+  m_NumberOfComponents = nbComponents;
+
+  m_Adjacencies.clear();
+  m_CompactionSize = 1 << 20;
+  m_Offsets.assign(static_cast<size_t>(nbRegions) + 1, 0);
+  m_Neighbors.clear();
+
+  m_Parents.resize(nbRegions);
+  for (LabelType label = 0; label < nbRegions; ++label)
+    {
+    m_Parents[label] = label;
+    }
+  m_Versions.assign(nbRegions, 0);
+  // allocated at the first merge
+  m_MergedNeighbors.clear();
+
+  m_Sizes.assign(nbRegions, 0);
+  m_Sums.assign(static_cast<size_t>(nbRegions) * nbComponents, 0.);
+}
+
+template <class TLabel>
+void
+RegionAdjacencyGraph<TLabel>
+::AddAdjacency(LabelType label1, LabelType label2)
+{
+  if (label1 == label2)
+    {
+    return;
+    }
+  const LabelPairType adjacency = label1 < label2 ? LabelPairType(label1, label2) : LabelPairType(label2, label1);
+  // the pixels along a boundary give the same adjacency many times in a row
+  if (!m_Adjacencies.empty() && m_Adjacencies.back() == adjacency)
+    {
+    return;
+    }
+  m_Adjacencies.push_back(adjacency);
+
+  // bound the memory used by the duplicates
+  if (m_Adjacencies.size() >= m_CompactionSize)
+    {
+    this->CompactAdjacencies();
+    m_CompactionSize = std::max(m_CompactionSize, 2 * static_cast<unsigned long>(m_Adjacencies.size()));
+    }
+}
+
+template <class TLabel>
+template <class TLabelImage>
+void
+RegionAdjacencyGraph<TLabel>
+::AddAdjacencies(const TLabelImage * image, const typename TLabelImage::RegionType & region)
+{
+  typedef typename TLabelImage::IndexType IndexType;
+  const unsigned int dimension = TLabelImage::ImageDimension;
+
+  IndexType lastIndex = image->GetBufferedRegion().GetUpperIndex();
+  itk::ImageRegionConstIteratorWithIndex<TLabelImage> it(image, region);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    const IndexType & index = it.GetIndex();
+    const LabelType label = static_cast<LabelType>(it.Get());
+    for (unsigned int d = 0; d < dimension; ++d)
+      {
+      if (index[d] < lastIndex[d])
+        {
+        IndexType neighborIndex = index;
+        ++neighborIndex[d];
+        this->AddAdjacency(label, static_cast<LabelType>(image->GetPixel(neighborIndex)));
+        }
+      }
+    }
+}
+
+template <class TLabel>
+void
+RegionAdjacencyGraph<TLabel>
+::CompactAdjacencies()
+{
+  std::sort(m_Adjacencies.begin(), m_Adjacencies.end());
+  m_Adjacencies.erase(std::unique(m_Adjacencies.begin(), m_Adjacencies.end()), m_Adjacencies.end());
+}
+
+template <class TLabel>
+void
+RegionAdjacencyGraph<TLabel>
+::BuildAdjacency()
+{
+  this->CompactAdjacencies();
+
+  if (!m_Adjacencies.empty() && m_Adjacencies.back().second >= m_NumberOfRegions)
+    {
+    itkGenericExceptionMacro(<< "Label " << m_Adjacencies.back().second << " is out of the "
+                             << m_NumberOfRegions << " regions of the graph");
+    }
+
+  // count the neighbors of each region
+  m_Offsets.assign(static_cast<size_t>(m_NumberOfRegions) + 1, 0);
+  for (typename LabelPairVectorType::const_iterator it = m_Adjacencies.begin(); it != m_Adjacencies.end(); ++it)
+    {
+    ++m_Offsets[it->first + 1];
+    ++m_Offsets[it->second + 1];
+    }
+  for (LabelType label = 0; label < m_NumberOfRegions; ++label)
+    {
+    m_Offsets[label + 1] += m_Offsets[label];
+    }
+
+  // fill the rows: since the pairs are sorted, each row is sorted
+  m_Neighbors.resize(2 * m_Adjacencies.size());
+  OffsetVectorType positions(m_Offsets.begin(), m_Offsets.end() - 1);
+  for (typename LabelPairVectorType::const_iterator it = m_Adjacencies.begin(); it != m_Adjacencies.end(); ++it)
+    {
+    m_Neighbors[positions[it->first]++] = it->second;
+    m_Neighbors[positions[it->second]++] = it->first;
+    }
+
+  // release the recorded adjacencies
+  LabelPairVectorType().swap(m_Adjacencies);
+}
+
+template <class TLabel>
+typename RegionAdjacencyGraph<TLabel>::LabelType
+RegionAdjacencyGraph<TLabel>
+::GetRegion(LabelType label)
+{
+  // path halving
+  while (m_Parents[label] != label)
+    {
+    m_Parents[label] = m_Parents[m_Parents[label]];
+    label = m_Parents[label];
+    }
+  return label;
+}
+
+template <class TLabel>
+typename RegionAdjacencyGraph<TLabel>::RealType
+RegionAdjacencyGraph<TLabel>
+::GetSquaredMeanDistance(LabelType region1, LabelType region2) const
+{
+  const RealType * sum1 = this->GetSum(region1);
+  const RealType * sum2 = this->GetSum(region2);
+  const RealType   size1 = m_Sizes[region1];
+  const RealType   size2 = m_Sizes[region2];
+
+  RealType distance = 0.;
+  for (unsigned int c = 0; c < m_NumberOfComponents; ++c)
+    {
+    const RealType e = sum1[c] / size1 - sum2[c] / size2;
+    distance += e * e;
+    }
+  return distance;
+}
+
+template <class TLabel>
+void
+RegionAdjacencyGraph<TLabel>
+::ResolveNeighbors(LabelType region, LabelVectorType & neighbors)
+{
+  for (typename LabelVectorType::iterator it = neighbors.begin(); it != neighbors.end(); ++it)
+    {
+    *it = this->GetRegion(*it);
+    }
+  std::sort(neighbors.begin(), neighbors.end());
+  neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+  typename LabelVectorType::iterator self = std::lower_bound(neighbors.begin(), neighbors.end(), region);
+  if (self != neighbors.end() && *self == region)
+    {
+    neighbors.erase(self);
+    }
+}
+
+template <class TLabel>
+void
+RegionAdjacencyGraph<TLabel>
+::GetAdjacentRegions(LabelType region, LabelVectorType & neighbors)
+{
+  if (m_Versions[region] == 0)
+    {
+    // never merged: the CSR row
+    neighbors.assign(this->GetNeighborsBegin(region), this->GetNeighborsEnd(region));
+    }
+  else
+    {
+    // keep the resolved list for the next queries
+    this->ResolveNeighbors(region, m_MergedNeighbors[region]);
+    neighbors = m_MergedNeighbors[region];
+    return;
+    }
+  this->ResolveNeighbors(region, neighbors);
+}
+
+template <class TLabel>
+typename RegionAdjacencyGraph<TLabel>::LabelType
+RegionAdjacencyGraph<TLabel>
+::Merge(LabelType label1, LabelType label2)
+{
+  LabelType region1 = this->GetRegion(label1);
+  LabelType region2 = this->GetRegion(label2);
+  if (region1 == region2)
+    {
+    return region1;
+    }
+  if (region2 < region1)
+    {
+    std::swap(region1, region2);
+    }
+
+  if (m_MergedNeighbors.empty())
+    {
+    m_MergedNeighbors.resize(m_NumberOfRegions);
+    }
+
+  // gather the neighbors of the two regions in the kept one
+  LabelVectorType & neighbors = m_MergedNeighbors[region1];
+  if (m_Versions[region1] == 0)
+    {
+    neighbors.assign(this->GetNeighborsBegin(region1), this->GetNeighborsEnd(region1));
+    }
+  if (m_Versions[region2] == 0)
+    {
+    neighbors.insert(neighbors.end(), this->GetNeighborsBegin(region2), this->GetNeighborsEnd(region2));
+    }
+  else
+    {
+    neighbors.insert(neighbors.end(), m_MergedNeighbors[region2].begin(), m_MergedNeighbors[region2].end());
+    LabelVectorType().swap(m_MergedNeighbors[region2]);
+    }
+
+  m_Parents[region2] = region1;
+  ++m_Versions[region1];
+  --m_NumberOfRemainingRegions;
+
+  // statistics
+  m_Sizes[region1] += m_Sizes[region2];
+  m_Sizes[region2] = 0;
+  if (m_NumberOfComponents > 0)
+    {
+    RealType * sum1 = &m_Sums[static_cast<size_t>(region1) * m_NumberOfComponents];
+    RealType * sum2 = &m_Sums[static_cast<size_t>(region2) * m_NumberOfComponents];
+    for (unsigned int c = 0; c < m_NumberOfComponents; ++c)
+      {
+      sum1[c] += sum2[c];
+      sum2[c] = 0.;
+      }
+    }
+
+  this->ResolveNeighbors(region1, neighbors);
+  return region1;
+}
+
+template <class TLabel>
+template <class TCostFunctor>
+unsigned long
+RegionAdjacencyGraph<TLabel>
+::MergeByPriority(TCostFunctor & cost, RealType maxCost)
+{
+  typedef std::priority_queue<MergeCandidate, std::vector<MergeCandidate>, std::greater<MergeCandidate> > QueueType;
+  QueueType queue;
+
+  MergeCandidate candidate;
+  LabelVectorType neighbors;
+
+  // initial candidates, each adjacency once
+  for (LabelType region = 0; region < m_NumberOfRegions; ++region)
+    {
+    if (!this->IsRegion(region))
+      {
+      continue;
+      }
+    this->GetAdjacentRegions(region, neighbors);
+    for (typename LabelVectorType::const_iterator it = std::upper_bound(neighbors.begin(), neighbors.end(), region);
+         it != neighbors.end(); ++it)
+      {
+      candidate.cost = cost(*this, region, *it);
+      if (candidate.cost < maxCost)
+        {
+        candidate.region1 = region;
+        candidate.region2 = *it;
+        candidate.version1 = m_Versions[region];
+        candidate.version2 = m_Versions[*it];
+        queue.push(candidate);
+        }
+      }
+    }
+
+  unsigned long nbMerges = 0;
+  while (!queue.empty())
+    {
+    const MergeCandidate top = queue.top();
+    queue.pop();
+
+    // stale entry: one of the regions has been merged since
+    if (!this->IsRegion(top.region1) || !this->IsRegion(top.region2)
+        || m_Versions[top.region1] != top.version1 || m_Versions[top.region2] != top.version2)
+      {
+      continue;
+      }
+
+    const LabelType region = this->Merge(top.region1, top.region2);
+    ++nbMerges;
+
+    // new candidates of the merged region
+    this->GetAdjacentRegions(region, neighbors);
+    for (typename LabelVectorType::const_iterator it = neighbors.begin(); it != neighbors.end(); ++it)
+      {
+      candidate.cost = cost(*this, region, *it);
+      if (candidate.cost < maxCost)
+        {
+        candidate.region1 = std::min(region, *it);
+        candidate.region2 = std::max(region, *it);
+        candidate.version1 = m_Versions[candidate.region1];
+        candidate.version2 = m_Versions[candidate.region2];
+        queue.push(candidate);
+        }
+      }
+    }
+
+  return nbMerges;
+}
+
+} // end namespace otb
+
+#endif
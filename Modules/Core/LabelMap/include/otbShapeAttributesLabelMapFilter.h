@@ -29,6 +29,8 @@
 #include "otbFlusserPathFunction.h"
 #include "otbSimplifyPathFunctor.h"
 
+#include <vector>
+
 
 namespace otb
 {
@@ -71,6 +73,7 @@ public:
   itkStaticConstMacro(ImageDimension, unsigned int, TLabelObject::ImageDimension);
   typedef itk::ImageRegion< TLabelObject::ImageDimension > RegionType;
   typedef itk::Offset< TLabelObject::ImageDimension > OffsetType;
+  typedef typename LabelObjectType::LineType LineType;
   /** Constructor */
   ShapeAttributesLabelObjectFunctor();
 
@@ -111,8 +114,8 @@ public:
   /** Get the compute reduced attributes set flag */
   bool GetReducedAttributeSet() const;
 
-  /** Set the label image (used only to compute
-   *  the Feret diameter */
+  /** Set the label image (only its geometry is used: origin,
+   *  spacing and largest possible region) */
   void SetLabelImage(const TLabelImage * image);
 
   /** Get the label image */
@@ -144,6 +147,37 @@ private:
 
   double ComputePerimeter(LabelObjectType *labelObject, const RegionType & region);
 
+  /** Compute the perimeter of a 2D object in a single pass over its
+   *  lines sorted by row, without the intermediate line image */
+  double ComputeLinesPerimeter(LabelObjectType *labelObject);
+
+  typedef std::vector<LineType>                    LineVectorType;
+  typedef typename LineVectorType::const_iterator  LineVectorConstIteratorType;
+
+  /** Accumulate the intercepts between the lines of a row and the
+   *  lines of one of its neighbor rows */
+  static void AccumulateNeighborIntercepts(LineVectorConstIteratorType lBegin,
+                                           LineVectorConstIteratorType lEnd,
+                                           LineVectorConstIteratorType nBegin,
+                                           LineVectorConstIteratorType nEnd,
+                                           itk::SizeValueType & intercepts,
+                                           itk::SizeValueType & diagonalIntercepts);
+
+  /** Order the lines by row, then by column */
+  static bool LineLess(const LineType & l1, const LineType & l2);
+
+  typedef itk::Point<double, TLabelObject::ImageDimension> PointType;
+  typedef std::vector<PointType>                           PointVectorType;
+
+  /** Compute the maximum Feret diameter from the ends of the lines */
+  double ComputeMaximumFeretDiameter(LabelObjectType *labelObject) const;
+
+  /** Lexicographic order on the points, used by the convex hull */
+  static bool PointLess(const PointType & p1, const PointType & p2);
+
+  /** Cross product of (a - o) and (b - o) in the first two dimensions */
+  static double Cross(const PointType & o, const PointType & a, const PointType & b);
+
   typedef itk::Offset<2>                                                          Offset2Type;
   typedef itk::Offset<3>                                                          Offset3Type;
   typedef itk::Vector<double, 2>                                                  Spacing2Type;
@@ -173,7 +207,7 @@ private:
   /** Compute only a reduced attribute set */
   bool m_ReducedAttributeSet;
 
-  /** The label image is used to compute the feret diameter */
+  /** The label image gives the geometry of the label map */
   typename LabelImageType::ConstPointer m_LabelImage;
 };
 
@@ -194,9 +228,15 @@ private:
  * physical size, elongation, Feret diameter (if activated),
  * perimeter (if activated) and roundness (if activated).
  *
- * For the sake of speed optimization, the original label image must
- * be given to the filter. If not, the filter will convert the
- * LabelObjectMap back to a LabelImage structure.
+ * The Feret diameter and the perimeter are computed from the run-length
+ * lines of each object, so that their cost is linear in the number of
+ * lines. In 2D, the Feret diameter is the diameter of the convex hull of
+ * the line ends, found with rotating calipers, and the perimeter is
+ * computed in a single pass over the lines sorted by row. The label
+ * objects are processed in parallel by the threads of the filter.
+ *
+ * The label image is optional: only its geometry is used. If it is
+ * not given, the geometry of the input label map is used.
  *
  * \sa itk::ShapeLabelMapFilter
  *
@@ -242,7 +282,7 @@ public:
 
   /**
    * Set/Get whether the maximum Feret diameter should be computed or not. The
-   * defaut value is false, because of the high computation time required.
+   * defaut value is false, to assure backward compatibility.
    */
   void SetComputeFeretDiameter(bool flag);
   bool GetComputeFeretDiameter() const;
@@ -250,7 +290,7 @@ public:
 
   /**
    * Set/Get whether the perimeter should be computed or not. The defaut value
-   * is false, because of the high computation time required.
+   * is false, to assure backward compatibility.
    */
   void SetComputePerimeter(bool flag);
   bool GetComputePerimeter() const;
@@ -278,8 +318,7 @@ public:
   bool GetReducedAttributeSet() const;
   itkBooleanMacro(ReducedAttributeSet);
 
-  /** Set/Get the label image (this is used only to compute the Feret
-   *  diameter) */
+  /** Set/Get the label image (only its geometry is used) */
   void SetLabelImage(const TLabelImage *);
   const TLabelImage * GetLabelImage() const;
 
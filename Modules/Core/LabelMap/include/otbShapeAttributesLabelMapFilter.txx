@@ -24,10 +24,7 @@
 
 #include "otbShapeAttributesLabelMapFilter.h"
 #include "itkProgressReporter.h"
-#include "itkConstNeighborhoodIterator.h"
 #include "itkConstShapedNeighborhoodIterator.h"
-#include "itkLabelMapToLabelImageFilter.h"
-#include "itkConstantBoundaryCondition.h"
 #include "itkGeometryUtilities.h"
 #include "itkConnectedComponentAlgorithm.h"
 #include "vnl/algo/vnl_real_eigensystem.h"
@@ -35,6 +32,7 @@
 
 #include "otbMacro.h"
 #include <deque>
+#include <algorithm>
 
 namespace otb {
 
@@ -169,8 +167,7 @@ ShapeAttributesLabelObjectFunctor<TLabelObject, TLabelImage>
   return m_ReducedAttributeSet;
 }
 
-/** Set the label image (used only to compute
- *  the Feret diameter */
+/** Set the label image (only its geometry is used) */
 template <class TLabelObject, class TLabelImage>
 void
 ShapeAttributesLabelObjectFunctor<TLabelObject, TLabelImage>
@@ -197,8 +194,6 @@ void
 ShapeAttributesLabelObjectFunctor<TLabelObject, TLabelImage>
 ::operator() (LabelObjectType * lo)
 {
-  const typename LabelObjectType::LabelType& label = lo->GetLabel();
-
   // TODO: compute sizePerPixel, borderMin and borderMax in BeforeThreadedGenerateData() ?
 
   // compute the size per pixel, to be used later
@@ -563,78 +558,7 @@ ShapeAttributesLabelObjectFunctor<TLabelObject, TLabelImage>
 
   if (m_ComputeFeretDiameter)
     {
-    // init the vars
-    unsigned long ssize = 0;
-    typedef typename std::deque<typename LabelObjectType::IndexType> IndexListType;
-    IndexListType idxList;
-
-    // Line iterator
-    ConstLineIteratorType llit = ConstLineIteratorType(lo);
-    llit.GoToBegin();
-
-    typedef typename itk::ConstNeighborhoodIterator<LabelImageType> NeighborIteratorType;
-    typename TLabelImage::SizeType neighborHoodRadius;
-    neighborHoodRadius.Fill(1);
-    NeighborIteratorType it(neighborHoodRadius, m_LabelImage, m_LabelImage->GetBufferedRegion());
-    itk::ConstantBoundaryCondition<LabelImageType> lcbc;
-    // use label + 1 to have a label different of the current label on the border
-    lcbc.SetConstant(label + 1);
-    it.OverrideBoundaryCondition(&lcbc);
-    it.GoToBegin();
-
-    // iterate over all the lines
-    while ( !llit.IsAtEnd() )
-      {
-      const typename LabelObjectType::IndexType& firstIdx = llit.GetLine().GetIndex();
-      unsigned long                              length = llit.GetLine().GetLength();
-
-      long endIdx0 = firstIdx[0] + length;
-      for (typename LabelObjectType::IndexType idx = firstIdx; idx[0] < endIdx0; idx[0]++)
-        {
-
-        // move the iterator to the new location
-        it += idx - it.GetIndex();
-
-        // push the pixel in the list if it is on the border of the object
-        for (unsigned i = 0; i < it.Size(); ++i)
-          {
-          if (it.GetPixel(i) != label)
-            {
-            idxList.push_back(idx);
-            ssize++;
-            break;
-            }
-          }
-        }
-      ++llit;
-      }
-
-    // we can now search the feret diameter
-    double feretDiameter = 0;
-    for (typename IndexListType::const_iterator iIt1 = idxList.begin();
-         iIt1 != idxList.end();
-         iIt1++)
-      {
-      typename IndexListType::const_iterator iIt2 = iIt1;
-      for (iIt2++; iIt2 != idxList.end(); iIt2++)
-        {
-        // Compute the length between the 2 indexes
-        double length = 0;
-        for (DimensionType i = 0; i < LabelObjectType::ImageDimension; ++i)
-          {
-          length += vcl_pow((iIt1->operator[] (i) - iIt2->operator[] (i)) * m_LabelImage->GetSpacing()[i], 2);
-          }
-        if (feretDiameter < length)
-          {
-          feretDiameter = length;
-          }
-        }
-      }
-    // final computation
-    feretDiameter = vcl_sqrt(feretDiameter);
-
-    // finally put the values in the label object
-    lo->SetAttribute("SHAPE::FeretDiameter", feretDiameter);
+    lo->SetAttribute("SHAPE::FeretDiameter", this->ComputeMaximumFeretDiameter(lo));
     }
 
   // be sure that the calculator has the perimeter estimation for that label.
@@ -694,6 +618,11 @@ double
 ShapeAttributesLabelObjectFunctor<TLabelObject, TLabelImage>
 ::ComputePerimeter(LabelObjectType *labelObject, const RegionType & region)
 {
+  if (ImageDimension == 2)
+    {
+    return this->ComputeLinesPerimeter(labelObject);
+    }
+
   // store the lines in a N-1D image of vectors
   typedef std::deque< typename LabelObjectType::LineType > VectorLineType;
   typedef itk::Image< VectorLineType, ImageDimension - 1 > LineImageType;
@@ -857,6 +786,264 @@ ShapeAttributesLabelObjectFunctor<TLabelObject, TLabelImage>
   return perimeter;
 }
 
+template <class TLabelObject, class TLabelImage>
+bool
+ShapeAttributesLabelObjectFunctor<TLabelObject, TLabelImage>
+::LineLess(const LineType & l1, const LineType & l2)
+{
+  if (l1.GetIndex()[1] != l2.GetIndex()[1])
+    {
+    return l1.GetIndex()[1] < l2.GetIndex()[1];
+    }
+  return l1.GetIndex()[0] < l2.GetIndex()[0];
+}
+
+template <class TLabelObject, class TLabelImage>
+void
+ShapeAttributesLabelObjectFunctor<TLabelObject, TLabelImage>
+::AccumulateNeighborIntercepts(LineVectorConstIteratorType lBegin,
+                               LineVectorConstIteratorType lEnd,
+                               LineVectorConstIteratorType nBegin,
+                               LineVectorConstIteratorType nEnd,
+                               itk::SizeValueType & intercepts,
+                               itk::SizeValueType & diagonalIntercepts)
+{
+  if (nBegin == nEnd)
+    {
+    // no line in the neighbors - all the lines are on the contour
+    for (LineVectorConstIteratorType li = lBegin; li != lEnd; ++li)
+      {
+      intercepts += li->GetLength();
+      diagonalIntercepts += li->GetLength() * 2;
+      }
+    return;
+    }
+
+  // same merge of the two rows as in ComputePerimeter()
+  LineVectorConstIteratorType li = lBegin;
+  LineVectorConstIteratorType ni = nBegin;
+
+  itk::IndexValueType lZero = 0;
+  itk::IndexValueType lMin = 0;
+  itk::IndexValueType lMax = 0;
+
+  itk::IndexValueType nMin = itk::NumericTraits<itk::IndexValueType>::NonpositiveMin() + 1;
+  itk::IndexValueType nMax = ni->GetIndex()[0] - 1;
+
+  while (li != lEnd)
+    {
+    lMin = li->GetIndex()[0];
+    lMax = lMin + li->GetLength() - 1;
+
+    intercepts += vnl_math_max( lZero, vnl_math_min(lMax, nMax) - vnl_math_max(lMin, nMin) + 1 );
+    // left and right diagonal intercepts
+    diagonalIntercepts += vnl_math_max( lZero, vnl_math_min(lMax, nMax+1) - vnl_math_max(lMin, nMin+1) + 1 );
+    diagonalIntercepts += vnl_math_max( lZero, vnl_math_min(lMax, nMax-1) - vnl_math_max(lMin, nMin-1) + 1 );
+
+    if (nMax <= lMax)
+      {
+      // go to next neighbor
+      nMin = ni->GetIndex()[0] + ni->GetLength();
+      ++ni;
+
+      if (ni != nEnd)
+        {
+        nMax = ni->GetIndex()[0] - 1;
+        }
+      else
+        {
+        nMax = itk::NumericTraits<itk::IndexValueType>::max() - 1;
+        }
+      }
+    else
+      {
+      // go to next line
+      ++li;
+      }
+    }
+}
+
+template <class TLabelObject, class TLabelImage>
+double
+ShapeAttributesLabelObjectFunctor<TLabelObject, TLabelImage>
+::ComputeLinesPerimeter(LabelObjectType *labelObject)
+{
+  // sort the lines by row: the rows and their neighbors are then
+  // contiguous ranges of the vector
+  LineVectorType lines;
+  lines.reserve(labelObject->GetNumberOfLines());
+  for (ConstLineIteratorType lit(labelObject); !lit.IsAtEnd(); ++lit)
+    {
+    lines.push_back(lit.GetLine());
+    }
+  std::sort(lines.begin(), lines.end(), &Self::LineLess);
+
+  itk::SizeValueType xIntercepts = 0;
+  itk::SizeValueType yIntercepts = 0;
+  itk::SizeValueType xyIntercepts = 0;
+
+  LineVectorConstIteratorType prevBegin = lines.begin();
+  LineVectorConstIteratorType prevEnd = lines.begin();
+  LineVectorConstIteratorType rowBegin = lines.begin();
+  while (rowBegin != lines.end())
+    {
+    const itk::IndexValueType row = rowBegin->GetIndex()[1];
+    LineVectorConstIteratorType rowEnd = rowBegin;
+    while (rowEnd != lines.end() && rowEnd->GetIndex()[1] == row)
+      {
+      ++rowEnd;
+      }
+    LineVectorConstIteratorType nextEnd = rowEnd;
+    while (nextEnd != lines.end() && nextEnd->GetIndex()[1] == row + 1)
+      {
+      ++nextEnd;
+      }
+
+    // there are two intercepts on the 0 axis for each line
+    xIntercepts += 2 * (rowEnd - rowBegin);
+
+    // previous row
+    if (prevBegin != prevEnd && prevBegin->GetIndex()[1] == row - 1)
+      {
+      AccumulateNeighborIntercepts(rowBegin, rowEnd, prevBegin, prevEnd, yIntercepts, xyIntercepts);
+      }
+    else
+      {
+      AccumulateNeighborIntercepts(rowBegin, rowEnd, rowEnd, rowEnd, yIntercepts, xyIntercepts);
+      }
+
+    // next row
+    AccumulateNeighborIntercepts(rowBegin, rowEnd, rowEnd, nextEnd, yIntercepts, xyIntercepts);
+
+    prevBegin = rowBegin;
+    prevEnd = rowEnd;
+    rowBegin = rowEnd;
+    }
+
+  typedef typename std::map<OffsetType, itk::SizeValueType, typename OffsetType::LexicographicCompare> MapInterceptType;
+  MapInterceptType intercepts;
+  OffsetType no;
+  no.Fill(0);
+  no[0] = 1;
+  intercepts[no] = xIntercepts;
+  no[0] = 0;
+  no[1] = 1;
+  intercepts[no] = yIntercepts;
+  no[0] = 1;
+  intercepts[no] = xyIntercepts;
+
+  return PerimeterFromInterceptCount( intercepts, m_LabelImage->GetSpacing() );
+}
+
+template <class TLabelObject, class TLabelImage>
+bool
+ShapeAttributesLabelObjectFunctor<TLabelObject, TLabelImage>
+::PointLess(const PointType & p1, const PointType & p2)
+{
+  for (DimensionType i = 0; i < ImageDimension; ++i)
+    {
+    if (p1[i] != p2[i])
+      {
+      return p1[i] < p2[i];
+      }
+    }
+  return false;
+}
+
+template <class TLabelObject, class TLabelImage>
+double
+ShapeAttributesLabelObjectFunctor<TLabelObject, TLabelImage>
+::Cross(const PointType & o, const PointType & a, const PointType & b)
+{
+  return (a[0] - o[0]) * (b[1] - o[1]) - (a[1] - o[1]) * (b[0] - o[0]);
+}
+
+template <class TLabelObject, class TLabelImage>
+double
+ShapeAttributesLabelObjectFunctor<TLabelObject, TLabelImage>
+::ComputeMaximumFeretDiameter(LabelObjectType *labelObject) const
+{
+  // The pixels inside a line are not extreme points of the object:
+  // the diameter is reached between two line ends.
+  const typename LabelImageType::SpacingType & spacing = m_LabelImage->GetSpacing();
+  PointVectorType points;
+  points.reserve(2 * labelObject->GetNumberOfLines());
+  for (ConstLineIteratorType lit(labelObject); !lit.IsAtEnd(); ++lit)
+    {
+    const typename LabelObjectType::IndexType & idx = lit.GetLine().GetIndex();
+    const unsigned long length = lit.GetLine().GetLength();
+    PointType p;
+    for (DimensionType i = 0; i < ImageDimension; ++i)
+      {
+      p[i] = idx[i] * spacing[i];
+      }
+    points.push_back(p);
+    if (length > 1)
+      {
+      p[0] = (idx[0] + static_cast<long>(length) - 1) * spacing[0];
+      points.push_back(p);
+      }
+    }
+
+  double feretDiameter = 0;
+  if (ImageDimension != 2 || points.size() < 3)
+    {
+    for (typename PointVectorType::const_iterator pIt1 = points.begin(); pIt1 != points.end(); ++pIt1)
+      {
+      for (typename PointVectorType::const_iterator pIt2 = pIt1 + 1; pIt2 != points.end(); ++pIt2)
+        {
+        feretDiameter = std::max(feretDiameter, pIt1->SquaredEuclideanDistanceTo(*pIt2));
+        }
+      }
+    return vcl_sqrt(feretDiameter);
+    }
+
+  // convex hull of the line ends (Andrew's monotone chain), counter-clockwise
+  std::sort(points.begin(), points.end(), &Self::PointLess);
+  const long nbPoints = points.size();
+  PointVectorType hull(2 * nbPoints);
+  long k = 0;
+  for (long i = 0; i < nbPoints; ++i)
+    {
+    while (k >= 2 && Cross(hull[k - 2], hull[k - 1], points[i]) <= 0)
+      {
+      --k;
+      }
+    hull[k++] = points[i];
+    }
+  for (long i = nbPoints - 2, lower = k + 1; i >= 0; --i)
+    {
+    while (k >= lower && Cross(hull[k - 2], hull[k - 1], points[i]) <= 0)
+      {
+      --k;
+      }
+    hull[k++] = points[i];
+    }
+  // the last point is the first one
+  const long nbHull = k - 1;
+
+  if (nbHull < 3)
+    {
+    return vcl_sqrt(hull[0].SquaredEuclideanDistanceTo(hull[1]));
+    }
+
+  // rotating calipers: for each edge of the hull, the farthest vertex
+  // moves forward monotonically
+  long j = 1;
+  for (long i = 0; i < nbHull; ++i)
+    {
+    const long ni = (i + 1) % nbHull;
+    while (Cross(hull[i], hull[ni], hull[(j + 1) % nbHull]) > Cross(hull[i], hull[ni], hull[j]))
+      {
+      j = (j + 1) % nbHull;
+      }
+    feretDiameter = std::max(feretDiameter, hull[i].SquaredEuclideanDistanceTo(hull[j]));
+    feretDiameter = std::max(feretDiameter, hull[ni].SquaredEuclideanDistanceTo(hull[j]));
+    }
+
+  return vcl_sqrt(feretDiameter);
+}
+
 template <class TLabelObject, class TLabelImage>
 template<class TMapIntercept, class TSpacing>
 double
@@ -1218,14 +1405,11 @@ ShapeAttributesLabelMapFilter<TImage, TLabelImage>
   Superclass::BeforeThreadedGenerateData();
   if (!this->GetFunctor().GetLabelImage())
     {
-    // generate an image of the labelized image
-    typedef itk::LabelMapToLabelImageFilter<TImage, TLabelImage> LCI2IType;
-    typename LCI2IType::Pointer lci2i = LCI2IType::New();
-    lci2i->SetInput(this->GetInput());
-    // respect the number of threads of the filter
-    lci2i->SetNumberOfThreads(this->GetNumberOfThreads());
-    lci2i->Update();
-    this->GetFunctor().SetLabelImage(lci2i->GetOutput());
+    // only the geometry of the label image is needed: the Feret
+    // diameter and the perimeter are computed from the lines
+    typename TLabelImage::Pointer labelImage = TLabelImage::New();
+    labelImage->CopyInformation(this->GetInput());
+    this->GetFunctor().SetLabelImage(labelImage);
     }
 
 /*   // delegate the computation of the perimeter to a dedicated calculator */
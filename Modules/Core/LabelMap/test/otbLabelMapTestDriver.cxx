@@ -45,6 +45,8 @@ void RegisterTests()
   REGISTER_TEST(otbNormalizeAttributesLabelMapFilter);
   REGISTER_TEST(otbNormalizeAttributesLabelMapFilterNew);
   REGISTER_TEST(otbShapeAttributesLabelMapFilterNew);
+  REGISTER_TEST(otbShapeAttributesLabelMapFilter);
+  REGISTER_TEST(otbRegionAdjacencyGraph);
   REGISTER_TEST(otbBandsStatisticsAttributesLabelMapFilter);
   REGISTER_TEST(otbBandsStatisticsAttributesLabelMapFilterNew);
 }
@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#include "otbRegionAdjacencyGraph.h"
+#include "otbImage.h"
+#include "itkVariableLengthVector.h"
+#include "vnl/vnl_math.h"
+
+#include <algorithm>
+
+namespace
+{
+/** Cost of a merge: squared distance between the means */
+struct MeanDistanceCost
+{
+  typedef otb::RegionAdjacencyGraph<unsigned int> GraphType;
+
+  double operator()(const GraphType & graph, unsigned int region1, unsigned int region2) const
+  {
+    return graph.GetSquaredMeanDistance(region1, region2);
+  }
+};
+}
+
+int otbRegionAdjacencyGraph(int itkNotUsed(argc), char * itkNotUsed(argv)[])
+{
+  typedef unsigned int                            LabelType;
+  typedef otb::Image<LabelType, 2>                LabelImageType;
+  typedef otb::RegionAdjacencyGraph<LabelType>    GraphType;
+  typedef GraphType::LabelVectorType              LabelVectorType;
+
+  // Label image:
+  // 1 1 2 2
+  // 1 3 3 2
+  // 4 4 3 5
+  LabelImageType::Pointer image = LabelImageType::New();
+  LabelImageType::SizeType size;
+  size[0] = 4;
+  size[1] = 3;
+  image->SetRegions(size);
+  image->Allocate();
+  const LabelType labels[12] = {1, 1, 2, 2,
+                                1, 3, 3, 2,
+                                4, 4, 3, 5};
+  // spectral value of each label, label 0 is not used
+  const double values[6] = {0., 10., 11., 30., 12., 31.};
+
+  GraphType graph;
+  graph.Initialize(6, 1);
+
+  LabelImageType::IndexType index;
+  itk::VariableLengthVector<double> pixel(1);
+  for (index[1] = 0; index[1] < 3; ++index[1])
+    {
+    for (index[0] = 0; index[0] < 4; ++index[0])
+      {
+      const LabelType label = labels[index[1] * 4 + index[0]];
+      image->SetPixel(index, label);
+      pixel[0] = values[label];
+      graph.AddPixel(label, pixel);
+      }
+    }
+
+  graph.AddAdjacencies(image.GetPointer(), image->GetLargestPossibleRegion());
+  graph.BuildAdjacency();
+
+  // Expected adjacency: 1-2 1-3 1-4 2-3 2-5 3-4 3-5
+  const LabelType expectedNeighbors[6][4] = {{0, 0, 0, 0},
+                                             {2, 3, 4, 0},
+                                             {1, 3, 5, 0},
+                                             {1, 2, 4, 5},
+                                             {1, 3, 0, 0},
+                                             {2, 3, 0, 0}};
+  const unsigned int expectedDegrees[6] = {0, 3, 3, 4, 2, 2};
+
+  if (graph.GetNumberOfAdjacencies() != 7)
+    {
+    std::cerr << "Wrong number of adjacencies: " << graph.GetNumberOfAdjacencies() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  for (LabelType label = 0; label < 6; ++label)
+    {
+    LabelVectorType neighbors(graph.GetNeighborsBegin(label), graph.GetNeighborsEnd(label));
+    if (neighbors.size() != expectedDegrees[label]
+        || !std::equal(neighbors.begin(), neighbors.end(), expectedNeighbors[label]))
+      {
+      std::cerr << "Wrong neighbors for label " << label << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Region without the last row and column, as scanned by the region
+  // merging filters: the pixels of the last row and column are still
+  // neighbors, only 2-5 and 3-5 are missed
+  LabelImageType::RegionType innerRegion = image->GetLargestPossibleRegion();
+  size[0] = 3;
+  size[1] = 2;
+  innerRegion.SetSize(size);
+
+  GraphType innerGraph;
+  innerGraph.Initialize(6, 1);
+  innerGraph.AddAdjacencies(image.GetPointer(), innerRegion);
+  innerGraph.BuildAdjacency();
+  if (innerGraph.GetNumberOfAdjacencies() != 5 || innerGraph.GetNeighborsBegin(5) != innerGraph.GetNeighborsEnd(5))
+    {
+    std::cerr << "Wrong number of adjacencies in the inner region: " << innerGraph.GetNumberOfAdjacencies() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Merge 3 and 5, then 2 and 3: region 2 now contains 2, 3 and 5
+  if (graph.Merge(5, 3) != 3 || graph.Merge(3, 2) != 2 || graph.GetRegion(5) != 2)
+    {
+    std::cerr << "Wrong merged regions" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  LabelVectorType neighbors;
+  graph.GetAdjacentRegions(2, neighbors);
+  if (neighbors.size() != 2 || neighbors[0] != 1 || neighbors[1] != 4)
+    {
+    std::cerr << "Wrong neighbors for the merged region" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // sizes: 2 -> 3 pixels, 3 -> 3 pixels, 5 -> 1 pixel
+  const double expectedMean = (3 * 11. + 3 * 30. + 31.) / 7.;
+  if (graph.GetSize(2) != 7 || vnl_math_abs(graph.GetMean(2, 0) - expectedMean) > 1e-12
+      || graph.GetNumberOfRemainingRegions() != 4)
+    {
+    std::cerr << "Wrong statistics for the merged region" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Merge by priority the regions with a squared distance lower than 5:
+  // 1 (10.) and 4 (12.)
+  // are merged, the region 2 (22.) stays apart
+  MeanDistanceCost cost;
+  const unsigned long nbMerges = graph.MergeByPriority(cost, 5.);
+  if (nbMerges != 1 || graph.GetRegion(4) != 1 || graph.GetRegion(2) != 2)
+    {
+    std::cerr << "Wrong priority merging: " << nbMerges << " merges" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#include "otbAttributesMapLabelObject.h"
+#include "otbShapeAttributesLabelMapFilter.h"
+#include "otbImage.h"
+#include "itkLabelMap.h"
+#include "itkLabelImageToLabelMapFilter.h"
+#include "itkLabelImageToShapeLabelMapFilter.h"
+#include "itkImageRegionIteratorWithIndex.h"
+
+int otbShapeAttributesLabelMapFilter(int itkNotUsed(argc), char * itkNotUsed(argv)[])
+{
+  typedef unsigned short                                         LabelType;
+  typedef otb::Image<LabelType, 2>                               LabelImageType;
+  typedef otb::AttributesMapLabelObject<LabelType, 2, double>    LabelObjectType;
+  typedef itk::LabelMap<LabelObjectType>                         LabelMapType;
+  typedef itk::LabelImageToLabelMapFilter<LabelImageType, LabelMapType> LabelMapFilterType;
+  typedef otb::ShapeAttributesLabelMapFilter<LabelMapType>       ShapeFilterType;
+  typedef itk::LabelImageToShapeLabelMapFilter<LabelImageType>   ReferenceFilterType;
+  typedef ReferenceFilterType::OutputImageType                   ReferenceLabelMapType;
+
+  // Synthetic objects, some of them touching the image border
+  LabelImageType::Pointer image = LabelImageType::New();
+  LabelImageType::SizeType size;
+  size[0] = 64;
+  size[1] = 48;
+  image->SetRegions(size);
+  LabelImageType::SpacingType spacing;
+  spacing[0] = 0.5;
+  spacing[1] = 2.;
+  image->SetSpacing(spacing);
+  image->Allocate();
+  image->FillBuffer(0);
+
+  itk::ImageRegionIteratorWithIndex<LabelImageType> it(image, image->GetLargestPossibleRegion());
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    const long x = it.GetIndex()[0];
+    const long y = it.GetIndex()[1];
+    const long r2 = (x - 16) * (x - 16) + (y - 14) * (y - 14);
+    if (r2 <= 100)
+      {
+      // disk with a hole
+      it.Set(r2 >= 16 ? 1 : 0);
+      }
+    else if (x >= 30 && x < 60 && y >= 2 && y < 8)
+      {
+      // L shape, first branch
+      it.Set(2);
+      }
+    else if (x >= 54 && x < 60 && y >= 8 && y < 30)
+      {
+      // L shape, second branch
+      it.Set(2);
+      }
+    else if (x >= 5 && x < 40 && y >= 30 && x - 5 == 2 * (y - 30))
+      {
+      // disconnected diagonal dots
+      it.Set(3);
+      }
+    else if (x == 45 && y == 40)
+      {
+      // single pixel
+      it.Set(4);
+      }
+    else if (y >= 38 && (x + y) % 7 < 3)
+      {
+      // stripes touching the border
+      it.Set(5);
+      }
+    }
+
+  LabelMapFilterType::Pointer labelMapFilter = LabelMapFilterType::New();
+  labelMapFilter->SetInput(image);
+  labelMapFilter->SetBackgroundValue(0);
+
+  ShapeFilterType::Pointer shapeFilter = ShapeFilterType::New();
+  shapeFilter->SetInput(labelMapFilter->GetOutput());
+  shapeFilter->SetComputeFeretDiameter(true);
+  shapeFilter->SetComputePerimeter(true);
+  shapeFilter->SetComputePolygon(false);
+  shapeFilter->SetComputeFlusser(false);
+  shapeFilter->Update();
+
+  ReferenceFilterType::Pointer referenceFilter = ReferenceFilterType::New();
+  referenceFilter->SetInput(image);
+  referenceFilter->SetBackgroundValue(0);
+  referenceFilter->SetComputeFeretDiameter(true);
+  referenceFilter->SetComputePerimeter(true);
+  referenceFilter->Update();
+
+  LabelMapType * labelMap = shapeFilter->GetOutput();
+  ReferenceLabelMapType * referenceMap = referenceFilter->GetOutput();
+
+  if (labelMap->GetNumberOfLabelObjects() != 5
+      || referenceMap->GetNumberOfLabelObjects() != 5)
+    {
+    std::cerr << "Wrong number of label objects" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const double epsilon = 1e-9;
+  for (LabelType label = 1; label <= 5; ++label)
+    {
+    const LabelObjectType * lo = labelMap->GetLabelObject(label);
+    const ReferenceLabelMapType::LabelObjectType * ref = referenceMap->GetLabelObject(label);
+
+    const double feret = lo->GetAttribute("SHAPE::FeretDiameter");
+    const double perimeter = lo->GetAttribute("SHAPE::Perimeter");
+    std::cout << "Label " << label << ": Feret diameter " << feret << " (reference " << ref->GetFeretDiameter()
+              << "), perimeter " << perimeter << " (reference " << ref->GetPerimeter() << ")" << std::endl;
+
+    if (vnl_math_abs(feret - ref->GetFeretDiameter()) > epsilon * (1. + ref->GetFeretDiameter()))
+      {
+      std::cerr << "Wrong Feret diameter for label " << label << std::endl;
+      return EXIT_FAILURE;
+      }
+    if (vnl_math_abs(perimeter - ref->GetPerimeter()) > epsilon * (1. + ref->GetPerimeter()))
+      {
+      std::cerr << "Wrong perimeter for label " << label << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
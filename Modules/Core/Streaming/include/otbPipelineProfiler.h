@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbPipelineProfiler_h
+#define otbPipelineProfiler_h
+
+#include "itkProcessObject.h"
+#include "itkCommand.h"
+#include "otbPipelineMemoryPrintCalculator.h"
+
+#include <map>
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include "OTBStreamingExport.h"
+
+namespace otb
+{
+/** \class PipelineProfiler
+ *  \brief Record the execution time of each filter of a pipeline
+ *
+ *  The profiler watches a sink (a writer or a persistent filter) with
+ *  Watch(). When the sink starts, the pipeline is traced back from its
+ *  inputs, and each execution of each ProcessObject (from its StartEvent
+ *  to its EndEvent, i.e. its GenerateData(), including the
+ *  BeforeThreadedGenerateData(), ThreadedGenerateData() and
+ *  AfterThreadedGenerateData() steps) is recorded with:
+ *  - the wall-clock time and the CPU time of the process (all threads),
+ *  - the index of the stream division,
+ *  - the buffered region and the size in bytes of its first output.
+ *
+ *  Readers record the size of the data they have read. At the end of
+ *  each stream division, the size of the data handed to the sink is
+ *  recorded too.
+ *
+ *  The records can be written as a Chrome trace (JSON file readable by
+ *  chrome://tracing or https://ui.perfetto.dev) with WriteTrace(), or
+ *  summed up per filter with Report().
+ *
+ *  Applications record their writers when the environment variable
+ *  OTB_PROFILE_TRACE_FILE is set (see ConfigurationManager).
+ *
+ *  Please note that composite filters are seen as a single filter, as
+ *  their internal mini-pipeline can not be traced back.
+ *
+ * \ingroup OTBStreaming
+ */
+class OTBStreaming_EXPORT PipelineProfiler :
+  public itk::Object
+{
+public:
+  /** Standard class typedefs */
+  typedef PipelineProfiler                    Self;
+  typedef itk::Object                         Superclass;
+  typedef itk::SmartPointer<Self>             Pointer;
+  typedef itk::SmartPointer<const Self>       ConstPointer;
+
+  typedef itk::ProcessObject                  ProcessObjectType;
+  typedef PipelineMemoryPrintCalculator::MemoryPrintType MemoryPrintType;
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(PipelineProfiler, itk::Object);
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Execution of a process object */
+  typedef struct
+    {
+    /** Class name and identifier of the process object */
+    std::string     Name;
+    /** Index of the stream division */
+    unsigned int    Division;
+    /** Start time, in seconds since the first record */
+    double          StartTime;
+    /** Wall-clock time, in seconds */
+    double          WallTime;
+    /** CPU time of all threads, in seconds */
+    double          CPUTime;
+    /** Buffered region of the first output */
+    std::string     Region;
+    /** Size of the outputs, in bytes */
+    MemoryPrintType OutputBytes;
+    /** The process object is a reader */
+    bool            IsReader;
+    /** The process object is the watched sink */
+    bool            IsSink;
+    } RecordType;
+
+  typedef std::vector<RecordType> RecordListType;
+
+  /** Watch the pipeline ending at the given sink. The pipeline is
+   * traced back when the sink starts, so it can still be modified until
+   * then. */
+  void Watch(ProcessObjectType * sink);
+
+  /** Stop watching and remove all the records */
+  void Clear();
+
+  /** Get the records */
+  const RecordListType & GetRecords() const
+  {
+    return m_Records;
+  }
+
+  /** Get the number of stream divisions seen by the sinks */
+  unsigned int GetNumberOfDivisions() const
+  {
+    return m_Division;
+  }
+
+  /** Get the number of bytes handed to the sinks */
+  itkGetConstMacro(WrittenBytes, MemoryPrintType);
+
+  /** Write the records as a Chrome trace */
+  void WriteTrace(const std::string & filename) const;
+
+  /** Print the time spent in each filter, most expensive first */
+  void Report(std::ostream & os) const;
+
+protected:
+  /** Constructor */
+  PipelineProfiler();
+
+  /** Destructor */
+  ~PipelineProfiler() ITK_OVERRIDE;
+
+  /** PrintSelf method */
+  void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
+
+private:
+  PipelineProfiler(const Self &); //purposely not implemented
+  void operator =(const Self&);   //purposely not implemented
+
+  typedef itk::MemberCommand<Self>                      CommandType;
+  typedef std::map<const ProcessObjectType *, unsigned long> TagMapType;
+
+  typedef struct
+    {
+    double WallStart;
+    double CPUStart;
+    } OpenRecordType;
+
+  typedef std::map<const ProcessObjectType *, OpenRecordType> OpenRecordMapType;
+  typedef std::map<const ProcessObjectType *, unsigned int>   IdentifierMapType;
+  typedef std::vector<ProcessObjectType::Pointer>             ProcessListType;
+
+  /** Callback of the start and end events */
+  void OnEvent(itk::Object * caller, const itk::EventObject & event);
+
+  /** Add observers to the process and its upstream pipeline */
+  void WatchRecursive(ProcessObjectType * process);
+
+  void Observe(ProcessObjectType * process);
+
+  void StartRecord(ProcessObjectType * process);
+  void EndRecord(ProcessObjectType * process);
+
+  /** Sizes of the outputs of a process, in bytes */
+  MemoryPrintType EvaluateOutputBytes(ProcessObjectType * process) const;
+
+  /** Name and identifier of a process */
+  std::string GetProcessName(const ProcessObjectType * process);
+
+  static double GetCPUTime();
+
+  CommandType::Pointer   m_Command;
+
+  PipelineMemoryPrintCalculator::Pointer m_MemoryPrintCalculator;
+
+  /** Watched sinks */
+  ProcessListType        m_Sinks;
+
+  /** Observed process objects (sinks included), kept alive until Clear() */
+  ProcessListType        m_Processes;
+  TagMapType             m_StartTags;
+  TagMapType             m_EndTags;
+
+  /** Process objects directly feeding a sink: a stream division ends
+   * when all of them have been executed */
+  std::map<const ProcessObjectType *, bool> m_LastStages;
+
+  OpenRecordMapType      m_OpenRecords;
+  IdentifierMapType      m_Identifiers;
+  RecordListType         m_Records;
+
+  double                 m_Origin;
+  unsigned int           m_Division;
+  MemoryPrintType        m_WrittenBytes;
+};
+} // end of namespace otb
+
+#endif
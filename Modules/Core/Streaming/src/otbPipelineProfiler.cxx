@@ -0,0 +1,413 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbPipelineProfiler.h"
+
+#include "itkImageBase.h"
+#include "itksys/SystemTools.hxx"
+
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace otb
+{
+
+namespace
+{
+/** Per filter totals, for Report() */
+struct ProcessTotal
+{
+  std::string                                Name;
+  unsigned int                               Count;
+  double                                     WallTime;
+  double                                     CPUTime;
+  PipelineProfiler::MemoryPrintType          OutputBytes;
+  bool                                       IsSink;
+};
+
+bool CompareWallTime(const ProcessTotal & a, const ProcessTotal & b)
+{
+  return a.WallTime > b.WallTime;
+}
+}
+
+PipelineProfiler
+::PipelineProfiler()
+  : m_Command(CommandType::New()),
+    m_MemoryPrintCalculator(PipelineMemoryPrintCalculator::New()),
+    m_Origin(-1.),
+    m_Division(0),
+    m_WrittenBytes(0)
+{
+  m_Command->SetCallbackFunction(this, &Self::OnEvent);
+}
+
+PipelineProfiler
+::~PipelineProfiler()
+{
+  // The observers hold a raw pointer to this object
+  this->Clear();
+}
+
+void
+PipelineProfiler
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Number of sinks:           " << m_Sinks.size() << std::endl;
+  os << indent << "Number of process objects: " << m_Processes.size() << std::endl;
+  os << indent << "Number of records:         " << m_Records.size() << std::endl;
+  os << indent << "Number of divisions:       " << m_Division << std::endl;
+}
+
+void
+PipelineProfiler
+::Watch(ProcessObjectType * sink)
+{
+  if (sink == ITK_NULLPTR)
+    {
+    itkExceptionMacro(<< "Can not watch a null process object");
+    }
+  if (std::find(m_Sinks.begin(), m_Sinks.end(), sink) != m_Sinks.end())
+    {
+    return;
+    }
+  m_Sinks.push_back(sink);
+  if (m_StartTags.find(sink) == m_StartTags.end())
+    {
+    this->Observe(sink);
+    }
+}
+
+void
+PipelineProfiler
+::Clear()
+{
+  for (ProcessListType::iterator it = m_Processes.begin(); it != m_Processes.end(); ++it)
+    {
+    (*it)->RemoveObserver(m_StartTags[*it]);
+    (*it)->RemoveObserver(m_EndTags[*it]);
+    }
+  m_Processes.clear();
+  m_Sinks.clear();
+  m_StartTags.clear();
+  m_EndTags.clear();
+  m_LastStages.clear();
+  m_OpenRecords.clear();
+  m_Identifiers.clear();
+  m_Records.clear();
+  m_Origin = -1.;
+  m_Division = 0;
+  m_WrittenBytes = 0;
+}
+
+void
+PipelineProfiler
+::Observe(ProcessObjectType * process)
+{
+  m_Processes.push_back(process);
+  m_StartTags[process] = process->AddObserver(itk::StartEvent(), m_Command);
+  m_EndTags[process] = process->AddObserver(itk::EndEvent(), m_Command);
+}
+
+void
+PipelineProfiler
+::WatchRecursive(ProcessObjectType * process)
+{
+  if (m_StartTags.find(process) != m_StartTags.end())
+    {
+    return;
+    }
+  this->Observe(process);
+
+  ProcessObjectType::DataObjectPointerArray inputs = process->GetInputs();
+  for (ProcessObjectType::DataObjectPointerArray::iterator it = inputs.begin();
+       it != inputs.end(); ++it)
+    {
+    if (it->IsNotNull() && (*it)->GetSource().IsNotNull())
+      {
+      this->WatchRecursive((*it)->GetSource());
+      }
+    }
+}
+
+void
+PipelineProfiler
+::OnEvent(itk::Object * caller, const itk::EventObject & event)
+{
+  ProcessObjectType * process = dynamic_cast<ProcessObjectType *>(caller);
+  if (process == ITK_NULLPTR)
+    {
+    return;
+    }
+
+  const bool isSink = std::find(m_Sinks.begin(), m_Sinks.end(), process) != m_Sinks.end();
+
+  if (itk::StartEvent().CheckEvent(&event))
+    {
+    if (isSink)
+      {
+      // The pipeline is complete now: trace it back
+      m_LastStages.clear();
+      ProcessObjectType::DataObjectPointerArray inputs = process->GetInputs();
+      for (ProcessObjectType::DataObjectPointerArray::iterator it = inputs.begin();
+           it != inputs.end(); ++it)
+        {
+        if (it->IsNotNull() && (*it)->GetSource().IsNotNull())
+          {
+          m_LastStages[(*it)->GetSource()] = false;
+          this->WatchRecursive((*it)->GetSource());
+          }
+        }
+      }
+    this->StartRecord(process);
+    }
+  else if (itk::EndEvent().CheckEvent(&event))
+    {
+    this->EndRecord(process);
+
+    if (isSink)
+      {
+      // Account for an aborted division
+      for (std::map<const ProcessObjectType *, bool>::iterator it = m_LastStages.begin();
+           it != m_LastStages.end(); ++it)
+        {
+        if (it->second)
+          {
+          ++m_Division;
+          break;
+          }
+        }
+      m_LastStages.clear();
+      }
+    }
+}
+
+void
+PipelineProfiler
+::StartRecord(ProcessObjectType * process)
+{
+  const double now = itksys::SystemTools::GetTime();
+  if (m_Origin < 0.)
+    {
+    m_Origin = now;
+    }
+
+  OpenRecordType openRecord;
+  openRecord.WallStart = now;
+  openRecord.CPUStart = GetCPUTime();
+  m_OpenRecords[process] = openRecord;
+}
+
+void
+PipelineProfiler
+::EndRecord(ProcessObjectType * process)
+{
+  OpenRecordMapType::iterator openIt = m_OpenRecords.find(process);
+  if (openIt == m_OpenRecords.end())
+    {
+    return;
+    }
+
+  const double now = itksys::SystemTools::GetTime();
+
+  RecordType record;
+  record.Name = this->GetProcessName(process);
+  record.Division = m_Division;
+  record.StartTime = openIt->second.WallStart - m_Origin;
+  record.WallTime = now - openIt->second.WallStart;
+  record.CPUTime = GetCPUTime() - openIt->second.CPUStart;
+  record.OutputBytes = 0;
+  record.IsSink = std::find(m_Sinks.begin(), m_Sinks.end(), process) != m_Sinks.end();
+  record.IsReader = strstr(process->GetNameOfClass(), "Reader") != ITK_NULLPTR;
+  m_OpenRecords.erase(openIt);
+
+  ProcessObjectType::DataObjectPointerArray outputs = process->GetOutputs();
+  if (!record.IsSink && !outputs.empty())
+    {
+    const itk::ImageBase<2> * image = dynamic_cast<const itk::ImageBase<2> *>(outputs[0].GetPointer());
+    if (image != ITK_NULLPTR)
+      {
+      const itk::ImageBase<2>::RegionType & region = image->GetBufferedRegion();
+      std::ostringstream oss;
+      oss << "[" << region.GetIndex(0) << ", " << region.GetIndex(1)
+          << ", " << region.GetSize(0) << ", " << region.GetSize(1) << "]";
+      record.Region = oss.str();
+      }
+    record.OutputBytes = this->EvaluateOutputBytes(process);
+    }
+
+  m_Records.push_back(record);
+
+  // A division ends when all the process objects feeding the sink have
+  // been executed
+  std::map<const ProcessObjectType *, bool>::iterator lastIt = m_LastStages.find(process);
+  if (lastIt != m_LastStages.end() && !lastIt->second)
+    {
+    lastIt->second = true;
+    m_WrittenBytes += record.OutputBytes;
+
+    bool divisionDone = true;
+    for (lastIt = m_LastStages.begin(); lastIt != m_LastStages.end(); ++lastIt)
+      {
+      divisionDone = divisionDone && lastIt->second;
+      }
+    if (divisionDone)
+      {
+      ++m_Division;
+      for (lastIt = m_LastStages.begin(); lastIt != m_LastStages.end(); ++lastIt)
+        {
+        lastIt->second = false;
+        }
+      }
+    }
+}
+
+PipelineProfiler::MemoryPrintType
+PipelineProfiler
+::EvaluateOutputBytes(ProcessObjectType * process) const
+{
+  MemoryPrintType bytes = 0;
+  ProcessObjectType::DataObjectPointerArray outputs = process->GetOutputs();
+  for (ProcessObjectType::DataObjectPointerArray::iterator it = outputs.begin();
+       it != outputs.end(); ++it)
+    {
+    if (it->IsNotNull())
+      {
+      bytes += m_MemoryPrintCalculator->EvaluateDataObjectPrint(*it);
+      }
+    }
+  return bytes;
+}
+
+std::string
+PipelineProfiler
+::GetProcessName(const ProcessObjectType * process)
+{
+  IdentifierMapType::iterator it = m_Identifiers.find(process);
+  if (it == m_Identifiers.end())
+    {
+    it = m_Identifiers.insert(std::make_pair(process, static_cast<unsigned int>(m_Identifiers.size()))).first;
+    }
+  std::ostringstream oss;
+  oss << process->GetNameOfClass() << " #" << it->second;
+  return oss.str();
+}
+
+double
+PipelineProfiler
+::GetCPUTime()
+{
+  // Process time: it includes all the threads
+  return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+}
+
+void
+PipelineProfiler
+::WriteTrace(const std::string & filename) const
+{
+  std::ofstream ofs(filename.c_str());
+  if (!ofs)
+    {
+    itkExceptionMacro(<< "Could not open " << filename << " for writing");
+    }
+
+  ofs << std::fixed << std::setprecision(3);
+  ofs << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+  for (RecordListType::const_iterator it = m_Records.begin(); it != m_Records.end(); ++it)
+    {
+    const char * category = it->IsSink ? "sink" : (it->IsReader ? "reader" : "filter");
+
+    ofs << (it == m_Records.begin() ? "\n" : ",\n");
+    ofs << "  {\"name\": \"" << it->Name << "\", \"cat\": \"" << category << "\""
+        << ", \"ph\": \"X\", \"pid\": 0, \"tid\": 0"
+        << ", \"ts\": " << it->StartTime * 1e6
+        << ", \"dur\": " << it->WallTime * 1e6
+        << ", \"args\": {\"division\": " << it->Division
+        << ", \"cpu_ms\": " << it->CPUTime * 1e3;
+    if (!it->Region.empty())
+      {
+      ofs << ", \"region\": " << it->Region;
+      }
+    if (!it->IsSink)
+      {
+      ofs << ", \"" << (it->IsReader ? "read_bytes" : "output_bytes") << "\": " << it->OutputBytes;
+      }
+    ofs << "}}";
+    }
+  ofs << "\n]}" << std::endl;
+}
+
+void
+PipelineProfiler
+::Report(std::ostream & os) const
+{
+  std::vector<ProcessTotal> totals;
+  std::map<std::string, unsigned int> indices;
+  for (RecordListType::const_iterator it = m_Records.begin(); it != m_Records.end(); ++it)
+    {
+    std::map<std::string, unsigned int>::iterator idxIt = indices.find(it->Name);
+    if (idxIt == indices.end())
+      {
+      ProcessTotal total;
+      total.Name = it->Name;
+      total.Count = 0;
+      total.WallTime = 0.;
+      total.CPUTime = 0.;
+      total.OutputBytes = 0;
+      total.IsSink = it->IsSink;
+      idxIt = indices.insert(std::make_pair(it->Name, static_cast<unsigned int>(totals.size()))).first;
+      totals.push_back(total);
+      }
+    ProcessTotal & total = totals[idxIt->second];
+    ++total.Count;
+    total.WallTime += it->WallTime;
+    total.CPUTime += it->CPUTime;
+    total.OutputBytes += it->OutputBytes;
+    }
+
+  std::sort(totals.begin(), totals.end(), CompareWallTime);
+
+  os << m_Division << " division(s), "
+     << m_WrittenBytes * PipelineMemoryPrintCalculator::ByteToMegabyte << " MB written" << std::endl;
+  for (std::vector<ProcessTotal>::const_iterator it = totals.begin(); it != totals.end(); ++it)
+    {
+    os << std::left << std::setw(50) << it->Name << std::right
+       << std::setw(6) << it->Count << " run(s)"
+       << std::fixed << std::setprecision(3)
+       << std::setw(12) << it->WallTime << " s wall"
+       << std::setw(12) << it->CPUTime << " s cpu";
+    if (it->IsSink)
+      {
+      os << "   (sink, upstream included)";
+      }
+    else
+      {
+      os << std::setw(12) << it->OutputBytes * PipelineMemoryPrintCalculator::ByteToMegabyte << " MB";
+      }
+    os << std::endl;
+    }
+}
+
+} // end of namespace otb
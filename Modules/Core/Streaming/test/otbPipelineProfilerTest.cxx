@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbPipelineProfiler.h"
+
+#include "otbVectorImage.h"
+#include "otbImage.h"
+#include "otbImageFileReader.h"
+#include "otbImageFileWriter.h"
+#include "otbVectorImageToIntensityImageFilter.h"
+
+#include <map>
+
+int otbPipelineProfilerTest(int itkNotUsed(argc), char * argv[])
+{
+  typedef otb::VectorImage<double, 2>            VectorImageType;
+  typedef otb::Image<double, 2>                  ImageType;
+  typedef otb::ImageFileReader<VectorImageType>  ReaderType;
+  typedef otb::VectorImageToIntensityImageFilter
+    <VectorImageType, ImageType>                 IntensityImageFilterType;
+  typedef otb::ImageFileWriter<ImageType>        WriterType;
+  typedef otb::PipelineProfiler                  ProfilerType;
+
+  const unsigned int nbDivisions = 4;
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(argv[1]);
+
+  IntensityImageFilterType::Pointer intensity = IntensityImageFilterType::New();
+  intensity->SetInput(reader->GetOutput());
+
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(intensity->GetOutput());
+  writer->SetFileName(argv[2]);
+  writer->SetNumberOfDivisionsStrippedStreaming(nbDivisions);
+
+  ProfilerType::Pointer profiler = ProfilerType::New();
+  profiler->Watch(writer);
+
+  writer->Update();
+
+  profiler->WriteTrace(argv[3]);
+  profiler->Report(std::cout);
+
+  if (profiler->GetNumberOfDivisions() != nbDivisions)
+    {
+    std::cerr << "Expected " << nbDivisions << " divisions, got "
+              << profiler->GetNumberOfDivisions() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The reader and the intensity filter run once per division, the
+  // writer once
+  std::map<std::string, unsigned int> counts;
+  const ProfilerType::RecordListType & records = profiler->GetRecords();
+  for (ProfilerType::RecordListType::const_iterator it = records.begin(); it != records.end(); ++it)
+    {
+    ++counts[it->Name];
+    }
+  if (counts.size() != 3)
+    {
+    std::cerr << "Expected 3 process objects, got " << counts.size() << std::endl;
+    return EXIT_FAILURE;
+    }
+  for (std::map<std::string, unsigned int>::const_iterator it = counts.begin(); it != counts.end(); ++it)
+    {
+    const unsigned int expected = (it->first.find("ImageFileWriter") == 0) ? 1 : nbDivisions;
+    if (it->second != expected)
+      {
+      std::cerr << it->first << " was recorded " << it->second << " times, expected "
+                << expected << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // The whole intensity image has been handed to the writer
+  const ImageType::RegionType & region = intensity->GetOutput()->GetLargestPossibleRegion();
+  const ProfilerType::MemoryPrintType expectedBytes = region.GetNumberOfPixels() * sizeof(double);
+  if (profiler->GetWrittenBytes() != expectedBytes)
+    {
+    std::cerr << "Expected " << expectedBytes << " bytes written, got "
+              << profiler->GetWrittenBytes() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
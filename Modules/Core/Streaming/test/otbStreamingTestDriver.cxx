@@ -30,4 +30,5 @@ void RegisterTests()
   REGISTER_TEST(otbRAMDrivenAdaptativeStreamingManager);
   REGISTER_TEST(otbPipelineMemoryPrintCalculatorTest);
   REGISTER_TEST(otbPipelineMemoryPrintCalculatorNew);
+  REGISTER_TEST(otbPipelineProfilerTest);
 }
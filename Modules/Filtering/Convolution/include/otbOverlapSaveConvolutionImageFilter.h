@@ -27,8 +27,94 @@
 #include "itkArray.h"
 #include "itkZeroFluxNeumannBoundaryCondition.h"
 
+#include "itkSimpleFastMutexLock.h"
+
+#include <map>
+#include <utility>
+
+#if defined ITK_USE_FFTWD || defined ITK_USE_FFTWF
+#include "itkFFTWCommon.h"
+#endif
+
 namespace otb
 {
+
+namespace internal
+{
+/** Precision of the Fourier transforms for a given pixel component
+ * type: single precision for float components when the single
+ * precision FFTW is available, double precision otherwise (or single
+ * precision if only this one is available). */
+#if defined ITK_USE_FFTWD
+template <class TScalar> struct OverlapSaveFFTPrecision
+{
+  typedef double Type;
+};
+#if defined ITK_USE_FFTWF
+template <> struct OverlapSaveFFTPrecision<float>
+{
+  typedef float Type;
+};
+#endif
+#else
+template <class TScalar> struct OverlapSaveFFTPrecision
+{
+  typedef float Type;
+};
+#endif
+
+/** Thin wrapper around the FFTW functions not provided by
+ * itk::fftw::Proxy : aligned allocation and new-array execution of
+ * plans, which allows to share a plan between threads. */
+template <class TReal> struct OverlapSaveFFTW;
+
+#if defined ITK_USE_FFTWD
+template <> struct OverlapSaveFFTW<double>
+{
+  typedef itk::fftw::Proxy<double> ProxyType;
+  static void * Malloc(size_t n)
+  {
+    return fftw_malloc(n);
+  }
+  static void Free(void * p)
+  {
+    fftw_free(p);
+  }
+  static void ExecuteForward(ProxyType::PlanType plan, ProxyType::PixelType * in, ProxyType::ComplexType * out)
+  {
+    fftw_execute_dft_r2c(plan, in, out);
+  }
+  static void ExecuteInverse(ProxyType::PlanType plan, ProxyType::ComplexType * in, ProxyType::PixelType * out)
+  {
+    fftw_execute_dft_c2r(plan, in, out);
+  }
+};
+#endif
+
+#if defined ITK_USE_FFTWF
+template <> struct OverlapSaveFFTW<float>
+{
+  typedef itk::fftw::Proxy<float> ProxyType;
+  static void * Malloc(size_t n)
+  {
+    return fftwf_malloc(n);
+  }
+  static void Free(void * p)
+  {
+    fftwf_free(p);
+  }
+  static void ExecuteForward(ProxyType::PlanType plan, ProxyType::PixelType * in, ProxyType::ComplexType * out)
+  {
+    fftwf_execute_dft_r2c(plan, in, out);
+  }
+  static void ExecuteInverse(ProxyType::PlanType plan, ProxyType::ComplexType * in, ProxyType::PixelType * out)
+  {
+    fftwf_execute_dft_c2r(plan, in, out);
+  }
+};
+#endif
+} // end namespace internal
+
 /** \class OverlapSaveConvolutionImageFilter
  *
  * This filter implements the convolution operation between a kernel and an
@@ -39,21 +125,31 @@ namespace otb
  * product in the Fourrier domain. This result in tremendous speed gain when using large kernel
  * with exactly the same result as the classical convolution filter.
  *
- * \note This filter could be threaded but requires additional design due to limited thread-safety
- * of the FFTW library.
+ * The filter is multi-threaded. FFTW plans and the spectrum of the kernel only depend on the
+ * size of the processed piece: they are computed once per piece size and shared by all
+ * threads and streaming pieces until the kernel or the radius changes. At most
+ * FFTCacheMaximumSize piece sizes are kept between two executions, the least recently used
+ * ones being released first. FFTW wisdom is handled
+ * by ITK (see the ITK_FFTW_READ_WISDOM_CACHE, ITK_FFTW_WRITE_WISDOM_CACHE and
+ * ITK_FFTW_PLAN_RIGOR environment variables), so that plans can be reused between runs.
+ *
+ * Both scalar images and otb::VectorImage are supported. With multi-band images, the kernel
+ * spectrum is computed once and applied to every band.
+ *
+ * Transforms are computed in single precision when the input pixel component type is float
+ * and ITK provides the single precision FFTW (ITK_USE_FFTWF), in double precision otherwise.
  *
  * \note For the moment only constant zero boundary conditions are used in this filter. This could produce
  *  very different results from the classical convolution filter with zero flux neumann boundary condition,
  * especially with large kernels.
  *
- * \note ITK must be set to use FFTW (double implementation) for this filter to work properly. If not, exception
- *  will be raised at filter creation.
- *  Install fftw and set the cmake variable ITK_USE_FFTWD to ON.
+ * \note ITK must be set to use FFTW (ITK_USE_FFTWD and/or ITK_USE_FFTWF) for this filter to work
+ *  properly. If not, exception will be raised at filter execution.
  *
  * \sa ConvolutionImageFilter
  *
- * \ingroup ShouldBeThreaded
  * \ingroup Streamed
+ * \ingroup Multithreaded
  * \ingroup IntensityImageFilters
  *
  * \ingroup OTBConvolution
@@ -85,14 +181,20 @@ public:
   itkTypeMacro(OverlapSaveConvolutionImageFilter, ImageToImageFilter);
 
   /** Image typedef support. */
-  typedef typename InputImageType::PixelType                    InputPixelType;
-  typedef typename OutputImageType::PixelType                   OutputPixelType;
-  typedef typename itk::NumericTraits<InputPixelType>::RealType InputRealType;
-  typedef typename InputImageType::RegionType                   InputImageRegionType;
-  typedef typename OutputImageType::RegionType                  OutputImageRegionType;
-  typedef typename InputImageType::SizeType                     InputSizeType;
-  typedef typename itk::Array<InputRealType>                    ArrayType;
-  typedef TBoundaryCondition                                    BoundaryConditionType;
+  typedef typename InputImageType::PixelType                          InputPixelType;
+  typedef typename OutputImageType::PixelType                         OutputPixelType;
+  typedef typename itk::NumericTraits<InputPixelType>::RealType       InputRealType;
+  typedef typename itk::NumericTraits<InputPixelType>::ScalarRealType InputScalarRealType;
+  typedef typename itk::NumericTraits<InputPixelType>::ValueType      InputValueType;
+  typedef typename itk::NumericTraits<OutputPixelType>::ValueType     OutputValueType;
+  typedef typename InputImageType::RegionType                         InputImageRegionType;
+  typedef typename OutputImageType::RegionType                        OutputImageRegionType;
+  typedef typename InputImageType::SizeType                           InputSizeType;
+  typedef typename itk::Array<InputScalarRealType>                    ArrayType;
+  typedef TBoundaryCondition                                          BoundaryConditionType;
+
+  /** Precision of the Fourier transforms */
+  typedef typename internal::OverlapSaveFFTPrecision<InputValueType>::Type FFTPrecisionType;
 
   /** Set the radius of the neighborhood used to compute the mean. */
   virtual void SetRadius(const InputSizeType rad)
@@ -108,6 +210,7 @@ public:
         }
       this->m_Filter.SetSize(arraySize);
       this->m_Filter.Fill(1);
+      this->ClearFFTCache();
       this->Modified();
       }
   }
@@ -128,8 +231,10 @@ public:
       {
       m_Filter = filter;
       }
+    this->ClearFFTCache();
     this->Modified();
   }
+
   /** Get the filter */
   itkGetConstReferenceMacro(Filter, ArrayType);
 
@@ -138,6 +243,14 @@ public:
   itkGetMacro(NormalizeFilter, bool);
   itkBooleanMacro(NormalizeFilter);
 
+  /** Set/Get the maximum number of piece sizes whose FFTW plans and
+   * kernel spectrum are kept between two executions (default is 8). */
+  itkSetMacro(FFTCacheMaximumSize, unsigned int);
+  itkGetMacro(FFTCacheMaximumSize, unsigned int);
+
+  /** Release the cached FFTW plans and kernel spectra */
+  void ClearFFTCache();
+
   /** Since this filter implements a neighborhood operation, it requests a largest input
    * region than the output region.
    */
@@ -154,27 +267,63 @@ protected:
   /** Constructor */
   OverlapSaveConvolutionImageFilter();
   /** destructor */
-  ~OverlapSaveConvolutionImageFilter() ITK_OVERRIDE {}
+  ~OverlapSaveConvolutionImageFilter() ITK_OVERRIDE;
+
   void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
 
-  /* TODO For the moment this class provide only a GenerateData(),
-   * due to limited thread-safety of FFTW plan creation.
-   */
-  void GenerateData() ITK_OVERRIDE;
-  // void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType threadId);
+  /** Check FFTW availability and compute the filter normalization */
+  void BeforeThreadedGenerateData() ITK_OVERRIDE;
+
+  /** Convolve the thread region, all bands with the same kernel spectrum */
+  void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType threadId) ITK_OVERRIDE;
+
+  /** Release the least recently used cache entries above the maximum size */
+  void AfterThreadedGenerateData() ITK_OVERRIDE;
 
 private:
   OverlapSaveConvolutionImageFilter(const Self &); //purposely not implemented
   void operator =(const Self&); //purposely not implemented
 
+#if defined ITK_USE_FFTWD || defined ITK_USE_FFTWF
+  typedef internal::OverlapSaveFFTW<FFTPrecisionType> FFTWType;
+  typedef typename FFTWType::ProxyType                FFTWProxyType;
+
+  /** Plans and kernel spectrum for a given piece size */
+  struct FFTCacheEntry
+  {
+    typename FFTWProxyType::PlanType      ForwardPlan;
+    typename FFTWProxyType::PlanType      InversePlan;
+    typename FFTWProxyType::ComplexType * FilterFFT;
+    unsigned long                         LastUse;
+  };
+  typedef std::pair<unsigned int, unsigned int>  PieceSizeType;
+  typedef std::map<PieceSizeType, FFTCacheEntry> FFTCacheType;
+
+  /** Get (and create if needed) the cache entry of a piece size */
+  const FFTCacheEntry& GetFFTCacheEntry(unsigned int pieceSizeX, unsigned int pieceSizeY);
+
+  /** Release the plans and the kernel spectrum of a cache entry */
+  static void ReleaseFFTCacheEntry(FFTCacheEntry& entry);
+
+  /** FFTW plans and kernel spectra, by piece size */
+  FFTCacheType m_FFTCache;
+  /** Incremented on each cache lookup, to find the least recently used entries */
+  unsigned long m_FFTCacheClock;
+#endif
+
+  /** Maximum number of piece sizes kept in the cache between two executions */
+  unsigned int m_FFTCacheMaximumSize;
+
   /** Radius of the filter */
   InputSizeType m_Radius;
-
   /** Filter array */
   ArrayType m_Filter;
-
   /** Flag for filter normalization */
   bool m_NormalizeFilter;
+  /** Normalization factor of the current run */
+  double m_Norm;
+  /** Protects the FFT cache */
+  itk::SimpleFastMutexLock m_FFTCacheLock;
 };
 } // end namespace otb
 
@@ -25,19 +25,14 @@
 
 #include "otbOverlapSaveConvolutionImageFilter.h"
 
-#include "itkConstNeighborhoodIterator.h"
-#include "itkImageRegionIteratorWithIndex.h"
-#include "itkNeighborhoodAlgorithm.h"
-#include "itkOffset.h"
-#include "itkProgressReporter.h"
-
-//debug
+#include "itkImageRegionConstIterator.h"
 #include "itkImageRegionIterator.h"
+#include "itkDefaultConvertPixelTraits.h"
+#include "itkProgressReporter.h"
 #include "otbMath.h"
 
-#ifdef ITK_USE_FFTWD
-#include "itkFFTWCommon.h"
-#endif
+#include <algorithm>
+#include <vector>
 
 namespace otb
 {
@@ -50,6 +45,59 @@ OverlapSaveConvolutionImageFilter<TInputImage, TOutputImage, TBoundaryCondition>
   m_Filter.SetSize(3 * 3);
   m_Filter.Fill(1);
   m_NormalizeFilter = false;
+  m_Norm = 1.;
+  m_FFTCacheMaximumSize = 8;
+#if defined ITK_USE_FFTWD || defined ITK_USE_FFTWF
+  m_FFTCacheClock = 0;
+#endif
+}
+
+template <class TInputImage, class TOutputImage, class TBoundaryCondition>
+OverlapSaveConvolutionImageFilter<TInputImage, TOutputImage, TBoundaryCondition>
+::~OverlapSaveConvolutionImageFilter()
+{
+  this->ClearFFTCache();
+}
+
+template <class TInputImage, class TOutputImage, class TBoundaryCondition>
+void
+OverlapSaveConvolutionImageFilter<TInputImage, TOutputImage, TBoundaryCondition>
+::ClearFFTCache()
+{
+#if defined ITK_USE_FFTWD || defined ITK_USE_FFTWF
+  m_FFTCacheLock.Lock();
+  for (typename FFTCacheType::iterator it = m_FFTCache.begin(); it != m_FFTCache.end(); ++it)
+    {
+    ReleaseFFTCacheEntry(it->second);
+    }
+  m_FFTCache.clear();
+  m_FFTCacheLock.Unlock();
+#endif
+}
+
+template <class TInputImage, class TOutputImage, class TBoundaryCondition>
+void
+OverlapSaveConvolutionImageFilter<TInputImage, TOutputImage, TBoundaryCondition>
+::AfterThreadedGenerateData()
+{
+#if defined ITK_USE_FFTWD || defined ITK_USE_FFTWF
+  // Entries are only released here, when no thread is using them
+  m_FFTCacheLock.Lock();
+  while (m_FFTCache.size() > m_FFTCacheMaximumSize)
+    {
+    typename FFTCacheType::iterator oldest = m_FFTCache.begin();
+    for (typename FFTCacheType::iterator it = m_FFTCache.begin(); it != m_FFTCache.end(); ++it)
+      {
+      if (it->second.LastUse < oldest->second.LastUse)
+        {
+        oldest = it;
+        }
+      }
+    ReleaseFFTCacheEntry(oldest->second);
+    m_FFTCache.erase(oldest);
+    }
+  m_FFTCacheLock.Unlock();
+#endif
 }
 
 template <class TInputImage, class TOutputImage, class TBoundaryCondition>
@@ -57,7 +105,7 @@ void
 OverlapSaveConvolutionImageFilter<TInputImage, TOutputImage, TBoundaryCondition>
 ::GenerateInputRequestedRegion() throw (itk::InvalidRequestedRegionError)
   {
-#if defined ITK_USE_FFTWD
+#if defined ITK_USE_FFTWD || defined ITK_USE_FFTWF
   // call the superclass' implementation of this method
   Superclass::GenerateInputRequestedRegion();
 
@@ -102,208 +150,255 @@ OverlapSaveConvolutionImageFilter<TInputImage, TOutputImage, TBoundaryCondition>
 #else
   itkGenericExceptionMacro(
     <<
-    "The OverlapSaveConvolutionImageFilter can not operate without the FFTW library (double implementation). Please build ITK with USE_FFTD set to ON, and rebuild OTB.");
+    "The OverlapSaveConvolutionImageFilter can not operate without the FFTW library. Please build ITK with USE_FFTWD or USE_FFTWF set to ON, and rebuild OTB.");
 #endif
   }
 
-template<class TInputImage, class TOutputImage, class TBoundaryCondition>
+template <class TInputImage, class TOutputImage, class TBoundaryCondition>
 void
 OverlapSaveConvolutionImageFilter<TInputImage, TOutputImage, TBoundaryCondition>
-/* TODO commented out since multi-threading is not supported for the moment
- * ::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType threadId) */
-::GenerateData()
+::BeforeThreadedGenerateData()
 {
-#if defined ITK_USE_FFTWD
-  // Input/Output pointers
-  typename OutputImageType::Pointer     output = this->GetOutput();
-  typename InputImageType::ConstPointer input = this->GetInput();
+#if defined ITK_USE_FFTWD || defined ITK_USE_FFTWF
+  // Computing the filter normalization
+  m_Norm = 1.;
+  if (m_NormalizeFilter)
+    {
+    double norm = 0.;
+    for (unsigned int i = 0; i < m_Filter.Size(); ++i)
+      {
+      norm += static_cast<double>(m_Filter(i));
+      }
+    if (norm != 0.0)
+      {
+      m_Norm = 1. / norm;
+      }
+    }
+#else
+  itkGenericExceptionMacro(
+    <<
+    "The OverlapSaveConvolutionImageFilter can not operate without the FFTW library. Please build ITK with USE_FFTWD or USE_FFTWF set to ON, and rebuild OTB.");
+#endif
+}
 
-  /* TODO: This is a patch to switch from GenerateData() to ThreadedGenerateData(). Remove these two lines
-  once multi-threading problem is solved */
-  this->AllocateOutputs();
-  OutputImageRegionType outputRegionForThread = output->GetRequestedRegion();
+#if defined ITK_USE_FFTWD || defined ITK_USE_FFTWF
+template <class TInputImage, class TOutputImage, class TBoundaryCondition>
+const typename OverlapSaveConvolutionImageFilter<TInputImage, TOutputImage, TBoundaryCondition>::FFTCacheEntry&
+OverlapSaveConvolutionImageFilter<TInputImage, TOutputImage, TBoundaryCondition>
+::GetFFTCacheEntry(unsigned int pieceSizeX, unsigned int pieceSizeY)
+{
+  typedef typename FFTWProxyType::PixelType   FFTPixelType;
+  typedef typename FFTWProxyType::ComplexType FFTComplexType;
 
-  // Size of the filter
-  typename InputImageType::SizeType sizeOfFilter;
-  sizeOfFilter[0] = 2 * m_Radius[0] + 1;
-  sizeOfFilter[1] = 2 * m_Radius[1] + 1;
+  const PieceSizeType key(pieceSizeX, pieceSizeY);
 
-  // Filter normalization
-  InputRealType norm;
+  m_FFTCacheLock.Lock();
+  typename FFTCacheType::iterator it = m_FFTCache.find(key);
+  if (it != m_FFTCache.end())
+    {
+    it->second.LastUse = ++m_FFTCacheClock;
+    m_FFTCacheLock.Unlock();
+    return it->second;
+    }
+  m_FFTCacheLock.Unlock();
+
+  // Plans and kernel spectrum are computed without holding the cache
+  // lock, so that threads processing other piece sizes are not
+  // blocked. The FFTW planner itself is serialized by ITK.
+  const unsigned int pieceNbOfPixel = pieceSizeX * pieceSizeY;
+  const unsigned int sizeFFT = (pieceSizeX / 2 + 1) * pieceSizeY;
+
+  // Planning buffers, only their alignment matters for the new-array
+  // execution of the plans. Planning may overwrite them.
+  FFTPixelType * realPiece = static_cast<FFTPixelType*>(FFTWType::Malloc(pieceNbOfPixel * sizeof(FFTPixelType)));
+  FFTComplexType * complexPiece = static_cast<FFTComplexType*>(FFTWType::Malloc(sizeFFT * sizeof(FFTComplexType)));
+
+  FFTCacheEntry entry;
+  entry.ForwardPlan = FFTWProxyType::Plan_dft_r2c_2d(pieceSizeY,
+                                                     pieceSizeX,
+                                                     realPiece,
+                                                     complexPiece,
+                                                     FFTW_MEASURE);
+  entry.InversePlan = FFTWProxyType::Plan_dft_c2r_2d(pieceSizeY,
+                                                     pieceSizeX,
+                                                     complexPiece,
+                                                     realPiece,
+                                                     FFTW_MEASURE);
+  entry.FilterFFT = static_cast<FFTComplexType*>(FFTWType::Malloc(sizeFFT * sizeof(FFTComplexType)));
+
+  // Kernel spectrum, shared by all bands and all pieces of this size
+  std::fill(realPiece, realPiece + pieceNbOfPixel, FFTPixelType(0));
+  const unsigned int sizeOfFilterX = 2 * m_Radius[0] + 1;
+  const unsigned int sizeOfFilterY = 2 * m_Radius[1] + 1;
+  unsigned int k = 0;
+  for (unsigned int j = 0; j < sizeOfFilterY; ++j)
+    {
+    for (unsigned int i = 0; i < sizeOfFilterX; ++i)
+      {
+      realPiece[i + j * pieceSizeX] = static_cast<FFTPixelType>(m_Filter.GetElement(k));
+      ++k;
+      }
+    }
+  FFTWType::ExecuteForward(entry.ForwardPlan, realPiece, entry.FilterFFT);
 
-  // Compute the input region for the given thread
-  OutputImageRegionType inputRegionForThread = outputRegionForThread;
-  inputRegionForThread.PadByRadius(m_Radius);
+  FFTWType::Free(realPiece);
+  FFTWType::Free(complexPiece);
 
-  // Compute the piece region for the input thread. Piece region is different
-  // from input region on boundaries
-  typename InputImageType::RegionType pieceRegion = inputRegionForThread;
-  typename InputImageType::SizeType   pieceSize = pieceRegion.GetSize();
-  typename InputImageType::IndexType  pieceIndex = pieceRegion.GetIndex();
+  // Another thread may have cached the same piece size meanwhile
+  m_FFTCacheLock.Lock();
+  entry.LastUse = ++m_FFTCacheClock;
+  std::pair<typename FFTCacheType::iterator, bool> inserted =
+    m_FFTCache.insert(typename FFTCacheType::value_type(key, entry));
+  if (!inserted.second)
+    {
+    inserted.first->second.LastUse = entry.LastUse;
+    }
+  m_FFTCacheLock.Unlock();
 
-  // Compute the size of the FFT and the size of the piece
-  unsigned int pieceNbOfPixel = pieceRegion.GetNumberOfPixels();
-  unsigned int sizeFFT = (pieceSize[0] / 2 + 1) * pieceSize[1];
+  if (!inserted.second)
+    {
+    ReleaseFFTCacheEntry(entry);
+    }
 
-  // Achieve the computation of the inputRegionForThread
-  inputRegionForThread.Crop(input->GetLargestPossibleRegion());
-  typename InputImageType::IndexType inputIndex = inputRegionForThread.GetIndex();
-  typename InputImageType::SizeType  inputSize =   inputRegionForThread.GetSize();
+  return inserted.first->second;
+}
 
-  //Iterator of input image
-  itk::ConstNeighborhoodIterator<InputImageType, BoundaryConditionType>
-  inputIt(m_Radius, input, inputRegionForThread);
-  inputIt.GoToBegin();
+template <class TInputImage, class TOutputImage, class TBoundaryCondition>
+void
+OverlapSaveConvolutionImageFilter<TInputImage, TOutputImage, TBoundaryCondition>
+::ReleaseFFTCacheEntry(FFTCacheEntry& entry)
+{
+  FFTWProxyType::DestroyPlan(entry.ForwardPlan);
+  FFTWProxyType::DestroyPlan(entry.InversePlan);
+  FFTWType::Free(entry.FilterFFT);
+}
+#endif
 
-  //Iterator of output image
-  itk::ImageRegionIteratorWithIndex<OutputImageType> outputIt;
-  outputIt = itk::ImageRegionIteratorWithIndex<OutputImageType>(output, outputRegionForThread);
+template<class TInputImage, class TOutputImage, class TBoundaryCondition>
+void
+OverlapSaveConvolutionImageFilter<TInputImage, TOutputImage, TBoundaryCondition>
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType threadId)
+{
+#if defined ITK_USE_FFTWD || defined ITK_USE_FFTWF
+  typedef typename FFTWProxyType::PixelType                 FFTPixelType;
+  typedef typename FFTWProxyType::ComplexType               FFTComplexType;
+  typedef itk::DefaultConvertPixelTraits<InputPixelType>    InputPixelTraits;
 
-  //variables for loops
-  unsigned int i, j, k, l;
+  // Input/Output pointers
+  OutputImageType *      output = this->GetOutput();
+  const InputImageType * input = this->GetInput();
 
-  // ITK proxy to the fftw library
-  typedef typename itk::fftw::Proxy<double> FFTWProxyType;
+  const unsigned int nbComponents = input->GetNumberOfComponentsPerPixel();
 
-  //memory allocation
-  InputPixelType* resampledFilterPiece;
-  resampledFilterPiece = static_cast<FFTWProxyType::PixelType*>(fftw_malloc(pieceNbOfPixel * sizeof(InputPixelType)));
+  // Compute the piece region for the given thread: the output region
+  // padded by the radius. Piece region is different from input region
+  // on boundaries, where it is zero padded.
+  typename InputImageType::RegionType pieceRegion = outputRegionForThread;
+  pieceRegion.PadByRadius(m_Radius);
+  const typename InputImageType::IndexType pieceIndex = pieceRegion.GetIndex();
+  const unsigned int pieceSizeX = pieceRegion.GetSize()[0];
+  const unsigned int pieceSizeY = pieceRegion.GetSize()[1];
 
-  FFTWProxyType::ComplexType* filterPieceFFT;
-  filterPieceFFT = static_cast<FFTWProxyType::ComplexType*>(fftw_malloc(sizeFFT * sizeof(FFTWProxyType::ComplexType)));
+  // Compute the size of the FFT and the size of the piece
+  const unsigned int pieceNbOfPixel = pieceSizeX * pieceSizeY;
+  const unsigned int sizeFFT = (pieceSizeX / 2 + 1) * pieceSizeY;
 
-  InputPixelType *inputPiece;
-  inputPiece = static_cast<FFTWProxyType::PixelType*>(fftw_malloc(pieceNbOfPixel * sizeof(InputPixelType)));
+  // Achieve the computation of the inputRegionForThread
+  typename InputImageType::RegionType inputRegionForThread = pieceRegion;
+  inputRegionForThread.Crop(input->GetLargestPossibleRegion());
+  const typename InputImageType::IndexType inputIndex = inputRegionForThread.GetIndex();
+  const typename InputImageType::SizeType  inputSize = inputRegionForThread.GetSize();
 
-  FFTWProxyType::ComplexType* inputPieceFFT;
-  inputPieceFFT = static_cast<FFTWProxyType::ComplexType*>(fftw_malloc(sizeFFT * sizeof(FFTWProxyType::ComplexType)));
+  const FFTCacheEntry& cache = this->GetFFTCacheEntry(pieceSizeX, pieceSizeY);
 
-  // Image piece FFT
-  FFTWProxyType::PlanType inputPlan = FFTWProxyType::Plan_dft_r2c_2d(pieceSize[1],
-                                                                     pieceSize[0],
-                                                                     inputPiece,
-                                                                     inputPieceFFT,
-                                                                     FFTW_MEASURE);
+  // left and top zero padding
+  const unsigned int leftskip = static_cast<unsigned int>(inputIndex[0] - pieceIndex[0]);
+  const unsigned int topskip = pieceSizeX * static_cast<unsigned int>(inputIndex[1] - pieceIndex[1]);
 
-  // left zero padding
-  unsigned int leftskip = static_cast<unsigned int>(std::max(0L, inputIndex[0] - pieceIndex[0]));
-  unsigned int topskip =  pieceSize[0] * static_cast<unsigned int>(std::max(0L, inputIndex[1] - pieceIndex[1]));
+  // Thread buffers: one real piece per component, one spectrum. The
+  // pieces stride is rounded so that every piece keeps the alignment
+  // of the planning buffers, as required by new-array execution.
+  const unsigned int pieceStride = (pieceNbOfPixel + 15) / 16 * 16;
+  FFTPixelType * inputPieces =
+    static_cast<FFTPixelType*>(FFTWType::Malloc(nbComponents * pieceStride * sizeof(FFTPixelType)));
+  FFTComplexType * pieceFFT = static_cast<FFTComplexType*>(FFTWType::Malloc(sizeFFT * sizeof(FFTComplexType)));
 
   // zero filling
-  memset(inputPiece,0,pieceNbOfPixel * sizeof(InputPixelType));
+  std::fill(inputPieces, inputPieces + nbComponents * pieceStride, FFTPixelType(0));
 
-  // Filling the buffer with image values
-  for (l = 0; l < inputSize[1]; ++l)
+  // Filling the buffers with image values, in a single pass over the input
+  itk::ImageRegionConstIterator<InputImageType> inputIt(input, inputRegionForThread);
+  inputIt.GoToBegin();
+  for (unsigned int l = 0; l < inputSize[1]; ++l)
     {
-    for (k = 0; k < inputSize[0]; ++k)
+    for (unsigned int k = 0; k < inputSize[0]; ++k)
       {
-      inputPiece[topskip + pieceSize[0] * l + k + leftskip] = inputIt.GetCenterPixel();
+      const InputPixelType pixel = inputIt.Get();
+      const unsigned int   offset = topskip + pieceSizeX * l + k + leftskip;
+      for (unsigned int c = 0; c < nbComponents; ++c)
+        {
+        inputPieces[c * pieceStride + offset] =
+          static_cast<FFTPixelType>(InputPixelTraits::GetNthComponent(c, pixel));
+        }
       ++inputIt;
       }
     }
 
-  FFTWProxyType::Execute(inputPlan);
-
-  // Resampled filter FFT
-  FFTWProxyType::PlanType filterPlan = FFTWProxyType::Plan_dft_r2c_2d(pieceSize[1],
-                                                                      pieceSize[0],
-                                                                      resampledFilterPiece,
-                                                                      filterPieceFFT,
-                                                                      FFTW_MEASURE);
-
-  // zero filling
-  memset(resampledFilterPiece,0,pieceNbOfPixel * sizeof(InputPixelType));
-
-  k = 0;
-  // Filling the buffer with filter values
-  for (j = 0; j < sizeOfFilter[1]; ++j)
+  // Convolve each component with the cached kernel spectrum, the
+  // result overwrites the component piece
+  const FFTPixelType scale = static_cast<FFTPixelType>(m_Norm / static_cast<double>(pieceNbOfPixel));
+  for (unsigned int c = 0; c < nbComponents; ++c)
     {
-    for (i = 0; i < sizeOfFilter[0]; ++i)
+    FFTPixelType * piece = inputPieces + c * pieceStride;
+    FFTWType::ExecuteForward(cache.ForwardPlan, piece, pieceFFT);
+
+    //complex mutiplication
+    for (unsigned int k = 0; k < sizeFFT; ++k)
       {
-      resampledFilterPiece[i + j * pieceSize[0]] = m_Filter.GetElement(k); //Copy values
-      ++k;
+      const FFTPixelType re = pieceFFT[k][0] * cache.FilterFFT[k][0] - pieceFFT[k][1] * cache.FilterFFT[k][1];
+      const FFTPixelType im = pieceFFT[k][0] * cache.FilterFFT[k][1] + pieceFFT[k][1] * cache.FilterFFT[k][0];
+      pieceFFT[k][0] = re * scale;
+      pieceFFT[k][1] = im * scale;
       }
-    }
-
-  FFTWProxyType::Execute(filterPlan);
-
-  // memory allocation for inverse FFT
-  FFTWProxyType::ComplexType* multipliedFFTarray;
-  multipliedFFTarray = static_cast<FFTWProxyType::ComplexType*>(fftw_malloc(sizeFFT * sizeof(FFTWProxyType::ComplexType)));
-
-  FFTWProxyType::PixelType* inverseFFTpiece;
-  inverseFFTpiece = static_cast<FFTWProxyType::PixelType*>(fftw_malloc(pieceNbOfPixel * sizeof(FFTWProxyType::PixelType)));
 
-  // Inverse FFT of the product of FFT (actually do filtering here)
-  FFTWProxyType::PlanType outputPlan = FFTWProxyType::Plan_dft_c2r_2d(pieceSize[1],
-                                                                      pieceSize[0],
-                                                                      multipliedFFTarray,
-                                                                      inverseFFTpiece,
-                                                                      FFTW_MEASURE);
-
-  // Filling the buffer with complex product values
-  for (k = 0; k < sizeFFT; ++k)
-    {
-    //complex mutiplication
-    multipliedFFTarray[k][0] = inputPieceFFT[k][0] * filterPieceFFT[k][0] - inputPieceFFT[k][1] * filterPieceFFT[k][1];
-    multipliedFFTarray[k][1] = inputPieceFFT[k][0] * filterPieceFFT[k][1] + inputPieceFFT[k][1] * filterPieceFFT[k][0];
+    FFTWType::ExecuteInverse(cache.InversePlan, pieceFFT, piece);
     }
 
-  FFTWProxyType::Execute(outputPlan);
+  // Fill the output image
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+  itk::ImageRegionIterator<OutputImageType> outputIt(output, outputRegionForThread);
+  outputIt.GoToBegin();
 
-  // Computing the filter normalization
+  OutputPixelType outPixel;
+  itk::NumericTraits<OutputPixelType>::SetLength(outPixel, nbComponents);
 
-  if (m_NormalizeFilter)
+  const unsigned int outputSizeX = outputRegionForThread.GetSize()[0];
+  const unsigned int outputSizeY = outputRegionForThread.GetSize()[1];
+  for (unsigned int y = 0; y < outputSizeY; ++y)
     {
-    norm = itk::NumericTraits<InputRealType>::Zero;
-    for (i = 0; i < sizeOfFilter[0] * sizeOfFilter[1]; ++i)
+    const unsigned int lineOffset = (y + 2 * m_Radius[1]) * pieceSizeX + 2 * m_Radius[0];
+    for (unsigned int x = 0; x < outputSizeX; ++x)
       {
-      norm += static_cast<InputRealType>(m_Filter(i));
+      for (unsigned int c = 0; c < nbComponents; ++c)
+        {
+        itk::DefaultConvertPixelTraits<OutputPixelType>::SetNthComponent(
+          c, outPixel, static_cast<OutputValueType>(inputPieces[c * pieceStride + lineOffset + x]));
+        }
+      outputIt.Set(outPixel);
+      ++outputIt;
+      progress.CompletedPixel();
       }
-    if (norm == 0.0)
-      {
-      norm = 1.0;
-      }
-    else
-      {
-      norm = 1 / norm;
-      }
-    }
-  else
-    {
-    norm = 1.0;
     }
 
-  // Fill the output image
-  outputIt.GoToBegin();
-  while (!outputIt.IsAtEnd())
-    {
-    typename InputImageType::IndexType index = outputIt.GetIndex();
-    unsigned int                       linearIndex =
-      (index[1] + sizeOfFilter[1] - 1 -
-       outputRegionForThread.GetIndex()[1]) * pieceSize[0] - 1 + index[0] + sizeOfFilter[0] -
-      outputRegionForThread.GetIndex()[0];
-    outputIt.Set(static_cast<OutputPixelType>((inverseFFTpiece[linearIndex] /
-                                               pieceNbOfPixel) * static_cast<double>(norm)));
-    ++outputIt;
-    }
-
-  // destroy the FFT plans
-  FFTWProxyType::DestroyPlan(inputPlan);
-  FFTWProxyType::DestroyPlan(filterPlan);
-  FFTWProxyType::DestroyPlan(outputPlan);
-
   //frees memory
-  fftw_free(resampledFilterPiece);
-  fftw_free(inputPiece);
-  fftw_free(filterPieceFFT);
-  fftw_free(inputPieceFFT);
-  fftw_free(multipliedFFTarray);
-  fftw_free(inverseFFTpiece);
+  FFTWType::Free(inputPieces);
+  FFTWType::Free(pieceFFT);
 #else
+  (void)outputRegionForThread;
+  (void)threadId;
   itkGenericExceptionMacro(
     <<
-    "The OverlapSaveConvolutionImageFilter can not operate without the FFTW library (double implementation). Please build ITK with USE_FFTD set to ON, and rebuild OTB.");
+    "The OverlapSaveConvolutionImageFilter can not operate without the FFTW library. Please build ITK with USE_FFTWD or USE_FFTWF set to ON, and rebuild OTB.");
 #endif
 }
 
@@ -316,6 +411,10 @@ OverlapSaveConvolutionImageFilter<TInputImage, TOutput, TBoundaryCondition>
   Superclass::PrintSelf(os, indent);
   os << indent << "Radius: " << m_Radius << std::endl;
   os << indent << "Normalize filter: " << m_NormalizeFilter << std::endl;
+  os << indent << "FFT cache maximum size: " << m_FFTCacheMaximumSize << std::endl;
+#if defined ITK_USE_FFTWD || defined ITK_USE_FFTWF
+  os << indent << "Cached piece sizes: " << m_FFTCache.size() << std::endl;
+#endif
 }
 } // end namespace otb
 
@@ -27,6 +27,7 @@ void RegisterTests()
   REGISTER_TEST(otbOverlapSaveConvolutionImageFilterNew);
 #if defined(ITK_USE_FFTWD)
   REGISTER_TEST(otbOverlapSaveConvolutionImageFilter);
+  REGISTER_TEST(otbOverlapSaveConvolutionImageFilterVectorImage);
   REGISTER_TEST(otbCompareOverlapSaveAndClassicalConvolutionWithGaborFilter);
 #endif
   REGISTER_TEST(otbGaborFilterGenerator);
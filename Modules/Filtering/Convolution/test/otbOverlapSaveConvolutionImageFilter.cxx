@@ -21,6 +21,7 @@
 
 
 #include "otbImage.h"
+#include "otbVectorImage.h"
 #include "otbImageFileReader.h"
 #include "otbImageFileWriter.h"
 #include "otbOverlapSaveConvolutionImageFilter.h"
@@ -65,3 +66,45 @@ int otbOverlapSaveConvolutionImageFilter(int itkNotUsed(argc), char * argv[])
 
   return EXIT_SUCCESS;
 }
+
+int otbOverlapSaveConvolutionImageFilterVectorImage(int itkNotUsed(argc), char * argv[])
+{
+  const char * inputFileName = argv[1];
+  const char * outputFileName = argv[2];
+
+  // float components: single precision transforms when available
+  typedef float      PixelType;
+  const unsigned int Dimension = 2;
+
+  typedef otb::VectorImage<PixelType,  Dimension>                           ImageType;
+  typedef otb::ImageFileReader<ImageType>                                   ReaderType;
+  typedef otb::ImageFileWriter<ImageType>                                   WriterType;
+  typedef otb::OverlapSaveConvolutionImageFilter<ImageType, ImageType>      ConvFilterType;
+
+  ReaderType::Pointer     reader     = ReaderType::New();
+  WriterType::Pointer     writer     = WriterType::New();
+  ConvFilterType::Pointer convFilter = ConvFilterType::New();
+
+  reader->SetFileName(inputFileName);
+  writer->SetFileName(outputFileName);
+
+  ConvFilterType::InputSizeType radius;
+  radius[0] = 3;
+  radius[1] = 3;
+  ConvFilterType::ArrayType filterCoeffs;
+  filterCoeffs.SetSize((2 * radius[0] + 1) * (2 * radius[1] + 1));
+  filterCoeffs.Fill(1);
+
+  convFilter->SetRadius(radius);
+  convFilter->SetFilter(filterCoeffs);
+  convFilter->NormalizeFilterOn();
+
+  convFilter->SetInput(reader->GetOutput());
+  writer->SetInput(convFilter->GetOutput());
+
+  // Several strips, so that cached plans are reused between pieces
+  writer->SetNumberOfDivisionsStrippedStreaming(5);
+  writer->Update();
+
+  return EXIT_SUCCESS;
+}
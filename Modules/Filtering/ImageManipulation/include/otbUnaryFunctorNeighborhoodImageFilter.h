@@ -25,6 +25,7 @@
 #include "itkImageRegionIteratorWithIndex.h"
 #include "itkConstNeighborhoodIterator.h"
 #include "itkProcessObject.h"
+#include "otbThreadPoolDispatcher.h"
 
 namespace otb
 {
@@ -125,6 +126,10 @@ protected:
    */
   ~UnaryFunctorNeighborhoodImageFilter() ITK_OVERRIDE {}
 
+  /** Process the output region by chunks on the ThreadPool when it is
+   * enabled, with the MultiThreader otherwise */
+  void GenerateData() ITK_OVERRIDE;
+
   /** UnaryFunctorNeighborhoodImageFilter can be implemented as a multithreaded filter.
    * Therefore, this implementation provides a ThreadedGenerateData() routine
    * which is called for each processing thread. The output image data is
@@ -143,6 +148,8 @@ protected:
   void GenerateInputRequestedRegion(void) ITK_OVERRIDE;
 
 private:
+  friend class ThreadPoolDispatcher<Self>;
+
   UnaryFunctorNeighborhoodImageFilter(const Self &); //purposely not implemented
   void operator =(const Self&); //purposely not implemented
 
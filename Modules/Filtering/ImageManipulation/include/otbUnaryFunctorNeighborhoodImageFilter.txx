@@ -91,6 +91,17 @@ UnaryFunctorNeighborhoodImageFilter<TInputImage, TOutputImage, TFunction>
     }
 }
 
+template <class TInputImage, class TOutputImage, class TFunction>
+void
+UnaryFunctorNeighborhoodImageFilter<TInputImage, TOutputImage, TFunction>
+::GenerateData()
+{
+  if (!ThreadPoolDispatcher<Self>::GenerateData(this))
+    {
+    Superclass::GenerateData();
+    }
+}
+
 /**
  * ThreadedGenerateData Performs the neighborhood-wise operation
  */
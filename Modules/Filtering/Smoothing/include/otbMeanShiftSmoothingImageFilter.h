@@ -26,6 +26,7 @@
 #include "itkImageToImageFilter.h"
 #include "itkImageRegionConstIterator.h"
 #include "itkImageRegionConstIteratorWithIndex.h"
+#include "otbThreadPoolDispatcher.h"
 #include <vcl_algorithm.h>
 
 
@@ -582,6 +583,12 @@ protected:
 
   void BeforeThreadedGenerateData() ITK_OVERRIDE;
 
+  /** Process the output region by chunks on the ThreadPool when it is
+   * enabled, with the MultiThreader otherwise. The mean shift converges
+   * in a very variable number of iterations from one pixel to another,
+   * which makes the static split of the MultiThreader unbalanced. */
+  void GenerateData() ITK_OVERRIDE;
+
   /** MeanShiftFilter can be implemented as a multithreaded filter.
    * Therefore, this implementation provides a ThreadedGenerateData()
    * routine which is called for each processing thread. The output
@@ -617,6 +624,8 @@ protected:
 #endif
 
 private:
+  friend class ThreadPoolDispatcher<Self>;
+
   MeanShiftSmoothingImageFilter(const Self &); //purposely not implemented
   void operator =(const Self&); //purposely not implemented
 
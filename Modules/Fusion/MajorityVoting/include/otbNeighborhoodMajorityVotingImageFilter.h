@@ -58,6 +58,15 @@ namespace otb
  *     the image neighbors where the kernel has elements > 0.
  *   - Replace the original label value with the more representative label value
  *
+ * The filter does not rebuild the label histogram for each pixel: labels
+ * present in the input are mapped to a dense array of counts, which is
+ * updated as the structuring element slides along each line, by removing
+ * the pixels leaving the kernel and adding the ones entering it (Huang's
+ * algorithm, generalized to any structuring element shape). The cost per
+ * pixel is proportional to the kernel border and the number of labels
+ * rather than to the kernel area. Pixels outside the image are considered
+ * as no-data pixels.
+ *
  * \sa MorphologyImageFilter, GrayscaleFunctionDilateImageFilter, BinaryDilateImageFilter
  * \ingroup ImageEnhancement  MathematicalMorphologyImageFilters
  *
@@ -115,6 +124,13 @@ public:
   /** Type of the pixels in the Kernel. */
   typedef typename TKernel::PixelType            KernelPixelType;
 
+  /** Image related typedefs. */
+  typedef TInputImage                                 InputImageType;
+  typedef typename InputImageType::RegionType         InputImageRegionType;
+  typedef typename InputImageType::IndexType          IndexType;
+  typedef typename InputImageType::OffsetType         OffsetType;
+  typedef typename Superclass::OutputImageRegionType  OutputImageRegionType;
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
   itkConceptMacro(InputConvertibleToOutputCheck,
@@ -173,6 +189,14 @@ protected:
 
   void GenerateOutputInformation() ITK_OVERRIDE;
 
+  /** Collect the labels of the input and the kernel offsets used by the
+   * sliding histogram. */
+  void BeforeThreadedGenerateData() ITK_OVERRIDE;
+
+  /** Majority voting with a sliding label histogram */
+  void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                            itk::ThreadIdType threadId) ITK_OVERRIDE;
+
 
   //Type to store the useful information from the label histogram  
   struct HistoSummary
@@ -198,6 +222,12 @@ protected:
                                                          const KernelIteratorType kernelBegin,
                                                          const KernelIteratorType kernelEnd) const;
 
+  //Select the output label from the center pixel and the histogram summary
+  PixelType DecideLabel(const PixelType& centerPixel, const HistoSummary& histoSummary) const;
+
+  //Position of a label in the dense histogram, -1 for no-data pixels
+  int GetLabelIndex(const PixelType& label) const;
+
 private:
   NeighborhoodMajorityVotingImageFilter(const Self&); //purposely not implemented
   void operator=(const Self&); //purposely not implemented
@@ -215,6 +245,20 @@ private:
   //this threshold with the same label
   unsigned int m_IsolatedThreshold;
 
+  //Sorted labels of the input, excluding the no-data label
+  std::vector<PixelType> m_Labels;
+  //Direct lookup of label positions, for integer labels of small range
+  std::vector<int> m_LabelLookupTable;
+  bool             m_UseLabelLookupTable;
+  PixelType        m_LabelLookupTableOrigin;
+
+  //Offsets of the kernel elements, and of the elements entering and
+  //leaving the kernel when its center moves by one pixel along the first
+  //dimension (both relative to the new center)
+  std::vector<OffsetType> m_KernelOffsets;
+  std::vector<OffsetType> m_EnteringOffsets;
+  std::vector<OffsetType> m_LeavingOffsets;
+
 }; // end of class
 
 } // end namespace otb
@@ -29,6 +29,12 @@
 #include "itkDefaultConvertPixelTraits.h"
 #include "itkMetaDataObject.h"
 #include "otbMetaDataKey.h"
+#include "itkImageLinearIteratorWithIndex.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkProgressReporter.h"
+
+#include <algorithm>
+#include <set>
 
 namespace otb
 {
@@ -37,6 +43,9 @@ namespace otb
  */
 template<class TInputImage, class TOutputImage, class TKernel>
 NeighborhoodMajorityVotingImageFilter<TInputImage, TOutputImage, TKernel>::NeighborhoodMajorityVotingImageFilter()
+  : m_LabelForNoDataPixels(itk::NumericTraits<PixelType>::Zero),
+    m_UseLabelLookupTable(false),
+    m_LabelLookupTableOrigin(itk::NumericTraits<PixelType>::Zero)
 {
   this->SetLabelForNoDataPixels(itk::NumericTraits<PixelType>::NonpositiveMin()); //m_LabelForNoDataPixels = 0
   this->SetLabelForUndecidedPixels(itk::NumericTraits<PixelType>::NonpositiveMin()); //m_LabelForUndecidedPixels = 0
@@ -64,32 +73,41 @@ NeighborhoodMajorityVotingImageFilter<TInputImage,
     //Get a histogram of label frequencies where the 2 highest are at the beginning and sorted
     const HistoSummary histoSummary = 
       this->ComputeNeighborhoodHistogramSummary(nit, kernelBegin, kernelEnd);
-    if(m_OnlyIsolatedPixels && 
-       histoSummary.freqCenterLabel > m_IsolatedThreshold)
-      {
-      //If we want to filter only isolated pixels, keep the label if
-      //there are enough pixels with the center label to consider that
-      //it is not isolated
-      return centerPixel;
-      }
-    else
+    return this->DecideLabel(centerPixel, histoSummary);
+    }//END if (centerPixel != m_LabelForNoDataPixels)
+}
+
+template<class TInputImage, class TOutputImage, class TKernel>
+typename NeighborhoodMajorityVotingImageFilter<TInputImage, TOutputImage,
+                                               TKernel>::PixelType
+NeighborhoodMajorityVotingImageFilter<TInputImage, TOutputImage, TKernel>
+::DecideLabel(const PixelType& centerPixel, const HistoSummary& histoSummary) const
+{
+  if(m_OnlyIsolatedPixels &&
+     histoSummary.freqCenterLabel > m_IsolatedThreshold)
+    {
+    //If we want to filter only isolated pixels, keep the label if
+    //there are enough pixels with the center label to consider that
+    //it is not isolated
+    return centerPixel;
+    }
+  else
+    {
+    //If the majorityLabel is NOT unique in the neighborhood
+    if(!histoSummary.majorityUnique)
       {
-      //If the majorityLabel is NOT unique in the neighborhood
-      if(!histoSummary.majorityUnique)
+      if (m_KeepOriginalLabelBool == true)
         {
-        if (m_KeepOriginalLabelBool == true)
-          {
-          return centerPixel;
-          }
-        else
-          {
-          return m_LabelForUndecidedPixels;
-          }
+        return centerPixel;
+        }
+      else
+        {
+        return m_LabelForUndecidedPixels;
         }
-      //Extraction of the more representative Label in the neighborhood (majorityLabel)
-      return histoSummary.majorityLabel;
       }
-    }//END if (centerPixel != m_LabelForNoDataPixels)
+    //Extraction of the more representative Label in the neighborhood (majorityLabel)
+    return histoSummary.majorityLabel;
+    }
 }
 
 template<class TInputImage, class TOutputImage, class TKernel>
@@ -140,6 +158,236 @@ NeighborhoodMajorityVotingImageFilter<TInputImage, TOutputImage,
   return result;
 }
 
+template<class TInputImage, class TOutputImage, class TKernel>
+int
+NeighborhoodMajorityVotingImageFilter<TInputImage, TOutputImage, TKernel>
+::GetLabelIndex(const PixelType& label) const
+{
+  if (label == m_LabelForNoDataPixels || m_Labels.empty())
+    {
+    return -1;
+    }
+  if (m_UseLabelLookupTable)
+    {
+    if (label < m_LabelLookupTableOrigin || label > m_Labels.back())
+      {
+      return -1;
+      }
+    return m_LabelLookupTable[static_cast<size_t>(label - m_LabelLookupTableOrigin)];
+    }
+  typename std::vector<PixelType>::const_iterator it =
+    std::lower_bound(m_Labels.begin(), m_Labels.end(), label);
+  if (it == m_Labels.end() || *it != label)
+    {
+    return -1;
+    }
+  return static_cast<int>(it - m_Labels.begin());
+}
+
+template<class TInputImage, class TOutputImage, class TKernel>
+void
+NeighborhoodMajorityVotingImageFilter<TInputImage, TOutputImage, TKernel>
+::BeforeThreadedGenerateData()
+{
+  Superclass::BeforeThreadedGenerateData();
+
+  const InputImageType * inputPtr = this->GetInput();
+
+  // Collect the labels read by the filter: classification maps have long
+  // runs of the same label, so remember the last inserted one.
+  std::set<PixelType> labels;
+  itk::ImageRegionConstIterator<InputImageType> inIt(inputPtr, inputPtr->GetBufferedRegion());
+  bool      hasLast = false;
+  PixelType last = itk::NumericTraits<PixelType>::Zero;
+  for (inIt.GoToBegin(); !inIt.IsAtEnd(); ++inIt)
+    {
+    const PixelType label = inIt.Get();
+    if (!hasLast || label != last)
+      {
+      if (label != m_LabelForNoDataPixels)
+        {
+        labels.insert(label);
+        }
+      last = label;
+      hasLast = true;
+      }
+    }
+  m_Labels.assign(labels.begin(), labels.end());
+
+  // Integer labels spanning a small range are looked up directly
+  m_UseLabelLookupTable = false;
+  m_LabelLookupTable.clear();
+  if (itk::NumericTraits<PixelType>::is_integer && !m_Labels.empty()
+      && static_cast<double>(m_Labels.back()) - static_cast<double>(m_Labels.front()) < 65536.0)
+    {
+    m_UseLabelLookupTable = true;
+    m_LabelLookupTableOrigin = m_Labels.front();
+    m_LabelLookupTable.assign(static_cast<size_t>(m_Labels.back() - m_Labels.front()) + 1, -1);
+    for (unsigned int i = 0; i < m_Labels.size(); ++i)
+      {
+      m_LabelLookupTable[static_cast<size_t>(m_Labels[i] - m_LabelLookupTableOrigin)] = i;
+      }
+    }
+
+  // Offsets of the kernel elements, and of the ones entering and leaving
+  // the kernel when it moves by one pixel along the first dimension
+  const KernelType& kernel = this->GetKernel();
+  const typename KernelType::SizeType radius = kernel.GetRadius();
+
+  m_KernelOffsets.clear();
+  m_EnteringOffsets.clear();
+  m_LeavingOffsets.clear();
+  for (unsigned int i = 0; i < kernel.Size(); ++i)
+    {
+    if (!(kernel[i] > itk::NumericTraits<KernelPixelType>::Zero))
+      {
+      continue;
+      }
+    const OffsetType offset = kernel.GetOffset(i);
+    m_KernelOffsets.push_back(offset);
+
+    OffsetType next = offset;
+    next[0] += 1;
+    if (next[0] > static_cast<typename OffsetType::OffsetValueType>(radius[0])
+        || !(kernel[kernel.GetNeighborhoodIndex(next)] > itk::NumericTraits<KernelPixelType>::Zero))
+      {
+      m_EnteringOffsets.push_back(offset);
+      }
+
+    OffsetType previous = offset;
+    previous[0] -= 1;
+    if (previous[0] < -static_cast<typename OffsetType::OffsetValueType>(radius[0])
+        || !(kernel[kernel.GetNeighborhoodIndex(previous)] > itk::NumericTraits<KernelPixelType>::Zero))
+      {
+      m_LeavingOffsets.push_back(previous);
+      }
+    }
+}
+
+template<class TInputImage, class TOutputImage, class TKernel>
+void
+NeighborhoodMajorityVotingImageFilter<TInputImage, TOutputImage, TKernel>
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
+                       itk::ThreadIdType threadId)
+{
+  const InputImageType * inputPtr = this->GetInput();
+  TOutputImage *         outputPtr = this->GetOutput();
+
+  const InputImageRegionType bufferedRegion = inputPtr->GetBufferedRegion();
+
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+
+  // Dense histogram of the labels under the kernel
+  const unsigned int        nbLabels = m_Labels.size();
+  std::vector<unsigned int> histogram(nbLabels, 0);
+
+  typedef itk::ImageLinearIteratorWithIndex<TOutputImage> LineIteratorType;
+  LineIteratorType outIt(outputPtr, outputRegionForThread);
+  outIt.SetDirection(0);
+
+  for (outIt.GoToBegin(); !outIt.IsAtEnd(); outIt.NextLine())
+    {
+    // Build the histogram of the first pixel of the line
+    std::fill(histogram.begin(), histogram.end(), 0);
+    IndexType center = outIt.GetIndex();
+    for (typename std::vector<OffsetType>::const_iterator offIt = m_KernelOffsets.begin();
+         offIt != m_KernelOffsets.end(); ++offIt)
+      {
+      const IndexType index = center + *offIt;
+      if (bufferedRegion.IsInside(index))
+        {
+        const int labelIndex = this->GetLabelIndex(inputPtr->GetPixel(index));
+        if (labelIndex >= 0)
+          {
+          ++histogram[labelIndex];
+          }
+        }
+      }
+
+    bool firstPixel = true;
+    for (outIt.GoToBeginOfLine(); !outIt.IsAtEndOfLine(); ++outIt)
+      {
+      center = outIt.GetIndex();
+
+      // Slide the kernel by one pixel
+      if (!firstPixel)
+        {
+        for (typename std::vector<OffsetType>::const_iterator offIt = m_LeavingOffsets.begin();
+             offIt != m_LeavingOffsets.end(); ++offIt)
+          {
+          const IndexType index = center + *offIt;
+          if (bufferedRegion.IsInside(index))
+            {
+            const int labelIndex = this->GetLabelIndex(inputPtr->GetPixel(index));
+            if (labelIndex >= 0)
+              {
+              --histogram[labelIndex];
+              }
+            }
+          }
+        for (typename std::vector<OffsetType>::const_iterator offIt = m_EnteringOffsets.begin();
+             offIt != m_EnteringOffsets.end(); ++offIt)
+          {
+          const IndexType index = center + *offIt;
+          if (bufferedRegion.IsInside(index))
+            {
+            const int labelIndex = this->GetLabelIndex(inputPtr->GetPixel(index));
+            if (labelIndex >= 0)
+              {
+              ++histogram[labelIndex];
+              }
+            }
+          }
+        }
+      firstPixel = false;
+
+      const PixelType centerPixel = inputPtr->GetPixel(center);
+      if (centerPixel == m_LabelForNoDataPixels)
+        {
+        outIt.Set(static_cast<typename TOutputImage::PixelType>(m_LabelForNoDataPixels));
+        progress.CompletedPixel();
+        continue;
+        }
+
+      // Summarize the histogram: the most frequent label and whether it is
+      // the only one with this frequency
+      unsigned int maxFrequency = 0;
+      unsigned int nbMaxLabels = 0;
+      unsigned int maxLabelIndex = 0;
+      for (unsigned int i = 0; i < nbLabels; ++i)
+        {
+        if (histogram[i] > maxFrequency)
+          {
+          maxFrequency = histogram[i];
+          maxLabelIndex = i;
+          nbMaxLabels = 1;
+          }
+        else if (histogram[i] == maxFrequency && maxFrequency > 0)
+          {
+          ++nbMaxLabels;
+          }
+        }
+
+      if (maxFrequency == 0)
+        {
+        // No label under the kernel
+        outIt.Set(static_cast<typename TOutputImage::PixelType>(centerPixel));
+        progress.CompletedPixel();
+        continue;
+        }
+
+      HistoSummary histoSummary;
+      const int centerLabelIndex = this->GetLabelIndex(centerPixel);
+      histoSummary.freqCenterLabel = centerLabelIndex >= 0 ? histogram[centerLabelIndex] : 0;
+      histoSummary.majorityLabel = m_Labels[maxLabelIndex];
+      histoSummary.majorityUnique = (nbMaxLabels == 1);
+
+      outIt.Set(static_cast<typename TOutputImage::PixelType>(this->DecideLabel(centerPixel, histoSummary)));
+      progress.CompletedPixel();
+      }
+    }
+}
+
 template<class TInputImage, class TOutputImage, class TKernel>
 void
 NeighborhoodMajorityVotingImageFilter<TInputImage, TOutputImage, TKernel>
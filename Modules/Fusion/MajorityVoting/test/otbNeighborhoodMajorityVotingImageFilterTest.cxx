@@ -29,6 +29,9 @@
 #include "otbNeighborhoodMajorityVotingImageFilter.h"
 
 #include "itkTimeProbe.h"
+#include "itkImageRegionIterator.h"
+
+#include <map>
 
 
 int otbNeighborhoodMajorityVotingImageFilterTest(int argc, char* argv[])
@@ -208,3 +211,101 @@ int otbNeighborhoodMajorityVotingImageFilterIsolatedTest(int itkNotUsed(argc), c
     }
   return EXIT_SUCCESS;
 }
+
+int otbNeighborhoodMajorityVotingImageFilterSlidingTest(int itkNotUsed(argc), char* itkNotUsed(argv)[])
+{
+  typedef unsigned char PixelType; // 8 bits
+  const unsigned int Dimension = 2;
+
+  typedef otb::Image<PixelType, Dimension> ImageType;
+
+  const PixelType noDataLabel = 255;
+  const PixelType undecidedLabel = 254;
+
+  // Random label image with 30 classes and some no-data pixels
+  ImageType::Pointer image = ImageType::New();
+  ImageType::IndexType start;
+  start.Fill(0);
+  ImageType::SizeType size;
+  size[0] = 61;
+  size[1] = 47;
+  ImageType::RegionType region;
+  region.SetSize(size);
+  region.SetIndex(start);
+  image->SetRegions(region);
+  image->Allocate();
+
+  srand(0);
+  itk::ImageRegionIterator<ImageType> imIt(image, region);
+  for (imIt.GoToBegin(); !imIt.IsAtEnd(); ++imIt)
+    {
+    const int draw = rand() % 40;
+    imIt.Set(draw < 30 ? static_cast<PixelType>(draw) : (draw < 33 ? noDataLabel : 3));
+    }
+
+  typedef otb::NeighborhoodMajorityVotingImageFilter<ImageType> NeighborhoodMajorityVotingFilterType;
+  typedef NeighborhoodMajorityVotingFilterType::KernelType StructuringType;
+  typedef StructuringType::RadiusType RadiusType;
+
+  StructuringType seBall;
+  RadiusType rad;
+  rad[0] = 3;
+  rad[1] = 2;
+  seBall.SetRadius(rad);
+  seBall.CreateStructuringElement();
+
+  NeighborhoodMajorityVotingFilterType::Pointer NeighMajVotingFilter = NeighborhoodMajorityVotingFilterType::New();
+  NeighMajVotingFilter->SetInput(image);
+  NeighMajVotingFilter->SetKernel(seBall);
+  NeighMajVotingFilter->SetKeepOriginalLabelBool(false);
+  NeighMajVotingFilter->SetLabelForNoDataPixels(noDataLabel);
+  NeighMajVotingFilter->SetLabelForUndecidedPixels(undecidedLabel);
+  NeighMajVotingFilter->Update();
+
+  // Reference: histogram rebuilt for each pixel
+  for (imIt.GoToBegin(); !imIt.IsAtEnd(); ++imIt)
+    {
+    const ImageType::IndexType center = imIt.GetIndex();
+    PixelType expected = noDataLabel;
+    if (imIt.Get() != noDataLabel)
+      {
+      std::map<PixelType, unsigned int> histogram;
+      for (unsigned int i = 0; i < seBall.Size(); ++i)
+        {
+        const ImageType::IndexType index = center + seBall.GetOffset(i);
+        if (seBall[i] > 0 && region.IsInside(index) && image->GetPixel(index) != noDataLabel)
+          {
+          histogram[image->GetPixel(index)] += 1;
+          }
+        }
+      unsigned int maxFrequency = 0;
+      unsigned int nbMaxLabels = 0;
+      for (std::map<PixelType, unsigned int>::const_iterator it = histogram.begin(); it != histogram.end(); ++it)
+        {
+        if (it->second > maxFrequency)
+          {
+          maxFrequency = it->second;
+          expected = it->first;
+          nbMaxLabels = 1;
+          }
+        else if (it->second == maxFrequency)
+          {
+          ++nbMaxLabels;
+          }
+        }
+      if (nbMaxLabels != 1)
+        {
+        expected = undecidedLabel;
+        }
+      }
+
+    const PixelType result = NeighMajVotingFilter->GetOutput()->GetPixel(center);
+    if (result != expected)
+      {
+      std::cout << "Wrong label at " << center << ": " << int(result)
+                << " instead of " << int(expected) << '\n';
+      return EXIT_FAILURE;
+      }
+    }
+  return EXIT_SUCCESS;
+}
@@ -26,6 +26,7 @@
 #include <vector>
 
 #include "otbImageIOBase.h"
+#include "otbMappedFile.h"
 
 namespace otb
 {
@@ -34,7 +35,11 @@ namespace otb
  *
  * \brief ImageIO object for reading (not writing) BSQ format images
  *
- * The streaming read is implemented.
+ * The streaming read is implemented. The channel files are memory mapped
+ * when possible: the requested region is then copied from the mapping,
+ * band by band, into the pixel interleaved buffer, without the seek and
+ * read calls of each line. If a channel file can not be mapped, the
+ * files are read with streams.
  *
  * \ingroup IOFilters
  *
@@ -147,6 +152,19 @@ private:
   /** Internal method to read header information */
   bool InternalReadHeaderInformation(const std::string& file_name, std::fstream& file, const bool reportError);
 
+  /** Map all the channel files. Returns false if one of them can not be
+   * mapped. */
+  bool MapChannelsFiles();
+
+  /** Unmap the channel files */
+  void UnmapChannelsFiles();
+
+  /** Read the IORegion from the mapped channel files */
+  void ReadMappedRegion(char * buffer);
+
+  /** Read the IORegion from the channel streams */
+  void ReadStreamedRegion(char * buffer);
+
 #define otbSwappFileOrderToSystemOrderMacro(StrongType, buffer, buffer_size) \
     { \
     typedef itk::ByteSwapper<StrongType> InternalByteSwapperType; \
@@ -182,6 +200,10 @@ private:
   std::vector<std::string>    m_ChannelsFileName;
   std::fstream * m_ChannelsFile;
 
+  /** Mapped channel files, and whether mapping them has already failed */
+  std::vector<MappedFile *>   m_MappedChannelsFiles;
+  bool                        m_MappingFailed;
+
 };
 
 } // end namespace otb
@@ -59,6 +59,7 @@ BSQImageIO::BSQImageIO()
   m_Origin[1] = 0.5;
   m_ChannelsFile = ITK_NULLPTR;
   m_FlagWriteImageInformation = true;
+  m_MappingFailed = false;
 
   this->AddSupportedWriteExtension(".hd");
   this->AddSupportedWriteExtension(".HD");
@@ -70,6 +71,7 @@ BSQImageIO::BSQImageIO()
 
 BSQImageIO::~BSQImageIO()
 {
+  this->UnmapChannelsFiles();
   if (m_HeaderFile.is_open())
     {
     m_HeaderFile.close();
@@ -130,20 +132,119 @@ void BSQImageIO::ReadVolume(void*)
 
 // Read image
 void BSQImageIO::Read(void* buffer)
+{
+  char * p = static_cast<char *>(buffer);
+
+  otbMsgDevMacro(<< " BSQImageIO::Read()  ");
+  otbMsgDevMacro(<< " Image size  : " << m_Dimensions[0] << "," << m_Dimensions[1]);
+  otbMsgDevMacro(<< " Region read (IORegion)  : " << this->GetIORegion());
+  otbMsgDevMacro(<< " Nb Of Components       : " << this->GetNumberOfComponents());
+
+  if (this->MapChannelsFiles())
+    {
+    this->ReadMappedRegion(p);
+    }
+  else
+    {
+    this->ReadStreamedRegion(p);
+    }
+
+  unsigned long numberOfPixelsOfRegion = this->GetIORegion().GetSize()[1] * this->GetIORegion().GetSize()[0]
+    * this->GetNumberOfComponents();
+
+  // Swap bytes if necessary
+  if (0) {}
+  otbSwappFileToSystemMacro(unsigned short, USHORT, buffer, numberOfPixelsOfRegion)
+  otbSwappFileToSystemMacro(short, SHORT, buffer, numberOfPixelsOfRegion)
+  otbSwappFileToSystemMacro(char, CHAR, buffer, numberOfPixelsOfRegion)
+  otbSwappFileToSystemMacro(unsigned char, UCHAR, buffer, numberOfPixelsOfRegion)
+  otbSwappFileToSystemMacro(unsigned int, UINT, buffer, numberOfPixelsOfRegion)
+  otbSwappFileToSystemMacro(int, INT, buffer, numberOfPixelsOfRegion)
+  otbSwappFileToSystemMacro(long, LONG, buffer, numberOfPixelsOfRegion)
+  otbSwappFileToSystemMacro(unsigned long, ULONG, buffer, numberOfPixelsOfRegion)
+  otbSwappFileToSystemMacro(float, FLOAT, buffer, numberOfPixelsOfRegion)
+  otbSwappFileToSystemMacro(double, DOUBLE, buffer, numberOfPixelsOfRegion)
+  else
+    {
+    itkExceptionMacro(<< "BSQImageIO::Read() undefined component type! ");
+    }
+}
+
+bool BSQImageIO::MapChannelsFiles()
+{
+  if (m_MappingFailed)
+    {
+    return false;
+    }
+  if (m_MappedChannelsFiles.size() == m_ChannelsFileName.size())
+    {
+    return true;
+    }
+
+  this->UnmapChannelsFiles();
+
+  const std::size_t channelSize = static_cast<std::size_t>(this->GetComponentSize())
+    * static_cast<std::size_t>(m_Dimensions[0]) * static_cast<std::size_t>(m_Dimensions[1]);
+
+  for (unsigned int channel = 0; channel < m_ChannelsFileName.size(); ++channel)
+    {
+    MappedFile * mappedFile = new MappedFile;
+    m_MappedChannelsFiles.push_back(mappedFile);
+    if (!mappedFile->Open(m_ChannelsFileName[channel]) || mappedFile->GetSize() < channelSize)
+      {
+      otbMsgDevMacro(<< "BSQImageIO: can not map " << m_ChannelsFileName[channel] << ", using stream reads");
+      this->UnmapChannelsFiles();
+      m_MappingFailed = true;
+      return false;
+      }
+    }
+  return true;
+}
+
+void BSQImageIO::UnmapChannelsFiles()
+{
+  for (unsigned int channel = 0; channel < m_MappedChannelsFiles.size(); ++channel)
+    {
+    delete m_MappedChannelsFiles[channel];
+    }
+  m_MappedChannelsFiles.clear();
+}
+
+void BSQImageIO::ReadMappedRegion(char * buffer)
+{
+  const unsigned int nbComponents = this->GetNumberOfComponents();
+  const std::size_t  componentSize = this->GetComponentSize();
+
+  const std::size_t lNbLines     = this->GetIORegion().GetSize()[1];
+  const std::size_t lNbColumns   = this->GetIORegion().GetSize()[0];
+  const std::size_t lFirstLine   = this->GetIORegion().GetIndex()[1];
+  const std::size_t lFirstColumn = this->GetIORegion().GetIndex()[0];
+
+  const std::size_t numberOfBytesPerLines = componentSize * m_Dimensions[0];
+  const std::size_t outputLineSize = componentSize * nbComponents * lNbColumns;
+
+  std::vector<const char *> bands(nbComponents);
+  for (std::size_t line = 0; line < lNbLines; ++line)
+    {
+    const std::size_t offset = numberOfBytesPerLines * (lFirstLine + line) + componentSize * lFirstColumn;
+    for (unsigned int b = 0; b < nbComponents; ++b)
+      {
+      bands[b] = m_MappedChannelsFiles[b]->GetData() + offset;
+      }
+    InterleaveBands(&bands[0], nbComponents, componentSize, lNbColumns, componentSize,
+                    buffer + line * outputLineSize);
+    }
+}
+
+void BSQImageIO::ReadStreamedRegion(char * p)
 {
   unsigned long step = this->GetNumberOfComponents();
-  char *        p = static_cast<char *>(buffer);
 
   int lNbLines   = this->GetIORegion().GetSize()[1];
   int lNbColumns = this->GetIORegion().GetSize()[0];
   int lFirstLine   = this->GetIORegion().GetIndex()[1]; // [1... ]
   int lFirstColumn = this->GetIORegion().GetIndex()[0]; // [1... ]
 
-  otbMsgDevMacro(<< " BSQImageIO::Read()  ");
-  otbMsgDevMacro(<< " Image size  : " << m_Dimensions[0] << "," << m_Dimensions[1]);
-  otbMsgDevMacro(<< " Region read (IORegion)  : " << this->GetIORegion());
-  otbMsgDevMacro(<< " Nb Of Components       : " << this->GetNumberOfComponents());
-
   std::streamoff  headerLength(0);
   std::streamoff  numberOfBytesPerLines = static_cast<std::streamoff>(this->GetComponentSize() * m_Dimensions[0]);
   std::streamoff  offset;
@@ -161,13 +262,6 @@ void BSQImageIO::Read(void* buffer)
     return;
     }
 
-  otbMsgDevMacro(<< " sizeof(streamsize)    : " << sizeof(std::streamsize));
-  otbMsgDevMacro(<< " sizeof(streampos)     : " << sizeof(std::streampos));
-  otbMsgDevMacro(<< " sizeof(streamoff)     : " << sizeof(std::streamoff));
-  otbMsgDevMacro(<< " sizeof(std::ios::beg) : " << sizeof(std::ios::beg));
-  otbMsgDevMacro(<< " sizeof(size_t)        : " << sizeof(size_t));
-  otbMsgDevMacro(<< " sizeof(unsigned long) : " << sizeof(unsigned long));
-
   for (unsigned int nbComponents = 0; nbComponents < this->GetNumberOfComponents(); ++nbComponents)
     {
     cpt = (unsigned long) (nbComponents) * (unsigned long) (this->GetComponentSize());
@@ -200,30 +294,15 @@ void BSQImageIO::Read(void* buffer)
         }
       }
     }
-  unsigned long numberOfPixelsOfRegion = lNbLines * lNbColumns * this->GetNumberOfComponents();
-
   delete[] value;
-
-  // Swap bytes if necessary
-  if (0) {}
-  otbSwappFileToSystemMacro(unsigned short, USHORT, buffer, numberOfPixelsOfRegion)
-  otbSwappFileToSystemMacro(short, SHORT, buffer, numberOfPixelsOfRegion)
-  otbSwappFileToSystemMacro(char, CHAR, buffer, numberOfPixelsOfRegion)
-  otbSwappFileToSystemMacro(unsigned char, UCHAR, buffer, numberOfPixelsOfRegion)
-  otbSwappFileToSystemMacro(unsigned int, UINT, buffer, numberOfPixelsOfRegion)
-  otbSwappFileToSystemMacro(int, INT, buffer, numberOfPixelsOfRegion)
-  otbSwappFileToSystemMacro(long, LONG, buffer, numberOfPixelsOfRegion)
-  otbSwappFileToSystemMacro(unsigned long, ULONG, buffer, numberOfPixelsOfRegion)
-  otbSwappFileToSystemMacro(float, FLOAT, buffer, numberOfPixelsOfRegion)
-  otbSwappFileToSystemMacro(double, DOUBLE, buffer, numberOfPixelsOfRegion)
-  else
-    {
-    itkExceptionMacro(<< "BSQImageIO::Read() undefined component type! ");
-    }
 }
 
 void BSQImageIO::ReadImageInformation()
 {
+  // The channel files may change with the header
+  this->UnmapChannelsFiles();
+  m_MappingFailed = false;
+
   if (m_HeaderFile.is_open())
     {
     m_HeaderFile.close();
@@ -63,6 +63,17 @@ class GDALDataTypeWrapper;
  *
  * The streaming read is implemented.
  *
+ * The regions of compressed images (JPEG2000, or compressed GeoTIFF)
+ * are read by several threads: each one decodes a strip of whole
+ * blocks from its own handle on the dataset, directly in the output
+ * buffer. The number of threads is given by
+ * ConfigurationManager::GetGDALReadThreads().
+ *
+ * Likewise, compressed GeoTIFF outputs are encoded by several threads
+ * (NUM_THREADS creation option of GDAL, see
+ * ConfigurationManager::GetGDALWriteThreads()), unless the creation
+ * options already set it.
+ *
  * \ingroup IOFilters
  *
  *
@@ -234,10 +245,31 @@ private:
    */
   bool CreationOptionContains(std::string partialOption) const;
 
+  /** Get the creation options, with the number of threads of the
+   * compression added when the driver supports it */
+  GDALCreationOptionsType GetCreationOptionsForDriver(const std::string& driverShortName) const;
+
+  /** Read a region at full resolution from the file mapping of the
+   * bands, for raw formats in native byte order (ENVI, EHdr, ...).
+   * Returns false, without reading anything, if the bands can not be
+   * mapped. */
+  bool ReadMappedRegion(unsigned char* buffer, int firstColumn, int firstLine, int nbColumns, int nbLines);
+
+  /** Read a region at full resolution with several threads, each one
+   * reading a strip of whole block lines from its own dataset handle.
+   * Returns false, without reading anything, if the dataset is not
+   * compressed or if the region has too few block lines. */
+  bool ReadParallelRegion(unsigned char* buffer, int firstColumn, int firstLine, int nbColumns, int nbLines,
+                          int pixelOffset, int lineOffset, int bandOffset);
+
   /** GDAL parameters. */
   typedef itk::SmartPointer<GDALDatasetWrapper> GDALDatasetWrapperPointer;
   GDALDatasetWrapperPointer m_Dataset;
 
+  /** Additional handles on the dataset, opened by the first parallel
+   * read and kept for the next ones */
+  std::vector<GDALDatasetWrapperPointer> m_ReadDatasets;
+
   GDALDataTypeWrapper*    m_PxType;
   /** Nombre d'octets par pixel */
   int m_BytePerPixel;
@@ -21,10 +21,14 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <algorithm>
+#include <cstddef>
 
 #include "otbGDALImageIO.h"
 #include "otbMacro.h"
 #include "otbSystem.h"
+#include "otbMappedFile.h"
+#include "otbConfigurationManager.h"
 #include "itksys/SystemTools.hxx"
 #include "otbImage.h"
 #include "otb_tinyxml.h"
@@ -36,12 +40,16 @@
 #include "itkRGBPixel.h"
 #include "itkRGBAPixel.h"
 #include "itkTimeProbe.h"
+#include "itkMultiThreader.h"
 
 #include "cpl_conv.h"
 #include "ogr_spatialref.h"
 #include "ogr_srs_api.h"
 
 #include "otbGDALDriverManagerWrapper.h"
+#if GDAL_VERSION_NUM >= 1110000
+#include "cpl_virtualmem.h"
+#endif
 
 #include "otb_boost_string_header.h"
 
@@ -181,6 +189,7 @@ bool GDALImageIO::CanReadFile(const char* file)
     return false;
     }
   m_Dataset = GDALDriverManagerWrapper::GetInstance().Open(file);
+  m_ReadDatasets.clear();
   return m_Dataset.IsNotNull();
 }
 
@@ -393,6 +402,23 @@ void GDALImageIO::Read(void* buffer)
       bandOffset  = m_BytePerPixel;
       }
 
+    // Raw files are copied from their mapping when the buffer has the
+    // layout of a RasterIO call without resampling
+    if (m_ResolutionFactor == 0 && lNbColumns == lNbColumnsRegion && lNbLines == lNbLinesRegion
+        && pixelOffset == m_BytePerPixel * m_NbBands
+        && this->ReadMappedRegion(p, lFirstColumn, lFirstLine, lNbColumns, lNbLines))
+      {
+      return;
+      }
+
+    // Compressed files are decoded by several threads
+    if (m_ResolutionFactor == 0 && lNbColumns == lNbColumnsRegion && lNbLines == lNbLinesRegion
+        && this->ReadParallelRegion(p, lFirstColumn, lFirstLine, lNbColumns, lNbLines,
+                                    pixelOffset, lineOffset, bandOffset))
+      {
+      return;
+      }
+
     // keep it for the moment
     //otbMsgDevMacro(<< "Number of bands inside input file: " << m_NbBands);
     otbMsgDevMacro(<< "Parameters RasterIO : \n"
@@ -439,6 +465,258 @@ void GDALImageIO::Read(void* buffer)
     }
 }
 
+bool GDALImageIO::ReadMappedRegion(unsigned char* buffer, int firstColumn, int firstLine, int nbColumns, int nbLines)
+{
+#if GDAL_VERSION_NUM >= 1110000
+  if (!CPLIsVirtualMemFileMapAvailable())
+    {
+    return false;
+    }
+
+  GDALDataset* dataset = m_Dataset->GetDataSet();
+
+  // Only the driver implementation is wanted: it maps the file when the
+  // band is raw and in native byte order, and fails otherwise
+  char ** options = CSLSetNameValue(ITK_NULLPTR, "USE_DEFAULT_IMPLEMENTATION", "NO");
+
+  std::vector<CPLVirtualMem*> mappings;
+  std::vector<const char*>    bands;
+  int                         commonPixelSpace = 0;
+  GIntBig                     commonLineSpace = 0;
+  bool                        mapped = true;
+
+  for (int band = 0; band < m_NbBands && mapped; ++band)
+    {
+    GDALRasterBand* rasterBand = dataset->GetRasterBand(band + 1);
+    int             pixelSpace = 0;
+    GIntBig         lineSpace = 0;
+    CPLVirtualMem*  mapping = ITK_NULLPTR;
+
+    if (rasterBand->GetRasterDataType() == m_PxType->pixType)
+      {
+      mapping = rasterBand->GetVirtualMemAuto(GF_Read, &pixelSpace, &lineSpace, options);
+      }
+    if (mapping == ITK_NULLPTR || (band > 0 && (pixelSpace != commonPixelSpace || lineSpace != commonLineSpace)))
+      {
+      mapped = false;
+      }
+    if (mapping != ITK_NULLPTR)
+      {
+      mappings.push_back(mapping);
+      }
+    if (mapped)
+      {
+      commonPixelSpace = pixelSpace;
+      commonLineSpace = lineSpace;
+      bands.push_back(static_cast<const char*>(CPLVirtualMemGetAddr(mapping))
+                      + static_cast<GIntBig>(firstColumn) * pixelSpace);
+      }
+    }
+  CSLDestroy(options);
+
+  if (mapped)
+    {
+    otbMsgDevMacro(<< "Reading " << m_FileName << " from its file mapping (pixel space " << commonPixelSpace
+                   << ", line space " << commonLineSpace << ")");
+
+    const std::size_t outputLineSize = static_cast<std::size_t>(m_BytePerPixel) * m_NbBands * nbColumns;
+    std::vector<const char*> lineBands(bands.size());
+    for (int line = 0; line < nbLines; ++line)
+      {
+      const GIntBig lineOffset = static_cast<GIntBig>(firstLine + line) * commonLineSpace;
+      for (unsigned int band = 0; band < bands.size(); ++band)
+        {
+        lineBands[band] = bands[band] + lineOffset;
+        }
+      InterleaveBands(&lineBands[0], m_NbBands, commonPixelSpace, nbColumns, m_BytePerPixel,
+                      reinterpret_cast<char*>(buffer) + line * outputLineSize);
+      }
+    }
+
+  for (unsigned int i = 0; i < mappings.size(); ++i)
+    {
+    CPLVirtualMemFree(mappings[i]);
+    }
+
+  return mapped;
+#else
+  (void)buffer;
+  (void)firstColumn;
+  (void)firstLine;
+  (void)nbColumns;
+  (void)nbLines;
+  return false;
+#endif
+}
+
+namespace
+{
+
+/** Parameters of the threads of a parallel read */
+struct ParallelReadStruct
+{
+  std::vector<GDALDataset*> Datasets;
+  unsigned char*            Buffer;
+  GDALDataType              PixelType;
+  int                       NbBands;
+  int                       PixelOffset;
+  int                       LineOffset;
+  int                       BandOffset;
+  int                       FirstColumn;
+  int                       FirstLine;
+  int                       NbColumns;
+  int                       NbLines;
+  int                       BlockHeight;
+  int                       FirstBlockLine;
+  int                       NbBlockLines;
+  std::vector<std::string>  Errors;
+};
+
+ITK_THREAD_RETURN_TYPE ParallelReadCallback(void* arg)
+{
+  itk::MultiThreader::ThreadInfoStruct* info = static_cast<itk::MultiThreader::ThreadInfoStruct*>(arg);
+  ParallelReadStruct* str = static_cast<ParallelReadStruct*>(info->UserData);
+  const int threadId = info->ThreadID;
+  const int nbThreads = static_cast<int>(str->Datasets.size());
+
+  // Contiguous block lines for each thread, so that no block is decoded
+  // by two threads
+  const int beginBlockLine = str->FirstBlockLine + (threadId * str->NbBlockLines) / nbThreads;
+  const int endBlockLine = str->FirstBlockLine + ((threadId + 1) * str->NbBlockLines) / nbThreads;
+
+  const int beginLine = std::max(str->FirstLine, beginBlockLine * str->BlockHeight);
+  const int endLine = std::min(str->FirstLine + str->NbLines, endBlockLine * str->BlockHeight);
+
+  if (endLine <= beginLine)
+    {
+    return ITK_THREAD_RETURN_VALUE;
+    }
+
+  unsigned char* buffer = str->Buffer
+    + static_cast<std::ptrdiff_t>(beginLine - str->FirstLine) * str->LineOffset;
+
+  CPLErr lCrGdal = str->Datasets[threadId]->RasterIO(GF_Read,
+                                                     str->FirstColumn,
+                                                     beginLine,
+                                                     str->NbColumns,
+                                                     endLine - beginLine,
+                                                     buffer,
+                                                     str->NbColumns,
+                                                     endLine - beginLine,
+                                                     str->PixelType,
+                                                     str->NbBands,
+                                                     ITK_NULLPTR,
+                                                     str->PixelOffset,
+                                                     str->LineOffset,
+                                                     str->BandOffset);
+  if (lCrGdal == CE_Failure)
+    {
+    // The GDAL error message is local to the thread
+    str->Errors[threadId] = CPLGetLastErrorMsg();
+    if (str->Errors[threadId].empty())
+      {
+      str->Errors[threadId] = "unknown error";
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+} // end anonymous namespace
+
+bool GDALImageIO::ReadParallelRegion(unsigned char* buffer, int firstColumn, int firstLine, int nbColumns, int nbLines,
+                                     int pixelOffset, int lineOffset, int bandOffset)
+{
+  GDALDataset* dataset = m_Dataset->GetDataSet();
+
+  // Uncompressed blocks are not worth the additional handles
+  const char* compression = dataset->GetMetadataItem("COMPRESSION", "IMAGE_STRUCTURE");
+  if (!m_Dataset->IsJPEG2000() && (compression == ITK_NULLPTR || EQUAL(compression, "NONE")))
+    {
+    return false;
+    }
+
+  int blockWidth = 0;
+  int blockHeight = 0;
+  dataset->GetRasterBand(1)->GetBlockSize(&blockWidth, &blockHeight);
+  if (blockHeight <= 0)
+    {
+    return false;
+    }
+
+  const int firstBlockLine = firstLine / blockHeight;
+  const int nbBlockLines = (firstLine + nbLines - 1) / blockHeight - firstBlockLine + 1;
+
+  int nbThreads = static_cast<int>(ConfigurationManager::GetGDALReadThreads());
+  if (nbThreads == 0)
+    {
+    nbThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+    }
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads(std::min(nbThreads, nbBlockLines));
+  nbThreads = static_cast<int>(threader->GetNumberOfThreads());
+  if (nbThreads < 2)
+    {
+    return false;
+    }
+
+  // The first thread reads from m_Dataset, the others from their own
+  // handle (GDAL datasets can not be shared between threads)
+  const std::string datasetName = dataset->GetDescription();
+  while (static_cast<int>(m_ReadDatasets.size()) < nbThreads - 1)
+    {
+    GDALDatasetWrapperPointer handle = GDALDriverManagerWrapper::GetInstance().Open(datasetName);
+    if (handle.IsNull())
+      {
+      otbMsgDevMacro(<< "Can not open another handle on " << datasetName << ", reading with a single thread");
+      return false;
+      }
+    m_ReadDatasets.push_back(handle);
+    }
+
+  ParallelReadStruct str;
+  str.Datasets.push_back(dataset);
+  for (int i = 0; i < nbThreads - 1; ++i)
+    {
+    str.Datasets.push_back(m_ReadDatasets[i]->GetDataSet());
+    }
+  str.Buffer = buffer;
+  str.PixelType = m_PxType->pixType;
+  str.NbBands = m_NbBands;
+  str.PixelOffset = pixelOffset;
+  str.LineOffset = lineOffset;
+  str.BandOffset = bandOffset;
+  str.FirstColumn = firstColumn;
+  str.FirstLine = firstLine;
+  str.NbColumns = nbColumns;
+  str.NbLines = nbLines;
+  str.BlockHeight = blockHeight;
+  str.FirstBlockLine = firstBlockLine;
+  str.NbBlockLines = nbBlockLines;
+  str.Errors.resize(nbThreads);
+
+  otbMsgDevMacro(<< "Reading " << nbBlockLines << " block lines of " << m_FileName
+                 << " with " << nbThreads << " threads");
+
+  itk::TimeProbe chrono;
+  chrono.Start();
+  threader->SetSingleMethod(ParallelReadCallback, &str);
+  threader->SingleMethodExecute();
+  chrono.Stop();
+  otbMsgDevMacro(<< "Parallel RasterIO Read took " << chrono.GetTotal() << " sec")
+
+  for (int i = 0; i < nbThreads; ++i)
+    {
+    if (!str.Errors[i].empty())
+      {
+      itkExceptionMacro(<< "Error while reading image (GDAL format) '"
+        << m_FileName.c_str() << "' : " << str.Errors[i]);
+      }
+    }
+
+  return true;
+}
+
 bool GDALImageIO::GetSubDatasetInfo(std::vector<std::string> &names, std::vector<std::string> &desc)
 {
   // Note: we assume that the subdatasets are in order : SUBDATASET_ID_NAME, SUBDATASET_ID_DESC, SUBDATASET_ID+1_NAME, SUBDATASET_ID+1_DESC
@@ -621,6 +899,7 @@ void GDALImageIO::InternalReadImageInformation()
       {
       otbMsgDevMacro(<< "Reading: " << names[m_DatasetNumber]);
       m_Dataset = GDALDriverManagerWrapper::GetInstance().Open(names[m_DatasetNumber]);
+      m_ReadDatasets.clear();
       }
     else
       {
@@ -1434,7 +1713,7 @@ void GDALImageIO::Write(const void* buffer)
       itkExceptionMacro(<< "Unable to instantiate driver " << gdalDriverShortName << " to write " << m_FileName);
       }
 
-    GDALCreationOptionsType creationOptions = m_CreationOptions;
+    GDALCreationOptionsType creationOptions = GetCreationOptionsForDriver(gdalDriverShortName);
     GDALDataset* hOutputDS = driver->CreateCopy( realFileName.c_str(), m_Dataset->GetDataSet(), FALSE,
                                                  otb::ogr::StringListConverter(creationOptions).to_ogr(),
                                                  ITK_NULLPTR, ITK_NULLPTR );
@@ -1583,7 +1862,7 @@ void GDALImageIO::InternalWriteImageInformation(const void* buffer)
 
   if (m_CanStreamWrite)
     {
-    GDALCreationOptionsType creationOptions = m_CreationOptions;
+    GDALCreationOptionsType creationOptions = GetCreationOptionsForDriver(driverShortName);
 /*
     // Force tile mode for TIFF format if no creation option are given
     if( driverShortName == "GTiff"  )
@@ -2016,6 +2295,39 @@ bool GDALImageIO::CreationOptionContains(std::string partialOption) const
   return (i != m_CreationOptions.size());
 }
 
+GDALImageIO::GDALCreationOptionsType
+GDALImageIO::GetCreationOptionsForDriver(const std::string& driverShortName) const
+{
+  GDALCreationOptionsType creationOptions = m_CreationOptions;
+
+#if GDAL_VERSION_NUM >= 2010000
+  // The GTiff driver compresses the blocks with a pool of threads when
+  // asked to, which is not the case by default
+  if (driverShortName == "GTiff"
+      && CreationOptionContains("COMPRESS=")
+      && !CreationOptionContains("COMPRESS=NONE")
+      && !CreationOptionContains("NUM_THREADS="))
+    {
+    unsigned int nbThreads = ConfigurationManager::GetGDALWriteThreads();
+    if (nbThreads == 0)
+      {
+      nbThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+      }
+    if (nbThreads > 1)
+      {
+      std::ostringstream oss;
+      oss << "NUM_THREADS=" << nbThreads;
+      creationOptions.push_back(oss.str());
+      otbMsgDevMacro(<< "Compressing " << m_FileName << " with " << nbThreads << " threads");
+      }
+    }
+#else
+  (void)driverShortName;
+#endif
+
+  return creationOptions;
+}
+
 
 std::string GDALImageIO::GetGdalPixelTypeAsString() const
 {
@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbMultiImageFileWriter_h
+#define otbMultiImageFileWriter_h
+
+#include "itkProcessObject.h"
+#include "otbImageIOBase.h"
+#include "otbExtendedFilenameToWriterOptions.h"
+#include "otbPipelineMemoryPrintCalculator.h"
+
+#include "OTBImageIOExport.h"
+
+#include <vector>
+
+namespace otb
+{
+
+/** \class MultiImageFileWriter
+ *  \brief Write several images from a single streaming loop
+ *
+ *  Each image given with AddInputImage() is the end of a pipeline, and
+ *  the pipelines may share some of their filters (a reader or a costly
+ *  filter with several outputs for instance). Instead of streaming each
+ *  image on its own, this writer computes a single number of stream
+ *  divisions from the memory print of all the pipelines, and for each
+ *  division, it updates then writes a piece of every image.
+ *
+ *  The divisions are either strips or tiles. The divisions form a grid
+ *  of rows and columns (a single column for strips), and the piece of an
+ *  image covers the same fraction of its lines and columns than the
+ *  current division, whatever the image size. Images with the same
+ *  footprint therefore request the same upstream data at each division,
+ *  and a filter shared by several images is executed only once per
+ *  division. The tiles are about square on the first image.
+ *
+ *  The number of divisions is either set with
+ *  SetNumberOfDivisionsStrippedStreaming() or
+ *  SetNumberOfDivisionsTiledStreaming(), or computed from the available
+ *  RAM (SetAutomaticStrippedStreaming() or SetAutomaticTiledStreaming()).
+ *  In tiled mode, the grid may have a few more divisions than requested.
+ *  If one of the ImageIO can not stream, the whole loop falls back to a
+ *  single division.
+ *
+ *  The streaming options of the extended filenames (streaming:type,
+ *  streaming:sizemode and streaming:sizevalue) are supported, but as the
+ *  divisions are common to all the images, only the options of the first
+ *  filename setting them are used.
+ *
+ *  The box and bands options are handled for each image, as in
+ *  ImageFileWriter: only the given region and bands are written.
+ *
+ * \sa ImageFileWriter
+ *
+ * \ingroup OTBImageIO
+ */
+class OTBImageIO_EXPORT MultiImageFileWriter : public itk::ProcessObject
+{
+public:
+  /** Standard class typedefs. */
+  typedef MultiImageFileWriter          Self;
+  typedef itk::ProcessObject            Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  typedef PipelineMemoryPrintCalculator::MemoryPrintType MemoryPrintType;
+  typedef ExtendedFilenameToWriterOptions                FNameHelperType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(MultiImageFileWriter, itk::ProcessObject);
+
+  /** Add an image to write in the given (extended) filename. The image
+   * has to be an otb::Image or an otb::VectorImage. */
+  template <class TImage>
+  void AddInputImage(const TImage * image, const std::string & fileName);
+
+  /** Remove all the images to write */
+  void ClearInputImages();
+
+  /** Get the number of images to write */
+  unsigned int GetNumberOfInputImages() const;
+
+  /** Compute the number of divisions from the memory print of all the
+   * pipelines, with the given RAM (in MB). 0 means the value from the
+   * configuration. */
+  void SetAutomaticStrippedStreaming(unsigned int availableRAM = 0);
+
+  /** Use the given number of strips */
+  void SetNumberOfDivisionsStrippedStreaming(unsigned int nbDivisions);
+
+  /** Compute the number of tiles from the memory print of all the
+   * pipelines, with the given RAM (in MB). 0 means the value from the
+   * configuration. */
+  void SetAutomaticTiledStreaming(unsigned int availableRAM = 0);
+
+  /** Use at least the given number of tiles */
+  void SetNumberOfDivisionsTiledStreaming(unsigned int nbDivisions);
+
+  /** Get the number of divisions used by the last Update() */
+  unsigned int GetNumberOfDivisions() const
+  {
+    return m_NumberOfDivisionRows * m_NumberOfDivisionColumns;
+  }
+
+  /** Get the number of rows and columns of divisions used by the last
+   * Update() */
+  itkGetConstMacro(NumberOfDivisionRows, unsigned int);
+  itkGetConstMacro(NumberOfDivisionColumns, unsigned int);
+
+  /** Get the memory print (in bytes) estimated by the last Update(). It
+   * is 0 when the number of divisions is set by the user. */
+  itkGetConstMacro(MemoryPrint, MemoryPrintType);
+
+  /** Write all the images */
+  void Update() ITK_OVERRIDE;
+
+protected:
+  MultiImageFileWriter();
+  ~MultiImageFileWriter() ITK_OVERRIDE;
+  void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
+
+  /** \class SinkBase
+   *  Type-independant part of an image to write
+   *
+   * \ingroup OTBImageIO
+   */
+  class OTBImageIO_EXPORT SinkBase
+  {
+  public:
+    SinkBase(const std::string & fileName);
+    virtual ~SinkBase();
+
+    /** Create the ImageIO and update the output information of the image */
+    virtual void PrepareOutput();
+
+    /** Estimate the memory print of the pipeline ending at the image */
+    virtual MemoryPrintType EstimateMemoryPrint() = 0;
+
+    /** Write the header of the output file */
+    virtual void WriteImageInformation() = 0;
+
+    /** Update and write the division at the given row and column of
+     * the grid of divisions */
+    virtual void Write(unsigned int row, unsigned int nbRows,
+                       unsigned int column, unsigned int nbColumns) = 0;
+
+    /** Write the geom file if asked in the extended filename */
+    virtual void WriteGeometry() = 0;
+
+    /** Number of lines of the region to write */
+    virtual itk::SizeValueType GetNumberOfLines() const = 0;
+
+    /** Number of columns of the region to write */
+    virtual itk::SizeValueType GetNumberOfColumns() const = 0;
+
+    bool CanStreamWrite() const;
+
+    /** Offset of the first line (or column) of a division, so that
+     * consecutive divisions cover all the lines without overlap */
+    static itk::SizeValueType GetDivisionOffset(unsigned int division,
+                                                unsigned int nbDivisions,
+                                                itk::SizeValueType nbLines);
+
+    const std::string & GetFileName() const
+    {
+      return m_FileName;
+    }
+
+    const FNameHelperType * GetFilenameHelper() const
+    {
+      return m_FilenameHelper;
+    }
+
+  protected:
+    /** Simple filename */
+    std::string m_FileName;
+
+    FNameHelperType::Pointer m_FilenameHelper;
+
+    ImageIOBase::Pointer m_ImageIO;
+
+  private:
+    SinkBase(const SinkBase &); //purposely not implemented
+    void operator =(const SinkBase&); //purposely not implemented
+  };
+
+  /** \class Sink
+   *  Image to write
+   *
+   * \ingroup OTBImageIO
+   */
+  template <class TImage>
+  class Sink : public SinkBase
+  {
+  public:
+    Sink(const TImage * image, const std::string & fileName);
+    ~Sink() ITK_OVERRIDE {}
+
+    void PrepareOutput() ITK_OVERRIDE;
+    MemoryPrintType EstimateMemoryPrint() ITK_OVERRIDE;
+    void WriteImageInformation() ITK_OVERRIDE;
+    void Write(unsigned int row, unsigned int nbRows,
+               unsigned int column, unsigned int nbColumns) ITK_OVERRIDE;
+    void WriteGeometry() ITK_OVERRIDE;
+    itk::SizeValueType GetNumberOfLines() const ITK_OVERRIDE;
+    itk::SizeValueType GetNumberOfColumns() const ITK_OVERRIDE;
+
+  private:
+    typename TImage::Pointer     m_Image;
+
+    /** Region to write: the largest possible region, or the box of the
+     * extended filename */
+    typename TImage::RegionType  m_Region;
+
+    /** Bands to write (zero-based), empty to write all of them */
+    std::vector<unsigned int>    m_BandList;
+  };
+
+  typedef std::vector<SinkBase *> SinkListType;
+
+private:
+  MultiImageFileWriter(const MultiImageFileWriter &); //purposely not implemented
+  void operator =(const MultiImageFileWriter&); //purposely not implemented
+
+  /** Override the number of divisions, the RAM and the tiled mode with
+   * the streaming options of the extended filenames, if any. Returns true
+   * if an extended filename sets the streaming type. */
+  bool ApplyStreamingOptions(unsigned int & nbDivisions, unsigned int & availableRAM, bool & tiled) const;
+
+  /** Set the grid of divisions, with at least nbDivisions divisions */
+  void ComputeDivisionGrid(unsigned int nbDivisions, bool tiled);
+
+  SinkListType    m_SinkList;
+
+  unsigned int    m_AvailableRAM;
+  unsigned int    m_RequestedNumberOfDivisions;
+  bool            m_TiledStreaming;
+  unsigned int    m_NumberOfDivisionRows;
+  unsigned int    m_NumberOfDivisionColumns;
+  MemoryPrintType m_MemoryPrint;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbMultiImageFileWriter.txx"
+#endif
+
+#endif
@@ -0,0 +1,314 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbMultiImageFileWriter_txx
+#define otbMultiImageFileWriter_txx
+
+#include "otbMultiImageFileWriter.h"
+#include "otbImageKeywordlist.h"
+#include "otbMetaDataKey.h"
+#include "otbStringUtils.h"
+#include "itkDefaultConvertPixelTraits.h"
+#include "itkExtractImageFilter.h"
+#include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkMetaDataObject.h"
+
+#include <cstring>
+
+namespace otb
+{
+
+template <class TImage>
+void
+MultiImageFileWriter
+::AddInputImage(const TImage * image, const std::string & fileName)
+{
+  if (image == ITK_NULLPTR)
+    {
+    itkExceptionMacro(<< "Can not write a null image in " << fileName);
+    }
+  m_SinkList.push_back(new Sink<TImage>(image, fileName));
+  // Also keep the image as an input, so that the pipeline can be traced
+  // back from the writer (memory print, profiling)
+  this->SetNthInput(this->GetNumberOfIndexedInputs(), const_cast<TImage *>(image));
+  this->Modified();
+}
+
+template <class TImage>
+MultiImageFileWriter::Sink<TImage>
+::Sink(const TImage * image, const std::string & fileName)
+  : SinkBase(fileName),
+    m_Image(const_cast<TImage *>(image))
+{
+}
+
+template <class TImage>
+void
+MultiImageFileWriter::Sink<TImage>
+::PrepareOutput()
+{
+  SinkBase::PrepareOutput();
+
+  m_Image->UpdateOutputInformation();
+  m_Region = m_Image->GetLargestPossibleRegion();
+
+  if (m_FilenameHelper->BoxIsSet())
+    {
+    std::vector<int> boxVector;
+    Utils::ConvertStringToVector(m_FilenameHelper->GetBox(), boxVector, "ExtendedFileName:box", ":");
+
+    typename TImage::IndexType start;
+    typename TImage::SizeType  size;
+    start[0] = boxVector[0];  // first index on X
+    start[1] = boxVector[1];  // first index on Y
+    size[0]  = boxVector[2];  // size along X
+    size[1]  = boxVector[3];  // size along Y
+    m_Region.SetIndex(start);
+    m_Region.SetSize(size);
+
+    if (!m_Region.Crop(m_Image->GetLargestPossibleRegion()))
+      {
+      itk::InvalidRequestedRegionError e(__FILE__, __LINE__);
+      e.SetLocation(ITK_LOCATION);
+      e.SetDescription("Requested box region is (at least partially) outside the largest possible region.");
+      e.SetDataObject(m_Image);
+      throw e;
+      }
+    }
+
+  m_BandList.clear();
+  if (m_FilenameHelper->BandRangeIsSet() && strcmp(m_Image->GetNameOfClass(), "VectorImage") == 0)
+    {
+    const unsigned int nbComponents = m_Image->GetNumberOfComponentsPerPixel();
+    if (!m_FilenameHelper->ResolveBandRange(m_FilenameHelper->GetBandRange(), nbComponents, m_BandList)
+        || m_BandList.empty())
+      {
+      itkGenericExceptionMacro("The given band range is either empty or invalid for a " << nbComponents
+                               << " bands input image!");
+      }
+    }
+}
+
+template <class TImage>
+MultiImageFileWriter::MemoryPrintType
+MultiImageFileWriter::Sink<TImage>
+::EstimateMemoryPrint()
+{
+  typedef itk::ExtractImageFilter<TImage, TImage> ExtractFilterType;
+
+  PipelineMemoryPrintCalculator::Pointer calculator = PipelineMemoryPrintCalculator::New();
+
+  // Same trick as in StreamingManager: run the estimation on a small
+  // region around the image center, and scale the result, to avoid a
+  // dry run of the pipeline on the whole image
+  typename TImage::SizeType  smallSize;
+  typename TImage::IndexType smallIndex;
+  smallSize.Fill(100);
+  for (unsigned int i = 0; i < TImage::ImageDimension; ++i)
+    {
+    smallIndex[i] = m_Region.GetIndex(i)
+      + static_cast<itk::IndexValueType>(m_Region.GetSize(i) / 2) - 50;
+    }
+  typename TImage::RegionType smallRegion(smallIndex, smallSize);
+
+  if (smallRegion.Crop(m_Region))
+    {
+    typename ExtractFilterType::Pointer extractFilter = ExtractFilterType::New();
+    extractFilter->SetInput(m_Image);
+    extractFilter->SetExtractionRegion(smallRegion);
+
+    calculator->SetDataToWrite(extractFilter->GetOutput());
+    calculator->Compute();
+
+    // Remove the contribution of the extract filter
+    MemoryPrintType print = calculator->GetMemoryPrint()
+      - calculator->EvaluateDataObjectPrint(extractFilter->GetOutput());
+
+    return static_cast<MemoryPrintType>(print
+      * static_cast<double>(m_Region.GetNumberOfPixels())
+      / static_cast<double>(smallRegion.GetNumberOfPixels()));
+    }
+
+  calculator->SetDataToWrite(m_Image);
+  calculator->Compute();
+  return calculator->GetMemoryPrint();
+}
+
+template <class TImage>
+void
+MultiImageFileWriter::Sink<TImage>
+::WriteImageInformation()
+{
+  const typename TImage::SpacingType&   spacing = m_Image->GetSpacing();
+  const typename TImage::PointType&     origin = m_Image->GetOrigin();
+  const typename TImage::DirectionType& direction = m_Image->GetDirection();
+
+  m_ImageIO->SetNumberOfDimensions(TImage::ImageDimension);
+  for (unsigned int i = 0; i < TImage::ImageDimension; ++i)
+    {
+    m_ImageIO->SetDimensions(i, m_Region.GetSize(i));
+    m_ImageIO->SetSpacing(i, spacing[i]);
+    m_ImageIO->SetOrigin(i, origin[i] + static_cast<double>(m_Region.GetIndex(i)) * spacing[i]);
+
+    // Direction cosines are stored as columns of the direction matrix
+    vnl_vector<double> axisDirection(TImage::ImageDimension);
+    for (unsigned int j = 0; j < TImage::ImageDimension; ++j)
+      {
+      axisDirection[j] = direction[j][i];
+      }
+    m_ImageIO->SetDirection(i, axisDirection);
+    }
+
+  if (strcmp(m_Image->GetNameOfClass(), "VectorImage") == 0)
+    {
+    m_ImageIO->SetPixelTypeInfo(typeid(typename TImage::InternalPixelType));
+    m_ImageIO->SetNumberOfComponents(m_BandList.empty() ? m_Image->GetNumberOfComponentsPerPixel()
+                                     : m_BandList.size());
+    }
+  else
+    {
+    m_ImageIO->SetPixelTypeInfo(typeid(typename TImage::PixelType));
+    }
+
+  m_ImageIO->SetMetaDataDictionary(m_Image->GetMetaDataDictionary());
+  m_ImageIO->SetFileName(m_FileName.c_str());
+  m_ImageIO->WriteImageInformation();
+}
+
+template <class TImage>
+void
+MultiImageFileWriter::Sink<TImage>
+::Write(unsigned int row, unsigned int nbRows, unsigned int column, unsigned int nbColumns)
+{
+  const unsigned int lastDim = TImage::ImageDimension - 1;
+  const itk::SizeValueType nbLines = m_Region.GetSize(lastDim);
+  const itk::SizeValueType nbImageColumns = m_Region.GetSize(0);
+
+  const itk::SizeValueType begin = GetDivisionOffset(row, nbRows, nbLines);
+  const itk::SizeValueType end = GetDivisionOffset(row + 1, nbRows, nbLines);
+  const itk::SizeValueType columnBegin = GetDivisionOffset(column, nbColumns, nbImageColumns);
+  const itk::SizeValueType columnEnd = GetDivisionOffset(column + 1, nbColumns, nbImageColumns);
+
+  // More divisions than lines or columns: nothing to write for this one
+  if (end <= begin || columnEnd <= columnBegin)
+    {
+    return;
+    }
+
+  typename TImage::RegionType streamRegion = m_Region;
+  streamRegion.SetIndex(lastDim, m_Region.GetIndex(lastDim) + static_cast<itk::IndexValueType>(begin));
+  streamRegion.SetSize(lastDim, end - begin);
+  streamRegion.SetIndex(0, m_Region.GetIndex(0) + static_cast<itk::IndexValueType>(columnBegin));
+  streamRegion.SetSize(0, columnEnd - columnBegin);
+
+  m_Image->SetRequestedRegion(streamRegion);
+  m_Image->PropagateRequestedRegion();
+  m_Image->UpdateOutputData();
+
+  itk::ImageIORegion ioRegion(TImage::ImageDimension);
+  for (unsigned int i = 0; i < TImage::ImageDimension; ++i)
+    {
+    ioRegion.SetSize(i, streamRegion.GetSize(i));
+    ioRegion.SetIndex(i, streamRegion.GetIndex(i) - m_Region.GetIndex(i));
+    }
+  m_ImageIO->SetIORegion(ioRegion);
+
+  const void* dataPtr = static_cast<const void*>(m_Image->GetBufferPointer());
+
+  // Selected bands are copied in their own buffer: the image buffer may
+  // be shared with other outputs and is never remapped in place
+  typedef itk::DefaultConvertPixelTraits<typename TImage::PixelType> PixelTraitsType;
+  typedef typename PixelTraitsType::ComponentType                    ComponentType;
+  std::vector<ComponentType> bandBuffer;
+
+  // The upstream filter may have produced more than requested
+  typename TImage::Pointer cacheImage;
+  if (!m_BandList.empty())
+    {
+    const unsigned int nbBands = m_BandList.size();
+    bandBuffer.resize(streamRegion.GetNumberOfPixels() * nbBands);
+
+    itk::ImageRegionConstIterator<TImage> inIt(m_Image, streamRegion);
+    typename std::vector<ComponentType>::iterator outIt = bandBuffer.begin();
+    for (inIt.GoToBegin(); !inIt.IsAtEnd(); ++inIt)
+      {
+      const typename TImage::PixelType pixel = inIt.Get();
+      for (unsigned int b = 0; b < nbBands; ++b, ++outIt)
+        {
+        *outIt = PixelTraitsType::GetNthComponent(m_BandList[b], pixel);
+        }
+      }
+
+    dataPtr = static_cast<const void*>(&bandBuffer[0]);
+    }
+  else if (m_Image->GetBufferedRegion() != streamRegion)
+    {
+    cacheImage = TImage::New();
+    cacheImage->CopyInformation(m_Image);
+    cacheImage->SetBufferedRegion(streamRegion);
+    cacheImage->Allocate();
+
+    itk::ImageRegionConstIterator<TImage> inIt(m_Image, streamRegion);
+    itk::ImageRegionIterator<TImage>      outIt(cacheImage, streamRegion);
+    for (inIt.GoToBegin(), outIt.GoToBegin(); !inIt.IsAtEnd(); ++inIt, ++outIt)
+      {
+      outIt.Set(inIt.Get());
+      }
+
+    dataPtr = static_cast<const void*>(cacheImage->GetBufferPointer());
+    }
+
+  m_ImageIO->Write(dataPtr);
+}
+
+template <class TImage>
+itk::SizeValueType
+MultiImageFileWriter::Sink<TImage>
+::GetNumberOfLines() const
+{
+  return m_Region.GetSize(TImage::ImageDimension - 1);
+}
+
+template <class TImage>
+itk::SizeValueType
+MultiImageFileWriter::Sink<TImage>
+::GetNumberOfColumns() const
+{
+  return m_Region.GetSize(0);
+}
+
+template <class TImage>
+void
+MultiImageFileWriter::Sink<TImage>
+::WriteGeometry()
+{
+  if (m_FilenameHelper->GetWriteGEOMFile())
+    {
+    ImageKeywordlist otb_kwl;
+    itk::MetaDataDictionary dict = m_Image->GetMetaDataDictionary();
+    itk::ExposeMetaData<ImageKeywordlist>(dict, MetaDataKey::OSSIMKeywordlistKey, otb_kwl);
+    otb::WriteGeometry(otb_kwl, m_FileName);
+    }
+}
+
+} // end namespace otb
+
+#endif
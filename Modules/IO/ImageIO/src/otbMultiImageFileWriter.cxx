@@ -0,0 +1,372 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbMultiImageFileWriter.h"
+#include "otbImageIOFactory.h"
+#include "otbGDALImageIO.h"
+#include "otbConfigurationManager.h"
+#include "otbMacro.h"
+#include "otbMath.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace otb
+{
+
+MultiImageFileWriter::SinkBase
+::SinkBase(const std::string & fileName)
+  : m_FilenameHelper(FNameHelperType::New())
+{
+  m_FilenameHelper->SetExtendedFileName(fileName.c_str());
+  m_FileName = m_FilenameHelper->GetSimpleFileName();
+}
+
+MultiImageFileWriter::SinkBase
+::~SinkBase()
+{
+}
+
+void
+MultiImageFileWriter::SinkBase
+::PrepareOutput()
+{
+  if (m_FileName.empty())
+    {
+    itkGenericExceptionMacro(<< "No filename was specified");
+    }
+
+  m_ImageIO = ImageIOFactory::CreateImageIO(m_FileName.c_str(),
+                                            ImageIOFactory::WriteMode);
+  if (m_ImageIO.IsNull())
+    {
+    itkGenericExceptionMacro(<< "Could not create IO object for file " << m_FileName);
+    }
+
+  if (strcmp(m_ImageIO->GetNameOfClass(), "GDALImageIO") == 0
+      && (m_FilenameHelper->gdalCreationOptionsIsSet() || m_FilenameHelper->WriteRPCTagsIsSet()))
+    {
+    GDALImageIO* imageIO = dynamic_cast<GDALImageIO*>(m_ImageIO.GetPointer());
+    if (imageIO)
+      {
+      imageIO->SetOptions(m_FilenameHelper->GetgdalCreationOptions());
+      imageIO->SetWriteRPCTags(m_FilenameHelper->GetWriteRPCTags());
+      }
+    }
+}
+
+bool
+MultiImageFileWriter::SinkBase
+::CanStreamWrite() const
+{
+  return m_ImageIO.IsNotNull() && m_ImageIO->CanStreamWrite();
+}
+
+itk::SizeValueType
+MultiImageFileWriter::SinkBase
+::GetDivisionOffset(unsigned int division, unsigned int nbDivisions, itk::SizeValueType nbLines)
+{
+  if (division >= nbDivisions)
+    {
+    return nbLines;
+    }
+  return static_cast<itk::SizeValueType>(
+    vcl_floor(static_cast<double>(division) * static_cast<double>(nbLines)
+              / static_cast<double>(nbDivisions)));
+}
+
+MultiImageFileWriter
+::MultiImageFileWriter()
+  : m_AvailableRAM(0),
+    m_RequestedNumberOfDivisions(0),
+    m_TiledStreaming(false),
+    m_NumberOfDivisionRows(0),
+    m_NumberOfDivisionColumns(0),
+    m_MemoryPrint(0)
+{
+  // The writer has no output
+  this->SetNumberOfRequiredOutputs(0);
+}
+
+MultiImageFileWriter
+::~MultiImageFileWriter()
+{
+  this->ClearInputImages();
+}
+
+void
+MultiImageFileWriter
+::ClearInputImages()
+{
+  for (SinkListType::iterator it = m_SinkList.begin(); it != m_SinkList.end(); ++it)
+    {
+    delete *it;
+    }
+  m_SinkList.clear();
+  this->SetNumberOfIndexedInputs(0);
+  this->Modified();
+}
+
+unsigned int
+MultiImageFileWriter
+::GetNumberOfInputImages() const
+{
+  return m_SinkList.size();
+}
+
+void
+MultiImageFileWriter
+::SetAutomaticStrippedStreaming(unsigned int availableRAM)
+{
+  m_AvailableRAM = availableRAM;
+  m_RequestedNumberOfDivisions = 0;
+  m_TiledStreaming = false;
+  this->Modified();
+}
+
+void
+MultiImageFileWriter
+::SetNumberOfDivisionsStrippedStreaming(unsigned int nbDivisions)
+{
+  m_RequestedNumberOfDivisions = nbDivisions;
+  m_TiledStreaming = false;
+  this->Modified();
+}
+
+void
+MultiImageFileWriter
+::SetAutomaticTiledStreaming(unsigned int availableRAM)
+{
+  m_AvailableRAM = availableRAM;
+  m_RequestedNumberOfDivisions = 0;
+  m_TiledStreaming = true;
+  this->Modified();
+}
+
+void
+MultiImageFileWriter
+::SetNumberOfDivisionsTiledStreaming(unsigned int nbDivisions)
+{
+  m_RequestedNumberOfDivisions = nbDivisions;
+  m_TiledStreaming = true;
+  this->Modified();
+}
+
+void
+MultiImageFileWriter
+::ComputeDivisionGrid(unsigned int nbDivisions, bool tiled)
+{
+  nbDivisions = std::max(nbDivisions, 1U);
+  if (!tiled || nbDivisions == 1)
+    {
+    m_NumberOfDivisionRows = nbDivisions;
+    m_NumberOfDivisionColumns = 1;
+    return;
+    }
+
+  // About square tiles on the first image
+  const double nbLines = std::max(static_cast<double>(m_SinkList.front()->GetNumberOfLines()), 1.);
+  const double nbColumns = std::max(static_cast<double>(m_SinkList.front()->GetNumberOfColumns()), 1.);
+  const double columns = vcl_floor(vcl_sqrt(nbDivisions * nbColumns / nbLines) + 0.5);
+  m_NumberOfDivisionColumns = static_cast<unsigned int>(std::min(std::max(columns, 1.),
+                                                                 static_cast<double>(nbDivisions)));
+  m_NumberOfDivisionRows = (nbDivisions + m_NumberOfDivisionColumns - 1) / m_NumberOfDivisionColumns;
+}
+
+void
+MultiImageFileWriter
+::Update()
+{
+  if (m_SinkList.empty())
+    {
+    itkExceptionMacro(<< "No input to writer");
+    }
+
+  this->SetAbortGenerateData(0);
+  this->SetProgress(0.0);
+  this->InvokeEvent(itk::StartEvent());
+
+  bool canStreamWrite = true;
+  for (SinkListType::iterator it = m_SinkList.begin(); it != m_SinkList.end(); ++it)
+    {
+    (*it)->PrepareOutput();
+    if (!(*it)->CanStreamWrite())
+      {
+      otbMsgDevMacro(<< "The ImageIO for " << (*it)->GetFileName() << " does not support streaming");
+      canStreamWrite = false;
+      }
+    }
+
+  unsigned int requestedNumberOfDivisions = m_RequestedNumberOfDivisions;
+  unsigned int availableRAM = m_AvailableRAM;
+  bool         tiled = m_TiledStreaming;
+  this->ApplyStreamingOptions(requestedNumberOfDivisions, availableRAM, tiled);
+
+  m_MemoryPrint = 0;
+  // A single division if one of the images can not be streamed
+  unsigned int nbDivisions = 1;
+  if (canStreamWrite && requestedNumberOfDivisions > 0)
+    {
+    nbDivisions = requestedNumberOfDivisions;
+    }
+  else if (canStreamWrite)
+    {
+    for (SinkListType::iterator it = m_SinkList.begin(); it != m_SinkList.end(); ++it)
+      {
+      m_MemoryPrint += (*it)->EstimateMemoryPrint();
+      }
+
+    MemoryPrintType availableRAMInBytes = availableRAM;
+    if (availableRAMInBytes == 0)
+      {
+      availableRAMInBytes = ConfigurationManager::GetMaxRAMHint();
+      }
+    availableRAMInBytes *= 1024 * 1024;
+
+    nbDivisions = static_cast<unsigned int>(
+      PipelineMemoryPrintCalculator::EstimateOptimalNumberOfStreamDivisions(m_MemoryPrint, availableRAMInBytes));
+    }
+  this->ComputeDivisionGrid(nbDivisions, tiled && canStreamWrite);
+
+  otbMsgDevMacro(<< "Writing " << m_SinkList.size() << " images in "
+                 << m_NumberOfDivisionRows << " x " << m_NumberOfDivisionColumns
+                 << " divisions (estimated memory print: "
+                 << m_MemoryPrint * PipelineMemoryPrintCalculator::ByteToMegabyte << " MB)");
+
+  for (SinkListType::iterator it = m_SinkList.begin(); it != m_SinkList.end(); ++it)
+    {
+    (*it)->WriteImageInformation();
+    }
+
+  const unsigned int nbTotalDivisions = this->GetNumberOfDivisions();
+  for (unsigned int division = 0;
+       division < nbTotalDivisions && !this->GetAbortGenerateData();
+       ++division)
+    {
+    const unsigned int row = division / m_NumberOfDivisionColumns;
+    const unsigned int column = division % m_NumberOfDivisionColumns;
+    for (SinkListType::iterator it = m_SinkList.begin(); it != m_SinkList.end(); ++it)
+      {
+      (*it)->Write(row, m_NumberOfDivisionRows, column, m_NumberOfDivisionColumns);
+      }
+    this->UpdateProgress(static_cast<float>(division + 1) / nbTotalDivisions);
+    }
+
+  for (SinkListType::iterator it = m_SinkList.begin(); it != m_SinkList.end(); ++it)
+    {
+    (*it)->WriteGeometry();
+    }
+
+  this->InvokeEvent(itk::EndEvent());
+}
+
+bool
+MultiImageFileWriter
+::ApplyStreamingOptions(unsigned int & nbDivisions, unsigned int & availableRAM, bool & tiled) const
+{
+  const SinkBase * selected = ITK_NULLPTR;
+  for (SinkListType::const_iterator it = m_SinkList.begin(); it != m_SinkList.end(); ++it)
+    {
+    if (!(*it)->GetFilenameHelper()->StreamingTypeIsSet())
+      {
+      continue;
+      }
+    if (selected == ITK_NULLPTR)
+      {
+      selected = *it;
+      }
+    else
+      {
+      itkWarningMacro(<< "Streaming options of " << (*it)->GetFileName()
+                      << " are ignored, the ones of " << selected->GetFileName() << " are used for all the images.");
+      }
+    }
+
+  if (selected == ITK_NULLPTR)
+    {
+    return false;
+    }
+
+  itkWarningMacro(<<"Streaming configuration through extended filename is used. Any previous streaming configuration (ram value, streaming mode ...) will be ignored.");
+
+  const FNameHelperType * helper = selected->GetFilenameHelper();
+  const std::string type = helper->GetStreamingType();
+  const std::string sizemode = helper->StreamingSizeModeIsSet() ? helper->GetStreamingSizeMode() : "auto";
+  const double sizevalue = helper->StreamingSizeValueIsSet() ? helper->GetStreamingSizeValue() : 0.;
+
+  if (type == "tiled" || type == "stripped")
+    {
+    tiled = (type == "tiled");
+    }
+
+  if (type == "none")
+    {
+    nbDivisions = 1;
+    }
+  else if (type == "auto" || sizemode == "auto")
+    {
+    // RAM driven, 0 means the value from the configuration
+    nbDivisions = 0;
+    availableRAM = static_cast<unsigned int>(sizevalue);
+    }
+  else if (sizemode == "nbsplits")
+    {
+    nbDivisions = std::max(static_cast<unsigned int>(sizevalue), 1U);
+    }
+  else if (sizemode == "height")
+    {
+    // Strips of the requested height, or tiles of the requested
+    // dimension, on the selected image
+    const itk::SizeValueType height = std::max(static_cast<itk::SizeValueType>(sizevalue),
+                                               static_cast<itk::SizeValueType>(1));
+    const itk::SizeValueType nbLines = selected->GetNumberOfLines();
+    itk::SizeValueType nbPieces = (nbLines + height - 1) / height;
+    if (tiled)
+      {
+      nbPieces *= (selected->GetNumberOfColumns() + height - 1) / height;
+      }
+    nbDivisions = static_cast<unsigned int>(std::max(nbPieces, static_cast<itk::SizeValueType>(1)));
+    }
+  else
+    {
+    itkWarningMacro(<< "Unknown streaming sizemode " << sizemode << ", it will be ignored.");
+    }
+
+  return true;
+}
+
+void
+MultiImageFileWriter
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Number of images: " << m_SinkList.size() << std::endl;
+  for (SinkListType::const_iterator it = m_SinkList.begin(); it != m_SinkList.end(); ++it)
+    {
+    os << indent.GetNextIndent() << (*it)->GetFileName() << std::endl;
+    }
+  os << indent << "Available RAM: " << m_AvailableRAM << " MB" << std::endl;
+  os << indent << "Requested number of divisions: " << m_RequestedNumberOfDivisions << std::endl;
+  os << indent << "Tiled streaming: " << m_TiledStreaming << std::endl;
+  os << indent << "Number of divisions: " << m_NumberOfDivisionRows << " x "
+     << m_NumberOfDivisionColumns << std::endl;
+}
+
+} // end namespace otb
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#include "otbVectorImage.h"
+#include "otbImageFileReader.h"
+#include "otbMultiImageFileWriter.h"
+#include "itkCommand.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace
+{
+void CountReaderExecutions(itk::Object * itkNotUsed(caller),
+                           const itk::EventObject & itkNotUsed(event),
+                           void * clientData)
+{
+  ++(*static_cast<unsigned int *>(clientData));
+}
+}
+
+int otbMultiImageFileWriterTest(int argc, char* argv[])
+{
+  const char * inputFilename   = argv[1];
+  const char * outputFilename1 = argv[2];
+  const char * outputFilename2 = argv[3];
+  const unsigned int nbDivisions = atoi(argv[4]);
+  // Optional expected number of divisions, when it comes from the
+  // extended filenames
+  const unsigned int expectedNbDivisions = (argc > 5 && atoi(argv[5]) > 0) ? atoi(argv[5]) : nbDivisions;
+  // Optional streaming mode, tiled or stripped (the default)
+  const bool tiled = (argc > 6) && std::string(argv[6]) == "tiled";
+
+  typedef otb::VectorImage<unsigned short, 2>  ImageType;
+  typedef otb::ImageFileReader<ImageType>      ReaderType;
+  typedef otb::MultiImageFileWriter            WriterType;
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(inputFilename);
+
+  unsigned int nbReaderExecutions = 0;
+  itk::CStyleCommand::Pointer command = itk::CStyleCommand::New();
+  command->SetCallback(&CountReaderExecutions);
+  command->SetClientData(&nbReaderExecutions);
+  reader->AddObserver(itk::StartEvent(), command);
+
+  // Both outputs share the reader
+  WriterType::Pointer writer = WriterType::New();
+  writer->AddInputImage(reader->GetOutput(), outputFilename1);
+  writer->AddInputImage(reader->GetOutput(), outputFilename2);
+  if (nbDivisions > 0 && tiled)
+    {
+    writer->SetNumberOfDivisionsTiledStreaming(nbDivisions);
+    }
+  else if (nbDivisions > 0)
+    {
+    writer->SetNumberOfDivisionsStrippedStreaming(nbDivisions);
+    }
+  writer->Update();
+
+  std::cout << "Number of divisions: " << writer->GetNumberOfDivisionRows()
+            << " x " << writer->GetNumberOfDivisionColumns() << std::endl;
+  std::cout << "Number of reader executions: " << nbReaderExecutions << std::endl;
+
+  // The tile grid may have a few more divisions than requested
+  if (tiled && (writer->GetNumberOfDivisions() < expectedNbDivisions
+                || writer->GetNumberOfDivisionColumns() < 2))
+    {
+    std::cerr << "Expected at least " << expectedNbDivisions << " tiles on several columns, got "
+              << writer->GetNumberOfDivisionRows() << " x " << writer->GetNumberOfDivisionColumns() << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (!tiled && writer->GetNumberOfDivisions() != expectedNbDivisions)
+    {
+    std::cerr << "Expected " << expectedNbDivisions << " divisions, got "
+              << writer->GetNumberOfDivisions() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The shared reader has to be executed once per division, not once
+  // per division and per output
+  if (nbReaderExecutions != writer->GetNumberOfDivisions())
+    {
+    std::cerr << "The reader was executed " << nbReaderExecutions
+              << " times for " << writer->GetNumberOfDivisions() << " divisions" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
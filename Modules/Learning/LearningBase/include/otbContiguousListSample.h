@@ -0,0 +1,274 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbContiguousListSample_h
+#define otbContiguousListSample_h
+
+#include "itkDataObject.h"
+#include "itkObjectFactory.h"
+#include "itkVariableLengthVector.h"
+#include "itkIntTypes.h"
+
+#include "otbMappedFile.h"
+
+#include <vector>
+#include <string>
+
+namespace otb
+{
+namespace Statistics
+{
+
+/** \class ContiguousListSample
+ * \brief List of samples stored in a single contiguous buffer
+ *
+ * itk::Statistics::ListSample keeps one VariableLengthVector per sample,
+ * so that each sample is a separate heap allocation. This class stores
+ * all the measurements in a single buffer, one sample after the other:
+ * the component j of the sample i is at offset
+ * i * GetMeasurementVectorSize() + j of GetBufferPointer(). The buffer
+ * can be given as is to the learning libraries expecting a dense row
+ * major matrix (see the zero-copy ListSampleToMat() of OpenCVUtils).
+ *
+ * The samples can be saved in a raw binary file with Save(), and loaded
+ * back with Load(). Load() maps the file in memory when possible: the
+ * samples are then read by the system on demand, and the list does not
+ * need to fit in RAM. A mapped list is read-only.
+ *
+ * The binary file starts with a 32 bytes header (magic string, version,
+ * value type, measurement vector size and number of samples) followed by
+ * the samples. It is written with the byte order of the host.
+ *
+ * The class offers the read interface of itk::Statistics::ListSample
+ * (Size(), GetMeasurementVectorSize(), GetMeasurementVector(), Begin()
+ * and End()), so that the code templated on the list type accepts both.
+ * It is not an itk::Statistics::Sample though: GetMeasurementVector()
+ * returns a copy of the sample, and is therefore safe to call from
+ * several threads. GetMeasurementVectorPointer() gives access to the
+ * measurements without copy.
+ *
+ * MachineLearningModel::SetInputContiguousListSample() trains the models
+ * on such a list.
+ *
+ * \sa itk::Statistics::ListSample
+ *
+ * \ingroup OTBLearningBase
+ */
+template <class TValue = float>
+class ITK_EXPORT ContiguousListSample : public itk::DataObject
+{
+public:
+  /** Standard class typedefs */
+  typedef ContiguousListSample          Self;
+  typedef itk::DataObject               Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Standard macros */
+  itkNewMacro(Self);
+  itkTypeMacro(ContiguousListSample, DataObject);
+
+  typedef TValue                                 ValueType;
+  typedef TValue                                 MeasurementType;
+  typedef itk::VariableLengthVector<TValue>      MeasurementVectorType;
+  typedef unsigned int                           MeasurementVectorSizeType;
+  typedef itk::IdentifierType                    InstanceIdentifier;
+
+  /** Size of the header of the binary files, in bytes */
+  itkStaticConstMacro(HeaderSize, unsigned int, 32);
+
+  /** Version of the format of the binary files */
+  itkStaticConstMacro(FileVersion, unsigned int, 1);
+
+  /** Set the size of the measurement vectors. The list must be empty. */
+  void SetMeasurementVectorSize(MeasurementVectorSizeType s);
+
+  /** Get the size of the measurement vectors */
+  MeasurementVectorSizeType GetMeasurementVectorSize() const
+  {
+    return m_MeasurementVectorSize;
+  }
+
+  /** Number of samples */
+  InstanceIdentifier Size() const
+  {
+    return m_Size;
+  }
+
+  /** Get a copy of the sample with the given identifier */
+  MeasurementVectorType GetMeasurementVector(InstanceIdentifier id) const;
+
+  /** Get the address of the first measurement of the given sample */
+  const ValueType * GetMeasurementVectorPointer(InstanceIdentifier id) const
+  {
+    return m_Data + id * m_MeasurementVectorSize;
+  }
+
+  /** Get the address of the whole buffer */
+  const ValueType * GetBufferPointer() const
+  {
+    return m_Data;
+  }
+
+  /** Allocate the buffer for the given number of samples */
+  void Reserve(InstanceIdentifier n);
+
+  /** Set the number of samples. New samples are set to zero. */
+  void Resize(InstanceIdentifier n);
+
+  /** Remove all the samples */
+  void Clear();
+
+  /** Add a sample at the end of the list */
+  void PushBack(const MeasurementVectorType & mv);
+
+  /** Add a sample given by the address of its measurements */
+  void PushBack(const ValueType * mv);
+
+  /** Set the component dim of the sample id */
+  void SetMeasurement(InstanceIdentifier id, unsigned int dim, const MeasurementType & value);
+
+  /** Set the sample id */
+  void SetMeasurementVector(InstanceIdentifier id, const MeasurementVectorType & mv);
+
+  /** Copy the samples of another list of samples (a ListSample for
+   * instance), using its measurement vector size. */
+  template <class TSample>
+  void CopyFrom(const TSample * sample);
+
+  /** Write the samples in a binary file */
+  void Save(const std::string & filename) const;
+
+  /** Load the samples from a binary file written by Save(). The file is
+   * mapped in memory if possible, and read otherwise. */
+  void Load(const std::string & filename);
+
+  /** Is the buffer a (read-only) mapping of a file ? */
+  bool IsMapped() const
+  {
+    return m_MappedFile.IsOpen();
+  }
+
+  /** \class ConstIterator
+   * \brief Iterator over the samples of a ContiguousListSample
+   *
+   * \ingroup OTBLearningBase
+   */
+  class ConstIterator
+  {
+    friend class ContiguousListSample;
+
+  public:
+    ConstIterator(const ContiguousListSample * sample)
+      : m_Sample(sample), m_Id(0)
+    {
+    }
+
+    /** Get a copy of the current sample */
+    MeasurementVectorType GetMeasurementVector() const
+    {
+      return m_Sample->GetMeasurementVector(m_Id);
+    }
+
+    /** Get the address of the measurements of the current sample */
+    const ValueType * GetMeasurementVectorPointer() const
+    {
+      return m_Sample->GetMeasurementVectorPointer(m_Id);
+    }
+
+    InstanceIdentifier GetInstanceIdentifier() const
+    {
+      return m_Id;
+    }
+
+    ConstIterator & operator++()
+    {
+      ++m_Id;
+      return *this;
+    }
+
+    bool operator!=(const ConstIterator & it) const
+    {
+      return m_Id != it.m_Id;
+    }
+
+    bool operator==(const ConstIterator & it) const
+    {
+      return m_Id == it.m_Id;
+    }
+
+  protected:
+    ConstIterator(const ContiguousListSample * sample, InstanceIdentifier id)
+      : m_Sample(sample), m_Id(id)
+    {
+    }
+
+  private:
+    const ContiguousListSample * m_Sample;
+    InstanceIdentifier           m_Id;
+  };
+
+  ConstIterator Begin() const
+  {
+    return ConstIterator(this, 0);
+  }
+
+  ConstIterator End() const
+  {
+    return ConstIterator(this, m_Size);
+  }
+
+protected:
+  ContiguousListSample();
+  ~ContiguousListSample() ITK_OVERRIDE {}
+  void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
+
+private:
+  ContiguousListSample(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  /** Throw if the list is a mapped file */
+  void CheckWritable() const;
+
+  /** Identify the value type in the header of the binary files */
+  static itk::uint32_t GetValueTypeCode();
+
+  MeasurementVectorSizeType m_MeasurementVectorSize;
+
+  /** Samples owned by the list (empty when mapped) */
+  std::vector<ValueType> m_Buffer;
+
+  /** Mapping of the file given to Load() */
+  MappedFile             m_MappedFile;
+
+  /** Address of the first sample, either in m_Buffer or in the mapping */
+  const ValueType *      m_Data;
+
+  InstanceIdentifier     m_Size;
+};
+
+} // end of namespace Statistics
+} // end of namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbContiguousListSample.txx"
+#endif
+
+#endif
@@ -0,0 +1,312 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbContiguousListSample_txx
+#define otbContiguousListSample_txx
+
+#include "otbContiguousListSample.h"
+
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace otb
+{
+namespace Statistics
+{
+
+template <class TValue>
+ContiguousListSample<TValue>
+::ContiguousListSample()
+  : m_MeasurementVectorSize(0),
+    m_Data(ITK_NULLPTR),
+    m_Size(0)
+{
+}
+
+template <class TValue>
+void
+ContiguousListSample<TValue>
+::SetMeasurementVectorSize(MeasurementVectorSizeType s)
+{
+  if (s == m_MeasurementVectorSize)
+    {
+    return;
+    }
+  if (m_Size > 0)
+    {
+    itkExceptionMacro(<< "Can not change the measurement vector size of a non empty list");
+    }
+  m_MeasurementVectorSize = s;
+  this->Modified();
+}
+
+template <class TValue>
+typename ContiguousListSample<TValue>::MeasurementVectorType
+ContiguousListSample<TValue>
+::GetMeasurementVector(InstanceIdentifier id) const
+{
+  if (id >= m_Size)
+    {
+    itkExceptionMacro(<< "Identifier " << id << " is out of bounds (size is " << m_Size << ")");
+    }
+  MeasurementVectorType mv(m_MeasurementVectorSize);
+  const ValueType * data = this->GetMeasurementVectorPointer(id);
+  std::copy(data, data + m_MeasurementVectorSize, &mv[0]);
+  return mv;
+}
+
+template <class TValue>
+void
+ContiguousListSample<TValue>
+::CheckWritable() const
+{
+  if (this->IsMapped())
+    {
+    itkExceptionMacro(<< "The samples are mapped from " << m_MappedFile.GetFileName()
+                      << " and can not be modified");
+    }
+}
+
+template <class TValue>
+void
+ContiguousListSample<TValue>
+::Reserve(InstanceIdentifier n)
+{
+  this->CheckWritable();
+  m_Buffer.reserve(n * this->GetMeasurementVectorSize());
+  m_Data = m_Buffer.empty() ? ITK_NULLPTR : &m_Buffer[0];
+}
+
+template <class TValue>
+void
+ContiguousListSample<TValue>
+::Resize(InstanceIdentifier n)
+{
+  this->CheckWritable();
+  m_Buffer.resize(n * this->GetMeasurementVectorSize(), static_cast<ValueType>(0));
+  m_Size = n;
+  m_Data = m_Buffer.empty() ? ITK_NULLPTR : &m_Buffer[0];
+  this->Modified();
+}
+
+template <class TValue>
+void
+ContiguousListSample<TValue>
+::Clear()
+{
+  m_MappedFile.Close();
+  m_Buffer.clear();
+  m_Size = 0;
+  m_Data = ITK_NULLPTR;
+  this->Modified();
+}
+
+template <class TValue>
+void
+ContiguousListSample<TValue>
+::PushBack(const MeasurementVectorType & mv)
+{
+  if (mv.Size() != this->GetMeasurementVectorSize())
+    {
+    itkExceptionMacro(<< "The sample has " << mv.Size() << " components instead of "
+                      << this->GetMeasurementVectorSize());
+    }
+  this->PushBack(mv.GetDataPointer());
+}
+
+template <class TValue>
+void
+ContiguousListSample<TValue>
+::PushBack(const ValueType * mv)
+{
+  this->CheckWritable();
+  m_Buffer.insert(m_Buffer.end(), mv, mv + this->GetMeasurementVectorSize());
+  ++m_Size;
+  m_Data = m_Buffer.empty() ? ITK_NULLPTR : &m_Buffer[0];
+  this->Modified();
+}
+
+template <class TValue>
+void
+ContiguousListSample<TValue>
+::SetMeasurement(InstanceIdentifier id, unsigned int dim, const MeasurementType & value)
+{
+  this->CheckWritable();
+  if (id >= m_Size || dim >= this->GetMeasurementVectorSize())
+    {
+    itkExceptionMacro(<< "Measurement (" << id << ", " << dim << ") is out of bounds");
+    }
+  m_Buffer[id * this->GetMeasurementVectorSize() + dim] = value;
+}
+
+template <class TValue>
+void
+ContiguousListSample<TValue>
+::SetMeasurementVector(InstanceIdentifier id, const MeasurementVectorType & mv)
+{
+  this->CheckWritable();
+  const unsigned int nbComp = this->GetMeasurementVectorSize();
+  if (id >= m_Size || mv.Size() != nbComp)
+    {
+    itkExceptionMacro(<< "Can not set the sample " << id);
+    }
+  std::copy(mv.GetDataPointer(), mv.GetDataPointer() + nbComp, m_Buffer.begin() + id * nbComp);
+}
+
+template <class TValue>
+template <class TSample>
+void
+ContiguousListSample<TValue>
+::CopyFrom(const TSample * sample)
+{
+  this->Clear();
+  this->SetMeasurementVectorSize(sample->GetMeasurementVectorSize());
+  const unsigned int nbComp = this->GetMeasurementVectorSize();
+  this->Resize(sample->Size());
+
+  ValueType * out = m_Buffer.empty() ? ITK_NULLPTR : &m_Buffer[0];
+  for (typename TSample::ConstIterator it = sample->Begin(); it != sample->End(); ++it)
+    {
+    const typename TSample::MeasurementVectorType & mv = it.GetMeasurementVector();
+    for (unsigned int j = 0; j < nbComp; ++j, ++out)
+      {
+      *out = static_cast<ValueType>(mv[j]);
+      }
+    }
+}
+
+template <class TValue>
+itk::uint32_t
+ContiguousListSample<TValue>
+::GetValueTypeCode()
+{
+  return static_cast<itk::uint32_t>(sizeof(ValueType))
+    | (std::numeric_limits<ValueType>::is_integer ? 0x100 : 0)
+    | (std::numeric_limits<ValueType>::is_signed ? 0x200 : 0);
+}
+
+template <class TValue>
+void
+ContiguousListSample<TValue>
+::Save(const std::string & filename) const
+{
+  std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file)
+    {
+    itkExceptionMacro(<< "Can not open " << filename << " for writing");
+    }
+
+  char header[HeaderSize];
+  std::memset(header, 0, HeaderSize);
+  const itk::uint32_t version = FileVersion;
+  const itk::uint32_t typeCode = GetValueTypeCode();
+  const itk::uint32_t nbComp = this->GetMeasurementVectorSize();
+  const itk::uint64_t nbSamples = m_Size;
+  std::memcpy(header, "OTBSAMPL", 8);
+  std::memcpy(header + 8, &version, 4);
+  std::memcpy(header + 12, &typeCode, 4);
+  std::memcpy(header + 16, &nbComp, 4);
+  std::memcpy(header + 24, &nbSamples, 8);
+  file.write(header, HeaderSize);
+
+  if (m_Size > 0)
+    {
+    file.write(reinterpret_cast<const char *>(m_Data),
+               static_cast<std::streamsize>(m_Size * nbComp * sizeof(ValueType)));
+    }
+  if (!file)
+    {
+    itkExceptionMacro(<< "Error while writing " << filename);
+    }
+}
+
+template <class TValue>
+void
+ContiguousListSample<TValue>
+::Load(const std::string & filename)
+{
+  this->Clear();
+
+  std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+  char header[HeaderSize];
+  if (!file || !file.read(header, HeaderSize))
+    {
+    itkExceptionMacro(<< "Can not read the header of " << filename);
+    }
+
+  itk::uint32_t version, typeCode, nbComp;
+  itk::uint64_t nbSamples;
+  std::memcpy(&version, header + 8, 4);
+  std::memcpy(&typeCode, header + 12, 4);
+  std::memcpy(&nbComp, header + 16, 4);
+  std::memcpy(&nbSamples, header + 24, 8);
+  if (std::memcmp(header, "OTBSAMPL", 8) != 0 || version != FileVersion)
+    {
+    itkExceptionMacro(<< filename << " is not a file of samples");
+    }
+  if (typeCode != GetValueTypeCode())
+    {
+    itkExceptionMacro(<< "The samples of " << filename << " do not have the expected value type");
+    }
+
+  this->SetMeasurementVectorSize(nbComp);
+  const std::size_t dataSize = static_cast<std::size_t>(nbSamples) * nbComp * sizeof(ValueType);
+
+  if (m_MappedFile.Open(filename))
+    {
+    if (m_MappedFile.GetSize() < HeaderSize + dataSize)
+      {
+      m_MappedFile.Close();
+      itkExceptionMacro(<< filename << " is truncated");
+      }
+    m_Data = reinterpret_cast<const ValueType *>(m_MappedFile.GetData() + HeaderSize);
+    }
+  else
+    {
+    m_Buffer.resize(static_cast<std::size_t>(nbSamples) * nbComp);
+    if (dataSize > 0
+        && !file.read(reinterpret_cast<char *>(&m_Buffer[0]), static_cast<std::streamsize>(dataSize)))
+      {
+      m_Buffer.clear();
+      itkExceptionMacro(<< filename << " is truncated");
+      }
+    m_Data = m_Buffer.empty() ? ITK_NULLPTR : &m_Buffer[0];
+    }
+  m_Size = static_cast<InstanceIdentifier>(nbSamples);
+  this->Modified();
+}
+
+template <class TValue>
+void
+ContiguousListSample<TValue>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Measurement vector size: " << m_MeasurementVectorSize << std::endl;
+  os << indent << "Number of samples: " << m_Size << std::endl;
+  os << indent << "Mapped: " << (this->IsMapped() ? m_MappedFile.GetFileName() : "no") << std::endl;
+}
+
+} // end of namespace Statistics
+} // end of namespace otb
+
+#endif
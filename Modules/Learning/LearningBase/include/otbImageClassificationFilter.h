@@ -24,6 +24,9 @@
 #include "itkImageToImageFilter.h"
 #include "otbMachineLearningModel.h"
 #include "otbImage.h"
+#include "otbVectorImage.h"
+#include "otbThreadPoolDispatcher.h"
+#include "otbImageRegionCostBalancedSplitter.h"
 
 namespace otb
 {
@@ -33,6 +36,16 @@ namespace otb
  *  This filter is streamed and threaded, allowing to classify huge images
  *  while fully using several core.
  *
+ *  Besides the labels, the filter can produce a confidence map, and, for
+ *  the models which give class probabilities (see
+ *  MachineLearningModel::HasProbaIndex()), a probability image with one
+ *  band per class, in the order of MachineLearningModel::GetProbaLabels().
+ *  The probabilities are computed in the same prediction as the labels.
+ *  The confidence and probability outputs are only requested and
+ *  allocated when UseConfidenceMap and UseProbaMap are on: otherwise they
+ *  take no memory, and do not weigh in the memory estimation of the
+ *  streaming.
+ *
  * \sa Classifier
  * \ingroup Streamed
  * \ingroup Threaded
@@ -75,6 +88,12 @@ public:
   typedef otb::Image<double>                    ConfidenceImageType;
   typedef typename ConfidenceImageType::Pointer ConfidenceImagePointerType;
 
+  typedef otb::VectorImage<double>              ProbaImageType;
+  typedef typename ProbaImageType::Pointer      ProbaImagePointerType;
+
+  typedef ImageRegionCostBalancedSplitter<OutputImageType::ImageDimension> SplitterType;
+  typedef typename SplitterType::Pointer                                   SplitterPointerType;
+
   /** Set/Get the model */
   itkSetObjectMacro(Model, ModelType);
   itkGetObjectMacro(Model, ModelType);
@@ -87,10 +106,21 @@ public:
   itkSetMacro(UseConfidenceMap, bool);
   itkGetMacro(UseConfidenceMap, bool);
 
+  /** Set/Get the class probabilities flag (the model has to support it) */
+  itkSetMacro(UseProbaMap, bool);
+  itkGetMacro(UseProbaMap, bool);
+
   itkSetMacro(BatchMode, bool);
   itkGetMacro(BatchMode, bool);
   itkBooleanMacro(BatchMode);
 
+  /** Set/Get whether the threads get pieces of the same cost instead of
+   * the same size when a mask is set (default is true): pixels outside
+   * the mask are much cheaper than the classified ones. */
+  itkSetMacro(CostBalancedSplitting, bool);
+  itkGetMacro(CostBalancedSplitting, bool);
+  itkBooleanMacro(CostBalancedSplitting);
+
   /**
    * If set, only pixels within the mask will be classified.
    * All pixels with a value greater than 0 in the mask, will be classified.
@@ -109,22 +139,45 @@ public:
    */
   ConfidenceImageType * GetOutputConfidence(void);
 
+  /**
+   * Get the output class probabilities
+   */
+  ProbaImageType * GetOutputProba(void);
+
 protected:
   /** Constructor */
   ImageClassificationFilter();
   /** Destructor */
   ~ImageClassificationFilter() ITK_OVERRIDE {}
 
+  /** Set the number of bands of the probability image */
+  void GenerateOutputInformation() ITK_OVERRIDE;
+
+  /** Request an empty region on the outputs which are not produced */
+  void GenerateOutputRequestedRegion(itk::DataObject * output) ITK_OVERRIDE;
+
+  /** Only allocate the outputs which are produced */
+  void AllocateOutputs() ITK_OVERRIDE;
+
+  /** Process the output region by chunks on the ThreadPool when it is
+   * enabled, with the MultiThreader otherwise */
+  void GenerateData() ITK_OVERRIDE;
+
   /** Threaded generate data */
   void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType threadId) ITK_OVERRIDE;
   void ClassicThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType threadId);
   void BatchThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType threadId);
   /** Before threaded generate data */
   void BeforeThreadedGenerateData() ITK_OVERRIDE;
+  /** Splitter balancing the mask coverage between the threads, when
+   * enabled */
+  const itk::ImageRegionSplitterBase* GetImageRegionSplitter(void) const ITK_OVERRIDE;
   /**PrintSelf method */
   void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
 
 private:
+  friend class ThreadPoolDispatcher<Self>;
+
   ImageClassificationFilter(const Self &); //purposely not implemented
   void operator =(const Self&); //purposely not implemented
 
@@ -134,7 +187,13 @@ private:
   LabelType m_DefaultLabel;
   /** Flag to produce the confidence map (if the model supports it) */
   bool m_UseConfidenceMap;
+  /** Flag to produce the class probabilities (if the model supports it) */
+  bool m_UseProbaMap;
   bool m_BatchMode;
+  bool m_CostBalancedSplitting;
+  /** Splitter with the mask coverage of the current requested region */
+  SplitterPointerType m_Splitter;
+  bool m_UseSplitter;
 };
 } // End namespace otb
 #ifndef OTB_MANUAL_INSTANTIATION
@@ -38,11 +38,16 @@ ImageClassificationFilter<TInputImage, TOutputImage, TMaskImage>
   this->SetNumberOfRequiredInputs(1);
   m_DefaultLabel = itk::NumericTraits<LabelType>::ZeroValue();
 
-  this->SetNumberOfRequiredOutputs(2);
+  this->SetNumberOfRequiredOutputs(3);
   this->SetNthOutput(0,TOutputImage::New());
   this->SetNthOutput(1,ConfidenceImageType::New());
+  this->SetNthOutput(2,ProbaImageType::New());
   m_UseConfidenceMap = false;
+  m_UseProbaMap = false;
   m_BatchMode = true;
+  m_CostBalancedSplitting = true;
+  m_Splitter = SplitterType::New();
+  m_UseSplitter = false;
 }
 
 template <class TInputImage, class TOutputImage, class TMaskImage>
@@ -79,6 +84,97 @@ ImageClassificationFilter<TInputImage, TOutputImage, TMaskImage>
   return static_cast<ConfidenceImageType *>(this->itk::ProcessObject::GetOutput(1));
 }
 
+template <class TInputImage, class TOutputImage, class TMaskImage>
+typename ImageClassificationFilter<TInputImage, TOutputImage, TMaskImage>
+::ProbaImageType *
+ImageClassificationFilter<TInputImage, TOutputImage, TMaskImage>
+::GetOutputProba()
+{
+  if (this->GetNumberOfOutputs() < 3)
+    {
+    return ITK_NULLPTR;
+    }
+  return static_cast<ProbaImageType *>(this->itk::ProcessObject::GetOutput(2));
+}
+
+template <class TInputImage, class TOutputImage, class TMaskImage>
+void
+ImageClassificationFilter<TInputImage, TOutputImage, TMaskImage>
+::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+
+  // One band per class, a single one if the probabilities are not
+  // computed
+  unsigned int nbBands = 1;
+  if (m_UseProbaMap)
+    {
+    if (!m_Model)
+      {
+      itkGenericExceptionMacro(<< "No model for classification");
+      }
+    if (!m_Model->HasProbaIndex() || m_Model->GetRegressionMode())
+      {
+      itkGenericExceptionMacro(<< "The model does not give class probabilities");
+      }
+    nbBands = m_Model->GetProbaLabels().size();
+    }
+  this->GetOutputProba()->SetNumberOfComponentsPerPixel(nbBands);
+}
+
+template <class TInputImage, class TOutputImage, class TMaskImage>
+void
+ImageClassificationFilter<TInputImage, TOutputImage, TMaskImage>
+::GenerateOutputRequestedRegion(itk::DataObject * output)
+{
+  Superclass::GenerateOutputRequestedRegion(output);
+
+  OutputImageRegionType emptyRegion;
+  emptyRegion.SetIndex(this->GetOutput()->GetRequestedRegion().GetIndex());
+  if (!m_UseConfidenceMap)
+    {
+    this->GetOutputConfidence()->SetRequestedRegion(emptyRegion);
+    }
+  if (!m_UseProbaMap)
+    {
+    this->GetOutputProba()->SetRequestedRegion(emptyRegion);
+    }
+}
+
+template <class TInputImage, class TOutputImage, class TMaskImage>
+void
+ImageClassificationFilter<TInputImage, TOutputImage, TMaskImage>
+::AllocateOutputs()
+{
+  OutputImagePointerType outputPtr = this->GetOutput();
+  outputPtr->SetBufferedRegion(outputPtr->GetRequestedRegion());
+  outputPtr->Allocate();
+
+  if (m_UseConfidenceMap)
+    {
+    ConfidenceImagePointerType confidencePtr = this->GetOutputConfidence();
+    confidencePtr->SetBufferedRegion(confidencePtr->GetRequestedRegion());
+    confidencePtr->Allocate();
+    }
+  if (m_UseProbaMap)
+    {
+    ProbaImagePointerType probaPtr = this->GetOutputProba();
+    probaPtr->SetBufferedRegion(probaPtr->GetRequestedRegion());
+    probaPtr->Allocate();
+    }
+}
+
+template <class TInputImage, class TOutputImage, class TMaskImage>
+void
+ImageClassificationFilter<TInputImage, TOutputImage, TMaskImage>
+::GenerateData()
+{
+  if (!ThreadPoolDispatcher<Self>::GenerateData(this))
+    {
+    Superclass::GenerateData();
+    }
+}
+
 template <class TInputImage, class TOutputImage, class TMaskImage>
 void
 ImageClassificationFilter<TInputImage, TOutputImage, TMaskImage>
@@ -95,6 +191,27 @@ ImageClassificationFilter<TInputImage, TOutputImage, TMaskImage>
     this->SetNumberOfThreads(1);
     #endif
     }
+
+  // The mask is up to date on the requested region: the threads can be
+  // balanced on its coverage
+  const MaskImageType * mask = this->GetInputMask();
+  m_UseSplitter = m_CostBalancedSplitting && mask != ITK_NULLPTR && this->GetNumberOfThreads() > 1;
+  if (m_UseSplitter)
+    {
+    m_Splitter->SetMaskImage(mask);
+    }
+}
+
+template <class TInputImage, class TOutputImage, class TMaskImage>
+const itk::ImageRegionSplitterBase*
+ImageClassificationFilter<TInputImage, TOutputImage, TMaskImage>
+::GetImageRegionSplitter(void) const
+{
+  if (m_UseSplitter)
+    {
+    return m_Splitter;
+    }
+  return Superclass::GetImageRegionSplitter();
 }
 
 template <class TInputImage, class TOutputImage, class TMaskImage>
@@ -107,6 +224,7 @@ ImageClassificationFilter<TInputImage, TOutputImage, TMaskImage>
   MaskImageConstPointerType  inputMaskPtr  = this->GetInputMask();
   OutputImagePointerType     outputPtr    = this->GetOutput();
   ConfidenceImagePointerType confidencePtr = this->GetOutputConfidence();
+  ProbaImagePointerType      probaPtr     = this->GetOutputProba();
 
   // Progress reporting
   itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
@@ -116,6 +234,7 @@ ImageClassificationFilter<TInputImage, TOutputImage, TMaskImage>
   typedef itk::ImageRegionConstIterator<MaskImageType>  MaskIteratorType;
   typedef itk::ImageRegionIterator<OutputImageType>     OutputIteratorType;
   typedef itk::ImageRegionIterator<ConfidenceImageType> ConfidenceMapIteratorType;
+  typedef itk::ImageRegionIterator<ProbaImageType>      ProbaMapIteratorType;
 
   InputIteratorType inIt(inputPtr, outputRegionForThread);
   OutputIteratorType outIt(outputPtr, outputRegionForThread);
@@ -137,6 +256,16 @@ ImageClassificationFilter<TInputImage, TOutputImage, TMaskImage>
     confidenceIt.GoToBegin();
     }
 
+  // setup iterator for class probabilities
+  bool computeProbaMap(m_UseProbaMap && m_Model->HasProbaIndex() && !m_Model->GetRegressionMode());
+  ProbaMapIteratorType probaIt;
+  typename ModelType::ProbaSampleType proba(probaPtr->GetNumberOfComponentsPerPixel());
+  if (computeProbaMap)
+    {
+    probaIt = ProbaMapIteratorType(probaPtr,outputRegionForThread);
+    probaIt.GoToBegin();
+    }
+
   bool validPoint = true;
   double confidenceIndex = 0.0;
 
@@ -153,26 +282,27 @@ ImageClassificationFilter<TInputImage, TOutputImage, TMaskImage>
     if (validPoint)
       {
       // Classifify
-      if (computeConfidenceMap)
-        {
-        outIt.Set(m_Model->Predict(inIt.Get(),&confidenceIndex)[0]);
-        }
-      else
-        {
-        outIt.Set(m_Model->Predict(inIt.Get())[0]);
-        }
+      outIt.Set(m_Model->Predict(inIt.Get(),
+                                 computeConfidenceMap ? &confidenceIndex : ITK_NULLPTR,
+                                 computeProbaMap ? &proba : ITK_NULLPTR)[0]);
       }
     else
       {
       // else, set default value
       outIt.Set(m_DefaultLabel);
       confidenceIndex = 0.0;
+      proba.Fill(0.0);
       }
     if (computeConfidenceMap)
       {
       confidenceIt.Set(confidenceIndex);
       ++confidenceIt;
       }
+    if (computeProbaMap)
+      {
+      probaIt.Set(proba);
+      ++probaIt;
+      }
     progress.CompletedPixel();
     }
 
@@ -185,11 +315,14 @@ ImageClassificationFilter<TInputImage, TOutputImage, TMaskImage>
 {
   bool computeConfidenceMap(m_UseConfidenceMap && m_Model->HasConfidenceIndex() 
                             && !m_Model->GetRegressionMode());
+  bool computeProbaMap(m_UseProbaMap && m_Model->HasProbaIndex()
+                       && !m_Model->GetRegressionMode());
   // Get the input pointers
   InputImageConstPointerType inputPtr     = this->GetInput();
   MaskImageConstPointerType  inputMaskPtr  = this->GetInputMask();
   OutputImagePointerType     outputPtr    = this->GetOutput();
   ConfidenceImagePointerType confidencePtr = this->GetOutputConfidence();
+  ProbaImagePointerType      probaPtr     = this->GetOutputProba();
     
   // Progress reporting
   itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
@@ -199,6 +332,7 @@ ImageClassificationFilter<TInputImage, TOutputImage, TMaskImage>
   typedef itk::ImageRegionConstIterator<MaskImageType>  MaskIteratorType;
   typedef itk::ImageRegionIterator<OutputImageType>     OutputIteratorType;
   typedef itk::ImageRegionIterator<ConfidenceImageType> ConfidenceMapIteratorType;
+  typedef itk::ImageRegionIterator<ProbaImageType>      ProbaMapIteratorType;
 
   InputIteratorType inIt(inputPtr, outputRegionForThread);
   OutputIteratorType outIt(outputPtr, outputRegionForThread);
@@ -219,6 +353,7 @@ ImageClassificationFilter<TInputImage, TOutputImage, TMaskImage>
   // typedef typename ModelType::ConfidenceValueType      ConfidenceValueType;
   // typedef typename ModelType::ConfidenceSampleType     ConfidenceSampleType;
   typedef typename ModelType::ConfidenceListSampleType ConfidenceListSampleType;
+  typedef typename ModelType::ProbaListSampleType      ProbaListSampleType;
 
   typename InputListSampleType::Pointer samples = InputListSampleType::New();
   unsigned int num_features = inputPtr->GetNumberOfComponentsPerPixel();
@@ -249,9 +384,12 @@ ImageClassificationFilter<TInputImage, TOutputImage, TMaskImage>
   typename ConfidenceListSampleType::Pointer confidences;
   if(computeConfidenceMap)
     confidences = ConfidenceListSampleType::New();
+  typename ProbaListSampleType::Pointer probas;
+  if(computeProbaMap)
+    probas = ProbaListSampleType::New();
 
   // This call is threadsafe
-  labels = m_Model->PredictBatch(samples,confidences);
+  labels = m_Model->PredictBatch(samples,confidences,probas);
 
   // Set the output values
   ConfidenceMapIteratorType confidenceIt;
@@ -260,12 +398,21 @@ ImageClassificationFilter<TInputImage, TOutputImage, TMaskImage>
     confidenceIt = ConfidenceMapIteratorType(confidencePtr,outputRegionForThread);
     confidenceIt.GoToBegin();
     }
+  ProbaMapIteratorType probaIt;
+  typename ProbaImageType::PixelType defaultProba(probaPtr->GetNumberOfComponentsPerPixel());
+  defaultProba.Fill(0.0);
+  if (computeProbaMap)
+    {
+    probaIt = ProbaMapIteratorType(probaPtr,outputRegionForThread);
+    probaIt.GoToBegin();
+    }
 
   typename TargetListSampleType::ConstIterator labIt = labels->Begin();
   maskIt.GoToBegin();
   for (outIt.GoToBegin(); !outIt.IsAtEnd(); ++outIt)
     {
     double confidenceIndex = 0.0;
+    bool classified = false;
     TargetValueType labelValue(m_DefaultLabel);
     if (inputMaskPtr)
       {
@@ -280,6 +427,11 @@ ImageClassificationFilter<TInputImage, TOutputImage, TMaskImage>
         {
         confidenceIndex = confidences->GetMeasurementVector(labIt.GetInstanceIdentifier())[0];
         }
+       if(computeProbaMap)
+        {
+        probaIt.Set(probas->GetMeasurementVector(labIt.GetInstanceIdentifier()));
+        classified = true;
+        }
        
       ++labIt;    
       }
@@ -295,6 +447,15 @@ ImageClassificationFilter<TInputImage, TOutputImage, TMaskImage>
       confidenceIt.Set(confidenceIndex);
       ++confidenceIt;
       }
+
+    if(computeProbaMap)
+      {
+      if(!classified)
+        {
+        probaIt.Set(defaultProba);
+        }
+      ++probaIt;
+      }
     
     progress.CompletedPixel();
     }
@@ -323,6 +484,8 @@ ImageClassificationFilter<TInputImage, TOutputImage, TMaskImage>
 ::PrintSelf(std::ostream& os, itk::Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
+  os << indent << "UseConfidenceMap: " << m_UseConfidenceMap << std::endl;
+  os << indent << "UseProbaMap: " << m_UseProbaMap << std::endl;
 }
 } // End namespace otb
 #endif
@@ -24,6 +24,9 @@
 #include "itkObject.h"
 #include "itkVariableLengthVector.h"
 #include "itkListSample.h"
+#include "otbContiguousListSample.h"
+
+#include <vector>
 
 namespace otb
 {
@@ -49,6 +52,10 @@ namespace otb
  * from a multi-band image) with the help of the Predict() method which
  * needs a previous loading of the classification model with the Load() method.
  *
+ * Some models can also give the probability of each class, in the same
+ * pass as the label (see HasProbaIndex()). They override DoPredictProba()
+ * and optionally DoPredictBatchProba().
+ *
  * \sa MachineLearningModelFactory
  * \sa LibSVMMachineLearningModel
  * \sa SVMMachineLearningModel
@@ -84,6 +91,7 @@ public:
   typedef TInputValue                                   InputValueType;
   typedef itk::VariableLengthVector<InputValueType>     InputSampleType;
   typedef itk::Statistics::ListSample<InputSampleType>  InputListSampleType;
+  typedef otb::Statistics::ContiguousListSample<InputValueType> InputContiguousListSampleType;
   //@}
 
   /**\name Target related typedefs */
@@ -98,6 +106,10 @@ public:
   typedef itk::FixedArray<ConfidenceValueType,1>            ConfidenceSampleType;
   typedef itk::Statistics::ListSample<ConfidenceSampleType> ConfidenceListSampleType;
 
+  /**\name Class probabilities typedefs */
+  typedef itk::VariableLengthVector<ConfidenceValueType>    ProbaSampleType;
+  typedef itk::Statistics::ListSample<ProbaSampleType>      ProbaListSampleType;
+
   /**\name Standard macros */
   //@{
   /** Run-time type information (and related methods). */
@@ -111,9 +123,11 @@ public:
     * \param input The sample
     * \param quality A pointer to the quality variable were to store
     * quality value, or NULL
+    * \param proba A pointer to the vector were to store the probability
+    * of each class, or NULL
     * \return The predicted label
      */
-  TargetSampleType Predict(const InputSampleType& input, ConfidenceValueType *quality = ITK_NULLPTR) const;
+  TargetSampleType Predict(const InputSampleType& input, ConfidenceValueType *quality = ITK_NULLPTR, ProbaSampleType *proba = ITK_NULLPTR) const;
 
 
 
@@ -121,11 +135,13 @@ public:
     * \param input The batch of sample to predict
     * \param quality A pointer to the list were to store
     * quality value, or NULL
+    * \param proba A pointer to the list were to store the probability
+    * of each class, or NULL
     * \return The predicted labels
     * Note that this method will be multi-threaded if OTB is built
     * with OpenMP.
      */
-  typename TargetListSampleType::Pointer PredictBatch(const InputListSampleType * input, ConfidenceListSampleType * quality = ITK_NULLPTR) const;
+  typename TargetListSampleType::Pointer PredictBatch(const InputListSampleType * input, ConfidenceListSampleType * quality = ITK_NULLPTR, ProbaListSampleType * proba = ITK_NULLPTR) const;
   
   /**\name Classification model file manipulation */
   //@{
@@ -148,6 +164,12 @@ public:
   /** Query capacity to produce a confidence index */
   bool HasConfidenceIndex() const {return m_ConfidenceIndex;}
 
+  /** Query capacity to produce the probability of each class */
+  bool HasProbaIndex() const {return !m_ProbaLabels.empty();}
+
+  /** Get the labels of the classes, in the order of the probabilities */
+  const std::vector<TargetValueType> & GetProbaLabels() const {return m_ProbaLabels;}
+
   /**\name Input list of samples accessors */
   //@{
   itkSetObjectMacro(InputListSample,InputListSampleType);
@@ -155,6 +177,16 @@ public:
   itkGetConstObjectMacro(InputListSample,InputListSampleType);
   //@}
 
+  /**\name Contiguous input list of samples accessors
+   * When set, the model is trained on this list instead of the input
+   * list sample. The training samples are then read from its buffer,
+   * without copying them one by one. */
+  //@{
+  itkSetObjectMacro(InputContiguousListSample,InputContiguousListSampleType);
+  itkGetObjectMacro(InputContiguousListSample,InputContiguousListSampleType);
+  itkGetConstObjectMacro(InputContiguousListSample,InputContiguousListSampleType);
+  //@}
+
   /**\name Classification output accessors */
   //@{
   /** Set the target labels (to be used before training) */
@@ -184,6 +216,10 @@ protected:
   /** Input list sample */
   typename InputListSampleType::Pointer m_InputListSample;
 
+  /** Contiguous input list sample, used for training instead of
+   * m_InputListSample when set */
+  typename InputContiguousListSampleType::Pointer m_InputContiguousListSample;
+
   /** Target list sample */
   typename TargetListSampleType::Pointer m_TargetListSample;
 
@@ -203,7 +239,16 @@ protected:
   /** Is DoPredictBatch multi-threaded ? */
   bool m_IsDoPredictBatchMultiThreaded;
 
+  /** Labels of the classes, in increasing order, if the model can give
+   * their probabilities. Child classes fill it after training or
+   * loading a model. */
+  std::vector<TargetValueType> m_ProbaLabels;
+
 private:
+  /** Predict a range of samples, with the probabilities if proba is not
+   * NULL */
+  void PredictRange(const InputListSampleType * input, const unsigned int & startIndex, const unsigned int & size, TargetListSampleType * target, ConfidenceListSampleType * quality, ProbaListSampleType * proba) const;
+
   /**  Actual implementation of BatchPredicition
     *  Default implementation will call DoPredict iteratively 
     *  \param input The input batch
@@ -228,6 +273,24 @@ private:
    *  \return The predicted label
    */ 
   virtual TargetSampleType DoPredict(const InputSampleType& input, ConfidenceValueType * quality= ITK_NULLPTR) const = 0;  
+
+  /** Actual implementation of single sample prediction with the
+   *  probability of each class. The default implementation throws an
+   *  exception.
+   *  \param input sample to predict
+   *  \param quality Pointer to a variable to store confidence value,
+   *  or NULL
+   *  \param proba Vector of the probabilities, of the size of
+   *  m_ProbaLabels
+   *  \return The predicted label
+   */
+  virtual TargetSampleType DoPredictProba(const InputSampleType& input, ConfidenceValueType * quality, ProbaSampleType & proba) const;
+
+  /** Actual implementation of batch prediction with the probability of
+   *  each class. Default implementation calls DoPredictProba
+   *  iteratively.
+   */
+  virtual void DoPredictBatchProba(const InputListSampleType * input, const unsigned int & startIndex, const unsigned int & size, TargetListSampleType * target, ConfidenceListSampleType * quality, ProbaListSampleType * proba) const;
  
   MachineLearningModel(const Self &); //purposely not implemented
   void operator =(const Self&); //purposely not implemented
@@ -67,8 +67,17 @@ template <class TInputValue, class TOutputValue, class TConfidenceValue>
 typename MachineLearningModel<TInputValue,TOutputValue,TConfidenceValue>
 ::TargetSampleType
 MachineLearningModel<TInputValue,TOutputValue,TConfidenceValue>
-::Predict(const InputSampleType& input, ConfidenceValueType *quality) const
+::Predict(const InputSampleType& input, ConfidenceValueType *quality, ProbaSampleType *proba) const
 {
+  if(proba != ITK_NULLPTR)
+    {
+    if(!this->HasProbaIndex())
+      {
+      itkExceptionMacro(<<"Class probabilities not available for this model");
+      }
+    proba->SetSize(m_ProbaLabels.size());
+    return this->DoPredictProba(input,quality,*proba);
+    }
   // Call protected specialization entry point
   return this->DoPredict(input,quality);
 }
@@ -78,7 +87,7 @@ template <class TInputValue, class TOutputValue, class TConfidenceValue>
 typename MachineLearningModel<TInputValue,TOutputValue,TConfidenceValue>
 ::TargetListSampleType::Pointer
 MachineLearningModel<TInputValue,TOutputValue,TConfidenceValue>
-::PredictBatch(const InputListSampleType * input, ConfidenceListSampleType * quality) const
+::PredictBatch(const InputListSampleType * input, ConfidenceListSampleType * quality, ProbaListSampleType * proba) const
 {
   typename TargetListSampleType::Pointer targets = TargetListSampleType::New();
   targets->Resize(input->Size());
@@ -88,11 +97,22 @@ MachineLearningModel<TInputValue,TOutputValue,TConfidenceValue>
     quality->Clear();
     quality->Resize(input->Size());
     }
+
+  if(proba!=ITK_NULLPTR)
+    {
+    if(!this->HasProbaIndex())
+      {
+      itkExceptionMacro(<<"Class probabilities not available for this model");
+      }
+    proba->Clear();
+    proba->SetMeasurementVectorSize(m_ProbaLabels.size());
+    proba->Resize(input->Size());
+    }
   
   if(m_IsDoPredictBatchMultiThreaded)
     {
     // Simply calls DoPredictBatch
-    this->DoPredictBatch(input,0,input->Size(),targets,quality);
+    this->PredictRange(input,0,input->Size(),targets,quality,proba);
     return targets;
     }
   else
@@ -119,16 +139,31 @@ MachineLearningModel<TInputValue,TOutputValue,TConfidenceValue>
         batch_size+=input->Size()%nb_batches;
         }
     
-      this->DoPredictBatch(input,batch_start,batch_size,targets,quality);
+      this->PredictRange(input,batch_start,batch_size,targets,quality,proba);
       }
     }
     #else
-    this->DoPredictBatch(input,0,input->Size(),targets,quality);
+    this->PredictRange(input,0,input->Size(),targets,quality,proba);
     #endif
     return targets;
     }
 }
 
+template <class TInputValue, class TOutputValue, class TConfidenceValue>
+void
+MachineLearningModel<TInputValue,TOutputValue,TConfidenceValue>
+::PredictRange(const InputListSampleType * input, const unsigned int & startIndex, const unsigned int & size, TargetListSampleType * targets, ConfidenceListSampleType * quality, ProbaListSampleType * proba) const
+{
+  if(proba != ITK_NULLPTR)
+    {
+    this->DoPredictBatchProba(input,startIndex,size,targets,quality,proba);
+    }
+  else
+    {
+    this->DoPredictBatch(input,startIndex,size,targets,quality);
+    }
+}
+
 
 
 template <class TInputValue, class TOutputValue, class TConfidenceValue>
@@ -167,6 +202,45 @@ MachineLearningModel<TInputValue,TOutputValue,TConfidenceValue>
     }
 }
 
+template <class TInputValue, class TOutputValue, class TConfidenceValue>
+typename MachineLearningModel<TInputValue,TOutputValue,TConfidenceValue>
+::TargetSampleType
+MachineLearningModel<TInputValue,TOutputValue,TConfidenceValue>
+::DoPredictProba(const InputSampleType& itkNotUsed(input), ConfidenceValueType * itkNotUsed(quality), ProbaSampleType & itkNotUsed(proba)) const
+{
+  itkExceptionMacro(<<"Class probabilities not implemented for this model");
+}
+
+template <class TInputValue, class TOutputValue, class TConfidenceValue>
+void
+MachineLearningModel<TInputValue,TOutputValue,TConfidenceValue>
+::DoPredictBatchProba(const InputListSampleType * input, const unsigned int & startIndex, const unsigned int & size, TargetListSampleType * targets, ConfidenceListSampleType * quality, ProbaListSampleType * proba) const
+{
+  assert(input != ITK_NULLPTR);
+  assert(targets != ITK_NULLPTR);
+  assert(proba != ITK_NULLPTR);
+
+  if(startIndex+size>input->Size())
+    {
+    itkExceptionMacro(<<"requested range ["<<startIndex<<", "<<startIndex+size<<"[ partially outside input sample list range.[0,"<<input->Size()<<"[");
+    }
+
+  ProbaSampleType probabilities(m_ProbaLabels.size());
+  for(unsigned int id = startIndex;id<startIndex+size;++id)
+    {
+    ConfidenceValueType confidence = 0;
+    const TargetSampleType target = this->DoPredictProba(input->GetMeasurementVector(id),
+                                                         quality != ITK_NULLPTR ? &confidence : ITK_NULLPTR,
+                                                         probabilities);
+    targets->SetMeasurementVector(id,target);
+    proba->SetMeasurementVector(id,probabilities);
+    if(quality != ITK_NULLPTR)
+      {
+      quality->SetMeasurementVector(id,confidence);
+      }
+    }
+}
+
 template <class TInputValue, class TOutputValue, class TConfidenceValue>
 void
 MachineLearningModel<TInputValue,TOutputValue,TConfidenceValue>
@@ -22,6 +22,7 @@
 #define otbSharkUtils_h
 
 #include "itkMacro.h"
+#include "otbContiguousListSample.h"
 
 #if defined(__GNUC__) || defined(__clang__)
 #pragma GCC diagnostic push
@@ -81,6 +82,27 @@ template <class T> void ListSampleRangeToSharkVector(const T * listSample, std::
     }
 }
 
+/** Same conversion for a ContiguousListSample, reading its buffer directly */
+template <class TValue> void ListSampleRangeToSharkVector(const Statistics::ContiguousListSample<TValue> * listSample, std::vector<shark::RealVector> & output, unsigned int start, unsigned int size)
+{
+  assert(listSample != ITK_NULLPTR);
+
+  if(start+size>listSample->Size())
+    {
+    itkGenericExceptionMacro(<<"Requested range ["<<start<<", "<<start+size<<"[ is out of bound for input list sample (range [0, "<<listSample->Size()<<"[");
+    }
+
+  output.clear();
+  output.reserve(size);
+
+  const unsigned int sampleSize = listSample->GetMeasurementVectorSize();
+  for (unsigned int sampleIdx = start; sampleIdx < start+size; ++sampleIdx)
+    {
+    const TValue * sample = listSample->GetMeasurementVectorPointer(sampleIdx);
+    output.emplace_back(sample, sample+sampleSize);
+    }
+}
+
 template <class T> void ListSampleRangeToSharkVector(const T * listSample, std::vector<unsigned int> & output, unsigned int start, unsigned int size)
 {
   assert(listSample != ITK_NULLPTR);
@@ -122,6 +144,21 @@ template <class T> void ListSampleToSharkVector(const T * listSample, std::vecto
   assert(listSample != ITK_NULLPTR);
   ListSampleRangeToSharkVector(listSample,output,0, static_cast<unsigned int>(listSample->Size()));
 }
+
+/** Converts the training samples of a machine learning model: its
+ * contiguous input list sample if it is set, its input list sample
+ * otherwise */
+template <class TModel> void TrainingSamplesToSharkVector(TModel * model, std::vector<shark::RealVector> & output)
+{
+  if(model->GetInputContiguousListSample() != ITK_NULLPTR)
+    {
+    ListSampleToSharkVector(model->GetInputContiguousListSample(), output);
+    }
+  else
+    {
+    ListSampleToSharkVector(model->GetInputListSample(), output);
+    }
+}
   
 }
 }
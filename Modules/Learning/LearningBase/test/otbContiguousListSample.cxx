@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "itkListSample.h"
+#include "itkVariableLengthVector.h"
+#include "otbContiguousListSample.h"
+
+#include <iostream>
+
+int otbContiguousListSample(int itkNotUsed(argc), char * argv[])
+{
+  typedef itk::VariableLengthVector<float>                    MeasurementVectorType;
+  typedef itk::Statistics::ListSample<MeasurementVectorType> ListSampleType;
+  typedef otb::Statistics::ContiguousListSample<float>       ContiguousListSampleType;
+
+  const char * outputFilename = argv[1];
+
+  const unsigned int nbComp = 5;
+  const unsigned int nbSamples = 1000;
+
+  ListSampleType::Pointer listSample = ListSampleType::New();
+  listSample->SetMeasurementVectorSize(nbComp);
+  MeasurementVectorType mv(nbComp);
+  for (unsigned int i = 0; i < nbSamples; ++i)
+    {
+    for (unsigned int j = 0; j < nbComp; ++j)
+      {
+      mv[j] = static_cast<float>(i) + 0.1f * static_cast<float>(j);
+      }
+    listSample->PushBack(mv);
+    }
+
+  ContiguousListSampleType::Pointer contiguous = ContiguousListSampleType::New();
+  contiguous->CopyFrom(listSample.GetPointer());
+
+  if (contiguous->Size() != nbSamples || contiguous->GetMeasurementVectorSize() != nbComp)
+    {
+    std::cerr << "Wrong size after the copy: " << contiguous->Size() << " samples of "
+              << contiguous->GetMeasurementVectorSize() << " components" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  contiguous->Save(outputFilename);
+
+  ContiguousListSampleType::Pointer loaded = ContiguousListSampleType::New();
+  loaded->Load(outputFilename);
+  std::cout << "Loaded samples are mapped: " << loaded->IsMapped() << std::endl;
+
+  if (loaded->Size() != nbSamples || loaded->GetMeasurementVectorSize() != nbComp)
+    {
+    std::cerr << "Wrong size after the load" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Check the values through the iterators and the random access
+  ListSampleType::ConstIterator refIt = listSample->Begin();
+  for (ContiguousListSampleType::ConstIterator it = loaded->Begin(); it != loaded->End(); ++it, ++refIt)
+    {
+    const MeasurementVectorType & ref = refIt.GetMeasurementVector();
+    const MeasurementVectorType & sample = it.GetMeasurementVector();
+    const float * ptr = loaded->GetMeasurementVectorPointer(it.GetInstanceIdentifier());
+    for (unsigned int j = 0; j < nbComp; ++j)
+      {
+      if (sample[j] != ref[j] || ptr[j] != ref[j]
+          || loaded->GetMeasurementVector(it.GetInstanceIdentifier())[j] != ref[j])
+        {
+        std::cerr << "Wrong value for the component " << j << " of the sample "
+                  << it.GetInstanceIdentifier() << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  // GetMeasurementVector() returns a copy
+  MeasurementVectorType copy = contiguous->GetMeasurementVector(0);
+  copy[0] += 1.f;
+  if (contiguous->GetMeasurementVectorPointer(0)[0] != listSample->GetMeasurementVector(0)[0])
+    {
+    std::cerr << "Modifying a copy of a sample modified the list" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A mapped list is read-only
+  if (loaded->IsMapped())
+    {
+    bool thrown = false;
+    try
+      {
+      loaded->PushBack(mv);
+      }
+    catch (itk::ExceptionObject &)
+      {
+      thrown = true;
+      }
+    if (!thrown)
+      {
+      std::cerr << "A mapped list should not be modified" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
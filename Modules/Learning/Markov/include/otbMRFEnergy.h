@@ -27,6 +27,46 @@
 
 namespace otb
 {
+namespace internal
+{
+/** Average TEnergy::GetSingleValue() over the neighbors of the iterator
+ * center. The call is qualified, hence resolved at compile time: derived
+ * energies use it to override GetValue() without paying a virtual call
+ * per neighbor. */
+template <class TEnergy, class TNeighborhoodIterator>
+double AverageMRFSingleValues(TEnergy * energy,
+                              const TNeighborhoodIterator& it,
+                              const typename TEnergy::LabelledImagePixelType& value2)
+{
+  typedef typename TEnergy::InputImagePixelType EnergyInputPixelType;
+
+  double             result = 0.0;
+  const unsigned int centerIndex = it.GetCenterNeighborhoodIndex();
+  const unsigned int size = it.Size();
+  bool               isInside = false;
+  unsigned int       insideNeighbors = 0;
+  for (unsigned int pos = 0; pos < centerIndex; ++pos)
+    {
+    EnergyInputPixelType value1 = it.GetPixel(pos, isInside);
+    if (isInside)
+      {
+      result += energy->TEnergy::GetSingleValue(value1, value2);
+      ++insideNeighbors;
+      }
+    }
+  for (unsigned int pos = centerIndex + 1; pos < size; ++pos)
+    {
+    EnergyInputPixelType value1 = it.GetPixel(pos, isInside);
+    if (isInside)
+      {
+      result += energy->TEnergy::GetSingleValue(value1, value2);
+      ++insideNeighbors;
+      }
+    }
+  return result / insideNeighbors;
+}
+} // end namespace internal
+
 /**
  * \class MRFEnergy
  * \brief This is the base class for energy function used in the MRF framework
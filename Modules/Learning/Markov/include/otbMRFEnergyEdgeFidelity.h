@@ -71,6 +71,17 @@ public:
     return vnl_math_sqr((val1 - val2)) / (1 + vnl_math_sqr(val1 - val2));
   }
 
+  typedef typename Superclass::LabelledNeighborhoodIterator LabelledNeighborhoodIterator;
+
+  using Superclass::GetValue;
+
+  /** Neighborhood energy, evaluated with GetSingleValue() resolved at
+   * compile time. */
+  double GetValue(const LabelledNeighborhoodIterator& it, const LabelledImagePixelType& value2) ITK_OVERRIDE
+  {
+    return internal::AverageMRFSingleValues(this, it, value2);
+  }
+
 protected:
   // The constructor and destructor.
   MRFEnergyEdgeFidelity() {};
@@ -86,6 +86,17 @@ public:
     return static_cast<double>(result);
   }
 
+  typedef typename Superclass::LabelledNeighborhoodIterator LabelledNeighborhoodIterator;
+
+  using Superclass::GetValue;
+
+  /** Neighborhood energy, evaluated with GetSingleValue() resolved at
+   * compile time. */
+  double GetValue(const LabelledNeighborhoodIterator& it, const LabelledImagePixelType& value2) ITK_OVERRIDE
+  {
+    return internal::AverageMRFSingleValues(this, it, value2);
+  }
+
 protected:
   // The constructor and destructor.
   MRFEnergyGaussianClassification() {};
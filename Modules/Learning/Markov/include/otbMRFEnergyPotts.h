@@ -78,6 +78,17 @@ public:
       }
   }
 
+  typedef typename Superclass::LabelledNeighborhoodIterator LabelledNeighborhoodIterator;
+
+  using Superclass::GetValue;
+
+  /** Neighborhood energy, evaluated with GetSingleValue() resolved at
+   * compile time. */
+  double GetValue(const LabelledNeighborhoodIterator& it, const LabelledImagePixelType& value2) ITK_OVERRIDE
+  {
+    return internal::AverageMRFSingleValues(this, it, value2);
+  }
+
 protected:
   // The constructor and destructor.
   MRFEnergyPotts()
@@ -24,6 +24,7 @@
 #include "itkObject.h"
 #include "itkObjectFactory.h"
 #include "itkArray.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
 
 namespace otb
 {
@@ -49,6 +50,8 @@ public:
   typedef itk::SmartPointer<const Self> ConstPointer;
   typedef itk::Array<double>            ParametersType;
 
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
+
   itkTypeMacro(MRFOptimizer, itk::Object);
 
   itkGetConstMacro(NumberOfParameters, unsigned int);
@@ -70,6 +73,11 @@ public:
     this->Modified();
   }
 
+  /** Set the generator used by stochastic optimizers instead of the global
+   * instance. Deterministic optimizers ignore it. This allows
+   * MarkovRandomFieldFilter to give one generator to each thread. */
+  virtual void SetRandomGenerator(RandomGeneratorType * itkNotUsed(generator)) {}
+
   virtual bool Compute(double deltaEnergy) = 0;
 
 protected:
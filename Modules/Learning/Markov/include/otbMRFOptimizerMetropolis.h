@@ -93,6 +93,11 @@ public:
     return false;
   }
 
+  void SetRandomGenerator(RandomGeneratorType * generator) ITK_OVERRIDE
+  {
+    m_Generator = generator;
+  }
+
   /** Methods to cancel random effects.*/
   void InitializeSeed(int seed)
   {
@@ -23,6 +23,7 @@
 
 #include "otbMRFEnergy.h"
 #include "itkNeighborhoodIterator.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
 
 namespace otb
 {
@@ -64,6 +65,8 @@ public:
   typedef typename EnergyFidelityType::Pointer       EnergyFidelityPointer;
   typedef typename EnergyRegularizationType::Pointer EnergyRegularizationPointer;
 
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
+
   itkTypeMacro(MRFSampler, Object);
 
   itkSetMacro(NumberOfClasses, unsigned int);
@@ -82,6 +85,11 @@ public:
   itkSetObjectMacro(EnergyRegularization, EnergyRegularizationType);
   itkSetObjectMacro(EnergyFidelity, EnergyFidelityType);
 
+  /** Set the generator used by stochastic samplers instead of the global
+   * instance. Deterministic samplers ignore it. This allows
+   * MarkovRandomFieldFilter to give one generator to each thread. */
+  virtual void SetRandomGenerator(RandomGeneratorType * itkNotUsed(generator)) {}
+
   virtual int Compute(const InputImageNeighborhoodIterator& itData,
                       const LabelledImageNeighborhoodIterator& itRegul) = 0;
 
@@ -80,6 +80,11 @@ public:
     return 0;
   }
 
+  void SetRandomGenerator(RandomGeneratorType * generator) ITK_OVERRIDE
+  {
+    m_Generator = generator;
+  }
+
   /** Methods to cancel random effects.*/
   void InitializeSeed(int seed)
   {
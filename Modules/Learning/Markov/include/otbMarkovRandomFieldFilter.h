@@ -69,6 +69,30 @@ namespace otb
  *   markovFilter->SetSampler(sampler);
  * \endcode
  *
+ * By default, sites are visited one after the other over the whole image.
+ * With UseCheckerboardUpdate on, sites are partitioned into color classes so
+ * that two sites of the same color never lie within the neighborhood radius
+ * of each other ((radius+1)^dimension colors, i.e. 4 colors for the 3x3
+ * neighborhood in 2D). Each color is then updated in parallel by the filter
+ * threads, each thread working with its own copy of the sampler and optimizer
+ * and its own random generator. The result is deterministic for a given seed
+ * and number of threads, but differs from the sequential visiting order.
+ *
+ * With UseStreaming on, the filter no longer requires the whole image: each
+ * requested region is padded by StreamingMargin pixels and regularized on
+ * its own, the margin providing the context of the tile borders. This
+ * allows processing images that do not fit in memory through a streaming
+ * writer. Streaming requires UseCheckerboardUpdate: in the sequential
+ * visiting order, a site can influence the whole image within a single
+ * iteration. In checkerboard mode, a label change travels by at most one
+ * neighborhood radius per color, so the default margin (the neighborhood
+ * radius times the number of colors times the maximum number of iterations)
+ * bounds the influence of the tile borders. Tiles still differ from the
+ * untiled result when the labels are initialized at random (the random
+ * values are drawn per tile, use SetTrainingInput() instead), when the
+ * sampler or the optimizer draws random numbers, or when ErrorTolerance
+ * stops the iterations (the stop is decided per tile).
+ *
  *
  * \ingroup Markov
  *
@@ -248,6 +272,25 @@ public:
   itkSetMacro(Lambda, double);
   itkGetMacro(Lambda, double);
 
+  /** Set/Get whether sites are updated in parallel by color classes
+   * rather than sequentially. Default is false. */
+  itkSetMacro(UseCheckerboardUpdate, bool);
+  itkGetMacro(UseCheckerboardUpdate, bool);
+  itkBooleanMacro(UseCheckerboardUpdate);
+
+  /** Set/Get whether the filter processes each requested region on its
+   * own, padded by the streaming margin, instead of the whole image.
+   * Requires UseCheckerboardUpdate. Default is false. */
+  itkSetMacro(UseStreaming, bool);
+  itkGetMacro(UseStreaming, bool);
+  itkBooleanMacro(UseStreaming);
+
+  /** Set/Get the margin added around each requested region in streaming
+   * mode. 0 (default) means the neighborhood radius times the number of
+   * colors times the maximum number of iterations. */
+  itkSetMacro(StreamingMargin, unsigned int);
+  itkGetMacro(StreamingMargin, unsigned int);
+
   /** Set the neighborhood radius */
   void SetNeighborhoodRadius(const NeighborhoodRadiusType&);
 
@@ -383,6 +426,40 @@ protected:
 
   virtual void MinimizeOnce();
 
+  /** Create the per-thread samplers, optimizers and random generators used
+   * by the checkerboard update. */
+  void InitializeCheckerboard();
+
+  /** Update all the sites once, color after color, in parallel. */
+  virtual void MinimizeOnceCheckerboard();
+
+  /** Update the sites of the current color within the given region. */
+  virtual void ThreadedMinimizeOnce(const LabelledImageRegionType& region, itk::ThreadIdType threadId);
+
+  /** Number of color classes and color of a site. */
+  unsigned int GetNumberOfColors() const;
+  unsigned int GetSiteColor(const LabelledImageIndexType& index) const;
+
+  /** Callback function to launch ThreadedMinimizeOnce in each thread */
+  static ITK_THREAD_RETURN_TYPE CheckerboardThreaderCallback(void *arg);
+
+  /** basically the same struct as itk::ImageSource::ThreadStruct */
+  struct CheckerboardThreadStruct
+    {
+      Pointer Filter;
+    };
+
+  bool         m_UseCheckerboardUpdate;
+  bool         m_UseStreaming;
+  unsigned int m_StreamingMargin;
+  unsigned int m_CurrentColor;
+
+  std::vector<SamplerPointer>               m_ThreadSamplers;
+  std::vector<OptimizerPointer>             m_ThreadOptimizers;
+  std::vector<RandomGeneratorType::Pointer> m_ThreadGenerators;
+  std::vector<int>                          m_ThreadErrorCounters;
+  std::vector<double>                       m_ThreadDeltaEnergies;
+
 private:
 
 }; // class MarkovRandomFieldFilter
@@ -23,6 +23,8 @@
 #define otbMarkovRandomFieldFilter_txx
 #include "otbMarkovRandomFieldFilter.h"
 
+#include <algorithm>
+
 namespace otb
 {
 template<class TInputImage, class TClassifiedImage>
@@ -40,7 +42,11 @@ MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
   m_NumberOfIterations(0),
   m_Lambda(1.0),
   m_ExternalClassificationSet(false),
-  m_StopCondition(MaximumNumberOfIterations)
+  m_StopCondition(MaximumNumberOfIterations),
+  m_UseCheckerboardUpdate(false),
+  m_UseStreaming(false),
+  m_StreamingMargin(0),
+  m_CurrentColor(0)
 {
   m_Generator = RandomGeneratorType::GetInstance();
   m_Generator->SetSeed();
@@ -116,6 +122,15 @@ MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
 
   os << indent << " Lambda: " <<
   m_Lambda << std::endl;
+
+  os << indent << " Use checkerboard update: " <<
+  m_UseCheckerboardUpdate << std::endl;
+
+  os << indent << " Use streaming: " <<
+  m_UseStreaming << std::endl;
+
+  os << indent << " Streaming margin: " <<
+  m_StreamingMargin << std::endl;
 } // end PrintSelf
 
 /**
@@ -132,6 +147,17 @@ MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
     const_cast<InputImageType *>(this->GetInput());
   OutputImagePointer outputPtr = this->GetOutput();
   inputPtr->SetRequestedRegion(outputPtr->GetRequestedRegion());
+
+  // the training image is read over the same region
+  if (m_ExternalClassificationSet)
+    {
+    TrainingImageType * trainingPtr =
+      const_cast<TrainingImageType *>(this->GetTrainingInput());
+    if (trainingPtr)
+      {
+      trainingPtr->SetRequestedRegion(outputPtr->GetRequestedRegion());
+      }
+    }
 }
 
 /**
@@ -142,11 +168,40 @@ void
 MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
 ::EnlargeOutputRequestedRegion(itk::DataObject *output)
 {
-  // this filter requires the all of the output image to be in
-  // the buffer
   TClassifiedImage *imgData;
   imgData = dynamic_cast<TClassifiedImage*>(output);
-  imgData->SetRequestedRegionToLargestPossibleRegion();
+
+  if (!m_UseStreaming)
+    {
+    // this filter requires the all of the output image to be in
+    // the buffer
+    imgData->SetRequestedRegionToLargestPossibleRegion();
+    return;
+    }
+
+  // In sequential mode, a site can change the labels of the whole image
+  // within one iteration: no margin bounds the influence of the borders.
+  if (!m_UseCheckerboardUpdate)
+    {
+    itkExceptionMacro(<< "UseStreaming requires UseCheckerboardUpdate");
+    }
+
+  // In streaming mode, the requested region is regularized on its own:
+  // pad it so that the sites of the region get some context. The sites
+  // of the margin are computed but not used downstream. A label change
+  // travels by at most one radius per color, i.e. radius times the number
+  // of colors per iteration.
+  LabelledImageRegionType requestedRegion = imgData->GetRequestedRegion();
+  SizeType                margin;
+  const unsigned int      numberOfColors = this->GetNumberOfColors();
+  for (unsigned int i = 0; i < InputImageDimension; ++i)
+    {
+    margin[i] = m_StreamingMargin > 0 ? m_StreamingMargin
+                : m_LabelledImageNeighborhoodRadius[i] * numberOfColors * m_MaximumNumberOfIterations;
+    }
+  requestedRegion.PadByRadius(margin);
+  requestedRegion.Crop(imgData->GetLargestPossibleRegion());
+  imgData->SetRequestedRegion(requestedRegion);
 }
 
 /**
@@ -176,6 +231,11 @@ MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
   //Branch the pipeline
   this->Initialize();
 
+  if (m_UseCheckerboardUpdate)
+    {
+    this->InitializeCheckerboard();
+    }
+
   //Run the Markov random field
   this->ApplyMarkovRandomFieldFilter();
 
@@ -405,12 +465,20 @@ void
 MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
 ::MinimizeOnce()
 {
+  if (m_UseCheckerboardUpdate)
+    {
+    this->MinimizeOnceCheckerboard();
+    return;
+    }
+
+  // The requested region is the largest possible region, unless in
+  // streaming mode
   LabelledImageNeighborhoodIterator
   labelledIterator(m_LabelledImageNeighborhoodRadius, this->GetOutput(),
-                   this->GetOutput()->GetLargestPossibleRegion());
+                   this->GetOutput()->GetRequestedRegion());
   InputImageNeighborhoodIterator
   dataIterator(m_InputImageNeighborhoodRadius, this->GetInput(),
-               this->GetInput()->GetLargestPossibleRegion());
+               this->GetOutput()->GetRequestedRegion());
   m_ErrorCounter = 0;
 
   for (labelledIterator.GoToBegin(), dataIterator.GoToBegin();
@@ -433,6 +501,182 @@ MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
 
 }
 
+/**
+* Create one sampler, optimizer and random generator per thread
+*/
+template<class TInputImage, class TClassifiedImage>
+void
+MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
+::InitializeCheckerboard()
+{
+  const itk::ThreadIdType numberOfThreads = this->GetNumberOfThreads();
+
+  m_ThreadSamplers.resize(numberOfThreads);
+  m_ThreadOptimizers.resize(numberOfThreads);
+  m_ThreadGenerators.resize(numberOfThreads);
+  m_ThreadErrorCounters.resize(numberOfThreads);
+  m_ThreadDeltaEnergies.resize(numberOfThreads);
+
+  for (itk::ThreadIdType threadId = 0; threadId < numberOfThreads; ++threadId)
+    {
+    SamplerPointer sampler =
+      dynamic_cast<SamplerType *>(m_Sampler->CreateAnother().GetPointer());
+    OptimizerPointer optimizer =
+      dynamic_cast<OptimizerType *>(m_Optimizer->CreateAnother().GetPointer());
+    if (sampler.IsNull() || optimizer.IsNull())
+      {
+      itkExceptionMacro(<< "Sampler and optimizer must be instantiable to use the checkerboard update");
+      }
+
+    // Seeds are drawn from the filter generator, so that InitializeSeed()
+    // still makes the result reproducible
+    RandomGeneratorType::Pointer generator = RandomGeneratorType::New();
+    generator->SetSeed(m_Generator->GetIntegerVariate());
+
+    sampler->SetLambda(m_Lambda);
+    sampler->SetEnergyRegularization(m_EnergyRegularization);
+    sampler->SetEnergyFidelity(m_EnergyFidelity);
+    sampler->SetNumberOfClasses(m_NumberOfClasses);
+    sampler->SetRandomGenerator(generator);
+
+    optimizer->SetParameters(m_Optimizer->GetParameters());
+    optimizer->SetRandomGenerator(generator);
+
+    m_ThreadSamplers[threadId] = sampler;
+    m_ThreadOptimizers[threadId] = optimizer;
+    m_ThreadGenerators[threadId] = generator;
+    }
+}
+
+template<class TInputImage, class TClassifiedImage>
+unsigned int
+MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
+::GetNumberOfColors() const
+{
+  unsigned int numberOfColors = 1;
+  for (unsigned int i = 0; i < InputImageDimension; ++i)
+    {
+    numberOfColors *= m_LabelledImageNeighborhoodRadius[i] + 1;
+    }
+  return numberOfColors;
+}
+
+template<class TInputImage, class TClassifiedImage>
+unsigned int
+MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
+::GetSiteColor(const LabelledImageIndexType& index) const
+{
+  // Sites whose coordinates are congruent modulo (radius+1) along every
+  // dimension share a color: they never lie in each other's neighborhood.
+  unsigned int color = 0;
+  unsigned int stride = 1;
+  for (unsigned int i = 0; i < InputImageDimension; ++i)
+    {
+    const IndexValueType period = m_LabelledImageNeighborhoodRadius[i] + 1;
+    IndexValueType       coordinate = index[i] % period;
+    if (coordinate < 0)
+      {
+      coordinate += period;
+      }
+    color += static_cast<unsigned int>(coordinate) * stride;
+    stride *= static_cast<unsigned int>(period);
+    }
+  return color;
+}
+
+/**
+*Apply the MRF image filter on the whole image once, one color at a time
+*/
+template<class TInputImage, class TClassifiedImage>
+void
+MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
+::MinimizeOnceCheckerboard()
+{
+  std::fill(m_ThreadErrorCounters.begin(), m_ThreadErrorCounters.end(), 0);
+  std::fill(m_ThreadDeltaEnergies.begin(), m_ThreadDeltaEnergies.end(), 0.0);
+
+  CheckerboardThreadStruct str;
+  str.Filter = this;
+
+  this->GetMultiThreader()->SetNumberOfThreads(this->GetNumberOfThreads());
+  this->GetMultiThreader()->SetSingleMethod(this->CheckerboardThreaderCallback, &str);
+
+  // Sites of one color are independent given the others: all threads
+  // update them at once, colors are processed one after the other.
+  const unsigned int numberOfColors = this->GetNumberOfColors();
+  for (m_CurrentColor = 0; m_CurrentColor < numberOfColors; ++m_CurrentColor)
+    {
+    this->GetMultiThreader()->SingleMethodExecute();
+    }
+
+  m_ErrorCounter = 0;
+  for (unsigned int threadId = 0; threadId < m_ThreadErrorCounters.size(); ++threadId)
+    {
+    m_ErrorCounter += m_ThreadErrorCounters[threadId];
+    m_ImageDeltaEnergy += m_ThreadDeltaEnergies[threadId];
+    }
+}
+
+template<class TInputImage, class TClassifiedImage>
+void
+MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
+::ThreadedMinimizeOnce(const LabelledImageRegionType& region, itk::ThreadIdType threadId)
+{
+  SamplerType *   sampler = m_ThreadSamplers[threadId];
+  OptimizerType * optimizer = m_ThreadOptimizers[threadId];
+
+  LabelledImageNeighborhoodIterator
+  labelledIterator(m_LabelledImageNeighborhoodRadius, this->GetOutput(), region);
+  InputImageNeighborhoodIterator
+  dataIterator(m_InputImageNeighborhoodRadius, this->GetInput(), region);
+
+  int    errorCounter = 0;
+  double deltaEnergy = 0.0;
+
+  for (labelledIterator.GoToBegin(), dataIterator.GoToBegin();
+       !labelledIterator.IsAtEnd();
+       ++labelledIterator, ++dataIterator)
+    {
+    if (this->GetSiteColor(labelledIterator.GetIndex()) != m_CurrentColor)
+      {
+      continue;
+      }
+
+    sampler->Compute(dataIterator, labelledIterator);
+    if (optimizer->Compute(sampler->GetDeltaEnergy()))
+      {
+      labelledIterator.SetCenterPixel(sampler->GetValue());
+      ++errorCounter;
+      deltaEnergy += sampler->GetDeltaEnergy();
+      }
+    }
+
+  m_ThreadErrorCounters[threadId] += errorCounter;
+  m_ThreadDeltaEnergies[threadId] += deltaEnergy;
+}
+
+template<class TInputImage, class TClassifiedImage>
+ITK_THREAD_RETURN_TYPE
+MarkovRandomFieldFilter<TInputImage, TClassifiedImage>
+::CheckerboardThreaderCallback(void *arg)
+{
+  CheckerboardThreadStruct *str =
+    (CheckerboardThreadStruct*)(((itk::MultiThreader::ThreadInfoStruct *)(arg))->UserData);
+
+  itk::ThreadIdType threadId = ((itk::MultiThreader::ThreadInfoStruct *)(arg))->ThreadID;
+  itk::ThreadIdType threadCount = ((itk::MultiThreader::ThreadInfoStruct *)(arg))->NumberOfThreads;
+
+  LabelledImageRegionType splitRegion;
+  itk::ThreadIdType total = str->Filter->SplitRequestedRegion(threadId, threadCount, splitRegion);
+
+  if (threadId < total)
+    {
+    str->Filter->ThreadedMinimizeOnce(splitRegion, threadId);
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
 } // namespace otb
 
 #endif
@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+
+#include "otbImageFileReader.h"
+#include "otbImageFileWriter.h"
+#include "otbImage.h"
+#include "otbMarkovRandomFieldFilter.h"
+#include "itkImageRegionConstIterator.h"
+
+#include "otbMRFEnergyPotts.h"
+#include "otbMRFEnergyGaussianClassification.h"
+#include "otbMRFOptimizerICM.h"
+#include "otbMRFSamplerMAP.h"
+
+const unsigned int Dimension = 2;
+
+typedef double                                   InternalPixelType;
+typedef unsigned char                            LabelledPixelType;
+typedef otb::Image<InternalPixelType, Dimension> InputImageType;
+typedef otb::Image<LabelledPixelType, Dimension> LabelledImageType;
+
+typedef otb::MarkovRandomFieldFilter<InputImageType, LabelledImageType>         MarkovRandomFieldFilterType;
+typedef otb::MRFSamplerMAP<InputImageType, LabelledImageType>                   SamplerType;
+typedef otb::MRFOptimizerICM                                                    OptimizerType;
+typedef otb::MRFEnergyPotts<LabelledImageType, LabelledImageType>               EnergyRegularizationType;
+typedef otb::MRFEnergyGaussianClassification<InputImageType, LabelledImageType> EnergyFidelityType;
+
+MarkovRandomFieldFilterType::Pointer
+CreateCheckerboardMarkovFilter(InputImageType * input, LabelledImageType * initialLabels,
+                               double lambda, unsigned int iterations)
+{
+  MarkovRandomFieldFilterType::Pointer markovFilter         = MarkovRandomFieldFilterType::New();
+  EnergyRegularizationType::Pointer    energyRegularization = EnergyRegularizationType::New();
+  EnergyFidelityType::Pointer          energyFidelity       = EnergyFidelityType::New();
+  OptimizerType::Pointer               optimizer            = OptimizerType::New();
+  SamplerType::Pointer                 sampler              = SamplerType::New();
+
+  unsigned int nClass = 4;
+  energyFidelity->SetNumberOfParameters(2 * nClass);
+  EnergyFidelityType::ParametersType parameters;
+  parameters.SetSize(energyFidelity->GetNumberOfParameters());
+  parameters[0] = 10.0; //Class 0 mean
+  parameters[1] = 10.0; //Class 0 stdev
+  parameters[2] = 80.0; //Class 1 mean
+  parameters[3] = 10.0; //Class 1 stdev
+  parameters[4] = 150.0; //Class 2 mean
+  parameters[5] = 10.0; //Class 2 stdev
+  parameters[6] = 220.0; //Class 3 mean
+  parameters[7] = 10.0; //Class 3 stde
+  energyFidelity->SetParameters(parameters);
+
+  markovFilter->SetNumberOfClasses(nClass);
+  markovFilter->SetMaximumNumberOfIterations(iterations);
+  markovFilter->SetErrorTolerance(0.0);
+  markovFilter->SetLambda(lambda);
+  markovFilter->SetNeighborhoodRadius(1);
+  markovFilter->UseCheckerboardUpdateOn();
+  markovFilter->InitializeSeed(2);
+
+  markovFilter->SetEnergyRegularization(energyRegularization);
+  markovFilter->SetEnergyFidelity(energyFidelity);
+  markovFilter->SetOptimizer(optimizer);
+  markovFilter->SetSampler(sampler);
+
+  markovFilter->SetInput(input);
+  markovFilter->SetTrainingInput(initialLabels);
+
+  return markovFilter;
+}
+
+int otbMarkovRandomFieldFilterCheckerboard(int itkNotUsed(argc), char* argv[])
+{
+  typedef otb::ImageFileReader<InputImageType>    ReaderType;
+  typedef otb::ImageFileWriter<LabelledImageType> WriterType;
+
+  const char * inputFilename  = argv[1];
+  const char * outputFilename = argv[2];
+  const char * streamedOutputFilename = argv[3];
+  const char * defaultMarginOutputFilename = argv[4];
+  double       lambda = atof(argv[5]);
+  unsigned int iterations = atoi(argv[6]);
+
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(inputFilename);
+  reader->Update();
+
+  // Deterministic initial labels, so that the streamed regularization
+  // does not depend on the random values drawn for each tile
+  LabelledImageType::Pointer initialLabels = LabelledImageType::New();
+  initialLabels->CopyInformation(reader->GetOutput());
+  initialLabels->SetRegions(reader->GetOutput()->GetLargestPossibleRegion());
+  initialLabels->Allocate();
+  initialLabels->FillBuffer(0);
+
+  // With MAP sampling and ICM, sites of one color do not depend on each
+  // other: the result must not depend on the number of threads.
+  MarkovRandomFieldFilterType::Pointer singleThreadFilter =
+    CreateCheckerboardMarkovFilter(reader->GetOutput(), initialLabels, lambda, iterations);
+  singleThreadFilter->SetNumberOfThreads(1);
+  singleThreadFilter->Update();
+
+  MarkovRandomFieldFilterType::Pointer multiThreadFilter =
+    CreateCheckerboardMarkovFilter(reader->GetOutput(), initialLabels, lambda, iterations);
+  multiThreadFilter->SetNumberOfThreads(4);
+  multiThreadFilter->Update();
+
+  typedef itk::ImageRegionConstIterator<LabelledImageType> IteratorType;
+  IteratorType singleIt(singleThreadFilter->GetOutput(),
+                        singleThreadFilter->GetOutput()->GetLargestPossibleRegion());
+  IteratorType multiIt(multiThreadFilter->GetOutput(),
+                       multiThreadFilter->GetOutput()->GetLargestPossibleRegion());
+  for (singleIt.GoToBegin(), multiIt.GoToBegin(); !singleIt.IsAtEnd(); ++singleIt, ++multiIt)
+    {
+    if (singleIt.Get() != multiIt.Get())
+      {
+      std::cerr << "Checkerboard update differs between 1 and 4 threads at index "
+                << singleIt.GetIndex() << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName(outputFilename);
+  writer->SetInput(multiThreadFilter->GetOutput());
+  writer->Update();
+
+  // Streamed processing of the same regularization. Within an iteration,
+  // a label change can travel by one radius per color: with a margin
+  // covering all the sweeps, tiles give the same labels as the whole image.
+  // Radius is 1, hence (1 + 1)^2 colors.
+  const unsigned int numberOfColors = 4;
+  MarkovRandomFieldFilterType::Pointer streamingFilter =
+    CreateCheckerboardMarkovFilter(reader->GetOutput(), initialLabels, lambda, iterations);
+  streamingFilter->UseStreamingOn();
+  streamingFilter->SetStreamingMargin(numberOfColors * iterations + 1);
+
+  WriterType::Pointer streamingWriter = WriterType::New();
+  streamingWriter->SetFileName(streamedOutputFilename);
+  streamingWriter->SetInput(streamingFilter->GetOutput());
+  streamingWriter->SetNumberOfDivisionsStrippedStreaming(4);
+  streamingWriter->Update();
+
+  // Same with the default margin (radius * colors * iterations), and
+  // another split of the image
+  MarkovRandomFieldFilterType::Pointer defaultMarginFilter =
+    CreateCheckerboardMarkovFilter(reader->GetOutput(), initialLabels, lambda, iterations);
+  defaultMarginFilter->UseStreamingOn();
+
+  WriterType::Pointer defaultMarginWriter = WriterType::New();
+  defaultMarginWriter->SetFileName(defaultMarginOutputFilename);
+  defaultMarginWriter->SetInput(defaultMarginFilter->GetOutput());
+  defaultMarginWriter->SetNumberOfDivisionsStrippedStreaming(7);
+  defaultMarginWriter->Update();
+
+  // Streaming is refused in the sequential visiting order
+  MarkovRandomFieldFilterType::Pointer sequentialFilter =
+    CreateCheckerboardMarkovFilter(reader->GetOutput(), initialLabels, lambda, iterations);
+  sequentialFilter->UseCheckerboardUpdateOff();
+  sequentialFilter->UseStreamingOn();
+  try
+    {
+    sequentialFilter->Update();
+    std::cerr << "Streaming should be refused without checkerboard update" << std::endl;
+    return EXIT_FAILURE;
+    }
+  catch (itk::ExceptionObject &)
+    {
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -28,6 +28,7 @@ void RegisterTests()
   REGISTER_TEST(otbMRFEnergyPottsNew);
   REGISTER_TEST(otbMRFSamplerMAPNew);
   REGISTER_TEST(otbMarkovRandomFieldFilter);
+  REGISTER_TEST(otbMarkovRandomFieldFilterCheckerboard);
   REGISTER_TEST(otbMRFSamplerRandomMAPNew);
   REGISTER_TEST(otbMRFSamplerRandomNew);
   REGISTER_TEST(otbMRFEnergyGaussianNew);
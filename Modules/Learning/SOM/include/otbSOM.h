@@ -24,10 +24,13 @@
 
 #include "itkImageToImageFilter.h"
 #include "itkEuclideanDistanceMetric.h"
+#include "itkMultiThreader.h"
 
 #include "otbCzihoSOMLearningBehaviorFunctor.h"
 #include "otbCzihoSOMNeighborhoodBehaviorFunctor.h"
 
+#include <vector>
+
 namespace otb
 {
 /**
@@ -48,6 +51,14 @@ namespace otb
  * The SOMMap produced as output can be either initialized with a constant custom value or randomly
  * generated following a normal law. The seed for the random initialization can be modified.
  *
+ * In batch mode (BatchMode on), the map is not updated after each sample. At each iteration,
+ * the samples are split in chunks processed by several threads, which search the winner of
+ * each sample on the map of the previous iteration, and accumulate the samples weighted by
+ * the neighborhood coefficient of each neuron. Each neuron then moves towards the weighted
+ * mean of its samples, by the learning coefficient. The samples are always split in the same
+ * chunks, whose sums are merged in a fixed order, so that the result does not depend on the
+ * number of threads. Subclasses redefining UpdateMap() are only affected in sequential mode.
+ *
  * \sa SOMMap
  * \sa SOMActivationBuilder
  * \sa CzihoSOMLearningBehaviorFunctor
@@ -110,6 +121,10 @@ public:
   itkGetMacro(Seed, unsigned int);
   itkGetObjectMacro(ListSample, ListSampleType);
   itkSetObjectMacro(ListSample, ListSampleType);
+  /** Set/Get the batch training mode (default is off) */
+  itkSetMacro(BatchMode, bool);
+  itkGetMacro(BatchMode, bool);
+  itkBooleanMacro(BatchMode);
 
   void SetBetaFunctor(const SOMLearningBehaviorFunctorType& functor)
   {
@@ -143,6 +158,16 @@ protected:
    * Step one iteration.
    */
   virtual void Step(unsigned int currentIteration);
+  /**
+   * Update the output map with all the samples at once (batch mode).
+   * \param beta The learning coefficient,
+   * \param radius The radius of the neighbourhood.
+   */
+  virtual void BatchUpdateMap(double beta, const SizeType& radius);
+  /** Accumulate the samples of a chunk in the accumulators of this chunk */
+  void AccumulateSamples(itk::SizeValueType chunk, itk::SizeValueType nbChunks);
+  /** Static function used as a "callback" by the MultiThreader */
+  static ITK_THREAD_RETURN_TYPE BatchThreaderCallback(void *arg);
   /** PrintSelf method */
   void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
 
@@ -173,6 +198,14 @@ private:
   SOMLearningBehaviorFunctorType m_BetaFunctor;
   /** Behavior of the Neighborhood extent */
   SOMNeighborhoodBehaviorFunctorType m_NeighborhoodSizeFunctor;
+  /** Batch training mode */
+  bool m_BatchMode;
+  /** Neighborhood radius of the current batch iteration */
+  SizeType m_BatchRadius;
+  /** Per chunk sums of the weighted samples, one neuron after the other */
+  std::vector<std::vector<double> > m_BatchSums;
+  /** Per chunk sums of the neighborhood coefficients of each neuron */
+  std::vector<std::vector<double> > m_BatchWeights;
 
 };
 } // end namespace otb
@@ -24,11 +24,14 @@
 
 #include "otbSOM.h"
 #include "itkImageRegionIteratorWithIndex.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkFixedArray.h"
 #include "otbMacro.h"
 #include "itkImageRegionIterator.h"
 #include "itkMersenneTwisterRandomVariateGenerator.h"
 
+#include <algorithm>
+
 namespace otb
 {
 /**
@@ -52,6 +55,8 @@ SOM<TListSample, TMap, TSOMLearningBehaviorFunctor, TSOMNeighborhoodBehaviorFunc
   m_MaxWeight = static_cast<ValueType>(128.0);
   m_RandomInit = false;
   m_Seed = 123574651;
+  m_BatchMode = false;
+  m_BatchRadius.Fill(0);
 }
 /**
  * Destructor
@@ -148,8 +153,14 @@ SOM<TListSample, TMap, TSOMLearningBehaviorFunctor, TSOMNeighborhoodBehaviorFunc
   SizeType newSize = m_NeighborhoodSizeFunctor(
     currentIteration, m_NumberOfIterations, m_NeighborhoodSizeInit);
 
-  // update the neurons map with each example of the training set.
   otbMsgDebugMacro(<< "Beta: " << newBeta << ", radius: " << newSize);
+  if (m_BatchMode)
+    {
+    BatchUpdateMap(newBeta, newSize);
+    return;
+    }
+
+  // update the neurons map with each example of the training set.
   for (typename ListSampleType::Iterator it = m_ListSample->Begin();
        it != m_ListSample->End();
        ++it)
@@ -157,6 +168,148 @@ SOM<TListSample, TMap, TSOMLearningBehaviorFunctor, TSOMNeighborhoodBehaviorFunc
     UpdateMap(it.GetMeasurementVector(), newBeta, newSize);
     }
 }
+/**
+ * Accumulate the samples of a chunk in the accumulators of this chunk.
+ */
+template <class TListSample, class TMap,
+    class TSOMLearningBehaviorFunctor,
+    class TSOMNeighborhoodBehaviorFunctor>
+void
+SOM<TListSample, TMap, TSOMLearningBehaviorFunctor, TSOMNeighborhoodBehaviorFunctor>
+::AccumulateSamples(itk::SizeValueType chunk, itk::SizeValueType nbChunks)
+{
+  typedef itk::ImageRegionConstIteratorWithIndex<MapType> IteratorType;
+
+  MapType * map = this->GetOutput(0);
+  const unsigned int nbComponents = map->GetNumberOfComponentsPerPixel();
+  const RegionType   mapRegion = map->GetLargestPossibleRegion();
+
+  std::vector<double> & sums = m_BatchSums[chunk];
+  std::vector<double> & weights = m_BatchWeights[chunk];
+
+  // Contiguous samples of this chunk
+  const itk::SizeValueType nbSamples = m_ListSample->Size();
+  const itk::SizeValueType first = nbSamples * chunk / nbChunks;
+  const itk::SizeValueType last = nbSamples * (chunk + 1) / nbChunks;
+
+  for (itk::SizeValueType id = first; id < last; ++id)
+    {
+    const NeuronType & sample = m_ListSample->GetMeasurementVector(id);
+    const IndexType position = map->GetWinner(sample);
+
+    // Local neighborhood definition, as in UpdateMap()
+    RegionType localRegion;
+    SizeType   localSize;
+    for (unsigned int i = 0; i < MapDimension; ++i)
+      {
+      localSize[i] = 2 * m_BatchRadius[i] + 1;
+      }
+    localRegion.SetIndex(position - m_BatchRadius);
+    localRegion.SetSize(localSize);
+    localRegion.Crop(mapRegion);
+
+    for (IteratorType it(map, localRegion); !it.IsAtEnd(); ++it)
+      {
+      double sqGridDistance = 0.;
+      for (unsigned int i = 0; i < MapDimension; ++i)
+        {
+        const double d = static_cast<double>(it.GetIndex()[i] - position[i]);
+        sqGridDistance += d * d;
+        }
+      const double weight = 1. / (1. + vcl_sqrt(sqGridDistance));
+
+      const itk::OffsetValueType offset = map->ComputeOffset(it.GetIndex());
+      double * sum = &sums[offset * nbComponents];
+      for (unsigned int c = 0; c < nbComponents; ++c)
+        {
+        sum[c] += weight * static_cast<double>(sample[c]);
+        }
+      weights[offset] += weight;
+      }
+    }
+}
+
+template <class TListSample, class TMap,
+    class TSOMLearningBehaviorFunctor,
+    class TSOMNeighborhoodBehaviorFunctor>
+ITK_THREAD_RETURN_TYPE
+SOM<TListSample, TMap, TSOMLearningBehaviorFunctor, TSOMNeighborhoodBehaviorFunctor>
+::BatchThreaderCallback(void *arg)
+{
+  itk::MultiThreader::ThreadInfoStruct* info = static_cast<itk::MultiThreader::ThreadInfoStruct*>(arg);
+  Self* self = static_cast<Self*>(info->UserData);
+
+  // The chunks are given to the threads in turn
+  const itk::SizeValueType nbChunks = self->m_BatchSums.size();
+  for (itk::SizeValueType chunk = info->ThreadID; chunk < nbChunks; chunk += info->NumberOfThreads)
+    {
+    self->AccumulateSamples(chunk, nbChunks);
+    }
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+/**
+ * Update the output map with all the samples at once (batch mode).
+ * \param beta The learning coefficient,
+ * \param radius The radius of the neighbourhood.
+ */
+template <class TListSample, class TMap,
+    class TSOMLearningBehaviorFunctor,
+    class TSOMNeighborhoodBehaviorFunctor>
+void
+SOM<TListSample, TMap, TSOMLearningBehaviorFunctor, TSOMNeighborhoodBehaviorFunctor>
+::BatchUpdateMap(double beta, const SizeType& radius)
+{
+  MapType * map = this->GetOutput(0);
+  const unsigned int       nbComponents = map->GetNumberOfComponentsPerPixel();
+  const itk::SizeValueType nbNeurons = map->GetLargestPossibleRegion().GetNumberOfPixels();
+
+  // The split of the samples does not depend on the number of threads,
+  // so that the sums are the same whatever the threads
+  const itk::SizeValueType nbChunks = std::max<itk::SizeValueType>(
+    1, std::min<itk::SizeValueType>(16, m_ListSample->Size()));
+  const itk::ThreadIdType nbThreads = static_cast<itk::ThreadIdType>(
+    std::min<itk::SizeValueType>(this->GetNumberOfThreads(), nbChunks));
+
+  m_BatchRadius = radius;
+  m_BatchSums.assign(nbChunks, std::vector<double>(nbNeurons * nbComponents, 0.));
+  m_BatchWeights.assign(nbChunks, std::vector<double>(nbNeurons, 0.));
+
+  this->GetMultiThreader()->SetNumberOfThreads(nbThreads);
+  this->GetMultiThreader()->SetSingleMethod(this->BatchThreaderCallback, this);
+  this->GetMultiThreader()->SingleMethodExecute();
+
+  // Merge the chunks accumulators, in a fixed order, and move each
+  // neuron towards the weighted mean of its samples
+  typename MapType::InternalPixelType * neuron = map->GetBufferPointer();
+  for (itk::SizeValueType n = 0; n < nbNeurons; ++n, neuron += nbComponents)
+    {
+    double weight = 0.;
+    for (itk::SizeValueType t = 0; t < nbChunks; ++t)
+      {
+      weight += m_BatchWeights[t][n];
+      }
+    if (weight <= 0.)
+      {
+      continue;
+      }
+    for (unsigned int c = 0; c < nbComponents; ++c)
+      {
+      double sum = 0.;
+      for (itk::SizeValueType t = 0; t < nbChunks; ++t)
+        {
+        sum += m_BatchSums[t][n * nbComponents + c];
+        }
+      const double current = static_cast<double>(neuron[c]);
+      neuron[c] = static_cast<typename MapType::InternalPixelType>(current + beta * (sum / weight - current));
+      }
+    }
+
+  m_BatchSums.clear();
+  m_BatchWeights.clear();
+  map->Modified();
+}
+
 /**
  *  Output information redefinition
  */
@@ -261,6 +414,7 @@ SOM<TListSample, TMap, TSOMLearningBehaviorFunctor, TSOMNeighborhoodBehaviorFunc
 ::PrintSelf(std::ostream& os, itk::Indent indent) const
 {
   Superclass::PrintSelf(os, indent);
+  os << indent << "Batch mode: " << (m_BatchMode ? "On" : "Off") << std::endl;
 }
 
 } // end namespace otb
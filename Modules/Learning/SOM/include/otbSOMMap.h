@@ -28,6 +28,26 @@
 
 namespace otb
 {
+/** \class SOMMapDistanceTraits
+ * \brief Tell whether the distance of a SOMMap is the euclidean distance
+ *
+ * For the euclidean distance, SOMMap searches the winning neuron
+ * directly in the weights buffer, with squared distances.
+ *
+ * \ingroup OTBSOM
+ */
+template <class TDistance>
+struct SOMMapDistanceTraits
+{
+  static const bool IsEuclidean = false;
+};
+
+template <class TVector>
+struct SOMMapDistanceTraits<itk::Statistics::EuclideanDistanceMetric<TVector> >
+{
+  static const bool IsEuclidean = true;
+};
+
 /**
  * \class SOMMap
  * \brief This class represent a Self Organizing Map.
@@ -43,6 +63,14 @@ namespace otb
  * The training is done via the SOM class, and the activation map can be produced with the SOMActivationBuilder
  * class.
  *
+ * With the euclidean distance, the search of the winning neuron reads the
+ * neuron weights in the pixel buffer, where they are stored one neuron
+ * after the other. Squared distances are accumulated by blocks of 4
+ * components, and a neuron is discarded as soon as its partial distance
+ * exceeds the best one. Squared distances are compared instead of the
+ * distances, so a neuron at the same distance as the best one up to
+ * rounding may win in place of the one the distance metric picks.
+ *
  * \sa SOM
  * \sa SOMActivationBuilder
  *
@@ -88,6 +116,15 @@ public:
    */
   IndexType GetWinner(const NeuronType& sample);
 
+  /**
+   * Get the index of the winning neuron for a sample, with the euclidean
+   * distance, whatever the distance of the map.
+   * \param sample the sample.
+   * \param sqDistance the squared distance of the sample to the winner.
+   * \return The index of the winning neuron.
+   */
+  IndexType GetEuclideanWinner(const NeuronType& sample, double& sqDistance) const;
+
 protected:
   /** Constructor */
   SOMMap();
@@ -24,6 +24,9 @@
 
 #include "otbSOMMap.h"
 #include "itkImageRegionIteratorWithIndex.h"
+#include "itkNumericTraits.h"
+
+#include <vector>
 
 namespace otb
 {
@@ -52,6 +55,12 @@ typename SOMMap<TNeuron, TDistance, VMapDimension>
 SOMMap<TNeuron, TDistance, VMapDimension>
 ::GetWinner(const NeuronType& sample)
 {
+  if (SOMMapDistanceTraits<DistanceType>::IsEuclidean)
+    {
+    double sqDistance;
+    return this->GetEuclideanWinner(sample, sqDistance);
+    }
+
   // Some typedefs
   typedef itk::ImageRegionIteratorWithIndex<Self> IteratorType;
 
@@ -80,6 +89,70 @@ SOMMap<TNeuron, TDistance, VMapDimension>
   // Return the index of the winner
   return minPos;
 }
+/**
+ * Get the index of the winning neuron for a sample, with the euclidean distance.
+ * \param sample The sample
+ * \param sqDistance The squared distance of the sample to the winner
+ * \return The index of the winning neuron.
+ */
+template <class TNeuron, class TDistance, unsigned int VMapDimension>
+typename SOMMap<TNeuron, TDistance, VMapDimension>
+::IndexType
+SOMMap<TNeuron, TDistance, VMapDimension>
+::GetEuclideanWinner(const NeuronType& sample, double& sqDistance) const
+{
+  typedef typename Superclass::InternalPixelType WeightType;
+
+  const unsigned int nbComponents = this->GetNumberOfComponentsPerPixel();
+  const unsigned int nbBlockComponents = nbComponents - nbComponents % 4;
+  const itk::SizeValueType nbNeurons = this->GetBufferedRegion().GetNumberOfPixels();
+
+  // Copy the sample once, to read it as a plain array
+  std::vector<double> values(nbComponents);
+  for (unsigned int c = 0; c < nbComponents; ++c)
+    {
+    values[c] = static_cast<double>(sample[c]);
+    }
+
+  itk::SizeValueType winner = 0;
+  sqDistance = itk::NumericTraits<double>::max();
+
+  // Exact ties are given to the last neuron, as with the distance metric
+  const WeightType * neuron = this->GetBufferPointer();
+  for (itk::SizeValueType n = 0; n < nbNeurons; ++n, neuron += nbComponents)
+    {
+    double       dist = 0.;
+    unsigned int c = 0;
+    for (; c < nbBlockComponents && dist <= sqDistance; c += 4)
+      {
+      const double d0 = values[c] - static_cast<double>(neuron[c]);
+      const double d1 = values[c + 1] - static_cast<double>(neuron[c + 1]);
+      const double d2 = values[c + 2] - static_cast<double>(neuron[c + 2]);
+      const double d3 = values[c + 3] - static_cast<double>(neuron[c + 3]);
+      dist += d0 * d0;
+      dist += d1 * d1;
+      dist += d2 * d2;
+      dist += d3 * d3;
+      }
+    if (dist > sqDistance)
+      {
+      continue;
+      }
+    for (; c < nbComponents; ++c)
+      {
+      const double d = values[c] - static_cast<double>(neuron[c]);
+      dist += d * d;
+      }
+    if (dist <= sqDistance)
+      {
+      sqDistance = dist;
+      winner = n;
+      }
+    }
+
+  return this->ComputeIndex(static_cast<typename Superclass::OffsetValueType>(winner));
+}
+
 template <class TNeuron, class TDistance, unsigned int VMapDimension>
 void
 SOMMap<TNeuron, TDistance, VMapDimension>
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+
+#include "otbSOMMap.h"
+#include "otbSOM.h"
+#include "itkListSample.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "vnl/vnl_math.h"
+
+int otbSOMBatch(int itkNotUsed(argc), char* itkNotUsed(argv) [])
+{
+  const unsigned int Dimension = 2;
+  typedef double                                              ComponentType;
+  typedef itk::VariableLengthVector<ComponentType>            PixelType;
+  typedef itk::Statistics::EuclideanDistanceMetric<PixelType> DistanceType;
+  typedef otb::SOMMap<PixelType, DistanceType, Dimension>     MapType;
+  typedef itk::Statistics::ListSample<PixelType>              ListSampleType;
+  typedef otb::SOM<ListSampleType, MapType>                   SOMType;
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator GeneratorType;
+
+  // 7 components, to test both the blocks of 4 components and the remainder
+  const unsigned int nbComponents = 7;
+  const unsigned int nbClusters = 4;
+  const unsigned int nbSamplesPerCluster = 500;
+
+  GeneratorType::Pointer generator = GeneratorType::New();
+  generator->Initialize(12345);
+
+  ListSampleType::Pointer listSample = ListSampleType::New();
+  listSample->SetMeasurementVectorSize(nbComponents);
+  PixelType sample(nbComponents);
+  for (unsigned int k = 0; k < nbClusters; ++k)
+    {
+    for (unsigned int i = 0; i < nbSamplesPerCluster; ++i)
+      {
+      for (unsigned int c = 0; c < nbComponents; ++c)
+        {
+        sample[c] = 100. * ((k + c) % nbClusters) + generator->GetNormalVariate(0., 4.);
+        }
+      listSample->PushBack(sample);
+      }
+    }
+
+  SOMType::Pointer som = SOMType::New();
+  som->SetListSample(listSample);
+  SOMType::SizeType size;
+  size.Fill(6);
+  som->SetMapSize(size);
+  SOMType::SizeType radius;
+  radius.Fill(3);
+  som->SetNeighborhoodSizeInit(radius);
+  som->SetNumberOfIterations(10);
+  som->SetBetaInit(1.0);
+  som->SetBetaEnd(0.5);
+  som->SetMinWeight(0.);
+  som->SetMaxWeight(300.);
+  som->SetRandomInit(true);
+  som->BatchModeOn();
+  som->Update();
+
+  MapType::Pointer map = som->GetOutput();
+  DistanceType::Pointer distance = DistanceType::New();
+
+  // The winner search on the buffer gives a neuron at the smallest
+  // distance, up to rounding, and every cluster is close to a neuron
+  double maxDistance = 0.;
+  for (unsigned int id = 0; id < listSample->Size(); ++id)
+    {
+    const PixelType & current = listSample->GetMeasurementVector(id);
+
+    MapType::IndexType expected;
+    double             minDistance = itk::NumericTraits<double>::max();
+    itk::ImageRegionConstIteratorWithIndex<MapType> it(map, map->GetLargestPossibleRegion());
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+      {
+      const double d = distance->Evaluate(current, it.Get());
+      if (d <= minDistance)
+        {
+        minDistance = d;
+        expected = it.GetIndex();
+        }
+      }
+
+    double sqDistance;
+    const MapType::IndexType winner = map->GetEuclideanWinner(current, sqDistance);
+    if (winner != map->GetWinner(current)
+        || vnl_math_abs(distance->Evaluate(current, map->GetPixel(winner)) - minDistance) > 1e-9)
+      {
+      std::cerr << "Winner " << winner << " of sample " << id << " instead of " << expected << std::endl;
+      return EXIT_FAILURE;
+      }
+    if (vnl_math_abs(vcl_sqrt(sqDistance) - minDistance) > 1e-9)
+      {
+      std::cerr << "Wrong distance for sample " << id << std::endl;
+      return EXIT_FAILURE;
+      }
+    maxDistance = std::max(maxDistance, minDistance);
+    }
+
+  std::cout << "Largest distance of a sample to its winner: " << maxDistance << std::endl;
+
+  // The noise has a standard deviation of 4 on 7 components
+  if (maxDistance > 50.)
+    {
+    std::cerr << "The map does not fit the clusters" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // The same training on a single thread gives the same map
+  SOMType::Pointer singleThreadSom = SOMType::New();
+  singleThreadSom->SetListSample(listSample);
+  singleThreadSom->SetMapSize(size);
+  singleThreadSom->SetNeighborhoodSizeInit(radius);
+  singleThreadSom->SetNumberOfIterations(10);
+  singleThreadSom->SetBetaInit(1.0);
+  singleThreadSom->SetBetaEnd(0.5);
+  singleThreadSom->SetMinWeight(0.);
+  singleThreadSom->SetMaxWeight(300.);
+  singleThreadSom->SetRandomInit(true);
+  singleThreadSom->BatchModeOn();
+  singleThreadSom->SetNumberOfThreads(1);
+  singleThreadSom->Update();
+
+  const unsigned int nbWeights = map->GetBufferedRegion().GetNumberOfPixels() * nbComponents;
+  if (!std::equal(map->GetBufferPointer(), map->GetBufferPointer() + nbWeights,
+                  singleThreadSom->GetOutput()->GetBufferPointer()))
+    {
+    std::cerr << "The map depends on the number of threads" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -22,6 +22,7 @@
 #define otbCvRTreesWrapper_h
 
 #include "otbOpenCVUtils.h"
+#include "otbFlatTreeEnsemble.h"
 #include <vector>
 
 namespace otb
@@ -66,6 +67,12 @@ public:
                           const cv::Mat& missing =
                           cv::Mat()) const;
 
+  /** Copy the trees to a FlatTreeEnsemble, which predicts the same labels
+      and confidences. Returns false if the forest uses categorical
+      splits, which the ensemble does not support.
+  */
+  bool ExportTreeEnsemble(FlatTreeEnsemble & ensemble) const;
+
 #ifdef OTB_OPENCV_3
 
 #define OTB_CV_WRAP_PROPERTY(type,name) \
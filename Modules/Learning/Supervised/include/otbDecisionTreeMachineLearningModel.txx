@@ -73,16 +73,16 @@ DecisionTreeMachineLearningModel<TInputValue,TOutputValue>
 {
   //convert listsample to opencv matrix
   cv::Mat samples;
-  otb::ListSampleToMat<InputListSampleType>(this->GetInputListSample(), samples);
+  otb::TrainingSamplesToMat(this, samples);
 
   cv::Mat labels;
   otb::ListSampleToMat<TargetListSampleType>(this->GetTargetListSample(),labels);
 
-  cv::Mat var_type = cv::Mat(this->GetInputListSample()->GetMeasurementVectorSize() + 1, 1, CV_8U );
+  cv::Mat var_type = cv::Mat(samples.cols + 1, 1, CV_8U );
   var_type.setTo(cv::Scalar(CV_VAR_NUMERICAL) ); // all inputs are numerical
 
   if (!this->m_RegressionMode) //Classification
-    var_type.at<uchar>(this->GetInputListSample()->GetMeasurementVectorSize(), 0) = CV_VAR_CATEGORICAL;
+    var_type.at<uchar>(samples.cols, 0) = CV_VAR_CATEGORICAL;
 
 #ifdef OTB_OPENCV_3
   m_DTreeModel->setMaxDepth(m_MaxDepth);
@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbDenseSVMModel_h
+#define otbDenseSVMModel_h
+
+#include "itkMacro.h"
+
+#include "OTBSupervisedExport.h"
+
+#include <vector>
+#include <cstddef>
+
+namespace otb
+{
+
+/** \class DenseSVMModel
+ * \brief Support vector machine packed for the prediction of many samples
+ *
+ * libsvm stores the support vectors as sparse lists of (index, value)
+ * nodes, and evaluates the kernel of one sample against one support
+ * vector at a time. This class copies the support vectors in a single
+ * row-major matrix, with the coefficients, the offsets and the
+ * probability parameters of the decision functions, so that the samples
+ * can be predicted by blocks.
+ *
+ * For a block of samples, the samples are transposed so that each
+ * feature is contiguous for the whole block. The kernel values of the
+ * block against each support vector are then accumulated with loops on
+ * the samples, which the compiler vectorizes, while the support vector
+ * stays in cache. The kernel matrix of the block is computed once, and
+ * reused by all the one-versus-one decision functions, the votes and the
+ * probability estimates.
+ *
+ * The values are accumulated in the same order as libsvm does, so the
+ * decision values are the ones of svm_predict_values(), up to the
+ * contraction of floating point operations by the compiler.
+ *
+ * The precomputed kernel is not supported.
+ *
+ * \sa LibSVMMachineLearningModel
+ *
+ * \ingroup OTBSupervised
+ */
+class OTBSupervised_EXPORT DenseSVMModel
+{
+public:
+  /** Kernel functions, numbered as in libsvm */
+  typedef enum
+    {
+    Linear = 0,
+    Polynomial = 1,
+    RBF = 2,
+    Sigmoid = 3
+    } KernelType;
+
+  /** Kind of decision function */
+  typedef enum
+    {
+    /** One-versus-one classification with votes */
+    Classification,
+    /** Single decision function, the output is 1 or -1 */
+    OneClass,
+    /** Single decision function, the output is its value */
+    Regression
+    } ProblemType;
+
+  /** Number of samples evaluated together by Predict() */
+  static const unsigned int BlockSize = 64;
+
+  DenseSVMModel();
+
+  /** Remove the support vectors */
+  void Clear();
+
+  /** Is there any support vector ? */
+  bool IsEmpty() const
+  {
+    return m_NumberOfSupportVectors == 0;
+  }
+
+  void SetProblemType(ProblemType type)
+  {
+    m_ProblemType = type;
+  }
+
+  ProblemType GetProblemType() const
+  {
+    return m_ProblemType;
+  }
+
+  /** Set the kernel function and its parameters */
+  void SetKernel(KernelType type, int degree, double gamma, double coef0);
+
+  KernelType GetKernelType() const
+  {
+    return m_KernelType;
+  }
+
+  /** Set the support vectors: values holds nbFeatures values for each
+   * support vector, one after the other. In classification, the support
+   * vectors are grouped by class. */
+  void SetSupportVectors(const std::vector<double> & values, unsigned int nbFeatures);
+
+  unsigned int GetNumberOfSupportVectors() const
+  {
+    return m_NumberOfSupportVectors;
+  }
+
+  unsigned int GetNumberOfFeatures() const
+  {
+    return m_NumberOfFeatures;
+  }
+
+  /** Classification: set the label of each class, and its number of
+   * support vectors */
+  void SetClasses(const std::vector<double> & labels,
+                  const std::vector<unsigned int> & nbSupportVectors);
+
+  /** Number of classes, in classification */
+  unsigned int GetNumberOfClasses() const
+  {
+    return static_cast<unsigned int>(m_Labels.size());
+  }
+
+  /** Number of decision values of a sample: one per pair of classes in
+   * classification, 1 otherwise */
+  unsigned int GetNumberOfDecisionValues() const;
+
+  /** Set the coefficients of the support vectors, with the layout of
+   * svm_model::sv_coef: nbClasses-1 rows (1 for one-class and regression)
+   * of one value per support vector. */
+  void SetCoefficients(const std::vector<double> & coefficients);
+
+  /** Set the offset of each decision function */
+  void SetRho(const std::vector<double> & rho);
+
+  /** Classification: set the parameters of the sigmoid giving the
+   * probability of each pair of classes. Empty vectors remove the
+   * probability model. */
+  void SetProbabilityParameters(const std::vector<double> & probA,
+                                const std::vector<double> & probB);
+
+  bool HasProbabilities() const
+  {
+    return !m_ProbA.empty();
+  }
+
+  /** With two classes, use the pairwise probability as class
+   * probability instead of solving the coupling problem, as recent
+   * libsvm versions do (default is false) */
+  void SetBinaryPairwiseProbability(bool flag)
+  {
+    m_BinaryPairwiseProbability = flag;
+  }
+
+  bool GetBinaryPairwiseProbability() const
+  {
+    return m_BinaryPairwiseProbability;
+  }
+
+  /** Predict the output of nbSamples samples.
+   *
+   * samples points to the features of the first sample, and the samples
+   * are separated by stride values. If not null, decisionValues receives
+   * GetNumberOfDecisionValues() values per sample. If not null and the
+   * model has probabilities, probabilities receives GetNumberOfClasses()
+   * values per sample, and the output is the most probable class, as
+   * svm_predict_probability() does. Otherwise, the output of a
+   * classification is the most voted class. */
+  void Predict(const double * samples,
+               std::size_t nbSamples,
+               std::size_t stride,
+               double * outputs,
+               double * decisionValues = ITK_NULLPTR,
+               double * probabilities = ITK_NULLPTR) const;
+
+private:
+  /** Evaluate a block of at most BlockSize samples. The buffers hold
+   * BlockSize values per feature, support vector and decision value. */
+  void PredictBlock(const double * samples,
+                    std::size_t nbSamples,
+                    std::size_t stride,
+                    double * outputs,
+                    double * decisionValues,
+                    double * probabilities,
+                    double * transposed,
+                    double * kernel,
+                    double * decisions) const;
+
+  /** Kernel of the transposed block against all the support vectors */
+  void ComputeKernel(const double * transposed, std::size_t nbSamples, double * kernel) const;
+
+  /** Class probabilities of a sample from its decision values, as in
+   * svm_predict_probability() */
+  void ComputeProbabilities(const double * decisionValues, double * probabilities) const;
+
+  ProblemType         m_ProblemType;
+
+  KernelType          m_KernelType;
+  int                 m_Degree;
+  double              m_Gamma;
+  double              m_Coef0;
+
+  unsigned int        m_NumberOfFeatures;
+  unsigned int        m_NumberOfSupportVectors;
+
+  /** Support vectors, one row per vector */
+  std::vector<double> m_SupportVectors;
+
+  std::vector<double> m_Labels;
+
+  /** Index of the first support vector of each class */
+  std::vector<unsigned int> m_ClassStart;
+
+  /** Number of support vectors of each class */
+  std::vector<unsigned int> m_ClassCount;
+
+  std::vector<double> m_Coefficients;
+  std::vector<double> m_Rho;
+  std::vector<double> m_ProbA;
+  std::vector<double> m_ProbB;
+
+  bool                m_BinaryPairwiseProbability;
+};
+
+} // end namespace otb
+
+#endif
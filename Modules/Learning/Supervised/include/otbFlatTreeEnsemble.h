@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbFlatTreeEnsemble_h
+#define otbFlatTreeEnsemble_h
+
+#include "itkMacro.h"
+
+#include "OTBSupervisedExport.h"
+
+#include <vector>
+#include <cstddef>
+
+namespace otb
+{
+
+/** \class FlatTreeEnsemble
+ * \brief Compact representation of a forest of binary decision trees
+ *
+ * The learning libraries store their trees as linked node objects, and
+ * walk them one sample at a time. This class packs the trees of a forest
+ * in a single array of 16 bytes nodes: the nodes of each tree are stored
+ * breadth-first, so that the first levels of a tree share a few cache
+ * lines, and the two children of a node are adjacent, so that going down
+ * the tree is a branch-free index computation.
+ *
+ * Predict() evaluates the samples by blocks: each tree is applied to all
+ * the samples of a block before moving to the next tree, so that the
+ * nodes of a tree stay in cache while they are used.
+ *
+ * A node sends a sample to its first child if the sample feature is lower
+ * or equal to the threshold, and to the second child otherwise. A leaf
+ * holds a class index and a value. In classification, each tree votes
+ * for the class of its leaf, and the output is the value of the most
+ * voted class. In regression, the output is the mean of the leaf values.
+ *
+ * The tie break between classes with the same number of votes is set to
+ * match the library the forest comes from.
+ *
+ * \sa CvRTreesWrapper
+ *
+ * \ingroup OTBSupervised
+ */
+class OTBSupervised_EXPORT FlatTreeEnsemble
+{
+public:
+  /** A node of a tree. For a leaf, Feature is -1, Threshold is the value
+   * of the leaf and Left its class index. */
+  typedef struct
+    {
+    float Threshold;
+    int   Feature;
+    int   Left;
+    int   Right;
+    } NodeType;
+
+  typedef std::vector<NodeType> TreeType;
+
+  /** Rule to select a class among the ones with the most votes */
+  typedef enum
+    {
+    /** The class with the lowest index */
+    LowestClassIndex,
+    /** The class which first reached the maximum, trees being considered
+     * in order */
+    FirstReachedMaximum
+    } TieBreakType;
+
+  /** Number of samples evaluated together by Predict() */
+  static const unsigned int BlockSize = 64;
+
+  FlatTreeEnsemble();
+
+  /** Remove all the trees */
+  void Clear();
+
+  /** Is there any tree ? */
+  bool IsEmpty() const
+  {
+    return m_Roots.empty();
+  }
+
+  /** Set the number of features of the samples */
+  void SetNumberOfFeatures(unsigned int nbFeatures);
+
+  unsigned int GetNumberOfFeatures() const
+  {
+    return m_NumberOfFeatures;
+  }
+
+  /** Classification mode, with the number of classes (0 for regression) */
+  void SetNumberOfClasses(unsigned int nbClasses);
+
+  unsigned int GetNumberOfClasses() const
+  {
+    return m_NumberOfClasses;
+  }
+
+  void SetTieBreak(TieBreakType tieBreak)
+  {
+    m_TieBreak = tieBreak;
+  }
+
+  TieBreakType GetTieBreak() const
+  {
+    return m_TieBreak;
+  }
+
+  /** Add a tree. The nodes can be in any order, Left and Right being
+   * indices in the given vector, and root being the index of the root
+   * node. The tree is packed breadth-first. */
+  void AddTree(const TreeType & tree, int root);
+
+  unsigned int GetNumberOfTrees() const
+  {
+    return static_cast<unsigned int>(m_Roots.size());
+  }
+
+  /** Get the total number of nodes */
+  std::size_t GetNumberOfNodes() const
+  {
+    return m_Nodes.size();
+  }
+
+  /** Predict the output of nbSamples samples.
+   *
+   * samples points to the features of the first sample, and the samples
+   * are separated by stride floats. If not null, confidences receives,
+   * in classification, the proportion of the trees which voted for the
+   * output class, or, if margin is true, the difference between the
+   * proportions of the first and second most voted classes. If not
+   * null, probabilities receives, in classification, the proportion of
+   * the trees which voted for each class, GetNumberOfClasses() values per
+   * sample. */
+  void Predict(const float * samples,
+               std::size_t nbSamples,
+               std::size_t stride,
+               float * outputs,
+               float * confidences = ITK_NULLPTR,
+               bool margin = false,
+               float * probabilities = ITK_NULLPTR) const;
+
+  /** Output value of a class */
+  float GetClassValue(unsigned int classIndex) const
+  {
+    return m_ClassValues[classIndex];
+  }
+
+private:
+  /** Evaluate a block of at most BlockSize samples */
+  void PredictBlock(const float * samples,
+                    std::size_t nbSamples,
+                    std::size_t stride,
+                    float * outputs,
+                    float * confidences,
+                    bool margin,
+                    float * probabilities) const;
+
+  unsigned int          m_NumberOfFeatures;
+  unsigned int          m_NumberOfClasses;
+  TieBreakType          m_TieBreak;
+
+  /** Nodes of all the trees */
+  std::vector<NodeType> m_Nodes;
+
+  /** Index of the root of each tree in m_Nodes */
+  std::vector<int>      m_Roots;
+
+  /** Output value of each class */
+  std::vector<float>    m_ClassValues;
+};
+
+} // end namespace otb
+
+#endif
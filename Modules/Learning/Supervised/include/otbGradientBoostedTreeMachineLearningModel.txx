@@ -61,7 +61,7 @@ GradientBoostedTreeMachineLearningModel<TInputValue,TOutputValue>
 {
   //convert listsample to opencv matrix
   cv::Mat samples;
-  otb::ListSampleToMat<InputListSampleType>(this->GetInputListSample(), samples);
+  otb::TrainingSamplesToMat(this, samples);
 
   cv::Mat labels;
   otb::ListSampleToMat<TargetListSampleType>(this->GetTargetListSample(),labels);
@@ -70,11 +70,11 @@ GradientBoostedTreeMachineLearningModel<TInputValue,TOutputValue>
                                            m_MaxDepth, m_UseSurrogates);
 
   //train the Decision Tree model
-  cv::Mat var_type = cv::Mat(this->GetInputListSample()->GetMeasurementVectorSize() + 1, 1, CV_8U );
+  cv::Mat var_type = cv::Mat(samples.cols + 1, 1, CV_8U );
   var_type.setTo(cv::Scalar(CV_VAR_NUMERICAL) ); // all inputs are numerical
 
   if (!this->m_RegressionMode) //Classification
-    var_type.at<uchar>(this->GetInputListSample()->GetMeasurementVectorSize(), 0) = CV_VAR_CATEGORICAL;
+    var_type.at<uchar>(samples.cols, 0) = CV_VAR_CATEGORICAL;
 
   m_GBTreeModel->train(samples,CV_ROW_SAMPLE,labels,cv::Mat(),cv::Mat(),var_type,cv::Mat(),params, false);
 }
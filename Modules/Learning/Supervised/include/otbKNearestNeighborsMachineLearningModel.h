@@ -114,6 +114,10 @@ private:
   KNearestNeighborsMachineLearningModel(const Self &); //purposely not implemented
   void operator =(const Self&); //purposely not implemented
 
+  /** Write the samples, preceded by their label, one per line */
+  template <class TListSample>
+  void SaveSamples(std::ostream & ofs, const TListSample * samples);
+
 #ifdef OTB_OPENCV_3
   cv::Ptr<cv::ml::KNearest> m_KNearestModel;
 #else
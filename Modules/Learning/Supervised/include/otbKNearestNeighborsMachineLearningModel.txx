@@ -65,7 +65,7 @@ KNearestNeighborsMachineLearningModel<TInputValue,TTargetValue>
 {
   //convert listsample to opencv matrix
   cv::Mat samples;
-  otb::ListSampleToMat<InputListSampleType>(this->GetInputListSample(), samples);
+  otb::TrainingSamplesToMat(this, samples);
 
   cv::Mat labels;
   otb::ListSampleToMat<TargetListSampleType>(this->GetTargetListSample(), labels);
@@ -185,13 +185,31 @@ KNearestNeighborsMachineLearningModel<TInputValue,TTargetValue>
     }
 
   //Save the samples. First column is the Label and other columns are the sample data.
-  typename InputListSampleType::ConstIterator sampleIt = this->GetInputListSample()->Begin();
+  if (this->GetInputContiguousListSample() != ITK_NULLPTR)
+    {
+    this->SaveSamples(ofs, this->GetInputContiguousListSample());
+    }
+  else
+    {
+    this->SaveSamples(ofs, this->GetInputListSample());
+    }
+  ofs.close();
+#endif
+}
+
+template <class TInputValue, class TTargetValue>
+template <class TListSample>
+void
+KNearestNeighborsMachineLearningModel<TInputValue,TTargetValue>
+::SaveSamples(std::ostream & ofs, const TListSample * samples)
+{
+  typename TListSample::ConstIterator sampleIt = samples->Begin();
   typename TargetListSampleType::ConstIterator labelIt = this->GetTargetListSample()->Begin();
-  const unsigned int sampleSize = this->GetInputListSample()->GetMeasurementVectorSize();
-  for(; sampleIt!=this->GetInputListSample()->End(); ++sampleIt,++labelIt)
+  const unsigned int sampleSize = samples->GetMeasurementVectorSize();
+  for(; sampleIt!=samples->End(); ++sampleIt,++labelIt)
   {
     // Retrieve sample
-    typename InputListSampleType::MeasurementVectorType sample = sampleIt.GetMeasurementVector();
+    const typename TListSample::MeasurementVectorType & sample = sampleIt.GetMeasurementVector();
     ofs <<labelIt.GetMeasurementVector()[0];
 
     // Loop on sample size
@@ -201,8 +219,6 @@ KNearestNeighborsMachineLearningModel<TInputValue,TTargetValue>
     }
     ofs <<"\n";
   }
-  ofs.close();
-#endif
 }
 
 template <class TInputValue, class TTargetValue>
@@ -311,6 +327,7 @@ KNearestNeighborsMachineLearningModel<TInputValue,TTargetValue>
   }
   ifs.close();
 
+  this->SetInputContiguousListSample(ITK_NULLPTR);
   this->SetInputListSample(samples);
   this->SetTargetListSample(labels);
   this->Train();
@@ -24,6 +24,7 @@
 #include "itkLightObject.h"
 #include "itkFixedArray.h"
 #include "otbMachineLearningModel.h"
+#include "otbDenseSVMModel.h"
 
 #include "svm.h"
 
@@ -47,6 +48,9 @@ public:
   typedef typename Superclass::TargetSampleType           TargetSampleType;
   typedef typename Superclass::TargetListSampleType       TargetListSampleType;
   typedef typename Superclass::ConfidenceValueType        ConfidenceValueType;
+  typedef typename Superclass::ConfidenceListSampleType   ConfidenceListSampleType;
+  typedef typename Superclass::ProbaSampleType            ProbaSampleType;
+  typedef typename Superclass::ProbaListSampleType        ProbaListSampleType;
 
   /** enum to choose the way confidence is computed
    *   CM_INDEX : compute the difference between highest and second highest probability
@@ -274,6 +278,17 @@ protected:
   /** Predict values using the model */
   TargetSampleType DoPredict(const InputSampleType& input, ConfidenceValueType *quality=ITK_NULLPTR) const ITK_OVERRIDE;
 
+  /** Predict a range of samples by blocks, with the dense copy of the
+   * model */
+  void DoPredictBatch(const InputListSampleType * input, const unsigned int & startIndex, const unsigned int & size, TargetListSampleType * targets, ConfidenceListSampleType * quality = ITK_NULLPTR) const ITK_OVERRIDE;
+
+  /** Predict values and class probabilities, when the model has a
+   * probability model */
+  TargetSampleType DoPredictProba(const InputSampleType& input, ConfidenceValueType *quality, ProbaSampleType & proba) const ITK_OVERRIDE;
+
+  /** Predict a range of samples by blocks, with the class probabilities */
+  void DoPredictBatchProba(const InputListSampleType * input, const unsigned int & startIndex, const unsigned int & size, TargetListSampleType * targets, ConfidenceListSampleType * quality, ProbaListSampleType * proba) const ITK_OVERRIDE;
+
   /** PrintSelf method */
   void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
 
@@ -283,6 +298,10 @@ private:
 
   void BuildProblem(void);
 
+  /** Build the problem from the given training samples */
+  template <class TListSample>
+  void BuildProblem(const TListSample * samples);
+
   void ConsistencyCheck(void);
 
   void DeleteProblem(void);
@@ -291,6 +310,20 @@ private:
 
   void OptimizeParameters(void);
 
+  /** Copy the trained or loaded model to m_DenseModel */
+  void UpdateDenseModel(void);
+
+  /** Prediction with libsvm, one sample at a time */
+  TargetSampleType PredictWithLibSVM(const InputSampleType& input, ConfidenceValueType *quality) const;
+
+  /** Confidence of a sample in CM_INDEX or CM_PROBA mode, from the
+   * probabilities of the dense model */
+  void ComputeConfidence(const double * probabilities, ConfidenceValueType * quality) const;
+
+  /** Block prediction with m_DenseModel, with the class probabilities
+   * if proba is not NULL */
+  void PredictBatchWithDenseModel(const InputListSampleType * input, const unsigned int & startIndex, const unsigned int & size, TargetListSampleType * targets, ConfidenceListSampleType * quality, ProbaListSampleType * proba) const;
+
   /** Container to hold the SVM model itself */
   struct svm_model* m_Model;
 
@@ -324,6 +357,13 @@ private:
   /** Temporary array to store cross-validation results */
   std::vector<double> m_TmpTarget;
 
+  /** Dense copy of the model used for prediction. It is empty if the
+   * model can not be converted, in which case libsvm is used. */
+  DenseSVMModel m_DenseModel;
+
+  /** Class of the dense model for each class probability */
+  std::vector<unsigned int> m_ProbaOrder;
+
 };
 } // end namespace otb
 
@@ -22,6 +22,7 @@
 #define otbLibSVMMachineLearningModel_txx
 
 #include <fstream>
+#include <algorithm>
 #include "otbLibSVMMachineLearningModel.h"
 #include "otbSVMCrossValidationCostFunction.h"
 #include "otbExhaustiveExponentialOptimizer.h"
@@ -101,6 +102,161 @@ LibSVMMachineLearningModel<TInputValue,TOutputValue>
   m_Model = svm_train(&m_Problem, &m_Parameters);
 
   this->m_ConfidenceIndex = this->HasProbabilities();
+
+  this->UpdateDenseModel();
+}
+
+template <class TInputValue, class TOutputValue>
+void
+LibSVMMachineLearningModel<TInputValue,TOutputValue>
+::UpdateDenseModel()
+{
+  m_DenseModel.Clear();
+  this->m_ProbaLabels.clear();
+  m_ProbaOrder.clear();
+
+  if (m_Model == ITK_NULLPTR || m_Model->l == 0)
+    {
+    return;
+    }
+
+  const struct svm_parameter & param = m_Model->param;
+  if (param.kernel_type != LINEAR && param.kernel_type != POLY
+      && param.kernel_type != RBF && param.kernel_type != SIGMOID)
+    {
+    otbMsgDevMacro(<< "Kernel " << param.kernel_type << " is not supported by the dense model, libsvm is used for the prediction");
+    return;
+    }
+
+  // The number of features is the largest index of the support vectors
+  const int nbSV = m_Model->l;
+  int nbFeatures = 0;
+  for (int i = 0; i < nbSV; ++i)
+    {
+    for (const struct svm_node * node = m_Model->SV[i]; node->index != -1; ++node)
+      {
+      if (node->index < 1)
+        {
+        otbMsgDevMacro(<< "Invalid feature index " << node->index << ", libsvm is used for the prediction");
+        return;
+        }
+      nbFeatures = std::max(nbFeatures, node->index);
+      }
+    }
+  if (nbFeatures == 0)
+    {
+    return;
+    }
+
+  std::vector<double> values(static_cast<std::size_t>(nbSV) * nbFeatures, 0.);
+  for (int i = 0; i < nbSV; ++i)
+    {
+    for (const struct svm_node * node = m_Model->SV[i]; node->index != -1; ++node)
+      {
+      values[static_cast<std::size_t>(i) * nbFeatures + node->index - 1] = node->value;
+      }
+    }
+
+  m_DenseModel.SetKernel(static_cast<DenseSVMModel::KernelType>(param.kernel_type),
+                         param.degree, param.gamma, param.coef0);
+  m_DenseModel.SetSupportVectors(values, nbFeatures);
+
+  const int nbClasses = m_Model->nr_class;
+  int nbRows = 1;
+  int nbDecisions = 1;
+  if (param.svm_type == C_SVC || param.svm_type == NU_SVC)
+    {
+    m_DenseModel.SetProblemType(DenseSVMModel::Classification);
+    std::vector<double> labels(nbClasses);
+    std::vector<unsigned int> counts(nbClasses);
+    for (int c = 0; c < nbClasses; ++c)
+      {
+      labels[c] = m_Model->label[c];
+      counts[c] = m_Model->nSV[c];
+      }
+    m_DenseModel.SetClasses(labels, counts);
+    nbRows = nbClasses - 1;
+    nbDecisions = nbClasses * (nbClasses - 1) / 2;
+
+    if (m_Model->probA != ITK_NULLPTR && m_Model->probB != ITK_NULLPTR)
+      {
+      m_DenseModel.SetProbabilityParameters(std::vector<double>(m_Model->probA, m_Model->probA + nbDecisions),
+                                            std::vector<double>(m_Model->probB, m_Model->probB + nbDecisions));
+      }
+#if defined(LIBSVM_VERSION) && LIBSVM_VERSION >= 325
+    m_DenseModel.SetBinaryPairwiseProbability(true);
+#endif
+
+    // Class probabilities are given in the order of the labels, libsvm
+    // keeps the order in which it found the classes
+    if (m_DenseModel.HasProbabilities())
+      {
+      std::vector<std::pair<double, unsigned int> > sorted(nbClasses);
+      for (int c = 0; c < nbClasses; ++c)
+        {
+        sorted[c] = std::make_pair(labels[c], static_cast<unsigned int>(c));
+        }
+      std::sort(sorted.begin(), sorted.end());
+      for (int c = 0; c < nbClasses; ++c)
+        {
+        this->m_ProbaLabels.push_back(static_cast<TargetValueType>(sorted[c].first));
+        m_ProbaOrder.push_back(sorted[c].second);
+        }
+      }
+    }
+  else if (param.svm_type == ONE_CLASS)
+    {
+    m_DenseModel.SetProblemType(DenseSVMModel::OneClass);
+    }
+  else
+    {
+    m_DenseModel.SetProblemType(DenseSVMModel::Regression);
+    }
+
+  std::vector<double> coefficients(static_cast<std::size_t>(nbRows) * nbSV);
+  for (int r = 0; r < nbRows; ++r)
+    {
+    std::copy(m_Model->sv_coef[r], m_Model->sv_coef[r] + nbSV, coefficients.begin() + r * nbSV);
+    }
+  m_DenseModel.SetCoefficients(coefficients);
+  m_DenseModel.SetRho(std::vector<double>(m_Model->rho, m_Model->rho + nbDecisions));
+}
+
+template <class TInputValue, class TOutputValue>
+void
+LibSVMMachineLearningModel<TInputValue,TOutputValue>
+::ComputeConfidence(const double * probabilities, ConfidenceValueType * quality) const
+{
+  int svm_type = svm_get_svm_type(m_Model);
+  if (this->m_ConfidenceMode == CM_PROBA)
+    {
+    for (unsigned int i = 0; i < m_DenseModel.GetNumberOfClasses(); ++i)
+      {
+      quality[i] = static_cast<ConfidenceValueType>(probabilities[i]);
+      }
+    }
+  else if (svm_type == C_SVC || svm_type == NU_SVC)
+    {
+    double maxProb = 0.0;
+    double secProb = 0.0;
+    for (unsigned int i = 0; i < m_DenseModel.GetNumberOfClasses(); ++i)
+      {
+      if (maxProb < probabilities[i])
+        {
+        secProb = maxProb;
+        maxProb = probabilities[i];
+        }
+      else if (secProb < probabilities[i])
+        {
+        secProb = probabilities[i];
+        }
+      }
+    (*quality) = static_cast<ConfidenceValueType>(maxProb - secProb);
+    }
+  else
+    {
+    (*quality) = svm_get_svr_probability(m_Model);
+    }
 }
 
 template <class TInputValue, class TOutputValue>
@@ -108,6 +264,205 @@ typename LibSVMMachineLearningModel<TInputValue,TOutputValue>
 ::TargetSampleType
 LibSVMMachineLearningModel<TInputValue,TOutputValue>
 ::DoPredict(const InputSampleType & input, ConfidenceValueType *quality) const
+{
+  const unsigned int nbFeatures = m_DenseModel.GetNumberOfFeatures();
+  if (m_DenseModel.IsEmpty() || input.Size() != nbFeatures)
+    {
+    return this->PredictWithLibSVM(input, quality);
+    }
+
+  if (quality != ITK_NULLPTR && !this->m_ConfidenceIndex)
+    {
+    itkExceptionMacro("Confidence index not available for this classifier !");
+    }
+
+  std::vector<double> sample(nbFeatures);
+  for (unsigned int i = 0; i < nbFeatures; ++i)
+    {
+    sample[i] = input[i];
+    }
+
+  double output = 0.;
+  if (quality != ITK_NULLPTR && this->m_ConfidenceMode == CM_HYPER)
+    {
+    std::vector<double> decisions(std::max(m_DenseModel.GetNumberOfDecisionValues(), 1U));
+    m_DenseModel.Predict(&sample[0], 1, nbFeatures, &output, &decisions[0]);
+    for (unsigned int i = 0; i < m_DenseModel.GetNumberOfDecisionValues(); ++i)
+      {
+      quality[i] = static_cast<ConfidenceValueType>(decisions[i]);
+      }
+    }
+  else
+    {
+    // As with svm_predict_probability(), the most probable class is
+    // predicted when the model has probabilities
+    std::vector<double> probabilities(std::max(m_DenseModel.GetNumberOfClasses(), 1U));
+    m_DenseModel.Predict(&sample[0], 1, nbFeatures, &output, ITK_NULLPTR, &probabilities[0]);
+    if (quality != ITK_NULLPTR)
+      {
+      this->ComputeConfidence(&probabilities[0], quality);
+      }
+    }
+
+  TargetSampleType target;
+  target[0] = static_cast<TargetValueType>(output);
+  return target;
+}
+
+template <class TInputValue, class TOutputValue>
+void
+LibSVMMachineLearningModel<TInputValue,TOutputValue>
+::DoPredictBatch(const InputListSampleType * input, const unsigned int & startIndex, const unsigned int & size, TargetListSampleType * targets, ConfidenceListSampleType * quality) const
+{
+  const unsigned int nbFeatures = m_DenseModel.GetNumberOfFeatures();
+
+  // The confidence list holds one value per sample, only CM_INDEX is
+  // handled by blocks
+  if (m_DenseModel.IsEmpty() || input->GetMeasurementVectorSize() != nbFeatures
+      || (quality != ITK_NULLPTR && this->m_ConfidenceMode != CM_INDEX))
+    {
+    Superclass::DoPredictBatch(input, startIndex, size, targets, quality);
+    return;
+    }
+  this->PredictBatchWithDenseModel(input, startIndex, size, targets, quality, ITK_NULLPTR);
+}
+
+template <class TInputValue, class TOutputValue>
+typename LibSVMMachineLearningModel<TInputValue,TOutputValue>
+::TargetSampleType
+LibSVMMachineLearningModel<TInputValue,TOutputValue>
+::DoPredictProba(const InputSampleType & input, ConfidenceValueType *quality, ProbaSampleType & proba) const
+{
+  const unsigned int nbFeatures = m_DenseModel.GetNumberOfFeatures();
+  if (input.Size() != nbFeatures)
+    {
+    itkExceptionMacro(<< "The sample has " << input.Size() << " features instead of " << nbFeatures);
+    }
+
+  if (quality != ITK_NULLPTR && !this->m_ConfidenceIndex)
+    {
+    itkExceptionMacro("Confidence index not available for this classifier !");
+    }
+
+  std::vector<double> sample(nbFeatures);
+  for (unsigned int i = 0; i < nbFeatures; ++i)
+    {
+    sample[i] = input[i];
+    }
+
+  const bool hyper = quality != ITK_NULLPTR && this->m_ConfidenceMode == CM_HYPER;
+  std::vector<double> decisions(std::max(m_DenseModel.GetNumberOfDecisionValues(), 1U));
+  std::vector<double> probabilities(m_DenseModel.GetNumberOfClasses());
+  double output = 0.;
+  m_DenseModel.Predict(&sample[0], 1, nbFeatures, &output,
+                       hyper ? &decisions[0] : ITK_NULLPTR, &probabilities[0]);
+
+  for (unsigned int c = 0; c < m_ProbaOrder.size(); ++c)
+    {
+    proba[c] = static_cast<ConfidenceValueType>(probabilities[m_ProbaOrder[c]]);
+    }
+
+  if (hyper)
+    {
+    for (unsigned int i = 0; i < m_DenseModel.GetNumberOfDecisionValues(); ++i)
+      {
+      quality[i] = static_cast<ConfidenceValueType>(decisions[i]);
+      }
+    }
+  else if (quality != ITK_NULLPTR)
+    {
+    this->ComputeConfidence(&probabilities[0], quality);
+    }
+
+  TargetSampleType target;
+  target[0] = static_cast<TargetValueType>(output);
+  return target;
+}
+
+template <class TInputValue, class TOutputValue>
+void
+LibSVMMachineLearningModel<TInputValue,TOutputValue>
+::DoPredictBatchProba(const InputListSampleType * input, const unsigned int & startIndex, const unsigned int & size, TargetListSampleType * targets, ConfidenceListSampleType * quality, ProbaListSampleType * proba) const
+{
+  if (input->GetMeasurementVectorSize() != m_DenseModel.GetNumberOfFeatures())
+    {
+    itkExceptionMacro(<< "The samples have " << input->GetMeasurementVectorSize() << " features instead of " << m_DenseModel.GetNumberOfFeatures());
+    }
+  if (quality != ITK_NULLPTR && this->m_ConfidenceMode != CM_INDEX)
+    {
+    itkExceptionMacro(<< "Only the CM_INDEX confidence can be computed with the class probabilities");
+    }
+  this->PredictBatchWithDenseModel(input, startIndex, size, targets, quality, proba);
+}
+
+template <class TInputValue, class TOutputValue>
+void
+LibSVMMachineLearningModel<TInputValue,TOutputValue>
+::PredictBatchWithDenseModel(const InputListSampleType * input, const unsigned int & startIndex, const unsigned int & size, TargetListSampleType * targets, ConfidenceListSampleType * quality, ProbaListSampleType * proba) const
+{
+  const unsigned int nbFeatures = m_DenseModel.GetNumberOfFeatures();
+
+  if (startIndex + size > input->Size())
+    {
+    itkExceptionMacro(<<"requested range ["<<startIndex<<", "<<startIndex+size<<"[ partially outside input sample list range.[0,"<<input->Size()<<"[");
+    }
+
+  if (quality != ITK_NULLPTR && !this->m_ConfidenceIndex)
+    {
+    itkExceptionMacro("Confidence index not available for this classifier !");
+    }
+
+  const unsigned int blockSize = DenseSVMModel::BlockSize;
+  const unsigned int nbClasses = std::max(m_DenseModel.GetNumberOfClasses(), 1U);
+  std::vector<double> samples(blockSize * nbFeatures);
+  std::vector<double> outputs(blockSize);
+  std::vector<double> probabilities(blockSize * nbClasses);
+  ProbaSampleType probaSample(m_ProbaOrder.size());
+
+  for (unsigned int start = startIndex; start < startIndex + size; start += blockSize)
+    {
+    const unsigned int nbSamples = std::min(blockSize, startIndex + size - start);
+
+    // Copy the block to a contiguous buffer of double, as libsvm nodes
+    for (unsigned int i = 0; i < nbSamples; ++i)
+      {
+      const InputSampleType & sample = input->GetMeasurementVector(start + i);
+      for (unsigned int j = 0; j < nbFeatures; ++j)
+        {
+        samples[i * nbFeatures + j] = sample[j];
+        }
+      }
+
+    m_DenseModel.Predict(&samples[0], nbSamples, nbFeatures, &outputs[0], ITK_NULLPTR, &probabilities[0]);
+
+    for (unsigned int i = 0; i < nbSamples; ++i)
+      {
+      TargetSampleType target;
+      target[0] = static_cast<TargetValueType>(outputs[i]);
+      targets->SetMeasurementVector(start + i, target);
+      if (quality != ITK_NULLPTR)
+        {
+        ConfidenceValueType confidence = 0;
+        this->ComputeConfidence(&probabilities[i * nbClasses], &confidence);
+        quality->SetMeasurementVector(start + i, confidence);
+        }
+      if (proba != ITK_NULLPTR)
+        {
+        for (unsigned int c = 0; c < m_ProbaOrder.size(); ++c)
+          {
+          probaSample[c] = static_cast<ConfidenceValueType>(probabilities[i * nbClasses + m_ProbaOrder[c]]);
+          }
+        proba->SetMeasurementVector(start + i, probaSample);
+        }
+      }
+    }
+}
+
+template <class TInputValue, class TOutputValue>
+typename LibSVMMachineLearningModel<TInputValue,TOutputValue>
+::TargetSampleType
+LibSVMMachineLearningModel<TInputValue,TOutputValue>
+::PredictWithLibSVM(const InputSampleType & input, ConfidenceValueType *quality) const
 {
   TargetSampleType target;
   target.Fill(0);
@@ -229,6 +584,8 @@ LibSVMMachineLearningModel<TInputValue,TOutputValue>
   m_Parameters = m_Model->param;
 
   this->m_ConfidenceIndex = this->HasProbabilities();
+
+  this->UpdateDenseModel();
 }
 
 template <class TInputValue, class TOutputValue>
@@ -302,9 +659,24 @@ template <class TInputValue, class TOutputValue>
 void
 LibSVMMachineLearningModel<TInputValue,TOutputValue>
 ::BuildProblem()
+{
+  if (this->GetInputContiguousListSample() != ITK_NULLPTR)
+    {
+    this->BuildProblem(this->GetInputContiguousListSample());
+    }
+  else
+    {
+    this->BuildProblem(this->GetInputListSample());
+    }
+}
+
+template <class TInputValue, class TOutputValue>
+template <class TListSample>
+void
+LibSVMMachineLearningModel<TInputValue,TOutputValue>
+::BuildProblem(const TListSample * samples)
 {
   // Get number of samples
-  typename InputListSampleType::Pointer samples = this->GetInputListSample();
   typename TargetListSampleType::Pointer target = this->GetTargetListSample();
   int probl = samples->Size();
 
@@ -327,7 +699,7 @@ LibSVMMachineLearningModel<TInputValue,TOutputValue>
     }
 
   // Iterate on the samples
-  typename InputListSampleType::ConstIterator sIt = samples->Begin();
+  typename TListSample::ConstIterator sIt = samples->Begin();
   typename TargetListSampleType::ConstIterator tIt = target->Begin();
   int sampleIndex = 0;
 
@@ -415,6 +787,7 @@ LibSVMMachineLearningModel<TInputValue,TOutputValue>
     svm_free_and_destroy_model(&m_Model);
     }
   m_Model = ITK_NULLPTR;
+  m_DenseModel.Clear();
 }
 
 template <class TInputValue, class TOutputValue>
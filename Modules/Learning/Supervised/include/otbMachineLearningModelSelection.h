@@ -0,0 +1,274 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbMachineLearningModelSelection_h
+#define otbMachineLearningModelSelection_h
+
+#include "itkObject.h"
+#include "itkArray.h"
+#include "itkMultiThreader.h"
+#include "itkSimpleFastMutexLock.h"
+#include "otbMachineLearningModel.h"
+
+#include <vector>
+#include <string>
+
+namespace otb
+{
+
+/** \class MachineLearningModelSelection
+ * \brief Select the parameters of a MachineLearningModel by cross-validation
+ *
+ * The candidate values of each parameter are given with AddParameter(),
+ * and the configurations to evaluate are either all the combinations of
+ * these values (grid search), or a random subset of them if
+ * NumberOfRandomConfigurations is not 0 (random search).
+ *
+ * The samples are split into NumberOfFolds folds, stratified by class.
+ * For each configuration and each fold, a model is created with the
+ * model generator, trained on the other folds, and evaluated on the fold
+ * with a ConfusionMatrixCalculator. The score of a configuration is the
+ * mean over the folds of the selected metric (overall accuracy, kappa or
+ * mean F-score), and the best configuration is the one with the highest
+ * score.
+ *
+ * The folds are only the fold index of each sample, shared read-only
+ * by all the configurations. The (configuration, fold) pairs are
+ * evaluated concurrently by NumberOfThreads threads, each thread taking
+ * the next pair as soon as it is done with the previous one. A pair
+ * gathers its training samples from the input list in a
+ * ContiguousListSample, released after the training, and predicts its
+ * validation samples one by one in the input list, on its own thread.
+ * The models must therefore train on the contiguous input list sample
+ * when it is set, as all the OTB models do.
+ *
+ * The training of the libsvm and OpenCV models is not documented as
+ * reentrant (libsvm sets a global print function), so the models of the
+ * same class (as given by GetNameOfClass()) are trained one at a time,
+ * across all the instances of this class. The predictions and the
+ * training of models of different classes run concurrently.
+ *
+ * The model generator is a function creating a new model set up with the
+ * given configuration (in the order of the calls to AddParameter()). It
+ * is called from several threads at once, and must not modify any shared
+ * state. The input samples are not modified.
+ *
+ * This class is meant for classification models.
+ *
+ * \sa ConfusionMatrixCalculator
+ *
+ * \ingroup OTBSupervised
+ */
+template <class TInputValue, class TTargetValue>
+class ITK_EXPORT MachineLearningModelSelection
+  : public itk::Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef MachineLearningModelSelection Self;
+  typedef itk::Object                   Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(MachineLearningModelSelection, itk::Object);
+
+  typedef MachineLearningModel<TInputValue, TTargetValue> ModelType;
+  typedef typename ModelType::Pointer                     ModelPointerType;
+  typedef typename ModelType::InputSampleType             InputSampleType;
+  typedef typename ModelType::InputListSampleType         InputListSampleType;
+  typedef typename ModelType::TargetSampleType            TargetSampleType;
+  typedef typename ModelType::TargetListSampleType        TargetListSampleType;
+  typedef typename ModelType::TargetValueType             TargetValueType;
+
+  /** A configuration: one value per parameter */
+  typedef itk::Array<double> ParametersType;
+
+  /** Create a model set up with the given configuration */
+  typedef ModelPointerType (*ModelGeneratorType)(const ParametersType & parameters, void * clientData);
+
+  /** Metrics available to rank the configurations */
+  typedef enum
+    {
+    OverallAccuracy,
+    Kappa,
+    FScore
+    } MetricType;
+
+  /** Set the input samples */
+  itkSetObjectMacro(InputListSample, InputListSampleType);
+  itkGetObjectMacro(InputListSample, InputListSampleType);
+
+  /** Set the labels of the input samples */
+  itkSetObjectMacro(TargetListSample, TargetListSampleType);
+  itkGetObjectMacro(TargetListSample, TargetListSampleType);
+
+  /** Set the function creating the models */
+  void SetModelGenerator(ModelGeneratorType generator, void * clientData = ITK_NULLPTR);
+
+  /** Add a parameter, with its candidate values */
+  void AddParameter(const std::string & name, const std::vector<double> & values);
+
+  /** Remove all the parameters */
+  void ClearParameters();
+
+  /** Get the names of the parameters */
+  const std::vector<std::string> & GetParameterNames() const
+  {
+    return m_ParameterNames;
+  }
+
+  /** Number of folds of the cross-validation (default is 5) */
+  itkSetMacro(NumberOfFolds, unsigned int);
+  itkGetConstMacro(NumberOfFolds, unsigned int);
+
+  /** Number of configurations drawn from the grid. If 0 (the default),
+   * all the configurations of the grid are evaluated. */
+  itkSetMacro(NumberOfRandomConfigurations, unsigned int);
+  itkGetConstMacro(NumberOfRandomConfigurations, unsigned int);
+
+  /** Seed of the random split into folds and of the random search */
+  itkSetMacro(Seed, unsigned int);
+  itkGetConstMacro(Seed, unsigned int);
+
+  /** Number of threads training the models. If 0 (the default), the ITK
+   * default number of threads is used. */
+  itkSetMacro(NumberOfThreads, unsigned int);
+  itkGetConstMacro(NumberOfThreads, unsigned int);
+
+  /** Metric used to rank the configurations (default is Kappa) */
+  itkSetMacro(Metric, MetricType);
+  itkGetConstMacro(Metric, MetricType);
+
+  /** Evaluate all the configurations */
+  void Compute();
+
+  /** Number of configurations evaluated by Compute() */
+  unsigned int GetNumberOfConfigurations() const
+  {
+    return static_cast<unsigned int>(m_Configurations.size());
+  }
+
+  /** Get the configuration at the given index */
+  const ParametersType & GetConfiguration(unsigned int configuration) const;
+
+  /** Get the overall accuracy of a configuration on a fold */
+  double GetFoldOverallAccuracy(unsigned int configuration, unsigned int fold) const;
+
+  /** Get the kappa index of a configuration on a fold */
+  double GetFoldKappa(unsigned int configuration, unsigned int fold) const;
+
+  /** Get the mean F-score of a configuration on a fold */
+  double GetFoldFScore(unsigned int configuration, unsigned int fold) const;
+
+  /** Get the mean of the selected metric over the folds */
+  double GetScore(unsigned int configuration) const;
+
+  /** Get the index of the best configuration */
+  itkGetConstMacro(BestConfigurationIndex, unsigned int);
+
+  /** Get the best configuration */
+  const ParametersType & GetBestConfiguration() const
+  {
+    return this->GetConfiguration(m_BestConfigurationIndex);
+  }
+
+  /** Get the score of the best configuration */
+  double GetBestScore() const
+  {
+    return this->GetScore(m_BestConfigurationIndex);
+  }
+
+protected:
+  MachineLearningModelSelection();
+  ~MachineLearningModelSelection() ITK_OVERRIDE {}
+  void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
+
+private:
+  MachineLearningModelSelection(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  /** Metrics of a configuration on a fold */
+  typedef struct
+    {
+    double OverallAccuracy;
+    double Kappa;
+    double FScore;
+    } FoldResultType;
+
+  /** Build the list of configurations to evaluate */
+  void GenerateConfigurations();
+
+  /** Assign each sample to a fold */
+  void GenerateFolds();
+
+  /** Train and evaluate a configuration on a fold */
+  void EvaluateTask(unsigned int task);
+
+  /** Get the index of the next task to evaluate, or false if none */
+  bool GetNextTask(unsigned int & task);
+
+  /** Record the failure of a task, the first one is reported by Compute() */
+  void SetTaskError(unsigned int task, const std::string & message);
+
+  /** Callback of the threads */
+  static ITK_THREAD_RETURN_TYPE ThreaderCallback(void * arg);
+
+  typename InputListSampleType::Pointer  m_InputListSample;
+  typename TargetListSampleType::Pointer m_TargetListSample;
+
+  ModelGeneratorType m_ModelGenerator;
+  void *             m_ModelGeneratorClientData;
+
+  std::vector<std::string>          m_ParameterNames;
+  std::vector<std::vector<double> > m_ParameterValues;
+
+  unsigned int m_NumberOfFolds;
+  unsigned int m_NumberOfRandomConfigurations;
+  unsigned int m_Seed;
+  unsigned int m_NumberOfThreads;
+  MetricType   m_Metric;
+
+  std::vector<ParametersType> m_Configurations;
+
+  /** Fold of each input sample, shared by all the configurations */
+  std::vector<unsigned int> m_SampleFolds;
+
+  /** Results, indexed by configuration * NumberOfFolds + fold */
+  std::vector<FoldResultType> m_Results;
+
+  unsigned int m_BestConfigurationIndex;
+
+  /** Task scheduling between the threads */
+  unsigned int              m_NextTask;
+  itk::SimpleFastMutexLock  m_Mutex;
+  std::string               m_ErrorMessage;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbMachineLearningModelSelection.txx"
+#endif
+
+#endif
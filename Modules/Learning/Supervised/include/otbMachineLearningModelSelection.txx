@@ -0,0 +1,469 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbMachineLearningModelSelection_txx
+#define otbMachineLearningModelSelection_txx
+
+#include "otbMachineLearningModelSelection.h"
+#include "otbConfusionMatrixCalculator.h"
+#include "otbMacro.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkMutexLock.h"
+#include "itkMutexLockHolder.h"
+
+#include <map>
+#include <algorithm>
+#include <sstream>
+
+namespace otb
+{
+
+namespace internal
+{
+/** Mutex serialising the training of the models of a class, shared by
+ * all the instantiations of MachineLearningModelSelection */
+inline itk::MutexLock * GetModelTrainingMutex(const std::string & modelClass)
+{
+  typedef std::map<std::string, itk::MutexLock::Pointer> MutexMapType;
+  static MutexMapType        mutexes;
+  static itk::SimpleMutexLock mapMutex;
+
+  itk::MutexLockHolder<itk::SimpleMutexLock> holder(mapMutex);
+  itk::MutexLock::Pointer & mutex = mutexes[modelClass];
+  if (mutex.IsNull())
+    {
+    mutex = itk::MutexLock::New();
+    }
+  return mutex.GetPointer();
+}
+} // end namespace internal
+
+template <class TInputValue, class TTargetValue>
+MachineLearningModelSelection<TInputValue, TTargetValue>
+::MachineLearningModelSelection()
+  : m_ModelGenerator(ITK_NULLPTR),
+    m_ModelGeneratorClientData(ITK_NULLPTR),
+    m_NumberOfFolds(5),
+    m_NumberOfRandomConfigurations(0),
+    m_Seed(0),
+    m_NumberOfThreads(0),
+    m_Metric(Kappa),
+    m_BestConfigurationIndex(0),
+    m_NextTask(0)
+{
+}
+
+template <class TInputValue, class TTargetValue>
+void
+MachineLearningModelSelection<TInputValue, TTargetValue>
+::SetModelGenerator(ModelGeneratorType generator, void * clientData)
+{
+  m_ModelGenerator = generator;
+  m_ModelGeneratorClientData = clientData;
+  this->Modified();
+}
+
+template <class TInputValue, class TTargetValue>
+void
+MachineLearningModelSelection<TInputValue, TTargetValue>
+::AddParameter(const std::string & name, const std::vector<double> & values)
+{
+  if (values.empty())
+    {
+    itkExceptionMacro(<< "No candidate value for the parameter " << name);
+    }
+  m_ParameterNames.push_back(name);
+  m_ParameterValues.push_back(values);
+  this->Modified();
+}
+
+template <class TInputValue, class TTargetValue>
+void
+MachineLearningModelSelection<TInputValue, TTargetValue>
+::ClearParameters()
+{
+  m_ParameterNames.clear();
+  m_ParameterValues.clear();
+  this->Modified();
+}
+
+template <class TInputValue, class TTargetValue>
+const typename MachineLearningModelSelection<TInputValue, TTargetValue>::ParametersType &
+MachineLearningModelSelection<TInputValue, TTargetValue>
+::GetConfiguration(unsigned int configuration) const
+{
+  if (configuration >= m_Configurations.size())
+    {
+    itkExceptionMacro(<< "No configuration " << configuration << ", call Compute() first");
+    }
+  return m_Configurations[configuration];
+}
+
+template <class TInputValue, class TTargetValue>
+double
+MachineLearningModelSelection<TInputValue, TTargetValue>
+::GetFoldOverallAccuracy(unsigned int configuration, unsigned int fold) const
+{
+  return m_Results[configuration * m_NumberOfFolds + fold].OverallAccuracy;
+}
+
+template <class TInputValue, class TTargetValue>
+double
+MachineLearningModelSelection<TInputValue, TTargetValue>
+::GetFoldKappa(unsigned int configuration, unsigned int fold) const
+{
+  return m_Results[configuration * m_NumberOfFolds + fold].Kappa;
+}
+
+template <class TInputValue, class TTargetValue>
+double
+MachineLearningModelSelection<TInputValue, TTargetValue>
+::GetFoldFScore(unsigned int configuration, unsigned int fold) const
+{
+  return m_Results[configuration * m_NumberOfFolds + fold].FScore;
+}
+
+template <class TInputValue, class TTargetValue>
+double
+MachineLearningModelSelection<TInputValue, TTargetValue>
+::GetScore(unsigned int configuration) const
+{
+  double score = 0.;
+  for (unsigned int fold = 0; fold < m_NumberOfFolds; ++fold)
+    {
+    const FoldResultType & result = m_Results[configuration * m_NumberOfFolds + fold];
+    switch (m_Metric)
+      {
+      case OverallAccuracy:
+        score += result.OverallAccuracy;
+        break;
+      case FScore:
+        score += result.FScore;
+        break;
+      default:
+        score += result.Kappa;
+        break;
+      }
+    }
+  return score / static_cast<double>(m_NumberOfFolds);
+}
+
+template <class TInputValue, class TTargetValue>
+void
+MachineLearningModelSelection<TInputValue, TTargetValue>
+::GenerateConfigurations()
+{
+  m_Configurations.clear();
+
+  const unsigned int nbParameters = static_cast<unsigned int>(m_ParameterValues.size());
+  unsigned long gridSize = 1;
+  for (unsigned int p = 0; p < nbParameters; ++p)
+    {
+    gridSize *= m_ParameterValues[p].size();
+    }
+
+  std::vector<unsigned long> indices(gridSize);
+  for (unsigned long i = 0; i < gridSize; ++i)
+    {
+    indices[i] = i;
+    }
+
+  // Random search: partial Fisher-Yates shuffle of the grid
+  if (m_NumberOfRandomConfigurations > 0 && m_NumberOfRandomConfigurations < gridSize)
+    {
+    typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
+    RandomGeneratorType::Pointer randomGenerator = RandomGeneratorType::New();
+    randomGenerator->Initialize(m_Seed);
+    for (unsigned long i = 0; i < m_NumberOfRandomConfigurations; ++i)
+      {
+      const unsigned long j = i + randomGenerator->GetIntegerVariate(gridSize - i - 1);
+      std::swap(indices[i], indices[j]);
+      }
+    indices.resize(m_NumberOfRandomConfigurations);
+    }
+
+  for (unsigned long i = 0; i < indices.size(); ++i)
+    {
+    // Decode the grid index, the last parameter varying the fastest
+    ParametersType configuration(nbParameters);
+    unsigned long index = indices[i];
+    for (unsigned int p = nbParameters; p > 0; --p)
+      {
+      const std::vector<double> & values = m_ParameterValues[p - 1];
+      configuration[p - 1] = values[index % values.size()];
+      index /= values.size();
+      }
+    m_Configurations.push_back(configuration);
+    }
+}
+
+template <class TInputValue, class TTargetValue>
+void
+MachineLearningModelSelection<TInputValue, TTargetValue>
+::GenerateFolds()
+{
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
+  typedef std::map<TargetValueType, std::vector<unsigned long> > ClassMapType;
+
+  const unsigned long nbSamples = m_InputListSample->Size();
+
+  // Group the samples by class, so that each fold has the same
+  // proportion of each class
+  ClassMapType classes;
+  for (unsigned long i = 0; i < nbSamples; ++i)
+    {
+    classes[m_TargetListSample->GetMeasurementVector(i)[0]].push_back(i);
+    }
+
+  RandomGeneratorType::Pointer randomGenerator = RandomGeneratorType::New();
+  randomGenerator->Initialize(m_Seed);
+
+  m_SampleFolds.resize(nbSamples);
+  unsigned long counter = 0;
+  for (typename ClassMapType::iterator it = classes.begin(); it != classes.end(); ++it)
+    {
+    std::vector<unsigned long> & ids = it->second;
+    for (unsigned long i = ids.size(); i > 1; --i)
+      {
+      std::swap(ids[i - 1], ids[randomGenerator->GetIntegerVariate(i - 1)]);
+      }
+    for (unsigned long i = 0; i < ids.size(); ++i, ++counter)
+      {
+      m_SampleFolds[ids[i]] = static_cast<unsigned int>(counter % m_NumberOfFolds);
+      }
+    }
+}
+
+template <class TInputValue, class TTargetValue>
+bool
+MachineLearningModelSelection<TInputValue, TTargetValue>
+::GetNextTask(unsigned int & task)
+{
+  m_Mutex.Lock();
+  const bool hasTask = m_NextTask < m_Results.size() && m_ErrorMessage.empty();
+  task = m_NextTask++;
+  m_Mutex.Unlock();
+  return hasTask;
+}
+
+template <class TInputValue, class TTargetValue>
+void
+MachineLearningModelSelection<TInputValue, TTargetValue>
+::EvaluateTask(unsigned int task)
+{
+  typedef ConfusionMatrixCalculator<TargetListSampleType, TargetListSampleType> ConfusionMatrixCalculatorType;
+
+  const unsigned int configuration = task / m_NumberOfFolds;
+  const unsigned int fold = task % m_NumberOfFolds;
+
+  ModelPointerType model = (*m_ModelGenerator)(m_Configurations[configuration], m_ModelGeneratorClientData);
+  if (model.IsNull())
+    {
+    itkExceptionMacro(<< "The model generator returned a null model");
+    }
+
+  const unsigned long nbSamples = m_InputListSample->Size();
+  unsigned long nbValidationSamples = 0;
+  for (unsigned long i = 0; i < nbSamples; ++i)
+    {
+    if (m_SampleFolds[i] == fold)
+      {
+      ++nbValidationSamples;
+      }
+    }
+
+  // Training samples of the fold, only kept during this task
+  typedef typename ModelType::InputContiguousListSampleType ContiguousListSampleType;
+  typename ContiguousListSampleType::Pointer trainingSamples = ContiguousListSampleType::New();
+  trainingSamples->SetMeasurementVectorSize(m_InputListSample->GetMeasurementVectorSize());
+  trainingSamples->Reserve(nbSamples - nbValidationSamples);
+  typename TargetListSampleType::Pointer trainingLabels = TargetListSampleType::New();
+  for (unsigned long i = 0; i < nbSamples; ++i)
+    {
+    if (m_SampleFolds[i] != fold)
+      {
+      trainingSamples->PushBack(m_InputListSample->GetMeasurementVector(i));
+      trainingLabels->PushBack(m_TargetListSample->GetMeasurementVector(i));
+      }
+    }
+  model->SetInputContiguousListSample(trainingSamples);
+  model->SetTargetListSample(trainingLabels);
+
+  {
+  itk::MutexLockHolder<itk::MutexLock> holder(*internal::GetModelTrainingMutex(model->GetNameOfClass()));
+  model->Train();
+  }
+
+  // Predict the validation samples one by one: PredictBatch() would
+  // start its own threads inside this one
+  typename TargetListSampleType::Pointer referenceLabels = TargetListSampleType::New();
+  typename TargetListSampleType::Pointer predicted = TargetListSampleType::New();
+  for (unsigned long i = 0; i < nbSamples; ++i)
+    {
+    if (m_SampleFolds[i] == fold)
+      {
+      referenceLabels->PushBack(m_TargetListSample->GetMeasurementVector(i));
+      predicted->PushBack(model->Predict(m_InputListSample->GetMeasurementVector(i)));
+      }
+    }
+
+  typename ConfusionMatrixCalculatorType::Pointer calculator = ConfusionMatrixCalculatorType::New();
+  calculator->SetReferenceLabels(referenceLabels);
+  calculator->SetProducedLabels(predicted);
+  calculator->Compute();
+
+  FoldResultType & result = m_Results[task];
+  result.OverallAccuracy = calculator->GetOverallAccuracy();
+  result.Kappa = calculator->GetKappaIndex();
+  result.FScore = calculator->GetFScore();
+}
+
+template <class TInputValue, class TTargetValue>
+void
+MachineLearningModelSelection<TInputValue, TTargetValue>
+::SetTaskError(unsigned int task, const std::string & message)
+{
+  std::ostringstream oss;
+  oss << "configuration " << m_Configurations[task / m_NumberOfFolds]
+      << " on fold " << task % m_NumberOfFolds << ": " << message;
+
+  m_Mutex.Lock();
+  if (m_ErrorMessage.empty())
+    {
+    m_ErrorMessage = oss.str();
+    }
+  m_Mutex.Unlock();
+}
+
+template <class TInputValue, class TTargetValue>
+ITK_THREAD_RETURN_TYPE
+MachineLearningModelSelection<TInputValue, TTargetValue>
+::ThreaderCallback(void * arg)
+{
+  itk::MultiThreader::ThreadInfoStruct* info = static_cast<itk::MultiThreader::ThreadInfoStruct*>(arg);
+  Self* self = static_cast<Self*>(info->UserData);
+
+  unsigned int task = 0;
+  while (self->GetNextTask(task))
+    {
+    try
+      {
+      self->EvaluateTask(task);
+      }
+    catch (std::exception & err)
+      {
+      self->SetTaskError(task, err.what());
+      }
+    catch (...)
+      {
+      self->SetTaskError(task, "unknown exception");
+      }
+    }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+template <class TInputValue, class TTargetValue>
+void
+MachineLearningModelSelection<TInputValue, TTargetValue>
+::Compute()
+{
+  if (m_InputListSample.IsNull() || m_TargetListSample.IsNull())
+    {
+    itkExceptionMacro(<< "The input samples and their labels are required");
+    }
+  if (m_InputListSample->Size() != m_TargetListSample->Size())
+    {
+    itkExceptionMacro(<< "The number of samples (" << m_InputListSample->Size()
+                      << ") and of labels (" << m_TargetListSample->Size() << ") differ");
+    }
+  if (m_ModelGenerator == ITK_NULLPTR)
+    {
+    itkExceptionMacro(<< "No model generator");
+    }
+  if (m_NumberOfFolds < 2 || m_NumberOfFolds > m_InputListSample->Size())
+    {
+    itkExceptionMacro(<< "Can not split " << m_InputListSample->Size() << " samples in "
+                      << m_NumberOfFolds << " folds");
+    }
+
+  this->GenerateConfigurations();
+  this->GenerateFolds();
+
+  m_Results.assign(m_Configurations.size() * m_NumberOfFolds, FoldResultType());
+  m_NextTask = 0;
+  m_ErrorMessage.clear();
+
+  unsigned int nbThreads = m_NumberOfThreads;
+  if (nbThreads == 0)
+    {
+    nbThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+    }
+  nbThreads = std::max(1U, std::min(nbThreads, static_cast<unsigned int>(m_Results.size())));
+
+  otbMsgDevMacro(<< "Evaluating " << m_Configurations.size() << " configurations on "
+                 << m_NumberOfFolds << " folds with " << nbThreads << " threads");
+
+  itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+  threader->SetNumberOfThreads(nbThreads);
+  threader->SetSingleMethod(ThreaderCallback, this);
+  threader->SingleMethodExecute();
+
+  // Release the folds
+  m_SampleFolds.clear();
+
+  if (!m_ErrorMessage.empty())
+    {
+    itkExceptionMacro(<< "Error during the cross-validation: " << m_ErrorMessage);
+    }
+
+  m_BestConfigurationIndex = 0;
+  for (unsigned int i = 1; i < m_Configurations.size(); ++i)
+    {
+    if (this->GetScore(i) > this->GetScore(m_BestConfigurationIndex))
+      {
+      m_BestConfigurationIndex = i;
+      }
+    }
+}
+
+template <class TInputValue, class TTargetValue>
+void
+MachineLearningModelSelection<TInputValue, TTargetValue>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Number of parameters: " << m_ParameterNames.size() << std::endl;
+  os << indent << "Number of folds: " << m_NumberOfFolds << std::endl;
+  os << indent << "Number of random configurations: " << m_NumberOfRandomConfigurations << std::endl;
+  os << indent << "Seed: " << m_Seed << std::endl;
+  os << indent << "Number of threads: " << m_NumberOfThreads << std::endl;
+  os << indent << "Metric: " << m_Metric << std::endl;
+  os << indent << "Number of configurations: " << m_Configurations.size() << std::endl;
+  if (!m_Configurations.empty() && !m_Results.empty())
+    {
+    os << indent << "Best configuration: " << this->GetBestConfiguration()
+       << " (score " << this->GetBestScore() << ")" << std::endl;
+    }
+}
+
+} // end namespace otb
+
+#endif
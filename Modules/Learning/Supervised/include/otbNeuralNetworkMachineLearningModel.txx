@@ -188,7 +188,7 @@ void NeuralNetworkMachineLearningModel<TInputValue, TOutputValue>::SetupNetworkA
 {
   //convert listsample to opencv matrix
   cv::Mat samples;
-  otb::ListSampleToMat<InputListSampleType>(this->GetInputListSample(), samples);
+  otb::TrainingSamplesToMat(this, samples);
   this->CreateNetwork();
 #ifdef OTB_OPENCV_3
   int flags = (this->m_RegressionMode ? 0 : cv::ml::ANN_MLP::NO_OUTPUT_SCALE);
@@ -46,6 +46,7 @@
 #include "OTBSupervisedExport.h"
 
 #include "itkListSample.h"
+#include "otbContiguousListSample.h"
 
 #ifdef OTB_OPENCV_3
 #define CV_TYPE_NAME_ML_SVM         "opencv-ml-svm"
@@ -106,7 +107,7 @@ namespace otb
        for(; sampleIt!=listSample->End(); ++sampleIt,++sampleIdx)
          {
            // Retrieve sample
-           typename T::MeasurementVectorType sample = sampleIt.GetMeasurementVector();
+           const typename T::MeasurementVectorType & sample = sampleIt.GetMeasurementVector();
 
            // Loop on sample size
            for(unsigned int i = 0; i < sampleSize; ++i)
@@ -125,6 +126,59 @@ namespace otb
     return ListSampleToMat(listSample.GetPointer(), output);
   }
 
+  /** Wraps the buffer of a ContiguousListSample of float in a cv::Mat,
+   *  without copy. The output is only valid while the list sample is
+   *  alive and not modified, and must not be modified itself.
+   */
+  inline void ListSampleToMat(const Statistics::ContiguousListSample<float> * listSample, cv::Mat & output)
+  {
+    if(listSample != ITK_NULLPTR && listSample->Size() > 0)
+      {
+      output = cv::Mat(static_cast<int>(listSample->Size()),
+                       static_cast<int>(listSample->GetMeasurementVectorSize()),
+                       CV_32FC1,
+                       const_cast<float *>(listSample->GetBufferPointer()));
+      }
+  }
+
+  /** Converts a ContiguousListSample of another value type to a cv::Mat,
+   *  reading its buffer directly.
+   */
+  template <class TValue> void ListSampleToMat(const Statistics::ContiguousListSample<TValue> * listSample, cv::Mat & output)
+  {
+    if(listSample != ITK_NULLPTR && listSample->Size() > 0)
+      {
+      const unsigned int sampleCount = listSample->Size();
+      const unsigned int sampleSize = listSample->GetMeasurementVectorSize();
+      output.create(sampleCount,sampleSize,CV_32FC1);
+      const TValue * data = listSample->GetBufferPointer();
+      for(unsigned int sampleIdx = 0; sampleIdx < sampleCount; ++sampleIdx)
+        {
+        float * row = output.ptr<float>(sampleIdx);
+        for(unsigned int i = 0; i < sampleSize; ++i, ++data)
+          {
+          row[i] = static_cast<float>(*data);
+          }
+        }
+      }
+  }
+
+  /** Converts the training samples of a machine learning model to a
+   *  cv::Mat: its contiguous input list sample if it is set (wrapped
+   *  without copy for float values), its input list sample otherwise.
+   */
+  template <class TModel> void TrainingSamplesToMat(TModel * model, cv::Mat & output)
+  {
+    if(model->GetInputContiguousListSample() != ITK_NULLPTR)
+      {
+      ListSampleToMat(model->GetInputContiguousListSample(), output);
+      }
+    else
+      {
+      ListSampleToMat(model->GetInputListSample(), output);
+      }
+  }
+
   template <typename T> typename T::Pointer MatToListSample(const cv::Mat & cvmat)
     {
       // Build output type
@@ -51,6 +51,9 @@ public:
   typedef typename Superclass::TargetSampleType           TargetSampleType;
   typedef typename Superclass::TargetListSampleType       TargetListSampleType;
   typedef typename Superclass::ConfidenceValueType        ConfidenceValueType;
+  typedef typename Superclass::ConfidenceListSampleType   ConfidenceListSampleType;
+  typedef typename Superclass::ProbaSampleType            ProbaSampleType;
+  typedef typename Superclass::ProbaListSampleType        ProbaListSampleType;
   
   // Other
   typedef itk::VariableSizeMatrix<float>                VariableImportanceMatrixType;
@@ -140,6 +143,18 @@ protected:
   /** Predict values using the model */
   TargetSampleType DoPredict(const InputSampleType& input, ConfidenceValueType *quality=ITK_NULLPTR) const ITK_OVERRIDE;
 
+  /** Predict a range of samples by blocks, with the flat copy of the
+   * forest */
+  void DoPredictBatch(const InputListSampleType * input, const unsigned int & startIndex, const unsigned int & size, TargetListSampleType * targets, ConfidenceListSampleType * quality = ITK_NULLPTR) const ITK_OVERRIDE;
+
+  /** Predict values and the proportion of the trees voting for each
+   * class */
+  TargetSampleType DoPredictProba(const InputSampleType& input, ConfidenceValueType *quality, ProbaSampleType & proba) const ITK_OVERRIDE;
+
+  /** Predict a range of samples by blocks, with the proportion of the
+   * trees voting for each class */
+  void DoPredictBatchProba(const InputListSampleType * input, const unsigned int & startIndex, const unsigned int & size, TargetListSampleType * targets, ConfidenceListSampleType * quality, ProbaListSampleType * proba) const ITK_OVERRIDE;
+
   
   /** PrintSelf method */
   void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
@@ -154,6 +169,13 @@ private:
   RandomForestsMachineLearningModel(const Self &); //purposely not implemented
   void operator =(const Self&); //purposely not implemented
 
+  /** Copy the trained or loaded forest to m_TreeEnsemble */
+  void UpdateTreeEnsemble();
+
+  /** Block prediction with m_TreeEnsemble, with the class probabilities
+   * if proba is not NULL */
+  void PredictBatchWithEnsemble(const InputListSampleType * input, const unsigned int & startIndex, const unsigned int & size, TargetListSampleType * targets, ConfidenceListSampleType * quality, ProbaListSampleType * proba) const;
+
 #ifdef OTB_OPENCV_3
   cv::Ptr<CvRTreesWrapper> m_RFModel;
 #else
@@ -222,6 +244,9 @@ private:
    * 2 most voted classes) instead of confidence (probability of the most
    * voted class) in prediction*/
   bool m_ComputeMargin;
+  /** Flat copy of the forest used for prediction. It is empty if the
+   * forest can not be converted, in which case OpenCV is used. */
+  FlatTreeEnsemble m_TreeEnsemble;
 };
 } // end namespace otb
 
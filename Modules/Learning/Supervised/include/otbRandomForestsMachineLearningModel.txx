@@ -22,7 +22,9 @@
 #define otbRandomForestsMachineLearningModel_txx
 
 #include <fstream>
+#include <algorithm>
 #include "itkMacro.h"
+#include "otbMacro.h"
 #include "otbRandomForestsMachineLearningModel.h"
 #include "otbOpenCVUtils.h"
 
@@ -71,18 +73,18 @@ RandomForestsMachineLearningModel<TInputValue,TOutputValue>
 #ifdef OTB_OPENCV_3
   // TODO
   cv::Mat samples;
-  otb::ListSampleToMat<InputListSampleType>(this->GetInputListSample(), samples);
+  otb::TrainingSamplesToMat(this, samples);
 
   cv::Mat labels;
   otb::ListSampleToMat<TargetListSampleType>(this->GetTargetListSample(),labels);
 
-  cv::Mat var_type = cv::Mat(this->GetInputListSample()->GetMeasurementVectorSize() + 1, 1, CV_8U );
+  cv::Mat var_type = cv::Mat(samples.cols + 1, 1, CV_8U );
   var_type.setTo(cv::Scalar(CV_VAR_NUMERICAL) ); // all inputs are numerical
 
   if(this->m_RegressionMode)
-    var_type.at<uchar>(this->GetInputListSample()->GetMeasurementVectorSize(), 0) = CV_VAR_NUMERICAL;
+    var_type.at<uchar>(samples.cols, 0) = CV_VAR_NUMERICAL;
   else
-    var_type.at<uchar>(this->GetInputListSample()->GetMeasurementVectorSize(), 0) = CV_VAR_CATEGORICAL;
+    var_type.at<uchar>(samples.cols, 0) = CV_VAR_CATEGORICAL;
 
   return m_RFModel->calcError(
     cv::ml::TrainData::create(
@@ -108,18 +110,18 @@ RandomForestsMachineLearningModel<TInputValue,TOutputValue>
 {
   //convert listsample to opencv matrix
   cv::Mat samples;
-  otb::ListSampleToMat<InputListSampleType>(this->GetInputListSample(), samples);
+  otb::TrainingSamplesToMat(this, samples);
 
   cv::Mat labels;
   otb::ListSampleToMat<TargetListSampleType>(this->GetTargetListSample(),labels);
 
-  cv::Mat var_type = cv::Mat(this->GetInputListSample()->GetMeasurementVectorSize() + 1, 1, CV_8U );
+  cv::Mat var_type = cv::Mat(samples.cols + 1, 1, CV_8U );
   var_type.setTo(cv::Scalar(CV_VAR_NUMERICAL) ); // all inputs are numerical
 
   if(this->m_RegressionMode)
-    var_type.at<uchar>(this->GetInputListSample()->GetMeasurementVectorSize(), 0) = CV_VAR_NUMERICAL;
+    var_type.at<uchar>(samples.cols, 0) = CV_VAR_NUMERICAL;
   else
-    var_type.at<uchar>(this->GetInputListSample()->GetMeasurementVectorSize(), 0) = CV_VAR_CATEGORICAL;
+    var_type.at<uchar>(samples.cols, 0) = CV_VAR_CATEGORICAL;
 
   //Mat var_type = Mat(ATTRIBUTES_PER_SAMPLE + 1, 1, CV_8U );
   //std::cout << "priors " << m_Priors[0] << std::endl;
@@ -165,6 +167,35 @@ RandomForestsMachineLearningModel<TInputValue,TOutputValue>
   m_RFModel->train(samples, CV_ROW_SAMPLE, labels,
                    cv::Mat(), cv::Mat(), var_type, cv::Mat(), params);
 #endif
+  this->UpdateTreeEnsemble();
+}
+
+template <class TInputValue, class TOutputValue>
+void
+RandomForestsMachineLearningModel<TInputValue,TOutputValue>
+::UpdateTreeEnsemble()
+{
+  this->m_ProbaLabels.clear();
+  if (!m_RFModel->ExportTreeEnsemble(m_TreeEnsemble))
+    {
+    otbMsgDevMacro(<< "The forest can not be converted to a flat ensemble, OpenCV is used for the prediction");
+    m_TreeEnsemble.Clear();
+    return;
+    }
+
+  // The votes of the classes give their probabilities, in the order of
+  // the labels
+  for (unsigned int c = 0; c < m_TreeEnsemble.GetNumberOfClasses(); ++c)
+    {
+    const TargetValueType label = static_cast<TargetValueType>(m_TreeEnsemble.GetClassValue(c));
+    if (c > 0 && !(this->m_ProbaLabels.back() < label))
+      {
+      otbMsgDevMacro(<< "The classes of the forest are not sorted, class probabilities are not available");
+      this->m_ProbaLabels.clear();
+      break;
+      }
+    this->m_ProbaLabels.push_back(label);
+    }
 }
 
 template <class TInputValue, class TOutputValue>
@@ -174,6 +205,32 @@ RandomForestsMachineLearningModel<TInputValue,TOutputValue>
 ::DoPredict(const InputSampleType & value, ConfidenceValueType *quality) const
 {
   TargetSampleType target;
+
+  if (!m_TreeEnsemble.IsEmpty())
+    {
+    const unsigned int nbFeatures = m_TreeEnsemble.GetNumberOfFeatures();
+    if (value.Size() < nbFeatures)
+      {
+      itkExceptionMacro(<< "The sample has " << value.Size() << " features instead of " << nbFeatures);
+      }
+    std::vector<float> sample(nbFeatures);
+    for (unsigned int i = 0; i < nbFeatures; ++i)
+      {
+      sample[i] = static_cast<float>(value[i]);
+      }
+
+    float result = 0.f;
+    float confidence = 0.f;
+    m_TreeEnsemble.Predict(&sample[0], 1, nbFeatures, &result,
+                           quality != ITK_NULLPTR ? &confidence : ITK_NULLPTR, m_ComputeMargin);
+    target[0] = static_cast<TOutputValue>(result);
+    if (quality != ITK_NULLPTR)
+      {
+      (*quality) = confidence;
+      }
+    return target[0];
+    }
+
   //convert listsample to Mat
   cv::Mat sample;
 
@@ -193,6 +250,127 @@ RandomForestsMachineLearningModel<TInputValue,TOutputValue>
   return target[0];
 }
 
+template <class TInputValue, class TOutputValue>
+void
+RandomForestsMachineLearningModel<TInputValue,TOutputValue>
+::DoPredictBatch(const InputListSampleType * input, const unsigned int & startIndex, const unsigned int & size, TargetListSampleType * targets, ConfidenceListSampleType * quality) const
+{
+  if (m_TreeEnsemble.IsEmpty())
+    {
+    Superclass::DoPredictBatch(input, startIndex, size, targets, quality);
+    return;
+    }
+  this->PredictBatchWithEnsemble(input, startIndex, size, targets, quality, ITK_NULLPTR);
+}
+
+template <class TInputValue, class TOutputValue>
+typename RandomForestsMachineLearningModel<TInputValue,TOutputValue>
+::TargetSampleType
+RandomForestsMachineLearningModel<TInputValue,TOutputValue>
+::DoPredictProba(const InputSampleType & value, ConfidenceValueType *quality, ProbaSampleType & proba) const
+{
+  const unsigned int nbFeatures = m_TreeEnsemble.GetNumberOfFeatures();
+  if (value.Size() < nbFeatures)
+    {
+    itkExceptionMacro(<< "The sample has " << value.Size() << " features instead of " << nbFeatures);
+    }
+  std::vector<float> sample(nbFeatures);
+  for (unsigned int i = 0; i < nbFeatures; ++i)
+    {
+    sample[i] = static_cast<float>(value[i]);
+    }
+
+  const unsigned int nbClasses = m_TreeEnsemble.GetNumberOfClasses();
+  std::vector<float> probabilities(nbClasses);
+  float result = 0.f;
+  float confidence = 0.f;
+  m_TreeEnsemble.Predict(&sample[0], 1, nbFeatures, &result,
+                         quality != ITK_NULLPTR ? &confidence : ITK_NULLPTR, m_ComputeMargin, &probabilities[0]);
+  for (unsigned int c = 0; c < nbClasses; ++c)
+    {
+    proba[c] = static_cast<ConfidenceValueType>(probabilities[c]);
+    }
+  if (quality != ITK_NULLPTR)
+    {
+    (*quality) = confidence;
+    }
+
+  TargetSampleType target;
+  target[0] = static_cast<TOutputValue>(result);
+  return target;
+}
+
+template <class TInputValue, class TOutputValue>
+void
+RandomForestsMachineLearningModel<TInputValue,TOutputValue>
+::DoPredictBatchProba(const InputListSampleType * input, const unsigned int & startIndex, const unsigned int & size, TargetListSampleType * targets, ConfidenceListSampleType * quality, ProbaListSampleType * proba) const
+{
+  this->PredictBatchWithEnsemble(input, startIndex, size, targets, quality, proba);
+}
+
+template <class TInputValue, class TOutputValue>
+void
+RandomForestsMachineLearningModel<TInputValue,TOutputValue>
+::PredictBatchWithEnsemble(const InputListSampleType * input, const unsigned int & startIndex, const unsigned int & size, TargetListSampleType * targets, ConfidenceListSampleType * quality, ProbaListSampleType * proba) const
+{
+  if (startIndex + size > input->Size())
+    {
+    itkExceptionMacro(<<"requested range ["<<startIndex<<", "<<startIndex+size<<"[ partially outside input sample list range.[0,"<<input->Size()<<"[");
+    }
+
+  const unsigned int nbFeatures = m_TreeEnsemble.GetNumberOfFeatures();
+  if (input->GetMeasurementVectorSize() < nbFeatures)
+    {
+    itkExceptionMacro(<< "The samples have " << input->GetMeasurementVectorSize() << " features instead of " << nbFeatures);
+    }
+
+  const unsigned int blockSize = FlatTreeEnsemble::BlockSize;
+  std::vector<float> samples(blockSize * nbFeatures);
+  std::vector<float> results(blockSize);
+  std::vector<float> confidences(blockSize);
+  const unsigned int nbClasses = m_TreeEnsemble.GetNumberOfClasses();
+  std::vector<float> probabilities(proba != ITK_NULLPTR ? blockSize * nbClasses : 0);
+  ProbaSampleType probaSample(nbClasses);
+
+  for (unsigned int start = startIndex; start < startIndex + size; start += blockSize)
+    {
+    const unsigned int nbSamples = std::min(blockSize, startIndex + size - start);
+
+    // Copy the block to a contiguous buffer of float
+    for (unsigned int i = 0; i < nbSamples; ++i)
+      {
+      const InputSampleType & sample = input->GetMeasurementVector(start + i);
+      for (unsigned int j = 0; j < nbFeatures; ++j)
+        {
+        samples[i * nbFeatures + j] = static_cast<float>(sample[j]);
+        }
+      }
+
+    m_TreeEnsemble.Predict(&samples[0], nbSamples, nbFeatures, &results[0],
+                           quality != ITK_NULLPTR ? &confidences[0] : ITK_NULLPTR, m_ComputeMargin,
+                           proba != ITK_NULLPTR ? &probabilities[0] : ITK_NULLPTR);
+
+    for (unsigned int i = 0; i < nbSamples; ++i)
+      {
+      TargetSampleType target;
+      target[0] = static_cast<TOutputValue>(results[i]);
+      targets->SetMeasurementVector(start + i, target);
+      if (quality != ITK_NULLPTR)
+        {
+        quality->SetMeasurementVector(start + i, static_cast<ConfidenceValueType>(confidences[i]));
+        }
+      if (proba != ITK_NULLPTR)
+        {
+        for (unsigned int c = 0; c < nbClasses; ++c)
+          {
+          probaSample[c] = static_cast<ConfidenceValueType>(probabilities[i * nbClasses + c]);
+          }
+        proba->SetMeasurementVector(start + i, probaSample);
+        }
+      }
+    }
+}
+
 template <class TInputValue, class TOutputValue>
 void
 RandomForestsMachineLearningModel<TInputValue,TOutputValue>
@@ -226,6 +404,7 @@ RandomForestsMachineLearningModel<TInputValue,TOutputValue>
   else
     m_RFModel->load(filename.c_str(), name.c_str());
 #endif
+  this->UpdateTreeEnsemble();
 }
 
 template <class TInputValue, class TOutputValue>
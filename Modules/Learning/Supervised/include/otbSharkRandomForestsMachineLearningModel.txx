@@ -74,7 +74,7 @@ SharkRandomForestsMachineLearningModel<TInputValue,TOutputValue>
   std::vector<shark::RealVector> features;
   std::vector<unsigned int> class_labels;
 
-  Shark::ListSampleToSharkVector(this->GetInputListSample(), features);
+  Shark::TrainingSamplesToSharkVector(this, features);
   Shark::ListSampleToSharkVector(this->GetTargetListSample(), class_labels);
   shark::ClassificationDataset TrainSamples = shark::createLabeledDataFromRange(features,class_labels);
 
@@ -0,0 +1,331 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef otbStreamingConfusionMatrixImageFilter_h
+#define otbStreamingConfusionMatrixImageFilter_h
+
+#include "otbPersistentImageFilter.h"
+#include "otbPersistentFilterStreamingDecorator.h"
+#include "otbConfusionMatrixMeasurements.h"
+#include "itkVariableSizeMatrix.h"
+#include "itkNumericTraits.h"
+
+#include <map>
+#include <vector>
+
+namespace otb
+{
+
+/** \class PersistentConfusionMatrixImageFilter
+ * \brief Accumulate the confusion matrix of a classification over streamed pieces
+ *
+ * The first input is the produced classification, and the reference
+ * labels are given by SetReferenceImage() (a ground truth raster, or a
+ * rasterized vector layer). Both images must have the same size. Pixels
+ * whose reference or produced label is a no-data value are ignored.
+ *
+ * Each thread counts the pairs of reference/produced labels in its own
+ * dense matrix, indexed by the order of appearance of the labels. Labels
+ * in [0, DirectLabelRange) are indexed through a lookup table, other
+ * labels through a map. The thread matrices are kept from one piece to
+ * the next, so that no label list is ever built, and they are merged in
+ * Synthetize().
+ *
+ * After Synthetize(), GetConfusionMatrix() holds the counts for all the
+ * labels found in the images, sorted by increasing values (rows =
+ * reference labels, columns = produced labels). The measurements
+ * (precisions, recalls, F-scores, kappa and overall accuracy) are
+ * computed on the square matrix of the reference labels, so that
+ * produced labels missing from the reference are ignored.
+ *
+ * \sa ConfusionMatrixCalculator
+ * \sa StreamingConfusionMatrixImageFilter
+ * \ingroup Streamed
+ * \ingroup Multithreaded
+ *
+ * \ingroup OTBSupervised
+ */
+template <class TProducedImage, class TReferenceImage = TProducedImage>
+class ITK_EXPORT PersistentConfusionMatrixImageFilter :
+  public PersistentImageFilter<TProducedImage, TProducedImage>
+{
+public:
+  /** Standard Self typedef */
+  typedef PersistentConfusionMatrixImageFilter                  Self;
+  typedef PersistentImageFilter<TProducedImage, TProducedImage> Superclass;
+  typedef itk::SmartPointer<Self>                               Pointer;
+  typedef itk::SmartPointer<const Self>                         ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(PersistentConfusionMatrixImageFilter, PersistentImageFilter);
+
+  /** Image related typedefs. */
+  typedef TProducedImage                            ProducedImageType;
+  typedef TReferenceImage                           ReferenceImageType;
+  typedef typename ProducedImageType::RegionType    RegionType;
+
+  typedef typename ReferenceImageType::PixelType    ClassLabelType;
+  typedef std::vector<ClassLabelType>               LabelListType;
+
+  typedef unsigned long                                   ConfusionMatrixEltType;
+  typedef itk::VariableSizeMatrix<ConfusionMatrixEltType> ConfusionMatrixType;
+
+  typedef ConfusionMatrixMeasurements<ConfusionMatrixType, ClassLabelType> ConfusionMatrixMeasurementsType;
+  typedef typename ConfusionMatrixMeasurementsType::MapOfClassesType      MapOfClassesType;
+
+  /** Labels below this value are indexed through a lookup table */
+  itkStaticConstMacro(DirectLabelRange, unsigned int, 4096);
+
+  /** Set/Get the reference labels */
+  void SetReferenceImage(const ReferenceImageType * reference);
+  const ReferenceImageType * GetReferenceImage() const;
+
+  /** Set/Get the no-data label of the reference image, used only if
+   * ReferenceNoDataFlag is on (default is off) */
+  itkSetMacro(ReferenceNoDataValue, ClassLabelType);
+  itkGetConstMacro(ReferenceNoDataValue, ClassLabelType);
+  itkSetMacro(ReferenceNoDataFlag, bool);
+  itkGetConstMacro(ReferenceNoDataFlag, bool);
+  itkBooleanMacro(ReferenceNoDataFlag);
+
+  /** Set/Get the no-data label of the produced image, used only if
+   * ProducedNoDataFlag is on (default is off) */
+  itkSetMacro(ProducedNoDataValue, ClassLabelType);
+  itkGetConstMacro(ProducedNoDataValue, ClassLabelType);
+  itkSetMacro(ProducedNoDataFlag, bool);
+  itkGetConstMacro(ProducedNoDataFlag, bool);
+  itkBooleanMacro(ProducedNoDataFlag);
+
+  /** Labels of the rows and columns of the confusion matrix */
+  itkGetConstReferenceMacro(Labels, LabelListType);
+
+  /** Labels found in the reference and in the produced image */
+  itkGetConstReferenceMacro(ReferenceLabels, LabelListType);
+  itkGetConstReferenceMacro(ProducedLabels, LabelListType);
+
+  /** Counts of the reference (rows) / produced (columns) label pairs */
+  itkGetConstReferenceMacro(ConfusionMatrix, ConfusionMatrixType);
+
+  /** Number of pixels counted in the confusion matrix */
+  itkGetConstMacro(NumberOfSamples, unsigned long);
+
+  /** Measurements on the square matrix of the reference labels */
+  ConfusionMatrixMeasurementsType * GetMeasurements() const
+  {
+    return m_Measurements;
+  }
+
+  void Reset(void) ITK_OVERRIDE;
+  void Synthetize(void) ITK_OVERRIDE;
+
+protected:
+  PersistentConfusionMatrixImageFilter();
+  ~PersistentConfusionMatrixImageFilter() ITK_OVERRIDE {}
+
+  /** The output image of this filter is not intended to be used */
+  void AllocateOutputs() ITK_OVERRIDE {}
+  void GenerateOutputInformation() ITK_OVERRIDE;
+
+  void BeforeThreadedGenerateData() ITK_OVERRIDE;
+  void ThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId) ITK_OVERRIDE;
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
+
+private:
+  PersistentConfusionMatrixImageFilter(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  /** Dense confusion matrix of a thread, over the labels it has met */
+  class ThreadAccumulator
+  {
+  public:
+    ThreadAccumulator();
+
+    /** Index of a label, added if new */
+    unsigned int GetIndex(ClassLabelType label)
+    {
+      if (itk::NumericTraits<ClassLabelType>::IsNonnegative(label)
+          && label < static_cast<ClassLabelType>(DirectLabelRange)
+          && static_cast<ClassLabelType>(static_cast<unsigned int>(label)) == label)
+        {
+        const int index = m_DirectIndices[static_cast<unsigned int>(label)];
+        return index >= 0 ? static_cast<unsigned int>(index) : AddLabel(label);
+        }
+      const typename std::map<ClassLabelType, unsigned int>::const_iterator it = m_OtherIndices.find(label);
+      return it != m_OtherIndices.end() ? it->second : AddLabel(label);
+    }
+
+    void Add(unsigned int refIndex, unsigned int prodIndex, ConfusionMatrixEltType count)
+    {
+      m_Counts[refIndex * m_Capacity + prodIndex] += count;
+    }
+
+    ConfusionMatrixEltType GetCount(unsigned int refIndex, unsigned int prodIndex) const
+    {
+      return m_Counts[refIndex * m_Capacity + prodIndex];
+    }
+
+    const LabelListType & GetLabels() const
+    {
+      return m_Labels;
+    }
+
+  private:
+    unsigned int AddLabel(ClassLabelType label);
+
+    std::vector<int>                        m_DirectIndices;
+    std::map<ClassLabelType, unsigned int>  m_OtherIndices;
+    LabelListType                           m_Labels;
+    /** Row major counts, with m_Capacity columns */
+    std::vector<ConfusionMatrixEltType>     m_Counts;
+    unsigned int                            m_Capacity;
+  };
+
+  ClassLabelType m_ReferenceNoDataValue;
+  bool           m_ReferenceNoDataFlag;
+  ClassLabelType m_ProducedNoDataValue;
+  bool           m_ProducedNoDataFlag;
+
+  std::vector<ThreadAccumulator> m_ThreadAccumulators;
+
+  LabelListType       m_Labels;
+  LabelListType       m_ReferenceLabels;
+  LabelListType       m_ProducedLabels;
+  ConfusionMatrixType m_ConfusionMatrix;
+  unsigned long       m_NumberOfSamples;
+
+  typename ConfusionMatrixMeasurementsType::Pointer m_Measurements;
+};
+
+/** \class StreamingConfusionMatrixImageFilter
+ * \brief Compute the confusion matrix of a classification with streaming
+ *
+ * This class streams the whole produced and reference images through
+ * the PersistentConfusionMatrixImageFilter.
+ *
+ * \sa PersistentConfusionMatrixImageFilter
+ * \ingroup Streamed
+ * \ingroup Multithreaded
+ *
+ * \ingroup OTBSupervised
+ */
+template <class TProducedImage, class TReferenceImage = TProducedImage>
+class ITK_EXPORT StreamingConfusionMatrixImageFilter :
+  public PersistentFilterStreamingDecorator<PersistentConfusionMatrixImageFilter<TProducedImage, TReferenceImage> >
+{
+public:
+  /** Standard Self typedef */
+  typedef StreamingConfusionMatrixImageFilter Self;
+  typedef PersistentFilterStreamingDecorator
+  <PersistentConfusionMatrixImageFilter<TProducedImage, TReferenceImage> > Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Type macro */
+  itkNewMacro(Self);
+
+  /** Creation through object factory macro */
+  itkTypeMacro(StreamingConfusionMatrixImageFilter, PersistentFilterStreamingDecorator);
+
+  typedef TProducedImage                                        ProducedImageType;
+  typedef TReferenceImage                                       ReferenceImageType;
+  typedef typename Superclass::FilterType                       ConfusionMatrixFilterType;
+  typedef typename ConfusionMatrixFilterType::ClassLabelType    ClassLabelType;
+  typedef typename ConfusionMatrixFilterType::LabelListType     LabelListType;
+  typedef typename ConfusionMatrixFilterType::ConfusionMatrixType ConfusionMatrixType;
+  typedef typename ConfusionMatrixFilterType::ConfusionMatrixMeasurementsType ConfusionMatrixMeasurementsType;
+
+  using Superclass::SetInput;
+  void SetInput(const ProducedImageType * input)
+  {
+    this->GetFilter()->SetInput(input);
+  }
+  const ProducedImageType * GetInput()
+  {
+    return this->GetFilter()->GetInput();
+  }
+
+  void SetReferenceImage(const ReferenceImageType * reference)
+  {
+    this->GetFilter()->SetReferenceImage(reference);
+  }
+
+  void SetReferenceNoDataValue(ClassLabelType value)
+  {
+    this->GetFilter()->SetReferenceNoDataValue(value);
+    this->GetFilter()->ReferenceNoDataFlagOn();
+  }
+
+  void SetProducedNoDataValue(ClassLabelType value)
+  {
+    this->GetFilter()->SetProducedNoDataValue(value);
+    this->GetFilter()->ProducedNoDataFlagOn();
+  }
+
+  const LabelListType & GetLabels() const
+  {
+    return this->GetFilter()->GetLabels();
+  }
+
+  const LabelListType & GetReferenceLabels() const
+  {
+    return this->GetFilter()->GetReferenceLabels();
+  }
+
+  const LabelListType & GetProducedLabels() const
+  {
+    return this->GetFilter()->GetProducedLabels();
+  }
+
+  const ConfusionMatrixType & GetConfusionMatrix() const
+  {
+    return this->GetFilter()->GetConfusionMatrix();
+  }
+
+  unsigned long GetNumberOfSamples() const
+  {
+    return this->GetFilter()->GetNumberOfSamples();
+  }
+
+  ConfusionMatrixMeasurementsType * GetMeasurements() const
+  {
+    return this->GetFilter()->GetMeasurements();
+  }
+
+protected:
+  StreamingConfusionMatrixImageFilter() {}
+  ~StreamingConfusionMatrixImageFilter() ITK_OVERRIDE {}
+
+private:
+  StreamingConfusionMatrixImageFilter(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbStreamingConfusionMatrixImageFilter.txx"
+#endif
+
+#endif
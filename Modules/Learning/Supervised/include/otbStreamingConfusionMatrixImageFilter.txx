@@ -0,0 +1,306 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef otbStreamingConfusionMatrixImageFilter_txx
+#define otbStreamingConfusionMatrixImageFilter_txx
+
+#include "otbStreamingConfusionMatrixImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "otbMacro.h"
+
+#include <algorithm>
+
+namespace otb
+{
+
+template <class TProducedImage, class TReferenceImage>
+PersistentConfusionMatrixImageFilter<TProducedImage, TReferenceImage>
+::ThreadAccumulator
+::ThreadAccumulator()
+  : m_DirectIndices(DirectLabelRange, -1),
+    m_Capacity(0)
+{
+}
+
+template <class TProducedImage, class TReferenceImage>
+unsigned int
+PersistentConfusionMatrixImageFilter<TProducedImage, TReferenceImage>
+::ThreadAccumulator
+::AddLabel(ClassLabelType label)
+{
+  const unsigned int index = m_Labels.size();
+  m_Labels.push_back(label);
+  if (itk::NumericTraits<ClassLabelType>::IsNonnegative(label)
+      && label < static_cast<ClassLabelType>(DirectLabelRange)
+      && static_cast<ClassLabelType>(static_cast<unsigned int>(label)) == label)
+    {
+    m_DirectIndices[static_cast<unsigned int>(label)] = index;
+    }
+  else
+    {
+    m_OtherIndices[label] = index;
+    }
+
+  // Grow the matrix by doubling its capacity, so that the counts are
+  // moved only a few times
+  if (index >= m_Capacity)
+    {
+    const unsigned int capacity = std::max(2 * m_Capacity, 16U);
+    std::vector<ConfusionMatrixEltType> counts(capacity * capacity, 0);
+    for (unsigned int i = 0; i < m_Capacity; ++i)
+      {
+      std::copy(m_Counts.begin() + i * m_Capacity, m_Counts.begin() + (i + 1) * m_Capacity,
+                counts.begin() + i * capacity);
+      }
+    m_Counts.swap(counts);
+    m_Capacity = capacity;
+    }
+  return index;
+}
+
+template <class TProducedImage, class TReferenceImage>
+PersistentConfusionMatrixImageFilter<TProducedImage, TReferenceImage>
+::PersistentConfusionMatrixImageFilter()
+  : m_ReferenceNoDataValue(itk::NumericTraits<ClassLabelType>::Zero),
+    m_ReferenceNoDataFlag(false),
+    m_ProducedNoDataValue(itk::NumericTraits<ClassLabelType>::Zero),
+    m_ProducedNoDataFlag(false),
+    m_NumberOfSamples(0),
+    m_Measurements(ConfusionMatrixMeasurementsType::New())
+{
+  this->SetNumberOfRequiredInputs(2);
+}
+
+template <class TProducedImage, class TReferenceImage>
+void
+PersistentConfusionMatrixImageFilter<TProducedImage, TReferenceImage>
+::SetReferenceImage(const ReferenceImageType * reference)
+{
+  this->itk::ProcessObject::SetNthInput(1, const_cast<ReferenceImageType *>(reference));
+}
+
+template <class TProducedImage, class TReferenceImage>
+const typename PersistentConfusionMatrixImageFilter<TProducedImage, TReferenceImage>::ReferenceImageType *
+PersistentConfusionMatrixImageFilter<TProducedImage, TReferenceImage>
+::GetReferenceImage() const
+{
+  if (this->GetNumberOfInputs() < 2)
+    {
+    return ITK_NULLPTR;
+    }
+  return static_cast<const ReferenceImageType *>(this->itk::ProcessObject::GetInput(1));
+}
+
+template <class TProducedImage, class TReferenceImage>
+void
+PersistentConfusionMatrixImageFilter<TProducedImage, TReferenceImage>
+::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+  if (this->GetInput())
+    {
+    this->GetOutput()->CopyInformation(this->GetInput());
+    this->GetOutput()->SetLargestPossibleRegion(this->GetInput()->GetLargestPossibleRegion());
+
+    if (this->GetOutput()->GetRequestedRegion().GetNumberOfPixels() == 0)
+      {
+      this->GetOutput()->SetRequestedRegion(this->GetOutput()->GetLargestPossibleRegion());
+      }
+    }
+}
+
+template <class TProducedImage, class TReferenceImage>
+void
+PersistentConfusionMatrixImageFilter<TProducedImage, TReferenceImage>
+::Reset()
+{
+  ProducedImageType * producedPtr = const_cast<ProducedImageType *>(this->GetInput());
+  ReferenceImageType * referencePtr = const_cast<ReferenceImageType *>(this->GetReferenceImage());
+  if (referencePtr == ITK_NULLPTR)
+    {
+    itkExceptionMacro(<< "No reference image");
+    }
+  producedPtr->UpdateOutputInformation();
+  referencePtr->UpdateOutputInformation();
+
+  if (producedPtr->GetLargestPossibleRegion().GetSize() != referencePtr->GetLargestPossibleRegion().GetSize())
+    {
+    itkExceptionMacro(<< "The produced image (" << producedPtr->GetLargestPossibleRegion().GetSize()
+                      << ") and the reference image (" << referencePtr->GetLargestPossibleRegion().GetSize()
+                      << ") do not have the same size");
+    }
+
+  m_ThreadAccumulators.assign(this->GetNumberOfThreads(), ThreadAccumulator());
+  m_Labels.clear();
+  m_ReferenceLabels.clear();
+  m_ProducedLabels.clear();
+  m_ConfusionMatrix.SetSize(0, 0);
+  m_NumberOfSamples = 0;
+}
+
+template <class TProducedImage, class TReferenceImage>
+void
+PersistentConfusionMatrixImageFilter<TProducedImage, TReferenceImage>
+::BeforeThreadedGenerateData()
+{
+  // Counts are kept from one piece to the next, only new threads get
+  // an empty matrix
+  if (m_ThreadAccumulators.size() < this->GetNumberOfThreads())
+    {
+    m_ThreadAccumulators.resize(this->GetNumberOfThreads());
+    }
+}
+
+template <class TProducedImage, class TReferenceImage>
+void
+PersistentConfusionMatrixImageFilter<TProducedImage, TReferenceImage>
+::ThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId)
+{
+  typedef itk::ImageRegionConstIterator<ProducedImageType>  ProducedIteratorType;
+  typedef itk::ImageRegionConstIterator<ReferenceImageType> ReferenceIteratorType;
+
+  ProducedIteratorType  prodIt(this->GetInput(), outputRegionForThread);
+  ReferenceIteratorType refIt(this->GetReferenceImage(), outputRegionForThread);
+
+  ThreadAccumulator & accumulator = m_ThreadAccumulators[threadId];
+
+  for (prodIt.GoToBegin(), refIt.GoToBegin(); !prodIt.IsAtEnd(); ++prodIt, ++refIt)
+    {
+    const ClassLabelType refLabel = refIt.Get();
+    const ClassLabelType prodLabel = static_cast<ClassLabelType>(prodIt.Get());
+    if ((m_ReferenceNoDataFlag && refLabel == m_ReferenceNoDataValue)
+        || (m_ProducedNoDataFlag && prodLabel == m_ProducedNoDataValue))
+      {
+      continue;
+      }
+    const unsigned int refIndex = accumulator.GetIndex(refLabel);
+    accumulator.Add(refIndex, accumulator.GetIndex(prodLabel), 1);
+    }
+}
+
+template <class TProducedImage, class TReferenceImage>
+void
+PersistentConfusionMatrixImageFilter<TProducedImage, TReferenceImage>
+::Synthetize()
+{
+  // All the labels met by the threads, sorted
+  m_Labels.clear();
+  for (unsigned int t = 0; t < m_ThreadAccumulators.size(); ++t)
+    {
+    const LabelListType & labels = m_ThreadAccumulators[t].GetLabels();
+    m_Labels.insert(m_Labels.end(), labels.begin(), labels.end());
+    }
+  std::sort(m_Labels.begin(), m_Labels.end());
+  m_Labels.erase(std::unique(m_Labels.begin(), m_Labels.end()), m_Labels.end());
+
+  const unsigned int nbLabels = m_Labels.size();
+  m_ConfusionMatrix.SetSize(nbLabels, nbLabels);
+  m_ConfusionMatrix.Fill(0);
+
+  // Merge the thread matrices
+  for (unsigned int t = 0; t < m_ThreadAccumulators.size(); ++t)
+    {
+    const ThreadAccumulator & accumulator = m_ThreadAccumulators[t];
+    const LabelListType &     labels = accumulator.GetLabels();
+    std::vector<unsigned int> positions(labels.size());
+    for (unsigned int i = 0; i < labels.size(); ++i)
+      {
+      positions[i] = std::lower_bound(m_Labels.begin(), m_Labels.end(), labels[i]) - m_Labels.begin();
+      }
+    for (unsigned int i = 0; i < labels.size(); ++i)
+      {
+      for (unsigned int j = 0; j < labels.size(); ++j)
+        {
+        m_ConfusionMatrix(positions[i], positions[j]) += accumulator.GetCount(i, j);
+        }
+      }
+    }
+  m_ThreadAccumulators.clear();
+
+  // Reference labels are the non empty rows, produced labels the non
+  // empty columns
+  m_ReferenceLabels.clear();
+  m_ProducedLabels.clear();
+  m_NumberOfSamples = 0;
+  std::vector<unsigned int> refPositions;
+  for (unsigned int i = 0; i < nbLabels; ++i)
+    {
+    ConfusionMatrixEltType rowSum = 0;
+    ConfusionMatrixEltType colSum = 0;
+    for (unsigned int j = 0; j < nbLabels; ++j)
+      {
+      rowSum += m_ConfusionMatrix(i, j);
+      colSum += m_ConfusionMatrix(j, i);
+      }
+    if (rowSum > 0)
+      {
+      m_ReferenceLabels.push_back(m_Labels[i]);
+      refPositions.push_back(i);
+      }
+    if (colSum > 0)
+      {
+      m_ProducedLabels.push_back(m_Labels[i]);
+      }
+    m_NumberOfSamples += rowSum;
+    }
+
+  // Measurements on the square matrix of the reference labels
+  const unsigned int nbRefLabels = refPositions.size();
+  ConfusionMatrixType refMatrix(nbRefLabels, nbRefLabels);
+  MapOfClassesType    mapOfClasses;
+  for (unsigned int i = 0; i < nbRefLabels; ++i)
+    {
+    mapOfClasses[m_ReferenceLabels[i]] = i;
+    for (unsigned int j = 0; j < nbRefLabels; ++j)
+      {
+      refMatrix(i, j) = m_ConfusionMatrix(refPositions[i], refPositions[j]);
+      }
+    }
+
+  m_Measurements = ConfusionMatrixMeasurementsType::New();
+  if (nbRefLabels > 0)
+    {
+    m_Measurements->SetMapOfClasses(mapOfClasses);
+    m_Measurements->SetConfusionMatrix(refMatrix);
+    m_Measurements->Compute();
+    }
+
+  otbMsgDevMacro(<< m_NumberOfSamples << " samples, " << m_ReferenceLabels.size() << " reference labels, "
+                 << m_ProducedLabels.size() << " produced labels");
+}
+
+template <class TProducedImage, class TReferenceImage>
+void
+PersistentConfusionMatrixImageFilter<TProducedImage, TReferenceImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Reference no-data: " << m_ReferenceNoDataValue
+     << (m_ReferenceNoDataFlag ? "" : " (not used)") << std::endl;
+  os << indent << "Produced no-data: " << m_ProducedNoDataValue
+     << (m_ProducedNoDataFlag ? "" : " (not used)") << std::endl;
+  os << indent << "Number of labels: " << m_Labels.size() << std::endl;
+  os << indent << "Number of samples: " << m_NumberOfSamples << std::endl;
+}
+
+} // end namespace otb
+
+#endif
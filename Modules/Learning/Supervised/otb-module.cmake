@@ -31,6 +31,7 @@ ENABLE_SHARED
     OTBImageBase
     OTBLabelMap
     OTBLearningBase
+    OTBStreaming
     OTBUnsupervised
 
   OPTIONAL_DEPENDS
@@ -141,6 +141,121 @@ float CvRTreesWrapper::predict_confidence(const cv::Mat& sample,
   return confidence;
 }
 
+bool CvRTreesWrapper::ExportTreeEnsemble(FlatTreeEnsemble & ensemble) const
+{
+  ensemble.Clear();
+
+#ifdef OTB_OPENCV_3
+  const std::vector< cv::ml::DTrees::Node > &nodes = m_Impl->getNodes();
+  const std::vector< cv::ml::DTrees::Split > &splits = m_Impl->getSplits();
+  const std::vector<int> &roots = m_Impl->getRoots();
+  if (roots.empty())
+    {
+    return false;
+    }
+
+  // Nodes of all the trees, with the OpenCV indices: AddTree() only
+  // copies the nodes reachable from the given root
+  FlatTreeEnsemble::TreeType tree(nodes.size());
+  int nbClasses = 0;
+  for (unsigned int i = 0; i < nodes.size(); ++i)
+    {
+    const cv::ml::DTrees::Node &node = nodes[i];
+    if (node.split < 0)
+      {
+      tree[i].Threshold = static_cast<float>(node.value);
+      tree[i].Feature = -1;
+      tree[i].Left = node.classIdx;
+      tree[i].Right = -1;
+      nbClasses = std::max(nbClasses, node.classIdx + 1);
+      continue;
+      }
+    const cv::ml::DTrees::Split &split = splits[node.split];
+    if (split.subsetOfs >= 0)
+      {
+      // Categorical split
+      return false;
+      }
+    tree[i].Threshold = split.c;
+    tree[i].Feature = split.varIdx;
+    tree[i].Left = split.inversed ? node.right : node.left;
+    tree[i].Right = split.inversed ? node.left : node.right;
+    }
+
+  ensemble.SetNumberOfFeatures(m_Impl->getVarCount());
+  ensemble.SetNumberOfClasses(m_Impl->isClassifier() ? nbClasses : 0);
+  ensemble.SetTieBreak(FlatTreeEnsemble::LowestClassIndex);
+  for (unsigned int t = 0; t < roots.size(); ++t)
+    {
+    ensemble.AddTree(tree, roots[t]);
+    }
+#else
+  if (ntrees == 0 || data == ITK_NULLPTR)
+    {
+    return false;
+    }
+
+  const int* vidx = data->var_idx ? data->var_idx->data.i : ITK_NULLPTR;
+  int nbFeatures = data->var_count;
+  if (vidx != ITK_NULLPTR)
+    {
+    nbFeatures = *std::max_element(vidx, vidx + data->var_count) + 1;
+    }
+
+  ensemble.SetNumberOfFeatures(nbFeatures);
+  ensemble.SetNumberOfClasses(nclasses);
+  ensemble.SetTieBreak(FlatTreeEnsemble::FirstReachedMaximum);
+
+  std::vector<std::pair<const CvDTreeNode*, int> > stack;
+  for (int k = 0; k < ntrees; ++k)
+    {
+    FlatTreeEnsemble::TreeType tree;
+    const int prunedTreeIdx = trees[k]->get_pruned_tree_idx();
+    stack.clear();
+    stack.push_back(std::make_pair(static_cast<const CvDTreeNode*>(trees[k]->get_root()), 0));
+    tree.resize(1);
+
+    while (!stack.empty())
+      {
+      const CvDTreeNode* node = stack.back().first;
+      const int index = stack.back().second;
+      stack.pop_back();
+
+      // Same leaf condition as CvDTree::predict()
+      if (node->Tn <= prunedTreeIdx || node->left == ITK_NULLPTR || node->split == ITK_NULLPTR)
+        {
+        tree[index].Threshold = static_cast<float>(node->value);
+        tree[index].Feature = -1;
+        tree[index].Left = node->class_idx;
+        tree[index].Right = -1;
+        continue;
+        }
+
+      const CvDTreeSplit* split = node->split;
+      if (data->get_var_type(split->var_idx) >= 0)
+        {
+        // Categorical split
+        return false;
+        }
+
+      const int leftIndex = static_cast<int>(tree.size());
+      tree.resize(tree.size() + 2);
+      tree[index].Threshold = split->ord.c;
+      tree[index].Feature = vidx != ITK_NULLPTR ? vidx[split->var_idx] : split->var_idx;
+      tree[index].Left = split->inversed ? leftIndex + 1 : leftIndex;
+      tree[index].Right = split->inversed ? leftIndex : leftIndex + 1;
+
+      stack.push_back(std::make_pair(static_cast<const CvDTreeNode*>(node->left), leftIndex));
+      stack.push_back(std::make_pair(static_cast<const CvDTreeNode*>(node->right), leftIndex + 1));
+      }
+
+    ensemble.AddTree(tree, 0);
+    }
+#endif
+
+  return true;
+}
+
 #ifdef OTB_OPENCV_3
 #define OTB_CV_WRAP_IMPL(type,name) \
 type CvRTreesWrapper::get##name() const \
@@ -0,0 +1,495 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbDenseSVMModel.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace otb
+{
+
+const unsigned int DenseSVMModel::BlockSize;
+
+DenseSVMModel::DenseSVMModel()
+  : m_ProblemType(Classification),
+    m_KernelType(Linear),
+    m_Degree(3),
+    m_Gamma(1.),
+    m_Coef0(0.),
+    m_NumberOfFeatures(0),
+    m_NumberOfSupportVectors(0),
+    m_BinaryPairwiseProbability(false)
+{
+}
+
+void DenseSVMModel::Clear()
+{
+  m_NumberOfFeatures = 0;
+  m_NumberOfSupportVectors = 0;
+  m_SupportVectors.clear();
+  m_Labels.clear();
+  m_ClassStart.clear();
+  m_ClassCount.clear();
+  m_Coefficients.clear();
+  m_Rho.clear();
+  m_ProbA.clear();
+  m_ProbB.clear();
+}
+
+void DenseSVMModel::SetKernel(KernelType type, int degree, double gamma, double coef0)
+{
+  if (type != Linear && type != Polynomial && type != RBF && type != Sigmoid)
+    {
+    itkGenericExceptionMacro(<< "Unsupported kernel type " << static_cast<int>(type));
+    }
+  m_KernelType = type;
+  m_Degree = degree;
+  m_Gamma = gamma;
+  m_Coef0 = coef0;
+}
+
+void DenseSVMModel::SetSupportVectors(const std::vector<double> & values, unsigned int nbFeatures)
+{
+  if (nbFeatures == 0 || values.size() % nbFeatures != 0)
+    {
+    itkGenericExceptionMacro(<< "Can not split " << values.size() << " values in support vectors of "
+                             << nbFeatures << " features");
+    }
+  m_NumberOfFeatures = nbFeatures;
+  m_NumberOfSupportVectors = static_cast<unsigned int>(values.size() / nbFeatures);
+  m_SupportVectors = values;
+}
+
+void DenseSVMModel::SetClasses(const std::vector<double> & labels,
+                               const std::vector<unsigned int> & nbSupportVectors)
+{
+  if (labels.size() != nbSupportVectors.size())
+    {
+    itkGenericExceptionMacro(<< labels.size() << " labels for " << nbSupportVectors.size() << " classes");
+    }
+  m_Labels = labels;
+  m_ClassCount = nbSupportVectors;
+  m_ClassStart.resize(nbSupportVectors.size());
+  unsigned int start = 0;
+  for (unsigned int c = 0; c < nbSupportVectors.size(); ++c)
+    {
+    m_ClassStart[c] = start;
+    start += nbSupportVectors[c];
+    }
+}
+
+unsigned int DenseSVMModel::GetNumberOfDecisionValues() const
+{
+  if (m_ProblemType != Classification)
+    {
+    return 1;
+    }
+  const unsigned int nbClasses = this->GetNumberOfClasses();
+  return nbClasses * (nbClasses - 1) / 2;
+}
+
+void DenseSVMModel::SetCoefficients(const std::vector<double> & coefficients)
+{
+  m_Coefficients = coefficients;
+}
+
+void DenseSVMModel::SetRho(const std::vector<double> & rho)
+{
+  m_Rho = rho;
+}
+
+void DenseSVMModel::SetProbabilityParameters(const std::vector<double> & probA,
+                                             const std::vector<double> & probB)
+{
+  if (probA.size() != probB.size())
+    {
+    itkGenericExceptionMacro(<< "Different numbers of probability parameters A and B");
+    }
+  m_ProbA = probA;
+  m_ProbB = probB;
+}
+
+void DenseSVMModel::Predict(const double * samples,
+                            std::size_t nbSamples,
+                            std::size_t stride,
+                            double * outputs,
+                            double * decisionValues,
+                            double * probabilities) const
+{
+  if (m_NumberOfSupportVectors == 0)
+    {
+    itkGenericExceptionMacro(<< "The model has no support vector");
+    }
+
+  // Check the consistency of the decision functions
+  unsigned int nbRows = 1;
+  if (m_ProblemType == Classification)
+    {
+    if (m_Labels.empty()
+        || m_ClassStart.back() + m_ClassCount.back() != m_NumberOfSupportVectors)
+      {
+      itkGenericExceptionMacro(<< "The classes do not match the " << m_NumberOfSupportVectors << " support vectors");
+      }
+    nbRows = this->GetNumberOfClasses() - 1;
+    }
+  const unsigned int nbDecisions = this->GetNumberOfDecisionValues();
+  if (m_Coefficients.size() != static_cast<std::size_t>(nbRows) * m_NumberOfSupportVectors
+      || m_Rho.size() < nbDecisions
+      || (!m_ProbA.empty() && m_ProbA.size() < nbDecisions))
+    {
+    itkGenericExceptionMacro(<< "The coefficients do not match the decision functions");
+    }
+
+  std::vector<double> transposed(static_cast<std::size_t>(BlockSize) * m_NumberOfFeatures);
+  std::vector<double> kernel(static_cast<std::size_t>(BlockSize) * m_NumberOfSupportVectors);
+  std::vector<double> decisions(static_cast<std::size_t>(BlockSize) * std::max(nbDecisions, 1U));
+
+  const bool withProbabilities = probabilities != ITK_NULLPTR && this->HasProbabilities()
+    && m_ProblemType == Classification;
+
+  for (std::size_t start = 0; start < nbSamples; start += BlockSize)
+    {
+    const std::size_t blockSize = std::min(static_cast<std::size_t>(BlockSize), nbSamples - start);
+    this->PredictBlock(samples + start * stride,
+                       blockSize,
+                       stride,
+                       outputs + start,
+                       decisionValues != ITK_NULLPTR ? decisionValues + start * nbDecisions : ITK_NULLPTR,
+                       withProbabilities ? probabilities + start * this->GetNumberOfClasses() : ITK_NULLPTR,
+                       &transposed[0],
+                       &kernel[0],
+                       &decisions[0]);
+    }
+}
+
+void DenseSVMModel::PredictBlock(const double * samples,
+                                 std::size_t nbSamples,
+                                 std::size_t stride,
+                                 double * outputs,
+                                 double * decisionValues,
+                                 double * probabilities,
+                                 double * transposed,
+                                 double * kernel,
+                                 double * decisions) const
+{
+  // Transpose the block, so that a feature is contiguous for all the
+  // samples
+  for (std::size_t i = 0; i < nbSamples; ++i)
+    {
+    const double * sample = samples + i * stride;
+    for (unsigned int f = 0; f < m_NumberOfFeatures; ++f)
+      {
+      transposed[f * BlockSize + i] = sample[f];
+      }
+    }
+
+  this->ComputeKernel(transposed, nbSamples, kernel);
+
+  const unsigned int nbDecisions = this->GetNumberOfDecisionValues();
+  const unsigned int nbSV = m_NumberOfSupportVectors;
+
+  if (m_ProblemType != Classification)
+    {
+    double * sums = decisions;
+    std::fill(sums, sums + nbSamples, 0.);
+    const double * coefficients = &m_Coefficients[0];
+    for (unsigned int k = 0; k < nbSV; ++k)
+      {
+      const double coef = coefficients[k];
+      const double * kvalues = kernel + k * BlockSize;
+      for (std::size_t i = 0; i < nbSamples; ++i)
+        {
+        sums[i] += coef * kvalues[i];
+        }
+      }
+    for (std::size_t i = 0; i < nbSamples; ++i)
+      {
+      sums[i] -= m_Rho[0];
+      if (decisionValues != ITK_NULLPTR)
+        {
+        decisionValues[i] = sums[i];
+        }
+      if (m_ProblemType == OneClass)
+        {
+        outputs[i] = sums[i] > 0 ? 1. : -1.;
+        }
+      else
+        {
+        outputs[i] = sums[i];
+        }
+      }
+    return;
+    }
+
+  // One decision function per pair of classes (i, j), with the support
+  // vectors of both classes, in the order of svm_predict_values()
+  const unsigned int nbClasses = this->GetNumberOfClasses();
+  unsigned int p = 0;
+  for (unsigned int ci = 0; ci < nbClasses; ++ci)
+    {
+    for (unsigned int cj = ci + 1; cj < nbClasses; ++cj, ++p)
+      {
+      double * sums = decisions + p * BlockSize;
+      std::fill(sums, sums + nbSamples, 0.);
+
+      const double * coef1 = &m_Coefficients[(cj - 1) * nbSV];
+      const double * coef2 = &m_Coefficients[ci * nbSV];
+      const unsigned int endi = m_ClassStart[ci] + m_ClassCount[ci];
+      for (unsigned int k = m_ClassStart[ci]; k < endi; ++k)
+        {
+        const double coef = coef1[k];
+        const double * kvalues = kernel + k * BlockSize;
+        for (std::size_t i = 0; i < nbSamples; ++i)
+          {
+          sums[i] += coef * kvalues[i];
+          }
+        }
+      const unsigned int endj = m_ClassStart[cj] + m_ClassCount[cj];
+      for (unsigned int k = m_ClassStart[cj]; k < endj; ++k)
+        {
+        const double coef = coef2[k];
+        const double * kvalues = kernel + k * BlockSize;
+        for (std::size_t i = 0; i < nbSamples; ++i)
+          {
+          sums[i] += coef * kvalues[i];
+          }
+        }
+      const double rho = m_Rho[p];
+      for (std::size_t i = 0; i < nbSamples; ++i)
+        {
+        sums[i] -= rho;
+        }
+      }
+    }
+
+  std::vector<double> sampleDecisions(nbDecisions);
+  std::vector<unsigned int> votes(nbClasses);
+  for (std::size_t i = 0; i < nbSamples; ++i)
+    {
+    for (unsigned int d = 0; d < nbDecisions; ++d)
+      {
+      sampleDecisions[d] = decisions[d * BlockSize + i];
+      }
+    if (decisionValues != ITK_NULLPTR)
+      {
+      std::copy(sampleDecisions.begin(), sampleDecisions.end(), decisionValues + i * nbDecisions);
+      }
+
+    unsigned int best = 0;
+    if (probabilities != ITK_NULLPTR)
+      {
+      double * sampleProbabilities = probabilities + i * nbClasses;
+      this->ComputeProbabilities(nbDecisions > 0 ? &sampleDecisions[0] : ITK_NULLPTR, sampleProbabilities);
+      for (unsigned int c = 1; c < nbClasses; ++c)
+        {
+        if (sampleProbabilities[c] > sampleProbabilities[best])
+          {
+          best = c;
+          }
+        }
+      }
+    else
+      {
+      std::fill(votes.begin(), votes.end(), 0U);
+      p = 0;
+      for (unsigned int ci = 0; ci < nbClasses; ++ci)
+        {
+        for (unsigned int cj = ci + 1; cj < nbClasses; ++cj, ++p)
+          {
+          if (sampleDecisions[p] > 0)
+            {
+            ++votes[ci];
+            }
+          else
+            {
+            ++votes[cj];
+            }
+          }
+        }
+      for (unsigned int c = 1; c < nbClasses; ++c)
+        {
+        if (votes[c] > votes[best])
+          {
+          best = c;
+          }
+        }
+      }
+    outputs[i] = m_Labels[best];
+    }
+}
+
+void DenseSVMModel::ComputeKernel(const double * transposed, std::size_t nbSamples, double * kernel) const
+{
+  const unsigned int nbFeatures = m_NumberOfFeatures;
+
+  for (unsigned int k = 0; k < m_NumberOfSupportVectors; ++k)
+    {
+    const double * sv = &m_SupportVectors[static_cast<std::size_t>(k) * nbFeatures];
+    double * kvalues = kernel + k * BlockSize;
+    std::fill(kvalues, kvalues + nbSamples, 0.);
+
+    if (m_KernelType == RBF)
+      {
+      for (unsigned int f = 0; f < nbFeatures; ++f)
+        {
+        const double value = sv[f];
+        const double * x = transposed + f * BlockSize;
+        for (std::size_t i = 0; i < nbSamples; ++i)
+          {
+          const double d = x[i] - value;
+          kvalues[i] += d * d;
+          }
+        }
+      for (std::size_t i = 0; i < nbSamples; ++i)
+        {
+        kvalues[i] = std::exp(-m_Gamma * kvalues[i]);
+        }
+      continue;
+      }
+
+    for (unsigned int f = 0; f < nbFeatures; ++f)
+      {
+      const double value = sv[f];
+      const double * x = transposed + f * BlockSize;
+      for (std::size_t i = 0; i < nbSamples; ++i)
+        {
+        kvalues[i] += x[i] * value;
+        }
+      }
+
+    if (m_KernelType == Polynomial)
+      {
+      for (std::size_t i = 0; i < nbSamples; ++i)
+        {
+        // Same integer power as libsvm
+        double base = m_Gamma * kvalues[i] + m_Coef0;
+        double result = 1.;
+        for (int t = m_Degree; t > 0; t /= 2)
+          {
+          if (t % 2 == 1)
+            {
+            result *= base;
+            }
+          base = base * base;
+          }
+        kvalues[i] = result;
+        }
+      }
+    else if (m_KernelType == Sigmoid)
+      {
+      for (std::size_t i = 0; i < nbSamples; ++i)
+        {
+        kvalues[i] = std::tanh(m_Gamma * kvalues[i] + m_Coef0);
+        }
+      }
+    }
+}
+
+void DenseSVMModel::ComputeProbabilities(const double * decisionValues, double * probabilities) const
+{
+  const unsigned int nbClasses = this->GetNumberOfClasses();
+  const double minProb = 1e-7;
+
+  // Pairwise probabilities from the sigmoid of the decision values
+  std::vector<double> r(nbClasses * nbClasses, 0.);
+  unsigned int p = 0;
+  for (unsigned int i = 0; i < nbClasses; ++i)
+    {
+    for (unsigned int j = i + 1; j < nbClasses; ++j, ++p)
+      {
+      const double fApB = decisionValues[p] * m_ProbA[p] + m_ProbB[p];
+      // 1-p is used later, avoid catastrophic cancellation
+      const double sigmoid = fApB >= 0 ? std::exp(-fApB) / (1.0 + std::exp(-fApB))
+                                       : 1.0 / (1 + std::exp(fApB));
+      r[i * nbClasses + j] = std::min(std::max(sigmoid, minProb), 1 - minProb);
+      r[j * nbClasses + i] = 1 - r[i * nbClasses + j];
+      }
+    }
+
+  if (nbClasses == 2 && m_BinaryPairwiseProbability)
+    {
+    probabilities[0] = r[1];
+    probabilities[1] = r[2];
+    return;
+    }
+
+  // Coupling of the pairwise probabilities, method 2 of Wu, Lin and Weng
+  // (2004), as implemented in libsvm
+  const unsigned int k = nbClasses;
+  const unsigned int maxIter = std::max(100U, k);
+  const double eps = 0.005 / k;
+  std::vector<double> Q(k * k);
+  std::vector<double> Qp(k);
+
+  for (unsigned int t = 0; t < k; ++t)
+    {
+    probabilities[t] = 1.0 / k;
+    Q[t * k + t] = 0;
+    for (unsigned int j = 0; j < t; ++j)
+      {
+      Q[t * k + t] += r[j * k + t] * r[j * k + t];
+      Q[t * k + j] = Q[j * k + t];
+      }
+    for (unsigned int j = t + 1; j < k; ++j)
+      {
+      Q[t * k + t] += r[j * k + t] * r[j * k + t];
+      Q[t * k + j] = -r[j * k + t] * r[t * k + j];
+      }
+    }
+
+  for (unsigned int iter = 0; iter < maxIter; ++iter)
+    {
+    // Stopping condition, recompute Qp and pQp for numerical accuracy
+    double pQp = 0;
+    for (unsigned int t = 0; t < k; ++t)
+      {
+      Qp[t] = 0;
+      for (unsigned int j = 0; j < k; ++j)
+        {
+        Qp[t] += Q[t * k + j] * probabilities[j];
+        }
+      pQp += probabilities[t] * Qp[t];
+      }
+    double maxError = 0;
+    for (unsigned int t = 0; t < k; ++t)
+      {
+      maxError = std::max(maxError, std::fabs(Qp[t] - pQp));
+      }
+    if (maxError < eps)
+      {
+      break;
+      }
+
+    for (unsigned int t = 0; t < k; ++t)
+      {
+      const double diff = (-Qp[t] + pQp) / Q[t * k + t];
+      probabilities[t] += diff;
+      pQp = (pQp + diff * (diff * Q[t * k + t] + 2 * Qp[t])) / (1 + diff) / (1 + diff);
+      for (unsigned int j = 0; j < k; ++j)
+        {
+        Qp[j] = (Qp[j] + diff * Q[t * k + j]) / (1 + diff);
+        probabilities[j] /= (1 + diff);
+        }
+      }
+    }
+}
+
+} // end namespace otb
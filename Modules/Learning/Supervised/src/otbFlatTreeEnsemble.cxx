@@ -0,0 +1,260 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbFlatTreeEnsemble.h"
+
+#include <algorithm>
+#include <deque>
+
+namespace otb
+{
+
+const unsigned int FlatTreeEnsemble::BlockSize;
+
+FlatTreeEnsemble::FlatTreeEnsemble()
+  : m_NumberOfFeatures(0),
+    m_NumberOfClasses(0),
+    m_TieBreak(LowestClassIndex)
+{
+}
+
+void FlatTreeEnsemble::Clear()
+{
+  m_Nodes.clear();
+  m_Roots.clear();
+  m_ClassValues.clear();
+  m_NumberOfClasses = 0;
+}
+
+void FlatTreeEnsemble::SetNumberOfFeatures(unsigned int nbFeatures)
+{
+  m_NumberOfFeatures = nbFeatures;
+}
+
+void FlatTreeEnsemble::SetNumberOfClasses(unsigned int nbClasses)
+{
+  m_NumberOfClasses = nbClasses;
+  m_ClassValues.assign(nbClasses, 0.f);
+}
+
+void FlatTreeEnsemble::AddTree(const TreeType & tree, int root)
+{
+  if (root < 0 || static_cast<std::size_t>(root) >= tree.size())
+    {
+    itkGenericExceptionMacro(<< "Invalid root " << root << " for a tree of " << tree.size() << " nodes");
+    }
+
+  const int rootIndex = static_cast<int>(m_Nodes.size());
+  m_Roots.push_back(rootIndex);
+  m_Nodes.push_back(tree[root]);
+
+  // Breadth-first copy: each entry of the queue is a node already copied
+  // in m_Nodes, with its index in the input tree
+  std::deque<std::pair<int, int> > queue;
+  queue.push_back(std::make_pair(rootIndex, root));
+  std::size_t nbCopied = 1;
+
+  while (!queue.empty())
+    {
+    const int flatIndex = queue.front().first;
+    const NodeType node = tree[queue.front().second];
+    queue.pop_front();
+
+    if (node.Feature < 0)
+      {
+      if (m_NumberOfClasses > 0)
+        {
+        if (node.Left < 0 || static_cast<unsigned int>(node.Left) >= m_NumberOfClasses)
+          {
+          itkGenericExceptionMacro(<< "Invalid class index " << node.Left);
+          }
+        m_ClassValues[node.Left] = node.Threshold;
+        }
+      continue;
+      }
+
+    if (static_cast<unsigned int>(node.Feature) >= m_NumberOfFeatures
+        || node.Left < 0 || static_cast<std::size_t>(node.Left) >= tree.size()
+        || node.Right < 0 || static_cast<std::size_t>(node.Right) >= tree.size())
+      {
+      itkGenericExceptionMacro(<< "Invalid node in the tree");
+      }
+
+    // More nodes than in the input tree: it has a cycle
+    nbCopied += 2;
+    if (nbCopied > tree.size())
+      {
+      itkGenericExceptionMacro(<< "The tree has a cycle");
+      }
+
+    // The two children are adjacent
+    const int leftIndex = static_cast<int>(m_Nodes.size());
+    m_Nodes.push_back(tree[node.Left]);
+    m_Nodes.push_back(tree[node.Right]);
+    m_Nodes[flatIndex].Left = leftIndex;
+    m_Nodes[flatIndex].Right = leftIndex + 1;
+
+    queue.push_back(std::make_pair(leftIndex, node.Left));
+    queue.push_back(std::make_pair(leftIndex + 1, node.Right));
+    }
+}
+
+void FlatTreeEnsemble::Predict(const float * samples,
+                               std::size_t nbSamples,
+                               std::size_t stride,
+                               float * outputs,
+                               float * confidences,
+                               bool margin,
+                               float * probabilities) const
+{
+  if (m_Roots.empty())
+    {
+    itkGenericExceptionMacro(<< "The ensemble has no tree");
+    }
+
+  for (std::size_t start = 0; start < nbSamples; start += BlockSize)
+    {
+    const std::size_t blockSize = std::min(static_cast<std::size_t>(BlockSize), nbSamples - start);
+    this->PredictBlock(samples + start * stride,
+                       blockSize,
+                       stride,
+                       outputs + start,
+                       confidences != ITK_NULLPTR ? confidences + start : ITK_NULLPTR,
+                       margin,
+                       probabilities != ITK_NULLPTR ? probabilities + start * m_NumberOfClasses : ITK_NULLPTR);
+    }
+}
+
+void FlatTreeEnsemble::PredictBlock(const float * samples,
+                                    std::size_t nbSamples,
+                                    std::size_t stride,
+                                    float * outputs,
+                                    float * confidences,
+                                    bool margin,
+                                    float * probabilities) const
+{
+  const NodeType * nodes = &m_Nodes[0];
+  const std::size_t nbTrees = m_Roots.size();
+
+  // Leaf reached by each sample in the current tree
+  int leaves[BlockSize];
+
+  if (m_NumberOfClasses == 0)
+    {
+    double sums[BlockSize];
+    std::fill(sums, sums + nbSamples, 0.);
+
+    for (std::size_t t = 0; t < nbTrees; ++t)
+      {
+      const int root = m_Roots[t];
+      for (std::size_t i = 0; i < nbSamples; ++i)
+        {
+        const float * sample = samples + i * stride;
+        int idx = root;
+        while (nodes[idx].Feature >= 0)
+          {
+          const NodeType & node = nodes[idx];
+          idx = node.Left + !(sample[node.Feature] <= node.Threshold);
+          }
+        leaves[i] = idx;
+        }
+      for (std::size_t i = 0; i < nbSamples; ++i)
+        {
+        sums[i] += nodes[leaves[i]].Threshold;
+        }
+      }
+
+    for (std::size_t i = 0; i < nbSamples; ++i)
+      {
+      outputs[i] = static_cast<float>(sums[i] / static_cast<double>(nbTrees));
+      if (confidences != ITK_NULLPTR)
+        {
+        confidences[i] = 0.f;
+        }
+      }
+    return;
+    }
+
+  const unsigned int nbClasses = m_NumberOfClasses;
+  std::vector<unsigned int> votes(nbSamples * nbClasses, 0);
+  unsigned int maxVotes[BlockSize];
+  int bestClass[BlockSize];
+  std::fill(maxVotes, maxVotes + nbSamples, 0U);
+  std::fill(bestClass, bestClass + nbSamples, 0);
+
+  for (std::size_t t = 0; t < nbTrees; ++t)
+    {
+    const int root = m_Roots[t];
+    for (std::size_t i = 0; i < nbSamples; ++i)
+      {
+      const float * sample = samples + i * stride;
+      int idx = root;
+      while (nodes[idx].Feature >= 0)
+        {
+        const NodeType & node = nodes[idx];
+        idx = node.Left + !(sample[node.Feature] <= node.Threshold);
+        }
+      leaves[i] = idx;
+      }
+    for (std::size_t i = 0; i < nbSamples; ++i)
+      {
+      const int classIndex = nodes[leaves[i]].Left;
+      const unsigned int nbVotes = ++votes[i * nbClasses + classIndex];
+      if (nbVotes > maxVotes[i]
+          || (nbVotes == maxVotes[i] && m_TieBreak == LowestClassIndex && classIndex < bestClass[i]))
+        {
+        maxVotes[i] = nbVotes;
+        bestClass[i] = classIndex;
+        }
+      }
+    }
+
+  for (std::size_t i = 0; i < nbSamples; ++i)
+    {
+    outputs[i] = m_ClassValues[bestClass[i]];
+
+    if (confidences != ITK_NULLPTR)
+      {
+      unsigned int second = 0;
+      if (margin)
+        {
+        const unsigned int * sampleVotes = &votes[i * nbClasses];
+        for (unsigned int c = 0; c < nbClasses; ++c)
+          {
+          if (static_cast<int>(c) != bestClass[i])
+            {
+            second = std::max(second, sampleVotes[c]);
+            }
+          }
+        }
+      confidences[i] = static_cast<float>(maxVotes[i] - second) / static_cast<float>(nbTrees);
+      }
+
+    if (probabilities != ITK_NULLPTR)
+      {
+      for (unsigned int c = 0; c < nbClasses; ++c)
+        {
+        probabilities[i * nbClasses + c] = static_cast<float>(votes[i * nbClasses + c]) / static_cast<float>(nbTrees);
+        }
+      }
+    }
+}
+
+} // end namespace otb
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+
+#include "otbFlatTreeEnsemble.h"
+
+namespace
+{
+typedef otb::FlatTreeEnsemble EnsembleType;
+
+EnsembleType::NodeType MakeNode(int feature, float threshold, int left, int right)
+{
+  EnsembleType::NodeType node;
+  node.Feature = feature;
+  node.Threshold = threshold;
+  node.Left = left;
+  node.Right = right;
+  return node;
+}
+
+EnsembleType::NodeType MakeLeaf(int classIndex, float value)
+{
+  return MakeNode(-1, value, classIndex, -1);
+}
+
+// f0 <= 0.5 ? class 0 : (f1 <= 0.5 ? class 1 : class 2), nodes in
+// a scrambled order
+EnsembleType::TreeType TreeA()
+{
+  EnsembleType::TreeType tree;
+  tree.push_back(MakeLeaf(2, 30.f));
+  tree.push_back(MakeNode(1, 0.5f, 4, 0));
+  tree.push_back(MakeLeaf(0, 10.f));
+  tree.push_back(MakeNode(0, 0.5f, 2, 1));
+  tree.push_back(MakeLeaf(1, 20.f));
+  return tree;
+}
+
+// f1 <= 0.5 ? class 1 : class 2
+EnsembleType::TreeType TreeB()
+{
+  EnsembleType::TreeType tree;
+  tree.push_back(MakeNode(1, 0.5f, 1, 2));
+  tree.push_back(MakeLeaf(1, 20.f));
+  tree.push_back(MakeLeaf(2, 30.f));
+  return tree;
+}
+
+// Always class 0
+EnsembleType::TreeType TreeC()
+{
+  EnsembleType::TreeType tree;
+  tree.push_back(MakeLeaf(0, 10.f));
+  return tree;
+}
+
+bool Check(const std::string & what, float value, float expected)
+{
+  if (std::fabs(value - expected) > 1e-6)
+    {
+    std::cerr << what << ": got " << value << " instead of " << expected << std::endl;
+    return false;
+    }
+  return true;
+}
+}
+
+int otbFlatTreeEnsembleTest(int itkNotUsed(argc), char * itkNotUsed(argv) [])
+{
+  bool ok = true;
+
+  EnsembleType ensemble;
+  ensemble.SetNumberOfFeatures(2);
+  ensemble.SetNumberOfClasses(3);
+  ensemble.AddTree(TreeA(), 3);
+  ensemble.AddTree(TreeB(), 0);
+  ensemble.AddTree(TreeC(), 0);
+
+  if (ensemble.GetNumberOfTrees() != 3 || ensemble.GetNumberOfNodes() != 9)
+    {
+    std::cerr << "Wrong number of trees or nodes" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const float samples[8] = {0.f, 0.f,
+                            1.f, 1.f,
+                            1.f, 0.f,
+                            0.f, 1.f};
+  float outputs[4];
+  float confidences[4];
+  float margins[4];
+  ensemble.Predict(samples, 4, 2, outputs, confidences);
+  ensemble.Predict(samples, 4, 2, outputs, margins, true);
+
+  ok &= Check("Label of sample 0", outputs[0], 10.f);
+  ok &= Check("Label of sample 1", outputs[1], 30.f);
+  ok &= Check("Label of sample 2", outputs[2], 20.f);
+  ok &= Check("Label of sample 3", outputs[3], 10.f);
+  ok &= Check("Confidence of sample 0", confidences[0], 2.f / 3.f);
+  ok &= Check("Confidence of sample 1", confidences[1], 2.f / 3.f);
+  ok &= Check("Margin of sample 0", margins[0], 1.f / 3.f);
+  ok &= Check("Margin of sample 2", margins[2], 1.f / 3.f);
+
+  // Proportion of the votes of each class
+  float probabilities[12];
+  ensemble.Predict(samples, 4, 2, outputs, ITK_NULLPTR, false, probabilities);
+  ok &= Check("Probability of class 0 for sample 0", probabilities[0], 2.f / 3.f);
+  ok &= Check("Probability of class 1 for sample 0", probabilities[1], 1.f / 3.f);
+  ok &= Check("Probability of class 2 for sample 0", probabilities[2], 0.f);
+  ok &= Check("Probability of class 2 for sample 1", probabilities[5], 2.f / 3.f);
+
+  // Tie between class 2 (first tree) and class 0 (second tree)
+  EnsembleType tie;
+  tie.SetNumberOfFeatures(2);
+  tie.SetNumberOfClasses(3);
+  tie.AddTree(TreeB(), 0);
+  tie.AddTree(TreeC(), 0);
+
+  float output = 0.f;
+  float margin = 1.f;
+  tie.Predict(samples + 6, 1, 2, &output, &margin, true);
+  ok &= Check("Lowest class index tie break", output, 10.f);
+  ok &= Check("Margin of a tie", margin, 0.f);
+
+  tie.SetTieBreak(EnsembleType::FirstReachedMaximum);
+  tie.Predict(samples + 6, 1, 2, &output);
+  ok &= Check("First reached maximum tie break", output, 30.f);
+
+  // Regression: mean of the leaf values
+  EnsembleType regression;
+  regression.SetNumberOfFeatures(2);
+  regression.SetNumberOfClasses(0);
+  regression.AddTree(TreeA(), 3);
+  regression.AddTree(TreeB(), 0);
+  regression.Predict(samples + 2, 1, 2, &output);
+  ok &= Check("Regression output", output, 30.f);
+  regression.Predict(samples, 1, 2, &output);
+  ok &= Check("Regression output", output, 15.f);
+
+  // Several blocks give the same results as single samples
+  const unsigned int nbSamples = 3 * EnsembleType::BlockSize + 5;
+  std::vector<float> many(2 * nbSamples);
+  for (unsigned int i = 0; i < nbSamples; ++i)
+    {
+    many[2 * i] = static_cast<float>(i % 3) * 0.4f;
+    many[2 * i + 1] = static_cast<float>(i % 5) * 0.25f;
+    }
+  std::vector<float> manyOutputs(nbSamples);
+  std::vector<float> manyConfidences(nbSamples);
+  ensemble.Predict(&many[0], nbSamples, 2, &manyOutputs[0], &manyConfidences[0]);
+  for (unsigned int i = 0; i < nbSamples && ok; ++i)
+    {
+    float confidence = 0.f;
+    ensemble.Predict(&many[2 * i], 1, 2, &output, &confidence);
+    ok &= Check("Block label", manyOutputs[i], output);
+    ok &= Check("Block confidence", manyConfidences[i], confidence);
+    }
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
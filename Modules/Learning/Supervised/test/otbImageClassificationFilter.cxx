@@ -104,5 +104,13 @@ int otbImageClassificationFilter(int itkNotUsed(argc), char * argv[])
   writer->SetFileName(outfname);
   writer->Update();
 
+  // The confidence and probability maps are disabled: they are not allocated
+  if (filter->GetOutputConfidence()->GetBufferedRegion().GetNumberOfPixels() != 0
+      || filter->GetOutputProba()->GetBufferedRegion().GetNumberOfPixels() != 0)
+    {
+    std::cerr << "The disabled outputs were allocated" << std::endl;
+    return EXIT_FAILURE;
+    }
+
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <iostream>
+#include <cstdlib>
+#include <map>
+
+#include "otbStreamingConfusionMatrixImageFilter.h"
+#include "otbImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "vnl/vnl_math.h"
+
+int otbStreamingConfusionMatrixImageFilter(int itkNotUsed(argc), char * itkNotUsed(argv) [])
+{
+  typedef otb::Image<int, 2>                                         ImageType;
+  typedef otb::StreamingConfusionMatrixImageFilter<ImageType>        FilterType;
+  typedef FilterType::ClassLabelType                                 ClassLabelType;
+  typedef std::map<ClassLabelType, std::map<ClassLabelType, unsigned long> > CountsType;
+
+  const ClassLabelType noData = 0;
+
+  // Reference labels in vertical bands, produced labels with periodic
+  // errors. Labels 10000 and -3 are outside the lookup table range, and
+  // label 9 is only produced.
+  ImageType::SizeType size;
+  size[0] = 250;
+  size[1] = 130;
+  ImageType::RegionType region;
+  region.SetSize(size);
+
+  ImageType::Pointer reference = ImageType::New();
+  reference->SetRegions(region);
+  reference->Allocate();
+  ImageType::Pointer produced = ImageType::New();
+  produced->SetRegions(region);
+  produced->Allocate();
+
+  const ClassLabelType labels[5] = {1, 2, 10000, -3, 7};
+  CountsType expected;
+  unsigned long nbSamples = 0;
+
+  itk::ImageRegionIteratorWithIndex<ImageType> refIt(reference, region);
+  itk::ImageRegionIteratorWithIndex<ImageType> prodIt(produced, region);
+  for (refIt.GoToBegin(), prodIt.GoToBegin(); !refIt.IsAtEnd(); ++refIt, ++prodIt)
+    {
+    const ImageType::IndexType index = refIt.GetIndex();
+    const ClassLabelType refLabel = index[1] % 17 == 0 ? noData : labels[index[0] / 50];
+    ClassLabelType prodLabel = refLabel;
+    if ((index[0] * 3 + index[1]) % 7 == 0)
+      {
+      prodLabel = labels[(index[0] / 50 + 1) % 5];
+      }
+    else if ((index[0] + index[1] * 5) % 11 == 0)
+      {
+      prodLabel = 9;
+      }
+    else if ((index[0] + index[1]) % 23 == 0)
+      {
+      prodLabel = noData;
+      }
+    refIt.Set(refLabel);
+    prodIt.Set(prodLabel);
+
+    if (refLabel != noData && prodLabel != noData)
+      {
+      ++expected[refLabel][prodLabel];
+      ++nbSamples;
+      }
+    }
+
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(produced);
+  filter->SetReferenceImage(reference);
+  filter->SetReferenceNoDataValue(noData);
+  filter->SetProducedNoDataValue(noData);
+  filter->GetStreamer()->SetNumberOfDivisionsStrippedStreaming(9);
+  filter->Update();
+
+  const FilterType::LabelListType & allLabels = filter->GetLabels();
+  const FilterType::ConfusionMatrixType & matrix = filter->GetConfusionMatrix();
+
+  std::cout << "Labels:";
+  for (unsigned int i = 0; i < allLabels.size(); ++i)
+    {
+    std::cout << " " << allLabels[i];
+    }
+  std::cout << std::endl << matrix << std::endl;
+
+  if (allLabels.size() != 6 || filter->GetReferenceLabels().size() != 5 || filter->GetProducedLabels().size() != 6)
+    {
+    std::cerr << "Wrong number of labels" << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (filter->GetNumberOfSamples() != nbSamples)
+    {
+    std::cerr << filter->GetNumberOfSamples() << " samples instead of " << nbSamples << std::endl;
+    return EXIT_FAILURE;
+    }
+  for (unsigned int i = 0; i < allLabels.size(); ++i)
+    {
+    if (i > 0 && allLabels[i - 1] >= allLabels[i])
+      {
+      std::cerr << "Labels are not sorted" << std::endl;
+      return EXIT_FAILURE;
+      }
+    for (unsigned int j = 0; j < allLabels.size(); ++j)
+      {
+      if (matrix(i, j) != expected[allLabels[i]][allLabels[j]])
+        {
+        std::cerr << "Wrong count for reference " << allLabels[i] << " and produced " << allLabels[j] << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  // Overall accuracy on the reference labels
+  unsigned long nbCorrect = 0;
+  unsigned long nbRefSamples = 0;
+  for (CountsType::const_iterator it = expected.begin(); it != expected.end(); ++it)
+    {
+    for (std::map<ClassLabelType, unsigned long>::const_iterator jt = it->second.begin(); jt != it->second.end(); ++jt)
+      {
+      nbCorrect += it->first == jt->first ? jt->second : 0;
+      nbRefSamples += expected.count(jt->first) ? jt->second : 0;
+      }
+    }
+  const double accuracy = static_cast<double>(nbCorrect) / static_cast<double>(nbRefSamples);
+  std::cout << "Overall accuracy: " << filter->GetMeasurements()->GetOverallAccuracy()
+            << ", kappa: " << filter->GetMeasurements()->GetKappaIndex() << std::endl;
+  if (vnl_math_abs(filter->GetMeasurements()->GetOverallAccuracy() - accuracy) > 1e-9)
+    {
+    std::cerr << "Wrong overall accuracy, expected " << accuracy << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -34,14 +34,17 @@ void RegisterTests()
   REGISTER_TEST(otbConfusionMatrixMeasurementsNew);
   REGISTER_TEST(otbConfusionMatrixMeasurementsTest);
   REGISTER_TEST(otbConfusionMatrixConcatenateTest);
+  REGISTER_TEST(otbStreamingConfusionMatrixImageFilter);
   REGISTER_TEST(otbExhaustiveExponentialOptimizerNew);
   REGISTER_TEST(otbExhaustiveExponentialOptimizerTest);
+  REGISTER_TEST(otbFlatTreeEnsembleTest);
   
   #ifdef OTB_USE_LIBSVM
   REGISTER_TEST(otbLibSVMMachineLearningModelCanRead);
   REGISTER_TEST(otbLibSVMMachineLearningModelNew);
   REGISTER_TEST(otbLibSVMMachineLearningModel);
   REGISTER_TEST(otbLibSVMRegressionTests);
+  REGISTER_TEST(otbLibSVMDenseModel);
   REGISTER_TEST(otbLabelMapClassifierNew);
   REGISTER_TEST(otbLabelMapClassifier);
   REGISTER_TEST(otbSVMCrossValidationCostFunctionNew);
@@ -62,8 +65,10 @@ void RegisterTests()
   REGISTER_TEST(otbSVMMachineLearningModel);
   REGISTER_TEST(otbKNearestNeighborsMachineLearningModelNew);
   REGISTER_TEST(otbKNearestNeighborsMachineLearningModel);
+  REGISTER_TEST(otbKNearestNeighborsModelSelection);
   REGISTER_TEST(otbRandomForestsMachineLearningModelNew);
   REGISTER_TEST(otbRandomForestsMachineLearningModel);
+  REGISTER_TEST(otbRandomForestsFlatTreeEnsemble);
   REGISTER_TEST(otbBoostMachineLearningModelNew);
   REGISTER_TEST(otbBoostMachineLearningModel);
   REGISTER_TEST(otbANNMachineLearningModelNew);
@@ -260,6 +260,108 @@ int otbLibSVMMachineLearningModel(int argc, char * argv[])
     return EXIT_FAILURE;
     }
 }
+
+// Compare the block prediction of the dense model with libsvm
+int otbLibSVMDenseModel(int argc, char * argv[])
+{
+  if (argc != 3)
+    {
+      std::cout<<"Wrong number of arguments "<<std::endl;
+      std::cout<<"Usage : sample file, output file "<<std::endl;
+      return EXIT_FAILURE;
+    }
+
+  typedef otb::LibSVMMachineLearningModel<InputValueType, TargetValueType> SVMType;
+  typedef SVMType::ConfidenceValueType ConfidenceValueType;
+  InputListSampleType::Pointer samples = InputListSampleType::New();
+  TargetListSampleType::Pointer labels = TargetListSampleType::New();
+
+  if (!ReadDataFile(argv[1], samples, labels))
+    {
+    std::cout << "Failed to read samples file " << argv[1] << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  const unsigned int nbFeatures = samples->GetMeasurementVectorSize();
+  std::vector<struct svm_node> nodes(nbFeatures + 1);
+  nodes[nbFeatures].index = -1;
+  nodes[nbFeatures].value = 0;
+
+  int nbErrors = 0;
+  for (int withProbabilities = 0; withProbabilities < 2; ++withProbabilities)
+    {
+    SVMType::Pointer classifier = SVMType::New();
+    classifier->SetInputListSample(samples);
+    classifier->SetTargetListSample(labels);
+    classifier->SetKernelType(RBF);
+    classifier->SetKernelGamma(0.5);
+    classifier->SetDoProbabilityEstimates(withProbabilities == 1);
+    classifier->Train();
+    classifier->Save(argv[2]);
+
+    // Same model, predicted with libsvm
+    struct svm_model * model = svm_load_model(argv[2]);
+    SVMType::Pointer classifierLoad = SVMType::New();
+    classifierLoad->Load(argv[2]);
+
+    const unsigned int nbClasses = classifierLoad->GetNumberOfClasses();
+    const unsigned int nbDecisions = nbClasses * (nbClasses - 1) / 2;
+    std::vector<double> refValues(std::max(nbClasses, nbDecisions));
+    std::vector<ConfidenceValueType> values(std::max(nbClasses, nbDecisions));
+
+    TargetListSampleType::Pointer predicted = classifierLoad->PredictBatch(samples, NULL);
+    classifierLoad->SetConfidenceMode(withProbabilities == 1 ? SVMType::CM_PROBA : SVMType::CM_HYPER);
+
+    for (unsigned int i = 0; i < samples->Size(); ++i)
+      {
+      const InputSampleType & sample = samples->GetMeasurementVector(i);
+      for (unsigned int j = 0; j < nbFeatures; ++j)
+        {
+        nodes[j].index = j + 1;
+        nodes[j].value = sample[j];
+        }
+
+      double refLabel = 0;
+      unsigned int nbValues = nbDecisions;
+      if (withProbabilities == 1)
+        {
+        refLabel = svm_predict_probability(model, &nodes[0], &refValues[0]);
+        nbValues = nbClasses;
+        }
+      else
+        {
+        refLabel = svm_predict_values(model, &nodes[0], &refValues[0]);
+        }
+      classifierLoad->Predict(sample, &values[0]);
+
+      double maxDiff = 0;
+      for (unsigned int j = 0; j < nbValues; ++j)
+        {
+        maxDiff = std::max(maxDiff, vcl_abs(refValues[j] - values[j]));
+        }
+
+      // The most probable class may differ for nearly equal probabilities
+      std::vector<double> sorted(refValues.begin(), refValues.begin() + nbValues);
+      std::sort(sorted.begin(), sorted.end());
+      const bool tie = withProbabilities == 1 && sorted[nbValues - 1] - sorted[nbValues - 2] < 1e-3;
+
+      if (maxDiff > 1e-3 || (predicted->GetMeasurementVector(i)[0] != static_cast<TargetValueType>(refLabel) && !tie))
+        {
+        std::cout << "Sample " << i << ": label " << predicted->GetMeasurementVector(i)[0]
+                  << " instead of " << refLabel << ", difference of the confidence values " << maxDiff << std::endl;
+        ++nbErrors;
+        }
+      }
+    svm_free_and_destroy_model(&model);
+    }
+
+  if (nbErrors > 0)
+    {
+    std::cout << nbErrors << " samples differ from libsvm" << std::endl;
+    return EXIT_FAILURE;
+    }
+  return EXIT_SUCCESS;
+}
 #endif
 
 #ifdef OTB_USE_OPENCV
@@ -272,6 +374,7 @@ int otbLibSVMMachineLearningModel(int argc, char * argv[])
 #include "otbDecisionTreeMachineLearningModel.h"
 #include "otbGradientBoostedTreeMachineLearningModel.h"
 #include "otbKNearestNeighborsMachineLearningModel.h"
+#include "otbMachineLearningModelSelection.h"
 
 int otbSVMMachineLearningModelNew(int itkNotUsed(argc), char * itkNotUsed(argv) [])
 {
@@ -496,6 +599,108 @@ int otbKNearestNeighborsMachineLearningModel(int argc, char * argv[])
     }
 }
 
+MachineLearningModelType::Pointer KNNModelGenerator(const itk::Array<double> & parameters, void * itkNotUsed(clientData))
+{
+  typedef otb::KNearestNeighborsMachineLearningModel<InputValueType,TargetValueType> KNearestNeighborsType;
+  KNearestNeighborsType::Pointer classifier = KNearestNeighborsType::New();
+  classifier->SetK(static_cast<int>(parameters[0]));
+  return classifier.GetPointer();
+}
+
+MachineLearningModelType::Pointer FailingModelGenerator(const itk::Array<double> & parameters, void * clientData)
+{
+  // Not a std::exception
+  if (parameters[0] > 10)
+    {
+    throw 1;
+    }
+  return KNNModelGenerator(parameters, clientData);
+}
+
+int otbKNearestNeighborsModelSelection(int argc, char * argv[])
+{
+  if (argc != 2 )
+    {
+    std::cout<<"Wrong number of arguments "<<std::endl;
+    std::cout<<"Usage : sample file"<<std::endl;
+    return EXIT_FAILURE;
+    }
+
+  typedef otb::MachineLearningModelSelection<InputValueType,TargetValueType> ModelSelectionType;
+  InputListSampleType::Pointer samples = InputListSampleType::New();
+  TargetListSampleType::Pointer labels = TargetListSampleType::New();
+
+  if(!ReadDataFile(argv[1],samples,labels))
+    {
+    std::cout<<"Failed to read samples file "<<argv[1]<<std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::vector<double> kValues;
+  kValues.push_back(1);
+  kValues.push_back(5);
+  kValues.push_back(11);
+  kValues.push_back(21);
+
+  ModelSelectionType::Pointer selection = ModelSelectionType::New();
+  selection->SetInputListSample(samples);
+  selection->SetTargetListSample(labels);
+  selection->SetModelGenerator(KNNModelGenerator);
+  selection->AddParameter("k", kValues);
+  selection->SetNumberOfFolds(3);
+  selection->SetNumberOfThreads(4);
+  selection->Compute();
+
+  for (unsigned int i = 0; i < selection->GetNumberOfConfigurations(); ++i)
+    {
+    std::cout<<"k = "<<selection->GetConfiguration(i)[0]<<" :";
+    for (unsigned int fold = 0; fold < selection->GetNumberOfFolds(); ++fold)
+      {
+      std::cout<<" "<<selection->GetFoldKappa(i, fold);
+      }
+    std::cout<<" -> "<<selection->GetScore(i)<<std::endl;
+    }
+  std::cout<<"Best k: "<<selection->GetBestConfiguration()[0]<<std::endl;
+
+  // The same search on a single thread must give the same results
+  ModelSelectionType::Pointer sequentialSelection = ModelSelectionType::New();
+  sequentialSelection->SetInputListSample(samples);
+  sequentialSelection->SetTargetListSample(labels);
+  sequentialSelection->SetModelGenerator(KNNModelGenerator);
+  sequentialSelection->AddParameter("k", kValues);
+  sequentialSelection->SetNumberOfFolds(3);
+  sequentialSelection->SetNumberOfThreads(1);
+  sequentialSelection->Compute();
+
+  if (selection->GetNumberOfConfigurations() != kValues.size()
+      || sequentialSelection->GetBestConfigurationIndex() != selection->GetBestConfigurationIndex()
+      || vcl_abs(sequentialSelection->GetBestScore() - selection->GetBestScore()) > 0.00000001
+      || selection->GetBestScore() <= 0.)
+    {
+    return EXIT_FAILURE;
+    }
+
+  // A failure in a thread is reported by Compute()
+  ModelSelectionType::Pointer failingSelection = ModelSelectionType::New();
+  failingSelection->SetInputListSample(samples);
+  failingSelection->SetTargetListSample(labels);
+  failingSelection->SetModelGenerator(FailingModelGenerator);
+  failingSelection->AddParameter("k", kValues);
+  failingSelection->SetNumberOfFolds(3);
+  failingSelection->SetNumberOfThreads(4);
+  try
+    {
+    failingSelection->Compute();
+    std::cout<<"The failure of the model generator was not reported"<<std::endl;
+    return EXIT_FAILURE;
+    }
+  catch (itk::ExceptionObject & err)
+    {
+    std::cout<<"Expected error: "<<err.GetDescription()<<std::endl;
+    }
+  return EXIT_SUCCESS;
+}
+
 int otbRandomForestsMachineLearningModelNew(int itkNotUsed(argc), char * itkNotUsed(argv) [])
 {
   typedef otb::RandomForestsMachineLearningModel<InputValueType,TargetValueType> RandomForestType;
@@ -582,6 +787,98 @@ int otbRandomForestsMachineLearningModel(int argc, char * argv[])
     }
 }
 
+int otbRandomForestsFlatTreeEnsemble(int argc, char * argv[])
+{
+  if (argc != 3 )
+    {
+    std::cout<<"Wrong number of arguments "<<std::endl;
+    std::cout<<"Usage : sample file, model file"<<std::endl;
+    return EXIT_FAILURE;
+    }
+
+  InputListSampleType::Pointer samples = InputListSampleType::New();
+  TargetListSampleType::Pointer labels = TargetListSampleType::New();
+
+  if(!ReadDataFile(argv[1],samples,labels))
+    {
+    std::cout<<"Failed to read samples file "<<argv[1]<<std::endl;
+    return EXIT_FAILURE;
+    }
+
+#ifdef OTB_OPENCV_3
+  cv::Ptr<otb::CvRTreesWrapper> forest = otb::CvRTreesWrapper::create();
+  cv::FileStorage fs(argv[2], cv::FileStorage::READ);
+  forest->read(fs.getFirstTopLevelNode());
+#else
+  otb::CvRTreesWrapper forestObject;
+  otb::CvRTreesWrapper * forest = &forestObject;
+  forest->load(argv[2]);
+#endif
+
+  otb::FlatTreeEnsemble ensemble;
+  if (!forest->ExportTreeEnsemble(ensemble))
+    {
+    std::cout<<"The forest can not be converted"<<std::endl;
+    return EXIT_FAILURE;
+    }
+  std::cout<<ensemble.GetNumberOfTrees()<<" trees, "<<ensemble.GetNumberOfNodes()<<" nodes"<<std::endl;
+
+  const unsigned int nbSamples = samples->Size();
+  const unsigned int nbFeatures = samples->GetMeasurementVectorSize();
+  std::vector<float> buffer(nbSamples * nbFeatures);
+  for (unsigned int i = 0; i < nbSamples; ++i)
+    {
+    for (unsigned int j = 0; j < nbFeatures; ++j)
+      {
+      buffer[i * nbFeatures + j] = samples->GetMeasurementVector(i)[j];
+      }
+    }
+  std::vector<float> outputs(nbSamples);
+  std::vector<float> confidences(nbSamples);
+  std::vector<float> margins(nbSamples);
+  ensemble.Predict(&buffer[0], nbSamples, nbFeatures, &outputs[0], &confidences[0]);
+  ensemble.Predict(&buffer[0], nbSamples, nbFeatures, &outputs[0], &margins[0], true);
+
+  unsigned int nbErrors = 0;
+  for (unsigned int i = 0; i < nbSamples; ++i)
+    {
+    cv::Mat sample;
+    otb::SampleToMat<InputSampleType>(samples->GetMeasurementVector(i), sample);
+    if (forest->predict(sample) != outputs[i]
+        || forest->predict_confidence(sample) != confidences[i]
+        || forest->predict_margin(sample) != margins[i])
+      {
+      ++nbErrors;
+      }
+    }
+
+  // The class probabilities of the model are the proportions of votes
+  typedef otb::RandomForestsMachineLearningModel<InputValueType,TargetValueType> RandomForestType;
+  RandomForestType::Pointer classifier = RandomForestType::New();
+  classifier->Load(argv[2]);
+  if (!classifier->HasProbaIndex())
+    {
+    std::cout<<"The model does not give class probabilities"<<std::endl;
+    return EXIT_FAILURE;
+    }
+  const std::vector<TargetValueType> & probaLabels = classifier->GetProbaLabels();
+  RandomForestType::ProbaListSampleType::Pointer probas = RandomForestType::ProbaListSampleType::New();
+  TargetListSampleType::Pointer predicted = classifier->PredictBatch(samples, NULL, probas);
+  for (unsigned int i = 0; i < nbSamples; ++i)
+    {
+    const TargetValueType label = predicted->GetMeasurementVector(i)[0];
+    const unsigned int classIndex = std::find(probaLabels.begin(), probaLabels.end(), label) - probaLabels.begin();
+    if (label != static_cast<TargetValueType>(outputs[i]) || classIndex == probaLabels.size()
+        || vcl_abs(probas->GetMeasurementVector(i)[classIndex] - confidences[i]) > 1e-6)
+      {
+      ++nbErrors;
+      }
+    }
+
+  std::cout<<nbErrors<<" differences on "<<nbSamples<<" samples"<<std::endl;
+  return nbErrors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 int otbBoostMachineLearningModelNew(int itkNotUsed(argc), char * itkNotUsed(argv) [])
 {
   typedef otb::BoostMachineLearningModel<InputValueType,TargetValueType> BoostType;
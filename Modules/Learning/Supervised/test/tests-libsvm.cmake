@@ -46,6 +46,12 @@ otb_add_test(NAME leTvLibSVMMachineLearningModelReg COMMAND otbSupervisedTestDri
   otbLibSVMRegressionTests
   )
 
+otb_add_test(NAME leTvLibSVMDenseModel COMMAND otbSupervisedTestDriver
+  otbLibSVMDenseModel
+  ${INPUTDATA}/letter.scale
+  ${TEMP}/libsvm_dense_model.txt
+  )
+
 #otb_add_test(NAME obTvLabelMapSVMClassifier COMMAND otbSupervisedTestDriver
   #otbLabelMapClassifier
   #${INPUTDATA}/maur.tif
@@ -103,6 +103,13 @@ otb_add_test(NAME leTvRandomForestsMachineLearningModel COMMAND otbSupervisedTes
   ${TEMP}/rf_model.txt
   )
 
+otb_add_test(NAME leTvRandomForestsFlatTreeEnsemble COMMAND otbSupervisedTestDriver
+  otbRandomForestsFlatTreeEnsemble
+  ${INPUTDATA}/letter.scale
+  ${TEMP}/rf_model.txt
+  )
+set_tests_properties(leTvRandomForestsFlatTreeEnsemble PROPERTIES DEPENDS leTvRandomForestsMachineLearningModel)
+
 otb_add_test(NAME leTuANNMachineLearningModelNew COMMAND otbSupervisedTestDriver
   otbANNMachineLearningModelNew)
 
@@ -112,6 +119,11 @@ otb_add_test(NAME leTvKNearestNeighborsMachineLearningModel COMMAND otbSupervise
   ${TEMP}/knn_model.txt
   )
 
+otb_add_test(NAME leTvKNearestNeighborsModelSelection COMMAND otbSupervisedTestDriver
+  otbKNearestNeighborsModelSelection
+  ${INPUTDATA}/letter.scale
+  )
+
 otb_add_test(NAME leTvDecisionTreeMachineLearningModel COMMAND otbSupervisedTestDriver
   otbDecisionTreeMachineLearningModel
   ${INPUTDATA}/letter.scale
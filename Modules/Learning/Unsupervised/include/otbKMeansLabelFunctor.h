@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbKMeansLabelFunctor_h
+#define otbKMeansLabelFunctor_h
+
+#include <vector>
+#include <limits>
+
+#include "itkMacro.h"
+
+namespace otb
+{
+namespace Functor
+{
+
+/** \class KMeansLabelFunctor
+ *  \brief Label a pixel with the index of its nearest centroid
+ *
+ *  The centroids are stored contiguously, one after the other, so that
+ *  the search of the nearest one reads a single array. The squared
+ *  distance to a centroid is accumulated by blocks of 4 components,
+ *  and its evaluation stops as soon as it exceeds the best distance
+ *  found so far. The 4 differences of a block are independent, but the
+ *  early exit between blocks keeps the compiler from vectorizing the
+ *  loop itself: the gain comes from the centroids skipped after a few
+ *  blocks.
+ *
+ *  The label of the i-th centroid is i.
+ *
+ * \ingroup OTBUnsupervised
+ */
+template <class TInput, class TLabel>
+class KMeansLabelFunctor
+{
+public:
+  typedef double                 ValueType;
+  typedef std::vector<ValueType> CentroidsType;
+
+  KMeansLabelFunctor() : m_NumberOfComponents(0) {}
+
+  /** Set the centroids, stored one after the other */
+  void SetCentroids(const CentroidsType & centroids, unsigned int nbComponents)
+  {
+    m_Centroids = centroids;
+    m_NumberOfComponents = nbComponents;
+  }
+
+  /** Append a centroid. All the centroids must have the same size. */
+  template <class TCentroid>
+  void AddCentroid(const TCentroid & centroid, unsigned int nbComponents)
+  {
+    m_NumberOfComponents = nbComponents;
+    for (unsigned int c = 0; c < nbComponents; ++c)
+      {
+      m_Centroids.push_back(static_cast<ValueType>(centroid[c]));
+      }
+  }
+
+  const CentroidsType & GetCentroids() const
+  {
+    return m_Centroids;
+  }
+
+  unsigned int GetNumberOfComponents() const
+  {
+    return m_NumberOfComponents;
+  }
+
+  unsigned int GetNumberOfCentroids() const
+  {
+    return m_NumberOfComponents > 0 ? m_Centroids.size() / m_NumberOfComponents : 0;
+  }
+
+  /** Get the index of the centroid nearest to the sample, and their
+   * squared distance */
+  unsigned int GetNearestCentroid(const TInput & sample, ValueType & sqDistance) const
+  {
+    const unsigned int nbComponents = m_NumberOfComponents;
+    const unsigned int nbCentroids = GetNumberOfCentroids();
+    const unsigned int nbBlockComponents = nbComponents - nbComponents % 4;
+
+    unsigned int nearest = 0;
+    sqDistance = std::numeric_limits<ValueType>::max();
+
+    const ValueType * centroid = nbCentroids > 0 ? &m_Centroids[0] : ITK_NULLPTR;
+    for (unsigned int k = 0; k < nbCentroids; ++k, centroid += nbComponents)
+      {
+      ValueType   dist = 0.;
+      unsigned int c = 0;
+      for (; c < nbBlockComponents && dist < sqDistance; c += 4)
+        {
+        const ValueType d0 = static_cast<ValueType>(sample[c]) - centroid[c];
+        const ValueType d1 = static_cast<ValueType>(sample[c + 1]) - centroid[c + 1];
+        const ValueType d2 = static_cast<ValueType>(sample[c + 2]) - centroid[c + 2];
+        const ValueType d3 = static_cast<ValueType>(sample[c + 3]) - centroid[c + 3];
+        dist += (d0 * d0 + d1 * d1) + (d2 * d2 + d3 * d3);
+        }
+      if (dist >= sqDistance)
+        {
+        continue;
+        }
+      for (; c < nbComponents; ++c)
+        {
+        const ValueType d = static_cast<ValueType>(sample[c]) - centroid[c];
+        dist += d * d;
+        }
+      if (dist < sqDistance)
+        {
+        sqDistance = dist;
+        nearest = k;
+        }
+      }
+    return nearest;
+  }
+
+  /** The output is a single label */
+  unsigned int GetOutputSize() const
+  {
+    return 1;
+  }
+
+  TLabel operator ()(const TInput & sample) const
+  {
+    ValueType sqDistance;
+    return static_cast<TLabel>(GetNearestCentroid(sample, sqDistance));
+  }
+
+  bool operator !=(const KMeansLabelFunctor & other) const
+  {
+    return m_NumberOfComponents != other.m_NumberOfComponents || m_Centroids != other.m_Centroids;
+  }
+
+  bool operator ==(const KMeansLabelFunctor & other) const
+  {
+    return !(*this != other);
+  }
+
+private:
+  CentroidsType m_Centroids;
+  unsigned int  m_NumberOfComponents;
+};
+
+} // end namespace Functor
+} // end namespace otb
+
+#endif
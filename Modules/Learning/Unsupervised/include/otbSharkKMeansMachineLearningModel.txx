@@ -73,7 +73,7 @@ SharkKMeansMachineLearningModel<TInputValue, TOutputValue>
 {
   // Parse input data and convert to Shark Data
   std::vector<shark::RealVector> vector_data;
-  otb::Shark::ListSampleToSharkVector( this->GetInputListSample(), vector_data );
+  otb::Shark::TrainingSamplesToSharkVector( this, vector_data );
   shark::Data<shark::RealVector> data = shark::createDataFromRange( vector_data );
 
   // Normalized input value if necessary
@@ -0,0 +1,313 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbStreamingMiniBatchKMeansImageFilter_h
+#define otbStreamingMiniBatchKMeansImageFilter_h
+
+#include "otbPersistentImageFilter.h"
+#include "otbPersistentFilterStreamingDecorator.h"
+#include "otbKMeansLabelFunctor.h"
+#include "otbImage.h"
+#include "itkListSample.h"
+
+#include <vector>
+
+namespace otb
+{
+
+/** \class PersistentMiniBatchKMeansImageFilter
+ * \brief Update k-means centroids with each streamed piece of an image
+ *
+ * Each piece of the image streamed through this filter is a mini-batch:
+ * its pixels are assigned to their nearest centroid by several threads,
+ * then each centroid is moved towards the mean of its pixels, with a
+ * learning rate equal to the inverse of the number of pixels it has
+ * received since the last Reset(). After a full pass on the image, each
+ * centroid is thus the mean of the pixels assigned to it during the
+ * pass, and several passes converge as the Lloyd algorithm, without
+ * keeping the pixels in memory.
+ *
+ * The threads only assign the pixels: the pixels of a piece are then
+ * summed in their order in the image, so that the centroids do not
+ * depend on the number of threads. They still depend on the pieces,
+ * which StreamingMiniBatchKMeansImageFilter fixes with its BatchSize.
+ *
+ * The centroids have to be initialized before the first pass, either
+ * with SetCentroids() or with InitializeCentroids(), which runs the
+ * k-means++ seeding on a list of samples.
+ *
+ * If a mask is set, only the pixels with a positive mask value are used.
+ *
+ * \sa StreamingMiniBatchKMeansImageFilter
+ * \ingroup Streamed
+ * \ingroup Multithreaded
+ *
+ * \ingroup OTBUnsupervised
+ */
+template <class TInputImage, class TMaskImage = otb::Image<unsigned char, 2> >
+class ITK_EXPORT PersistentMiniBatchKMeansImageFilter :
+  public PersistentImageFilter<TInputImage, TInputImage>
+{
+public:
+  /** Standard Self typedef */
+  typedef PersistentMiniBatchKMeansImageFilter            Self;
+  typedef PersistentImageFilter<TInputImage, TInputImage> Superclass;
+  typedef itk::SmartPointer<Self>                         Pointer;
+  typedef itk::SmartPointer<const Self>                   ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Runtime information support. */
+  itkTypeMacro(PersistentMiniBatchKMeansImageFilter, PersistentImageFilter);
+
+  /** Image related typedefs. */
+  typedef TInputImage                           ImageType;
+  typedef typename ImageType::Pointer           InputImagePointer;
+  typedef typename ImageType::RegionType        RegionType;
+  typedef typename ImageType::PixelType         PixelType;
+
+  typedef TMaskImage                            MaskImageType;
+
+  typedef Functor::KMeansLabelFunctor<PixelType, unsigned int> FunctorType;
+  typedef typename FunctorType::ValueType                      ValueType;
+  typedef typename FunctorType::CentroidsType                  CentroidsType;
+  typedef std::vector<itk::SizeValueType>                      CountsType;
+
+  typedef itk::Statistics::ListSample<PixelType> ListSampleType;
+
+  /** Set/Get the mask of the valid pixels */
+  void SetMaskImage(const MaskImageType * mask);
+  const MaskImageType * GetMaskImage() const;
+
+  /** Set the centroids, stored one after the other */
+  void SetCentroids(const CentroidsType & centroids, unsigned int nbComponents);
+
+  /** Initialize nbClasses centroids from a list of samples with the
+   * k-means++ seeding: the first centroid is drawn uniformly, and each
+   * next one with a probability proportional to its squared distance to
+   * the nearest centroid already chosen. The random generator is the
+   * global instance of itk::Statistics::MersenneTwisterRandomVariateGenerator. */
+  void InitializeCentroids(const ListSampleType * samples, unsigned int nbClasses);
+
+  /** Get the centroids, stored one after the other */
+  const CentroidsType & GetCentroids() const
+  {
+    return m_Functor.GetCentroids();
+  }
+
+  unsigned int GetNumberOfClasses() const
+  {
+    return m_Functor.GetNumberOfCentroids();
+  }
+
+  /** Get a functor labelling pixels with the current centroids */
+  const FunctorType & GetFunctor() const
+  {
+    return m_Functor;
+  }
+
+  /** Number of pixels assigned to each centroid during the last pass */
+  itkGetConstReferenceMacro(Counts, CountsType);
+
+  /** Sum of the squared distances of the pixels to their centroid
+   * during the last pass */
+  itkGetConstMacro(Inertia, double);
+
+  /** Largest displacement of a centroid during the last pass */
+  itkGetConstMacro(CentroidsShift, double);
+
+  void Reset(void) ITK_OVERRIDE;
+  void Synthetize(void) ITK_OVERRIDE;
+
+protected:
+  PersistentMiniBatchKMeansImageFilter();
+  ~PersistentMiniBatchKMeansImageFilter() ITK_OVERRIDE {}
+
+  /** The output image of this filter is not intended to be used */
+  void AllocateOutputs() ITK_OVERRIDE {}
+  void GenerateOutputInformation() ITK_OVERRIDE;
+
+  void BeforeThreadedGenerateData() ITK_OVERRIDE;
+  void ThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType threadId) ITK_OVERRIDE;
+  /** Update the centroids with the mini-batch */
+  void AfterThreadedGenerateData() ITK_OVERRIDE;
+
+  /** Offset of a pixel in the assignments of the current piece */
+  itk::SizeValueType GetPieceOffset(const typename RegionType::IndexType & index) const;
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
+
+private:
+  PersistentMiniBatchKMeansImageFilter(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  /** Nearest centroid search */
+  FunctorType   m_Functor;
+
+  /** Centroids at the beginning of the pass */
+  CentroidsType m_PreviousCentroids;
+
+  CountsType    m_Counts;
+  double        m_Inertia;
+  double        m_CentroidsShift;
+
+  /** Nearest centroid of each pixel of the current piece, or the number
+   * of classes for the masked pixels, with its squared distance */
+  std::vector<unsigned int> m_PieceLabels;
+  std::vector<ValueType>    m_PieceSquaredDistances;
+};
+
+/** \class StreamingMiniBatchKMeansImageFilter
+ * \brief Estimate k-means centroids on a whole image with streaming
+ *
+ * Each call to Update() runs passes of the
+ * PersistentMiniBatchKMeansImageFilter on the whole image, until the
+ * largest displacement of a centroid during a pass is below
+ * CentroidsShiftThreshold, or until MaximumNumberOfIterations passes.
+ *
+ * The mini-batches are strips of whole lines of at most BatchSize
+ * pixels (at least one line). Update() sets this splitting on the
+ * streamer, whatever the streaming mode or the available RAM, so that
+ * the centroids only depend on the image, the initial centroids and
+ * BatchSize.
+ *
+ * \sa PersistentMiniBatchKMeansImageFilter
+ * \ingroup Streamed
+ * \ingroup Multithreaded
+ *
+ * \ingroup OTBUnsupervised
+ */
+template <class TInputImage, class TMaskImage = otb::Image<unsigned char, 2> >
+class ITK_EXPORT StreamingMiniBatchKMeansImageFilter :
+  public PersistentFilterStreamingDecorator<PersistentMiniBatchKMeansImageFilter<TInputImage, TMaskImage> >
+{
+public:
+  /** Standard Self typedef */
+  typedef StreamingMiniBatchKMeansImageFilter Self;
+  typedef PersistentFilterStreamingDecorator
+  <PersistentMiniBatchKMeansImageFilter<TInputImage, TMaskImage> > Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Type macro */
+  itkNewMacro(Self);
+
+  /** Creation through object factory macro */
+  itkTypeMacro(StreamingMiniBatchKMeansImageFilter, PersistentFilterStreamingDecorator);
+
+  typedef TInputImage                           InputImageType;
+  typedef TMaskImage                            MaskImageType;
+  typedef typename Superclass::FilterType       KMeansFilterType;
+  typedef typename KMeansFilterType::FunctorType   FunctorType;
+  typedef typename KMeansFilterType::CentroidsType CentroidsType;
+  typedef typename KMeansFilterType::CountsType    CountsType;
+  typedef typename KMeansFilterType::ListSampleType ListSampleType;
+
+  using Superclass::SetInput;
+  void SetInput(const InputImageType * input)
+  {
+    this->GetFilter()->SetInput(input);
+  }
+  const InputImageType * GetInput()
+  {
+    return this->GetFilter()->GetInput();
+  }
+
+  void SetMaskImage(const MaskImageType * mask)
+  {
+    this->GetFilter()->SetMaskImage(mask);
+  }
+
+  void SetCentroids(const CentroidsType & centroids, unsigned int nbComponents)
+  {
+    this->GetFilter()->SetCentroids(centroids, nbComponents);
+  }
+
+  void InitializeCentroids(const ListSampleType * samples, unsigned int nbClasses)
+  {
+    this->GetFilter()->InitializeCentroids(samples, nbClasses);
+  }
+
+  const CentroidsType & GetCentroids() const
+  {
+    return this->GetFilter()->GetCentroids();
+  }
+
+  const FunctorType & GetFunctor() const
+  {
+    return this->GetFilter()->GetFunctor();
+  }
+
+  const CountsType & GetCounts() const
+  {
+    return this->GetFilter()->GetCounts();
+  }
+
+  double GetInertia() const
+  {
+    return this->GetFilter()->GetInertia();
+  }
+
+  double GetCentroidsShift() const
+  {
+    return this->GetFilter()->GetCentroidsShift();
+  }
+
+  /** Set/Get the maximum number of passes on the image (default is 10) */
+  itkSetMacro(MaximumNumberOfIterations, unsigned int);
+  itkGetConstMacro(MaximumNumberOfIterations, unsigned int);
+
+  /** Set/Get the displacement of the centroids below which the
+   * estimation stops (default is 0.0001) */
+  itkSetMacro(CentroidsShiftThreshold, double);
+  itkGetConstMacro(CentroidsShiftThreshold, double);
+
+  /** Set/Get the maximum number of pixels of a mini-batch (default is 262144) */
+  itkSetMacro(BatchSize, itk::SizeValueType);
+  itkGetConstMacro(BatchSize, itk::SizeValueType);
+
+  /** Get the number of passes of the last Update() */
+  itkGetConstMacro(NumberOfIterations, unsigned int);
+
+  /** Run the passes on the image */
+  void Update(void) ITK_OVERRIDE;
+
+protected:
+  StreamingMiniBatchKMeansImageFilter();
+  ~StreamingMiniBatchKMeansImageFilter() ITK_OVERRIDE {}
+
+private:
+  StreamingMiniBatchKMeansImageFilter(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  unsigned int m_MaximumNumberOfIterations;
+  double       m_CentroidsShiftThreshold;
+  unsigned int m_NumberOfIterations;
+  itk::SizeValueType m_BatchSize;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbStreamingMiniBatchKMeansImageFilter.txx"
+#endif
+
+#endif
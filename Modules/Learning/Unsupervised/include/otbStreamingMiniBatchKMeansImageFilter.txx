@@ -0,0 +1,395 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbStreamingMiniBatchKMeansImageFilter_txx
+#define otbStreamingMiniBatchKMeansImageFilter_txx
+
+#include "otbStreamingMiniBatchKMeansImageFilter.h"
+#include "itkImageRegionConstIterator.h"
+#include "itkImageRegionConstIteratorWithIndex.h"
+#include "itkMersenneTwisterRandomVariateGenerator.h"
+#include "itkNumericTraits.h"
+#include "vnl/vnl_math.h"
+#include "otbMacro.h"
+
+#include <algorithm>
+
+namespace otb
+{
+
+template <class TInputImage, class TMaskImage>
+PersistentMiniBatchKMeansImageFilter<TInputImage, TMaskImage>
+::PersistentMiniBatchKMeansImageFilter()
+  : m_Inertia(0.),
+    m_CentroidsShift(0.)
+{
+  this->SetNumberOfRequiredInputs(1);
+}
+
+template <class TInputImage, class TMaskImage>
+void
+PersistentMiniBatchKMeansImageFilter<TInputImage, TMaskImage>
+::SetMaskImage(const MaskImageType * mask)
+{
+  this->itk::ProcessObject::SetNthInput(1, const_cast<MaskImageType *>(mask));
+}
+
+template <class TInputImage, class TMaskImage>
+const typename PersistentMiniBatchKMeansImageFilter<TInputImage, TMaskImage>::MaskImageType *
+PersistentMiniBatchKMeansImageFilter<TInputImage, TMaskImage>
+::GetMaskImage() const
+{
+  if (this->GetNumberOfInputs() < 2)
+    {
+    return ITK_NULLPTR;
+    }
+  return static_cast<const MaskImageType *>(this->itk::ProcessObject::GetInput(1));
+}
+
+template <class TInputImage, class TMaskImage>
+void
+PersistentMiniBatchKMeansImageFilter<TInputImage, TMaskImage>
+::SetCentroids(const CentroidsType & centroids, unsigned int nbComponents)
+{
+  if (nbComponents == 0 || centroids.empty() || centroids.size() % nbComponents != 0)
+    {
+    itkExceptionMacro(<< "The centroids do not have " << nbComponents << " components");
+    }
+  m_Functor.SetCentroids(centroids, nbComponents);
+  this->Modified();
+}
+
+template <class TInputImage, class TMaskImage>
+void
+PersistentMiniBatchKMeansImageFilter<TInputImage, TMaskImage>
+::InitializeCentroids(const ListSampleType * samples, unsigned int nbClasses)
+{
+  typedef itk::Statistics::MersenneTwisterRandomVariateGenerator RandomGeneratorType;
+
+  if (samples == ITK_NULLPTR || samples->Size() == 0)
+    {
+    itkExceptionMacro(<< "No sample to initialize the centroids");
+    }
+  if (nbClasses == 0)
+    {
+    itkExceptionMacro(<< "The number of classes must be positive");
+    }
+
+  RandomGeneratorType::Pointer randomGenerator = RandomGeneratorType::GetInstance();
+
+  const unsigned int nbComponents = samples->GetMeasurementVectorSize();
+  const itk::SizeValueType nbSamples = samples->Size();
+
+  FunctorType seeds;
+  seeds.AddCentroid(samples->GetMeasurementVector(randomGenerator->GetIntegerVariate(nbSamples - 1)),
+                    nbComponents);
+
+  // Squared distance of each sample to its nearest seed
+  std::vector<ValueType> sqDistances(nbSamples, itk::NumericTraits<ValueType>::max());
+
+  while (seeds.GetNumberOfCentroids() < nbClasses)
+    {
+    // Only the last seed can be nearer than the previous ones
+    FunctorType lastSeed;
+    lastSeed.SetCentroids(CentroidsType(seeds.GetCentroids().end() - nbComponents, seeds.GetCentroids().end()),
+                          nbComponents);
+
+    double total = 0.;
+    for (itk::SizeValueType i = 0; i < nbSamples; ++i)
+      {
+      ValueType sqDistance;
+      lastSeed.GetNearestCentroid(samples->GetMeasurementVector(i), sqDistance);
+      sqDistances[i] = std::min(sqDistances[i], sqDistance);
+      total += sqDistances[i];
+      }
+
+    itk::SizeValueType chosen = 0;
+    if (total > 0.)
+      {
+      const double target = randomGenerator->GetVariateWithOpenUpperRange(total);
+      double cumulated = 0.;
+      for (chosen = 0; chosen < nbSamples - 1; ++chosen)
+        {
+        cumulated += sqDistances[chosen];
+        if (cumulated > target)
+          {
+          break;
+          }
+        }
+      }
+    else
+      {
+      // All the samples are on a seed
+      chosen = randomGenerator->GetIntegerVariate(nbSamples - 1);
+      }
+
+    seeds.AddCentroid(samples->GetMeasurementVector(chosen), nbComponents);
+    }
+
+  m_Functor = seeds;
+  this->Modified();
+}
+
+template <class TInputImage, class TMaskImage>
+void
+PersistentMiniBatchKMeansImageFilter<TInputImage, TMaskImage>
+::GenerateOutputInformation()
+{
+  Superclass::GenerateOutputInformation();
+  if (this->GetInput())
+    {
+    this->GetOutput()->CopyInformation(this->GetInput());
+    this->GetOutput()->SetLargestPossibleRegion(this->GetInput()->GetLargestPossibleRegion());
+
+    if (this->GetOutput()->GetRequestedRegion().GetNumberOfPixels() == 0)
+      {
+      this->GetOutput()->SetRequestedRegion(this->GetOutput()->GetLargestPossibleRegion());
+      }
+    }
+}
+
+template <class TInputImage, class TMaskImage>
+void
+PersistentMiniBatchKMeansImageFilter<TInputImage, TMaskImage>
+::Reset()
+{
+  TInputImage * inputPtr = const_cast<TInputImage *>(this->GetInput());
+  inputPtr->UpdateOutputInformation();
+
+  if (GetNumberOfClasses() == 0)
+    {
+    itkExceptionMacro(<< "The centroids are not initialized");
+    }
+  if (inputPtr->GetNumberOfComponentsPerPixel() != m_Functor.GetNumberOfComponents())
+    {
+    itkExceptionMacro(<< "The centroids have " << m_Functor.GetNumberOfComponents()
+                      << " components, and the image " << inputPtr->GetNumberOfComponentsPerPixel());
+    }
+
+  m_PreviousCentroids = m_Functor.GetCentroids();
+  m_Counts.assign(GetNumberOfClasses(), 0);
+  m_Inertia = 0.;
+  m_CentroidsShift = 0.;
+
+  // The pipeline may not have changed since the previous pass
+  this->Modified();
+}
+
+template <class TInputImage, class TMaskImage>
+void
+PersistentMiniBatchKMeansImageFilter<TInputImage, TMaskImage>
+::BeforeThreadedGenerateData()
+{
+  const itk::SizeValueType nbPixels = this->GetOutput()->GetRequestedRegion().GetNumberOfPixels();
+
+  m_PieceLabels.assign(nbPixels, GetNumberOfClasses());
+  m_PieceSquaredDistances.assign(nbPixels, 0.);
+}
+
+template <class TInputImage, class TMaskImage>
+itk::SizeValueType
+PersistentMiniBatchKMeansImageFilter<TInputImage, TMaskImage>
+::GetPieceOffset(const typename RegionType::IndexType & index) const
+{
+  const RegionType & piece = this->GetOutput()->GetRequestedRegion();
+
+  itk::SizeValueType offset = 0;
+  itk::SizeValueType stride = 1;
+  for (unsigned int d = 0; d < RegionType::ImageDimension; ++d)
+    {
+    offset += static_cast<itk::SizeValueType>(index[d] - piece.GetIndex()[d]) * stride;
+    stride *= piece.GetSize()[d];
+    }
+  return offset;
+}
+
+template <class TInputImage, class TMaskImage>
+void
+PersistentMiniBatchKMeansImageFilter<TInputImage, TMaskImage>
+::ThreadedGenerateData(const RegionType& outputRegionForThread, itk::ThreadIdType itkNotUsed(threadId))
+{
+  typedef itk::ImageRegionConstIteratorWithIndex<ImageType> InputIteratorType;
+  typedef itk::ImageRegionConstIterator<MaskImageType>      MaskIteratorType;
+
+  const ImageType *     inputPtr = this->GetInput();
+  const MaskImageType * maskPtr = this->GetMaskImage();
+
+  InputIteratorType inIt(inputPtr, outputRegionForThread);
+  MaskIteratorType  maskIt;
+  if (maskPtr)
+    {
+    maskIt = MaskIteratorType(maskPtr, outputRegionForThread);
+    maskIt.GoToBegin();
+    }
+
+  // The pixels are only assigned here, the centroids are updated in
+  // AfterThreadedGenerateData() whatever the split between the threads
+  for (inIt.GoToBegin(); !inIt.IsAtEnd(); ++inIt)
+    {
+    if (maskPtr)
+      {
+      const bool valid = maskIt.Get() > 0;
+      ++maskIt;
+      if (!valid)
+        {
+        continue;
+        }
+      }
+
+    const itk::SizeValueType offset = GetPieceOffset(inIt.GetIndex());
+    m_PieceLabels[offset] = m_Functor.GetNearestCentroid(inIt.Get(), m_PieceSquaredDistances[offset]);
+    }
+}
+
+template <class TInputImage, class TMaskImage>
+void
+PersistentMiniBatchKMeansImageFilter<TInputImage, TMaskImage>
+::AfterThreadedGenerateData()
+{
+  typedef itk::ImageRegionConstIterator<ImageType> InputIteratorType;
+
+  const unsigned int nbComponents = m_Functor.GetNumberOfComponents();
+  const unsigned int nbClasses = GetNumberOfClasses();
+  CentroidsType      centroids = m_Functor.GetCentroids();
+
+  // Sums of the mini-batch, in the order of the pixels in the image
+  CentroidsType batchSums(nbClasses * nbComponents, 0.);
+  CountsType    batchCounts(nbClasses, 0);
+
+  InputIteratorType inIt(this->GetInput(), this->GetOutput()->GetRequestedRegion());
+  itk::SizeValueType offset = 0;
+  for (inIt.GoToBegin(); !inIt.IsAtEnd(); ++inIt, ++offset)
+    {
+    const unsigned int label = m_PieceLabels[offset];
+    if (label == nbClasses)
+      {
+      continue;
+      }
+
+    const PixelType pixel = inIt.Get();
+    ValueType * sum = &batchSums[label * nbComponents];
+    for (unsigned int c = 0; c < nbComponents; ++c)
+      {
+      sum[c] += static_cast<ValueType>(pixel[c]);
+      }
+    ++batchCounts[label];
+    m_Inertia += m_PieceSquaredDistances[offset];
+    }
+
+  for (unsigned int k = 0; k < nbClasses; ++k)
+    {
+    const itk::SizeValueType batchCount = batchCounts[k];
+    if (batchCount == 0)
+      {
+      continue;
+      }
+
+    // Running mean of the pixels assigned to the centroid since Reset()
+    m_Counts[k] += batchCount;
+    const double rate = 1. / static_cast<double>(m_Counts[k]);
+    for (unsigned int c = 0; c < nbComponents; ++c)
+      {
+      ValueType & centroid = centroids[k * nbComponents + c];
+      centroid += rate * (batchSums[k * nbComponents + c] - static_cast<double>(batchCount) * centroid);
+      }
+    }
+
+  m_Functor.SetCentroids(centroids, nbComponents);
+}
+
+template <class TInputImage, class TMaskImage>
+void
+PersistentMiniBatchKMeansImageFilter<TInputImage, TMaskImage>
+::Synthetize()
+{
+  const unsigned int nbComponents = m_Functor.GetNumberOfComponents();
+  const CentroidsType & centroids = m_Functor.GetCentroids();
+
+  m_CentroidsShift = 0.;
+  for (unsigned int k = 0; k < GetNumberOfClasses(); ++k)
+    {
+    double shift = 0.;
+    for (unsigned int c = 0; c < nbComponents; ++c)
+      {
+      const double d = centroids[k * nbComponents + c] - m_PreviousCentroids[k * nbComponents + c];
+      shift += d * d;
+      }
+    m_CentroidsShift = std::max(m_CentroidsShift, vcl_sqrt(shift));
+    }
+}
+
+template <class TInputImage, class TMaskImage>
+void
+PersistentMiniBatchKMeansImageFilter<TInputImage, TMaskImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Number of classes: " << GetNumberOfClasses() << std::endl;
+  os << indent << "Inertia: " << m_Inertia << std::endl;
+  os << indent << "Centroids shift: " << m_CentroidsShift << std::endl;
+}
+
+template <class TInputImage, class TMaskImage>
+StreamingMiniBatchKMeansImageFilter<TInputImage, TMaskImage>
+::StreamingMiniBatchKMeansImageFilter()
+  : m_MaximumNumberOfIterations(10),
+    m_CentroidsShiftThreshold(0.0001),
+    m_NumberOfIterations(0),
+    m_BatchSize(262144)
+{
+}
+
+template <class TInputImage, class TMaskImage>
+void
+StreamingMiniBatchKMeansImageFilter<TInputImage, TMaskImage>
+::Update(void)
+{
+  if (this->GetInput() == ITK_NULLPTR)
+    {
+    itkExceptionMacro(<< "No input image");
+    }
+  if (m_BatchSize == 0)
+    {
+    itkExceptionMacro(<< "The batch size must be positive");
+    }
+
+  // The mini-batches are the streamed strips: their size must not
+  // depend on the available RAM
+  const_cast<InputImageType *>(this->GetInput())->UpdateOutputInformation();
+  const itk::SizeValueType width = this->GetInput()->GetLargestPossibleRegion().GetSize()[0];
+  this->GetStreamer()->SetNumberOfLinesStrippedStreaming(
+    static_cast<unsigned int>(std::max<itk::SizeValueType>(1, m_BatchSize / width)));
+
+  m_NumberOfIterations = 0;
+  do
+    {
+    this->GenerateData();
+    ++m_NumberOfIterations;
+    otbMsgDevMacro(<< "K-means pass " << m_NumberOfIterations << ": inertia " << this->GetInertia()
+                   << ", centroids shift " << this->GetCentroidsShift());
+    this->InvokeEvent(itk::IterationEvent());
+    }
+  while (m_NumberOfIterations < m_MaximumNumberOfIterations
+         && this->GetCentroidsShift() > m_CentroidsShiftThreshold);
+}
+
+} // end namespace otb
+
+#endif
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <iostream>
+#include <cstdlib>
+
+#include "otbStreamingMiniBatchKMeansImageFilter.h"
+#include "otbVectorImage.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "vnl/vnl_math.h"
+
+int otbStreamingMiniBatchKMeansImageFilter(int itkNotUsed(argc), char * itkNotUsed(argv) [])
+{
+  typedef otb::VectorImage<float, 2>                                 ImageType;
+  typedef otb::Image<unsigned char, 2>                               MaskType;
+  typedef otb::StreamingMiniBatchKMeansImageFilter<ImageType, MaskType> FilterType;
+
+  const unsigned int nbComponents = 5;
+  const unsigned int nbClasses = 3;
+
+  // Three vertical bands of 100 columns, of values 0, 100 and 200 with
+  // a small noise. The last 10 lines have an outlier value, and are
+  // masked out.
+  ImageType::SizeType size;
+  size[0] = 300;
+  size[1] = 110;
+  ImageType::RegionType region;
+  region.SetSize(size);
+
+  ImageType::Pointer image = ImageType::New();
+  image->SetRegions(region);
+  image->SetNumberOfComponentsPerPixel(nbComponents);
+  image->Allocate();
+
+  MaskType::Pointer mask = MaskType::New();
+  mask->SetRegions(region);
+  mask->Allocate();
+
+  FilterType::ListSampleType::Pointer samples = FilterType::ListSampleType::New();
+  samples->SetMeasurementVectorSize(nbComponents);
+
+  itk::ImageRegionIteratorWithIndex<ImageType> it(image, region);
+  itk::ImageRegionIteratorWithIndex<MaskType>  maskIt(mask, region);
+  ImageType::PixelType pixel(nbComponents);
+  for (it.GoToBegin(), maskIt.GoToBegin(); !it.IsAtEnd(); ++it, ++maskIt)
+    {
+    const ImageType::IndexType index = it.GetIndex();
+    const bool valid = index[1] < 100;
+    for (unsigned int c = 0; c < nbComponents; ++c)
+      {
+      const float noise = static_cast<float>((index[0] * 7 + index[1] * 13 + c * 3) % 11) - 5.f;
+      pixel[c] = valid ? 100.f * (index[0] / 100) + noise : 10000.f;
+      }
+    it.Set(pixel);
+    maskIt.Set(valid ? 1 : 0);
+
+    if (valid && index[1] % 10 == 0 && index[0] % 10 == 0)
+      {
+      samples->PushBack(pixel);
+      }
+    }
+
+  // Mini-batches of 10 lines
+  FilterType::Pointer filter = FilterType::New();
+  filter->SetInput(image);
+  filter->SetMaskImage(mask);
+  filter->InitializeCentroids(samples, nbClasses);
+  filter->SetMaximumNumberOfIterations(20);
+  filter->SetCentroidsShiftThreshold(0.001);
+  filter->SetBatchSize(3000);
+  const FilterType::CentroidsType seeds = filter->GetCentroids();
+  filter->GetStreamer()->SetNumberOfDivisionsStrippedStreaming(7);
+  filter->Update();
+
+  std::cout << "Passes: " << filter->GetNumberOfIterations() << ", inertia: " << filter->GetInertia() << std::endl;
+
+  // The same mini-batches give the same centroids with one thread and
+  // another streaming
+  FilterType::Pointer singleThreadFilter = FilterType::New();
+  singleThreadFilter->SetInput(image);
+  singleThreadFilter->SetMaskImage(mask);
+  singleThreadFilter->SetCentroids(seeds, nbComponents);
+  singleThreadFilter->SetMaximumNumberOfIterations(20);
+  singleThreadFilter->SetCentroidsShiftThreshold(0.001);
+  singleThreadFilter->SetBatchSize(3000);
+  singleThreadFilter->GetFilter()->SetNumberOfThreads(1);
+  singleThreadFilter->GetStreamer()->SetNumberOfDivisionsTiledStreaming(4);
+  singleThreadFilter->Update();
+
+  if (singleThreadFilter->GetCentroids() != filter->GetCentroids()
+      || singleThreadFilter->GetNumberOfIterations() != filter->GetNumberOfIterations())
+    {
+    std::cerr << "The centroids depend on the threads or on the streaming" << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Each band gives one centroid, at the mean of its pixels
+  const FilterType::CentroidsType & centroids = filter->GetCentroids();
+  bool found[nbClasses] = {false, false, false};
+  for (unsigned int k = 0; k < nbClasses; ++k)
+    {
+    const int band = static_cast<int>(vnl_math_rnd(centroids[k * nbComponents] / 100.));
+    std::cout << "Centroid " << k << ": " << centroids[k * nbComponents] << std::endl;
+    if (band < 0 || band >= static_cast<int>(nbClasses) || found[band])
+      {
+      std::cerr << "Centroid " << k << " is not the only one of a band" << std::endl;
+      return EXIT_FAILURE;
+      }
+    found[band] = true;
+    if (filter->GetCounts()[k] != 100 * 100)
+      {
+      std::cerr << "Centroid " << k << " has " << filter->GetCounts()[k] << " pixels instead of 10000" << std::endl;
+      return EXIT_FAILURE;
+      }
+    for (unsigned int c = 0; c < nbComponents; ++c)
+      {
+      if (vnl_math_abs(centroids[k * nbComponents + c] - 100. * band) > 1.)
+        {
+        std::cerr << "Centroid " << k << " is too far from the mean of its band" << std::endl;
+        return EXIT_FAILURE;
+        }
+      }
+    }
+
+  // The functor labels each pixel with its band centroid
+  ImageType::IndexType index;
+  index[1] = 50;
+  for (index[0] = 0; index[0] < 300; index[0] += 50)
+    {
+    const unsigned int label = filter->GetFunctor()(image->GetPixel(index));
+    if (vnl_math_rnd(centroids[label * nbComponents] / 100.) != index[0] / 100)
+      {
+      std::cerr << "Wrong label " << label << " for pixel " << index << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
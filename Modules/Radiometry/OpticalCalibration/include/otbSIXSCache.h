@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef otbSIXSCache_h
+#define otbSIXSCache_h
+
+#include "OTBOpticalCalibrationExport.h"
+#include "otbAtmosphericCorrectionParameters.h"
+#include "itkFixedArray.h"
+#include "itkMutexLock.h"
+
+#include <map>
+#include <string>
+
+namespace otb
+{
+
+/** \class SIXSCache
+ * \brief Memory and disk cache of the atmospheric radiative terms computed by 6S.
+ *
+ * A 6S run only depends on the acquisition geometry, the date, the
+ * atmospheric parameters and the spectral sensitivity of the band
+ * resampled at the 6S step. Those inputs are gathered into a key and
+ * the nine output terms are stored in a map, so that identical calls
+ * to SIXSTraits::ComputeAtmosphericParameters() skip the 6S run.
+ *
+ * The sensor does not need to be part of the key: the relative
+ * spectral response of the band fully identifies it from the 6S
+ * point of view.
+ *
+ * If the OTB_6S_CACHE_FILE environment variable is set (see
+ * ConfigurationManager::GetSIXSCacheFile()), the entries are loaded
+ * from this file at first use and every new entry is appended to it,
+ * so that the cache is shared between runs and processes.
+ *
+ * All methods are thread-safe.
+ *
+ * \sa SIXSTraits
+ *
+ * \ingroup OTBOpticalCalibration
+ */
+class OTBOpticalCalibration_EXPORT SIXSCache
+{
+public:
+  /** Standard class typedefs. */
+  typedef SIXSCache Self;
+
+  /** Number of radiative terms returned by 6S */
+  itkStaticConstMacro(NumberOfTerms, unsigned int, 9);
+
+  /** Terms in the SIXSTraits::ComputeAtmosphericParameters() output
+   * order : atmospheric reflectance, spherical albedo, total gaseous
+   * transmission, downward transmittance, upward transmittance,
+   * upward diffuse transmittance, upward direct transmittance, upward
+   * diffuse transmittance for rayleigh and for aerosols. */
+  typedef itk::FixedArray<double, 9>                        TermsType;
+  typedef FilterFunctionValues                              WavelengthSpectralType;
+  typedef AtmosphericCorrectionParameters::AerosolModelType AerosolModelType;
+
+  /** Get the process-wide cache instance */
+  static Self * GetInstance();
+
+  /** Build the key identifying a 6S run. The spectral band must have
+   * been resampled at the 6S step (see
+   * SIXSTraits::ComputeWavelengthSpectralBandValuesFor6S()) */
+  static std::string GenerateKey(
+    const double SolarZenithalAngle,
+    const double SolarAzimutalAngle,
+    const double ViewingZenithalAngle,
+    const double ViewingAzimutalAngle,
+    const unsigned int Month,
+    const unsigned int Day,
+    const double AtmosphericPressure,
+    const double WaterVaporAmount,
+    const double OzoneAmount,
+    const AerosolModelType& AerosolModel,
+    const double AerosolOptical,
+    const WavelengthSpectralType* WavelengthSpectralBand);
+
+  /** Look for a key, return true and fill terms if found */
+  bool Find(const std::string& key, TermsType& terms);
+
+  /** Store the terms of a key (and append them to the cache file if any) */
+  void Insert(const std::string& key, const TermsType& terms);
+
+  /** Number of entries currently held in memory */
+  unsigned int GetNumberOfEntries();
+
+  /** Remove all entries from memory (the cache file is left untouched) */
+  void Clear();
+
+  /** Enable or disable the cache (enabled by default) */
+  void SetEnabled(bool flag);
+  bool GetEnabled();
+
+  /** Set the cache file name. This overrides OTB_6S_CACHE_FILE and
+   * loads the entries already stored in the file. An empty name
+   * disables the persistence. */
+  void SetFileName(const std::string& filename);
+  std::string GetFileName();
+
+private:
+  SIXSCache();
+  ~SIXSCache() {}
+  SIXSCache(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  /** Read the entries of m_FileName, the lock must be held */
+  void LoadFile();
+
+  typedef std::map<std::string, TermsType> MapType;
+
+  MapType              m_Map;
+  std::string          m_FileName;
+  bool                 m_Enabled;
+  itk::SimpleMutexLock m_Mutex;
+};
+
+} // namespace otb
+
+#endif
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef otbSIXSLookupTable_h
+#define otbSIXSLookupTable_h
+
+#include "OTBOpticalCalibrationExport.h"
+#include "otbSIXSCache.h"
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+
+#include <vector>
+
+namespace otb
+{
+
+/** \class SIXSLookupTable
+ * \brief Precomputed 6S radiative terms over aerosol optical thickness and geometry.
+ *
+ * For bulk processing of products sharing the same date, atmosphere
+ * and spectral band but with varying aerosol optical thickness and
+ * zenithal angles, 6S is run once on each node of a regular
+ * (solar zenithal angle, viewing zenithal angle, aerosol optical
+ * thickness) grid when Compute() is called. Evaluate() then returns
+ * the trilinear interpolation of the nine radiative terms.
+ *
+ * Each axis must be sorted in increasing order and hold at least one
+ * value. Queries outside of an axis are clamped to its bounds.
+ *
+ * \sa SIXSTraits, SIXSCache
+ *
+ * \ingroup OTBOpticalCalibration
+ */
+class OTBOpticalCalibration_EXPORT SIXSLookupTable : public itk::Object
+{
+public:
+  /** Standard typedefs */
+  typedef SIXSLookupTable               Self;
+  typedef itk::Object                   Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Type macro */
+  itkTypeMacro(SIXSLookupTable, Object);
+
+  /** Creation through object factory macro */
+  itkNewMacro(Self);
+
+  typedef SIXSCache::TermsType                              TermsType;
+  typedef FilterFunctionValues                              WavelengthSpectralType;
+  typedef AtmosphericCorrectionParameters::AerosolModelType AerosolModelType;
+  typedef std::vector<double>                               AxisType;
+
+  /** Fixed parameters */
+  itkSetMacro(SolarAzimutalAngle, double);
+  itkGetMacro(SolarAzimutalAngle, double);
+  itkSetMacro(ViewingAzimutalAngle, double);
+  itkGetMacro(ViewingAzimutalAngle, double);
+  itkSetMacro(Month, unsigned int);
+  itkGetMacro(Month, unsigned int);
+  itkSetMacro(Day, unsigned int);
+  itkGetMacro(Day, unsigned int);
+  itkSetMacro(AtmosphericPressure, double);
+  itkGetMacro(AtmosphericPressure, double);
+  itkSetMacro(WaterVaporAmount, double);
+  itkGetMacro(WaterVaporAmount, double);
+  itkSetMacro(OzoneAmount, double);
+  itkGetMacro(OzoneAmount, double);
+  itkSetEnumMacro(AerosolModel, AerosolModelType);
+  itkGetEnumMacro(AerosolModel, AerosolModelType);
+  itkSetObjectMacro(WavelengthSpectralBand, WavelengthSpectralType);
+  itkGetObjectMacro(WavelengthSpectralBand, WavelengthSpectralType);
+
+  /** Grid axes */
+  void SetSolarZenithalAngleAxis(const AxisType& axis);
+  const AxisType& GetSolarZenithalAngleAxis() const
+  {
+    return m_SolarZenithalAngleAxis;
+  }
+  void SetViewingZenithalAngleAxis(const AxisType& axis);
+  const AxisType& GetViewingZenithalAngleAxis() const
+  {
+    return m_ViewingZenithalAngleAxis;
+  }
+  void SetAerosolOpticalAxis(const AxisType& axis);
+  const AxisType& GetAerosolOpticalAxis() const
+  {
+    return m_AerosolOpticalAxis;
+  }
+
+  /** Run 6S on every node of the grid */
+  void Compute();
+
+  /** Interpolate the radiative terms, Compute() must have been called
+   * since the last modification of the parameters */
+  void Evaluate(double solarZenithalAngle, double viewingZenithalAngle, double aerosolOptical,
+                TermsType& terms) const;
+
+protected:
+  /** Constructor */
+  SIXSLookupTable();
+  /** Destructor */
+  ~SIXSLookupTable() ITK_OVERRIDE {}
+
+  /** PrintSelf method */
+  void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
+
+private:
+  SIXSLookupTable(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  /** Locate value in axis: lower node index and interpolation weight */
+  static void Locate(const AxisType& axis, double value, unsigned int& index, double& weight);
+
+  /** Linear index of a node in m_Table */
+  unsigned int NodeIndex(unsigned int sza, unsigned int vza, unsigned int aot) const
+  {
+    return (sza * m_ViewingZenithalAngleAxis.size() + vza) * m_AerosolOpticalAxis.size() + aot;
+  }
+
+  double           m_SolarAzimutalAngle;
+  double           m_ViewingAzimutalAngle;
+  unsigned int     m_Month;
+  unsigned int     m_Day;
+  double           m_AtmosphericPressure;
+  double           m_WaterVaporAmount;
+  double           m_OzoneAmount;
+  AerosolModelType m_AerosolModel;
+
+  WavelengthSpectralType::Pointer m_WavelengthSpectralBand;
+
+  AxisType m_SolarZenithalAngleAxis;
+  AxisType m_ViewingZenithalAngleAxis;
+  AxisType m_AerosolOpticalAxis;
+
+  /** Radiative terms for each node, aerosol optical thickness varying fastest */
+  std::vector<TermsType> m_Table;
+};
+
+} // namespace otb
+
+#endif
@@ -50,7 +50,10 @@ public:
   typedef WavelengthSpectralType::WavelengthSpectralBandType WavelengthSpectralBandType;
   typedef WavelengthSpectralType::ValuesVectorType           ValuesVectorType;
 
-  /** Call 6S main function */
+  /** Call 6S main function.
+   *
+   * Results are kept in the SIXSCache, so that a second call with the
+   * same parameters does not run 6S again. */
   static void ComputeAtmosphericParameters(
     const double SolarZenithalAngle,                                        /** The Solar zenithal angle */
     const double SolarAzimutalAngle,                                        /** The Solar azimutal angle */
@@ -92,7 +92,7 @@ public:
     {
       contribution = 0;
       // Load the current channel ponderation value matrix
-      WeightingMatrixType TempChannelWeighting = m_WeightingValues[j];
+      const WeightingMatrixType& TempChannelWeighting = m_WeightingValues[j];
       // Loop over the neighborhood
       for (unsigned int i = 0; i < neighborhoodSize; ++i)
       {
@@ -132,6 +132,14 @@ private:
  *   reflectance estimation. The satellite signal is considered as to be a combinaison of the signal coming from
  *   the target pixel and a weighting of the siganls coming from the neighbor pixels.
  *
+ *   The neighborhood weighting cost grows with the square of the window radius. When UseFFT is on,
+ *   the weighting is computed as an overlap-save convolution in the Fourier domain on each thread
+ *   region instead (same approach as OverlapSaveConvolutionImageFilter), so that large radii
+ *   matching the physical adjacency distance remain tractable. Boundaries are handled as in the
+ *   neighborhood implementation (zero flux Neumann), results are identical up to rounding errors.
+ *
+ * \note UseFFT requires ITK to be built with FFTW (double implementation, ITK_USE_FFTWD).
+ *
  * \ingroup Radiometry
  *
  *
@@ -265,6 +273,11 @@ public:
   itkGetMacro(IsSetAtmosphericRadiativeTerms, bool);
   itkBooleanMacro(IsSetAtmosphericRadiativeTerms);
 
+  /** Set/Get the use of the FFT based computation of the neighborhood contribution */
+  itkSetMacro(UseFFT, bool);
+  itkGetMacro(UseFFT, bool);
+  itkBooleanMacro(UseFFT);
+
 protected:
   SurfaceAdjacencyEffectCorrectionSchemeFilter();
   ~SurfaceAdjacencyEffectCorrectionSchemeFilter() ITK_OVERRIDE {}
@@ -273,6 +286,12 @@ protected:
   /** Initialize the parameters of the functor before the threads run. */
   void BeforeThreadedGenerateData() ITK_OVERRIDE;
 
+  /** Use the neighborhood functor, or the Fourier domain if UseFFT is on */
+  void ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType threadId) ITK_OVERRIDE;
+
+  /** Fourier domain computation of the neighborhood contribution */
+  void ThreadedGenerateDataFFT(const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType threadId);
+
   /** Fill AtmosphericRadiativeTerms using image metadata*/
   void UpdateAtmosphericRadiativeTerms();
 
@@ -303,6 +322,11 @@ private:
   double m_PixelSpacingInKilometers;
   /** Viewing angle in degree */
   double m_ZenithalViewingAngle;
+  /** Compute the neighborhood contribution in the Fourier domain */
+  bool m_UseFFT;
+  /** Functor ratios, kept here for the FFT computation */
+  DoubleContainerType m_UpwardTransmittanceRatio;
+  DoubleContainerType m_DiffuseRatio;
 };
 
 } // end namespace otb
@@ -35,6 +35,13 @@
 #include "otbSIXSTraits.h"
 #include "otbMath.h"
 #include "otbOpticalImageMetadataInterfaceFactory.h"
+#include "itkImageRegionConstIterator.h"
+
+#include <algorithm>
+
+#if defined ITK_USE_FFTWD
+#include "itkFFTWCommon.h"
+#endif
 
 namespace otb
 {
@@ -48,7 +55,8 @@ SurfaceAdjacencyEffectCorrectionSchemeFilter<TInputImage, TOutputImage>
  m_WindowRadius(1),
  m_FunctorParametersHaveBeenComputed(false),
  m_PixelSpacingInKilometers(1.),
- m_ZenithalViewingAngle(361.)
+ m_ZenithalViewingAngle(361.),
+ m_UseFFT(false)
 {
   m_AtmosphericRadiativeTerms = AtmosphericRadiativeTermsType::New();
   m_AtmoCorrectionParameters = AtmoCorrectionParametersType::New();
@@ -63,6 +71,205 @@ SurfaceAdjacencyEffectCorrectionSchemeFilter<TInputImage, TOutputImage>
   Superclass::BeforeThreadedGenerateData();
   this->GenerateParameters();
 
+#if !defined ITK_USE_FFTWD
+  if (m_UseFFT)
+    {
+    itkExceptionMacro(<< "UseFFT requires the FFTW library (double implementation). Please build ITK with USE_FFTWD set to ON, and rebuild OTB.");
+    }
+#endif
+}
+
+template <class TInputImage, class TOutputImage>
+void
+SurfaceAdjacencyEffectCorrectionSchemeFilter<TInputImage, TOutputImage>
+::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType threadId)
+{
+  if (m_UseFFT)
+    {
+    this->ThreadedGenerateDataFFT(outputRegionForThread, threadId);
+    }
+  else
+    {
+    Superclass::ThreadedGenerateData(outputRegionForThread, threadId);
+    }
+}
+
+template <class TInputImage, class TOutputImage>
+void
+SurfaceAdjacencyEffectCorrectionSchemeFilter<TInputImage, TOutputImage>
+::ThreadedGenerateDataFFT(const OutputImageRegionType& outputRegionForThread, itk::ThreadIdType threadId)
+{
+#if defined ITK_USE_FFTWD
+  typedef itk::fftw::Proxy<double> FFTWProxyType;
+
+  const InputImageType * inputPtr = this->GetInput();
+  OutputImageType *      outputPtr = this->GetOutput();
+
+  const unsigned int nbBands = inputPtr->GetNumberOfComponentsPerPixel();
+  const unsigned int radius = m_WindowRadius;
+  const unsigned int sizeOfFilter = 2 * radius + 1;
+
+  // The piece is the output region padded by the radius. Its circular
+  // convolution with the (2r+1)x(2r+1) kernel is free of aliasing on
+  // the output region (overlap-save).
+  InputImageRegionType pieceRegion = outputRegionForThread;
+  pieceRegion.PadByRadius(radius);
+  const typename InputImageRegionType::IndexType pieceIndex = pieceRegion.GetIndex();
+  const unsigned int pieceSizeX = pieceRegion.GetSize()[0];
+  const unsigned int pieceSizeY = pieceRegion.GetSize()[1];
+  const unsigned int pieceNbOfPixel = pieceSizeX * pieceSizeY;
+  const unsigned int sizeFFT = (pieceSizeX / 2 + 1) * pieceSizeY;
+
+  // Part of the piece available in the input buffer, the rest is
+  // filled by replicating the border (zero flux Neumann condition, as
+  // the neighborhood implementation)
+  InputImageRegionType validRegion = pieceRegion;
+  validRegion.Crop(inputPtr->GetBufferedRegion());
+  const unsigned int validStartX = validRegion.GetIndex()[0] - pieceIndex[0];
+  const unsigned int validStartY = validRegion.GetIndex()[1] - pieceIndex[1];
+  const unsigned int validEndX = validStartX + validRegion.GetSize()[0];
+  const unsigned int validEndY = validStartY + validRegion.GetSize()[1];
+
+  // Band sequential copy of the piece
+  std::vector<double> pieceValues(static_cast<size_t>(nbBands) * pieceNbOfPixel);
+
+  itk::ImageRegionConstIterator<InputImageType> inputIt(inputPtr, validRegion);
+  inputIt.GoToBegin();
+  for (unsigned int y = validStartY; y < validEndY; ++y)
+    {
+    for (unsigned int x = validStartX; x < validEndX; ++x)
+      {
+      const InputPixelType& pixel = inputIt.Get();
+      for (unsigned int band = 0; band < nbBands; ++band)
+        {
+        pieceValues[band * pieceNbOfPixel + y * pieceSizeX + x] = static_cast<double>(pixel[band]);
+        }
+      ++inputIt;
+      }
+    }
+
+  for (unsigned int band = 0; band < nbBands; ++band)
+    {
+    double * values = &pieceValues[band * pieceNbOfPixel];
+    for (unsigned int y = validStartY; y < validEndY; ++y)
+      {
+      double * line = values + y * pieceSizeX;
+      for (unsigned int x = 0; x < validStartX; ++x)
+        {
+        line[x] = line[validStartX];
+        }
+      for (unsigned int x = validEndX; x < pieceSizeX; ++x)
+        {
+        line[x] = line[validEndX - 1];
+        }
+      }
+    for (unsigned int y = 0; y < validStartY; ++y)
+      {
+      std::copy(values + validStartY * pieceSizeX, values + (validStartY + 1) * pieceSizeX, values + y * pieceSizeX);
+      }
+    for (unsigned int y = validEndY; y < pieceSizeY; ++y)
+      {
+      std::copy(values + (validEndY - 1) * pieceSizeX, values + validEndY * pieceSizeX, values + y * pieceSizeX);
+      }
+    }
+
+  // FFTW buffers and plans, shared by all bands
+  FFTWProxyType::PixelType * workPiece =
+    static_cast<FFTWProxyType::PixelType*>(fftw_malloc(pieceNbOfPixel * sizeof(FFTWProxyType::PixelType)));
+  FFTWProxyType::ComplexType * workFFT =
+    static_cast<FFTWProxyType::ComplexType*>(fftw_malloc(sizeFFT * sizeof(FFTWProxyType::ComplexType)));
+  FFTWProxyType::ComplexType * filterFFT =
+    static_cast<FFTWProxyType::ComplexType*>(fftw_malloc(sizeFFT * sizeof(FFTWProxyType::ComplexType)));
+
+  // FFTW_ESTIMATE does not overwrite the buffers and keeps the plan
+  // creation cheap, as plans are created for each thread region
+  FFTWProxyType::PlanType forwardPlan = FFTWProxyType::Plan_dft_r2c_2d(pieceSizeY,
+                                                                       pieceSizeX,
+                                                                       workPiece,
+                                                                       workFFT,
+                                                                       FFTW_ESTIMATE);
+  FFTWProxyType::PlanType inversePlan = FFTWProxyType::Plan_dft_c2r_2d(pieceSizeY,
+                                                                       pieceSizeX,
+                                                                       workFFT,
+                                                                       workPiece,
+                                                                       FFTW_ESTIMATE);
+
+  const unsigned int outputSizeX = outputRegionForThread.GetSize()[0];
+  const unsigned int outputSizeY = outputRegionForThread.GetSize()[1];
+
+  for (unsigned int band = 0; band < nbBands; ++band)
+    {
+    // Kernel spectrum
+    const WeightingMatrixType& weighting = m_WeightingValues[band];
+    std::fill(workPiece, workPiece + pieceNbOfPixel, 0.);
+    for (unsigned int j = 0; j < sizeOfFilter; ++j)
+      {
+      for (unsigned int i = 0; i < sizeOfFilter; ++i)
+        {
+        workPiece[j * pieceSizeX + i] = weighting(j, i);
+        }
+      }
+    FFTWProxyType::Execute(forwardPlan);
+    std::copy(workFFT, workFFT + sizeFFT, filterFFT);
+
+    // Band spectrum times kernel spectrum
+    double * values = &pieceValues[band * pieceNbOfPixel];
+    std::copy(values, values + pieceNbOfPixel, workPiece);
+    FFTWProxyType::Execute(forwardPlan);
+    for (unsigned int k = 0; k < sizeFFT; ++k)
+      {
+      const double re = workFFT[k][0] * filterFFT[k][0] - workFFT[k][1] * filterFFT[k][1];
+      const double im = workFFT[k][0] * filterFFT[k][1] + workFFT[k][1] * filterFFT[k][0];
+      workFFT[k][0] = re;
+      workFFT[k][1] = im;
+      }
+    FFTWProxyType::Execute(inversePlan);
+
+    // The corrected value replaces the center pixel value, which is
+    // not used by any other output pixel
+    const double upwardRatio = m_UpwardTransmittanceRatio[band];
+    const double diffuseRatio = m_DiffuseRatio[band] / static_cast<double>(pieceNbOfPixel);
+    for (unsigned int y = 0; y < outputSizeY; ++y)
+      {
+      for (unsigned int x = 0; x < outputSizeX; ++x)
+        {
+        double& center = values[(y + radius) * pieceSizeX + x + radius];
+        center = center * upwardRatio + workPiece[(y + 2 * radius) * pieceSizeX + x + 2 * radius] * diffuseRatio;
+        }
+      }
+    }
+
+  FFTWProxyType::DestroyPlan(forwardPlan);
+  FFTWProxyType::DestroyPlan(inversePlan);
+  fftw_free(workPiece);
+  fftw_free(workFFT);
+  fftw_free(filterFFT);
+
+  // Fill the output image
+  itk::ProgressReporter progress(this, threadId, outputRegionForThread.GetNumberOfPixels());
+  itk::ImageRegionIterator<OutputImageType> outputIt(outputPtr, outputRegionForThread);
+  outputIt.GoToBegin();
+  OutputPixelType outPixel;
+  outPixel.SetSize(nbBands);
+  for (unsigned int y = 0; y < outputSizeY; ++y)
+    {
+    for (unsigned int x = 0; x < outputSizeX; ++x)
+      {
+      const unsigned int center = (y + radius) * pieceSizeX + x + radius;
+      for (unsigned int band = 0; band < nbBands; ++band)
+        {
+        outPixel[band] = static_cast<OutputInternalPixelType>(pieceValues[band * pieceNbOfPixel + center]);
+        }
+      outputIt.Set(outPixel);
+      ++outputIt;
+      progress.CompletedPixel();
+      }
+    }
+#else
+  (void)outputRegionForThread;
+  (void)threadId;
+  itkExceptionMacro(<< "UseFFT requires the FFTW library (double implementation). Please build ITK with USE_FFTWD set to ON, and rebuild OTB.");
+#endif
 }
 
 template <class TInputImage, class TOutputImage>
@@ -175,6 +382,8 @@ SurfaceAdjacencyEffectCorrectionSchemeFilter<TInputImage, TOutputImage>
       }
     }
 
+  m_WeightingValues.clear();
+
   for (unsigned int band = 0; band < inputPtr->GetNumberOfComponentsPerPixel(); ++band)
     {
     double rayleigh = m_AtmosphericRadiativeTerms->GetUpwardDiffuseTransmittanceForRayleigh(band);
@@ -183,9 +392,11 @@ SurfaceAdjacencyEffectCorrectionSchemeFilter<TInputImage, TOutputImage>
     WeightingMatrixType currentWeightingMatrix(2*m_WindowRadius + 1, 2*m_WindowRadius + 1);
     currentWeightingMatrix.Fill(0.);
 
-    for (unsigned int i = 0; i < 2 * m_WindowRadius + 1; ++i)
+    // The weighting only depends on the distance to the center, compute
+    // one quadrant and mirror it
+    for (unsigned int i = 0; i < m_WindowRadius + 1; ++i)
       {
-      for (unsigned int j = 0; j < 2 * m_WindowRadius + 1; ++j)
+      for (unsigned int j = 0; j < m_WindowRadius + 1; ++j)
         {
         double notUsed1, notUsed2;
         double factor = 1;
@@ -199,22 +410,26 @@ SurfaceAdjacencyEffectCorrectionSchemeFilter<TInputImage, TOutputImage>
                                                      notUsed2,
                                                      factor);                                                                                                        //Call to 6S
         currentWeightingMatrix(i, j) = factor;
+        currentWeightingMatrix(2 * m_WindowRadius - i, j) = factor;
+        currentWeightingMatrix(2 * m_WindowRadius - i, 2 * m_WindowRadius - j) = factor;
+        currentWeightingMatrix(i, 2 * m_WindowRadius - j) = factor;
         }
       }
     m_WeightingValues.push_back(currentWeightingMatrix);
     }
 
-  DoubleContainerType upwardTransmittanceRatio, diffuseRatio;
+  m_UpwardTransmittanceRatio.clear();
+  m_DiffuseRatio.clear();
 
   for (unsigned int band = 0; band < inputPtr->GetNumberOfComponentsPerPixel(); ++band)
     {
-    upwardTransmittanceRatio.push_back(m_AtmosphericRadiativeTerms->GetUpwardTransmittance(
-                                         band) / m_AtmosphericRadiativeTerms->GetUpwardDirectTransmittance(band));
-    diffuseRatio.push_back(m_AtmosphericRadiativeTerms->GetUpwardDiffuseTransmittance(
-                             band) / m_AtmosphericRadiativeTerms->GetUpwardDirectTransmittance(band));
+    m_UpwardTransmittanceRatio.push_back(m_AtmosphericRadiativeTerms->GetUpwardTransmittance(
+                                           band) / m_AtmosphericRadiativeTerms->GetUpwardDirectTransmittance(band));
+    m_DiffuseRatio.push_back(m_AtmosphericRadiativeTerms->GetUpwardDiffuseTransmittance(
+                               band) / m_AtmosphericRadiativeTerms->GetUpwardDirectTransmittance(band));
     }
-  this->GetFunctor().SetUpwardTransmittanceRatio(upwardTransmittanceRatio);
-  this->GetFunctor().SetDiffuseRatio(diffuseRatio);
+  this->GetFunctor().SetUpwardTransmittanceRatio(m_UpwardTransmittanceRatio);
+  this->GetFunctor().SetDiffuseRatio(m_DiffuseRatio);
   this->GetFunctor().SetWeightingValues(m_WeightingValues);
 }
 /**
@@ -228,6 +443,7 @@ SurfaceAdjacencyEffectCorrectionSchemeFilter<TInputImage, TOutput>
   os << indent << "Radius : " << m_WindowRadius << std::endl;
   os << indent << "Pixel spacing in kilometers: " << m_PixelSpacingInKilometers << std::endl;
   os << indent << "Zenithal viewing angle in degree: " << m_AcquiCorrectionParameters->GetViewingZenithalAngle() << std::endl;
+  os << indent << "Use FFT: " << m_UseFFT << std::endl;
 }
 
 } // end namespace otb
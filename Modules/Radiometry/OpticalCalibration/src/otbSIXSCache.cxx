@@ -0,0 +1,237 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "otbSIXSCache.h"
+
+#include "otbConfigurationManager.h"
+#include "otbMacro.h"
+#include "itkMutexLockHolder.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+namespace otb
+{
+
+namespace
+{
+/** FNV-1a hash of the band sensitivity, the values vector can hold
+ * up to 1501 elements and would make the key unreasonably long. */
+std::string HashValues(const FilterFunctionValues::ValuesVectorType& values)
+{
+  unsigned long long hash = 14695981039346656037ULL;
+  for (unsigned int i = 0; i < values.size(); ++i)
+    {
+    const unsigned char * bytes = reinterpret_cast<const unsigned char *>(&values[i]);
+    for (unsigned int b = 0; b < sizeof(FilterFunctionValues::WavelengthSpectralBandType); ++b)
+      {
+      hash ^= static_cast<unsigned long long>(bytes[b]);
+      hash *= 1099511628211ULL;
+      }
+    }
+  std::ostringstream oss;
+  oss << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return oss.str();
+}
+}
+
+SIXSCache::SIXSCache() :
+  m_FileName(ConfigurationManager::GetSIXSCacheFile()),
+  m_Enabled(true)
+{
+  itk::MutexLockHolder<itk::SimpleMutexLock> mutexHolder(m_Mutex);
+  this->LoadFile();
+}
+
+SIXSCache *
+SIXSCache::GetInstance()
+{
+  static itk::SimpleMutexLock mutex;
+  static SIXSCache * instance = ITK_NULLPTR;
+
+  itk::MutexLockHolder<itk::SimpleMutexLock> mutexHolder(mutex);
+  if (instance == ITK_NULLPTR)
+    {
+    instance = new SIXSCache;
+    }
+  return instance;
+}
+
+std::string
+SIXSCache::GenerateKey(
+  const double SolarZenithalAngle,
+  const double SolarAzimutalAngle,
+  const double ViewingZenithalAngle,
+  const double ViewingAzimutalAngle,
+  const unsigned int Month,
+  const unsigned int Day,
+  const double AtmosphericPressure,
+  const double WaterVaporAmount,
+  const double OzoneAmount,
+  const AerosolModelType& AerosolModel,
+  const double AerosolOptical,
+  const WavelengthSpectralType* WavelengthSpectralBand)
+{
+  const WavelengthSpectralType::ValuesVectorType& values = WavelengthSpectralBand->GetFilterFunctionValues6S();
+
+  // No white space in the key, so that it can be read back with operator>>
+  std::ostringstream oss;
+  oss << std::setprecision(17)
+      << SolarZenithalAngle << ';' << SolarAzimutalAngle << ';'
+      << ViewingZenithalAngle << ';' << ViewingAzimutalAngle << ';'
+      << Month << ';' << Day << ';'
+      << AtmosphericPressure << ';' << WaterVaporAmount << ';' << OzoneAmount << ';'
+      << static_cast<int>(AerosolModel) << ';' << AerosolOptical << ';'
+      << WavelengthSpectralBand->GetMinSpectralValue() << ';'
+      << WavelengthSpectralBand->GetMaxSpectralValue() << ';'
+      << values.size() << ';' << HashValues(values);
+  return oss.str();
+}
+
+bool
+SIXSCache::Find(const std::string& key, TermsType& terms)
+{
+  itk::MutexLockHolder<itk::SimpleMutexLock> mutexHolder(m_Mutex);
+  if (!m_Enabled)
+    {
+    return false;
+    }
+  MapType::const_iterator it = m_Map.find(key);
+  if (it == m_Map.end())
+    {
+    return false;
+    }
+  terms = it->second;
+  return true;
+}
+
+void
+SIXSCache::Insert(const std::string& key, const TermsType& terms)
+{
+  itk::MutexLockHolder<itk::SimpleMutexLock> mutexHolder(m_Mutex);
+  if (!m_Enabled)
+    {
+    return;
+    }
+  if (!m_Map.insert(MapType::value_type(key, terms)).second)
+    {
+    return;
+    }
+
+  if (!m_FileName.empty())
+    {
+    // Append only: several processes may share the same file, a
+    // duplicated line is harmless
+    std::ofstream ofs(m_FileName.c_str(), std::ios::out | std::ios::app);
+    if (!ofs)
+      {
+      otbGenericWarningMacro(<< "Unable to write the 6S cache file " << m_FileName);
+      return;
+      }
+    ofs << key << std::setprecision(17);
+    for (unsigned int i = 0; i < NumberOfTerms; ++i)
+      {
+      ofs << ' ' << terms[i];
+      }
+    ofs << '\n';
+    }
+}
+
+unsigned int
+SIXSCache::GetNumberOfEntries()
+{
+  itk::MutexLockHolder<itk::SimpleMutexLock> mutexHolder(m_Mutex);
+  return static_cast<unsigned int>(m_Map.size());
+}
+
+void
+SIXSCache::Clear()
+{
+  itk::MutexLockHolder<itk::SimpleMutexLock> mutexHolder(m_Mutex);
+  m_Map.clear();
+}
+
+void
+SIXSCache::SetEnabled(bool flag)
+{
+  itk::MutexLockHolder<itk::SimpleMutexLock> mutexHolder(m_Mutex);
+  m_Enabled = flag;
+}
+
+bool
+SIXSCache::GetEnabled()
+{
+  itk::MutexLockHolder<itk::SimpleMutexLock> mutexHolder(m_Mutex);
+  return m_Enabled;
+}
+
+void
+SIXSCache::SetFileName(const std::string& filename)
+{
+  itk::MutexLockHolder<itk::SimpleMutexLock> mutexHolder(m_Mutex);
+  m_FileName = filename;
+  this->LoadFile();
+}
+
+std::string
+SIXSCache::GetFileName()
+{
+  itk::MutexLockHolder<itk::SimpleMutexLock> mutexHolder(m_Mutex);
+  return m_FileName;
+}
+
+void
+SIXSCache::LoadFile()
+{
+  if (m_FileName.empty())
+    {
+    return;
+    }
+
+  std::ifstream ifs(m_FileName.c_str());
+  if (!ifs)
+    {
+    // The file will be created by the first insertion
+    return;
+    }
+
+  std::string line;
+  while (std::getline(ifs, line))
+    {
+    std::istringstream iss(line);
+    std::string key;
+    TermsType terms;
+    iss >> key;
+    for (unsigned int i = 0; i < NumberOfTerms; ++i)
+      {
+      iss >> terms[i];
+      }
+    // Skip truncated lines (e.g. left by an interrupted process)
+    if (!key.empty() && !iss.fail())
+      {
+      m_Map.insert(MapType::value_type(key, terms));
+      }
+    }
+  otbMsgDevMacro(<< "Loaded " << m_Map.size() << " entries from 6S cache file " << m_FileName);
+}
+
+} // namespace otb
@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "otbSIXSLookupTable.h"
+#include "otbSIXSTraits.h"
+#include "otbMacro.h"
+
+#include <algorithm>
+
+namespace otb
+{
+
+SIXSLookupTable::SIXSLookupTable() :
+  m_SolarAzimutalAngle(0.),
+  m_ViewingAzimutalAngle(0.),
+  m_Month(1),
+  m_Day(1),
+  m_AtmosphericPressure(1013.),
+  m_WaterVaporAmount(2.5),
+  m_OzoneAmount(0.28),
+  m_AerosolModel(AtmosphericCorrectionParameters::CONTINENTAL)
+{
+}
+
+void
+SIXSLookupTable::SetSolarZenithalAngleAxis(const AxisType& axis)
+{
+  m_SolarZenithalAngleAxis = axis;
+  m_Table.clear();
+  this->Modified();
+}
+
+void
+SIXSLookupTable::SetViewingZenithalAngleAxis(const AxisType& axis)
+{
+  m_ViewingZenithalAngleAxis = axis;
+  m_Table.clear();
+  this->Modified();
+}
+
+void
+SIXSLookupTable::SetAerosolOpticalAxis(const AxisType& axis)
+{
+  m_AerosolOpticalAxis = axis;
+  m_Table.clear();
+  this->Modified();
+}
+
+void
+SIXSLookupTable::Compute()
+{
+  if (m_WavelengthSpectralBand.IsNull())
+    {
+    itkExceptionMacro(<< "No wavelength spectral band set");
+    }
+  if (m_SolarZenithalAngleAxis.empty() || m_ViewingZenithalAngleAxis.empty() || m_AerosolOpticalAxis.empty())
+    {
+    itkExceptionMacro(<< "Every axis of the lookup table must hold at least one value");
+    }
+
+  m_Table.assign(m_SolarZenithalAngleAxis.size() * m_ViewingZenithalAngleAxis.size() * m_AerosolOpticalAxis.size(),
+                 TermsType(0.));
+
+  for (unsigned int sza = 0; sza < m_SolarZenithalAngleAxis.size(); ++sza)
+    {
+    for (unsigned int vza = 0; vza < m_ViewingZenithalAngleAxis.size(); ++vza)
+      {
+      for (unsigned int aot = 0; aot < m_AerosolOpticalAxis.size(); ++aot)
+        {
+        // SIXSTraits updates the max spectral value of the band it
+        // processes, so each node works on a fresh copy
+        WavelengthSpectralType::Pointer band = WavelengthSpectralType::New();
+        band->SetFilterFunctionValues(m_WavelengthSpectralBand->GetFilterFunctionValues());
+        band->SetMinSpectralValue(m_WavelengthSpectralBand->GetMinSpectralValue());
+        band->SetMaxSpectralValue(m_WavelengthSpectralBand->GetMaxSpectralValue());
+        band->SetUserStep(m_WavelengthSpectralBand->GetUserStep());
+
+        TermsType& terms = m_Table[this->NodeIndex(sza, vza, aot)];
+        SIXSTraits::ComputeAtmosphericParameters(m_SolarZenithalAngleAxis[sza],
+                                                 m_SolarAzimutalAngle,
+                                                 m_ViewingZenithalAngleAxis[vza],
+                                                 m_ViewingAzimutalAngle,
+                                                 m_Month,
+                                                 m_Day,
+                                                 m_AtmosphericPressure,
+                                                 m_WaterVaporAmount,
+                                                 m_OzoneAmount,
+                                                 m_AerosolModel,
+                                                 m_AerosolOpticalAxis[aot],
+                                                 band,
+                                                 terms[0], terms[1], terms[2],
+                                                 terms[3], terms[4], terms[5],
+                                                 terms[6], terms[7], terms[8]);
+        }
+      }
+    }
+  otbMsgDevMacro(<< "6S lookup table computed on " << m_Table.size() << " nodes");
+}
+
+void
+SIXSLookupTable::Locate(const AxisType& axis, double value, unsigned int& index, double& weight)
+{
+  if (axis.size() == 1 || value <= axis.front())
+    {
+    index = 0;
+    weight = 0.;
+    return;
+    }
+  if (value >= axis.back())
+    {
+    index = static_cast<unsigned int>(axis.size() - 2);
+    weight = 1.;
+    return;
+    }
+  AxisType::const_iterator it = std::upper_bound(axis.begin(), axis.end(), value);
+  index = static_cast<unsigned int>(it - axis.begin()) - 1;
+  weight = (value - axis[index]) / (axis[index + 1] - axis[index]);
+}
+
+void
+SIXSLookupTable::Evaluate(double solarZenithalAngle, double viewingZenithalAngle, double aerosolOptical,
+                          TermsType& terms) const
+{
+  if (m_Table.empty())
+    {
+    itkExceptionMacro(<< "The lookup table has not been computed");
+    }
+
+  unsigned int idx[3];
+  double       w[3];
+  Locate(m_SolarZenithalAngleAxis, solarZenithalAngle, idx[0], w[0]);
+  Locate(m_ViewingZenithalAngleAxis, viewingZenithalAngle, idx[1], w[1]);
+  Locate(m_AerosolOpticalAxis, aerosolOptical, idx[2], w[2]);
+
+  terms.Fill(0.);
+  // Accumulate the 8 corners of the cell, degenerated axes (single
+  // node) only contribute their lower corner
+  for (unsigned int corner = 0; corner < 8; ++corner)
+    {
+    double       weight = 1.;
+    unsigned int node[3];
+    for (unsigned int d = 0; d < 3; ++d)
+      {
+      const bool upper = (corner >> d) & 1;
+      weight *= upper ? w[d] : 1. - w[d];
+      node[d] = idx[d] + (upper ? 1 : 0);
+      }
+    if (weight == 0.)
+      {
+      continue;
+      }
+    const TermsType& nodeTerms = m_Table[this->NodeIndex(node[0], node[1], node[2])];
+    for (unsigned int i = 0; i < SIXSCache::NumberOfTerms; ++i)
+      {
+      terms[i] += weight * nodeTerms[i];
+      }
+    }
+}
+
+void
+SIXSLookupTable::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Solar azimutal angle: " << m_SolarAzimutalAngle << std::endl;
+  os << indent << "Viewing azimutal angle: " << m_ViewingAzimutalAngle << std::endl;
+  os << indent << "Month: " << m_Month << std::endl;
+  os << indent << "Day: " << m_Day << std::endl;
+  os << indent << "Atmospheric pressure: " << m_AtmosphericPressure << std::endl;
+  os << indent << "Water vapor amount: " << m_WaterVaporAmount << std::endl;
+  os << indent << "Ozone amount: " << m_OzoneAmount << std::endl;
+  os << indent << "Aerosol model: " << m_AerosolModel << std::endl;
+  os << indent << "Grid size: " << m_SolarZenithalAngleAxis.size() << " x "
+     << m_ViewingZenithalAngleAxis.size() << " x " << m_AerosolOpticalAxis.size() << std::endl;
+  os << indent << "Computed: " << (m_Table.empty() ? "no" : "yes") << std::endl;
+}
+
+} // namespace otb
@@ -19,6 +19,7 @@
  */
 
 #include "otbSIXSTraits.h"
+#include "otbSIXSCache.h"
 
 #include "otb_6S.h"
 #include "main_6s.h"
@@ -90,6 +91,30 @@ SIXSTraits::ComputeAtmosphericParameters(
   ComputeWavelengthSpectralBandValuesFor6S(SIXSStepOfWavelengthSpectralBandValues,
                                            WavelengthSpectralBand        // Update
                                            );
+  // Identical 6S runs are served by the cache
+  SIXSCache * cache = SIXSCache::GetInstance();
+  const std::string cacheKey = SIXSCache::GenerateKey(SolarZenithalAngle, SolarAzimutalAngle,
+                                                      ViewingZenithalAngle, ViewingAzimutalAngle,
+                                                      Month, Day,
+                                                      AtmosphericPressure, WaterVaporAmount, OzoneAmount,
+                                                      AerosolModel, AerosolOptical,
+                                                      WavelengthSpectralBand);
+  SIXSCache::TermsType terms;
+  if (cache->Find(cacheKey, terms))
+    {
+    otbMsgDevMacro(<< "6S radiative terms found in cache");
+    AtmosphericReflectance = terms[0];
+    AtmosphericSphericalAlbedo = terms[1];
+    TotalGaseousTransmission = terms[2];
+    DownwardTransmittance = terms[3];
+    UpwardTransmittance = terms[4];
+    UpwardDiffuseTransmittance = terms[5];
+    UpwardDirectTransmittance = terms[6];
+    UpwardDiffuseTransmittanceForRayleigh = terms[7];
+    UpwardDiffuseTransmittanceForAerosol = terms[8];
+    return;
+    }
+
   try
     {
 
@@ -148,6 +173,17 @@ SIXSTraits::ComputeAtmosphericParameters(
   UpwardDirectTransmittance = static_cast<double>(tdir_up);
   UpwardDiffuseTransmittanceForRayleigh = static_cast<double>(tdif_up_ray);
   UpwardDiffuseTransmittanceForAerosol = static_cast<double>(tdif_up_aer);
+
+  terms[0] = AtmosphericReflectance;
+  terms[1] = AtmosphericSphericalAlbedo;
+  terms[2] = TotalGaseousTransmission;
+  terms[3] = DownwardTransmittance;
+  terms[4] = UpwardTransmittance;
+  terms[5] = UpwardDiffuseTransmittance;
+  terms[6] = UpwardDirectTransmittance;
+  terms[7] = UpwardDiffuseTransmittanceForRayleigh;
+  terms[8] = UpwardDiffuseTransmittanceForAerosol;
+  cache->Insert(cacheKey, terms);
 }
 
 void
@@ -59,6 +59,8 @@ void RegisterTests()
   REGISTER_TEST(otbAtmosphericCorrectionSequencementTest);
   REGISTER_TEST(otbSIXSTraitsTest);
   REGISTER_TEST(otbSIXSTraitsComputeAtmosphericParametersTest);
+  REGISTER_TEST(otbSIXSCacheTest);
+  REGISTER_TEST(otbSIXSLookupTableTest);
   REGISTER_TEST(otbReflectanceToImageImageFilterNew);
   REGISTER_TEST(otbSurfaceAdjacencyEffectCorrectionSchemeFilter);
   REGISTER_TEST(otbLuminanceToImageImageFilter);
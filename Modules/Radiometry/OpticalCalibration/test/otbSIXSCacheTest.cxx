@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "otbSIXSTraits.h"
+#include "otbSIXSCache.h"
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cstdio>
+
+int otbSIXSCacheTest(int itkNotUsed(argc), char * argv[])
+{
+  const char * inname   = argv[1];
+  const char * cachename  = argv[2];
+
+  typedef otb::AtmosphericCorrectionParameters AtmosphericCorrectionParametersType;
+  typedef AtmosphericCorrectionParametersType::AerosolModelType AerosolModelType;
+  typedef otb::FilterFunctionValues FilterFunctionValuesType;
+  FilterFunctionValuesType::ValuesVectorType vect;
+
+  double       SolarZenithalAngle(0.);
+  double       SolarAzimutalAngle(0.);
+  double       ViewingZenithalAngle(0.);
+  double       ViewingAzimutalAngle(0.);
+  unsigned int Month(0);
+  unsigned int Day(0);
+  double       AtmosphericPressure(0.);
+  double       WaterVaporAmount(0.);
+  double       OzoneAmount(0.);
+  unsigned int aer(0);
+  double       AerosolOptical(0.);
+  float        MinSpectralValue(0.);
+  float        MaxSpectralValue(0.);
+
+  std::ifstream fin(inname);
+  fin >> SolarZenithalAngle >> SolarAzimutalAngle >> ViewingZenithalAngle >> ViewingAzimutalAngle;
+  fin >> Month >> Day;
+  fin >> AtmosphericPressure >> WaterVaporAmount >> OzoneAmount;
+  fin >> aer >> AerosolOptical;
+  fin >> MinSpectralValue >> MaxSpectralValue;
+  std::string line;
+  std::getline(fin, line);
+  while (std::getline(fin, line))
+    {
+    vect.push_back(atof(line.c_str()));
+    }
+  fin.close();
+
+  // Start from an empty cache file
+  std::remove(cachename);
+  otb::SIXSCache * cache = otb::SIXSCache::GetInstance();
+  cache->SetFileName(cachename);
+  cache->Clear();
+
+  otb::SIXSCache::TermsType terms[2];
+  for (unsigned int run = 0; run < 2; ++run)
+    {
+    FilterFunctionValuesType::Pointer functionValues = FilterFunctionValuesType::New();
+    functionValues->SetFilterFunctionValues(vect);
+    functionValues->SetMinSpectralValue(MinSpectralValue);
+    functionValues->SetMaxSpectralValue(MaxSpectralValue);
+    functionValues->SetUserStep(.0025);
+
+    otb::SIXSTraits::ComputeAtmosphericParameters(
+      SolarZenithalAngle, SolarAzimutalAngle, ViewingZenithalAngle, ViewingAzimutalAngle,
+      Month, Day, AtmosphericPressure, WaterVaporAmount, OzoneAmount,
+      static_cast<AerosolModelType>(aer), AerosolOptical, functionValues,
+      terms[run][0], terms[run][1], terms[run][2], terms[run][3], terms[run][4],
+      terms[run][5], terms[run][6], terms[run][7], terms[run][8]);
+    }
+
+  if (cache->GetNumberOfEntries() != 1)
+    {
+    std::cerr << "Expected 1 cache entry, got " << cache->GetNumberOfEntries() << std::endl;
+    return EXIT_FAILURE;
+    }
+  if (terms[0] != terms[1])
+    {
+    std::cerr << "Cached terms " << terms[1] << " differ from computed terms " << terms[0] << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // Entries must survive a reload from disk
+  cache->Clear();
+  cache->SetFileName(cachename);
+  if (cache->GetNumberOfEntries() != 1)
+    {
+    std::cerr << "Expected 1 entry after reloading " << cachename << ", got "
+              << cache->GetNumberOfEntries() << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  FilterFunctionValuesType::Pointer functionValues = FilterFunctionValuesType::New();
+  functionValues->SetFilterFunctionValues(vect);
+  functionValues->SetMinSpectralValue(MinSpectralValue);
+  functionValues->SetMaxSpectralValue(MaxSpectralValue);
+  functionValues->SetUserStep(.0025);
+  otb::SIXSTraits::ComputeWavelengthSpectralBandValuesFor6S(.0025, functionValues);
+
+  otb::SIXSCache::TermsType reloaded;
+  const std::string key = otb::SIXSCache::GenerateKey(
+    SolarZenithalAngle, SolarAzimutalAngle, ViewingZenithalAngle, ViewingAzimutalAngle,
+    Month, Day, AtmosphericPressure, WaterVaporAmount, OzoneAmount,
+    static_cast<AerosolModelType>(aer), AerosolOptical, functionValues);
+  if (!cache->Find(key, reloaded) || reloaded != terms[0])
+    {
+    std::cerr << "Entry not found or altered after reloading " << cachename << std::endl;
+    return EXIT_FAILURE;
+    }
+
+  cache->SetFileName("");
+  cache->Clear();
+  return EXIT_SUCCESS;
+}
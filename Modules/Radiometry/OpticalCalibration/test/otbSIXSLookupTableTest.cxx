@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "otbSIXSLookupTable.h"
+#include "otbSIXSTraits.h"
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <algorithm>
+
+int otbSIXSLookupTableTest(int itkNotUsed(argc), char * argv[])
+{
+  const char * inname   = argv[1];
+
+  typedef otb::AtmosphericCorrectionParameters AtmosphericCorrectionParametersType;
+  typedef AtmosphericCorrectionParametersType::AerosolModelType AerosolModelType;
+  typedef otb::FilterFunctionValues FilterFunctionValuesType;
+  typedef otb::SIXSLookupTable      LookupTableType;
+  FilterFunctionValuesType::ValuesVectorType vect;
+
+  double       SolarZenithalAngle(0.);
+  double       SolarAzimutalAngle(0.);
+  double       ViewingZenithalAngle(0.);
+  double       ViewingAzimutalAngle(0.);
+  unsigned int Month(0);
+  unsigned int Day(0);
+  double       AtmosphericPressure(0.);
+  double       WaterVaporAmount(0.);
+  double       OzoneAmount(0.);
+  unsigned int aer(0);
+  double       AerosolOptical(0.);
+  float        MinSpectralValue(0.);
+  float        MaxSpectralValue(0.);
+
+  std::ifstream fin(inname);
+  fin >> SolarZenithalAngle >> SolarAzimutalAngle >> ViewingZenithalAngle >> ViewingAzimutalAngle;
+  fin >> Month >> Day;
+  fin >> AtmosphericPressure >> WaterVaporAmount >> OzoneAmount;
+  fin >> aer >> AerosolOptical;
+  fin >> MinSpectralValue >> MaxSpectralValue;
+  std::string line;
+  std::getline(fin, line);
+  while (std::getline(fin, line))
+    {
+    vect.push_back(atof(line.c_str()));
+    }
+  fin.close();
+
+  FilterFunctionValuesType::Pointer functionValues = FilterFunctionValuesType::New();
+  functionValues->SetFilterFunctionValues(vect);
+  functionValues->SetMinSpectralValue(MinSpectralValue);
+  functionValues->SetMaxSpectralValue(MaxSpectralValue);
+  functionValues->SetUserStep(.0025);
+
+  LookupTableType::Pointer table = LookupTableType::New();
+  table->SetSolarAzimutalAngle(SolarAzimutalAngle);
+  table->SetViewingAzimutalAngle(ViewingAzimutalAngle);
+  table->SetMonth(Month);
+  table->SetDay(Day);
+  table->SetAtmosphericPressure(AtmosphericPressure);
+  table->SetWaterVaporAmount(WaterVaporAmount);
+  table->SetOzoneAmount(OzoneAmount);
+  table->SetAerosolModel(static_cast<AerosolModelType>(aer));
+  table->SetWavelengthSpectralBand(functionValues);
+
+  // Grid nodes surrounding the reference parameters
+  LookupTableType::AxisType sza, vza, aot;
+  sza.push_back(SolarZenithalAngle - 5.);
+  sza.push_back(SolarZenithalAngle);
+  sza.push_back(SolarZenithalAngle + 5.);
+  vza.push_back(ViewingZenithalAngle);
+  aot.push_back(0.5 * AerosolOptical);
+  aot.push_back(AerosolOptical);
+  aot.push_back(2. * AerosolOptical);
+  table->SetSolarZenithalAngleAxis(sza);
+  table->SetViewingZenithalAngleAxis(vza);
+  table->SetAerosolOpticalAxis(aot);
+  table->Compute();
+
+  std::cout << table << std::endl;
+
+  // On a node, the table must give back the 6S terms
+  LookupTableType::TermsType expected, interpolated;
+  otb::SIXSTraits::ComputeAtmosphericParameters(
+    SolarZenithalAngle, SolarAzimutalAngle, ViewingZenithalAngle, ViewingAzimutalAngle,
+    Month, Day, AtmosphericPressure, WaterVaporAmount, OzoneAmount,
+    static_cast<AerosolModelType>(aer), AerosolOptical, functionValues,
+    expected[0], expected[1], expected[2], expected[3], expected[4],
+    expected[5], expected[6], expected[7], expected[8]);
+
+  table->Evaluate(SolarZenithalAngle, ViewingZenithalAngle, AerosolOptical, interpolated);
+  for (unsigned int i = 0; i < otb::SIXSCache::NumberOfTerms; ++i)
+    {
+    if (vcl_abs(interpolated[i] - expected[i]) > 1e-9)
+      {
+      std::cerr << "Term " << i << " : interpolated " << interpolated[i] << " expected " << expected[i] << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  // Between nodes, the terms must stay within the node values
+  LookupTableType::TermsType lower, upper;
+  table->Evaluate(SolarZenithalAngle, ViewingZenithalAngle, 0.5 * AerosolOptical, lower);
+  table->Evaluate(SolarZenithalAngle, ViewingZenithalAngle, 0.75 * AerosolOptical, interpolated);
+  upper = expected;
+  for (unsigned int i = 0; i < otb::SIXSCache::NumberOfTerms; ++i)
+    {
+    const double lo = std::min(lower[i], upper[i]) - 1e-9;
+    const double hi = std::max(lower[i], upper[i]) + 1e-9;
+    if (interpolated[i] < lo || interpolated[i] > hi)
+      {
+      std::cerr << "Term " << i << " : interpolated " << interpolated[i] << " out of ["
+                << lo << ", " << hi << "]" << std::endl;
+      return EXIT_FAILURE;
+      }
+    }
+
+  return EXIT_SUCCESS;
+}
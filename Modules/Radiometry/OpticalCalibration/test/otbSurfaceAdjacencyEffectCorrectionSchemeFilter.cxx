@@ -29,7 +29,7 @@
 #include <fstream>
 #include <iostream>
 
-int otbSurfaceAdjacencyEffectCorrectionSchemeFilter(int itkNotUsed(argc), char * argv[])
+int otbSurfaceAdjacencyEffectCorrectionSchemeFilter(int argc, char * argv[])
 {
   const char * inputFileName  = argv[1];
   const char * outputFileName = argv[2];
@@ -169,6 +169,11 @@ int otbSurfaceAdjacencyEffectCorrectionSchemeFilter(int itkNotUsed(argc), char *
   filter->SetWindowRadius(atoi(argv[3]));
   filter->SetPixelSpacingInKilometers(static_cast<double>(atof(argv[4])));
   filter->SetZenithalViewingAngle(paramAcqui->GetViewingZenithalAngle());
+  // Optional: compute the neighborhood contribution in the Fourier domain
+  if (argc > 6 + static_cast<int>(nbChannel) + 1)
+    {
+    filter->SetUseFFT(atoi(argv[6 + nbChannel + 1]) != 0);
+    }
 
   filter->SetInput(reader->GetOutput());
   writer->SetInput(filter->GetOutput());
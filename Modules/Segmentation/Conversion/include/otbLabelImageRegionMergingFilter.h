@@ -24,6 +24,7 @@
 #include "otbImage.h"
 #include "otbVectorImage.h"
 #include "itkImageToImageFilter.h"
+#include "otbRegionAdjacencyGraph.h"
 
 #include <set>
 
@@ -36,6 +37,9 @@ namespace otb
  * This class merges regions in the input label image according to the input
  * image of spectral values and the RangeBandwidth parameter.
  *
+ * The adjacency of the regions is built once, in a RegionAdjacencyGraph,
+ * and the merges of each iteration are applied to the graph.
+ *
  *
  * \ingroup ImageSegmentation
  *
@@ -91,6 +95,12 @@ public:
   typedef std::set<LabelType> AdjacentLabelsContainerType;
   typedef std::vector<AdjacentLabelsContainerType> RegionAdjacencyMapType;
 
+  /** Typedefs for the region adjacency graph */
+  typedef RegionAdjacencyGraph<LabelType>                      RegionAdjacencyGraphType;
+  typedef typename RegionAdjacencyGraphType::LabelVectorType     LabelVectorType;
+  typedef typename RegionAdjacencyGraphType::LabelPairType       LabelPairType;
+  typedef typename RegionAdjacencyGraphType::LabelPairVectorType LabelPairVectorType;
+
 
   /** Setters / Getters */
   itkSetMacro(RangeBandwidth, RealType);
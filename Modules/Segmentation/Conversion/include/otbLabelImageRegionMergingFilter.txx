@@ -183,241 +183,151 @@ LabelImageRegionMergingFilter<TInputLabelImage, TInputSpectralImage, TOutputLabe
 
   m_NumberOfComponentsPerPixel = spectralImage->GetNumberOfComponentsPerPixel();
 
-  //std::cout << "Copy input label image to output label image" << std::endl;
-  // Copy input label image to output label image
-  typename itk::ImageRegionConstIterator<InputLabelImageType> inputIt(inputLabelImage, outputLabelImage->GetRequestedRegion());
-  typename itk::ImageRegionIterator<OutputLabelImageType> outputIt(outputLabelImage, outputLabelImage->GetRequestedRegion());
-  inputIt.GoToBegin();
-  outputIt.GoToBegin();
-  while(!inputIt.IsAtEnd())
-    {
-    outputIt.Set(inputIt.Get());
-    ++inputIt;
-    ++outputIt;
-    }
+  const RegionType & region = outputLabelImage->GetRequestedRegion();
 
-  RegionAdjacencyMapType regionAdjacencyMap = LabelImageToRegionAdjacencyMap(outputLabelImage);
-  unsigned int regionCount = regionAdjacencyMap.size() - 1;
-
-  // Initialize arrays for mode information
-  m_CanonicalLabels.clear();
-  m_CanonicalLabels.resize(regionCount+1);
-
-  m_Modes.clear();
-  m_Modes.reserve(regionCount+1);
-  for(unsigned int i = 0; i < regionCount+1; ++i)
+  // Find the maximum label value
+  itk::ImageRegionConstIterator<InputLabelImageType> inputIt(inputLabelImage, region);
+  LabelType maxLabel = 0;
+  for (inputIt.GoToBegin(); !inputIt.IsAtEnd(); ++inputIt)
     {
-    m_Modes.push_back( SpectralPixelType(m_NumberOfComponentsPerPixel) );
+    maxLabel = vcl_max(maxLabel, inputIt.Get());
     }
-
-  m_PointCounts.clear();
-  m_PointCounts.resize(regionCount+1); // = std::vector<unsigned int>(regionCount+1);
-
-
-  // Associate each label to a spectral value, a canonical label and a point count
-  typename itk::ImageRegionConstIterator<InputLabelImageType> inputItWithIndex(inputLabelImage, outputLabelImage->GetRequestedRegion());
-  inputItWithIndex.GoToBegin();
-  while(!inputItWithIndex.IsAtEnd())
+  const LabelType nbLabels = maxLabel + 1;
+
+  // Associate each label to a spectral value (the one of its first
+  // pixel) and a point count
+  m_Modes.assign(nbLabels, SpectralPixelType(m_NumberOfComponentsPerPixel));
+  m_PointCounts.assign(nbLabels, 0);
+  itk::ImageRegionConstIterator<InputSpectralImageType> spectralIt(spectralImage, region);
+  for (inputIt.GoToBegin(), spectralIt.GoToBegin(); !inputIt.IsAtEnd(); ++inputIt, ++spectralIt)
     {
-    LabelType label = inputItWithIndex.Get();
+    LabelType label = inputIt.Get();
     // if label has not been initialized yet ..
     if(m_PointCounts[label] == 0)
       {
-     // m_CanonicalLabels[label] = label;
-      m_Modes[label] = spectralImage->GetPixel(inputItWithIndex.GetIndex());
+      m_Modes[label] = spectralIt.Get();
       }
     m_PointCounts[label]++;
-    ++inputItWithIndex;
     }
-  // Region Merging
 
-  bool finishedMerging = false;
-  unsigned int mergeIterations = 0;
+  // Build the region adjacency graph once: the merges are then applied
+  // to the graph, without scanning the label image again. As before, the
+  // adjacencies are searched in the region without bottom and right
+  // borders, so the last row and column only count as neighbors.
+  RegionType regionWithoutBottomRightBorders = region;
+  SizeType size = regionWithoutBottomRightBorders.GetSize();
+  for(unsigned int d = 0; d < ImageDimension; ++d) size[d] -= 1;
+  regionWithoutBottomRightBorders.SetSize(size);
 
-  //std::cout << "Start merging" << std::endl;
-  // Iterate until no more merge to do
- // while(!finishedMerging)
- //   {
-    while(!finishedMerging)
+  RegionAdjacencyGraphType graph;
+  graph.Initialize(nbLabels, m_NumberOfComponentsPerPixel);
+  graph.AddAdjacencies(inputLabelImage.GetPointer(), regionWithoutBottomRightBorders);
+  graph.BuildAdjacency();
+  for (LabelType label = 0; label < nbLabels; ++label)
+    {
+    if (m_PointCounts[label] > 0)
       {
+      graph.AddPixels(label, m_Modes[label], m_PointCounts[label]);
+      }
+    }
 
-      // Initialize Canonical Labels
-      for(LabelType curLabel = 1; curLabel <= regionCount; ++curLabel)
-        m_CanonicalLabels[curLabel] = curLabel;
+  LabelVectorType     neighbors;
+  LabelPairVectorType mergedRegions;
 
-    // Iterate over all regions
+  // Region Merging
+  bool finishedMerging = false;
+  unsigned int mergeIterations = 0;
 
-      for(LabelType curLabel = 1; curLabel <= regionCount; ++curLabel)
+  // Iterate until no more merge to do
+  while(!finishedMerging)
+    {
+    // Find the similar adjacent regions, with the modes of the
+    // beginning of the iteration
+    mergedRegions.clear();
+    for(LabelType curLabel = 1; curLabel < nbLabels; ++curLabel)
       {
-
-      if(m_PointCounts[curLabel] == 0)
+      if(!graph.IsRegion(curLabel) || graph.GetSize(curLabel) == 0)
         {
-        // do not process empty regions
+        // do not process empty or merged regions
         continue;
         }
-     // std::cout<<" point in label "<<curLabel<<" "<<m_PointCounts[curLabel]<<std::endl;
-      const SpectralPixelType & curSpectral = m_Modes[curLabel];
 
       // Iterate over all adjacent regions and check for merge
-      typename AdjacentLabelsContainerType::const_iterator adjIt = regionAdjacencyMap[curLabel].begin();
-      while (adjIt != regionAdjacencyMap[curLabel].end())
+      graph.GetAdjacentRegions(curLabel, neighbors);
+      for(typename LabelVectorType::const_iterator adjIt = neighbors.begin(); adjIt != neighbors.end(); ++adjIt)
         {
         LabelType adjLabel = *adjIt;
-        assert(adjLabel <= regionCount);
-        const SpectralPixelType & adjSpectral = m_Modes[adjLabel];
+        if(adjLabel != 0 && adjLabel < curLabel)
+          {
+          // the similarity is symmetric, this pair has already been checked
+          continue;
+          }
+
         // Check condition to merge regions
-        bool isSimilar = true;
         RealType norm2 = 0;
-         for(unsigned int comp = 0; comp < m_NumberOfComponentsPerPixel; ++comp)
+        for(unsigned int comp = 0; comp < m_NumberOfComponentsPerPixel; ++comp)
           {
           RealType e;
-          e = (curSpectral[comp] - adjSpectral[comp]) / m_RangeBandwidth;
+          e = (graph.GetMean(curLabel, comp) - graph.GetMean(adjLabel, comp)) / m_RangeBandwidth;
           norm2 += e*e;
           }
-        isSimilar = norm2 < 0.25;
 
-        if(isSimilar)
+        if(norm2 < 0.25)
           {
-          // Find canonical label for current region
-          LabelType curCanLabel = curLabel; //m_CanonicalLabels[curLabel];
-          while(m_CanonicalLabels[curCanLabel] != curCanLabel)
-            {
-            curCanLabel = m_CanonicalLabels[curCanLabel];
-            }
-
-          // Find canonical label for adjacent region
-          LabelType adjCanLabel = adjLabel; //m_CanonicalLabels[curLabel];
-          while(m_CanonicalLabels[adjCanLabel] != adjCanLabel)
-            {
-            adjCanLabel = m_CanonicalLabels[adjCanLabel];
-            }
-
-          // Assign same canonical label to both regions
-          if(curCanLabel < adjCanLabel)
-            {
-            m_CanonicalLabels[adjCanLabel] = curCanLabel;
-            }
-          else
-            {
-            m_CanonicalLabels[m_CanonicalLabels[curCanLabel]] = adjCanLabel;
-            m_CanonicalLabels[curCanLabel] = adjCanLabel;
-            }
+          mergedRegions.push_back(LabelPairType(curLabel, adjLabel));
           }
-        ++adjIt;
         } // end of loop over adjacent labels
       } // end of loop over labels
 
-    //std::cout << "Simplify the table of canonical labels" << std::endl;
-    /* Simplify the table of canonical labels */
-    for(LabelType i = 1; i < regionCount+1; ++i)
+    // Merge the regions, the modes and point counts are updated by the graph
+    for(typename LabelPairVectorType::const_iterator it = mergedRegions.begin(); it != mergedRegions.end(); ++it)
       {
-      LabelType can = i;
-      while(m_CanonicalLabels[can] != can)
-        {
-        can = m_CanonicalLabels[can];
-        }
-      m_CanonicalLabels[i] = can;
+      graph.Merge(it->first, it->second);
       }
 
-    //std::cout << "merge regions with same canonical label" << std::endl;
-    /* Merge regions with same canonical label */
-    /* - update modes and point counts */
-    std::vector<SpectralPixelType> newModes;
-    newModes.reserve(regionCount+1); //(regionCount+1, SpectralPixelType(m_NumberOfComponentsPerPixel));
-    for(unsigned int i = 0; i < regionCount+1; ++i)
-      {
-      newModes.push_back( SpectralPixelType(m_NumberOfComponentsPerPixel) );
-      }
-    std::vector<unsigned int> newPointCounts(regionCount+1);
+    // the label 0 is not counted as a region
+    const LabelType regionCount = graph.GetNumberOfRemainingRegions() - 1;
 
-    for(unsigned int i = 1; i < regionCount+1; ++i)
-      {
-      newModes[i].Fill(0);
-      newPointCounts[i] = 0;
-      }
+    finishedMerging = mergedRegions.empty() || mergeIterations >= 10 || regionCount <= 1;
 
-    for(unsigned int i = 1; i < regionCount+1; ++i)
+    mergeIterations++;
+    } // end of main iteration loop
+
+  // Label the regions consecutively, in the order of their smallest
+  // label, and compute their modes and point counts
+  LabelVectorType newLabels(nbLabels, 0);
+  LabelType label = 0;
+  for (LabelType l = 1; l < nbLabels; ++l)
+    {
+    const LabelType canLabel = graph.GetRegion(l);
+    if (newLabels[canLabel] == 0)
       {
-      LabelType canLabel = m_CanonicalLabels[i];
-      unsigned int nPoints = m_PointCounts[i];
+      newLabels[canLabel] = ++label;
       for(unsigned int comp = 0; comp < m_NumberOfComponentsPerPixel; ++comp)
         {
-        newModes[canLabel][comp] += nPoints * m_Modes[i][comp];
+        m_Modes[label][comp] = graph.GetMean(canLabel, comp);
         }
-      newPointCounts[canLabel] += nPoints;
-      }
-
-    //std::cout << "re-labeling" << std::endl;
-    /* re-labeling */
-    std::vector<LabelType> newLabels(regionCount+1);
-    std::vector<bool> newLabelSet(regionCount+1);
-    for(unsigned int i = 1; i < regionCount+1; ++i)
-      {
-      newLabelSet[i] = false;
-      }
-
-    LabelType label = 0;
-    for(unsigned int i = 1; i < regionCount+1; ++i)
-      {
-      LabelType canLabel = m_CanonicalLabels[i];
-      if(newLabelSet[canLabel] == false)
-        {
-        newLabelSet[canLabel] = true;
-        label++;
-        newLabels[canLabel] = label;
-        unsigned int nPoints = newPointCounts[canLabel];
-        for(unsigned int comp = 0; comp < m_NumberOfComponentsPerPixel; ++comp)
-          {
-          m_Modes[label][comp] = newModes[canLabel][comp] / nPoints;
-          }
-
-        m_PointCounts[label] = newPointCounts[canLabel];
-        }
-      }
-
-    unsigned int oldRegionCount = regionCount;
-    regionCount = label;
-
-    /* reassign labels in label image */
-    outputIt.GoToBegin();
-    while(!outputIt.IsAtEnd())
-      {
-
-      LabelType l = outputIt.Get();
-      LabelType canLabel;
-      assert(m_CanonicalLabels[l] <= oldRegionCount);
-      canLabel = newLabels[m_CanonicalLabels[l]];
-      outputIt.Set( canLabel );
-
-      ++outputIt;
-      }
-
-    finishedMerging = oldRegionCount == regionCount || mergeIterations >= 10 || regionCount == 1;
-
-    // only one iteration for now
-
-    if(!finishedMerging)
-      {
-      /* Update adjacency table */
-      regionAdjacencyMap = LabelImageToRegionAdjacencyMap(outputLabelImage);
+      m_PointCounts[label] = graph.GetSize(canLabel);
       }
+    }
 
-    mergeIterations++;
-    } // end of main iteration loop
-  // std::cout << "merge iterations: " << mergeIterations << std::endl;
-  // std::cout << "number of label objects: " << regionCount << std::endl;
+  // Table of the output label of each input label
+  m_CanonicalLabels.resize(nbLabels);
+  for (LabelType l = 0; l < nbLabels; ++l)
+    {
+    m_CanonicalLabels[l] = newLabels[graph.GetRegion(l)];
+    }
 
-  // Generate clustered output
+  // Generate the label and clustered outputs
+  itk::ImageRegionIterator<OutputLabelImageType> outputIt(outputLabelImage, region);
   itk::ImageRegionIterator<OutputClusteredImageType> outputClusteredIt(outputClusteredImage, outputClusteredImage->GetRequestedRegion() );
-  outputClusteredIt.GoToBegin();
-  outputIt.GoToBegin();
-  while( !outputClusteredIt.IsAtEnd() )
+  for (inputIt.GoToBegin(), outputIt.GoToBegin(), outputClusteredIt.GoToBegin();
+       !inputIt.IsAtEnd();
+       ++inputIt, ++outputIt, ++outputClusteredIt)
     {
-    LabelType label = outputIt.Get();
-    const SpectralPixelType & p = m_Modes[ label ];
-    outputClusteredIt.Set(p);
-    ++outputClusteredIt;
-    ++outputIt;
+    const LabelType outputLabel = m_CanonicalLabels[inputIt.Get()];
+    outputIt.Set(outputLabel);
+    outputClusteredIt.Set(m_Modes[outputLabel]);
     }
 }
 
@@ -24,6 +24,7 @@
 #include "otbImage.h"
 #include "otbVectorImage.h"
 #include "itkImageToImageFilter.h"
+#include "otbRegionAdjacencyGraph.h"
 #include "itkNumericTraits.h"
 
 #include <set>
@@ -37,6 +38,11 @@ namespace otb
  * This class merges regions in the input label image according to the input
  * image of spectral values and the RangeBandwidth parameter.
  *
+ * Each region smaller than MinRegionSize is merged with its spectrally
+ * nearest neighbor. The adjacency of the regions is built once, in a
+ * RegionAdjacencyGraph, and the merges of each iteration are applied to
+ * the graph.
+ *
  *
  * \ingroup ImageSegmentation
  *
@@ -92,6 +98,12 @@ public:
   typedef std::set<LabelType> AdjacentLabelsContainerType;
   typedef std::vector<AdjacentLabelsContainerType> RegionAdjacencyMapType;
 
+  /** Typedefs for the region adjacency graph */
+  typedef RegionAdjacencyGraph<LabelType>                      RegionAdjacencyGraphType;
+  typedef typename RegionAdjacencyGraphType::LabelVectorType     LabelVectorType;
+  typedef typename RegionAdjacencyGraphType::LabelPairType       LabelPairType;
+  typedef typename RegionAdjacencyGraphType::LabelPairVectorType LabelPairVectorType;
+
   itkSetMacro(MinRegionSize, RealType);
   itkGetConstMacro(MinRegionSize, RealType);
 
@@ -118,6 +118,10 @@ public:
    * if they have an associated filename.
    * This is a helper function for wrappers without pipeline support.
    *
+   * When there are several output images, they are written within a
+   * single streaming loop (see MultiImageFileWriter), so that their
+   * common upstream filters are computed only once.
+   *
    * Returns 0 on success, or a non-null integer on error
    */
   int ExecuteAndWriteOutput();
@@ -534,6 +538,21 @@ public:
    */
   FloatVectorImageType* GetParameterImage(std::string parameter);
 
+  /* Get the pixel type stored on disk for an input image
+   *
+   * Can be called for types :
+   * \li ParameterType_InputImage
+   */
+  ImagePixelType GetParameterImageNativePixelType(std::string parameter);
+
+  /* Get an image value as a VectorImage of its native pixel type
+   * (see GetParameterImageNativePixelType)
+   *
+   * Can be called for types :
+   * \li ParameterType_InputImage
+   */
+  InputImageParameter::ImageBaseType* GetParameterNativeVectorImage(std::string parameter);
+
 #define otbGetParameterImageMacro( Image )                              \
   Image##Type * GetParameter##Image( std::string parameter )            \
     {                                                                   \
@@ -598,6 +617,22 @@ public:
    */
   FloatVectorImageListType* GetParameterImageList(std::string parameter);
 
+  /* Get the pixel type stored on disk shared by all the images of an
+   * image list, float if they differ
+   *
+   * Can be called for types :
+   * \li ParameterType_InputImageList
+   */
+  ImagePixelType GetParameterImageListNativePixelType(std::string parameter);
+
+  /* Get one image of an image list as a VectorImage of its native pixel
+   * type (see GetParameterImageListNativePixelType)
+   *
+   * Can be called for types :
+   * \li ParameterType_InputImageList
+   */
+  InputImageParameter::ImageBaseType* GetParameterNthNativeVectorImage(std::string parameter, unsigned int i);
+
   /* Get a complex image value
    *
    * Can be called for types :
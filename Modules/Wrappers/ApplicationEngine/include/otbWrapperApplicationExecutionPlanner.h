@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbWrapperApplicationExecutionPlanner_h
+#define otbWrapperApplicationExecutionPlanner_h
+
+#include "otbWrapperApplication.h"
+#include "otbWrapperInputImageParameter.h"
+#include "otbMultiImageFileWriter.h"
+
+#include <map>
+#include <vector>
+
+namespace otb
+{
+namespace Wrapper
+{
+
+/** \class ApplicationExecutionPlanner
+ *  \brief Execute a graph of in-memory connected applications at once
+ *
+ * Applications are added to the planner with an identifier, and their
+ * images are connected with Connect("app1.out", "app2.in"), which
+ * replaces the calls to SetParameterInputImage(). The other parameters
+ * (including the output filenames) are set on the applications
+ * themselves.
+ *
+ * ExecuteAndWriteOutputs() then:
+ * - sorts the applications so that each one is executed after the
+ *   applications it depends on,
+ * - opens a single reader for the input images used by several
+ *   applications with the same filename,
+ * - executes the applications, connecting their images on the fly,
+ * - writes every output image of the graph with a MultiImageFileWriter:
+ *   the number of stream divisions is computed once from the memory
+ *   print of the whole graph, and each division of each output is
+ *   computed within the same streaming loop.
+ *
+ * Outputs that are not images (vector data, complex images) are
+ * written after the streaming loop, in the usual way.
+ *
+ * \ingroup OTBApplicationEngine
+ */
+class OTBApplicationEngine_EXPORT ApplicationExecutionPlanner : public itk::Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef ApplicationExecutionPlanner   Self;
+  typedef itk::Object                   Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Defining ::New() static method */
+  itkNewMacro(Self);
+
+  /** RTTI support */
+  itkTypeMacro(ApplicationExecutionPlanner, itk::Object);
+
+  /** Add an application to the graph, with the given identifier */
+  void AddApplication(Application* app, const std::string & id);
+
+  /** Get the application with the given identifier */
+  Application* GetApplication(const std::string & id) const;
+
+  /** Connect the output image "fromKey" of an application to the input
+   * image "toKey" of another one. Keys are prefixed by the application
+   * identifier, for instance Connect("cal.out", "ortho.io.in") */
+  void Connect(const std::string & fromKey, const std::string & toKey);
+
+  /** Set/Get the RAM (in MB) for the whole graph. If 0, the smallest
+   * RAM parameter of the applications is used, and if none has one, the
+   * value from the configuration. */
+  itkSetMacro(AvailableRAM, unsigned int);
+  itkGetConstMacro(AvailableRAM, unsigned int);
+
+  /** Set/Get whether input images with the same filename share their
+   * reader (default is true) */
+  itkSetMacro(ShareReaders, bool);
+  itkGetConstMacro(ShareReaders, bool);
+  itkBooleanMacro(ShareReaders);
+
+  /** Get the identifiers of the applications in execution order */
+  std::vector<std::string> GetExecutionOrder() const;
+
+  /** Get the number of readers shared by several applications during
+   * the last ExecuteAndWriteOutputs() */
+  unsigned int GetNumberOfSharedReaders() const;
+
+  /** Get the number of stream divisions of the last ExecuteAndWriteOutputs() */
+  unsigned int GetNumberOfDivisions() const;
+
+  /** Execute all the applications and write all their outputs */
+  void ExecuteAndWriteOutputs();
+
+protected:
+  ApplicationExecutionPlanner();
+  ~ApplicationExecutionPlanner() ITK_OVERRIDE;
+  void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
+
+private:
+  ApplicationExecutionPlanner(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  typedef struct
+    {
+    std::string FromApp;
+    std::string FromKey;
+    std::string ToApp;
+    std::string ToKey;
+    } ConnectionType;
+
+  typedef std::vector<ConnectionType>                   ConnectionListType;
+  typedef std::map<std::string, Application::Pointer>   ApplicationMapType;
+  typedef std::vector<InputImageParameter::Pointer>     ReaderListType;
+
+  /** Split "app.key" into the application identifier and the key */
+  void DecodeKey(const std::string & fullKey, std::string & id, std::string & key) const;
+
+  /** Check that the given key is a connected input image */
+  bool IsConnected(const std::string & id, const std::string & key) const;
+
+  /** Open one reader per filename used by several input images */
+  void ShareReaders();
+
+  /** Get the RAM to use for the whole graph */
+  unsigned int ComputeAvailableRAM() const;
+
+  /** Insertion order of the applications */
+  std::vector<std::string> m_ApplicationIds;
+
+  ApplicationMapType   m_Applications;
+
+  ConnectionListType   m_Connections;
+
+  unsigned int         m_AvailableRAM;
+
+  bool                 m_ShareReaders;
+
+  /** Parameters holding the shared readers */
+  ReaderListType       m_SharedReaders;
+
+  MultiImageFileWriter::Pointer m_Writer;
+};
+
+} // end namespace Wrapper
+} // end namespace otb
+
+#endif
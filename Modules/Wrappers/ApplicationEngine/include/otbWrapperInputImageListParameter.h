@@ -77,6 +77,16 @@ public:
   /** Get one specific stored image. */
   FloatVectorImageType* GetNthImage(unsigned int i) const;
 
+  /** Get the native pixel type shared by all the images of the list (see
+   * InputImageParameter::GetNativePixelType), float if they differ. */
+  ImagePixelType GetNativePixelType();
+
+  /** Get one specific image as a VectorImage of its native pixel type
+   * (see InputImageParameter::GetNativeVectorImage). Files are opened by
+   * a second reader of the native type, the image list keeps the float
+   * one. */
+  ImageBaseType* GetNthNativeVectorImage(unsigned int i);
+
   /** Set one specific image. */
   void SetNthImage(unsigned int i, ImageBaseType * img);
   
@@ -112,6 +122,9 @@ private:
 
   InputImageParameterVectorType m_InputImageParameterVector;
   FloatVectorImageListType::Pointer m_ImageList;
+
+  /** Readers of the native pixel type, by image of the list */
+  InputImageParameterVectorType m_NativeInputImageParameterVector;
   
   
 }; // End class InputImage Parameter
@@ -56,6 +56,9 @@ public:
   bool SetFromFileName(const std::string& filename);
   itkGetConstMacro(FileName, std::string);
 
+  /** True if the value comes from a filename, false if an image was set */
+  itkGetConstMacro(UseFilename, bool);
+
 
   /** Get the input image as FloatVectorImageType. */
   FloatVectorImageType* GetImage();
@@ -80,6 +83,17 @@ public:
   UInt8RGBImageType* GetUInt8RGBImage();
   UInt8RGBAImageType* GetUInt8RGBAImage();
 
+  /** Get the pixel type of the input, as stored in the file or as given by
+   * the image set. Types without an ImagePixelType counterpart (complex,
+   * signed char, RGB...) are reported as float. */
+  ImagePixelType GetNativePixelType();
+
+  /** Get the input image as a VectorImage of its native pixel type when
+   * it is uint8, int16 or uint16, and as a FloatVectorImageType otherwise.
+   * Type-generic applications use it to avoid a float copy of 8 and 16 bits
+   * images: the result has to be dynamic_cast to one of these four types. */
+  ImageBaseType* GetNativeVectorImage();
+
 
   /** Get the input image as templated image type. */
   template <class TImageType>
@@ -158,6 +172,10 @@ private:
   /** flag : are we using a filename or an image pointer as an input */
   bool m_UseFilename;
 
+  /** Native pixel type of the file m_NativePixelTypeFileName */
+  ImagePixelType m_NativePixelType;
+  std::string    m_NativePixelTypeFileName;
+
 }; // End class InputImage Parameter
 
 
@@ -25,6 +25,7 @@
 #include "itkImageBase.h"
 #include "otbWrapperParameter.h"
 #include "otbImageFileWriter.h"
+#include "otbMultiImageFileWriter.h"
 
 namespace otb
 {
@@ -103,6 +104,11 @@ public:
 
   void Write();
 
+  /** Register the image, clamped to the output pixel type, in the given
+   * multi-writer instead of writing it. The file is written by the
+   * multi-writer Update(), along with its other images. */
+  void AddToMultiWriter(MultiImageFileWriter* multiWriter);
+
   itk::ProcessObject* GetWriter();
 
   void InitializeWriters();
@@ -171,6 +177,12 @@ protected:
   RGBUInt8WriterType::Pointer   m_RGBUInt8Writer;
   RGBAUInt8WriterType::Pointer  m_RGBAUInt8Writer;
 
+  /** Clamp filter of the last call to AddToMultiWriter() */
+  itk::ProcessObject::Pointer   m_ClampFilter;
+
+  /** Set during AddToMultiWriter() only */
+  MultiImageFileWriter*         m_MultiWriter;
+
 private:
   OutputImageParameter(const Parameter &); //purposely not implemented
   void operator =(const Parameter&); //purposely not implemented
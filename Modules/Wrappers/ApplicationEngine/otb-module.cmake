@@ -26,6 +26,7 @@ ENABLE_SHARED
   DEPENDS
     OTBVectorDataBase
     OTBImageIO
+    OTBStreaming
     OTBProjection
     OTBVectorDataIO
     OTBTransform
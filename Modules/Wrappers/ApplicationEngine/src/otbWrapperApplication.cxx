@@ -42,9 +42,16 @@
 
 #include "otbMacro.h"
 #include "otbWrapperTypes.h"
+#include "otbMultiImageFileWriter.h"
+#include "otbPipelineProfiler.h"
+#include "otbConfigurationManager.h"
 #include <exception>
 #include "itkMacro.h"
 
+#ifdef OTB_USE_MPI
+#include "otbMPIConfig.h"
+#endif
+
 namespace otb
 {
 namespace Wrapper
@@ -419,6 +426,70 @@ int Application::ExecuteAndWriteOutput()
           }
         }
 
+      // Record the execution of each filter when profiling is enabled
+      const std::string traceFile = ConfigurationManager::GetProfileTraceFile();
+      PipelineProfiler::Pointer profiler;
+      if (!traceFile.empty())
+        {
+        profiler = PipelineProfiler::New();
+        }
+
+      // Several output images usually share a part of their pipeline
+      // (MeanShiftSmoothing fout and foutpos for instance): write them
+      // from a single streaming loop, so that the shared filters are
+      // updated once per division instead of once per output
+      std::vector<OutputImageParameter*> outputImages;
+      for (std::vector<std::string>::const_iterator it = paramList.begin();
+           it != paramList.end();
+           ++it)
+        {
+        if (GetParameterType(*it) == ParameterType_OutputImage
+            && IsParameterEnabled(*it) && HasValue(*it))
+          {
+          OutputImageParameter* outputParam =
+            dynamic_cast<OutputImageParameter*>(GetParameterByKey(*it));
+          if (outputParam != ITK_NULLPTR)
+            {
+            outputImages.push_back(outputParam);
+            }
+          }
+        }
+
+      bool useMultiWriter = outputImages.size() > 1;
+#ifdef OTB_USE_MPI
+      // Parallel writing handles each output on its own
+      if (otb::MPIConfig::Instance()->GetNbProcs() > 1)
+        {
+        useMultiWriter = false;
+        }
+#endif
+
+      if (useMultiWriter)
+        {
+        MultiImageFileWriter::Pointer multiWriter = MultiImageFileWriter::New();
+        multiWriter->SetAutomaticTiledStreaming(useRAM ? ram : 0);
+        for (std::vector<OutputImageParameter*>::iterator it = outputImages.begin();
+             it != outputImages.end();
+             ++it)
+          {
+          (*it)->InitializeWriters();
+          std::string checkReturn = (*it)->CheckFileName(true);
+          if (!checkReturn.empty())
+            {
+            otbAppLogWARNING("Check filename : "<<checkReturn);
+            }
+          (*it)->AddToMultiWriter(multiWriter);
+          }
+        std::ostringstream progressId;
+        progressId << "Writing " << outputImages.size() << " output images...";
+        AddProcess(multiWriter, progressId.str());
+        if (profiler.IsNotNull())
+          {
+          profiler->Watch(multiWriter);
+          }
+        multiWriter->Update();
+        }
+
       for (std::vector<std::string>::const_iterator it = paramList.begin();
            it != paramList.end();
            ++it)
@@ -427,6 +498,11 @@ int Application::ExecuteAndWriteOutput()
         if (GetParameterType(key) == ParameterType_OutputImage
             && IsParameterEnabled(key) && HasValue(key) )
           {
+          if (useMultiWriter)
+            {
+            // Already written
+            continue;
+            }
           Parameter* param = GetParameterByKey(key);
           OutputImageParameter* outputParam = dynamic_cast<OutputImageParameter*>(param);
 
@@ -445,6 +521,10 @@ int Application::ExecuteAndWriteOutput()
             std::ostringstream progressId;
             progressId << "Writing " << outputParam->GetFileName() << "...";
             AddProcess(outputParam->GetWriter(), progressId.str());
+            if (profiler.IsNotNull())
+              {
+              profiler->Watch(outputParam->GetWriter());
+              }
             outputParam->Write();
             }
           }
@@ -459,6 +539,10 @@ int Application::ExecuteAndWriteOutput()
             std::ostringstream progressId;
             progressId << "Writing " << outputParam->GetFileName() << "...";
             AddProcess(outputParam->GetWriter(), progressId.str());
+            if (profiler.IsNotNull())
+              {
+              profiler->Watch(outputParam->GetWriter());
+              }
             outputParam->Write();
             }
           }
@@ -478,6 +562,10 @@ int Application::ExecuteAndWriteOutput()
             std::ostringstream progressId;
             progressId << "Writing " << outputParam->GetFileName() << "...";
             AddProcess(outputParam->GetWriter(), progressId.str());
+            if (profiler.IsNotNull())
+              {
+              profiler->Watch(outputParam->GetWriter());
+              }
             outputParam->Write();
             }
           }
@@ -494,6 +582,14 @@ int Application::ExecuteAndWriteOutput()
             }
           }
         }
+
+      if (profiler.IsNotNull())
+        {
+        profiler->WriteTrace(traceFile);
+        std::ostringstream report;
+        profiler->Report(report);
+        otbAppLogINFO("Execution profile (trace written in "<<traceFile<<"):\n"<<report.str());
+        }
     }
 
   this->AfterExecuteAndWriteOutputs();
@@ -1345,6 +1441,42 @@ FloatVectorImageType* Application::GetParameterImage(std::string parameter)
   return ret;
 }
 
+ImagePixelType Application::GetParameterImageNativePixelType(std::string parameter)
+{
+  ImagePixelType ret = ImagePixelType_float;
+  Parameter* param = GetParameterByKey(parameter);
+
+  if (dynamic_cast<InputImageParameter*> (param))
+    {
+    InputImageParameter* paramDown = dynamic_cast<InputImageParameter*> (param);
+    ret = paramDown->GetNativePixelType();
+    }
+  else
+    {
+    itkExceptionMacro(<<parameter << "parameter can't be casted to ImageType");
+    }
+
+  return ret;
+}
+
+InputImageParameter::ImageBaseType* Application::GetParameterNativeVectorImage(std::string parameter)
+{
+  InputImageParameter::ImageBaseType::Pointer ret = ITK_NULLPTR;
+  Parameter* param = GetParameterByKey(parameter);
+
+  if (dynamic_cast<InputImageParameter*> (param))
+    {
+    InputImageParameter* paramDown = dynamic_cast<InputImageParameter*> (param);
+    ret = paramDown->GetNativeVectorImage();
+    }
+  else
+    {
+    itkExceptionMacro(<<parameter << "parameter can't be casted to ImageType");
+    }
+
+  return ret;
+}
+
 FloatVectorImageListType* Application::GetParameterImageList(std::string parameter)
 {
   FloatVectorImageListType::Pointer ret=ITK_NULLPTR;
@@ -1363,6 +1495,42 @@ FloatVectorImageListType* Application::GetParameterImageList(std::string paramet
   return ret;
 }
 
+ImagePixelType Application::GetParameterImageListNativePixelType(std::string parameter)
+{
+  ImagePixelType ret = ImagePixelType_float;
+  Parameter* param = GetParameterByKey(parameter);
+
+  if (dynamic_cast<InputImageListParameter*>(param))
+    {
+    InputImageListParameter* paramDown = dynamic_cast<InputImageListParameter*>(param);
+    ret = paramDown->GetNativePixelType();
+    }
+  else
+    {
+    itkExceptionMacro(<<parameter << "parameter can't be casted to ImageListType");
+    }
+
+  return ret;
+}
+
+InputImageParameter::ImageBaseType* Application::GetParameterNthNativeVectorImage(std::string parameter, unsigned int i)
+{
+  InputImageParameter::ImageBaseType::Pointer ret = ITK_NULLPTR;
+  Parameter* param = GetParameterByKey(parameter);
+
+  if (dynamic_cast<InputImageListParameter*>(param))
+    {
+    InputImageListParameter* paramDown = dynamic_cast<InputImageListParameter*>(param);
+    ret = paramDown->GetNthNativeVectorImage(i);
+    }
+  else
+    {
+    itkExceptionMacro(<<parameter << "parameter can't be casted to ImageListType");
+    }
+
+  return ret;
+}
+
 ComplexFloatVectorImageType* Application::GetParameterComplexImage(std::string parameter)
 {
   ComplexFloatVectorImageType::Pointer ret=ITK_NULLPTR;
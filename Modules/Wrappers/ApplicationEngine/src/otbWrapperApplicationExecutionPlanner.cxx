@@ -0,0 +1,449 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbWrapperApplicationExecutionPlanner.h"
+#include "otbWrapperOutputImageParameter.h"
+#include "otbWrapperOutputVectorDataParameter.h"
+#include "otbWrapperComplexOutputImageParameter.h"
+#include "otbWrapperRAMParameter.h"
+#include "otbPipelineProfiler.h"
+#include "otbConfigurationManager.h"
+
+namespace otb
+{
+namespace Wrapper
+{
+
+ApplicationExecutionPlanner::ApplicationExecutionPlanner()
+  : m_AvailableRAM(0),
+    m_ShareReaders(true)
+{
+}
+
+ApplicationExecutionPlanner::~ApplicationExecutionPlanner()
+{
+}
+
+void
+ApplicationExecutionPlanner::AddApplication(Application* app, const std::string & id)
+{
+  if (app == ITK_NULLPTR)
+    {
+    itkExceptionMacro(<< "Can not add a null application");
+    }
+  if (id.empty() || id.find('.') != std::string::npos)
+    {
+    itkExceptionMacro(<< "Invalid application identifier '" << id << "'");
+    }
+  if (m_Applications.count(id))
+    {
+    itkExceptionMacro(<< "An application is already registered as '" << id << "'");
+    }
+
+  m_Applications[id] = app;
+  m_ApplicationIds.push_back(id);
+  this->Modified();
+}
+
+Application*
+ApplicationExecutionPlanner::GetApplication(const std::string & id) const
+{
+  ApplicationMapType::const_iterator it = m_Applications.find(id);
+  if (it == m_Applications.end())
+    {
+    itkExceptionMacro(<< "No application registered as '" << id << "'");
+    }
+  return it->second;
+}
+
+void
+ApplicationExecutionPlanner::DecodeKey(const std::string & fullKey, std::string & id, std::string & key) const
+{
+  std::string::size_type pos = fullKey.find('.');
+  if (pos == std::string::npos || pos == 0 || pos + 1 == fullKey.size())
+    {
+    itkExceptionMacro(<< "Key '" << fullKey << "' is not of the form 'application.parameter'");
+    }
+  id = fullKey.substr(0, pos);
+  key = fullKey.substr(pos + 1);
+}
+
+void
+ApplicationExecutionPlanner::Connect(const std::string & fromKey, const std::string & toKey)
+{
+  ConnectionType connection;
+  DecodeKey(fromKey, connection.FromApp, connection.FromKey);
+  DecodeKey(toKey, connection.ToApp, connection.ToKey);
+
+  if (connection.FromApp == connection.ToApp)
+    {
+    itkExceptionMacro(<< "Can not connect application '" << connection.FromApp << "' to itself");
+    }
+  if (GetApplication(connection.FromApp)->GetParameterType(connection.FromKey) != ParameterType_OutputImage)
+    {
+    itkExceptionMacro(<< fromKey << " is not an output image");
+    }
+  if (GetApplication(connection.ToApp)->GetParameterType(connection.ToKey) != ParameterType_InputImage)
+    {
+    itkExceptionMacro(<< toKey << " is not an input image");
+    }
+  if (IsConnected(connection.ToApp, connection.ToKey))
+    {
+    itkExceptionMacro(<< toKey << " is already connected");
+    }
+
+  m_Connections.push_back(connection);
+  this->Modified();
+}
+
+bool
+ApplicationExecutionPlanner::IsConnected(const std::string & id, const std::string & key) const
+{
+  for (ConnectionListType::const_iterator it = m_Connections.begin(); it != m_Connections.end(); ++it)
+    {
+    if (it->ToApp == id && it->ToKey == key)
+      {
+      return true;
+      }
+    }
+  return false;
+}
+
+std::vector<std::string>
+ApplicationExecutionPlanner::GetExecutionOrder() const
+{
+  // Topological sort: an application is ready when all the applications
+  // it is connected to are already in the list. Ties are broken by
+  // insertion order, so that the order is reproducible.
+  std::map<std::string, unsigned int> nbPendingInputs;
+  for (ConnectionListType::const_iterator it = m_Connections.begin(); it != m_Connections.end(); ++it)
+    {
+    ++nbPendingInputs[it->ToApp];
+    }
+
+  std::vector<std::string> order;
+  std::vector<bool> done(m_ApplicationIds.size(), false);
+
+  bool progress = true;
+  while (progress && order.size() < m_ApplicationIds.size())
+    {
+    progress = false;
+    for (unsigned int i = 0; i < m_ApplicationIds.size(); ++i)
+      {
+      const std::string & id = m_ApplicationIds[i];
+      if (!done[i] && nbPendingInputs[id] == 0)
+        {
+        done[i] = true;
+        order.push_back(id);
+        progress = true;
+
+        for (ConnectionListType::const_iterator it = m_Connections.begin(); it != m_Connections.end(); ++it)
+          {
+          if (it->FromApp == id)
+            {
+            --nbPendingInputs[it->ToApp];
+            }
+          }
+        }
+      }
+    }
+
+  if (order.size() < m_ApplicationIds.size())
+    {
+    itkExceptionMacro(<< "The connections between applications contain a cycle");
+    }
+
+  return order;
+}
+
+void
+ApplicationExecutionPlanner::ShareReaders()
+{
+  typedef std::map<std::string, std::vector<InputImageParameter*> > FileMapType;
+
+  m_SharedReaders.clear();
+
+  FileMapType files;
+  for (std::vector<std::string>::const_iterator idIt = m_ApplicationIds.begin();
+       idIt != m_ApplicationIds.end(); ++idIt)
+    {
+    Application* app = m_Applications[*idIt];
+    std::vector<std::string> keys = app->GetParametersKeys(true);
+
+    for (std::vector<std::string>::const_iterator it = keys.begin(); it != keys.end(); ++it)
+      {
+      if (app->GetParameterType(*it) != ParameterType_InputImage
+          || IsConnected(*idIt, *it)
+          || !app->HasValue(*it))
+        {
+        continue;
+        }
+
+      InputImageParameter* param = dynamic_cast<InputImageParameter*>(app->GetParameterByKey(*it));
+      if (param && param->GetUseFilename() && !param->GetFileName().empty())
+        {
+        files[param->GetFileName()].push_back(param);
+        }
+      }
+    }
+
+  for (FileMapType::const_iterator it = files.begin(); it != files.end(); ++it)
+    {
+    if (it->second.size() < 2)
+      {
+      continue;
+      }
+
+    // A standalone parameter owns the shared reader. The image is read
+    // in its native type, each application casting it to the type it
+    // asks for.
+    InputImageParameter::Pointer reader = InputImageParameter::New();
+    if (!reader->SetFromFileName(it->first))
+      {
+      continue;
+      }
+    InputImageParameter::ImageBaseType* image = reader->GetNativeVectorImage();
+
+    for (std::vector<InputImageParameter*>::const_iterator paramIt = it->second.begin();
+         paramIt != it->second.end(); ++paramIt)
+      {
+      if (dynamic_cast<UInt8VectorImageType*>(image))
+        {
+        (*paramIt)->SetImage<UInt8VectorImageType>(dynamic_cast<UInt8VectorImageType*>(image));
+        }
+      else if (dynamic_cast<Int16VectorImageType*>(image))
+        {
+        (*paramIt)->SetImage<Int16VectorImageType>(dynamic_cast<Int16VectorImageType*>(image));
+        }
+      else if (dynamic_cast<UInt16VectorImageType*>(image))
+        {
+        (*paramIt)->SetImage<UInt16VectorImageType>(dynamic_cast<UInt16VectorImageType*>(image));
+        }
+      else
+        {
+        (*paramIt)->SetImage(dynamic_cast<FloatVectorImageType*>(image));
+        }
+      }
+
+    otbMsgDevMacro(<< "Sharing the reader of " << it->first << " between "
+                   << it->second.size() << " input images");
+    m_SharedReaders.push_back(reader);
+    }
+}
+
+unsigned int
+ApplicationExecutionPlanner::ComputeAvailableRAM() const
+{
+  if (m_AvailableRAM > 0)
+    {
+    return m_AvailableRAM;
+    }
+
+  // The graph runs in a single streaming loop, so the most constrained
+  // application sets the RAM for all of them
+  unsigned int ram = 0;
+  for (ApplicationMapType::const_iterator appIt = m_Applications.begin();
+       appIt != m_Applications.end(); ++appIt)
+    {
+    Application* app = appIt->second;
+    std::vector<std::string> keys = app->GetParametersKeys(true);
+    for (std::vector<std::string>::const_iterator it = keys.begin(); it != keys.end(); ++it)
+      {
+      if (app->GetParameterType(*it) == ParameterType_RAM && app->IsParameterEnabled(*it))
+        {
+        RAMParameter* ramParam = dynamic_cast<RAMParameter*>(app->GetParameterByKey(*it));
+        if (ramParam != ITK_NULLPTR && ramParam->GetValue() > 0
+            && (ram == 0 || ramParam->GetValue() < ram))
+          {
+          ram = ramParam->GetValue();
+          }
+        }
+      }
+    }
+  return ram;
+}
+
+unsigned int
+ApplicationExecutionPlanner::GetNumberOfSharedReaders() const
+{
+  return m_SharedReaders.size();
+}
+
+unsigned int
+ApplicationExecutionPlanner::GetNumberOfDivisions() const
+{
+  if (m_Writer.IsNull())
+    {
+    return 0;
+    }
+  return m_Writer->GetNumberOfDivisions();
+}
+
+void
+ApplicationExecutionPlanner::ExecuteAndWriteOutputs()
+{
+  std::vector<std::string> order = this->GetExecutionOrder();
+
+  if (m_ShareReaders)
+    {
+    this->ShareReaders();
+    }
+  else
+    {
+    m_SharedReaders.clear();
+    }
+
+  // Build the whole pipeline, nothing is computed yet
+  for (std::vector<std::string>::const_iterator idIt = order.begin(); idIt != order.end(); ++idIt)
+    {
+    Application* app = m_Applications[*idIt];
+
+    for (ConnectionListType::const_iterator it = m_Connections.begin(); it != m_Connections.end(); ++it)
+      {
+      if (it->ToApp == *idIt)
+        {
+        app->SetParameterInputImage(it->ToKey,
+                                    m_Applications[it->FromApp]->GetParameterOutputImage(it->FromKey));
+        }
+      }
+
+    otbMsgDevMacro(<< "Executing application " << *idIt);
+    if (app->Execute() != 0)
+      {
+      itkExceptionMacro(<< "Execution of application '" << *idIt << "' failed");
+      }
+    }
+
+  // Stream all the output images at once
+  m_Writer = MultiImageFileWriter::New();
+  m_Writer->SetAutomaticTiledStreaming(this->ComputeAvailableRAM());
+
+  for (std::vector<std::string>::const_iterator idIt = order.begin(); idIt != order.end(); ++idIt)
+    {
+    Application* app = m_Applications[*idIt];
+    std::vector<std::string> keys = app->GetParametersKeys(true);
+
+    for (std::vector<std::string>::const_iterator it = keys.begin(); it != keys.end(); ++it)
+      {
+      if (app->GetParameterType(*it) == ParameterType_OutputImage
+          && app->IsParameterEnabled(*it) && app->HasValue(*it))
+        {
+        OutputImageParameter* outputParam = dynamic_cast<OutputImageParameter*>(app->GetParameterByKey(*it));
+        if (outputParam != ITK_NULLPTR)
+          {
+          outputParam->InitializeWriters();
+          std::string checkReturn = outputParam->CheckFileName(true);
+          if (!checkReturn.empty())
+            {
+            app->GetLogger()->Warning("Check filename : " + checkReturn + "\n");
+            }
+          outputParam->AddToMultiWriter(m_Writer);
+          }
+        }
+      }
+    }
+
+  if (m_Writer->GetNumberOfInputImages() > 0)
+    {
+    // Record the execution of each filter of the graph when profiling is
+    // enabled
+    const std::string traceFile = ConfigurationManager::GetProfileTraceFile();
+    PipelineProfiler::Pointer profiler;
+    if (!traceFile.empty())
+      {
+      profiler = PipelineProfiler::New();
+      profiler->Watch(m_Writer);
+      }
+
+    m_Writer->Update();
+    otbMsgDevMacro(<< "Wrote " << m_Writer->GetNumberOfInputImages() << " images in "
+                   << m_Writer->GetNumberOfDivisions() << " divisions");
+
+    if (profiler.IsNotNull())
+      {
+      profiler->WriteTrace(traceFile);
+      std::ostringstream report;
+      profiler->Report(report);
+      otbMsgDevMacro(<< "Execution profile (trace written in " << traceFile << "):\n" << report.str());
+      }
+    }
+
+  // Remaining outputs are written one after the other
+  for (std::vector<std::string>::const_iterator idIt = order.begin(); idIt != order.end(); ++idIt)
+    {
+    Application* app = m_Applications[*idIt];
+    std::vector<std::string> keys = app->GetParametersKeys(true);
+
+    for (std::vector<std::string>::const_iterator it = keys.begin(); it != keys.end(); ++it)
+      {
+      if (!app->IsParameterEnabled(*it) || !app->HasValue(*it))
+        {
+        continue;
+        }
+
+      if (app->GetParameterType(*it) == ParameterType_OutputVectorData)
+        {
+        OutputVectorDataParameter* outputParam =
+          dynamic_cast<OutputVectorDataParameter*>(app->GetParameterByKey(*it));
+        if (outputParam != ITK_NULLPTR)
+          {
+          outputParam->InitializeWriters();
+          outputParam->Write();
+          }
+        }
+      else if (app->GetParameterType(*it) == ParameterType_ComplexOutputImage)
+        {
+        ComplexOutputImageParameter* outputParam =
+          dynamic_cast<ComplexOutputImageParameter*>(app->GetParameterByKey(*it));
+        if (outputParam != ITK_NULLPTR)
+          {
+          outputParam->InitializeWriters();
+          outputParam->SetRAMValue(this->ComputeAvailableRAM());
+          outputParam->Write();
+          }
+        }
+      }
+    }
+}
+
+void
+ApplicationExecutionPlanner::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+
+  os << indent << "Applications:" << std::endl;
+  for (std::vector<std::string>::const_iterator it = m_ApplicationIds.begin();
+       it != m_ApplicationIds.end(); ++it)
+    {
+    ApplicationMapType::const_iterator appIt = m_Applications.find(*it);
+    os << indent.GetNextIndent() << *it << " (" << appIt->second->GetName() << ")" << std::endl;
+    }
+  os << indent << "Connections:" << std::endl;
+  for (ConnectionListType::const_iterator it = m_Connections.begin(); it != m_Connections.end(); ++it)
+    {
+    os << indent.GetNextIndent() << it->FromApp << "." << it->FromKey
+       << " -> " << it->ToApp << "." << it->ToKey << std::endl;
+    }
+  os << indent << "Available RAM: " << m_AvailableRAM << std::endl;
+  os << indent << "Share readers: " << m_ShareReaders << std::endl;
+}
+
+} // end namespace Wrapper
+} // end namespace otb
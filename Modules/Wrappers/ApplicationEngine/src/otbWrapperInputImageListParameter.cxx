@@ -198,6 +198,55 @@ InputImageListParameter::GetNthImage(unsigned int i) const
   return m_ImageList->GetNthElement(i);
 }
 
+ImagePixelType
+InputImageListParameter::GetNativePixelType()
+{
+  if (m_InputImageParameterVector.empty() || m_InputImageParameterVector[0].IsNull())
+    {
+    return ImagePixelType_float;
+    }
+
+  const ImagePixelType pixelType = m_InputImageParameterVector[0]->GetNativePixelType();
+  for (unsigned int i = 1; i < m_InputImageParameterVector.size(); ++i)
+    {
+    if (m_InputImageParameterVector[i].IsNull()
+        || m_InputImageParameterVector[i]->GetNativePixelType() != pixelType)
+      {
+      return ImagePixelType_float;
+      }
+    }
+  return pixelType;
+}
+
+InputImageListParameter::ImageBaseType*
+InputImageListParameter::GetNthNativeVectorImage(unsigned int i)
+{
+  if(m_InputImageParameterVector.size()<=i)
+    {
+    itkExceptionMacro(<< "No image "<<i<<". Only "<<m_InputImageParameterVector.size()<<" images available.");
+    }
+
+  InputImageParameter* param = m_InputImageParameterVector[i];
+  if (!param->GetUseFilename())
+    {
+    return param->GetNativeVectorImage();
+    }
+
+  // The parameter of the list already reads the file as float, and an
+  // InputImageParameter only serves one image type: use another one
+  if (m_NativeInputImageParameterVector.size() < m_InputImageParameterVector.size())
+    {
+    m_NativeInputImageParameterVector.resize(m_InputImageParameterVector.size());
+    }
+  InputImageParameter::Pointer& nativeParam = m_NativeInputImageParameterVector[i];
+  if (nativeParam.IsNull() || nativeParam->GetFileName() != param->GetFileName())
+    {
+    nativeParam = InputImageParameter::New();
+    nativeParam->SetFromFileName(param->GetFileName());
+    }
+  return nativeParam->GetNativeVectorImage();
+}
+
 void
 InputImageListParameter::SetImageList(FloatVectorImageListType* imList)
 {
@@ -314,6 +363,10 @@ InputImageListParameter::Erase( unsigned int id )
 
   m_ImageList->Erase( id );
   m_InputImageParameterVector.erase(m_InputImageParameterVector.begin()+id);
+  if (id < m_NativeInputImageParameterVector.size())
+    {
+    m_NativeInputImageParameterVector.erase(m_NativeInputImageParameterVector.begin()+id);
+    }
 
   this->Modified();
 }
@@ -330,6 +383,7 @@ InputImageListParameter::ClearValue()
 {
   m_ImageList->Clear();
   m_InputImageParameterVector.clear();
+  m_NativeInputImageParameterVector.clear();
 
   SetActive(false);
   this->Modified();
@@ -23,6 +23,8 @@
 #include "otbWrapperTypes.h"
 #include "otbWrapperInputImageParameterMacros.h"
 #include "otb_boost_string_header.h"
+#include "otbImageIOFactory.h"
+#include "otbExtendedFilenameToReaderOptions.h"
 
 namespace otb
 {
@@ -36,6 +38,8 @@ InputImageParameter::InputImageParameter()
   m_FileName="";
   m_PreviousFileName="";
   m_UseFilename = true;
+  m_NativePixelType = ImagePixelType_float;
+  m_NativePixelTypeFileName = "";
   this->ClearValue();
 }
 
@@ -87,6 +91,124 @@ otbGetImageMacro(UInt8RGBImage);
 otbGetImageMacro(UInt8RGBAImage);
 
 
+ImagePixelType
+InputImageParameter::GetNativePixelType()
+{
+  if (!m_UseFilename)
+    {
+    if (dynamic_cast<UInt8ImageType*>(m_Image.GetPointer())
+        || dynamic_cast<UInt8VectorImageType*>(m_Image.GetPointer()))
+      {
+      return ImagePixelType_uint8;
+      }
+    else if (dynamic_cast<Int16ImageType*>(m_Image.GetPointer())
+             || dynamic_cast<Int16VectorImageType*>(m_Image.GetPointer()))
+      {
+      return ImagePixelType_int16;
+      }
+    else if (dynamic_cast<UInt16ImageType*>(m_Image.GetPointer())
+             || dynamic_cast<UInt16VectorImageType*>(m_Image.GetPointer()))
+      {
+      return ImagePixelType_uint16;
+      }
+    else if (dynamic_cast<Int32ImageType*>(m_Image.GetPointer())
+             || dynamic_cast<Int32VectorImageType*>(m_Image.GetPointer()))
+      {
+      return ImagePixelType_int32;
+      }
+    else if (dynamic_cast<UInt32ImageType*>(m_Image.GetPointer())
+             || dynamic_cast<UInt32VectorImageType*>(m_Image.GetPointer()))
+      {
+      return ImagePixelType_uint32;
+      }
+    else if (dynamic_cast<DoubleImageType*>(m_Image.GetPointer())
+             || dynamic_cast<DoubleVectorImageType*>(m_Image.GetPointer()))
+      {
+      return ImagePixelType_double;
+      }
+    return ImagePixelType_float;
+    }
+
+  if (m_FileName.empty())
+    {
+    return ImagePixelType_float;
+    }
+
+  // The file header is read once per filename
+  if (m_FileName != m_NativePixelTypeFileName)
+    {
+    m_NativePixelTypeFileName = m_FileName;
+    m_NativePixelType = ImagePixelType_float;
+
+    otb::ExtendedFilenameToReaderOptions::Pointer filenameHelper =
+      otb::ExtendedFilenameToReaderOptions::New();
+    filenameHelper->SetExtendedFileName(m_FileName);
+
+    std::string simpleFilename = filenameHelper->GetSimpleFileName();
+    otb::ImageIOBase::Pointer imageIO =
+      otb::ImageIOFactory::CreateImageIO(simpleFilename.c_str(),
+                                         otb::ImageIOFactory::ReadMode);
+    if (imageIO.IsNotNull())
+      {
+      imageIO->SetFileName(simpleFilename);
+      try
+        {
+        imageIO->ReadImageInformation();
+        }
+      catch (itk::ExceptionObject &)
+        {
+        // The reader will report the error, fall back to float
+        return m_NativePixelType;
+        }
+
+      switch (imageIO->GetComponentType())
+        {
+        case otb::ImageIOBase::UCHAR:
+          m_NativePixelType = ImagePixelType_uint8;
+          break;
+        case otb::ImageIOBase::SHORT:
+          m_NativePixelType = ImagePixelType_int16;
+          break;
+        case otb::ImageIOBase::USHORT:
+          m_NativePixelType = ImagePixelType_uint16;
+          break;
+        case otb::ImageIOBase::INT:
+          m_NativePixelType = ImagePixelType_int32;
+          break;
+        case otb::ImageIOBase::UINT:
+          m_NativePixelType = ImagePixelType_uint32;
+          break;
+        case otb::ImageIOBase::DOUBLE:
+          m_NativePixelType = ImagePixelType_double;
+          break;
+        default:
+          m_NativePixelType = ImagePixelType_float;
+          break;
+        }
+      }
+    }
+
+  return m_NativePixelType;
+}
+
+
+InputImageParameter::ImageBaseType*
+InputImageParameter::GetNativeVectorImage()
+{
+  switch (this->GetNativePixelType())
+    {
+    case ImagePixelType_uint8:
+      return this->GetImage<UInt8VectorImageType>();
+    case ImagePixelType_int16:
+      return this->GetImage<Int16VectorImageType>();
+    case ImagePixelType_uint16:
+      return this->GetImage<UInt16VectorImageType>();
+    default:
+      return this->GetImage<FloatVectorImageType>();
+    }
+}
+
+
 void
 InputImageParameter::SetImage(FloatVectorImageType* image)
 {
@@ -22,6 +22,7 @@
 #include "otbClampImageFilter.h"
 #include "otbClampVectorImageFilter.h"
 #include "otbImageIOFactory.h"
+#include "otbMultiImageFileWriter.h"
 #include "itksys/SystemTools.hxx"
 
 #ifdef OTB_USE_MPI
@@ -43,6 +44,7 @@ namespace Wrapper
 OutputImageParameter::OutputImageParameter()
   : m_PixelType(ImagePixelType_float),
     m_DefaultPixelType(ImagePixelType_float),
+    m_MultiWriter(ITK_NULLPTR),
     m_RAMValue(0)
 {
   this->SetName("Output Image");
@@ -121,11 +123,43 @@ void OutputImageParameter::InitializeWriters()
 }
 
 
-template <typename TInput, typename TOutput> void ClampAndWriteImage(itk::ImageBase<2> * in, otb::ImageFileWriter<TOutput> * writer, const std::string & filename, const unsigned int & ramValue)
+/** Build the clamping step between the application output and the
+ *  writer. When the output already has the requested pixel type the
+ *  clamping is a no-op, so the image is handed to the writer directly. */
+template <typename TInput, typename TOutput, typename TClampFilter>
+struct ClampFilterSelector
 {
-  typedef otb::ClampImageFilter<TInput, TOutput> ClampFilterType; 
-  typename ClampFilterType::Pointer clampFilter = ClampFilterType::New();         
-  clampFilter->SetInput( dynamic_cast<TInput*>(in));
+  static TOutput * Clamp(itk::ImageBase<2> * in, itk::ProcessObject::Pointer & filter)
+  {
+    typename TClampFilter::Pointer clampFilter = TClampFilter::New();
+    clampFilter->SetInput( dynamic_cast<TInput*>(in));
+    filter = clampFilter;
+    return clampFilter->GetOutput();
+  }
+};
+
+template <typename TImage, typename TClampFilter>
+struct ClampFilterSelector<TImage, TImage, TClampFilter>
+{
+  static TImage * Clamp(itk::ImageBase<2> * in, itk::ProcessObject::Pointer & itkNotUsed(filter))
+  {
+    return dynamic_cast<TImage*>(in);
+  }
+};
+
+template <typename TInput, typename TOutput> void ClampAndWriteImage(itk::ImageBase<2> * in, otb::ImageFileWriter<TOutput> * writer, const std::string & filename, const unsigned int & ramValue, otb::MultiImageFileWriter * multiWriter, itk::ProcessObject::Pointer & clampFilter)
+{
+  typedef otb::ClampImageFilter<TInput, TOutput> ClampFilterType;
+  TOutput * output =
+    ClampFilterSelector<TInput, TOutput, ClampFilterType>::Clamp(in, clampFilter);
+
+  if (multiWriter)
+    {
+    // The image will be written later, with the other images of the
+    // multi-writer
+    multiWriter->AddInputImage(output, filename);
+    return;
+    }
   
   bool useStandardWriter = true;
 
@@ -143,7 +177,7 @@ template <typename TInput, typename TOutput> void ClampAndWriteImage(itk::ImageB
     if(extension == ".vrt")
       {
       // Use the WriteMPI function
-      WriteMPI(clampFilter->GetOutput(),filename,ramValue);      
+      WriteMPI(output,filename,ramValue);      
       }
     #ifdef OTB_USE_SPTW
     else if (extension == ".tif")
@@ -153,7 +187,7 @@ template <typename TInput, typename TOutput> void ClampAndWriteImage(itk::ImageB
 
       typename SPTWriterType::Pointer sptWriter = SPTWriterType::New();
       sptWriter->SetFileName(filename);
-      sptWriter->SetInput(clampFilter->GetOutput());
+      sptWriter->SetInput(output);
       sptWriter->SetAutomaticAdaptativeStreaming(ramValue);
       sptWriter->Update();
       }
@@ -172,17 +206,25 @@ template <typename TInput, typename TOutput> void ClampAndWriteImage(itk::ImageB
     {
     
     writer->SetFileName( filename );                                     
-    writer->SetInput(clampFilter->GetOutput());                                     
+    writer->SetInput(output);                                     
     writer->SetAutomaticAdaptativeStreaming(ramValue);
     writer->Update();
     }
 }
 
-template <typename TInput, typename TOutput > void ClampAndWriteVectorImage(itk::ImageBase<2> * in, otb::ImageFileWriter<TOutput > * writer, const std::string & filename, const unsigned int & ramValue)
+template <typename TInput, typename TOutput > void ClampAndWriteVectorImage(itk::ImageBase<2> * in, otb::ImageFileWriter<TOutput > * writer, const std::string & filename, const unsigned int & ramValue, otb::MultiImageFileWriter * multiWriter, itk::ProcessObject::Pointer & clampFilter)
 {
-  typedef otb::ClampVectorImageFilter<TInput, TOutput> ClampFilterType; 
-  typename ClampFilterType::Pointer clampFilter = ClampFilterType::New();         
-  clampFilter->SetInput( dynamic_cast<TInput*>(in));
+  typedef otb::ClampVectorImageFilter<TInput, TOutput> ClampFilterType;
+  TOutput * output =
+    ClampFilterSelector<TInput, TOutput, ClampFilterType>::Clamp(in, clampFilter);
+
+  if (multiWriter)
+    {
+    // The image will be written later, with the other images of the
+    // multi-writer
+    multiWriter->AddInputImage(output, filename);
+    return;
+    }
   
   bool useStandardWriter = true;
   
@@ -200,7 +242,7 @@ template <typename TInput, typename TOutput > void ClampAndWriteVectorImage(itk:
     if(extension == ".vrt")
       {
       // Use the WriteMPI function
-      WriteMPI(clampFilter->GetOutput(),filename,ramValue);      
+      WriteMPI(output,filename,ramValue);      
       }
     #ifdef OTB_USE_SPTW
     else if (extension == ".tif")
@@ -210,7 +252,7 @@ template <typename TInput, typename TOutput > void ClampAndWriteVectorImage(itk:
       
       typename SPTWriterType::Pointer sptWriter = SPTWriterType::New();
       sptWriter->SetFileName(filename);
-      sptWriter->SetInput(clampFilter->GetOutput());
+      sptWriter->SetInput(output);
       sptWriter->SetAutomaticAdaptativeStreaming(ramValue);
       sptWriter->Update();
       }
@@ -227,7 +269,7 @@ template <typename TInput, typename TOutput > void ClampAndWriteVectorImage(itk:
     {
     
     writer->SetFileName( filename );                                     
-    writer->SetInput(clampFilter->GetOutput());                                     
+    writer->SetInput(output);                                     
     writer->SetAutomaticAdaptativeStreaming(ramValue);
     writer->Update();
     }
@@ -242,37 +284,37 @@ OutputImageParameter::SwitchImageWrite()
     {
     case ImagePixelType_uint8:
     {
-    ClampAndWriteImage<TInputImageType,UInt8ImageType>(m_Image,m_UInt8Writer,m_FileName,m_RAMValue);
+    ClampAndWriteImage<TInputImageType,UInt8ImageType>(m_Image,m_UInt8Writer,m_FileName,m_RAMValue,m_MultiWriter,m_ClampFilter);
     break;
     }
     case ImagePixelType_int16:
     {
-    ClampAndWriteImage<TInputImageType,Int16ImageType>(m_Image,m_Int16Writer,m_FileName,m_RAMValue);
+    ClampAndWriteImage<TInputImageType,Int16ImageType>(m_Image,m_Int16Writer,m_FileName,m_RAMValue,m_MultiWriter,m_ClampFilter);
     break;
     }
     case ImagePixelType_uint16:
     {
-    ClampAndWriteImage<TInputImageType,UInt16ImageType>(m_Image,m_UInt16Writer,m_FileName,m_RAMValue);
+    ClampAndWriteImage<TInputImageType,UInt16ImageType>(m_Image,m_UInt16Writer,m_FileName,m_RAMValue,m_MultiWriter,m_ClampFilter);
     break;
     }
     case ImagePixelType_int32:
     {
-    ClampAndWriteImage<TInputImageType,Int32ImageType>(m_Image,m_Int32Writer,m_FileName,m_RAMValue);
+    ClampAndWriteImage<TInputImageType,Int32ImageType>(m_Image,m_Int32Writer,m_FileName,m_RAMValue,m_MultiWriter,m_ClampFilter);
     break;
     }
     case ImagePixelType_uint32:
     {
-    ClampAndWriteImage<TInputImageType,UInt32ImageType>(m_Image,m_UInt32Writer,m_FileName,m_RAMValue);
+    ClampAndWriteImage<TInputImageType,UInt32ImageType>(m_Image,m_UInt32Writer,m_FileName,m_RAMValue,m_MultiWriter,m_ClampFilter);
     break;
     }
     case ImagePixelType_float:
     {
-    ClampAndWriteImage<TInputImageType,FloatImageType>(m_Image,m_FloatWriter,m_FileName,m_RAMValue);
+    ClampAndWriteImage<TInputImageType,FloatImageType>(m_Image,m_FloatWriter,m_FileName,m_RAMValue,m_MultiWriter,m_ClampFilter);
     break;
     }
     case ImagePixelType_double:
     {
-    ClampAndWriteImage<TInputImageType,DoubleImageType>(m_Image,m_DoubleWriter,m_FileName,m_RAMValue);
+    ClampAndWriteImage<TInputImageType,DoubleImageType>(m_Image,m_DoubleWriter,m_FileName,m_RAMValue,m_MultiWriter,m_ClampFilter);
     break;
     }
     }
@@ -287,37 +329,37 @@ OutputImageParameter::SwitchVectorImageWrite()
     {
     case ImagePixelType_uint8:
     {
-    ClampAndWriteVectorImage<TInputVectorImageType,UInt8VectorImageType>(m_Image,m_VectorUInt8Writer,m_FileName,m_RAMValue);
+    ClampAndWriteVectorImage<TInputVectorImageType,UInt8VectorImageType>(m_Image,m_VectorUInt8Writer,m_FileName,m_RAMValue,m_MultiWriter,m_ClampFilter);
     break;
     }
     case ImagePixelType_int16:
     {
-    ClampAndWriteVectorImage<TInputVectorImageType,Int16VectorImageType>(m_Image,m_VectorInt16Writer,m_FileName,m_RAMValue);
+    ClampAndWriteVectorImage<TInputVectorImageType,Int16VectorImageType>(m_Image,m_VectorInt16Writer,m_FileName,m_RAMValue,m_MultiWriter,m_ClampFilter);
     break;
     }
     case ImagePixelType_uint16:
     {
-    ClampAndWriteVectorImage<TInputVectorImageType,UInt16VectorImageType>(m_Image,m_VectorUInt16Writer,m_FileName,m_RAMValue);
+    ClampAndWriteVectorImage<TInputVectorImageType,UInt16VectorImageType>(m_Image,m_VectorUInt16Writer,m_FileName,m_RAMValue,m_MultiWriter,m_ClampFilter);
     break;
     }
     case ImagePixelType_int32:
     {
-    ClampAndWriteVectorImage<TInputVectorImageType,Int32VectorImageType>(m_Image,m_VectorInt32Writer,m_FileName,m_RAMValue);
+    ClampAndWriteVectorImage<TInputVectorImageType,Int32VectorImageType>(m_Image,m_VectorInt32Writer,m_FileName,m_RAMValue,m_MultiWriter,m_ClampFilter);
     break;
     }
     case ImagePixelType_uint32:
     {
-    ClampAndWriteVectorImage<TInputVectorImageType,UInt32VectorImageType>(m_Image,m_VectorUInt32Writer,m_FileName,m_RAMValue);
+    ClampAndWriteVectorImage<TInputVectorImageType,UInt32VectorImageType>(m_Image,m_VectorUInt32Writer,m_FileName,m_RAMValue,m_MultiWriter,m_ClampFilter);
     break;
     }
     case ImagePixelType_float:
     {
-    ClampAndWriteVectorImage<TInputVectorImageType,FloatVectorImageType>(m_Image,m_VectorFloatWriter,m_FileName,m_RAMValue);
+    ClampAndWriteVectorImage<TInputVectorImageType,FloatVectorImageType>(m_Image,m_VectorFloatWriter,m_FileName,m_RAMValue,m_MultiWriter,m_ClampFilter);
     break;
     }
     case ImagePixelType_double:
     {
-    ClampAndWriteVectorImage<TInputVectorImageType,DoubleVectorImageType>(m_Image,m_VectorDoubleWriter,m_FileName,m_RAMValue);
+    ClampAndWriteVectorImage<TInputVectorImageType,DoubleVectorImageType>(m_Image,m_VectorDoubleWriter,m_FileName,m_RAMValue,m_MultiWriter,m_ClampFilter);
     break;
     }
     }
@@ -330,6 +372,11 @@ OutputImageParameter::SwitchRGBAImageWrite()
   {
   if( m_PixelType == ImagePixelType_uint8 )
     {
+    if (m_MultiWriter)
+      {
+      m_MultiWriter->AddInputImage(dynamic_cast<UInt8RGBAImageType*>(m_Image.GetPointer()), m_FileName);
+      return;
+      }
     m_RGBAUInt8Writer->SetFileName( this->GetFileName() );
     m_RGBAUInt8Writer->SetInput(dynamic_cast<UInt8RGBAImageType*>(m_Image.GetPointer()) );
     m_RGBAUInt8Writer->SetAutomaticAdaptativeStreaming(m_RAMValue);
@@ -345,6 +392,11 @@ OutputImageParameter::SwitchRGBImageWrite()
   {
    if( m_PixelType == ImagePixelType_uint8 )
     {
+    if (m_MultiWriter)
+      {
+      m_MultiWriter->AddInputImage(dynamic_cast<UInt8RGBImageType*>(m_Image.GetPointer()), m_FileName);
+      return;
+      }
     m_RGBUInt8Writer->SetFileName( this->GetFileName() );
     m_RGBUInt8Writer->SetInput(dynamic_cast<UInt8RGBImageType*>(m_Image.GetPointer()) );
     m_RGBUInt8Writer->SetAutomaticAdaptativeStreaming(m_RAMValue);
@@ -430,6 +482,25 @@ OutputImageParameter::Write()
   }
 
 
+void
+OutputImageParameter::AddToMultiWriter(MultiImageFileWriter* multiWriter)
+{
+  // Go through the same pixel type dispatch than Write(), but hand the
+  // clamped image to the multi-writer instead of writing it
+  m_MultiWriter = multiWriter;
+  try
+    {
+    this->Write();
+    }
+  catch (...)
+    {
+    m_MultiWriter = ITK_NULLPTR;
+    throw;
+    }
+  m_MultiWriter = ITK_NULLPTR;
+}
+
+
 itk::ProcessObject*
 OutputImageParameter::GetWriter()
 {
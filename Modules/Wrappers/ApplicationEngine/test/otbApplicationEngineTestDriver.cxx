@@ -54,4 +54,5 @@ void RegisterTests()
   REGISTER_TEST(otbWrapperOutputImageParameterNew);
   REGISTER_TEST(otbWrapperOutputImageParameterTest1);
   REGISTER_TEST(otbApplicationMemoryConnectTest);
+  REGISTER_TEST(otbApplicationExecutionPlannerTest);
 }
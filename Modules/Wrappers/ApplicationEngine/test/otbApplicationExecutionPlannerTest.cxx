@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if defined(_MSC_VER)
+#pragma warning ( disable : 4786 )
+#endif
+
+#include "otbWrapperApplicationRegistry.h"
+#include "otbWrapperApplicationExecutionPlanner.h"
+
+
+int otbApplicationExecutionPlannerTest(int argc, char * argv[])
+{
+  if(argc<7)
+    {
+    std::cerr<<"Usage: "<<argv[0]<<" application_path infname outfname1 outfname2 reffname1 reffname2"<<std::endl;
+    return EXIT_FAILURE;
+    }
+
+  std::string path = argv[1];
+  std::string infname = argv[2];
+  std::string outfname1 = argv[3];
+  std::string outfname2 = argv[4];
+  std::string reffname1 = argv[5];
+  std::string reffname2 = argv[6];
+
+  otb::Wrapper::ApplicationRegistry::SetApplicationPath(path);
+
+  // Reference: applications connected and written one by one
+  otb::Wrapper::Application::Pointer ref1 = otb::Wrapper::ApplicationRegistry::CreateApplication("Smoothing");
+  otb::Wrapper::Application::Pointer ref2 = otb::Wrapper::ApplicationRegistry::CreateApplication("Smoothing");
+  otb::Wrapper::Application::Pointer ref3 = otb::Wrapper::ApplicationRegistry::CreateApplication("Smoothing");
+
+  if(ref1.IsNull() || ref2.IsNull() || ref3.IsNull())
+    {
+    std::cerr<<"Failed to create applications"<<std::endl;
+    return EXIT_FAILURE;
+    }
+
+  ref1->SetParameterString("in",infname);
+  ref1->Execute();
+  ref2->SetParameterInputImage("in",ref1->GetParameterOutputImage("out"));
+  ref2->SetParameterString("out",reffname1);
+  ref2->ExecuteAndWriteOutput();
+  ref3->SetParameterString("in",infname);
+  ref3->SetParameterString("out",reffname2);
+  ref3->ExecuteAndWriteOutput();
+
+  // Same graph through the planner
+  otb::Wrapper::Application::Pointer app1 = otb::Wrapper::ApplicationRegistry::CreateApplication("Smoothing");
+  otb::Wrapper::Application::Pointer app2 = otb::Wrapper::ApplicationRegistry::CreateApplication("Smoothing");
+  otb::Wrapper::Application::Pointer app3 = otb::Wrapper::ApplicationRegistry::CreateApplication("Smoothing");
+
+  app1->SetParameterString("in",infname);
+  app2->SetParameterString("out",outfname1);
+  app3->SetParameterString("in",infname);
+  app3->SetParameterString("out",outfname2);
+
+  otb::Wrapper::ApplicationExecutionPlanner::Pointer planner = otb::Wrapper::ApplicationExecutionPlanner::New();
+
+  // Added out of order on purpose
+  planner->AddApplication(app2,"second");
+  planner->AddApplication(app1,"first");
+  planner->AddApplication(app3,"other");
+  planner->Connect("first.out","second.in");
+
+  std::vector<std::string> order = planner->GetExecutionOrder();
+  if (order.size() != 3 || order[0] != "first" || order[1] != "second" || order[2] != "other")
+    {
+    std::cerr<<"Wrong execution order"<<std::endl;
+    return EXIT_FAILURE;
+    }
+
+  planner->ExecuteAndWriteOutputs();
+
+  // "first" and "other" read the same file
+  if (planner->GetNumberOfSharedReaders() != 1)
+    {
+    std::cerr<<"Expected 1 shared reader, got "<<planner->GetNumberOfSharedReaders()<<std::endl;
+    return EXIT_FAILURE;
+    }
+
+  // A cycle has to be detected
+  planner->Connect("second.out","first.in");
+  try
+    {
+    planner->GetExecutionOrder();
+    std::cerr<<"The cycle was not detected"<<std::endl;
+    return EXIT_FAILURE;
+    }
+  catch (itk::ExceptionObject &)
+    {
+    }
+
+  return EXIT_SUCCESS;
+}
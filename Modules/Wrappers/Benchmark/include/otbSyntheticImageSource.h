@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbSyntheticImageSource_h
+#define otbSyntheticImageSource_h
+
+#include "itkImageSource.h"
+
+namespace otb
+{
+
+/** \class SyntheticImageSource
+ *  \brief Generate a reproducible multi-band image
+ *
+ *  The value of each pixel only depends on its position and band, so
+ *  the image is the same whatever the streaming or the number of threads,
+ *  and it can be sampled without being generated (see Evaluate()). It
+ *  mixes a smooth pattern, piecewise constant areas of 32x32 pixels and
+ *  a pseudo-random noise, in the range [600, 2050].
+ *
+ *  The horizontal shift translates the pattern to the left, which gives
+ *  the right image of a stereo pair with a constant disparity.
+ *
+ *  The output image has to be an otb::VectorImage.
+ *
+ * \ingroup OTBBenchmark
+ */
+template <class TOutputImage>
+class ITK_EXPORT SyntheticImageSource : public itk::ImageSource<TOutputImage>
+{
+public:
+  /** Standard class typedefs. */
+  typedef SyntheticImageSource                 Self;
+  typedef itk::ImageSource<TOutputImage>       Superclass;
+  typedef itk::SmartPointer<Self>              Pointer;
+  typedef itk::SmartPointer<const Self>        ConstPointer;
+
+  typedef TOutputImage                            OutputImageType;
+  typedef typename OutputImageType::SizeType      SizeType;
+  typedef typename OutputImageType::RegionType    RegionType;
+  typedef typename OutputImageType::PixelType     PixelType;
+  typedef typename OutputImageType::InternalPixelType InternalPixelType;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(SyntheticImageSource, itk::ImageSource);
+
+  /** Set/Get the size of the image */
+  itkSetMacro(Size, SizeType);
+  itkGetConstReferenceMacro(Size, SizeType);
+
+  /** Set/Get the number of bands */
+  itkSetMacro(NumberOfBands, unsigned int);
+  itkGetConstMacro(NumberOfBands, unsigned int);
+
+  /** Set/Get the horizontal shift of the pattern, in pixels */
+  itkSetMacro(HorizontalShift, unsigned int);
+  itkGetConstMacro(HorizontalShift, unsigned int);
+
+  /** Value of the given pixel and band, without shift */
+  static double Evaluate(unsigned long x, unsigned long y, unsigned int band);
+
+  /** Index of the piecewise constant area of the given pixel */
+  static unsigned int GetArea(unsigned long x, unsigned long y, unsigned int band);
+
+protected:
+  SyntheticImageSource();
+  ~SyntheticImageSource() ITK_OVERRIDE {}
+
+  void GenerateOutputInformation() ITK_OVERRIDE;
+
+  void ThreadedGenerateData(const RegionType& outputRegionForThread,
+                            itk::ThreadIdType threadId) ITK_OVERRIDE;
+
+  void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
+
+private:
+  SyntheticImageSource(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  SizeType     m_Size;
+  unsigned int m_NumberOfBands;
+  unsigned int m_HorizontalShift;
+};
+
+} // end namespace otb
+
+#ifndef OTB_MANUAL_INSTANTIATION
+#include "otbSyntheticImageSource.txx"
+#endif
+
+#endif
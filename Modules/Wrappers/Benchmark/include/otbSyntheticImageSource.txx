@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbSyntheticImageSource_txx
+#define otbSyntheticImageSource_txx
+
+#include "otbSyntheticImageSource.h"
+#include "itkImageRegionIteratorWithIndex.h"
+#include "otbMath.h"
+
+namespace otb
+{
+
+template <class TOutputImage>
+SyntheticImageSource<TOutputImage>
+::SyntheticImageSource()
+  : m_NumberOfBands(4),
+    m_HorizontalShift(0)
+{
+  m_Size.Fill(512);
+}
+
+template <class TOutputImage>
+double
+SyntheticImageSource<TOutputImage>
+::Evaluate(unsigned long x, unsigned long y, unsigned int band)
+{
+  const double smooth = 400. * vcl_sin(0.05 * x + 0.7 * band) * vcl_cos(0.03 * y);
+  const double areas = 300. * GetArea(x, y, band);
+
+  // Integer hash of the position: reproducible and thread-safe
+  unsigned long hash = (x * 73856093UL) ^ (y * 19349663UL) ^ (band * 83492791UL);
+  hash = (hash ^ (hash >> 13)) * 1274126177UL;
+  const double noise = static_cast<double>((hash >> 7) % 50);
+
+  return 1000. + smooth + areas + noise;
+}
+
+template <class TOutputImage>
+unsigned int
+SyntheticImageSource<TOutputImage>
+::GetArea(unsigned long x, unsigned long y, unsigned int band)
+{
+  return static_cast<unsigned int>((x / 32 + y / 32 + band) % 3);
+}
+
+template <class TOutputImage>
+void
+SyntheticImageSource<TOutputImage>
+::GenerateOutputInformation()
+{
+  OutputImageType * output = this->GetOutput();
+
+  typename OutputImageType::IndexType index;
+  index.Fill(0);
+  RegionType region(index, m_Size);
+  output->SetLargestPossibleRegion(region);
+
+  typename OutputImageType::SpacingType spacing;
+  spacing.Fill(1.);
+  output->SetSpacing(spacing);
+
+  // Pixel centers, so that the upper left corner is (0, 0)
+  typename OutputImageType::PointType origin;
+  origin.Fill(0.5);
+  output->SetOrigin(origin);
+
+  output->SetNumberOfComponentsPerPixel(m_NumberOfBands);
+}
+
+template <class TOutputImage>
+void
+SyntheticImageSource<TOutputImage>
+::ThreadedGenerateData(const RegionType& outputRegionForThread,
+                       itk::ThreadIdType itkNotUsed(threadId))
+{
+  typedef itk::ImageRegionIteratorWithIndex<OutputImageType> IteratorType;
+
+  PixelType pixel(m_NumberOfBands);
+  IteratorType it(this->GetOutput(), outputRegionForThread);
+  for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+    const typename OutputImageType::IndexType & index = it.GetIndex();
+    for (unsigned int band = 0; band < m_NumberOfBands; ++band)
+      {
+      pixel[band] = static_cast<InternalPixelType>(
+        Evaluate(index[0] + m_HorizontalShift, index[1], band));
+      }
+    it.Set(pixel);
+    }
+}
+
+template <class TOutputImage>
+void
+SyntheticImageSource<TOutputImage>
+::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Size: " << m_Size << std::endl;
+  os << indent << "Number of bands: " << m_NumberOfBands << std::endl;
+  os << indent << "Horizontal shift: " << m_HorizontalShift << std::endl;
+}
+
+} // end namespace otb
+
+#endif
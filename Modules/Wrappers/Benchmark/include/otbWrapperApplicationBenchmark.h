@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef otbWrapperApplicationBenchmark_h
+#define otbWrapperApplicationBenchmark_h
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+
+#include "OTBBenchmarkExport.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace otb
+{
+namespace Wrapper
+{
+
+class Application;
+
+/** \class ApplicationBenchmark
+ *  \brief Timed runs of applications on synthetic data
+ *
+ *  A scenario runs an application on inputs generated by
+ *  GenerateInputs() in the working directory, so that the benchmark
+ *  does not need any data and gives the same results on every machine
+ *  with the same build:
+ *  - io: ExtractROI of the whole image (GDAL read and write),
+ *  - bandmath: BandMath with a normalized difference,
+ *  - resampling: RigidTransformResample with a bicubic interpolator,
+ *  - classification: ImageClassifier with a model trained by
+ *    TrainVectorClassifier on synthetic samples,
+ *  - haralick: HaralickTextureExtraction of the simple features,
+ *  - meanshift: MeanShiftSmoothing with both outputs,
+ *  - blockmatching: BlockMatching of a stereo pair with a constant
+ *    disparity,
+ *  - statistics: ComputeImagesStatistics,
+ *  - rasterization: Rasterization of a grid of polygons.
+ *
+ *  A scenario is skipped when its application is not available in the
+ *  application path. Each scenario is run NumberOfRuns times with the
+ *  given number of threads, and its result gives the fastest and mean
+ *  wall-clock times, the CPU time of the fastest run, the throughput
+ *  in input pixels per second and the peak resident memory of the
+ *  process. To get the peak memory of each scenario, run each one in its
+ *  own process (as otbApplicationBenchmark does).
+ *
+ * \ingroup OTBBenchmark
+ */
+class OTBBenchmark_EXPORT ApplicationBenchmark : public itk::Object
+{
+public:
+  /** Standard class typedefs. */
+  typedef ApplicationBenchmark          Self;
+  typedef itk::Object                   Superclass;
+  typedef itk::SmartPointer<Self>       Pointer;
+  typedef itk::SmartPointer<const Self> ConstPointer;
+
+  /** Defining ::New() static method */
+  itkNewMacro(Self);
+
+  /** RTTI support */
+  itkTypeMacro(ApplicationBenchmark, itk::Object);
+
+  /** Result of a scenario */
+  typedef struct
+    {
+    std::string   Scenario;
+    std::string   Application;
+    /** "ok", "skipped" or "failed" */
+    std::string   Status;
+    std::string   Message;
+    unsigned int  NumberOfThreads;
+    unsigned int  NumberOfRuns;
+    unsigned long NumberOfPixels;
+    /** Wall-clock time of the fastest run, in seconds */
+    double        WallTime;
+    /** Mean wall-clock time of the runs, in seconds */
+    double        MeanWallTime;
+    /** CPU time of the fastest run (all threads), in seconds */
+    double        CPUTime;
+    double        PixelsPerSecond;
+    /** Peak resident memory of the process, in kB */
+    unsigned long PeakRSS;
+    } ResultType;
+
+  /** Set/Get the directory of the inputs and outputs */
+  itkSetStringMacro(WorkingDirectory);
+  itkGetStringMacro(WorkingDirectory);
+
+  /** Set/Get the width and height of the synthetic images (default 1024) */
+  itkSetMacro(ImageSize, unsigned int);
+  itkGetConstMacro(ImageSize, unsigned int);
+
+  /** Set/Get the number of bands of the synthetic images (default 4) */
+  itkSetMacro(NumberOfBands, unsigned int);
+  itkGetConstMacro(NumberOfBands, unsigned int);
+
+  /** Set/Get the number of runs of each scenario (default 3) */
+  itkSetMacro(NumberOfRuns, unsigned int);
+  itkGetConstMacro(NumberOfRuns, unsigned int);
+
+  /** Set/Get the RAM of the applications, in MB. 0 means the default
+   * of the applications. */
+  itkSetMacro(AvailableRAM, unsigned int);
+  itkGetConstMacro(AvailableRAM, unsigned int);
+
+  /** Names of all the scenarios */
+  static std::vector<std::string> GetScenarioNames();
+
+  /** Generate the synthetic inputs in the working directory */
+  void GenerateInputs();
+
+  /** Run a scenario in the current process. If nbThreads is 0, the
+   * default number of threads is used. */
+  ResultType RunScenario(const std::string & scenario, unsigned int nbThreads = 0);
+
+  /** Write a result as a JSON object, on a single line */
+  static void WriteResult(std::ostream & os, const ResultType & result);
+
+  /** Peak resident memory of the current process, in kB (0 if unknown) */
+  static unsigned long GetPeakRSS();
+
+protected:
+  ApplicationBenchmark();
+  ~ApplicationBenchmark() ITK_OVERRIDE;
+  void PrintSelf(std::ostream& os, itk::Indent indent) const ITK_OVERRIDE;
+
+private:
+  ApplicationBenchmark(const Self &); //purposely not implemented
+  void operator =(const Self&); //purposely not implemented
+
+  /** Full path of a file of the working directory */
+  std::string GetPath(const std::string & filename) const;
+
+  /** Train the model of the classification scenario */
+  void TrainModel();
+
+  /** Set the parameters of the application of a scenario */
+  void ConfigureScenario(const std::string & scenario, Application * app) const;
+
+  std::string  m_WorkingDirectory;
+  unsigned int m_ImageSize;
+  unsigned int m_NumberOfBands;
+  unsigned int m_NumberOfRuns;
+  unsigned int m_AvailableRAM;
+};
+
+} // end namespace Wrapper
+} // end namespace otb
+
+#endif
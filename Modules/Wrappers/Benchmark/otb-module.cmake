@@ -0,0 +1,39 @@
+#
+# Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+#
+# This file is part of Orfeo Toolbox
+#
+#     https://www.orfeo-toolbox.org/
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+set(DOCUMENTATION "Performance benchmark of applications on synthetic data:
+timed runs, throughput, peak memory and scaling with the number of threads.")
+
+otb_module(OTBBenchmark
+  DEPENDS
+    OTBApplicationEngine
+    OTBCommon
+    OTBITK
+    OTBImageBase
+    OTBImageIO
+
+  TEST_DEPENDS
+    OTBAppImageUtils
+    OTBAppMathParser
+    OTBAppClassification
+
+  DESCRIPTION
+    "${DOCUMENTATION}"
+)
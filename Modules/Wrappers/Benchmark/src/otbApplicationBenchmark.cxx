@@ -0,0 +1,276 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbWrapperApplicationBenchmark.h"
+#include "otbWrapperApplicationRegistry.h"
+#include "otbConfigure.h"
+
+#include "itkMultiThreader.h"
+#include "itksys/Process.h"
+#include "itksys/SystemInformation.hxx"
+#include "itksys/SystemTools.hxx"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+typedef otb::Wrapper::ApplicationBenchmark BenchmarkType;
+
+void Usage(const char * program)
+{
+  std::cerr << "Usage: " << program << " <working directory> [options]\n"
+            << "Options:\n"
+            << "  -size <n>           Width and height of the synthetic images (default 1024)\n"
+            << "  -bands <n>          Number of bands of the synthetic images (default 4)\n"
+            << "  -threads <n,m,...>  Numbers of threads to run each scenario with (default: ITK default)\n"
+            << "  -scenarios <a,b,..> Scenarios to run (default: all)\n"
+            << "  -runs <n>           Number of runs of each scenario (default 3)\n"
+            << "  -ram <n>            RAM of the applications, in MB\n"
+            << "  -modulepath <dir>   Path of the applications\n"
+            << "  -out <file>         JSON output (default: standard output)\n"
+            << "Scenarios:";
+  std::vector<std::string> names = BenchmarkType::GetScenarioNames();
+  for (std::vector<std::string>::const_iterator it = names.begin(); it != names.end(); ++it)
+    {
+    std::cerr << " " << *it;
+    }
+  std::cerr << std::endl;
+}
+
+std::vector<std::string> SplitList(const std::string & list)
+{
+  std::vector<std::string> items;
+  std::istringstream iss(list);
+  std::string item;
+  while (std::getline(iss, item, ','))
+    {
+    if (!item.empty())
+      {
+      items.push_back(item);
+      }
+    }
+  return items;
+}
+
+/** Run a scenario in a child process, so that its peak memory is its own */
+std::string RunInChildProcess(const std::string & program,
+                              const std::vector<std::string> & commonArgs,
+                              const std::string & scenario,
+                              const std::string & threads,
+                              const std::string & resultFile)
+{
+  std::vector<std::string> args;
+  args.push_back(program);
+  args.insert(args.end(), commonArgs.begin(), commonArgs.end());
+  args.push_back("-run");
+  args.push_back(scenario);
+  args.push_back("-threads");
+  args.push_back(threads);
+  args.push_back("-result");
+  args.push_back(resultFile);
+
+  std::vector<const char *> argv;
+  for (std::vector<std::string>::const_iterator it = args.begin(); it != args.end(); ++it)
+    {
+    argv.push_back(it->c_str());
+    }
+  argv.push_back(ITK_NULLPTR);
+
+  itksys::SystemTools::RemoveFile(resultFile.c_str());
+
+  itksysProcess * process = itksysProcess_New();
+  itksysProcess_SetCommand(process, &argv[0]);
+  itksysProcess_SetPipeShared(process, itksysProcess_Pipe_STDOUT, 1);
+  itksysProcess_SetPipeShared(process, itksysProcess_Pipe_STDERR, 1);
+  itksysProcess_Execute(process);
+  itksysProcess_WaitForExit(process, ITK_NULLPTR);
+  itksysProcess_Delete(process);
+
+  std::ifstream ifs(resultFile.c_str());
+  std::string line;
+  if (!ifs || !std::getline(ifs, line) || line.empty())
+    {
+    BenchmarkType::ResultType result;
+    result.Scenario = scenario;
+    result.Status = "failed";
+    result.Message = "The benchmark process ended abnormally";
+    result.NumberOfThreads = atoi(threads.c_str());
+    result.NumberOfRuns = 0;
+    result.NumberOfPixels = 0;
+    result.WallTime = 0.;
+    result.MeanWallTime = 0.;
+    result.CPUTime = 0.;
+    result.PixelsPerSecond = 0.;
+    result.PeakRSS = 0;
+    std::ostringstream oss;
+    BenchmarkType::WriteResult(oss, result);
+    line = oss.str();
+    }
+  return line;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2 || argv[1][0] == '-')
+    {
+    Usage(argv[0]);
+    return EXIT_FAILURE;
+    }
+
+  BenchmarkType::Pointer benchmark = BenchmarkType::New();
+  benchmark->SetWorkingDirectory(argv[1]);
+
+  std::vector<std::string> scenarios = BenchmarkType::GetScenarioNames();
+  std::vector<std::string> threads(1, "0");
+  std::string outputFile;
+  std::string runScenario;
+  std::string resultFile;
+  // Options forwarded to the child processes
+  std::vector<std::string> commonArgs(1, argv[1]);
+
+  for (int i = 2; i + 1 < argc; i += 2)
+    {
+    const std::string option = argv[i];
+    const std::string value = argv[i + 1];
+    if (option == "-size")
+      {
+      benchmark->SetImageSize(atoi(value.c_str()));
+      }
+    else if (option == "-bands")
+      {
+      benchmark->SetNumberOfBands(atoi(value.c_str()));
+      }
+    else if (option == "-runs")
+      {
+      benchmark->SetNumberOfRuns(atoi(value.c_str()));
+      }
+    else if (option == "-ram")
+      {
+      benchmark->SetAvailableRAM(atoi(value.c_str()));
+      }
+    else if (option == "-modulepath")
+      {
+      otb::Wrapper::ApplicationRegistry::AddApplicationPath(value);
+      }
+    else if (option == "-threads")
+      {
+      threads = SplitList(value);
+      }
+    else if (option == "-scenarios")
+      {
+      scenarios = SplitList(value);
+      }
+    else if (option == "-out")
+      {
+      outputFile = value;
+      }
+    else if (option == "-run")
+      {
+      runScenario = value;
+      }
+    else if (option == "-result")
+      {
+      resultFile = value;
+      }
+    else
+      {
+      std::cerr << "Unknown option " << option << std::endl;
+      Usage(argv[0]);
+      return EXIT_FAILURE;
+      }
+
+    if (option != "-threads" && option != "-scenarios" && option != "-out"
+        && option != "-run" && option != "-result")
+      {
+      commonArgs.push_back(option);
+      commonArgs.push_back(value);
+      }
+    }
+
+  // Child process: run a single scenario
+  if (!runScenario.empty())
+    {
+    try
+      {
+      BenchmarkType::ResultType result =
+        benchmark->RunScenario(runScenario, threads.empty() ? 0 : atoi(threads.front().c_str()));
+      std::ofstream ofs(resultFile.c_str());
+      BenchmarkType::WriteResult(ofs, result);
+      ofs << std::endl;
+      }
+    catch (itk::ExceptionObject & err)
+      {
+      std::cerr << err << std::endl;
+      return EXIT_FAILURE;
+      }
+    return EXIT_SUCCESS;
+    }
+
+  std::string program = argv[0];
+  if (program.find('/') == std::string::npos && program.find('\\') == std::string::npos)
+    {
+    program = itksys::SystemTools::FindProgram(program.c_str());
+    }
+
+  itksys::SystemInformation systemInformation;
+  systemInformation.RunCPUCheck();
+
+  std::cerr << "Generating the synthetic inputs in " << benchmark->GetWorkingDirectory() << std::endl;
+  benchmark->GenerateInputs();
+
+  std::ostringstream report;
+  report << "{\"otb_version\": \"" << OTB_VERSION_STRING << "\""
+         << ", \"image_size\": " << benchmark->GetImageSize()
+         << ", \"bands\": " << benchmark->GetNumberOfBands()
+         << ", \"runs\": " << benchmark->GetNumberOfRuns()
+         << ", \"logical_cpus\": " << systemInformation.GetNumberOfLogicalCPU()
+         << ", \"results\": [";
+
+  bool failed = false;
+  bool first = true;
+  for (std::vector<std::string>::const_iterator scenarioIt = scenarios.begin();
+       scenarioIt != scenarios.end(); ++scenarioIt)
+    {
+    for (std::vector<std::string>::const_iterator threadsIt = threads.begin();
+         threadsIt != threads.end(); ++threadsIt)
+      {
+      std::cerr << "Running " << *scenarioIt << " with " << *threadsIt << " thread(s)" << std::endl;
+      const std::string line = RunInChildProcess(program, commonArgs, *scenarioIt, *threadsIt,
+        benchmark->GetWorkingDirectory() + std::string("/result.json"));
+      failed = failed || line.find("\"status\": \"failed\"") != std::string::npos;
+      report << (first ? "\n  " : ",\n  ") << line;
+      first = false;
+      }
+    }
+  report << "\n]}" << std::endl;
+
+  if (outputFile.empty())
+    {
+    std::cout << report.str();
+    }
+  else
+    {
+    std::ofstream ofs(outputFile.c_str());
+    ofs << report.str();
+    }
+
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
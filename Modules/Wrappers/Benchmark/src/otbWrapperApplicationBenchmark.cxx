@@ -0,0 +1,514 @@
+/*
+ * Copyright (C) 2005-2017 Centre National d'Etudes Spatiales (CNES)
+ *
+ * This file is part of Orfeo Toolbox
+ *
+ *     https://www.orfeo-toolbox.org/
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "otbWrapperApplicationBenchmark.h"
+#include "otbWrapperApplicationRegistry.h"
+#include "otbSyntheticImageSource.h"
+#include "otbVectorImage.h"
+#include "otbImageFileWriter.h"
+#include "otbMacro.h"
+
+#include "itkMultiThreader.h"
+#include "itksys/SystemTools.hxx"
+
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+namespace otb
+{
+namespace Wrapper
+{
+
+namespace
+{
+typedef otb::VectorImage<unsigned short, 2>         SyntheticImageType;
+typedef otb::SyntheticImageSource<SyntheticImageType> SyntheticSourceType;
+
+/** Scenario names and their application */
+const char * const Scenarios[][2] = {
+  {"io",             "ExtractROI"},
+  {"bandmath",       "BandMath"},
+  {"resampling",     "RigidTransformResample"},
+  {"classification", "ImageClassifier"},
+  {"haralick",       "HaralickTextureExtraction"},
+  {"meanshift",      "MeanShiftSmoothing"},
+  {"blockmatching",  "BlockMatching"},
+  {"statistics",     "ComputeImagesStatistics"},
+  {"rasterization",  "Rasterization"}
+};
+
+const unsigned int NumberOfScenarios = sizeof(Scenarios) / sizeof(Scenarios[0]);
+
+/** Disparity of the stereo pair */
+const unsigned int StereoShift = 4;
+
+/** Spacing of the training samples and of the rasterized polygons */
+const unsigned int GridStep = 16;
+
+std::string EscapeJSON(const std::string & str)
+{
+  std::ostringstream oss;
+  for (std::string::const_iterator it = str.begin(); it != str.end(); ++it)
+    {
+    switch (*it)
+      {
+      case '"':  oss << "\\\""; break;
+      case '\\': oss << "\\\\"; break;
+      case '\n': oss << "\\n"; break;
+      case '\t': oss << "\\t"; break;
+      case '\r': break;
+      default:   oss << *it;
+      }
+    }
+  return oss.str();
+}
+
+void SetParameter(Application * app, const std::string & key, const std::string & value)
+{
+  app->SetParameterString(key, value);
+  app->UpdateParameters();
+}
+
+template <class T>
+void SetParameter(Application * app, const std::string & key, T value)
+{
+  std::ostringstream oss;
+  oss << value;
+  SetParameter(app, key, oss.str());
+}
+
+void SetParameterList(Application * app, const std::string & key, const std::vector<std::string> & values)
+{
+  app->SetParameterStringList(key, values);
+  app->UpdateParameters();
+}
+
+bool HasParameter(Application * app, const std::string & key)
+{
+  std::vector<std::string> keys = app->GetParametersKeys(true);
+  return std::find(keys.begin(), keys.end(), key) != keys.end();
+}
+
+void WriteSyntheticImage(const std::string & filename, unsigned int size,
+                         unsigned int nbBands, unsigned int shift)
+{
+  typedef otb::ImageFileWriter<SyntheticImageType> WriterType;
+
+  SyntheticSourceType::Pointer source = SyntheticSourceType::New();
+  SyntheticSourceType::SizeType imageSize;
+  imageSize.Fill(size);
+  source->SetSize(imageSize);
+  source->SetNumberOfBands(nbBands);
+  source->SetHorizontalShift(shift);
+
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetInput(source->GetOutput());
+  writer->SetFileName(filename);
+  writer->Update();
+}
+}
+
+ApplicationBenchmark::ApplicationBenchmark()
+  : m_ImageSize(1024),
+    m_NumberOfBands(4),
+    m_NumberOfRuns(3),
+    m_AvailableRAM(0)
+{
+}
+
+ApplicationBenchmark::~ApplicationBenchmark()
+{
+}
+
+std::vector<std::string>
+ApplicationBenchmark::GetScenarioNames()
+{
+  std::vector<std::string> names;
+  for (unsigned int i = 0; i < NumberOfScenarios; ++i)
+    {
+    names.push_back(Scenarios[i][0]);
+    }
+  return names;
+}
+
+std::string
+ApplicationBenchmark::GetPath(const std::string & filename) const
+{
+  return m_WorkingDirectory + "/" + filename;
+}
+
+void
+ApplicationBenchmark::GenerateInputs()
+{
+  if (m_WorkingDirectory.empty())
+    {
+    itkExceptionMacro(<< "No working directory");
+    }
+  itksys::SystemTools::MakeDirectory(m_WorkingDirectory.c_str());
+
+  // Image and right image of the stereo pair
+  WriteSyntheticImage(GetPath("image.tif"), m_ImageSize, m_NumberOfBands, 0);
+  WriteSyntheticImage(GetPath("right.tif"), m_ImageSize, m_NumberOfBands, StereoShift);
+
+  // Training samples: points with the pixel values as features and the
+  // area as class
+  std::ofstream points(GetPath("samples.geojson").c_str());
+  points << "{\"type\": \"FeatureCollection\", \"features\": [";
+  bool first = true;
+  for (unsigned int y = GridStep / 2; y < m_ImageSize; y += GridStep)
+    {
+    for (unsigned int x = GridStep / 2; x < m_ImageSize; x += GridStep)
+      {
+      points << (first ? "\n" : ",\n") << "{\"type\": \"Feature\", \"properties\": {\"class\": "
+             << SyntheticSourceType::GetArea(x, y, 0) + 1;
+      for (unsigned int band = 0; band < m_NumberOfBands; ++band)
+        {
+        points << ", \"b" << band + 1 << "\": " << SyntheticSourceType::Evaluate(x, y, band);
+        }
+      points << "}, \"geometry\": {\"type\": \"Point\", \"coordinates\": ["
+             << x + 0.5 << ", " << y + 0.5 << "]}}";
+      first = false;
+      }
+    }
+  points << "\n]}" << std::endl;
+  points.close();
+
+  // Polygons to rasterize: a checkerboard of squares
+  std::ofstream polygons(GetPath("polygons.geojson").c_str());
+  polygons << "{\"type\": \"FeatureCollection\", \"features\": [";
+  first = true;
+  for (unsigned int y = 0; y + GridStep <= m_ImageSize; y += GridStep)
+    {
+    for (unsigned int x = (y / GridStep) % 2 * GridStep; x + GridStep <= m_ImageSize; x += 2 * GridStep)
+      {
+      polygons << (first ? "\n" : ",\n")
+               << "{\"type\": \"Feature\", \"properties\": {}, \"geometry\": {\"type\": \"Polygon\", \"coordinates\": [["
+               << "[" << x << ", " << y << "], [" << x + GridStep << ", " << y << "], "
+               << "[" << x + GridStep << ", " << y + GridStep << "], [" << x << ", " << y + GridStep << "], "
+               << "[" << x << ", " << y << "]]]}}";
+      first = false;
+      }
+    }
+  polygons << "\n]}" << std::endl;
+  polygons.close();
+
+  this->TrainModel();
+}
+
+void
+ApplicationBenchmark::TrainModel()
+{
+  const std::string model = GetPath("model.txt");
+  itksys::SystemTools::RemoveFile(model.c_str());
+
+  Application::Pointer app = ApplicationRegistry::CreateApplication("TrainVectorClassifier");
+  if (app.IsNull())
+    {
+    otbMsgDevMacro(<< "TrainVectorClassifier is not available, the classification scenario will be skipped");
+    return;
+    }
+
+  try
+    {
+    std::vector<std::string> samples(1, GetPath("samples.geojson"));
+    SetParameterList(app, "io.vd", samples);
+    SetParameter(app, "io.out", model);
+
+    std::vector<std::string> features;
+    for (unsigned int band = 0; band < m_NumberOfBands; ++band)
+      {
+      std::ostringstream oss;
+      oss << "b" << band + 1;
+      features.push_back(oss.str());
+      }
+    SetParameterList(app, "feat", features);
+    SetParameterList(app, "cfield", std::vector<std::string>(1, "class"));
+
+    // Prefer the fastest classifiers which are available
+    const char * const preferred[] = {"sharkrf", "rf", "dt", "libsvm"};
+    std::vector<std::string> classifiers = app->GetChoiceKeys("classifier");
+    std::string classifier = classifiers.empty() ? "" : classifiers.front();
+    for (unsigned int i = 0; i < sizeof(preferred) / sizeof(preferred[0]); ++i)
+      {
+      if (std::find(classifiers.begin(), classifiers.end(), preferred[i]) != classifiers.end())
+        {
+        classifier = preferred[i];
+        break;
+        }
+      }
+    SetParameter(app, "classifier", classifier);
+
+    app->ExecuteAndWriteOutput();
+    }
+  catch (itk::ExceptionObject & err)
+    {
+    itkWarningMacro(<< "Training failed, the classification scenario will be skipped: " << err.GetDescription());
+    }
+}
+
+void
+ApplicationBenchmark::ConfigureScenario(const std::string & scenario, Application * app) const
+{
+  const std::string image = GetPath("image.tif");
+  const std::string out = GetPath(scenario + "_out.tif");
+
+  if (scenario == "io")
+    {
+    SetParameter(app, "in", image);
+    SetParameter(app, "out", out);
+    }
+  else if (scenario == "bandmath")
+    {
+    SetParameterList(app, "il", std::vector<std::string>(1, image));
+    SetParameter(app, "exp", "(im1b1-im1b2)/(im1b1+im1b2+1)");
+    SetParameter(app, "out", out);
+    }
+  else if (scenario == "resampling")
+    {
+    SetParameter(app, "in", image);
+    SetParameter(app, "transform.type", "id");
+    SetParameter(app, "transform.type.id.scalex", 0.75);
+    SetParameter(app, "transform.type.id.scaley", 0.75);
+    SetParameter(app, "interpolator", "bco");
+    SetParameter(app, "out", out);
+    }
+  else if (scenario == "classification")
+    {
+    SetParameter(app, "in", image);
+    SetParameter(app, "model", GetPath("model.txt"));
+    SetParameter(app, "out", out);
+    }
+  else if (scenario == "haralick")
+    {
+    SetParameter(app, "in", image);
+    SetParameter(app, "channel", 1);
+    SetParameter(app, "texture", "simple");
+    SetParameter(app, "parameters.min", 0);
+    SetParameter(app, "parameters.max", 2100);
+    SetParameter(app, "parameters.nbbin", 8);
+    SetParameter(app, "out", out);
+    }
+  else if (scenario == "meanshift")
+    {
+    SetParameter(app, "in", image);
+    SetParameter(app, "spatialr", 5);
+    SetParameter(app, "ranger", 100);
+    SetParameter(app, "maxiter", 4);
+    app->SetParameterEmpty("modesearch", false);
+    SetParameter(app, "fout", out);
+    SetParameter(app, "foutpos", GetPath(scenario + "_outpos.tif"));
+    }
+  else if (scenario == "blockmatching")
+    {
+    SetParameter(app, "io.inleft", image);
+    SetParameter(app, "io.inright", GetPath("right.tif"));
+    SetParameter(app, "bm.radius", 3);
+    SetParameter(app, "bm.minhd", -2 * static_cast<int>(StereoShift));
+    SetParameter(app, "bm.maxhd", 2 * static_cast<int>(StereoShift));
+    SetParameter(app, "bm.minvd", 0);
+    SetParameter(app, "bm.maxvd", 0);
+    SetParameter(app, "io.out", out);
+    }
+  else if (scenario == "statistics")
+    {
+    SetParameterList(app, "il", std::vector<std::string>(1, image));
+    SetParameter(app, "out", GetPath(scenario + "_out.xml"));
+    }
+  else if (scenario == "rasterization")
+    {
+    SetParameter(app, "in", GetPath("polygons.geojson"));
+    SetParameter(app, "szx", m_ImageSize);
+    SetParameter(app, "szy", m_ImageSize);
+    SetParameter(app, "orx", 0.5);
+    SetParameter(app, "ory", 0.5);
+    SetParameter(app, "spx", 1.);
+    SetParameter(app, "spy", 1.);
+    SetParameter(app, "out", out);
+    }
+
+  if (m_AvailableRAM > 0 && HasParameter(app, "ram"))
+    {
+    SetParameter(app, "ram", m_AvailableRAM);
+    }
+}
+
+ApplicationBenchmark::ResultType
+ApplicationBenchmark::RunScenario(const std::string & scenario, unsigned int nbThreads)
+{
+  ResultType result;
+  result.Scenario = scenario;
+  result.Status = "ok";
+  result.NumberOfThreads = 0;
+  result.NumberOfRuns = 0;
+  result.NumberOfPixels = static_cast<unsigned long>(m_ImageSize) * m_ImageSize;
+  result.WallTime = 0.;
+  result.MeanWallTime = 0.;
+  result.CPUTime = 0.;
+  result.PixelsPerSecond = 0.;
+  result.PeakRSS = 0;
+
+  for (unsigned int i = 0; i < NumberOfScenarios; ++i)
+    {
+    if (scenario == Scenarios[i][0])
+      {
+      result.Application = Scenarios[i][1];
+      }
+    }
+  if (result.Application.empty())
+    {
+    itkExceptionMacro(<< "Unknown scenario " << scenario);
+    }
+
+  if (nbThreads > 0)
+    {
+    itk::MultiThreader::SetGlobalDefaultNumberOfThreads(nbThreads);
+    }
+  result.NumberOfThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+
+  if (scenario == "classification" && !itksys::SystemTools::FileExists(GetPath("model.txt").c_str()))
+    {
+    result.Status = "skipped";
+    result.Message = "No model was trained";
+    return result;
+    }
+
+  double totalWallTime = 0.;
+  try
+    {
+    for (unsigned int run = 0; run < m_NumberOfRuns; ++run)
+      {
+      // A new application for each run, so that nothing is cached
+      Application::Pointer app = ApplicationRegistry::CreateApplication(result.Application);
+      if (app.IsNull())
+        {
+        result.Status = "skipped";
+        result.Message = "Application " + result.Application + " is not available";
+        return result;
+        }
+      app->GetLogger()->SetPriorityLevel(itk::LoggerBase::WARNING);
+
+      this->ConfigureScenario(scenario, app);
+
+      const double wallStart = itksys::SystemTools::GetTime();
+      const std::clock_t cpuStart = std::clock();
+
+      if (app->ExecuteAndWriteOutput() != 0)
+        {
+        result.Status = "failed";
+        result.Message = "Execution failed";
+        return result;
+        }
+
+      const double cpuTime = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+      const double wallTime = itksys::SystemTools::GetTime() - wallStart;
+
+      if (run == 0 || wallTime < result.WallTime)
+        {
+        result.WallTime = wallTime;
+        result.CPUTime = cpuTime;
+        }
+      totalWallTime += wallTime;
+      ++result.NumberOfRuns;
+      }
+    }
+  catch (itk::ExceptionObject & err)
+    {
+    result.Status = "failed";
+    result.Message = err.GetDescription();
+    }
+  catch (std::exception & err)
+    {
+    result.Status = "failed";
+    result.Message = err.what();
+    }
+
+  if (result.NumberOfRuns > 0)
+    {
+    result.MeanWallTime = totalWallTime / result.NumberOfRuns;
+    if (result.WallTime > 0.)
+      {
+      result.PixelsPerSecond = result.NumberOfPixels / result.WallTime;
+      }
+    }
+  result.PeakRSS = GetPeakRSS();
+
+  return result;
+}
+
+void
+ApplicationBenchmark::WriteResult(std::ostream & os, const ResultType & result)
+{
+  std::ostringstream oss;
+  oss << std::fixed << std::setprecision(6);
+  oss << "{\"scenario\": \"" << result.Scenario << "\""
+      << ", \"application\": \"" << result.Application << "\""
+      << ", \"status\": \"" << result.Status << "\""
+      << ", \"message\": \"" << EscapeJSON(result.Message) << "\""
+      << ", \"threads\": " << result.NumberOfThreads
+      << ", \"runs\": " << result.NumberOfRuns
+      << ", \"pixels\": " << result.NumberOfPixels
+      << ", \"wall_s\": " << result.WallTime
+      << ", \"mean_wall_s\": " << result.MeanWallTime
+      << ", \"cpu_s\": " << result.CPUTime
+      << ", \"pixels_per_s\": " << std::setprecision(1) << result.PixelsPerSecond
+      << ", \"peak_rss_kb\": " << result.PeakRSS << "}";
+  os << oss.str();
+}
+
+unsigned long
+ApplicationBenchmark::GetPeakRSS()
+{
+#if defined(_WIN32)
+  return 0;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+    return 0;
+    }
+#if defined(__APPLE__)
+  // In bytes on Mac OS X
+  return static_cast<unsigned long>(usage.ru_maxrss) / 1024;
+#else
+  return static_cast<unsigned long>(usage.ru_maxrss);
+#endif
+#endif
+}
+
+void
+ApplicationBenchmark::PrintSelf(std::ostream& os, itk::Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+  os << indent << "Working directory: " << m_WorkingDirectory << std::endl;
+  os << indent << "Image size: " << m_ImageSize << std::endl;
+  os << indent << "Number of bands: " << m_NumberOfBands << std::endl;
+  os << indent << "Number of runs: " << m_NumberOfRuns << std::endl;
+  os << indent << "Available RAM: " << m_AvailableRAM << std::endl;
+}
+
+} // end namespace Wrapper
+} // end namespace otb